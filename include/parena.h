@@ -0,0 +1,20 @@
+#ifndef PARENA_H
+#define PARENA_H
+
+#include<stddef.h>
+
+/* Chunk size used when pvars_arena_create() is passed 0 */
+#define PVARS_ARENA_DEFAULT_CHUNK_SIZE (64u * 1024u)
+
+/* --- Public API Function Prototypes --- */
+
+/* pvars_arena_t setup and packdown */
+pvars_arena_t *pvars_arena_create(size_t chunk_size);
+void pvars_arena_destroy(pvars_arena_t *arena);
+void pvars_arena_reset(pvars_arena_t *arena);
+
+/* pvars_arena_t meta data accessors */
+size_t pvars_arena_get_used(const pvars_arena_t *arena);
+size_t pvars_arena_get_chunk_count(const pvars_arena_t *arena);
+
+#endif /* PARENA_H */
@@ -5,10 +5,40 @@
 
 typedef struct pdict_t pdict_t;
 
+/**
+ * @brief Storage layouts available to a dict.
+ */
+typedef enum {
+	PDICT_BACKEND_CHAINED = 0, /* Bucket array with separately chained entries (default) */
+	PDICT_BACKEND_FLAT         /* Open addressing with entries stored inline, probed 16 control bytes at a time */
+} pdict_backend;
+
+/**
+ * @brief Hash functions available to a dict. Every dict is seeded randomly.
+ */
+typedef enum {
+	PDICT_HASH_WYHASH = 0, /* Eight bytes at a time, 128-bit multiply mixing (default) */
+	PDICT_HASH_DJB2        /* One byte at a time, DJB2 with a 64-bit finaliser */
+} pdict_hash_function;
+
+/**
+ * @brief Occupancy of the entry slabs of a dict. See pdict_get_slab_stats().
+ */
+typedef struct {
+	size_t slab_count;     /* Slabs held by the dict */
+	size_t entry_capacity; /* Entries the slabs can hold */
+	size_t entries_in_use; /* Entries holding a key */
+	size_t entries_free;   /* Entries waiting on the free list for reuse */
+	size_t bytes;          /* Memory held by the slabs */
+} pdict_slab_stats_t;
+
 /* --- Public API Function Prototypes --- */
 
 /* plist_t setup and packdown*/
 pdict_t *pdict_create(long int initial_capacity);
+pdict_t *pdict_create_with_backend(long int initial_capacity, pdict_backend backend);
+pdict_t *pdict_create_in(pvars_arena_t *arena, long int initial_capacity);
+pdict_t *pdict_create_with_allocator(const pvars_allocator_t *allocator, long int initial_capacity);
 pdict_t *pdict_copy(const pdict_t *src);
 
 /* Cleanup functions */
@@ -16,6 +46,23 @@ void pdict_destroy(pdict_t *dict);
 void pdict_empty(pdict_t *dict);
 
 void pdict_remove(pdict_t *dict, const char *key);
+bool pdict_pop(pdict_t *dict, const char *key, pvar_t *out_value);
+
+/* Sizing */
+void pdict_reserve(pdict_t *dict, size_t expected_count);
+void pdict_shrink_to_fit(pdict_t *dict);
+bool pdict_get_slab_stats(const pdict_t *dict, pdict_slab_stats_t *out_stats);
+void pdict_set_max_load_factor(pdict_t *dict, double max_load_factor);
+double pdict_get_max_load_factor(const pdict_t *dict);
+
+/* Hashing */
+void pdict_set_hash_function(pdict_t *dict, pdict_hash_function hash_function);
+pdict_hash_function pdict_get_hash_function(const pdict_t *dict);
+void pdict_set_hash_seed(pdict_t *dict, uint64_t seed);
+
+/* Backend selection */
+void pdict_set_default_backend(pdict_backend backend);
+pdict_backend pdict_get_backend(const pdict_t *dict);
 
 /* Functions that act on plist_t variables */
 void pdict_print(const pdict_t *dict);
@@ -28,6 +75,7 @@ pvar_type pdict_get_type(const pdict_t *dict, const char *key);
 
 /* Core Add element functions (SINGLE ITEM ONLY) */
 void pdict_add_str(pdict_t *dict, const char *key, const char *value);
+void pdict_add_strn(pdict_t *dict, const char *key, const char *value, size_t len);
 void pdict_add_int(pdict_t *dict, const char *key, int value);
 void pdict_add_double(pdict_t *dict, const char *key, double value);
 void pdict_add_long(pdict_t *dict, const char *key, long value);
@@ -35,37 +83,48 @@ void pdict_add_float(pdict_t *dict, const char *key, float value);
 void pdict_add_list(pdict_t *dict, const char *key, const plist_t *value);
 void pdict_add_dict(pdict_t *dict, const char *key, const pdict_t *value);
 
+/* Ownership transferring add functions (no copy) */
+void pdict_add_list_take(pdict_t *dict, const char *key, plist_t *value);
+void pdict_add_dict_take(pdict_t *dict, const char *key, pdict_t *value);
+
 /* Data Extraction */
 bool pdict_contains(const pdict_t *dict, const char *key);
 plist_t *pdict_get_keys(const pdict_t * dict);
 plist_t *pdict_get_values(const pdict_t *dict);
 
 /* String accessors */
-bool pdict_get_str(pdict_t *dict, const char *key, char **out_value);
+bool pdict_get_str(const pdict_t *dict, const char *key, char **out_value);
+bool pdict_borrow_str(const pdict_t *dict, const char *key, const char **out_value);
+bool pdict_borrow_strn(const pdict_t *dict, const char *key, const char **out_value, size_t *out_len);
 void pdict_set_str(pdict_t *list, const char *key, const char *new_string);
+void pdict_set_strn(pdict_t *dict, const char *key, const char *value, size_t len);
 
 /* List accessors */
-bool pdict_get_list(pdict_t *dict, const char *key, plist_t **out_value);
+bool pdict_get_list(const pdict_t *dict, const char *key, plist_t **out_value);
+bool pdict_borrow_list(const pdict_t *dict, const char *key, const plist_t **out_value);
 void pdict_set_list(pdict_t *dict, const char *key, const plist_t *value);
+void pdict_set_list_take(pdict_t *dict, const char *key, plist_t *value);
 
 /* Dict accessors */
-bool pdict_get_dict(pdict_t *dict, const char *key, pdict_t **out_value);
+bool pdict_get_dict(const pdict_t *dict, const char *key, pdict_t **out_value);
+bool pdict_borrow_dict(const pdict_t *dict, const char *key, const pdict_t **out_value);
 void pdict_set_dict(pdict_t *dict, const char *key, const pdict_t *value);
+void pdict_set_dict_take(pdict_t *dict, const char *key, pdict_t *value);
 
 /* Int accessor */
-bool pdict_get_int(pdict_t *dict, const char *key, int *out_value);
+bool pdict_get_int(const pdict_t *dict, const char *key, int *out_value);
 void pdict_set_int(pdict_t *dict, const char *key, int value);
 
 /* Double accessor */
-bool pdict_get_double(pdict_t *dict, const char *key, double *out_value);
+bool pdict_get_double(const pdict_t *dict, const char *key, double *out_value);
 void pdict_set_double(pdict_t *dict, const char *key, double value);
 
 /* Long accessor */
-bool pdict_get_long(pdict_t *dict, const char *key, long *out_value);
+bool pdict_get_long(const pdict_t *dict, const char *key, long *out_value);
 void pdict_set_long(pdict_t *dict, const char *key, long value);
 
 /* Float accessor */
-bool pdict_get_float(pdict_t *dict, const char *key, float *out_value);
+bool pdict_get_float(const pdict_t *dict, const char *key, float *out_value);
 void pdict_set_float(pdict_t *dict, const char *key, float value);
 
 #endif
@@ -3,30 +3,132 @@
 
 #include"pvars.h"
 #include"plist_internal.h"
+#include"phash_internal.h"
+#include"pstr_internal.h"
+#include"pintern_internal.h"
+#include"pshare_internal.h"
 
 /**
  * @brief Represents a single key-value pair in the dictionary.
- * The key is always a dynamically allocated string (char *).
+ * The key is always a length-prefixed string made by pstr_create().
  * The value is a pvar_t, allowing it to hold any type.
  */
 typedef struct pdict_entry_t {
-	char *key;           // The dictionary key (dynamically allocated string)
+	char *key;           // The dictionary key, see pstr_create(). Its length is in the header
+	size_t hash;         // Full hash of the key, see pdict_hash_key()
 	pvar_t value;        // The dictionary value (can be any pvar_t type)
 	struct pdict_entry_t *next; // Pointer for separate chaining (linked list)
 } pdict_entry_t;
 
+/**
+ * @brief A slot of a PDICT_BACKEND_FLAT table. Its state (empty, deleted or
+ * full) is kept in the matching control byte, not in the slot itself.
+ */
+typedef struct {
+	char *key;      // The dictionary key, see pstr_create(). Its length is in the header
+	size_t hash;    // Full hash of the key, reused when the table is resized
+	pvar_t value;   // The dictionary value
+} pdict_slot_t;
+
+/**
+ * @brief A key being looked up. Its length and hash are computed once per
+ * call and then compared against the cached values of stored entries, so
+ * the key bytes are only compared when both match.
+ */
+typedef struct {
+	const char *str;
+	size_t len;
+	size_t hash;
+	bool stored;  // str is a key stored in another dict, see pdict_key_clone()
+} pdict_key_t;
+
+#define PDICT_DEFAULT_MAX_LOAD_FACTOR 0.75
+#define PDICT_REHASH_STEP 4 /* Old buckets migrated per insert/remove during a rehash */
+#define PDICT_GROUP_WIDTH 16 /* Control bytes probed at once by PDICT_BACKEND_FLAT */
+#define PDICT_FLAT_MAX_LOAD_FACTOR 0.875 /* Upper bound on the load factor of PDICT_BACKEND_FLAT */
+#define PDICT_SLAB_MIN_ENTRIES 16 /* Entries in the first slab of a PDICT_BACKEND_CHAINED dict */
+#define PDICT_SLAB_MAX_ENTRIES 1024 /* Largest slab of a PDICT_BACKEND_CHAINED dict */
+
+typedef struct pdict_slab_t pdict_slab_t;
+
 /**
  * @brief The full definition of the dictionary structure (Hash Table).
  * This is hidden from the user.
+ *
+ * The bucket count is always a power of two, so a bucket is picked by masking
+ * the key hash rather than dividing it.
+ *
+ * When the load factor is exceeded the dict doubles 'buckets' and keeps the
+ * previous array in 'old_buckets'. Each insert/remove then migrates a few of
+ * the old buckets, so the cost of growing is spread over many operations.
+ * Lookups search both arrays until the migration finishes.
+ *
+ * Entries of a PDICT_BACKEND_CHAINED dict come from per-dict slabs and are
+ * recycled through 'free_entries' (see src/pdict_slab.c).
+ *
+ * A PDICT_BACKEND_FLAT dict leaves the bucket fields unused and stores its
+ * entries inline in 'slots' instead (see src/pdict_flat.c).
  */
 struct pdict_t {
 	pdict_entry_t **buckets; // Array of pointers to pdict_entry_t (the buckets)
-	size_t count;            // Number of elements currently in the dictionary
+	size_t count;            // Number of elements currently in the dictionary (both tables)
 	size_t capacity;         // Size of the 'buckets' array (number of slots)
-	// You'll need a load factor and resize logic later, but this is enough for now.
+	pdict_entry_t **old_buckets; // Table being drained by an incremental rehash, NULL when idle
+	size_t old_capacity;     // Size of the 'old_buckets' array
+	size_t rehash_index;     // Next bucket of 'old_buckets' to migrate
+	double max_load_factor;  // Grow once count > capacity * max_load_factor
+	pdict_backend backend;   // Storage layout, fixed at creation
+	pdict_hash_function hash_function; // Hash used for keys, see pdict_hash_key()
+	uint64_t seed;           // Per-dict hash seed, random unless set by pdict_set_hash_seed()
+	unsigned char *ctrl;     // PDICT_BACKEND_FLAT: capacity + PDICT_GROUP_WIDTH control bytes
+	pdict_slot_t *slots;     // PDICT_BACKEND_FLAT: 'capacity' slots
+	size_t growth_left;      // PDICT_BACKEND_FLAT: EMPTY slots that may still be filled before growing
+	const pvars_allocator_t *allocator; // Allocator of the dict's memory, possibly an arena's
+	bool intern_keys;        // Keys come from the process wide pool, see pvars_set_key_interning()
+	pdict_slab_t *slabs;     // PDICT_BACKEND_CHAINED: entry slabs, newest first
+	pdict_entry_t *free_entries; // PDICT_BACKEND_CHAINED: unused slab entries, linked through 'next'
+	size_t slab_count;       // Number of slabs
+	size_t slab_capacity;    // Entries across all slabs
+	size_t free_count;       // Entries on 'free_entries'
+	pshare_t *_Atomic share; // Handles sharing the entries after pdict_copy(), NULL if never shared. Must stay last
 };
 
-size_t pdict_hash(const char *key, size_t capacity);
+/**
+ * @brief Cursor over every key/value pair of a dict. See pdict_iter_init().
+ */
+typedef struct {
+	const pdict_t *dict;
+	size_t bucket;        // Next bucket (or flat slot) to visit, counting old_buckets first
+	pdict_entry_t *entry; // Next entry to return
+} pdict_iter_t;
+
+size_t pdict_hash_key(const pdict_t *dict, const char *key, size_t len);
+void pdict_key_init(pdict_key_t *lookup, const pdict_t *dict, const char *key);
+char *pdict_key_create(pdict_t *dict, const char *bytes, size_t len);
+char *pdict_key_clone(pdict_t *dict, char *key);
+void pdict_key_free(pdict_t *dict, char *key);
 void pdict_print_internal(const pdict_t *dict);
+pdict_t *pdict_copy_in(const pvars_allocator_t *allocator, const pdict_t *src);
+pdict_t *pdict_create_sized(const pvars_allocator_t *allocator, size_t count);
+void pdict_iter_init(pdict_iter_t *iter, const pdict_t *dict);
+bool pdict_iter_next(pdict_iter_t *iter, const char **out_key, pvar_t **out_value);
+bool pdict_insert_take(pdict_t *dict, const char *key, size_t len, const pvar_t *value, perrno_t exists_failure, perrno_t alloc_failure);
+
+/* PDICT_BACKEND_FLAT engine (src/pdict_flat.c) */
+size_t pdict_flat_capacity_for(const pdict_t *dict, size_t count);
+bool pdict_flat_init(pdict_t *dict, size_t capacity);
+bool pdict_flat_resize(pdict_t *dict, size_t new_capacity);
+pvar_t *pdict_flat_find(const pdict_t *dict, const pdict_key_t *lookup);
+bool pdict_flat_insert(pdict_t *dict, const pdict_key_t *lookup, char *key, const pvar_t *value);
+bool pdict_flat_erase(pdict_t *dict, const pdict_key_t *lookup, pvar_t *out_value);
+void pdict_flat_clear(pdict_t *dict);
+bool pdict_flat_is_full(const pdict_t *dict, size_t index);
+
+/* PDICT_BACKEND_CHAINED entry slabs (src/pdict_slab.c) */
+pdict_entry_t *pdict_slab_alloc(pdict_t *dict);
+bool pdict_slab_reserve(pdict_t *dict, size_t count);
+void pdict_slab_release(pdict_t *dict, pdict_entry_t *entry);
+void pdict_slab_trim(pdict_t *dict);
+void pdict_slab_destroy(pdict_t *dict);
 
 #endif
@@ -17,15 +17,30 @@ typedef enum {
 	FAILURE_PLIST_ADD_STR_NULL_STRING_INPUT,
 	FAILURE_PLIST_ADD_STR_PLIST_ENSURE_CAPACITY_FAILED,
 	FAILURE_PLIST_ADD_STR_STRDUP_FAILED,
+	FAILURE_PLIST_ADD_STRN_NULL_INPUT_LIST,
+	FAILURE_PLIST_ADD_STRN_NULL_STRING_INPUT,
+	FAILURE_PLIST_ADD_STRN_STRDUP_FAILED,
 	FAILURE_PLIST_GET_STR_NULL_INPUT,
 	FAILURE_PLIST_GET_STR_OUT_OF_BOUNDS,
 	FAILURE_PLIST_GET_STR_NULL_INPUT_OUT_VALUE,
 	FAILURE_PLIST_GET_STR_WRONG_TYPE,
 	FAILURE_PLIST_GET_STR_STRDUP_FAILED,
+	FAILURE_PLIST_BORROW_STR_NULL_INPUT,
+	FAILURE_PLIST_BORROW_STR_OUT_OF_BOUNDS,
+	FAILURE_PLIST_BORROW_STR_NULL_INPUT_OUT_VALUE,
+	FAILURE_PLIST_BORROW_STR_WRONG_TYPE,
+	FAILURE_PLIST_BORROW_STRN_NULL_INPUT,
+	FAILURE_PLIST_BORROW_STRN_OUT_OF_BOUNDS,
+	FAILURE_PLIST_BORROW_STRN_NULL_INPUT_OUT_VALUE,
+	FAILURE_PLIST_BORROW_STRN_WRONG_TYPE,
 	FAILURE_PLIST_SET_STR_NULL_INPUT,
 	FAILURE_PLIST_SET_STR_OUT_OF_BOUNDS,
 	FAILURE_PLIST_SET_STR_NULL_STRING_INPUT,
 	FAILURE_PLIST_SET_STR_STRDUP_FAILED,
+	FAILURE_PLIST_SET_STRN_NULL_INPUT,
+	FAILURE_PLIST_SET_STRN_OUT_OF_BOUNDS,
+	FAILURE_PLIST_SET_STRN_NULL_STRING_INPUT,
+	FAILURE_PLIST_SET_STRN_STRDUP_FAILED,
 
 	/* plist_add_int / plist_get_int / plist_set_int Failures */
 	FAILURE_PLIST_ADD_INT_NULL_INPUT,
@@ -68,40 +83,169 @@ typedef enum {
 	FAILURE_PLIST_ADD_LIST_NULL_LIST_INPUT,
 	FAILURE_PLIST_ADD_LIST_PLIST_ENSURE_CAPACITY_FAILED,
 	FAILURE_PLIST_ADD_LIST_PLIST_COPY_FAILED,
+	FAILURE_PLIST_ADD_LIST_TAKE_NULL_INPUT,
+	FAILURE_PLIST_ADD_LIST_TAKE_NULL_LIST_INPUT,
+	FAILURE_PLIST_ADD_LIST_TAKE_ALLOCATOR_MISMATCH,
+	FAILURE_PLIST_ADD_LIST_TAKE_SELF_INSERT,
 	FAILURE_PLIST_GET_LIST_NULL_INPUT,
 	FAILURE_PLIST_GET_LIST_OUT_OF_BOUNDS,
 	FAILURE_PLIST_GET_LIST_NULL_INPUT_OUT_VALUE,
 	FAILURE_PLIST_GET_LIST_WRONG_TYPE,
 	FAILURE_PLIST_GET_LIST_PLIST_COPY_FAILED,
+	FAILURE_PLIST_BORROW_LIST_NULL_INPUT,
+	FAILURE_PLIST_BORROW_LIST_OUT_OF_BOUNDS,
+	FAILURE_PLIST_BORROW_LIST_NULL_INPUT_OUT_VALUE,
+	FAILURE_PLIST_BORROW_LIST_WRONG_TYPE,
 	FAILURE_PLIST_SET_LIST_NULL_INPUT,
 	FAILURE_PLIST_SET_LIST_OUT_OF_BOUNDS,
 	FAILURE_PLIST_SET_LIST_NULL_LIST_INPUT,
 	FAILURE_PLIST_SET_LIST_PLIST_COPY_FAILED,
+	FAILURE_PLIST_SET_LIST_TAKE_NULL_INPUT,
+	FAILURE_PLIST_SET_LIST_TAKE_OUT_OF_BOUNDS,
+	FAILURE_PLIST_SET_LIST_TAKE_NULL_LIST_INPUT,
+	FAILURE_PLIST_SET_LIST_TAKE_ALLOCATOR_MISMATCH,
+	FAILURE_PLIST_SET_LIST_TAKE_SELF_INSERT,
 	
 	/* plist_add_dict plist_get_dict Failures */
 	FAILURE_PLIST_ADD_DICT_NULL_INPUT,
 	FAILURE_PLIST_ADD_DICT_NULL_DICT_INPUT,
 	FAILURE_PLIST_ADD_DICT_PLIST_ENSURE_CAPACITY_FAILED,
 	FAILURE_PLIST_ADD_DICT_PDICT_COPY_FAILED,
+	FAILURE_PLIST_ADD_DICT_TAKE_NULL_INPUT,
+	FAILURE_PLIST_ADD_DICT_TAKE_NULL_DICT_INPUT,
+	FAILURE_PLIST_ADD_DICT_TAKE_ALLOCATOR_MISMATCH,
 	FAILURE_PLIST_GET_DICT_NULL_INPUT,
 	FAILURE_PLIST_GET_DICT_OUT_OF_BOUNDS,
 	FAILURE_PLIST_GET_DICT_WRONG_TYPE,
 	FAILURE_PLIST_GET_DICT_NULL_INPUT_OUT_VALUE,
 	FAILURE_PLIST_GET_DICT_PDICT_COPY_FAILED,
+	FAILURE_PLIST_BORROW_DICT_NULL_INPUT,
+	FAILURE_PLIST_BORROW_DICT_OUT_OF_BOUNDS,
+	FAILURE_PLIST_BORROW_DICT_NULL_INPUT_OUT_VALUE,
+	FAILURE_PLIST_BORROW_DICT_WRONG_TYPE,
 	FAILURE_PLIST_SET_DICT_NULL_INPUT,
 	FAILURE_PLIST_SET_DICT_OUT_OF_BOUNDS,
 	FAILURE_PLIST_SET_DICT_NULL_DICT_INPUT,
 	FAILURE_PLIST_SET_DICT_PDICT_COPY_FAILED,
+	FAILURE_PLIST_SET_DICT_TAKE_NULL_INPUT,
+	FAILURE_PLIST_SET_DICT_TAKE_OUT_OF_BOUNDS,
+	FAILURE_PLIST_SET_DICT_TAKE_NULL_DICT_INPUT,
+	FAILURE_PLIST_SET_DICT_TAKE_ALLOCATOR_MISMATCH,
 	
 	/* plist_add_pvar Failures */
 	FAILURE_PLIST_ADD_PVAR_NULL_INPUT,
 	FAILURE_PLIST_ADD_PVAR_NULL_PVAR_INPUT,
 	FAILURE_PLIST_ADD_PVAR_PLIST_ENSURE_CAPACITY_FAILED,
 	FAILURE_PLIST_ADD_PVAR_PVAR_COPY_FAILED,
+
+	/* plist_extend_* Failures */
+	FAILURE_PLIST_EXTEND_INTS_NULL_INPUT,
+	FAILURE_PLIST_EXTEND_INTS_NULL_VALUES_INPUT,
+	FAILURE_PLIST_EXTEND_INTS_REALLOC_FAILED,
+	FAILURE_PLIST_EXTEND_LONGS_NULL_INPUT,
+	FAILURE_PLIST_EXTEND_LONGS_NULL_VALUES_INPUT,
+	FAILURE_PLIST_EXTEND_LONGS_REALLOC_FAILED,
+	FAILURE_PLIST_EXTEND_DOUBLES_NULL_INPUT,
+	FAILURE_PLIST_EXTEND_DOUBLES_NULL_VALUES_INPUT,
+	FAILURE_PLIST_EXTEND_DOUBLES_REALLOC_FAILED,
+	FAILURE_PLIST_EXTEND_FLOATS_NULL_INPUT,
+	FAILURE_PLIST_EXTEND_FLOATS_NULL_VALUES_INPUT,
+	FAILURE_PLIST_EXTEND_FLOATS_REALLOC_FAILED,
+	FAILURE_PLIST_EXTEND_STRS_NULL_INPUT,
+	FAILURE_PLIST_EXTEND_STRS_NULL_VALUES_INPUT,
+	FAILURE_PLIST_EXTEND_STRS_NULL_STRING_INPUT,
+	FAILURE_PLIST_EXTEND_STRS_REALLOC_FAILED,
+	FAILURE_PLIST_EXTEND_STRS_STRDUP_FAILED,
+	FAILURE_PLIST_EXTEND_PVARS_NULL_INPUT,
+	FAILURE_PLIST_EXTEND_PVARS_NULL_VALUES_INPUT,
+	FAILURE_PLIST_EXTEND_PVARS_REALLOC_FAILED,
+	FAILURE_PLIST_EXTEND_PVARS_PVAR_COPY_FAILED,
+	FAILURE_PLIST_EXTEND_NULL_INPUT,
+	FAILURE_PLIST_EXTEND_NULL_LIST_INPUT,
+	FAILURE_PLIST_EXTEND_REALLOC_FAILED,
+	FAILURE_PLIST_EXTEND_PVAR_COPY_FAILED,
+
+	/* plist_insert_* Failures */
+	FAILURE_PLIST_INSERT_STR_NULL_INPUT_LIST,
+	FAILURE_PLIST_INSERT_STR_NULL_STRING_INPUT,
+	FAILURE_PLIST_INSERT_STR_OUT_OF_BOUNDS,
+	FAILURE_PLIST_INSERT_STR_STRDUP_FAILED,
+	FAILURE_PLIST_INSERT_STRN_NULL_INPUT_LIST,
+	FAILURE_PLIST_INSERT_STRN_NULL_STRING_INPUT,
+	FAILURE_PLIST_INSERT_STRN_OUT_OF_BOUNDS,
+	FAILURE_PLIST_INSERT_STRN_STRDUP_FAILED,
+	FAILURE_PLIST_INSERT_INT_NULL_INPUT,
+	FAILURE_PLIST_INSERT_INT_OUT_OF_BOUNDS,
+	FAILURE_PLIST_INSERT_LONG_NULL_INPUT,
+	FAILURE_PLIST_INSERT_LONG_OUT_OF_BOUNDS,
+	FAILURE_PLIST_INSERT_DOUBLE_NULL_INPUT,
+	FAILURE_PLIST_INSERT_DOUBLE_OUT_OF_BOUNDS,
+	FAILURE_PLIST_INSERT_FLOAT_NULL_INPUT,
+	FAILURE_PLIST_INSERT_FLOAT_OUT_OF_BOUNDS,
+	FAILURE_PLIST_INSERT_LIST_NULL_INPUT,
+	FAILURE_PLIST_INSERT_LIST_NULL_LIST_INPUT,
+	FAILURE_PLIST_INSERT_LIST_OUT_OF_BOUNDS,
+	FAILURE_PLIST_INSERT_LIST_PLIST_COPY_FAILED,
+	FAILURE_PLIST_INSERT_DICT_NULL_INPUT,
+	FAILURE_PLIST_INSERT_DICT_NULL_DICT_INPUT,
+	FAILURE_PLIST_INSERT_DICT_OUT_OF_BOUNDS,
+	FAILURE_PLIST_INSERT_DICT_PDICT_COPY_FAILED,
+	FAILURE_PLIST_INSERT_PVAR_NULL_INPUT,
+	FAILURE_PLIST_INSERT_PVAR_NULL_PVAR_INPUT,
+	FAILURE_PLIST_INSERT_PVAR_OUT_OF_BOUNDS,
+	FAILURE_PLIST_INSERT_PVAR_PVAR_COPY_FAILED,
+	FAILURE_PLIST_INSERT_LIST_TAKE_NULL_INPUT,
+	FAILURE_PLIST_INSERT_LIST_TAKE_NULL_LIST_INPUT,
+	FAILURE_PLIST_INSERT_LIST_TAKE_OUT_OF_BOUNDS,
+	FAILURE_PLIST_INSERT_LIST_TAKE_ALLOCATOR_MISMATCH,
+	FAILURE_PLIST_INSERT_LIST_TAKE_SELF_INSERT,
+	FAILURE_PLIST_INSERT_DICT_TAKE_NULL_INPUT,
+	FAILURE_PLIST_INSERT_DICT_TAKE_NULL_DICT_INPUT,
+	FAILURE_PLIST_INSERT_DICT_TAKE_OUT_OF_BOUNDS,
+	FAILURE_PLIST_INSERT_DICT_TAKE_ALLOCATOR_MISMATCH,
+
+	/* plist sizing Failures */
+	FAILURE_PLIST_RESERVE_NULL_INPUT,
+	FAILURE_PLIST_RESERVE_REALLOC_FAILED,
+	FAILURE_PLIST_SHRINK_TO_FIT_NULL_INPUT,
+	FAILURE_PLIST_SHRINK_TO_FIT_REALLOC_FAILED,
+	FAILURE_PLIST_SET_GROWTH_POLICY_NULL_INPUT,
+	FAILURE_PLIST_SET_GROWTH_POLICY_UNKNOWN_POLICY,
+	FAILURE_PLIST_SET_GROWTH_POLICY_CHUNK_OUT_OF_BOUNDS,
+
+	/* Typed list Failures */
+	FAILURE_PLIST_CREATE_TYPED_UNSUPPORTED_TYPE,
+	FAILURE_PLIST_TYPED_LIST_TYPE_MISMATCH,
+	FAILURE_PLIST_BORROW_SPAN_NULL_INPUT,
+	FAILURE_PLIST_BORROW_SPAN_NOT_TYPED,
+	FAILURE_PLIST_BORROW_SPAN_MUTABLE_NULL_INPUT,
+	FAILURE_PLIST_BORROW_SPAN_MUTABLE_NOT_TYPED,
+
+	/* Numeric reduction Failures */
+	FAILURE_PLIST_SUM_NULL_INPUT,
+	FAILURE_PLIST_SUM_NOT_NUMERIC,
+	FAILURE_PLIST_MIN_NULL_INPUT,
+	FAILURE_PLIST_MIN_EMPTY_LIST,
+	FAILURE_PLIST_MIN_NOT_NUMERIC,
+	FAILURE_PLIST_MAX_NULL_INPUT,
+	FAILURE_PLIST_MAX_EMPTY_LIST,
+	FAILURE_PLIST_MAX_NOT_NUMERIC,
+	FAILURE_PLIST_MEAN_NULL_INPUT,
+	FAILURE_PLIST_MEAN_EMPTY_LIST,
+	FAILURE_PLIST_MEAN_NOT_NUMERIC,
+	FAILURE_PLIST_VARIANCE_NULL_INPUT,
+	FAILURE_PLIST_VARIANCE_EMPTY_LIST,
+	FAILURE_PLIST_VARIANCE_NOT_NUMERIC,
 	
 	/* plist_contains Failures */
 	FAILURE_PLIST_CONTAINS_NULL_INPUT,
 	
+	/* plist_set_indexed / plist_index_of / plist_count_of Failures */
+	FAILURE_PLIST_SET_INDEXED_NULL_INPUT,
+	FAILURE_PLIST_INDEX_OF_NULL_INPUT,
+	FAILURE_PLIST_INDEX_OF_NOT_FOUND,
+	FAILURE_PLIST_COUNT_OF_NULL_INPUT,
+	
 	/* plist_get_type Failures */
 	FAILURE_PLIST_GET_TYPE_NULL_INPUT,
 	FAILURE_PLIST_GET_TYPE_OUT_OF_BOUNDS,
@@ -112,6 +256,7 @@ typedef enum {
 	FAILURE_PVAR_COPY_NULL_INPUT,
 	FAILURE_PVAR_COPY_STRDUP_FAILED,
 	FAILURE_PVAR_COPY_PLIST_COPY_FAILED,
+	FAILURE_PVAR_COPY_PDICT_COPY_FAILED,
 	
 	/* plist_copy Failures */
 	FAILURE_PLIST_COPY_NULL_INPUT,
@@ -123,11 +268,33 @@ typedef enum {
 	FAILURE_PLIST_PRINT_INTERNAL_NULL_INPUT_LIST_DATA,
 	FAILURE_PLIST_REMOVE_NULL_INPUT,
 	FAILURE_PLIST_REMOVE_OUT_OF_BOUNDS,
+	FAILURE_PLIST_POP_NULL_INPUT,
+	FAILURE_PLIST_POP_OUT_OF_BOUNDS,
+	FAILURE_PLIST_POP_NULL_INPUT_OUT_VALUE,
+	FAILURE_PLIST_POP_STRDUP_FAILED,
+	FAILURE_PLIST_REMOVE_RANGE_NULL_INPUT,
+	FAILURE_PLIST_REMOVE_RANGE_OUT_OF_BOUNDS,
+	FAILURE_PLIST_REMOVE_IF_NULL_INPUT,
+	FAILURE_PLIST_SWAP_REMOVE_NULL_INPUT,
+	FAILURE_PLIST_SWAP_REMOVE_OUT_OF_BOUNDS,
 	
 	/* pdict_create Failures */
 	FAILURE_PDICT_CREATE_CAPACITY_OUT_OF_BOUNDS,
 	FAILURE_PDICT_CREATE_NEW_DICT_MALLOC_FAILED,
 	FAILURE_PDICT_CREATE_NEW_DICT_BUCKETS_MALLOC_FAILED,
+	FAILURE_PDICT_CREATE_UNKNOWN_BACKEND,
+	
+	/* pdict backend selection Failures */
+	FAILURE_PDICT_SET_DEFAULT_BACKEND_UNKNOWN_BACKEND,
+	FAILURE_PDICT_GET_BACKEND_NULL_INPUT,
+	
+	/* pdict hash selection Failures */
+	FAILURE_PDICT_SET_HASH_FUNCTION_NULL_INPUT,
+	FAILURE_PDICT_SET_HASH_FUNCTION_UNKNOWN_FUNCTION,
+	FAILURE_PDICT_SET_HASH_FUNCTION_REHASH_MALLOC_FAILED,
+	FAILURE_PDICT_GET_HASH_FUNCTION_NULL_INPUT,
+	FAILURE_PDICT_SET_HASH_SEED_NULL_INPUT,
+	FAILURE_PDICT_SET_HASH_SEED_REHASH_MALLOC_FAILED,
 	
 	/* pdict_entry_copy Failures */
 	FAILURE_PDICT_ENTRY_COPY_NULL_INPUT,
@@ -144,6 +311,23 @@ typedef enum {
 	FAILURE_PDICT_REMOVE_NULL_INPUT_DICT,
 	FAILURE_PDICT_REMOVE_NULL_INPUT_KEY,
 	FAILURE_PDICT_REMOVE_KEY_NOT_FOUND,
+	FAILURE_PDICT_POP_NULL_INPUT_DICT,
+	FAILURE_PDICT_POP_NULL_INPUT_KEY,
+	FAILURE_PDICT_POP_NULL_INPUT_OUT_VALUE,
+	FAILURE_PDICT_POP_KEY_NOT_FOUND,
+	FAILURE_PDICT_POP_STRDUP_FAILED,
+	
+	/* pdict_reserve pdict_shrink_to_fit pdict_set_max_load_factor Failures */
+	FAILURE_PDICT_RESERVE_NULL_INPUT,
+	FAILURE_PDICT_RESERVE_BUCKETS_MALLOC_FAILED,
+	FAILURE_PDICT_SHRINK_TO_FIT_NULL_INPUT,
+	FAILURE_PDICT_SHRINK_TO_FIT_BUCKETS_MALLOC_FAILED,
+	FAILURE_PDICT_SET_MAX_LOAD_FACTOR_NULL_INPUT,
+	FAILURE_PDICT_SET_MAX_LOAD_FACTOR_OUT_OF_BOUNDS,
+	
+	/* pdict_get_slab_stats Failures */
+	FAILURE_PDICT_GET_SLAB_STATS_NULL_INPUT,
+	FAILURE_PDICT_GET_SLAB_STATS_NULL_INPUT_OUT_VALUE,
 	
 	/* pdict_print pdict_print_internal Failures */
 	FAILURE_PDICT_PRINT_INTERNAL_NULL_INPUT,
@@ -157,17 +341,39 @@ typedef enum {
 	FAILURE_PDICT_ADD_STR_ENTRY_MALLOC_FAILED,
 	FAILURE_PDICT_ADD_STR_KEY_STRDUP_FAILED,
 	FAILURE_PDICT_ADD_STR_VALUE_STRDUP_FAILED,
+	FAILURE_PDICT_ADD_STRN_NULL_INPUT_DICT,
+	FAILURE_PDICT_ADD_STRN_NULL_INPUT_KEY,
+	FAILURE_PDICT_ADD_STRN_NULL_INPUT_VALUE,
+	FAILURE_PDICT_ADD_STRN_KEY_EXISTS,
+	FAILURE_PDICT_ADD_STRN_ENTRY_MALLOC_FAILED,
+	FAILURE_PDICT_ADD_STRN_KEY_STRDUP_FAILED,
+	FAILURE_PDICT_ADD_STRN_VALUE_STRDUP_FAILED,
 	FAILURE_PDICT_GET_STR_NULL_INPUT_DICT,
 	FAILURE_PDICT_GET_STR_NULL_INPUT_KEY,
 	FAILURE_PDICT_GET_STR_NULL_INPUT_OUT_VALUE,
 	FAILURE_PDICT_GET_STR_WRONG_TYPE,
 	FAILURE_PDICT_GET_STR_STRDUP_FAILED,
 	FAILURE_PDICT_GET_STR_KEY_NOT_FOUND,
+	FAILURE_PDICT_BORROW_STR_NULL_INPUT_DICT,
+	FAILURE_PDICT_BORROW_STR_NULL_INPUT_KEY,
+	FAILURE_PDICT_BORROW_STR_NULL_INPUT_OUT_VALUE,
+	FAILURE_PDICT_BORROW_STR_WRONG_TYPE,
+	FAILURE_PDICT_BORROW_STR_KEY_NOT_FOUND,
+	FAILURE_PDICT_BORROW_STRN_NULL_INPUT_DICT,
+	FAILURE_PDICT_BORROW_STRN_NULL_INPUT_KEY,
+	FAILURE_PDICT_BORROW_STRN_NULL_INPUT_OUT_VALUE,
+	FAILURE_PDICT_BORROW_STRN_WRONG_TYPE,
+	FAILURE_PDICT_BORROW_STRN_KEY_NOT_FOUND,
 	FAILURE_PDICT_SET_STR_NULL_INPUT_DICT,
 	FAILURE_PDICT_SET_STR_NULL_INPUT_KEY,
 	FAILURE_PDICT_SET_STR_NULL_INPUT_VALUE,
 	FAILURE_PDICT_SET_STR_VALUE_STRDUP_FAILED,
 	FAILURE_PDICT_SET_STR_VALUE_NOT_FOUND,
+	FAILURE_PDICT_SET_STRN_NULL_INPUT_DICT,
+	FAILURE_PDICT_SET_STRN_NULL_INPUT_KEY,
+	FAILURE_PDICT_SET_STRN_NULL_INPUT_VALUE,
+	FAILURE_PDICT_SET_STRN_VALUE_STRDUP_FAILED,
+	FAILURE_PDICT_SET_STRN_VALUE_NOT_FOUND,
 	
 	/* pdict_add_int pdict_get_int pdict_set_int Failures */
 	FAILURE_PDICT_ADD_INT_NULL_INPUT_DICT,
@@ -237,17 +443,34 @@ typedef enum {
 	FAILURE_PDICT_ADD_LIST_ENTRY_MALLOC_FAILED,
 	FAILURE_PDICT_ADD_LIST_KEY_STRDUP_FAILED,
 	FAILURE_PDICT_ADD_LIST_VALUE_PLIST_COPY_FAILED,
+	FAILURE_PDICT_ADD_LIST_TAKE_NULL_INPUT_DICT,
+	FAILURE_PDICT_ADD_LIST_TAKE_NULL_INPUT_KEY,
+	FAILURE_PDICT_ADD_LIST_TAKE_NULL_INPUT_VALUE,
+	FAILURE_PDICT_ADD_LIST_TAKE_ALLOCATOR_MISMATCH,
+	FAILURE_PDICT_ADD_LIST_TAKE_KEY_EXISTS,
+	FAILURE_PDICT_ADD_LIST_TAKE_ENTRY_MALLOC_FAILED,
+	FAILURE_PDICT_ADD_LIST_TAKE_KEY_STRDUP_FAILED,
 	FAILURE_PDICT_GET_LIST_NULL_INPUT_DICT,
 	FAILURE_PDICT_GET_LIST_NULL_INPUT_KEY,
 	FAILURE_PDICT_GET_LIST_NULL_INPUT_OUT_VALUE,
 	FAILURE_PDICT_GET_LIST_WRONG_TYPE,
 	FAILURE_PDICT_GET_LIST_PLIST_COPY_FAILED,
 	FAILURE_PDICT_GET_LIST_KEY_NOT_FOUND,
+	FAILURE_PDICT_BORROW_LIST_NULL_INPUT_DICT,
+	FAILURE_PDICT_BORROW_LIST_NULL_INPUT_KEY,
+	FAILURE_PDICT_BORROW_LIST_NULL_INPUT_OUT_VALUE,
+	FAILURE_PDICT_BORROW_LIST_WRONG_TYPE,
+	FAILURE_PDICT_BORROW_LIST_KEY_NOT_FOUND,
 	FAILURE_PDICT_SET_LIST_NULL_INPUT_DICT,
 	FAILURE_PDICT_SET_LIST_NULL_INPUT_KEY,
 	FAILURE_PDICT_SET_LIST_NULL_INPUT_VALUE,
 	FAILURE_PDICT_SET_LIST_VALUE_PLIST_COPY_FAILED,
 	FAILURE_PDICT_SET_LIST_VALUE_NOT_FOUND,
+	FAILURE_PDICT_SET_LIST_TAKE_NULL_INPUT_DICT,
+	FAILURE_PDICT_SET_LIST_TAKE_NULL_INPUT_KEY,
+	FAILURE_PDICT_SET_LIST_TAKE_NULL_INPUT_VALUE,
+	FAILURE_PDICT_SET_LIST_TAKE_ALLOCATOR_MISMATCH,
+	FAILURE_PDICT_SET_LIST_TAKE_VALUE_NOT_FOUND,
 	
 	/* pdict_add_dict pdict_get_dict pdict_set_dict Failures */
 	FAILURE_PDICT_ADD_DICT_NULL_INPUT_DICT,
@@ -257,17 +480,36 @@ typedef enum {
 	FAILURE_PDICT_ADD_DICT_ENTRY_MALLOC_FAILED,
 	FAILURE_PDICT_ADD_DICT_KEY_STRDUP_FAILED,
 	FAILURE_PDICT_ADD_DICT_VALUE_PDICT_COPY_FAILED,
+	FAILURE_PDICT_ADD_DICT_TAKE_NULL_INPUT_DICT,
+	FAILURE_PDICT_ADD_DICT_TAKE_NULL_INPUT_KEY,
+	FAILURE_PDICT_ADD_DICT_TAKE_NULL_INPUT_VALUE,
+	FAILURE_PDICT_ADD_DICT_TAKE_ALLOCATOR_MISMATCH,
+	FAILURE_PDICT_ADD_DICT_TAKE_KEY_EXISTS,
+	FAILURE_PDICT_ADD_DICT_TAKE_ENTRY_MALLOC_FAILED,
+	FAILURE_PDICT_ADD_DICT_TAKE_KEY_STRDUP_FAILED,
+	FAILURE_PDICT_ADD_DICT_TAKE_SELF_INSERT,
 	FAILURE_PDICT_GET_DICT_NULL_INPUT_DICT,
 	FAILURE_PDICT_GET_DICT_NULL_INPUT_KEY,
 	FAILURE_PDICT_GET_DICT_NULL_INPUT_OUT_VALUE,
 	FAILURE_PDICT_GET_DICT_WRONG_TYPE,
 	FAILURE_PDICT_GET_DICT_PDICT_COPY_FAILED,
 	FAILURE_PDICT_GET_DICT_KEY_NOT_FOUND,
+	FAILURE_PDICT_BORROW_DICT_NULL_INPUT_DICT,
+	FAILURE_PDICT_BORROW_DICT_NULL_INPUT_KEY,
+	FAILURE_PDICT_BORROW_DICT_NULL_INPUT_OUT_VALUE,
+	FAILURE_PDICT_BORROW_DICT_WRONG_TYPE,
+	FAILURE_PDICT_BORROW_DICT_KEY_NOT_FOUND,
 	FAILURE_PDICT_SET_DICT_NULL_INPUT_DICT,
 	FAILURE_PDICT_SET_DICT_NULL_INPUT_KEY,
 	FAILURE_PDICT_SET_DICT_NULL_INPUT_VALUE,
 	FAILURE_PDICT_SET_DICT_VALUE_PDICT_COPY_FAILED,
 	FAILURE_PDICT_SET_DICT_VALUE_NOT_FOUND,
+	FAILURE_PDICT_SET_DICT_TAKE_NULL_INPUT_DICT,
+	FAILURE_PDICT_SET_DICT_TAKE_NULL_INPUT_KEY,
+	FAILURE_PDICT_SET_DICT_TAKE_NULL_INPUT_VALUE,
+	FAILURE_PDICT_SET_DICT_TAKE_ALLOCATOR_MISMATCH,
+	FAILURE_PDICT_SET_DICT_TAKE_SELF_INSERT,
+	FAILURE_PDICT_SET_DICT_TAKE_VALUE_NOT_FOUND,
 	
 	/* pdict_get_type Failures */
 	FAILURE_PDICT_GET_TYPE_NULL_INPUT,
@@ -286,7 +528,109 @@ typedef enum {
 	/* pdict_get_values Failures */
 	FAILURE_PDICT_GET_VALUES_NULL_INPUT,
 	FAILURE_PDICT_GET_VALUES_PLIST_CREATE_FAILED,
-	FAILURE_PDICT_GET_VALUES_PLIST_ADD_PVAR_FAILED
+	FAILURE_PDICT_GET_VALUES_PLIST_ADD_PVAR_FAILED,
+	
+	/* pvars_arena_t Failures */
+	FAILURE_PVARS_ARENA_CREATE_CHUNK_SIZE_OUT_OF_BOUNDS,
+	FAILURE_PVARS_ARENA_CREATE_MALLOC_FAILED,
+	FAILURE_PVARS_ARENA_RESET_NULL_INPUT,
+	FAILURE_PVARS_ARENA_GET_USED_NULL_INPUT,
+	FAILURE_PVARS_ARENA_GET_CHUNK_COUNT_NULL_INPUT,
+	
+	/* pvars_set_allocator Failures */
+	FAILURE_PVARS_SET_ALLOCATOR_MISSING_HOOK,
+	
+	/* pvars_get_intern_stats Failures */
+	FAILURE_PVARS_GET_INTERN_STATS_NULL_INPUT_OUT_VALUE,
+	
+	/* pvars_buffer_t pvars_serialize pvars_deserialize Failures */
+	FAILURE_PVARS_BUFFER_INIT_NULL_INPUT,
+	FAILURE_PVARS_SERIALIZE_NULL_INPUT,
+	FAILURE_PVARS_SERIALIZE_UNKNOWN_TYPE,
+	FAILURE_PVARS_SERIALIZE_REALLOC_FAILED,
+	FAILURE_PVARS_DESERIALIZE_NULL_INPUT,
+	FAILURE_PVARS_DESERIALIZE_BAD_HEADER,
+	FAILURE_PVARS_DESERIALIZE_TRUNCATED,
+	FAILURE_PVARS_DESERIALIZE_MALFORMED,
+	FAILURE_PVARS_DESERIALIZE_TOO_DEEP,
+	FAILURE_PVARS_DESERIALIZE_ALLOC_FAILED,
+	
+	/* pvars_image_t pview_t Failures */
+	FAILURE_PVARS_IMAGE_WRITE_NULL_INPUT,
+	FAILURE_PVARS_IMAGE_WRITE_UNKNOWN_TYPE,
+	FAILURE_PVARS_IMAGE_WRITE_TOO_LARGE,
+	FAILURE_PVARS_IMAGE_WRITE_REALLOC_FAILED,
+	FAILURE_PVARS_IMAGE_OPEN_NULL_INPUT,
+	FAILURE_PVARS_IMAGE_OPEN_MISALIGNED,
+	FAILURE_PVARS_IMAGE_OPEN_BAD_HEADER,
+	FAILURE_PVARS_IMAGE_OPEN_MALLOC_FAILED,
+	FAILURE_PVARS_IMAGE_MAP_NULL_INPUT,
+	FAILURE_PVARS_IMAGE_MAP_OPEN_FAILED,
+	FAILURE_PVARS_IMAGE_MAP_MMAP_FAILED,
+	FAILURE_PVARS_IMAGE_MAP_BAD_HEADER,
+	FAILURE_PVARS_IMAGE_MAP_MALLOC_FAILED,
+	FAILURE_PVARS_IMAGE_ROOT_NULL_INPUT,
+	FAILURE_PVARS_IMAGE_CORRUPT,
+	FAILURE_PVIEW_GET_TYPE_NULL_INPUT,
+	FAILURE_PVIEW_GET_SIZE_NULL_INPUT,
+	FAILURE_PVIEW_GET_SIZE_WRONG_TYPE,
+	FAILURE_PVIEW_GET_COLUMN_TYPE_NULL_INPUT,
+	FAILURE_PVIEW_GET_COLUMN_TYPE_WRONG_TYPE,
+	FAILURE_PVIEW_LIST_GET_NULL_INPUT,
+	FAILURE_PVIEW_LIST_GET_WRONG_TYPE,
+	FAILURE_PVIEW_LIST_GET_OUT_OF_BOUNDS,
+	FAILURE_PVIEW_DICT_GET_NULL_INPUT,
+	FAILURE_PVIEW_DICT_GET_WRONG_TYPE,
+	FAILURE_PVIEW_DICT_GET_KEY_NOT_FOUND,
+	FAILURE_PVIEW_DICT_ENTRY_NULL_INPUT,
+	FAILURE_PVIEW_DICT_ENTRY_WRONG_TYPE,
+	FAILURE_PVIEW_DICT_ENTRY_OUT_OF_BOUNDS,
+	FAILURE_PVIEW_GET_INT_NULL_INPUT,
+	FAILURE_PVIEW_GET_INT_WRONG_TYPE,
+	FAILURE_PVIEW_GET_LONG_NULL_INPUT,
+	FAILURE_PVIEW_GET_LONG_WRONG_TYPE,
+	FAILURE_PVIEW_GET_DOUBLE_NULL_INPUT,
+	FAILURE_PVIEW_GET_DOUBLE_WRONG_TYPE,
+	FAILURE_PVIEW_GET_FLOAT_NULL_INPUT,
+	FAILURE_PVIEW_GET_FLOAT_WRONG_TYPE,
+	FAILURE_PVIEW_BORROW_STR_NULL_INPUT,
+	FAILURE_PVIEW_BORROW_STR_WRONG_TYPE,
+	FAILURE_PVIEW_BORROW_STRN_NULL_INPUT,
+	FAILURE_PVIEW_BORROW_STRN_WRONG_TYPE,
+	FAILURE_PVIEW_BORROW_SPAN_NULL_INPUT,
+	FAILURE_PVIEW_BORROW_SPAN_NOT_TYPED,
+	
+	/* pvars_parse_json Failures */
+	FAILURE_PVARS_PARSE_JSON_NULL_INPUT,
+	FAILURE_PVARS_PARSE_JSON_TOO_LARGE,
+	FAILURE_PVARS_PARSE_JSON_SYNTAX,
+	FAILURE_PVARS_PARSE_JSON_BAD_STRING,
+	FAILURE_PVARS_PARSE_JSON_BAD_NUMBER,
+	FAILURE_PVARS_PARSE_JSON_DUPLICATE_KEY,
+	FAILURE_PVARS_PARSE_JSON_TOO_DEEP,
+	FAILURE_PVARS_PARSE_JSON_ALLOC_FAILED,
+	
+	/* pvars_to_json pvars_to_json_fd Failures */
+	FAILURE_PVARS_TO_JSON_NULL_INPUT,
+	FAILURE_PVARS_TO_JSON_UNKNOWN_STYLE,
+	FAILURE_PVARS_TO_JSON_UNKNOWN_TYPE,
+	FAILURE_PVARS_TO_JSON_NOT_FINITE,
+	FAILURE_PVARS_TO_JSON_REALLOC_FAILED,
+	FAILURE_PVARS_TO_JSON_WRITE_FAILED,
+	
+	/* pvars_stream_t Failures */
+	FAILURE_PVARS_STREAM_CREATE_NULL_INPUT,
+	FAILURE_PVARS_STREAM_CREATE_UNKNOWN_FORMAT,
+	FAILURE_PVARS_STREAM_CREATE_MALLOC_FAILED,
+	FAILURE_PVARS_STREAM_FEED_NULL_INPUT,
+	FAILURE_PVARS_STREAM_FINISH_NULL_INPUT,
+	FAILURE_PVARS_STREAM_GET_OFFSET_NULL_INPUT,
+	FAILURE_PVARS_STREAM_STOPPED,
+	FAILURE_PVARS_STREAM_ALLOC_FAILED,
+	
+	/* Copy-on-write Failures */
+	FAILURE_PLIST_UNSHARE_COPY_FAILED,
+	FAILURE_PDICT_UNSHARE_COPY_FAILED
 	
 } perrno_t;
 
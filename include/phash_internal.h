@@ -0,0 +1,12 @@
+#ifndef PHASH_INTERNAL_H
+#define PHASH_INTERNAL_H
+
+#include<stddef.h>
+#include<stdint.h>
+
+/* Byte string hash functions shared by the containers */
+uint64_t phash_wyhash(const void *data, size_t len, uint64_t seed);
+uint64_t phash_djb2(const void *data, size_t len, uint64_t seed);
+uint64_t phash_random_seed(void);
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef PIMAGE_H
+#define PIMAGE_H
+
+#include<stdbool.h>
+#include<stddef.h>
+#include<stdint.h>
+
+/**
+ * @brief OPAQUE DATA TYPE: a read-only document laid out to be used in
+ * place, from memory or from a mapped file, without being decoded.
+ * Made by pvars_image_write() and opened by pvars_image_open() or
+ * pvars_image_map().
+ */
+typedef struct pvars_image_t pvars_image_t;
+
+/**
+ * @brief A value inside an image. Views are small and are copied freely;
+ * they stay valid until their image is closed. Read them through the
+ * pview_* functions rather than the fields.
+ */
+typedef struct {
+	const pvars_image_t *image; /* The image the value lives in */
+	uint64_t data;              /* Bits of a number, or offset of a string, list or dict */
+	pvar_type type;             /* Type of the value */
+} pview_t;
+
+/* Version written in the header of every image */
+#define PVARS_IMAGE_VERSION 1
+
+/* --- Public API Function Prototypes --- */
+
+/* Writing, opening and closing images */
+bool pvars_image_write(const pvar_t *value, pvars_buffer_t *buffer);
+pvars_image_t *pvars_image_open(const void *data, size_t size);
+pvars_image_t *pvars_image_map(const char *path);
+void pvars_image_close(pvars_image_t *image);
+bool pvars_image_root(const pvars_image_t *image, pview_t *out_view);
+
+/* Shape of a value */
+pvar_type pview_get_type(const pview_t *view);
+size_t pview_get_size(const pview_t *view);
+pvar_type pview_get_column_type(const pview_t *view);
+
+/* Lists and dicts */
+bool pview_list_get(const pview_t *list, size_t index, pview_t *out_view);
+bool pview_dict_get(const pview_t *dict, const char *key, pview_t *out_view);
+bool pview_dict_entry(const pview_t *dict, size_t index, const char **out_key, pview_t *out_view);
+bool pview_borrow_span(const pview_t *list, const void **out_data, size_t *out_count);
+
+/* Strings and numbers */
+bool pview_borrow_str(const pview_t *view, const char **out_value);
+bool pview_borrow_strn(const pview_t *view, const char **out_value, size_t *out_len);
+bool pview_get_int(const pview_t *view, int *out_value);
+bool pview_get_long(const pview_t *view, long *out_value);
+bool pview_get_double(const pview_t *view, double *out_value);
+bool pview_get_float(const pview_t *view, float *out_value);
+
+#endif /* PIMAGE_H */
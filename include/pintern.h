@@ -0,0 +1,24 @@
+#ifndef PINTERN_H
+#define PINTERN_H
+
+#include<stdbool.h>
+#include<stddef.h>
+
+/**
+ * @brief Usage of the process wide dict key pool. See pvars_get_intern_stats().
+ */
+typedef struct {
+	size_t unique_keys; /* Distinct keys held by the pool */
+	size_t references;  /* Dict entries using a pooled key */
+	size_t bytes;       /* Memory held by the pool: its keys and tables */
+	size_t bytes_saved; /* Memory a private copy per entry would have needed on top of 'bytes' */
+} pvars_intern_stats_t;
+
+/* --- Public API Function Prototypes --- */
+
+/* Key interning, used by every dict created afterwards */
+void pvars_set_key_interning(bool enabled);
+bool pvars_get_key_interning(void);
+bool pvars_get_intern_stats(pvars_intern_stats_t *out_stats);
+
+#endif /* PINTERN_H */
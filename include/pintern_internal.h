@@ -0,0 +1,11 @@
+#ifndef PINTERN_INTERNAL_H
+#define PINTERN_INTERNAL_H
+
+#include<stddef.h>
+
+/* Process wide pool of dict keys (src/pintern.c) */
+char *pintern_acquire(const char *bytes, size_t len);
+char *pintern_retain(char *key);
+void pintern_release(char *key);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef PJSON_H
+#define PJSON_H
+
+#include<stdbool.h>
+#include<stddef.h>
+
+/**
+ * @brief Layout of the text written by pvars_to_json().
+ */
+typedef enum {
+	PVARS_JSON_COMPACT = 0, /* No whitespace at all */
+	PVARS_JSON_PRETTY       /* One element per line, indented by two spaces per level */
+} pvars_json_style;
+
+/* Deepest nesting of arrays and objects pvars_parse_json() accepts */
+#define PVARS_JSON_MAX_DEPTH 512
+
+/* --- Public API Function Prototypes --- */
+
+/* JSON text to values */
+bool pvars_parse_json(const char *json, size_t len, pvar_t *out_value);
+bool pvars_parse_json_in(pvars_arena_t *arena, const char *json, size_t len, pvar_t *out_value);
+
+/* Values to JSON text */
+bool pvars_to_json(const pvar_t *value, pvars_buffer_t *buffer, pvars_json_style style);
+bool pvars_to_json_fd(const pvar_t *value, int fd, pvars_json_style style);
+
+#endif /* PJSON_H */
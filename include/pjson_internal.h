@@ -0,0 +1,60 @@
+#ifndef PJSON_INTERNAL_H
+#define PJSON_INTERNAL_H
+
+#include<stdbool.h>
+#include<stddef.h>
+#include<stdint.h>
+#include<string.h>
+
+#include"pvars.h"
+
+/* Shared by the JSON reader (src/pjson.c), writer (src/pjson_write.c) and stream (src/pstream_json.c) */
+
+/**
+ * @brief A growable buffer for unescaped strings and for numbers handed to
+ * strtod(). Zero it and set its allocator before use, and free it with
+ * pjson_scratch_release().
+ */
+typedef struct {
+	const pvars_allocator_t *allocator;
+	char *bytes;
+	size_t capacity;
+} pjson_scratch_t;
+
+/* Conversion of complete tokens (src/pjson.c) */
+bool pjson_scratch_reserve(pjson_scratch_t *scratch, size_t size);
+void pjson_scratch_release(pjson_scratch_t *scratch);
+bool pjson_unescape(pjson_scratch_t *scratch, const unsigned char *start, const unsigned char *p, const unsigned char *end, const char **out_bytes, size_t *out_len);
+const unsigned char *pjson_read_number(pjson_scratch_t *scratch, const unsigned char *start, const unsigned char *end, pvar_t *out_value);
+
+/**
+ * @brief Finds the first quote, backslash or control character of a
+ * string, eight bytes at a time.
+ *
+ * @return Its address, or end if there is none.
+ */
+static inline const unsigned char *pjson_scan_string(const unsigned char *p, const unsigned char *end)
+{
+	const uint64_t ones = 0x0101010101010101ull;
+	const uint64_t highs = 0x8080808080808080ull;
+
+	while (end - p >= 8) {
+		uint64_t word;
+		memcpy(&word, p, sizeof(word));
+
+		uint64_t quote = word ^ (ones * '"');
+		uint64_t backslash = word ^ (ones * '\\');
+		uint64_t special = ((quote - ones) & ~quote) | ((backslash - ones) & ~backslash) | ((word - ones * 0x20) & ~word);
+		if ((special & highs) != 0) {
+			break;
+		}
+		p += 8;
+	}
+
+	while (p < end && *p != '"' && *p != '\\' && *p >= 0x20) {
+		p++;
+	}
+	return p;
+}
+
+#endif
@@ -12,10 +12,28 @@
 
 typedef struct plist_t plist_t;
 
+/**
+ * @brief How a full list grows. See plist_set_growth_policy().
+ */
+typedef enum {
+	PLIST_GROWTH_DOUBLE = 0, /* Capacity doubles (default): fewest reallocs, up to half the array unused */
+	PLIST_GROWTH_HALF,       /* Capacity grows by half: more reallocs, up to a third of the array unused */
+	PLIST_GROWTH_CHUNK       /* Capacity grows by a fixed number of elements: bounded slack, O(n) reallocs */
+} plist_growth_policy;
+
+/**
+ * @brief Callback choosing elements for plist_remove_if(): returns true for
+ * an element to remove. ctx is the pointer given to plist_remove_if().
+ */
+typedef bool (*plist_predicate)(const pvar_t *value, void *ctx);
+
 /* --- Public API Function Prototypes --- */
 
 /* plist_t setup and packdown*/
 plist_t *plist_create(long int initial_capacity);				// Test 1
+plist_t *plist_create_in(pvars_arena_t *arena, long int initial_capacity);	// Test 33
+plist_t *plist_create_with_allocator(const pvars_allocator_t *allocator, long int initial_capacity); // Test 34
+plist_t *plist_create_typed(pvar_type type, long int initial_capacity);		// Test 44
 plist_t *plist_copy(const plist_t *src);					// Test 24
 
 /* Cleanup functions */
@@ -29,9 +47,21 @@ void plist_print(const plist_t *list);
 size_t plist_get_size(const plist_t *list);					// Test 23
 size_t plist_get_capacity(const plist_t *list);					// Test 23
 pvar_type plist_get_type(const plist_t *list, size_t index);			// Test 23
+pvar_type plist_get_column_type(const plist_t *list);				// Test 44
+
+/* Zero-copy access to the numbers of a typed list */
+bool plist_borrow_span(const plist_t *list, const void **out_data, size_t *out_count);	// Test 44
+bool plist_borrow_span_mutable(plist_t *list, void **out_data, size_t *out_count);	// Test 44
+
+/* Sizing */
+void plist_reserve(plist_t *list, size_t expected_count);			// Test 41
+void plist_shrink_to_fit(plist_t *list);					// Test 41
+void plist_set_growth_policy(plist_t *list, plist_growth_policy policy, size_t chunk);	// Test 41
+plist_growth_policy plist_get_growth_policy(const plist_t *list);		// Test 41
 
 /* Core Add element functions (SINGLE ITEM ONLY) */
 void plist_add_str(plist_t *list, const char *value);				// Test 2
+void plist_add_strn(plist_t *list, const char *value, size_t len);		// Test 37
 void plist_add_int(plist_t *list, int value);					// Test 3
 void plist_add_double(plist_t *list, double value);				// Test 5
 void plist_add_long(plist_t *list, long value);					// Test 4
@@ -40,9 +70,38 @@ void plist_add_list(plist_t *list, const plist_t *value);			// Test 7
 void plist_add_dict(plist_t *list, const pdict_t *value);			// Test 8
 void plist_add_pvar(plist_t *list, const pvar_t *value);
 
+/* Ownership transferring add functions (no copy) */
+void plist_add_list_take(plist_t *list, plist_t *value);			// Test 32
+void plist_add_dict_take(plist_t *list, pdict_t *value);			// Test 32
+
+/* Insert functions (index 0 pushes to the front in amortised O(1)) */
+void plist_insert_str(plist_t *list, size_t index, const char *value);		// Test 43
+void plist_insert_strn(plist_t *list, size_t index, const char *value, size_t len);	// Test 43
+void plist_insert_int(plist_t *list, size_t index, int value);			// Test 43
+void plist_insert_long(plist_t *list, size_t index, long value);		// Test 43
+void plist_insert_double(plist_t *list, size_t index, double value);		// Test 43
+void plist_insert_float(plist_t *list, size_t index, float value);		// Test 43
+void plist_insert_list(plist_t *list, size_t index, const plist_t *value);	// Test 43
+void plist_insert_dict(plist_t *list, size_t index, const pdict_t *value);	// Test 43
+void plist_insert_pvar(plist_t *list, size_t index, const pvar_t *value);	// Test 43
+void plist_insert_list_take(plist_t *list, size_t index, plist_t *value);	// Test 43
+void plist_insert_dict_take(plist_t *list, size_t index, pdict_t *value);	// Test 43
+
+/* Bulk add functions (the list grows at most once) */
+void plist_extend_ints(plist_t *list, const int *values, size_t count);		// Test 40
+void plist_extend_longs(plist_t *list, const long *values, size_t count);	// Test 40
+void plist_extend_doubles(plist_t *list, const double *values, size_t count);	// Test 40
+void plist_extend_floats(plist_t *list, const float *values, size_t count);	// Test 40
+void plist_extend_strs(plist_t *list, const char *const *values, size_t count);	// Test 40
+void plist_extend_pvars(plist_t *list, const pvar_t *values, size_t count);	// Test 40
+void plist_extend(plist_t *list, const plist_t *src);				// Test 40
+
 /* String accessors */
 bool plist_get_str(const plist_t *list, size_t index, char **out_value);	// Test 9
+bool plist_borrow_str(const plist_t *list, size_t index, const char **out_value);	// Test 31
+bool plist_borrow_strn(const plist_t *list, size_t index, const char **out_value, size_t *out_len);	// Test 37
 void plist_set_str(plist_t *list, size_t index, const char *new_string);	// Test 16
+void plist_set_strn(plist_t *list, size_t index, const char *new_string, size_t len);	// Test 37
 
 /* Integer accessors */
 bool plist_get_int(const plist_t *list, size_t index, int *out_value);		// Test 10
@@ -62,17 +121,35 @@ void plist_set_float(plist_t *list, size_t index, float new_value);		// Test 20
 
 /* List accessors */
 bool plist_get_list(const plist_t *list, size_t index, plist_t **out_value);	// Test 14
+bool plist_borrow_list(const plist_t *list, size_t index, const plist_t **out_value);	// Test 31
 void plist_set_list(plist_t *list, size_t index, const plist_t *new_list);	// Test 21
+void plist_set_list_take(plist_t *list, size_t index, plist_t *new_list);	// Test 32
 
 /* Dict accessors */
 bool plist_get_dict(const plist_t *list, size_t index, pdict_t **out_value);	// Test 15
+bool plist_borrow_dict(const plist_t *list, size_t index, const pdict_t **out_value);	// Test 31
 void plist_set_dict(plist_t *list, size_t index, const pdict_t *new_dict);	// Test 22
+void plist_set_dict_take(plist_t *list, size_t index, pdict_t *new_dict);	// Test 32
 
 /* Remove element */
 void plist_remove(plist_t *list, size_t index);					// Test 23
+bool plist_pop(plist_t *list, size_t index, pvar_t *out_value);			// Test 32
+void plist_remove_range(plist_t *list, size_t start, size_t count);		// Test 42
+size_t plist_remove_if(plist_t *list, plist_predicate predicate, void *ctx);	// Test 42
+void plist_swap_remove(plist_t *list, size_t index);				// Test 42
 
 /* Functions that query list */
 bool plist_contains(const plist_t *list, pvar_t *element_to_find);		// Test 25
+bool plist_index_of(const plist_t *list, const pvar_t *value, size_t *out_index);	// Test 46
+size_t plist_count_of(const plist_t *list, const pvar_t *value);		// Test 46
+void plist_set_indexed(plist_t *list, bool indexed);				// Test 46
+
+/* Numeric reductions over lists of numbers */
+bool plist_sum(const plist_t *list, double *out_value);				// Test 45
+bool plist_min(const plist_t *list, double *out_value);				// Test 45
+bool plist_max(const plist_t *list, double *out_value);				// Test 45
+bool plist_mean(const plist_t *list, double *out_value);			// Test 45
+bool plist_variance(const plist_t *list, double *out_value);			// Test 45
 
 
 #endif /* PLIST_H */
@@ -7,6 +7,9 @@
 #include"perrno.h" /* For pvar_type enum */
 #include"pvars.h"
 #include"pdict_internal.h"
+#include"pshare_internal.h"
+
+typedef struct plist_index_t plist_index_t;
 
 /**
  * @brief The full definition of the list structure.
@@ -14,13 +17,31 @@
  * by including this header.
  */
 struct plist_t {
-	pvar_t *elements; /* Pointer to the dynamic array of pvar_t structs */
+	union {
+		pvar_t *elements; /* Pointer to the first element of the dynamic array of pvar_t structs */
+		void *values; /* The same array as raw slots; a typed list packs bare numbers here */
+	};
 	size_t count; /* Number of elements in the list */
-	size_t capacity; /* Total allocated space (number of char * slots) */
+	size_t capacity; /* Slots from 'elements' to the end of the array */
+	size_t front; /* Unused slots before 'elements', left by removals at and insertions near the front */
+	size_t width; /* Bytes per slot: sizeof(pvar_t), or the size of a typed list's numbers */
+	pvar_type column; /* Type of every element of a typed list, PVAR_TYPE_NONE for a list of pvar_t */
+	const pvars_allocator_t *allocator; /* Allocator of the list's memory, possibly an arena's */
+	plist_growth_policy growth; /* How the capacity grows when the list is full */
+	size_t growth_chunk; /* Elements added per growth step under PLIST_GROWTH_CHUNK */
+	bool indexed; /* Searches build and use a hash index, see plist_set_indexed() */
+	plist_index_t *_Atomic index; /* Hash index of the elements, NULL until a search builds it or after a change */
+	bool lent; /* A span from plist_borrow_span_mutable() may still be written through, so searches scan */
+	pshare_t *_Atomic share; /* Handles sharing 'elements' after plist_copy(), NULL if never shared. Must stay last */
 };
 
 
 /* Helper Function definitions */
 void plist_print_internal(const plist_t *list);
+plist_t *plist_copy_in(const pvars_allocator_t *allocator, const plist_t *src);
+const pvar_t *plist_element(const plist_t *list, size_t index, pvar_t *scratch);
+bool plist_search(const plist_t *list, const pvar_t *value, size_t *out_index, size_t *out_count);
+void plist_index_drop(plist_t *list);
+bool plist_append_take(plist_t *list, const pvar_t *value);
 
 #endif /* PLIST_INTERNAL_H */
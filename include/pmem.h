@@ -0,0 +1,27 @@
+#ifndef PMEM_H
+#define PMEM_H
+
+#include<stddef.h>
+
+/**
+ * @brief A memory allocator for lists, dicts and arenas.
+ *
+ * Every hook receives ctx. Sizes are passed back to resize and release, so
+ * sized allocators (and counting ones) need no per-block header. alloc and
+ * resize must return memory aligned for any type, or NULL on failure; a
+ * failed resize must leave ptr untouched.
+ */
+typedef struct {
+	void *(*alloc)(size_t size, void *ctx);
+	void *(*resize)(void *ptr, size_t old_size, size_t new_size, void *ctx);
+	void (*release)(void *ptr, size_t size, void *ctx);
+	void *ctx;
+} pvars_allocator_t;
+
+/* --- Public API Function Prototypes --- */
+
+/* Process wide allocator, used by every container created afterwards */
+void pvars_set_allocator(const pvars_allocator_t *allocator);
+const pvars_allocator_t *pvars_get_allocator(void);
+
+#endif /* PMEM_H */
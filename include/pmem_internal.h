@@ -0,0 +1,27 @@
+#ifndef PMEM_INTERNAL_H
+#define PMEM_INTERNAL_H
+
+#include<stdbool.h>
+#include<stddef.h>
+
+#include"pvars.h"
+
+/*
+ * Allocation entry points used by every container. Each container keeps the
+ * allocator it was created with and passes it here, so memory is always
+ * returned to the allocator it came from.
+ */
+const pvars_allocator_t *pmem_default(void);
+const pvars_allocator_t *pmem_heap(void);
+void *pmem_malloc(const pvars_allocator_t *allocator, size_t size);
+void *pmem_calloc(const pvars_allocator_t *allocator, size_t count, size_t size);
+void *pmem_realloc(const pvars_allocator_t *allocator, void *ptr, size_t old_size, size_t new_size);
+char *pmem_strndup(const pvars_allocator_t *allocator, const char *str, size_t len);
+char *pmem_strdup(const pvars_allocator_t *allocator, const char *str);
+void pmem_free(const pvars_allocator_t *allocator, void *ptr, size_t size);
+
+/* Arena allocators (src/parena.c) */
+const pvars_allocator_t *parena_allocator(pvars_arena_t *arena);
+bool parena_owns(const pvars_allocator_t *allocator);
+
+#endif
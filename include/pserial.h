@@ -0,0 +1,36 @@
+#ifndef PSERIAL_H
+#define PSERIAL_H
+
+#include<stdbool.h>
+#include<stddef.h>
+
+/**
+ * @brief A growable byte buffer that encoded documents are appended to.
+ * Initialise it with pvars_buffer_init() and free it with
+ * pvars_buffer_release(); the fields may be read directly.
+ */
+typedef struct {
+	unsigned char *data; /* The bytes written so far, NULL until the first write */
+	size_t size;         /* Bytes in use */
+	size_t capacity;     /* Bytes allocated */
+	const pvars_allocator_t *allocator; /* Allocator of 'data' */
+} pvars_buffer_t;
+
+/* Version written in the header of every encoded document */
+#define PVARS_SERIAL_VERSION 1
+
+/* Deepest nesting of lists and dicts pvars_deserialize() accepts */
+#define PVARS_SERIAL_MAX_DEPTH 512
+
+/* --- Public API Function Prototypes --- */
+
+/* pvars_buffer_t setup and packdown */
+void pvars_buffer_init(pvars_buffer_t *buffer);
+void pvars_buffer_clear(pvars_buffer_t *buffer);
+void pvars_buffer_release(pvars_buffer_t *buffer);
+
+/* Binary encoding of a value and everything nested in it */
+bool pvars_serialize(const pvar_t *value, pvars_buffer_t *buffer);
+bool pvars_deserialize(const void *data, size_t size, pvar_t *out_value, size_t *out_used);
+
+#endif /* PSERIAL_H */
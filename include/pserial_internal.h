@@ -0,0 +1,20 @@
+#ifndef PSERIAL_INTERNAL_H
+#define PSERIAL_INTERNAL_H
+
+#include<stdbool.h>
+#include<stddef.h>
+
+#include"pvars.h"
+#include"perrno.h"
+
+/* Layout of encoded documents, described in src/pserial.c */
+#define PSERIAL_MAGIC_0 'P'
+#define PSERIAL_MAGIC_1 'V'
+#define PSERIAL_HEADER_SIZE 3
+#define PSERIAL_TAG_TYPED 0x80 /* Set on the tag of a typed list */
+#define PSERIAL_VARINT_MAX 10  /* Bytes of the longest 64-bit varint */
+
+/* Growth of the buffers that encoders write to (src/pserial.c) */
+bool pvars_buffer_reserve(pvars_buffer_t *buffer, size_t extra, perrno_t failure);
+
+#endif
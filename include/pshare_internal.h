@@ -0,0 +1,24 @@
+#ifndef PSHARE_INTERNAL_H
+#define PSHARE_INTERNAL_H
+
+#include<stdatomic.h>
+#include<stdbool.h>
+#include<stddef.h>
+
+#include"pvars.h"
+
+/**
+ * @brief Reference count of the contents of a list or dict that several
+ * handles share after an O(1) copy. Each handle holds one reference; the
+ * contents are copied before any of them is modified (see src/pshare.c).
+ */
+typedef struct {
+	_Atomic size_t refs;
+} pshare_t;
+
+/* Shared container contents (src/pshare.c) */
+pshare_t *pshare_acquire(const pvars_allocator_t *allocator, pshare_t *_Atomic *share);
+bool pshare_release(const pvars_allocator_t *allocator, pshare_t *share);
+bool pshare_is_shared(const pshare_t *share);
+
+#endif
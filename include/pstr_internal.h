@@ -0,0 +1,51 @@
+#ifndef PSTR_INTERNAL_H
+#define PSTR_INTERNAL_H
+
+#include<stdbool.h>
+#include<stddef.h>
+#include<stdint.h>
+
+#include"pmem.h"
+
+/**
+ * @brief Header stored in front of the bytes of every heap string owned by a
+ * list or dict (long string values and dict keys).
+ *
+ * Containers hold a pointer to 'data', so the bytes read like any C string,
+ * but 'len' is authoritative: a string may contain NUL bytes. The bytes are
+ * never modified after pstr_create(); only the key pool updates 'refs'.
+ */
+typedef struct {
+	size_t len;     // Bytes in data, excluding the terminator
+	uint64_t hash;  // pstr_hash_bytes(data, len), valid if PSTR_FLAG_HASHED is set
+	uint32_t flags; // PSTR_FLAG_* bits
+	size_t refs;    // Dict entries sharing the string, PSTR_FLAG_INTERNED only; as wide as a pointer, so it cannot wrap
+	char data[];    // The bytes, followed by a NUL
+} pstr_t;
+
+#define PSTR_FLAG_HASHED 0x1u /* 'hash' has been computed */
+#define PSTR_FLAG_BINARY 0x2u /* 'data' contains NUL bytes */
+#define PSTR_FLAG_INTERNED 0x4u /* Owned by the key pool, see src/pintern.c */
+
+char *pstr_create(const pvars_allocator_t *allocator, const char *bytes, size_t len, bool hashed);
+void pstr_free(const pvars_allocator_t *allocator, char *str);
+size_t pstr_size(size_t len);
+uint64_t pstr_hash_bytes(const void *bytes, size_t len);
+
+/**
+ * @brief Returns the header of a string made by pstr_create().
+ */
+static inline const pstr_t *pstr_header(const char *str)
+{
+	return (const pstr_t *)(const void *)(str - offsetof(pstr_t, data));
+}
+
+/**
+ * @brief Returns the length of a string made by pstr_create().
+ */
+static inline size_t pstr_len(const char *str)
+{
+	return pstr_header(str)->len;
+}
+
+#endif
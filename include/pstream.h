@@ -0,0 +1,66 @@
+#ifndef PSTREAM_H
+#define PSTREAM_H
+
+#include<stdbool.h>
+#include<stddef.h>
+#include<stdint.h>
+
+/**
+ * @brief OPAQUE DATA TYPE: an incremental reader that is fed a sequence of
+ * documents in chunks of any size and reports what it reads through
+ * callbacks, holding only the unfinished token and one frame per open
+ * list or dict. Made by pvars_stream_create().
+ */
+typedef struct pvars_stream_t pvars_stream_t;
+
+/**
+ * @brief Encoding of the documents fed to a stream.
+ */
+typedef enum {
+	PVARS_STREAM_JSON = 0, /* JSON values, separated by optional whitespace (as in one value per line) */
+	PVARS_STREAM_BINARY    /* Documents written by pvars_serialize(), one after the other */
+} pvars_stream_format;
+
+/**
+ * @brief What a stream calls as it reads. Any member may be NULL, and
+ * every callback returns false to stop the stream.
+ *
+ * Each list and dict is reported as start_list() or start_dict(), its
+ * elements, then end(); each member of a dict as key() then the value.
+ * Strings go to string() and other scalars to value(); true and false
+ * are the ints 1 and 0 and null is PVAR_TYPE_NONE, as in
+ * pvars_parse_json(). Keys and strings are followed by a NUL, but binary
+ * strings may also contain NULs, and all of them are only valid during
+ * the call.
+ *
+ * Before a list or dict is started, select() may claim it: it is then
+ * built as a whole, with none of the calls above for what it contains,
+ * and handed to subtree(), which takes ownership of it.
+ */
+typedef struct {
+	bool (*start_list)(void *context);
+	bool (*start_dict)(void *context);
+	bool (*key)(void *context, const char *key, size_t len);
+	bool (*string)(void *context, const char *bytes, size_t len);
+	bool (*value)(void *context, const pvar_t *value);
+	bool (*end)(void *context);
+	/* True to build the list or dict about to start; depth counts the lists and dicts around it */
+	bool (*select)(void *context, pvar_type type, size_t depth);
+	/* Receives a list or dict claimed by select(), to be released with pvar_destroy() */
+	bool (*subtree)(void *context, pvar_t *value);
+} pvars_stream_callbacks_t;
+
+/* --- Public API Function Prototypes --- */
+
+/* pvars_stream_t setup and packdown */
+pvars_stream_t *pvars_stream_create(pvars_stream_format format, const pvars_stream_callbacks_t *callbacks, void *context);
+void pvars_stream_destroy(pvars_stream_t *stream);
+
+/* Feeding input */
+bool pvars_stream_feed(pvars_stream_t *stream, const void *data, size_t size);
+bool pvars_stream_finish(pvars_stream_t *stream);
+
+/* pvars_stream_t meta data accessors */
+uint64_t pvars_stream_get_offset(const pvars_stream_t *stream);
+
+#endif /* PSTREAM_H */
@@ -0,0 +1,143 @@
+#ifndef PSTREAM_INTERNAL_H
+#define PSTREAM_INTERNAL_H
+
+#include<stdbool.h>
+#include<stddef.h>
+#include<stdint.h>
+
+#include"pvars.h"
+#include"perrno.h"
+#include"pjson_internal.h"
+
+/**
+ * @brief What the JSON grammar accepts next.
+ */
+typedef enum {
+	PSTREAM_JSON_VALUE = 0,      // A value: a document at depth 0, else after ',' in an array or ':' in an object
+	PSTREAM_JSON_VALUE_OR_CLOSE, // After '['
+	PSTREAM_JSON_KEY_OR_CLOSE,   // After '{'
+	PSTREAM_JSON_KEY,            // After ',' in an object
+	PSTREAM_JSON_COLON,          // After a key
+	PSTREAM_JSON_COMMA_OR_CLOSE  // After a value in an array or object
+} pstream_json_expect;
+
+/**
+ * @brief Token the JSON grammar is in the middle of.
+ */
+typedef enum {
+	PSTREAM_LEX_NONE = 0, // Between tokens
+	PSTREAM_LEX_STRING,   // A string, its bytes so far (without the opening quote) in the token buffer
+	PSTREAM_LEX_SCALAR    // A number or literal, its bytes so far in the token buffer
+} pstream_lex;
+
+/**
+ * @brief State of the JSON grammar (src/pstream_json.c).
+ */
+typedef struct {
+	uint8_t expect;  // A pstream_json_expect
+	uint8_t lex;     // A pstream_lex
+	bool escaped;    // The token ends in a backslash, which escapes the next byte
+	bool escapes;    // The string in the token buffer has escapes to undo
+	uint8_t kinds[PVARS_JSON_MAX_DEPTH]; // PVAR_TYPE_LIST or PVAR_TYPE_DICT of every open container
+} pstream_json_t;
+
+/**
+ * @brief Part of an encoded document the binary grammar is reading.
+ */
+typedef enum {
+	PSTREAM_BINARY_HEADER = 0, // The 'P' 'V' version header, 'have' bytes of it read
+	PSTREAM_BINARY_TAG,        // The tag of a value
+	PSTREAM_BINARY_COLUMN,     // The column type of a typed list
+	PSTREAM_BINARY_VARINT,     // A varint standing for 'field'
+	PSTREAM_BINARY_FIXED,      // The 'need' bytes of a double or float, 'have' of them in 'fixed'
+	PSTREAM_BINARY_BYTES       // The 'need' bytes of a string or key, 'have' of them in the token buffer
+} pstream_binary_state;
+
+/**
+ * @brief What a varint, fixed field or run of bytes stands for.
+ */
+typedef enum {
+	PSTREAM_FIELD_INT = 0,
+	PSTREAM_FIELD_LONG,
+	PSTREAM_FIELD_DOUBLE,
+	PSTREAM_FIELD_FLOAT,
+	PSTREAM_FIELD_STRING_LEN,
+	PSTREAM_FIELD_STRING,
+	PSTREAM_FIELD_KEY_LEN,
+	PSTREAM_FIELD_KEY,
+	PSTREAM_FIELD_LIST_COUNT,
+	PSTREAM_FIELD_DICT_COUNT,
+	PSTREAM_FIELD_COLUMN_COUNT
+} pstream_field;
+
+/**
+ * @brief A list or dict open in the binary grammar.
+ */
+typedef struct {
+	uint64_t remaining; // Elements or entries still to read
+	uint8_t type;       // PVAR_TYPE_LIST or PVAR_TYPE_DICT
+	uint8_t column;     // Column type of a typed list, PVAR_TYPE_NONE otherwise
+} pstream_frame_t;
+
+/**
+ * @brief State of the binary grammar (src/pstream_binary.c).
+ */
+typedef struct {
+	uint8_t state;    // A pstream_binary_state
+	uint8_t field;    // A pstream_field
+	uint8_t column;   // Column type of the typed list whose count is being read
+	unsigned shift;   // Bits of 'varint' read so far
+	uint64_t varint;
+	uint64_t need;
+	uint64_t have;
+	unsigned char fixed[8];
+	pstream_frame_t frames[PVARS_SERIAL_MAX_DEPTH];
+} pstream_binary_t;
+
+/**
+ * @brief A list or dict being built for select().
+ */
+typedef struct {
+	pvar_t value;        // The list or dict
+	char *key;           // Key of the dict's next member
+	size_t key_len;
+	size_t key_capacity;
+} pstream_build_t;
+
+struct pvars_stream_t {
+	const pvars_allocator_t *allocator; // Allocator of the stream and its buffers
+	pvars_stream_format format;
+	pvars_stream_callbacks_t callbacks;
+	void *context;
+	perrno_t failure;           // Error that stopped the stream, SUCCESS while it runs
+	perrno_t duplicate_failure; // Error for a key repeated in a dict being built
+	uint64_t offset;            // Bytes read since the stream was created or finished
+	size_t depth;               // Lists and dicts started and not yet ended
+	pstream_build_t *builds;    // Lists and dicts being built, outermost first
+	size_t building;            // Entries of 'builds' in use
+	size_t build_capacity;
+	char *token;                // The unfinished token
+	size_t token_size;
+	size_t token_capacity;
+	pjson_scratch_t scratch;
+	union {
+		pstream_json_t json;
+		pstream_binary_t binary;
+	} grammar;
+};
+
+/* Events, reported or built (src/pstream.c) */
+bool pstream_token_append(pvars_stream_t *stream, const void *bytes, size_t len);
+bool pstream_begin(pvars_stream_t *stream, pvar_type type, pvar_type column, uint64_t count);
+bool pstream_key(pvars_stream_t *stream, const char *key, size_t len);
+bool pstream_string(pvars_stream_t *stream, const char *bytes, size_t len);
+bool pstream_scalar(pvars_stream_t *stream, const pvar_t *value);
+bool pstream_end(pvars_stream_t *stream);
+
+/* Grammars: each feed reports the bytes it consumed, even on failure */
+bool pstream_json_feed(pvars_stream_t *stream, const unsigned char *data, size_t size, size_t *out_used);
+bool pstream_json_finish(pvars_stream_t *stream);
+bool pstream_binary_feed(pvars_stream_t *stream, const unsigned char *data, size_t size, size_t *out_used);
+bool pstream_binary_finish(pvars_stream_t *stream);
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 /**
  * @brief OPAQUE DATA TYPE: plist_t is a forward declaration.
@@ -13,6 +14,12 @@
 typedef struct plist_t plist_t;
 typedef struct pdict_t pdict_t;
 
+/**
+ * @brief OPAQUE DATA TYPE: a memory region that whole trees of lists and
+ * dicts can be built in and released at once. See parena.h.
+ */
+typedef struct pvars_arena_t pvars_arena_t;
+
 /* Enum to track the type of data stored */
 typedef enum {
 	PVAR_TYPE_NONE = 0, /* For an empty or uninitialised slot (value is 0 for calloc safety) */
@@ -38,13 +45,37 @@ typedef union {
 	/* Future types to go here */
 } pvar_data;
 
-/* Structure combining the type and the data (the new list element) */
+/* Bytes, including the terminator, of a string stored inside a pvar_t */
+#define PVAR_INLINE_STR_SIZE 14
+
+/*
+ * Structure combining the type and the data (the new list element).
+ *
+ * Inside lists and dicts, strings shorter than PVAR_INLINE_STR_SIZE are
+ * stored in the pvar itself, starting at 'data' and running on into
+ * 'inline_tail', and longer ones point past a length-prefixed header. Either
+ * way 'str_tag' records the form, so strings may contain NUL bytes. Values
+ * passed to or returned from the API always hold a plain C string in data.s,
+ * and 'str_tag' is ignored on input.
+ */
 typedef struct {
-	pvar_type type;
 	pvar_data data;
+	char inline_tail[PVAR_INLINE_STR_SIZE - sizeof(pvar_data)];
+	uint8_t str_tag; /* How a PVAR_TYPE_STRING is stored, see pvars_internal.h */
+	uint8_t type;    /* A pvar_type */
 } pvar_t;
 
+/* Releases a value handed out by plist_pop() or pdict_pop() */
+void pvar_destroy(pvar_t *pvar);
+
+#include"pmem.h"
+#include"parena.h"
+#include"pintern.h"
 #include"plist.h"
 #include"pdict.h"
+#include"pserial.h"
+#include"pimage.h"
+#include"pjson.h"
+#include"pstream.h"
 
 #endif /* PVARS_H */
@@ -1,9 +1,26 @@
 #ifndef PVARS_INTERNAL_H
 #define PVARS_INTERNAL_H
 
+/*
+ * Values of pvar_t.str_tag for a PVAR_TYPE_STRING:
+ *   PVAR_STR_PLAIN       data.s is a plain C string (values outside containers)
+ *   1..PVAR_INLINE_STR_SIZE  the string is stored inline, length + 1
+ *   PVAR_STR_HEADER      data.s was made by pstr_create()
+ */
+#define PVAR_STR_PLAIN 0
+#define PVAR_STR_HEADER 0xFF
+
 /* Helper functions */
 void pvar_destroy_internal(pvar_t *pvar);
+void pvar_destroy_in(const pvars_allocator_t *allocator, pvar_t *pvar);
 bool pvar_equals(pvar_t *a, pvar_t *b);
-pvar_t pvar_copy(const pvar_t *src);
+bool pvar_str_equals(const pvar_t *pvar, const char *bytes, size_t len, uint64_t hash);
+pvar_t pvar_copy_in(const pvars_allocator_t *allocator, const pvar_t *src);
+bool pvar_set_str_in(const pvars_allocator_t *allocator, pvar_t *pvar, const char *str);
+bool pvar_set_strn_in(const pvars_allocator_t *allocator, pvar_t *pvar, const char *bytes, size_t len);
+const char *pvar_str(const pvar_t *pvar);
+size_t pvar_str_len(const pvar_t *pvar);
+bool pvar_is_inline_str(const pvar_t *pvar);
+char *pvar_str_to_heap(const pvar_t *pvar);
 
 #endif
@@ -0,0 +1,387 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<stdint.h>
+#include<string.h>
+
+#include"pvars.h"
+#include"perrno.h"
+#include"pmem_internal.h"
+
+/* Every allocation is aligned for any object type */
+#define PARENA_ALIGNMENT _Alignof(max_align_t)
+
+/**
+ * @brief A region that allocations are bumped out of. Chunks are only ever
+ * freed together, by pvars_arena_reset() or pvars_arena_destroy().
+ */
+typedef struct parena_chunk_t {
+	struct parena_chunk_t *next; // Older chunk
+	size_t size;                 // Usable bytes in 'data'
+	size_t used;                 // Bytes handed out from 'data'
+	max_align_t data[];          // The region itself
+} parena_chunk_t;
+
+/**
+ * @brief The full definition of the arena structure. This is hidden from
+ * the user.
+ *
+ * New memory is taken from the head chunk. Requests larger than half a chunk
+ * get a chunk of their own, linked behind the head so that the head keeps
+ * serving small requests.
+ *
+ * Containers built in the arena hold a pointer to 'allocator', whose hooks
+ * bump-allocate from it. Chunks come from the 'backing' allocator.
+ */
+struct pvars_arena_t {
+	pvars_allocator_t allocator;       // Hooks handed to containers, ctx is the arena
+	const pvars_allocator_t *backing;  // Allocator of the chunks and of the arena itself
+	parena_chunk_t *head; // Chunk currently bumped, newest first
+	size_t chunk_size;    // Usable bytes of a regular chunk
+	size_t chunk_count;   // Number of chunks held
+	size_t used;          // Bytes handed out across all chunks
+	void *last;           // Most recent allocation from head, may grow in place
+};
+
+/**
+ * @brief Rounds size up to PARENA_ALIGNMENT.
+ *
+ * @return The rounded size, or 0 if it would overflow.
+ */
+static size_t parena_align(size_t size)
+{
+	if (size == 0) {
+		size = 1;
+	}
+
+	if (size > SIZE_MAX - (PARENA_ALIGNMENT - 1)) {
+		return 0;
+	}
+
+	return (size + PARENA_ALIGNMENT - 1) & ~(size_t)(PARENA_ALIGNMENT - 1);
+}
+
+/**
+ * @brief Allocates a chunk with size usable bytes.
+ */
+static parena_chunk_t *parena_chunk_new(pvars_arena_t *arena, size_t size)
+{
+	if (size > SIZE_MAX - sizeof(parena_chunk_t)) {
+		return NULL;
+	}
+
+	parena_chunk_t *chunk = pmem_malloc(arena->backing, sizeof(parena_chunk_t) + size);
+	if (chunk == NULL) {
+		return NULL;
+	}
+
+	chunk->next = NULL;
+	chunk->size = size;
+	chunk->used = 0;
+
+	return chunk;
+}
+
+/**
+ * @brief Returns a chunk to the backing allocator.
+ */
+static void parena_chunk_free(pvars_arena_t *arena, parena_chunk_t *chunk)
+{
+	pmem_free(arena->backing, chunk, sizeof(parena_chunk_t) + chunk->size);
+}
+
+static void *parena_hook_alloc(size_t size, void *ctx);
+static void *parena_hook_resize(void *ptr, size_t old_size, size_t new_size, void *ctx);
+static void parena_hook_release(void *ptr, size_t size, void *ctx);
+
+/**
+ * @brief Creates an empty arena.
+ *
+ * Lists and dicts created in the arena with plist_create_in() and
+ * pdict_create_in() take all of their memory from it: element arrays,
+ * strings, entries, buckets and nested containers. Destroying such a
+ * container does nothing; its memory is released by pvars_arena_reset() or
+ * pvars_arena_destroy() in one pass over the chunks.
+ *
+ * Chunks are taken from the process wide allocator in effect when the
+ * arena is created (see pvars_set_allocator()). An arena is not thread safe.
+ *
+ * @param chunk_size Bytes reserved from the system at a time, or 0 for
+ * PVARS_ARENA_DEFAULT_CHUNK_SIZE.
+ * @return A pointer to the new arena, or NULL on failure.
+ */
+pvars_arena_t *pvars_arena_create(size_t chunk_size)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (chunk_size == 0) {
+		chunk_size = PVARS_ARENA_DEFAULT_CHUNK_SIZE;
+	}
+
+	chunk_size = parena_align(chunk_size);
+	if (chunk_size == 0) {
+		pvars_errno = FAILURE_PVARS_ARENA_CREATE_CHUNK_SIZE_OUT_OF_BOUNDS;
+		return NULL;
+	}
+
+	const pvars_allocator_t *backing = pmem_default();
+
+	pvars_arena_t *arena = pmem_malloc(backing, sizeof(pvars_arena_t));
+	if (arena == NULL) {
+		pvars_errno = FAILURE_PVARS_ARENA_CREATE_MALLOC_FAILED;
+		return NULL;
+	}
+
+	arena->allocator.alloc = parena_hook_alloc;
+	arena->allocator.resize = parena_hook_resize;
+	arena->allocator.release = parena_hook_release;
+	arena->allocator.ctx = arena;
+	arena->backing = backing;
+
+	/* The first chunk is reserved lazily, on the first allocation */
+	arena->head = NULL;
+	arena->chunk_size = chunk_size;
+	arena->chunk_count = 0;
+	arena->used = 0;
+	arena->last = NULL;
+
+	pvars_errno = SUCCESS;
+	return arena;
+}
+
+/**
+ * @brief Frees the arena and every list, dict and string built in it.
+ *
+ * @param arena The arena to destroy. NULL is ignored.
+ */
+void pvars_arena_destroy(pvars_arena_t *arena)
+{
+	if (arena == NULL) {
+		return;
+	}
+
+	parena_chunk_t *chunk = arena->head;
+
+	while (chunk != NULL) {
+		parena_chunk_t *next = chunk->next;
+		parena_chunk_free(arena, chunk);
+		chunk = next;
+	}
+
+	pmem_free(arena->backing, arena, sizeof(pvars_arena_t));
+}
+
+/**
+ * @brief Releases everything built in the arena but keeps one regular chunk
+ * for reuse, so a scratch arena can be recycled without touching the system
+ * allocator again.
+ *
+ * Every list and dict created in the arena is invalid afterwards.
+ *
+ * @param arena The arena to reset.
+ */
+void pvars_arena_reset(pvars_arena_t *arena)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (arena == NULL) {
+		pvars_errno = FAILURE_PVARS_ARENA_RESET_NULL_INPUT;
+		return;
+	}
+
+	parena_chunk_t *kept = NULL;
+	parena_chunk_t *chunk = arena->head;
+
+	while (chunk != NULL) {
+		parena_chunk_t *next = chunk->next;
+
+		if (kept == NULL && chunk->size == arena->chunk_size) {
+			kept = chunk;
+		} else {
+			parena_chunk_free(arena, chunk);
+		}
+		chunk = next;
+	}
+
+	if (kept != NULL) {
+		kept->next = NULL;
+		kept->used = 0;
+	}
+
+	arena->head = kept;
+	arena->chunk_count = (kept != NULL);
+	arena->used = 0;
+	arena->last = NULL;
+
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Returns the number of bytes handed out by the arena, including
+ * alignment padding.
+ *
+ * @param arena The arena to query.
+ * @return The bytes in use, or 0 if the arena is NULL.
+ */
+size_t pvars_arena_get_used(const pvars_arena_t *arena)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (arena == NULL) {
+		pvars_errno = FAILURE_PVARS_ARENA_GET_USED_NULL_INPUT;
+		return 0;
+	}
+
+	pvars_errno = SUCCESS;
+	return arena->used;
+}
+
+/**
+ * @brief Returns the number of chunks the arena holds from the system.
+ *
+ * @param arena The arena to query.
+ * @return The chunk count, or 0 if the arena is NULL.
+ */
+size_t pvars_arena_get_chunk_count(const pvars_arena_t *arena)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (arena == NULL) {
+		pvars_errno = FAILURE_PVARS_ARENA_GET_CHUNK_COUNT_NULL_INPUT;
+		return 0;
+	}
+
+	pvars_errno = SUCCESS;
+	return arena->chunk_count;
+}
+
+/**
+ * @brief Returns the allocator that containers built in arena use.
+ */
+const pvars_allocator_t *parena_allocator(pvars_arena_t *arena)
+{
+	return &arena->allocator;
+}
+
+/**
+ * @brief Returns true if allocator belongs to an arena. Memory from such an
+ * allocator is never released piecemeal.
+ */
+bool parena_owns(const pvars_allocator_t *allocator)
+{
+	return allocator->alloc == parena_hook_alloc;
+}
+
+/**
+ * @brief Bump-allocates size bytes from the arena.
+ *
+ * @param arena The arena to allocate from.
+ * @param size Number of bytes.
+ * @return Memory aligned for any type, or NULL if a chunk could not be reserved.
+ */
+static void *parena_alloc(pvars_arena_t *arena, size_t size)
+{
+	size_t aligned = parena_align(size);
+	if (aligned == 0) {
+		return NULL;
+	}
+
+	parena_chunk_t *head = arena->head;
+
+	if (head == NULL || head->size - head->used < aligned) {
+		if (aligned > arena->chunk_size / 2) {
+			/* Oversized: a dedicated chunk behind the head */
+			parena_chunk_t *chunk = parena_chunk_new(arena, aligned);
+			if (chunk == NULL) {
+				return NULL;
+			}
+
+			chunk->used = aligned;
+			if (head != NULL) {
+				chunk->next = head->next;
+				head->next = chunk;
+			} else {
+				arena->head = chunk;
+			}
+
+			arena->chunk_count++;
+			arena->used += aligned;
+			return chunk->data;
+		}
+
+		head = parena_chunk_new(arena, arena->chunk_size);
+		if (head == NULL) {
+			return NULL;
+		}
+
+		head->next = arena->head;
+		arena->head = head;
+		arena->chunk_count++;
+	}
+
+	void *ptr = (unsigned char *)head->data + head->used;
+	head->used += aligned;
+	arena->used += aligned;
+	arena->last = ptr;
+
+	return ptr;
+}
+
+/**
+ * @brief Resizes an arena allocation.
+ *
+ * The most recent allocation grows or shrinks in place while the head chunk
+ * has room, which is the common case for a list being filled. Otherwise the
+ * contents move to a new allocation and the old one is abandoned until the
+ * arena is reset.
+ *
+ * @param arena The arena ptr was allocated from.
+ * @param ptr The allocation, or NULL.
+ * @param old_size The size ptr was allocated with.
+ * @param new_size The size wanted.
+ * @return The resized allocation, or NULL on failure (ptr is untouched).
+ */
+static void *parena_resize(pvars_arena_t *arena, void *ptr, size_t old_size, size_t new_size)
+{
+	parena_chunk_t *head = arena->head;
+
+	if (ptr != NULL && ptr == arena->last) {
+		size_t offset = (size_t)((unsigned char *)ptr - (unsigned char *)head->data);
+		size_t old_aligned = head->used - offset;
+		size_t new_aligned = parena_align(new_size);
+
+		if (new_aligned != 0 && new_aligned <= head->size - offset) {
+			head->used = offset + new_aligned;
+			arena->used = arena->used - old_aligned + new_aligned;
+			return ptr;
+		}
+	}
+
+	void *moved = parena_alloc(arena, new_size);
+	if (moved == NULL) {
+		return NULL;
+	}
+
+	if (ptr != NULL) {
+		memcpy(moved, ptr, old_size < new_size ? old_size : new_size);
+	}
+
+	return moved;
+}
+
+static void *parena_hook_alloc(size_t size, void *ctx)
+{
+	return parena_alloc(ctx, size);
+}
+
+static void *parena_hook_resize(void *ptr, size_t old_size, size_t new_size, void *ctx)
+{
+	return parena_resize(ctx, ptr, old_size, new_size);
+}
+
+/* Arena memory is only released with the whole arena */
+static void parena_hook_release(void *ptr, size_t size, void *ctx)
+{
+	(void)ptr;
+	(void)size;
+	(void)ctx;
+}
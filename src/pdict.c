@@ -1,5 +1,7 @@
 #define _POSIX_C_SOURCE 200809L
 
+#include<limits.h>
+#include<stdatomic.h>
 #include<stddef.h>
 #include<stdlib.h>
 #include<string.h>
@@ -8,215 +10,1486 @@
 #include"pvars_internal.h"
 #include"perrno.h"
 #include"pdict_internal.h"
+#include"pmem_internal.h"
+
+/* Backend used by pdict_create() */
+static pdict_backend pdict_default_backend = PDICT_BACKEND_CHAINED;
+
+static pdict_t *pdict_create_internal(const pvars_allocator_t *allocator, long int initial_capacity, pdict_backend backend);
+static pdict_t *pdict_copy_deep(const pvars_allocator_t *allocator, const pdict_t *src, bool intern_keys);
+static bool pdict_unshare(pdict_t *dict);
+
+/**
+ * @brief Creates a full hash value from the key given, using the dict's
+ * hash function and seed.
+ *
+ * The result is stored in every entry, so it must be well mixed in both its
+ * high bits (flat table position) and its low bits (bucket index and the
+ * flat table's 7-bit tag).
+ *
+ * @param dict The dict the key belongs to.
+ * @param key string
+ * @param len strlen(key)
+ * @return a hash value stored in size_t variable.
+ */
+size_t pdict_hash_key(const pdict_t *dict, const char *key, size_t len)
+{
+	if (dict->hash_function == PDICT_HASH_DJB2) {
+		return (size_t)phash_djb2(key, len, dict->seed);
+	}
+
+	return (size_t)phash_wyhash(key, len, dict->seed);
+}
+
+/**
+ * @brief Prepares a key for lookup by computing its length and hash once.
+ *
+ * @param lookup The key to initialise.
+ * @param dict The dict the key will be looked up in.
+ * @param key The key string. Must outlive lookup.
+ */
+void pdict_key_init(pdict_key_t *lookup, const pdict_t *dict, const char *key)
+{
+	lookup->str = key;
+	lookup->len = strlen(key);
+	lookup->hash = pdict_hash_key(dict, key, lookup->len);
+	lookup->stored = false;
+}
+
+/**
+ * @brief Makes the stored form of a key: a reference to the pooled copy if
+ * the dict interns its keys, or a private copy from the dict's allocator.
+ *
+ * @param dict The dict the key is for.
+ * @param bytes The key bytes.
+ * @param len Number of bytes.
+ * @return The key, to be released with pdict_key_free(), or NULL on failure.
+ */
+char *pdict_key_create(pdict_t *dict, const char *bytes, size_t len)
+{
+	if (dict->intern_keys) {
+		return pintern_acquire(bytes, len);
+	}
+
+	return pstr_create(dict->allocator, bytes, len, false);
+}
+
+/**
+ * @brief Makes the stored form of a key already stored in another dict.
+ *
+ * A pooled key is shared without being looked up or copied when dict also
+ * interns its keys.
+ *
+ * @param dict The dict the key is for.
+ * @param key A key stored in some dict.
+ * @return The key, to be released with pdict_key_free(), or NULL on failure.
+ */
+char *pdict_key_clone(pdict_t *dict, char *key)
+{
+	if (dict->intern_keys && (pstr_header(key)->flags & PSTR_FLAG_INTERNED)) {
+		return pintern_retain(key);
+	}
+
+	return pdict_key_create(dict, key, pstr_len(key));
+}
+
+/**
+ * @brief Releases a key made by pdict_key_create() or pdict_key_clone().
+ *
+ * @param dict The dict the key belonged to.
+ * @param key The key.
+ */
+void pdict_key_free(pdict_t *dict, char *key)
+{
+	if (pstr_header(key)->flags & PSTR_FLAG_INTERNED) {
+		pintern_release(key);
+		return;
+	}
+
+	pstr_free(dict->allocator, key);
+}
+
+/**
+ * @brief Maps a key hash to a bucket. Bucket counts are powers of two.
+ */
+static size_t pdict_bucket_index(size_t hash, size_t capacity)
+{
+	return hash & (capacity - 1);
+}
+
+/**
+ * @brief Rounds n up to a power of two (n itself if it already is one).
+ */
+static size_t pdict_round_pow2(size_t n)
+{
+	size_t capacity = 1;
+
+	while (capacity < n) {
+		capacity *= 2;
+	}
+
+	return capacity;
+}
+
+/**
+ * @brief Returns true if entry is stored under the looked up key.
+ *
+ * The cached hash and length reject almost every mismatch before any key
+ * bytes are read, and a key shared through the intern pool matches by
+ * address.
+ */
+static bool pdict_entry_matches(const pdict_entry_t *entry, const pdict_key_t *lookup)
+{
+	return entry->hash == lookup->hash && (entry->key == lookup->str || (pstr_len(entry->key) == lookup->len &&
+		memcmp(entry->key, lookup->str, lookup->len) == STRING_MATCH));
+}
+
+/**
+ * @brief Returns the number of buckets needed to hold count entries
+ * without exceeding the dict's maximum load factor.
+ *
+ * @param dict The dict whose load factor is used.
+ * @param count The number of entries to make room for.
+ * @return The bucket count, a power of two.
+ */
+static size_t pdict_buckets_for(const pdict_t *dict, size_t count)
+{
+	if (dict->backend == PDICT_BACKEND_FLAT) {
+		return pdict_flat_capacity_for(dict, count);
+	}
+
+	double wanted = (double)count / dict->max_load_factor;
+	size_t buckets = (size_t)wanted;
+
+	if ((double)buckets < wanted) {
+		buckets++;
+	}
+
+	return pdict_round_pow2(buckets);
+}
+
+/**
+ * @brief Migrates up to `steps` buckets from the draining table into the
+ * active table. Frees the draining table once it is empty.
+ *
+ * @param dict The dict being rehashed.
+ * @param steps Number of old buckets to migrate.
+ */
+static void pdict_rehash_step(pdict_t *dict, size_t steps)
+{
+	if (dict->old_buckets == NULL) {
+		return;
+	}
+
+	while (steps-- > 0 && dict->rehash_index < dict->old_capacity) {
+		pdict_entry_t *current = dict->old_buckets[dict->rehash_index];
+
+		while (current != NULL) {
+			pdict_entry_t *next_entry = current->next;
+			size_t bucket_index = pdict_bucket_index(current->hash, dict->capacity);
+
+			current->next = dict->buckets[bucket_index];
+			dict->buckets[bucket_index] = current;
+			current = next_entry;
+		}
+
+		dict->old_buckets[dict->rehash_index] = NULL;
+		dict->rehash_index++;
+	}
+
+	if (dict->rehash_index >= dict->old_capacity) {
+		pmem_free(dict->allocator, dict->old_buckets, dict->old_capacity * sizeof(pdict_entry_t *));
+		dict->old_buckets = NULL;
+		dict->old_capacity = 0;
+		dict->rehash_index = 0;
+	}
+}
+
+/**
+ * @brief Completes any rehash in progress in one go.
+ *
+ * @param dict The dict being rehashed.
+ */
+static void pdict_rehash_finish(pdict_t *dict)
+{
+	if (dict->old_buckets != NULL) {
+		pdict_rehash_step(dict, dict->old_capacity - dict->rehash_index);
+	}
+}
+
+/**
+ * @brief Starts moving the dict into a bucket array of new_capacity slots.
+ *
+ * The current table becomes the draining table and entries are migrated a
+ * few buckets at a time by pdict_rehash_step(). Any earlier rehash is
+ * finished first so that at most two tables exist at once.
+ *
+ * @param dict The dict to resize.
+ * @param new_capacity The size of the new bucket array. Must be >= 1.
+ * @return True on success, false if the new bucket array could not be allocated.
+ */
+static bool pdict_rehash_start(pdict_t *dict, size_t new_capacity)
+{
+	pdict_entry_t **new_buckets = pmem_calloc(dict->allocator, new_capacity, sizeof(pdict_entry_t *));
+	if (new_buckets == NULL) {
+		return false;
+	}
+
+	pdict_rehash_finish(dict);
+
+	dict->old_buckets = dict->buckets;
+	dict->old_capacity = dict->capacity;
+	dict->rehash_index = 0;
+
+	dict->buckets = new_buckets;
+	dict->capacity = new_capacity;
+
+	return true;
+}
+
+/**
+ * @brief Looks up the entry stored under key in either table.
+ *
+ * @param dict The dict to search.
+ * @param lookup The key to search for.
+ * @return The entry, or NULL if the key is not in the dict.
+ */
+static pdict_entry_t *pdict_find_entry(const pdict_t *dict, const pdict_key_t *lookup)
+{
+	pdict_entry_t *current = dict->buckets[pdict_bucket_index(lookup->hash, dict->capacity)];
+
+	while (current != NULL) {
+		if (pdict_entry_matches(current, lookup)) {
+			return current;
+		}
+		current = current->next;
+	}
+
+	if (dict->old_buckets == NULL) {
+		return NULL;
+	}
+
+	current = dict->old_buckets[pdict_bucket_index(lookup->hash, dict->old_capacity)];
+
+	while (current != NULL) {
+		if (pdict_entry_matches(current, lookup)) {
+			return current;
+		}
+		current = current->next;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Looks up the value stored under a prepared key, whatever the
+ * dict's backend.
+ *
+ * @param dict The dict to search.
+ * @param lookup The key to search for.
+ * @return A pointer to the value inside the dict, or NULL if not found.
+ */
+static pvar_t *pdict_lookup(const pdict_t *dict, const pdict_key_t *lookup)
+{
+	if (dict->backend == PDICT_BACKEND_FLAT) {
+		return pdict_flat_find(dict, lookup);
+	}
+
+	pdict_entry_t *entry = pdict_find_entry(dict, lookup);
+
+	return entry != NULL ? &entry->value : NULL;
+}
+
+/**
+ * @brief Looks up the value stored under key, whatever the dict's backend.
+ *
+ * @param dict The dict to search.
+ * @param key The key to search for.
+ * @return A pointer to the value inside the dict, or NULL if not found.
+ */
+static pvar_t *pdict_find_value(const pdict_t *dict, const char *key)
+{
+	pdict_key_t lookup;
+
+	pdict_key_init(&lookup, dict, key);
+	return pdict_lookup(dict, &lookup);
+}
+
+/**
+ * @brief Detaches the entry stored under key from its bucket chain.
+ *
+ * @param dict The dict to search.
+ * @param lookup The key to search for.
+ * @return The unlinked entry (now owned by the caller), or NULL if not found.
+ */
+static pdict_entry_t *pdict_unlink_entry(pdict_t *dict, const pdict_key_t *lookup)
+{
+	pdict_entry_t **link = &dict->buckets[pdict_bucket_index(lookup->hash, dict->capacity)];
+
+	while (*link != NULL) {
+		if (pdict_entry_matches(*link, lookup)) {
+			pdict_entry_t *found = *link;
+			*link = found->next;
+			return found;
+		}
+		link = &(*link)->next;
+	}
+
+	if (dict->old_buckets == NULL) {
+		return NULL;
+	}
+
+	link = &dict->old_buckets[pdict_bucket_index(lookup->hash, dict->old_capacity)];
+
+	while (*link != NULL) {
+		if (pdict_entry_matches(*link, lookup)) {
+			pdict_entry_t *found = *link;
+			*link = found->next;
+			return found;
+		}
+		link = &(*link)->next;
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Inserts a new entry into the active table and grows the dict
+ * once the load factor is exceeded.
+ *
+ * Growth is incremental: the bucket array is doubled and existing entries
+ * migrate over the following operations. A failed growth allocation is not
+ * an error; the dict keeps working at a higher load factor.
+ *
+ * @param dict The dict to insert into.
+ * @param entry The entry to link. The key must not already be present.
+ */
+static void pdict_link_entry(pdict_t *dict, pdict_entry_t *entry)
+{
+	size_t bucket_index = pdict_bucket_index(entry->hash, dict->capacity);
+
+	entry->next = dict->buckets[bucket_index];
+	dict->buckets[bucket_index] = entry;
+	dict->count++;
+
+	pdict_rehash_step(dict, PDICT_REHASH_STEP);
+
+	if ((double)dict->count > (double)dict->capacity * dict->max_load_factor) {
+		pdict_rehash_start(dict, dict->capacity * 2);
+	}
+}
+
+/**
+ * @brief Removes the entry stored under key, whatever the dict's backend,
+ * and moves its value out.
+ *
+ * @param dict The dict to modify.
+ * @param key The key to remove.
+ * @param out_value Receives the removed value, now owned by the caller.
+ * @return True on success, false if the key was not found.
+ */
+static bool pdict_extract(pdict_t *dict, const char *key, pvar_t *out_value)
+{
+	pdict_key_t lookup;
+	pdict_key_init(&lookup, dict, key);
+
+	if (dict->backend == PDICT_BACKEND_FLAT) {
+		return pdict_flat_erase(dict, &lookup, out_value);
+	}
+
+	pdict_entry_t *current = pdict_unlink_entry(dict, &lookup);
+	
+	if (current == NULL) {
+		return false;
+	}
+
+	*out_value = current->value;
+	pdict_key_free(dict, current->key);
+	pdict_slab_release(dict, current);
+	
+	dict->count--;
+
+	pdict_rehash_step(dict, PDICT_REHASH_STEP);
+	return true;
+}
+
+/**
+ * @brief Stores a copy of key together with value, whatever the dict's backend.
+ *
+ * The key must not already be present. On failure pvars_errno is set to
+ * entry_failure, key_failure or FAILURE_PDICT_UNSHARE_COPY_FAILED and value
+ * is still owned by the caller.
+ *
+ * @param dict The dict to insert into.
+ * @param lookup The key, as prepared by pdict_key_init(). It is duplicated.
+ * @param value The value. Ownership passes to the dict on success.
+ * @param entry_failure Error reported if the entry could not be stored.
+ * @param key_failure Error reported if the key could not be duplicated.
+ * @return True on success, false on failure.
+ */
+static bool pdict_insert(pdict_t *dict, const pdict_key_t *lookup, const pvar_t *value, perrno_t entry_failure, perrno_t key_failure)
+{
+	if (!pdict_unshare(dict)) {
+		return false;
+	}
+
+	char *new_key = lookup->stored ? pdict_key_clone(dict, (char *)lookup->str) : pdict_key_create(dict, lookup->str, lookup->len);
+	if (new_key == NULL) {
+		pvars_errno = key_failure;
+		return false;
+	}
+
+	if (dict->backend == PDICT_BACKEND_FLAT) {
+		if (!pdict_flat_insert(dict, lookup, new_key, value)) {
+			pdict_key_free(dict, new_key);
+			pvars_errno = entry_failure;
+			return false;
+		}
+		return true;
+	}
+
+	pdict_entry_t *new_entry = pdict_slab_alloc(dict);
+	if (new_entry == NULL) {
+		pdict_key_free(dict, new_key);
+		pvars_errno = entry_failure;
+		return false;
+	}
+
+	new_entry->key = new_key;
+	new_entry->hash = lookup->hash;
+	new_entry->value = *value;
+	pdict_link_entry(dict, new_entry);
+
+	return true;
+}
+
+/**
+ * @brief Adds a value already in stored form under a key of len bytes,
+ * taking ownership of the value. Used by decoders.
+ *
+ * @param dict The dict to insert into.
+ * @param key The key bytes, not necessarily NUL terminated.
+ * @param len Number of key bytes.
+ * @param value The value; its string, if any, was made with the dict's
+ * allocator. Ownership passes to the dict on success.
+ * @param exists_failure Error reported if the key is already present.
+ * @param alloc_failure Error reported if memory ran out.
+ * @return True on success, false on failure (the value is still the caller's).
+ */
+bool pdict_insert_take(pdict_t *dict, const char *key, size_t len, const pvar_t *value, perrno_t exists_failure, perrno_t alloc_failure)
+{
+	pdict_key_t lookup;
+	lookup.str = key;
+	lookup.len = len;
+	lookup.hash = pdict_hash_key(dict, key, len);
+	lookup.stored = false;
+
+	if (pdict_lookup(dict, &lookup) != NULL) {
+		pvars_errno = exists_failure;
+		return false;
+	}
+
+	if (!pdict_insert(dict, &lookup, value, alloc_failure, alloc_failure)) {
+		pvars_errno = alloc_failure;
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Resizes the dict to new_capacity buckets immediately.
+ *
+ * @param dict The dict to resize.
+ * @param new_capacity The new bucket count.
+ * @return True on success, false if the bucket array could not be allocated.
+ */
+static bool pdict_resize_now(pdict_t *dict, size_t new_capacity)
+{
+	if (!pdict_unshare(dict)) {
+		return false;
+	}
+
+	if (dict->backend == PDICT_BACKEND_FLAT) {
+		return new_capacity == dict->capacity || pdict_flat_resize(dict, new_capacity);
+	}
+
+	pdict_rehash_finish(dict);
+
+	if (new_capacity == dict->capacity) {
+		return true;
+	}
+
+	if (!pdict_rehash_start(dict, new_capacity)) {
+		return false;
+	}
+
+	pdict_rehash_finish(dict);
+	return true;
+}
+
+/**
+ * @brief Prepares an iterator over every entry in the dict.
+ *
+ * Entries are visited in table order, including any that are still waiting
+ * to be migrated by an incremental rehash. The dict must not be modified
+ * while the iterator is in use.
+ *
+ * @param iter The iterator to initialise.
+ * @param dict The dict to iterate over.
+ */
+void pdict_iter_init(pdict_iter_t *iter, const pdict_t *dict)
+{
+	iter->dict = dict;
+	iter->bucket = 0;
+	iter->entry = NULL;
+}
+
+/**
+ * @brief Advances the iterator to the next entry.
+ *
+ * @param iter The iterator.
+ * @param out_key Receives the entry's key. May be NULL.
+ * @param out_value Receives a pointer to the entry's value. May be NULL.
+ * @return True if an entry was produced, false once the dict is exhausted.
+ */
+bool pdict_iter_next(pdict_iter_t *iter, const char **out_key, pvar_t **out_value)
+{
+	const pdict_t *dict = iter->dict;
+
+	if (dict->backend == PDICT_BACKEND_FLAT) {
+		while (iter->bucket < dict->capacity) {
+			size_t index = iter->bucket++;
+
+			if (pdict_flat_is_full(dict, index)) {
+				if (out_key != NULL) {
+					*out_key = dict->slots[index].key;
+				}
+				if (out_value != NULL) {
+					*out_value = &dict->slots[index].value;
+				}
+				return true;
+			}
+		}
+		return false;
+	}
+
+	size_t total = dict->old_capacity + dict->capacity;
+
+	while (iter->entry == NULL && iter->bucket < total) {
+		if (iter->bucket < dict->old_capacity) {
+			iter->entry = dict->old_buckets[iter->bucket];
+		} else {
+			iter->entry = dict->buckets[iter->bucket - dict->old_capacity];
+		}
+		iter->bucket++;
+	}
+
+	if (iter->entry == NULL) {
+		return false;
+	}
+
+	if (out_key != NULL) {
+		*out_key = iter->entry->key;
+	}
+	if (out_value != NULL) {
+		*out_value = &iter->entry->value;
+	}
+
+	iter->entry = iter->entry->next;
+	return true;
+}
+
+/**
+ * @brief Creates and initializes a new pdict_t structure using the
+ * default backend (see pdict_set_default_backend()).
+ *
+ * Allocates memory for the dict structure and its initial buckets array.
+ * The buckets array is initialized using calloc and its size is rounded up
+ * to a power of two. The dict grows on its own once it holds more than
+ * capacity * PDICT_DEFAULT_MAX_LOAD_FACTOR entries, so initial_capacity is
+ * only a hint.
+ *
+ * @param initial_capacity The starting capacity for the dict. Must be >= 1.
+ * @return A pointer to the newly created pdict_t structure, or NULL on failure.
+ */
+pdict_t *pdict_create(long int initial_capacity)
+{
+	return pdict_create_with_backend(initial_capacity, pdict_default_backend);
+}
+
+/**
+ * @brief Creates a new pdict_t structure whose memory comes from an arena,
+ * using the default backend.
+ *
+ * Buckets, entries, keys, string values and every list or dict copied into
+ * the dict are allocated from arena. pdict_destroy() is then a no-op: the
+ * whole tree is released with the arena (see parena.h). Functions that
+ * return new data to the caller, such as pdict_get_keys(), still allocate
+ * it on the heap.
+ *
+ * @param arena The arena to allocate from, or NULL for the process wide allocator.
+ * @param initial_capacity The starting capacity for the dict. Must be >= 1.
+ * @return A pointer to the newly created pdict_t structure, or NULL on failure.
+ */
+pdict_t *pdict_create_in(pvars_arena_t *arena, long int initial_capacity)
+{
+	return pdict_create_internal(arena != NULL ? parena_allocator(arena) : NULL, initial_capacity, pdict_default_backend);
+}
+
+/**
+ * @brief Creates a new pdict_t structure whose memory comes from the given
+ * allocator, using the default backend.
+ *
+ * The dict keeps the allocator for its whole life: buckets, entries, keys,
+ * strings and nested copies are allocated with it and returned to it.
+ *
+ * @param allocator The allocator to use, or NULL for the process wide one
+ * (see pvars_set_allocator()). It must outlive the dict.
+ * @param initial_capacity The starting capacity for the dict. Must be >= 1.
+ * @return A pointer to the newly created pdict_t structure, or NULL on failure.
+ */
+pdict_t *pdict_create_with_allocator(const pvars_allocator_t *allocator, long int initial_capacity)
+{
+	return pdict_create_internal(allocator, initial_capacity, pdict_default_backend);
+}
+
+/**
+ * @brief Creates and initializes a new pdict_t structure with the given
+ * storage backend.
+ *
+ * The capacity is rounded up to a power of two, and PDICT_BACKEND_FLAT
+ * uses at least PDICT_GROUP_WIDTH slots. Keys are hashed with
+ * PDICT_HASH_WYHASH and a random per-dict seed.
+ *
+ * @param initial_capacity The starting capacity for the dict. Must be >= 1.
+ * @param backend The storage layout of the dict.
+ * @return A pointer to the newly created pdict_t structure, or NULL on failure.
+ */
+pdict_t *pdict_create_with_backend(long int initial_capacity, pdict_backend backend)
+{
+	return pdict_create_internal(NULL, initial_capacity, backend);
+}
+
+/**
+ * @brief Creates a dict with the given allocator (NULL for the process wide
+ * one) and backend. See pdict_create_with_backend().
+ */
+static pdict_t *pdict_create_internal(const pvars_allocator_t *allocator, long int initial_capacity, pdict_backend backend)
+{
+	pvars_errno = PERRNO_CLEAR;
+	
+	if (initial_capacity < 1) {
+		pvars_errno = FAILURE_PDICT_CREATE_CAPACITY_OUT_OF_BOUNDS;
+		return NULL;
+	}
+
+	if (backend != PDICT_BACKEND_CHAINED && backend != PDICT_BACKEND_FLAT) {
+		pvars_errno = FAILURE_PDICT_CREATE_UNKNOWN_BACKEND;
+		return NULL;
+	}
+
+	if (allocator == NULL) {
+		allocator = pmem_default();
+	}
+
+	pdict_t *new_dict = pmem_malloc(allocator, sizeof(pdict_t));
+	if (new_dict == NULL) {
+		pvars_errno = FAILURE_PDICT_CREATE_NEW_DICT_MALLOC_FAILED;
+		return NULL;
+	}
+
+	new_dict->allocator = allocator;
+	new_dict->intern_keys = pvars_get_key_interning() && !parena_owns(allocator);
+	new_dict->slabs = NULL;
+	new_dict->free_entries = NULL;
+	new_dict->slab_count = 0;
+	new_dict->slab_capacity = 0;
+	new_dict->free_count = 0;
+	new_dict->buckets = NULL;
+	new_dict->count = 0;
+	new_dict->old_buckets = NULL;
+	new_dict->old_capacity = 0;
+	new_dict->rehash_index = 0;
+	new_dict->max_load_factor = PDICT_DEFAULT_MAX_LOAD_FACTOR;
+	new_dict->backend = backend;
+	new_dict->ctrl = NULL;
+	new_dict->slots = NULL;
+	new_dict->growth_left = 0;
+	new_dict->hash_function = PDICT_HASH_WYHASH;
+	new_dict->seed = phash_random_seed();
+	atomic_init(&new_dict->share, NULL);
+
+	size_t capacity = pdict_round_pow2((size_t)initial_capacity);
+
+	if (backend == PDICT_BACKEND_FLAT) {
+		if (capacity < PDICT_GROUP_WIDTH) {
+			capacity = PDICT_GROUP_WIDTH;
+		}
+
+		if (!pdict_flat_init(new_dict, capacity)) {
+			pmem_free(allocator, new_dict, sizeof(pdict_t));
+			pvars_errno = FAILURE_PDICT_CREATE_NEW_DICT_BUCKETS_MALLOC_FAILED;
+			return NULL;
+		}
+
+		return new_dict;
+	}
+
+	// Use calloc for pvar_t structs: initializes type to PVAR_TYPE_NONE (0) and data union to zero (NULL pointer)
+	new_dict->buckets = pmem_calloc(allocator, capacity, sizeof(pdict_entry_t *));
+	if (new_dict->buckets == NULL) {
+		pmem_free(allocator, new_dict, sizeof(pdict_t));
+		pvars_errno = FAILURE_PDICT_CREATE_NEW_DICT_BUCKETS_MALLOC_FAILED;
+		return NULL;
+	}
+	
+	new_dict->capacity = capacity;
+
+	return new_dict;
+}
+
+/**
+ * @brief Creates a dict with the given allocator (NULL for the process wide
+ * one) and the default backend, sized to take count entries without
+ * growing: the table stays within the load factor and a chained dict has
+ * one slab of exactly count entries. For decoders, which know the size of
+ * every dict before filling it.
+ *
+ * @return The dict, or NULL on failure (with pvars_errno set).
+ */
+pdict_t *pdict_create_sized(const pvars_allocator_t *allocator, size_t count)
+{
+	pdict_t shape = { .backend = pdict_default_backend, .max_load_factor = PDICT_DEFAULT_MAX_LOAD_FACTOR };
+	size_t capacity = pdict_buckets_for(&shape, count);
+
+	pdict_t *dict = pdict_create_internal(allocator, capacity > LONG_MAX ? LONG_MAX : (long int)capacity, pdict_default_backend);
+	if (dict == NULL) {
+		return NULL;
+	}
+
+	if (dict->backend == PDICT_BACKEND_CHAINED && count > 0 && !pdict_slab_reserve(dict, count)) {
+		pdict_destroy(dict);
+		pvars_errno = FAILURE_PDICT_CREATE_NEW_DICT_MALLOC_FAILED;
+		return NULL;
+	}
+
+	return dict;
+}
+
+/**
+ * @brief Sets the backend used by subsequent calls to pdict_create().
+ *
+ * Existing dicts keep their backend. Copies always use the backend of
+ * their source.
+ *
+ * @param backend The new default backend.
+ */
+void pdict_set_default_backend(pdict_backend backend)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (backend != PDICT_BACKEND_CHAINED && backend != PDICT_BACKEND_FLAT) {
+		pvars_errno = FAILURE_PDICT_SET_DEFAULT_BACKEND_UNKNOWN_BACKEND;
+		return;
+	}
+
+	pdict_default_backend = backend;
+}
+
+/**
+ * @brief Returns the storage backend of a dict.
+ *
+ * @param dict The dict to query.
+ * @return The dict's backend, or PDICT_BACKEND_CHAINED if the dict is NULL.
+ */
+pdict_backend pdict_get_backend(const pdict_t *dict)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_GET_BACKEND_NULL_INPUT;
+		return PDICT_BACKEND_CHAINED;
+	}
+
+	return dict->backend;
+}
+
+/**
+ * @brief Deep copies a pdict_entry_t variable into an entry of dict.
+ *
+ * @param The dict the copy is for. It is not linked in.
+ * @param pdict_entry_t
+ */
+static pdict_entry_t *pdict_entry_copy(pdict_t *dict, const pdict_entry_t *src)
+{
+	pvars_errno = PERRNO_CLEAR;
+	
+	if (src == NULL) {
+		pvars_errno = FAILURE_PDICT_ENTRY_COPY_NULL_INPUT;
+		return NULL;
+	}
+	
+	pdict_entry_t *dest = pdict_slab_alloc(dict);
+	if (dest == NULL) {
+		pvars_errno = FAILURE_PDICT_ENTRY_COPY_NEW_ENTRY_MALLOC_FAILED;
+		return NULL;
+	}
+	
+	pvar_t new_pvar = pvar_copy_in(dict->allocator, &src->value);
+	if (pvars_errno != SUCCESS) {
+		pvars_errno = FAILURE_PDICT_ENTRY_COPY_PVAR_COPY_FAILED;
+		pdict_slab_release(dict, dest);
+		return NULL;
+	}
+	
+	char *key = pdict_key_clone(dict, src->key);
+	if (key == NULL) {
+		pvars_errno = FAILURE_PDICT_ENTRY_COPY_STRDUP_FAILED;
+		pvar_destroy_in(dict->allocator, &new_pvar);
+		pdict_slab_release(dict, dest);
+		return NULL;
+	}
+	
+	dest->value = new_pvar;
+	dest->key = key;
+	dest->hash = src->hash;
+	dest->next = NULL; 
+	
+	pvars_errno = SUCCESS;
+	return dest;
+}
+
+/**
+ * @brief Copy a dict.
+ *
+ * The copy behaves as an independent deep copy, but costs O(1): it shares
+ * the entries of src until either dict is modified, and the first change
+ * through either one copies the entries for that dict alone. Nested lists
+ * and dicts are shared the same way, so only the path that is written to
+ * is ever copied. Dicts in an arena are copied eagerly.
+ *
+ * A copied dict has the same capacity and load factor as src. Entries still
+ * waiting on an incremental rehash in src are placed directly into the
+ * copy's single table.
+ *
+ * @param dict
+ */
+pdict_t *pdict_copy(const pdict_t *src)
+{
+	return pdict_copy_in(NULL, src);
+}
+
+/**
+ * @brief Copy a dict with the given allocator (NULL for the process wide
+ * one). The copy shares the entries of src if both use the same allocator
+ * (see pdict_copy()), and is a deep copy otherwise.
+ *
+ * @param allocator Where the copy is allocated.
+ * @param src The dict to copy.
+ * @return The copy, or NULL on failure.
+ */
+pdict_t *pdict_copy_in(const pvars_allocator_t *allocator, const pdict_t *src)
+{
+	pvars_errno = PERRNO_CLEAR;
+	
+	if (src == NULL) {
+		pvars_errno = FAILURE_PDICT_COPY_NULL_INPUT;
+		return NULL;
+	}
+
+	if (allocator == NULL) {
+		allocator = pmem_default();
+	}
+
+	if (allocator != src->allocator || parena_owns(allocator)) {
+		return pdict_copy_deep(allocator, src, pvars_get_key_interning());
+	}
+
+	pdict_t *new_dict = pmem_malloc(allocator, sizeof(pdict_t));
+	/* Sharing only records another handle, src is left as it was */
+	pshare_t *share = new_dict != NULL ? pshare_acquire(allocator, &((pdict_t *)src)->share) : NULL;
+
+	if (share == NULL) {
+		pmem_free(allocator, new_dict, sizeof(pdict_t));
+		pvars_errno = FAILURE_PDICT_COPY_PDICT_CREATE_FAILED;
+		return NULL;
+	}
+
+	memcpy(new_dict, src, offsetof(pdict_t, share));
+	atomic_init(&new_dict->share, share);
+
+	pvars_errno = SUCCESS;
+	return new_dict;
+}
+
+/**
+ * @brief Deep copies a dict: every entry is duplicated, nested lists and
+ * dicts are copied with pvar_copy_in().
+ *
+ * @param allocator Where the copy is allocated (NULL for the process wide one).
+ * @param src The dict to copy.
+ * @param intern_keys Whether the copy takes its keys from the intern pool.
+ * @return The copy, or NULL on failure (with pvars_errno set).
+ */
+static pdict_t *pdict_copy_deep(const pvars_allocator_t *allocator, const pdict_t *src, bool intern_keys)
+{
+	pdict_t *new_dict = pdict_create_internal(allocator, src->capacity, src->backend);
+	if (new_dict == NULL) {
+		pvars_errno = FAILURE_PDICT_COPY_PDICT_CREATE_FAILED;
+		return NULL;
+	}
+
+	new_dict->intern_keys = intern_keys && !parena_owns(new_dict->allocator);
+	new_dict->max_load_factor = src->max_load_factor;
+
+	/* Same hash and seed, so that the cached entry hashes stay valid */
+	new_dict->hash_function = src->hash_function;
+	new_dict->seed = src->seed;
+
+	if (src->backend == PDICT_BACKEND_FLAT) {
+		for (size_t i = 0; i < src->capacity; i++) {
+			if (!pdict_flat_is_full(src, i)) {
+				continue;
+			}
+
+			const pdict_slot_t *slot = &src->slots[i];
+			pvar_t new_value = pvar_copy_in(new_dict->allocator, &slot->value);
+			if (pvars_errno != SUCCESS) {
+				pvars_errno = FAILURE_PDICT_COPY_PDICT_ENTRY_COPY_FAILED;
+				pdict_destroy(new_dict);
+				return NULL;
+			}
+
+			/* The cached hash is reused, the key is not rehashed */
+			pdict_key_t lookup = { slot->key, pstr_len(slot->key), slot->hash, true };
+
+			if (!pdict_insert(new_dict, &lookup, &new_value, FAILURE_PDICT_COPY_PDICT_ENTRY_COPY_FAILED, FAILURE_PDICT_COPY_PDICT_ENTRY_COPY_FAILED)) {
+				pvar_destroy_in(new_dict->allocator, &new_value);
+				pdict_destroy(new_dict);
+				return NULL;
+			}
+		}
+
+		pvars_errno = SUCCESS;
+		return new_dict;
+	}
+	
+	for (size_t i = 0; i < src->old_capacity + src->capacity; i++) {
+		pdict_entry_t *current;
+
+		if (i < src->old_capacity) {
+			current = src->old_buckets[i];
+		} else {
+			current = src->buckets[i - src->old_capacity];
+		}
+		
+		while (current != NULL) {
+			pdict_entry_t *new_entry = pdict_entry_copy(new_dict, current);
+			if (new_entry == NULL) {
+				pvars_errno = FAILURE_PDICT_COPY_PDICT_ENTRY_COPY_FAILED;
+				pdict_destroy(new_dict);
+				return NULL;
+			}
+
+			size_t bucket_index = pdict_bucket_index(new_entry->hash, new_dict->capacity);
+			new_entry->next = new_dict->buckets[bucket_index];
+			new_dict->buckets[bucket_index] = new_entry;
+			new_dict->count++;
+			
+			current = current->next;
+		}
+	}
+	
+	pvars_errno = SUCCESS;
+	
+	return new_dict;
+}
+
+/**
+ * @brief Frees every entry chained from a bucket array.
+ *
+ * @param dict The dict owning the entries.
+ * @param buckets The bucket array to clear. Slots are reset to NULL.
+ * @param capacity Number of slots in the bucket array.
+ */
+static void pdict_free_buckets(pdict_t *dict, pdict_entry_t **buckets, size_t capacity)
+{
+	for (size_t i = 0; i < capacity; i++) {
+		pdict_entry_t *current = buckets[i];
+		pdict_entry_t *next_entry;
+		
+		while (current != NULL) {
+			next_entry = current->next;
+			if (current->key != NULL) {
+				pdict_key_free(dict, current->key);
+			}
+			
+			pvar_destroy_in(dict->allocator, &(current->value));
+			
+			pdict_slab_release(dict, current);
+			current = next_entry;
+		}
+		
+		buckets[i] = NULL;
+	}
+}
+
+/**
+ * @brief Frees the entries, slabs and tables of a dict, but not the dict
+ * structure itself.
+ *
+ * @param dict The dict, which must not share its entries.
+ */
+static void pdict_free_contents(pdict_t *dict)
+{
+	pdict_empty(dict);
+	pdict_slab_destroy(dict);
+	
+	if (dict->backend == PDICT_BACKEND_FLAT) {
+		pmem_free(dict->allocator, dict->ctrl, dict->capacity + PDICT_GROUP_WIDTH);
+		pmem_free(dict->allocator, dict->slots, dict->capacity * sizeof(pdict_slot_t));
+	} else {
+		pmem_free(dict->allocator, dict->buckets, dict->capacity * sizeof(pdict_entry_t *));
+	}
+}
+
+/**
+ * @brief Moves the contents of fresh into dict, which drops its reference
+ * on the entries it shared. fresh itself is freed.
+ *
+ * @param dict A dict sharing its entries with copies.
+ * @param fresh A dict with the same allocator and entries of its own.
+ * @param share The count dict was holding a reference on.
+ */
+static void pdict_adopt(pdict_t *dict, pdict_t *fresh, pshare_t *share)
+{
+	pdict_t shared;
+
+	memcpy(&shared, dict, offsetof(pdict_t, share));
+	atomic_init(&shared.share, NULL);
+
+	memcpy(dict, fresh, offsetof(pdict_t, share));
+	atomic_store(&dict->share, NULL);
+	pmem_free(dict->allocator, fresh, sizeof(pdict_t));
+
+	/* The other handles may all have let go while the entries were copied */
+	if (pshare_release(dict->allocator, share)) {
+		pdict_free_contents(&shared);
+	}
+}
 
 /**
- * @brief Creates a hash value from the key and capacity given
+ * @brief Gives the dict entries of its own before it is modified, if it
+ * shares them with copies (see pdict_copy()).
  *
- * @param key string
- * @param capacity
- * @return a hash value stored in size_t variable.
+ * Keys and strings are duplicated, nested lists and dicts are shared again.
+ *
+ * @param dict The dict about to be modified.
+ * @return True on success, false if the copy failed (with pvars_errno set).
  */
-size_t pdict_hash(const char *key, size_t capacity)
+static bool pdict_unshare(pdict_t *dict)
 {
-	unsigned long hash = 5381;
-	int c;
+	pshare_t *share = atomic_load(&dict->share);
+
+	if (share == NULL) {
+		return true;
+	}
+
+	if (!pshare_is_shared(share)) {
+		/* The other handles are gone, the entries are ours */
+		pshare_release(dict->allocator, share);
+		atomic_store(&dict->share, NULL);
+		return true;
+	}
 
-	// Standard DJB2 loop
-	while ((c = *key++)) {
-		// hash * 33 + c
-		hash = ((hash << 5) + hash) + c; 
+	pdict_t *fresh = pdict_copy_deep(dict->allocator, dict, dict->intern_keys);
+	if (fresh == NULL) {
+		pvars_errno = FAILURE_PDICT_UNSHARE_COPY_FAILED;
+		return false;
 	}
 
-	// Modulo operation to fit the hash into the table capacity
-	return (size_t)(hash % capacity);
+	pdict_adopt(dict, fresh, share);
+	return true;
 }
 
 /**
- * @brief Creates and initializes a new pdict_t structure.
+ * @brief Unshares a dict about to have the value at *current replaced, and
+ * looks the value up again if its entries were copied.
  *
- * Allocates memory for the dict structure and its initial buckets array.
- * The buckets array is initialized using calloc
+ * @param dict The dict about to be modified.
+ * @param key The key of the value.
+ * @param current The value found under key, updated on return.
+ * @return True on success, false if the copy failed (with pvars_errno set).
+ */
+static bool pdict_unshare_value(pdict_t *dict, const char *key, pvar_t **current)
+{
+	if (atomic_load(&dict->share) == NULL) {
+		return true;
+	}
+
+	if (!pdict_unshare(dict)) {
+		return false;
+	}
+
+	*current = pdict_find_value(dict, key);
+	return true;
+}
+
+/**
+ * @brief Empties the dict, but leaves dict and dict->buckets
+ * memory intact for future use. The entry slabs are kept as well, so
+ * refilling the dict does not allocate entries again.
  *
- * @param initial_capacity The starting capacity for the dict. Must be >= 1.
- * @return A pointer to the newly created pdict_t structure, or NULL on failure.
+ * @param The dict to be emptied
+ * @return void
  */
-pdict_t *pdict_create(long int initial_capacity)
+void pdict_empty(pdict_t *dict)
 {
-	pvars_errno = PERRNO_CLEAR;
-	
-	if (initial_capacity < 1) {
-		pvars_errno = FAILURE_PDICT_CREATE_CAPACITY_OUT_OF_BOUNDS;
-		return NULL;
+	if (dict == NULL) {
+		return;
 	}
 
-	pdict_t *new_dict = malloc(sizeof(pdict_t));
-	if (new_dict == NULL) {
-		pvars_errno = FAILURE_PDICT_CREATE_NEW_DICT_MALLOC_FAILED;
-		return NULL;
+	pshare_t *share = atomic_load(&dict->share);
+
+	/* Shared entries are left to the other handles, not copied */
+	if (pshare_is_shared(share)) {
+		pdict_t *fresh = pdict_create_internal(dict->allocator, (long int)dict->capacity, dict->backend);
+		if (fresh == NULL) {
+			pvars_errno = FAILURE_PDICT_UNSHARE_COPY_FAILED;
+			return;
+		}
+
+		fresh->intern_keys = dict->intern_keys;
+		fresh->max_load_factor = dict->max_load_factor;
+		fresh->hash_function = dict->hash_function;
+		fresh->seed = dict->seed;
+
+		pdict_adopt(dict, fresh, share);
+		return;
 	}
 
-	// Use calloc for pvar_t structs: initializes type to PVAR_TYPE_NONE (0) and data union to zero (NULL pointer)
-	new_dict->buckets = calloc((size_t)initial_capacity, sizeof(pdict_entry_t *));
-	if (new_dict->buckets == NULL) {
-		free(new_dict);
-		pvars_errno = FAILURE_PDICT_CREATE_NEW_DICT_BUCKETS_MALLOC_FAILED;
-		return NULL;
+	if (dict->backend == PDICT_BACKEND_FLAT) {
+		pdict_flat_clear(dict);
+		return;
+	}
+
+	if (dict->buckets == NULL) {
+		return;
 	}
 	
-	new_dict->capacity = (size_t)initial_capacity;
-	new_dict->count = 0;
+	pdict_free_buckets(dict, dict->buckets, dict->capacity);
 
-	return new_dict;
+	if (dict->old_buckets != NULL) {
+		pdict_free_buckets(dict, dict->old_buckets, dict->old_capacity);
+		pmem_free(dict->allocator, dict->old_buckets, dict->old_capacity * sizeof(pdict_entry_t *));
+		dict->old_buckets = NULL;
+		dict->old_capacity = 0;
+		dict->rehash_index = 0;
+	}
+	
+	dict->count = 0;
 }
 
 /**
- * @brief Deep copies a pdict_entry_t variable.
+ * @brief Destroys all the memory associated with the dict. A dict created
+ * in an arena is left alone: it is released together with the arena.
  *
- * @param pdict_entry_t
+ * @param The dict to be destroyed
+ * @return void
  */
-pdict_entry_t *pdict_entry_copy(const pdict_entry_t *src)
+void pdict_destroy(pdict_t *dict)
 {
-	pvars_errno = PERRNO_CLEAR;
-	
-	if (src == NULL) {
-		pvars_errno = FAILURE_PDICT_ENTRY_COPY_NULL_INPUT;
-		return NULL;
+	if (dict == NULL || parena_owns(dict->allocator)) {
+		return;
 	}
 	
-	pdict_entry_t *dest = calloc(1, sizeof(pdict_entry_t));
-	if (dest == NULL) {
-		pvars_errno = FAILURE_PDICT_ENTRY_COPY_NEW_ENTRY_MALLOC_FAILED;
-		return NULL;
+	pshare_t *share = atomic_load(&dict->share);
+	atomic_store(&dict->share, NULL);
+
+	/* Entries still shared with a copy stay with the copy */
+	if (pshare_release(dict->allocator, share)) {
+		pdict_free_contents(dict);
 	}
 	
-	pvar_t new_pvar = pvar_copy(&src->value);
-	if (pvars_errno != SUCCESS) {
-		pvars_errno = FAILURE_PDICT_ENTRY_COPY_PVAR_COPY_FAILED;
-		free(dest);
-		return NULL;
+	pmem_free(dict->allocator, dict, sizeof(pdict_t));
+}
+
+/**
+ * @brief Pre-sizes the dict so that it can hold expected_count entries
+ * without growing again.
+ *
+ * Unlike automatic growth, the resize happens immediately.
+ *
+ * @param dict The dict to resize.
+ * @param expected_count The number of entries the dict should accommodate.
+ */
+void pdict_reserve(pdict_t *dict, size_t expected_count)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_RESERVE_NULL_INPUT;
+		return;
 	}
-	
-	char *key = strdup(src->key);
-	if (key == NULL) {
-		pvars_errno = FAILURE_PDICT_ENTRY_COPY_STRDUP_FAILED;
-		free(dest);
-		return NULL;
+
+	size_t needed = pdict_buckets_for(dict, expected_count);
+	if (needed <= dict->capacity) {
+		return;
 	}
-	
-	dest->value = new_pvar;
-	dest->key = key;
-	dest->next = NULL; 
-	
+
+	if (!pdict_resize_now(dict, needed)) {
+		pvars_errno = FAILURE_PDICT_RESERVE_BUCKETS_MALLOC_FAILED;
+		return;
+	}
+
 	pvars_errno = SUCCESS;
-	return dest;
 }
 
 /**
- * @brief Deep copy a dict.
+ * @brief Shrinks the bucket array to the smallest size that holds the
+ * current entries within the maximum load factor, and frees the entry
+ * slabs that are no longer in use.
  *
- * @param dict
+ * @param dict The dict to shrink.
  */
-pdict_t *pdict_copy(const pdict_t *src)
+void pdict_shrink_to_fit(pdict_t *dict)
 {
 	pvars_errno = PERRNO_CLEAR;
-	
-	if (src == NULL) {
-		pvars_errno = FAILURE_PDICT_COPY_NULL_INPUT;
-		return NULL;
+
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_SHRINK_TO_FIT_NULL_INPUT;
+		return;
 	}
-	
-	pdict_t *new_dict = pdict_create(src->capacity);
-	if (new_dict == NULL) {
-		pvars_errno = FAILURE_PDICT_COPY_PDICT_CREATE_FAILED;
-		return NULL;
+
+	if (!pdict_unshare(dict)) {
+		return;
 	}
-	
-	for (size_t i = 0; i < src->capacity; i++) {
-		pdict_entry_t *current = src->buckets[i];
-		pdict_entry_t *new_head = NULL;
-		pdict_entry_t *new_tail = NULL;
-		
-		while (current != NULL) {
-			pdict_entry_t *new_entry = pdict_entry_copy(current);
-			if (new_entry == NULL) {
-				pvars_errno = FAILURE_PDICT_COPY_PDICT_ENTRY_COPY_FAILED;
-				pdict_destroy(new_dict);
-				return NULL;
-			}
-			
-			if (new_head == NULL) {
-				new_head = new_entry;
-				new_tail = new_entry;
-			} else {
-				new_tail->next = new_entry;
-				new_tail = new_entry;
-			}
-			
-			current = current->next;
-		}
-		
-		new_dict->buckets[i] = new_head;
+
+	pdict_slab_trim(dict);
+
+	size_t needed = pdict_buckets_for(dict, dict->count);
+	if (needed >= dict->capacity) {
+		pdict_rehash_finish(dict);
+		return;
 	}
-	
-	new_dict->count = src->count;
-	
+
+	if (!pdict_resize_now(dict, needed)) {
+		pvars_errno = FAILURE_PDICT_SHRINK_TO_FIT_BUCKETS_MALLOC_FAILED;
+		return;
+	}
+
 	pvars_errno = SUCCESS;
-	
-	return new_dict;
 }
 
 /**
- * @brief Empties the dict, but leaves dict and dict->buckets
- * memory intact for future use.
+ * @brief Sets the load factor (entries per bucket) above which the dict grows.
  *
- * @param The dict to be emptied
- * @return void
+ * Lower values trade memory for shorter chains. If the dict is already above
+ * the new limit, growth begins on the next insertion.
+ *
+ * @param dict The dict to configure.
+ * @param max_load_factor The new limit. Must be > 0.
  */
-void pdict_empty(pdict_t *dict)
+void pdict_set_max_load_factor(pdict_t *dict, double max_load_factor)
 {
-	if (dict == NULL || dict->buckets == NULL) {
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_SET_MAX_LOAD_FACTOR_NULL_INPUT;
 		return;
 	}
-	
-	for (size_t i = 0; i < dict->capacity; i++) {
-		pdict_entry_t *current = dict->buckets[i];
-		pdict_entry_t *next_entry;
-		
-		while (current != NULL) {
-			next_entry = current->next;
-			if (current->key != NULL) {
-				free(current->key);
+
+	/* Written this way round so that NaN is rejected too */
+	if (!(max_load_factor > 0.0)) {
+		pvars_errno = FAILURE_PDICT_SET_MAX_LOAD_FACTOR_OUT_OF_BOUNDS;
+		return;
+	}
+
+	dict->max_load_factor = max_load_factor;
+}
+
+/**
+ * @brief Returns the load factor above which the dict grows.
+ *
+ * @param dict The dict to query.
+ * @return The maximum load factor, or 0 if the dict is NULL.
+ */
+double pdict_get_max_load_factor(const pdict_t *dict)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL) {
+		return 0.0;
+	}
+
+	return dict->max_load_factor;
+}
+
+/**
+ * @brief Recomputes the cached hash of every entry from the dict's current
+ * hash function and seed. Entries are not moved.
+ *
+ * @param dict The dict to update.
+ */
+static void pdict_recompute_hashes(pdict_t *dict)
+{
+	if (dict->backend == PDICT_BACKEND_FLAT) {
+		for (size_t i = 0; i < dict->capacity; i++) {
+			if (pdict_flat_is_full(dict, i)) {
+				pdict_slot_t *slot = &dict->slots[i];
+				slot->hash = pdict_hash_key(dict, slot->key, pstr_len(slot->key));
 			}
-			
-			pvar_destroy_internal(&(current->value));
-			
-			free(current);
-			current = next_entry;
 		}
-		
-		dict->buckets[i] = NULL;
+		return;
+	}
+
+	for (size_t i = 0; i < dict->old_capacity + dict->capacity; i++) {
+		pdict_entry_t *current;
+
+		if (i < dict->old_capacity) {
+			current = dict->old_buckets[i];
+		} else {
+			current = dict->buckets[i - dict->old_capacity];
+		}
+
+		while (current != NULL) {
+			current->hash = pdict_hash_key(dict, current->key, pstr_len(current->key));
+			current = current->next;
+		}
 	}
-	
-	dict->count = 0;
 }
 
 /**
- * @brief Destroys all the memory associated with the dict
+ * @brief Switches the dict to a new hash function and seed, rehashing and
+ * redistributing every entry immediately.
  *
- * @param The dict to be destroyed
- * @return void
+ * @param dict The dict to update.
+ * @param hash_function The new hash function.
+ * @param seed The new seed.
+ * @return True on success, false if the new table could not be allocated
+ * (the dict keeps its previous hash function and seed).
+ */
+static bool pdict_rehash_all(pdict_t *dict, pdict_hash_function hash_function, uint64_t seed)
+{
+	if (!pdict_unshare(dict)) {
+		return false;
+	}
+
+	pdict_hash_function old_hash_function = dict->hash_function;
+	uint64_t old_seed = dict->seed;
+
+	dict->hash_function = hash_function;
+	dict->seed = seed;
+
+	if (dict->count == 0) {
+		return true;
+	}
+
+	pdict_recompute_hashes(dict);
+
+	bool rebuilt;
+
+	if (dict->backend == PDICT_BACKEND_FLAT) {
+		rebuilt = pdict_flat_resize(dict, dict->capacity);
+	} else {
+		rebuilt = pdict_rehash_start(dict, dict->capacity);
+		if (rebuilt) {
+			pdict_rehash_finish(dict);
+		}
+	}
+
+	if (!rebuilt) {
+		dict->hash_function = old_hash_function;
+		dict->seed = old_seed;
+		pdict_recompute_hashes(dict);
+	}
+
+	return rebuilt;
+}
+
+/**
+ * @brief Selects the function used to hash the dict's keys.
+ *
+ * Existing entries are rehashed immediately. The dict's seed is kept.
+ *
+ * @param dict The dict to configure.
+ * @param hash_function PDICT_HASH_WYHASH (the default) or PDICT_HASH_DJB2.
+ */
+void pdict_set_hash_function(pdict_t *dict, pdict_hash_function hash_function)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_SET_HASH_FUNCTION_NULL_INPUT;
+		return;
+	}
+
+	if (hash_function != PDICT_HASH_WYHASH && hash_function != PDICT_HASH_DJB2) {
+		pvars_errno = FAILURE_PDICT_SET_HASH_FUNCTION_UNKNOWN_FUNCTION;
+		return;
+	}
+
+	if (hash_function == dict->hash_function) {
+		return;
+	}
+
+	if (!pdict_rehash_all(dict, hash_function, dict->seed)) {
+		pvars_errno = FAILURE_PDICT_SET_HASH_FUNCTION_REHASH_MALLOC_FAILED;
+		return;
+	}
+
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Returns the function used to hash the dict's keys.
+ *
+ * @param dict The dict to query.
+ * @return The dict's hash function, or PDICT_HASH_WYHASH if the dict is NULL.
+ */
+pdict_hash_function pdict_get_hash_function(const pdict_t *dict)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_GET_HASH_FUNCTION_NULL_INPUT;
+		return PDICT_HASH_WYHASH;
+	}
+
+	return dict->hash_function;
+}
+
+/**
+ * @brief Replaces the dict's random hash seed, e.g. to make bucket layout
+ * reproducible while debugging.
+ *
+ * A fixed seed lets anyone who knows it craft colliding keys, so leave the
+ * random seed in place for dicts keyed by untrusted input. Existing entries
+ * are rehashed immediately.
+ *
+ * @param dict The dict to configure.
+ * @param seed The new seed.
  */
-void pdict_destroy(pdict_t *dict)
+void pdict_set_hash_seed(pdict_t *dict, uint64_t seed)
 {
+	pvars_errno = PERRNO_CLEAR;
+
 	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_SET_HASH_SEED_NULL_INPUT;
 		return;
 	}
-	
-	pdict_empty(dict);
-	
-	free(dict->buckets);
-	
-	free(dict);
+
+	if (seed == dict->seed) {
+		return;
+	}
+
+	if (!pdict_rehash_all(dict, dict->hash_function, seed)) {
+		pvars_errno = FAILURE_PDICT_SET_HASH_SEED_REHASH_MALLOC_FAILED;
+		return;
+	}
+
+	pvars_errno = SUCCESS;
 }
 
 /**
@@ -234,45 +1507,46 @@ void pdict_print_internal(const pdict_t *dict)
 	pvars_errno = PERRNO_CLEAR;
 
 	putchar('[');
+
+	pdict_iter_t iter;
+	const char *key;
+	pvar_t *value;
+
+	pdict_iter_init(&iter, dict);
 	
-	for (size_t i = 0; i < dict->capacity; i++) {
-		pdict_entry_t *current = dict->buckets[i];
-		while (current != NULL) {			
-			printf("[Key: \"%s\" | Value: ", current->key);
-			
-			switch (current->value.type) {
-				case PVAR_TYPE_STRING:
-					printf("\'%s\']", current->value.data.s);
-					break;
-				case PVAR_TYPE_LIST:	
-					plist_print_internal(current->value.data.ls);
-					putchar(']');
-					break;
-				case PVAR_TYPE_DICT:
-					pdict_print_internal(current->value.data.dt);
-					putchar(']');
-					break;
-				case PVAR_TYPE_INT:
-					printf("%d]", current->value.data.i);
-					break;
-				case PVAR_TYPE_DOUBLE:
-					printf("%lf]", current->value.data.d);
-					break;
-				case PVAR_TYPE_LONG:
-					printf("%d]", current->value.data.i);
-					break;
-				case PVAR_TYPE_FLOAT:
-					printf("%f]", current->value.data.f);
-					break;
-				case PVAR_TYPE_NONE:
-					printf("[TYPE: NONE]");
-					break;
-				default:
-					printf("[TYPE: UNKNOWN]");
-					break;
-			}
-			
-			current = current->next;
+	while (pdict_iter_next(&iter, &key, &value)) {
+		printf("[Key: \"%s\" | Value: ", key);
+		
+		switch (value->type) {
+			case PVAR_TYPE_STRING:
+				printf("\'%s\']", pvar_str(value));
+				break;
+			case PVAR_TYPE_LIST:	
+				plist_print_internal(value->data.ls);
+				putchar(']');
+				break;
+			case PVAR_TYPE_DICT:
+				pdict_print_internal(value->data.dt);
+				putchar(']');
+				break;
+			case PVAR_TYPE_INT:
+				printf("%d]", value->data.i);
+				break;
+			case PVAR_TYPE_DOUBLE:
+				printf("%lf]", value->data.d);
+				break;
+			case PVAR_TYPE_LONG:
+				printf("%d]", value->data.i);
+				break;
+			case PVAR_TYPE_FLOAT:
+				printf("%f]", value->data.f);
+				break;
+			case PVAR_TYPE_NONE:
+				printf("[TYPE: NONE]");
+				break;
+			default:
+				printf("[TYPE: UNKNOWN]");
+				break;
 		}
 	}
 	
@@ -353,14 +1627,10 @@ pvar_type pdict_get_type(const pdict_t *dict, const char *key)
 		return PVAR_TYPE_NONE;
 	}
 	
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
+	pvar_t *current = pdict_find_value(dict, key);
 
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			return current->value.type;
-		}
-		current = current->next;
+	if (current != NULL) {
+		return current->type;
 	}
 	
 	pvars_errno = FAILURE_PDICT_GET_TYPE_KEY_NOT_FOUND;
@@ -388,14 +1658,10 @@ bool pdict_contains(const pdict_t *dict, const char *key)
 		return false;
 	}
 	
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
+	pvar_t *current = pdict_find_value(dict, key);
 
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			return true;
-		}
-		current = current->next;
+	if (current != NULL) {
+		return true;
 	}
 	
 	return false;
@@ -422,17 +1688,17 @@ plist_t *pdict_get_keys(const pdict_t * dict)
 		return NULL;
 	}
 	
-	for (size_t i = 0; i < dict->capacity; i++) {
-		pdict_entry_t *current = dict->buckets[i];
-		while (current != NULL) {
-			plist_add_str(new_list, current->key);
-			if (pvars_errno != SUCCESS) {
-				pvars_errno = FAILURE_PDICT_GET_KEYS_PLIST_ADD_STR_FAILED; // Intentional double handling of pvars_errno.
-				plist_destroy(new_list);
-				return NULL;
-			}
-			
-			current = current->next;
+	pdict_iter_t iter;
+	const char *key;
+
+	pdict_iter_init(&iter, dict);
+
+	while (pdict_iter_next(&iter, &key, NULL)) {
+		plist_add_str(new_list, key);
+		if (pvars_errno != SUCCESS) {
+			pvars_errno = FAILURE_PDICT_GET_KEYS_PLIST_ADD_STR_FAILED; // Intentional double handling of pvars_errno.
+			plist_destroy(new_list);
+			return NULL;
 		}
 	}
 
@@ -461,17 +1727,17 @@ plist_t *pdict_get_values(const pdict_t *dict)
 		return NULL;
 	}
 	
-	for (size_t i = 0; i < dict->capacity; i++) {
-		pdict_entry_t *current = dict->buckets[i];
-		while (current != NULL) {
-			plist_add_pvar(new_list, &(current->value));
-			if (pvars_errno != SUCCESS) {
-				pvars_errno = FAILURE_PDICT_GET_VALUES_PLIST_ADD_PVAR_FAILED;
-				plist_destroy(new_list);
-				return NULL;
-			}
-			
-			current = current->next;
+	pdict_iter_t iter;
+	pvar_t *value;
+
+	pdict_iter_init(&iter, dict);
+
+	while (pdict_iter_next(&iter, NULL, &value)) {
+		plist_add_pvar(new_list, value);
+		if (pvars_errno != SUCCESS) {
+			pvars_errno = FAILURE_PDICT_GET_VALUES_PLIST_ADD_PVAR_FAILED;
+			plist_destroy(new_list);
+			return NULL;
 		}
 	}
 
@@ -499,30 +1765,81 @@ void pdict_remove(pdict_t *dict, const char *key)
 		return;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	
-	pdict_entry_t *current = dict->buckets[bucket_index];
-	pdict_entry_t *previous = NULL;
-	
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			if (previous == NULL) {
-				dict->buckets[bucket_index] = current->next;
-			} else {
-				previous->next = current->next;
-			}
-			pvar_destroy_internal(&(current->value));
-			free(current->key);
-			free(current);
-			
-			dict->count--;
-			return;
+	if (!pdict_unshare(dict)) {
+		return;
+	}
+
+	pvar_t removed;
+
+	if (!pdict_extract(dict, key, &removed)) {
+		pvars_errno = FAILURE_PDICT_REMOVE_KEY_NOT_FOUND;
+		return;
+	}
+
+	pvar_destroy_in(dict->allocator, &removed);
+}
+
+/**
+ * @brief Removes an entry from a pdict_t variable and hands its value to
+ * the caller
+ *
+ * Strings, lists and dicts are moved, not copied. The caller owns
+ * *out_value and releases it with pvar_destroy(). A string popped from a
+ * dict with its own allocator or arena is copied to the heap first; lists
+ * and dicts keep their allocator.
+ *
+ * @param The address of a dict.
+ * @param Char key
+ * @param Receives the removed value
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pdict_pop(pdict_t *dict, const char *key, pvar_t *out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_POP_NULL_INPUT_DICT;
+		return false;
+	}
+	if (key == NULL) {
+		pvars_errno = FAILURE_PDICT_POP_NULL_INPUT_KEY;
+		return false;
+	}
+	if (out_value == NULL) {
+		pvars_errno = FAILURE_PDICT_POP_NULL_INPUT_OUT_VALUE;
+		return false;
+	}
+
+	if (!pdict_unshare(dict)) {
+		return false;
+	}
+
+	char *heap_string = NULL;
+	const pvar_t *current = pdict_find_value(dict, key);
+
+	/* The caller gets a plain heap string in data.s. Copied before the entry is removed, so a failure leaves the dict intact */
+	if (current != NULL && current->type == PVAR_TYPE_STRING) {
+		heap_string = pvar_str_to_heap(current);
+		if (heap_string == NULL) {
+			pvars_errno = FAILURE_PDICT_POP_STRDUP_FAILED;
+			return false;
 		}
-		previous = current;
-		current = current->next;
 	}
 
-	pvars_errno = FAILURE_PDICT_REMOVE_KEY_NOT_FOUND;
+	if (!pdict_extract(dict, key, out_value)) {
+		pvars_errno = FAILURE_PDICT_POP_KEY_NOT_FOUND;
+		return false;
+	}
+
+	if (heap_string != NULL) {
+		pvar_destroy_in(dict->allocator, out_value);
+		out_value->type = PVAR_TYPE_STRING;
+		out_value->str_tag = PVAR_STR_PLAIN;
+		out_value->data.s = heap_string;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
 }
 
  
@@ -550,583 +1867,819 @@ void pdict_add_str(pdict_t *dict, const char *key, const char *value)
 		pvars_errno = FAILURE_PDICT_ADD_STR_NULL_INPUT_VALUE;
 		return;
 	}
-
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
-
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			pvars_errno = FAILURE_PDICT_ADD_STR_KEY_EXISTS;
-			return;
-		}
-		current = current->next;
+
+	pdict_key_t lookup;
+	pdict_key_init(&lookup, dict, key);
+
+	pvar_t *current = pdict_lookup(dict, &lookup);
+
+	if (current != NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_STR_KEY_EXISTS;
+		return;
+	}
+
+	pvar_t new_value;
+	if (!pvar_set_str_in(dict->allocator, &new_value, value)) {
+		pvars_errno = FAILURE_PDICT_ADD_STR_VALUE_STRDUP_FAILED;
+		return;
+	}
+
+	if (!pdict_insert(dict, &lookup, &new_value, FAILURE_PDICT_ADD_STR_ENTRY_MALLOC_FAILED, FAILURE_PDICT_ADD_STR_KEY_STRDUP_FAILED)) {
+		pvar_destroy_in(dict->allocator, &new_value);
+		return;
+	}
+	
+	pvars_errno = SUCCESS;
+}
+
+
+/**
+ * @brief Adds len bytes, which may contain NULs, to a pdict_t variable as a
+ * string
+ *
+ * @param The address of a dict.
+ * @param Char key
+ * @param The bytes to add to the dict
+ * @param Number of bytes
+ * @return void
+ */
+void pdict_add_strn(pdict_t *dict, const char *key, const char *value, size_t len)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_STRN_NULL_INPUT_DICT;
+		return;
+	}
+	if (key == NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_STRN_NULL_INPUT_KEY;
+		return;
+	}
+	if (value == NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_STRN_NULL_INPUT_VALUE;
+		return;
+	}
+
+	pdict_key_t lookup;
+	pdict_key_init(&lookup, dict, key);
+
+	pvar_t *current = pdict_lookup(dict, &lookup);
+
+	if (current != NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_STRN_KEY_EXISTS;
+		return;
+	}
+
+	pvar_t new_value;
+	if (!pvar_set_strn_in(dict->allocator, &new_value, value, len)) {
+		pvars_errno = FAILURE_PDICT_ADD_STRN_VALUE_STRDUP_FAILED;
+		return;
+	}
+
+	if (!pdict_insert(dict, &lookup, &new_value, FAILURE_PDICT_ADD_STRN_ENTRY_MALLOC_FAILED, FAILURE_PDICT_ADD_STRN_KEY_STRDUP_FAILED)) {
+		pvar_destroy_in(dict->allocator, &new_value);
+		return;
+	}
+	
+	pvars_errno = SUCCESS;
+}
+
+
+/**
+ * @brief Adds an int to a pdict_t variable
+ *
+ * @param The address of a dict.
+ * @param Char key
+ * @param The value to add to the dict
+ * @return void
+ */
+void pdict_add_int(pdict_t *dict, const char *key, int value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_INT_NULL_INPUT_DICT;
+		return;
+	}
+	if (key == NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_INT_NULL_INPUT_KEY;
+		return;
+	}
+
+	pdict_key_t lookup;
+	pdict_key_init(&lookup, dict, key);
+
+	pvar_t *current = pdict_lookup(dict, &lookup);
+
+	if (current != NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_INT_KEY_EXISTS;
+		return;
+	}
+
+	pvar_t new_value;
+	new_value.type = PVAR_TYPE_INT;
+	new_value.data.i = value;
+
+	if (!pdict_insert(dict, &lookup, &new_value, FAILURE_PDICT_ADD_INT_ENTRY_MALLOC_FAILED, FAILURE_PDICT_ADD_INT_KEY_STRDUP_FAILED)) {
+		return;
+	}
+	
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Adds a double to a pdict_t variable
+ *
+ * @param The address of a dict.
+ * @param Char key
+ * @param The value to add to the dict
+ * @return void
+ */
+void pdict_add_double(pdict_t *dict, const char *key, double value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_DOUBLE_NULL_INPUT_DICT;
+		return;
+	}
+	if (key == NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_DOUBLE_NULL_INPUT_KEY;
+		return;
+	}
+
+	pdict_key_t lookup;
+	pdict_key_init(&lookup, dict, key);
+
+	pvar_t *current = pdict_lookup(dict, &lookup);
+
+	if (current != NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_DOUBLE_KEY_EXISTS;
+		return;
+	}
+
+	pvar_t new_value;
+	new_value.type = PVAR_TYPE_DOUBLE;
+	new_value.data.d = value;
+
+	if (!pdict_insert(dict, &lookup, &new_value, FAILURE_PDICT_ADD_DOUBLE_ENTRY_MALLOC_FAILED, FAILURE_PDICT_ADD_DOUBLE_KEY_STRDUP_FAILED)) {
+		return;
+	}
+	
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Adds a long to a pdict_t variable
+ *
+ * @param The address of a dict.
+ * @param Char key
+ * @param The value to add to the dict
+ * @return void
+ */
+void pdict_add_long(pdict_t *dict, const char *key, long value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_LONG_NULL_INPUT_DICT;
+		return;
+	}
+	if (key == NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_LONG_NULL_INPUT_KEY;
+		return;
+	}
+
+	pdict_key_t lookup;
+	pdict_key_init(&lookup, dict, key);
+
+	pvar_t *current = pdict_lookup(dict, &lookup);
+
+	if (current != NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_LONG_KEY_EXISTS;
+		return;
+	}
+
+	pvar_t new_value;
+	new_value.type = PVAR_TYPE_LONG;
+	new_value.data.l = value;
+
+	if (!pdict_insert(dict, &lookup, &new_value, FAILURE_PDICT_ADD_LONG_ENTRY_MALLOC_FAILED, FAILURE_PDICT_ADD_LONG_KEY_STRDUP_FAILED)) {
+		return;
+	}
+	
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Adds a float to a pdict_t variable
+ *
+ * @param The address of a dict.
+ * @param Char key
+ * @param The value to add to the dict
+ * @return void
+ */
+void pdict_add_float(pdict_t *dict, const char *key, float value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_FLOAT_NULL_INPUT_DICT;
+		return;
+	}
+	if (key == NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_FLOAT_NULL_INPUT_KEY;
+		return;
 	}
 
+	pdict_key_t lookup;
+	pdict_key_init(&lookup, dict, key);
 
+	pvar_t *current = pdict_lookup(dict, &lookup);
 
-	pdict_entry_t *new_entry = calloc(1, sizeof(pdict_entry_t));
-	if (new_entry == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_STR_ENTRY_MALLOC_FAILED;
+	if (current != NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_FLOAT_KEY_EXISTS;
 		return;
 	}
 
-	new_entry->key = strdup(key);
-	if (new_entry->key == NULL) {
-		free(new_entry);
-		pvars_errno = FAILURE_PDICT_ADD_STR_KEY_STRDUP_FAILED;
-		return;
-	}
+	pvar_t new_value;
+	new_value.type = PVAR_TYPE_FLOAT;
+	new_value.data.f = value;
 
-	char *new_string = strdup(value);
-	if (new_string == NULL) {
-		free(new_entry->key);
-		free(new_entry);
-		pvars_errno = FAILURE_PDICT_ADD_STR_VALUE_STRDUP_FAILED;
+	if (!pdict_insert(dict, &lookup, &new_value, FAILURE_PDICT_ADD_FLOAT_ENTRY_MALLOC_FAILED, FAILURE_PDICT_ADD_FLOAT_KEY_STRDUP_FAILED)) {
 		return;
 	}
-
-	new_entry->value.type = PVAR_TYPE_STRING;
-	new_entry->value.data.s = new_string;
-
-	new_entry->next = dict->buckets[bucket_index];
-	dict->buckets[bucket_index] = new_entry;
-
-	dict->count++;
 	
 	pvars_errno = SUCCESS;
 }
 
-
 /**
- * @brief Adds an int to a pdict_t variable
+ * @brief Adds a list to a pdict_t variable
  *
  * @param The address of a dict.
  * @param Char key
  * @param The value to add to the dict
  * @return void
  */
-void pdict_add_int(pdict_t *dict, const char *key, int value)
+void pdict_add_list(pdict_t *dict, const char *key, const plist_t *value)
 {
 	pvars_errno = PERRNO_CLEAR;
 
 	if (dict == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_INT_NULL_INPUT_DICT;
+		pvars_errno = FAILURE_PDICT_ADD_LIST_NULL_INPUT_DICT;
 		return;
 	}
 	if (key == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_INT_NULL_INPUT_KEY;
+		pvars_errno = FAILURE_PDICT_ADD_LIST_NULL_INPUT_KEY;
+		return;
+	}
+	if (value == NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_LIST_NULL_INPUT_VALUE;
 		return;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
+	pdict_key_t lookup;
+	pdict_key_init(&lookup, dict, key);
 
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			pvars_errno = FAILURE_PDICT_ADD_INT_KEY_EXISTS;
-			return;
-		}
-		current = current->next;
-	}
+	pvar_t *current = pdict_lookup(dict, &lookup);
 
-	pdict_entry_t *new_entry = calloc(1, sizeof(pdict_entry_t));
-	if (new_entry == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_INT_ENTRY_MALLOC_FAILED;
+	if (current != NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_LIST_KEY_EXISTS;
 		return;
 	}
 
-	new_entry->key = strdup(key);
-	if (new_entry->key == NULL) {
-		free(new_entry);
-		pvars_errno = FAILURE_PDICT_ADD_INT_KEY_STRDUP_FAILED;
+	plist_t *new_list = plist_copy_in(dict->allocator, value);
+	if (new_list == NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_LIST_VALUE_PLIST_COPY_FAILED;
 		return;
 	}
 
-	new_entry->value.type = PVAR_TYPE_INT;
-	new_entry->value.data.i = value;
+	pvar_t new_value;
+	new_value.type = PVAR_TYPE_LIST;
+	new_value.data.ls = new_list;
 
-	new_entry->next = dict->buckets[bucket_index];
-	dict->buckets[bucket_index] = new_entry;
-
-	dict->count++;
+	if (!pdict_insert(dict, &lookup, &new_value, FAILURE_PDICT_ADD_LIST_ENTRY_MALLOC_FAILED, FAILURE_PDICT_ADD_LIST_KEY_STRDUP_FAILED)) {
+		pvar_destroy_in(dict->allocator, &new_value);
+		return;
+	}
 	
 	pvars_errno = SUCCESS;
 }
 
 /**
- * @brief Adds a double to a pdict_t variable
+ * @brief Adds a dict to a pdict_t variable
  *
  * @param The address of a dict.
  * @param Char key
  * @param The value to add to the dict
  * @return void
  */
-void pdict_add_double(pdict_t *dict, const char *key, double value)
+void pdict_add_dict(pdict_t *dict, const char *key, const pdict_t *value)
 {
 	pvars_errno = PERRNO_CLEAR;
 
 	if (dict == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_DOUBLE_NULL_INPUT_DICT;
+		pvars_errno = FAILURE_PDICT_ADD_DICT_NULL_INPUT_DICT;
 		return;
 	}
 	if (key == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_DOUBLE_NULL_INPUT_KEY;
+		pvars_errno = FAILURE_PDICT_ADD_DICT_NULL_INPUT_KEY;
+		return;
+	}
+	if (value == NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_DICT_NULL_INPUT_VALUE;
 		return;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
+	pdict_key_t lookup;
+	pdict_key_init(&lookup, dict, key);
 
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			pvars_errno = FAILURE_PDICT_ADD_DOUBLE_KEY_EXISTS;
-			return;
-		}
-		current = current->next;
-	}
+	pvar_t *current = pdict_lookup(dict, &lookup);
 
-	pdict_entry_t *new_entry = calloc(1, sizeof(pdict_entry_t));
-	if (new_entry == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_DOUBLE_ENTRY_MALLOC_FAILED;
+	if (current != NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_DICT_KEY_EXISTS;
 		return;
 	}
 
-	new_entry->key = strdup(key);
-	if (new_entry->key == NULL) {
-		free(new_entry);
-		pvars_errno = FAILURE_PDICT_ADD_DOUBLE_KEY_STRDUP_FAILED;
+	pdict_t *new_dict = pdict_copy_in(dict->allocator, value);
+	if (new_dict == NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_DICT_VALUE_PDICT_COPY_FAILED;
 		return;
 	}
 
-	new_entry->value.type = PVAR_TYPE_DOUBLE;
-	new_entry->value.data.d = value;
+	pvar_t new_value;
+	new_value.type = PVAR_TYPE_DICT;
+	new_value.data.dt = new_dict;
 
-	new_entry->next = dict->buckets[bucket_index];
-	dict->buckets[bucket_index] = new_entry;
-
-	dict->count++;
+	if (!pdict_insert(dict, &lookup, &new_value, FAILURE_PDICT_ADD_DICT_ENTRY_MALLOC_FAILED, FAILURE_PDICT_ADD_DICT_KEY_STRDUP_FAILED)) {
+		pvar_destroy_in(dict->allocator, &new_value);
+		return;
+	}
 	
 	pvars_errno = SUCCESS;
 }
 
 /**
- * @brief Adds a long to a pdict_t variable
+ * @brief Adds a list to a pdict_t variable, taking ownership of it instead
+ * of copying
+ *
+ * On success the dict owns value and frees it when the entry is removed or
+ * the dict is destroyed; the caller must not use or free it afterwards. On
+ * failure ownership stays with the caller.
  *
  * @param The address of a dict.
  * @param Char key
- * @param The value to add to the dict
+ * @param The value to move into the dict
  * @return void
  */
-void pdict_add_long(pdict_t *dict, const char *key, long value)
+void pdict_add_list_take(pdict_t *dict, const char *key, plist_t *value)
 {
 	pvars_errno = PERRNO_CLEAR;
 
 	if (dict == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_LONG_NULL_INPUT_DICT;
+		pvars_errno = FAILURE_PDICT_ADD_LIST_TAKE_NULL_INPUT_DICT;
 		return;
 	}
 	if (key == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_LONG_NULL_INPUT_KEY;
+		pvars_errno = FAILURE_PDICT_ADD_LIST_TAKE_NULL_INPUT_KEY;
 		return;
 	}
-
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
-
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			pvars_errno = FAILURE_PDICT_ADD_LONG_KEY_EXISTS;
-			return;
-		}
-		current = current->next;
+	if (value == NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_LIST_TAKE_NULL_INPUT_VALUE;
+		return;
 	}
-
-	pdict_entry_t *new_entry = calloc(1, sizeof(pdict_entry_t));
-	if (new_entry == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_LONG_ENTRY_MALLOC_FAILED;
+	if (value->allocator != dict->allocator) {
+		pvars_errno = FAILURE_PDICT_ADD_LIST_TAKE_ALLOCATOR_MISMATCH;
 		return;
 	}
 
-	new_entry->key = strdup(key);
-	if (new_entry->key == NULL) {
-		free(new_entry);
-		pvars_errno = FAILURE_PDICT_ADD_LONG_KEY_STRDUP_FAILED;
+	pdict_key_t lookup;
+	pdict_key_init(&lookup, dict, key);
+
+	if (pdict_lookup(dict, &lookup) != NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_LIST_TAKE_KEY_EXISTS;
 		return;
 	}
 
-	new_entry->value.type = PVAR_TYPE_LONG;
-	new_entry->value.data.l = value;
-
-	new_entry->next = dict->buckets[bucket_index];
-	dict->buckets[bucket_index] = new_entry;
+	pvar_t new_value;
+	new_value.type = PVAR_TYPE_LIST;
+	new_value.data.ls = value;
 
-	dict->count++;
+	if (!pdict_insert(dict, &lookup, &new_value, FAILURE_PDICT_ADD_LIST_TAKE_ENTRY_MALLOC_FAILED, FAILURE_PDICT_ADD_LIST_TAKE_KEY_STRDUP_FAILED)) {
+		return;
+	}
 	
 	pvars_errno = SUCCESS;
 }
 
 /**
- * @brief Adds a float to a pdict_t variable
+ * @brief Adds a dict to a pdict_t variable, taking ownership of it instead
+ * of copying
+ *
+ * On success the dict owns value and frees it when the entry is removed or
+ * the dict is destroyed; the caller must not use or free it afterwards. On
+ * failure ownership stays with the caller.
  *
  * @param The address of a dict.
  * @param Char key
- * @param The value to add to the dict
+ * @param The value to move into the dict
  * @return void
  */
-void pdict_add_float(pdict_t *dict, const char *key, float value)
+void pdict_add_dict_take(pdict_t *dict, const char *key, pdict_t *value)
 {
 	pvars_errno = PERRNO_CLEAR;
 
 	if (dict == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_FLOAT_NULL_INPUT_DICT;
+		pvars_errno = FAILURE_PDICT_ADD_DICT_TAKE_NULL_INPUT_DICT;
 		return;
 	}
 	if (key == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_FLOAT_NULL_INPUT_KEY;
+		pvars_errno = FAILURE_PDICT_ADD_DICT_TAKE_NULL_INPUT_KEY;
 		return;
 	}
-
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
-
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			pvars_errno = FAILURE_PDICT_ADD_FLOAT_KEY_EXISTS;
-			return;
-		}
-		current = current->next;
+	if (value == NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_DICT_TAKE_NULL_INPUT_VALUE;
+		return;
 	}
-
-	pdict_entry_t *new_entry = calloc(1, sizeof(pdict_entry_t));
-	if (new_entry == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_FLOAT_ENTRY_MALLOC_FAILED;
+	if (value->allocator != dict->allocator) {
+		pvars_errno = FAILURE_PDICT_ADD_DICT_TAKE_ALLOCATOR_MISMATCH;
 		return;
 	}
-
-	new_entry->key = strdup(key);
-	if (new_entry->key == NULL) {
-		free(new_entry);
-		pvars_errno = FAILURE_PDICT_ADD_FLOAT_KEY_STRDUP_FAILED;
+	if (value == dict) {
+		pvars_errno = FAILURE_PDICT_ADD_DICT_TAKE_SELF_INSERT;
 		return;
 	}
 
-	new_entry->value.type = PVAR_TYPE_FLOAT;
-	new_entry->value.data.f = value;
+	pdict_key_t lookup;
+	pdict_key_init(&lookup, dict, key);
 
-	new_entry->next = dict->buckets[bucket_index];
-	dict->buckets[bucket_index] = new_entry;
+	if (pdict_lookup(dict, &lookup) != NULL) {
+		pvars_errno = FAILURE_PDICT_ADD_DICT_TAKE_KEY_EXISTS;
+		return;
+	}
 
-	dict->count++;
+	pvar_t new_value;
+	new_value.type = PVAR_TYPE_DICT;
+	new_value.data.dt = value;
+
+	if (!pdict_insert(dict, &lookup, &new_value, FAILURE_PDICT_ADD_DICT_TAKE_ENTRY_MALLOC_FAILED, FAILURE_PDICT_ADD_DICT_TAKE_KEY_STRDUP_FAILED)) {
+		return;
+	}
 	
 	pvars_errno = SUCCESS;
-    
-	// G. (Future) Check Load Factor and Resize
-	// You would place your load factor check and resize function call here.
 }
 
 /**
- * @brief Adds a list to a pdict_t variable
+ * @brief Retrieves a string from a pdict_t variable
  *
  * @param The address of a dict.
  * @param Char key
- * @param The value to add to the dict
- * @return void
+ * @param The value to store the retrieved value
+ * @return bool
  */
-void pdict_add_list(pdict_t *dict, const char *key, const plist_t *value)
+bool pdict_get_str(const pdict_t *dict, const char *key, char **out_value)
 {
 	pvars_errno = PERRNO_CLEAR;
 
 	if (dict == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_LIST_NULL_INPUT_DICT;
-		return;
+		pvars_errno = FAILURE_PDICT_GET_STR_NULL_INPUT_DICT;
+		*out_value = NULL;
+		return false;
 	}
 	if (key == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_LIST_NULL_INPUT_KEY;
-		return;
+		pvars_errno = FAILURE_PDICT_GET_STR_NULL_INPUT_KEY;
+		*out_value = NULL;
+		return false;
 	}
-	if (value == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_LIST_NULL_INPUT_VALUE;
-		return;
+	if (out_value == NULL) {
+		pvars_errno = FAILURE_PDICT_GET_STR_NULL_INPUT_OUT_VALUE;
+		return false;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
+	pvar_t *current = pdict_find_value(dict, key);
 
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			pvars_errno = FAILURE_PDICT_ADD_LIST_KEY_EXISTS;
-			return;
+	if (current != NULL) {
+		if (current->type != PVAR_TYPE_STRING) {
+			pvars_errno = FAILURE_PDICT_GET_STR_WRONG_TYPE;
+			*out_value = NULL;
+			return false;
 		}
-		current = current->next;
+
+		*out_value = strdup(pvar_str(current));
+		if (*out_value == NULL) {
+			pvars_errno = FAILURE_PDICT_GET_STR_STRDUP_FAILED;
+			return false;
+		}
+		
+		pvars_errno = SUCCESS;
+		return true;
 	}
 
+	pvars_errno = FAILURE_PDICT_GET_STR_KEY_NOT_FOUND;
+	*out_value = NULL;
+	return false;
+}
 
+/**
+ * @brief Borrows a string from a pdict_t variable without copying it
+ *
+ * The returned pointer refers to the dict's own storage. It stays valid
+ * until the entry is modified or removed, or the dict is emptied or
+ * destroyed, and must not be freed by the caller. A string shorter than
+ * PVAR_INLINE_STR_SIZE lives inside the entry, so adding to a
+ * PDICT_BACKEND_FLAT dict, which may move its entries, invalidates the
+ * pointer as well.
+ *
+ * @param The address of a dict.
+ * @param Char key
+ * @param The value to store the borrowed pointer
+ * @return bool
+ */
+bool pdict_borrow_str(const pdict_t *dict, const char *key, const char **out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
 
-	pdict_entry_t *new_entry = calloc(1, sizeof(pdict_entry_t));
-	if (new_entry == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_LIST_ENTRY_MALLOC_FAILED;
-		return;
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_BORROW_STR_NULL_INPUT_DICT;
+		return false;
 	}
-
-	new_entry->key = strdup(key);
-	if (new_entry->key == NULL) {
-		free(new_entry);
-		pvars_errno = FAILURE_PDICT_ADD_LIST_KEY_STRDUP_FAILED;
-		return;
+	if (key == NULL) {
+		pvars_errno = FAILURE_PDICT_BORROW_STR_NULL_INPUT_KEY;
+		return false;
+	}
+	if (out_value == NULL) {
+		pvars_errno = FAILURE_PDICT_BORROW_STR_NULL_INPUT_OUT_VALUE;
+		return false;
 	}
 
-	plist_t *new_list = plist_copy(value);
-	if (new_list == NULL) {
-		free(new_entry->key);
-		free(new_entry);
-		pvars_errno = FAILURE_PDICT_ADD_LIST_VALUE_PLIST_COPY_FAILED;
-		return;
+	const pvar_t *current = pdict_find_value(dict, key);
+
+	if (current == NULL) {
+		pvars_errno = FAILURE_PDICT_BORROW_STR_KEY_NOT_FOUND;
+		*out_value = NULL;
+		return false;
 	}
 
-	new_entry->value.type = PVAR_TYPE_LIST;
-	new_entry->value.data.ls = new_list;
+	if (current->type != PVAR_TYPE_STRING) {
+		pvars_errno = FAILURE_PDICT_BORROW_STR_WRONG_TYPE;
+		*out_value = NULL;
+		return false;
+	}
 
-	new_entry->next = dict->buckets[bucket_index];
-	dict->buckets[bucket_index] = new_entry;
+	*out_value = pvar_str(current);
 
-	dict->count++;
-	
 	pvars_errno = SUCCESS;
+	return true;
 }
 
 /**
- * @brief Adds a dict to a pdict_t variable
+ * @brief Borrows a string from a pdict_t variable together with its length
+ *
+ * The length counts every byte, including embedded NULs. The pointer follows
+ * the same rules as pdict_borrow_str().
  *
  * @param The address of a dict.
  * @param Char key
- * @param The value to add to the dict
- * @return void
+ * @param The value to store the borrowed pointer
+ * @param The value to store the length
+ * @return bool
  */
-void pdict_add_dict(pdict_t *dict, const char *key, const pdict_t *value)
+bool pdict_borrow_strn(const pdict_t *dict, const char *key, const char **out_value, size_t *out_len)
 {
 	pvars_errno = PERRNO_CLEAR;
 
 	if (dict == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_DICT_NULL_INPUT_DICT;
-		return;
+		pvars_errno = FAILURE_PDICT_BORROW_STRN_NULL_INPUT_DICT;
+		return false;
 	}
 	if (key == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_DICT_NULL_INPUT_KEY;
-		return;
+		pvars_errno = FAILURE_PDICT_BORROW_STRN_NULL_INPUT_KEY;
+		return false;
 	}
-	if (value == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_DICT_NULL_INPUT_VALUE;
-		return;
+	if (out_value == NULL || out_len == NULL) {
+		pvars_errno = FAILURE_PDICT_BORROW_STRN_NULL_INPUT_OUT_VALUE;
+		return false;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
+	const pvar_t *current = pdict_find_value(dict, key);
 
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			pvars_errno = FAILURE_PDICT_ADD_DICT_KEY_EXISTS;
-			return;
-		}
-		current = current->next;
+	if (current == NULL) {
+		pvars_errno = FAILURE_PDICT_BORROW_STRN_KEY_NOT_FOUND;
+		*out_value = NULL;
+		return false;
 	}
 
+	if (current->type != PVAR_TYPE_STRING) {
+		pvars_errno = FAILURE_PDICT_BORROW_STRN_WRONG_TYPE;
+		*out_value = NULL;
+		return false;
+	}
 
+	*out_value = pvar_str(current);
+	*out_len = pvar_str_len(current);
 
-	pdict_entry_t *new_entry = calloc(1, sizeof(pdict_entry_t));
-	if (new_entry == NULL) {
-		pvars_errno = FAILURE_PDICT_ADD_DICT_ENTRY_MALLOC_FAILED;
-		return;
-	}
+	pvars_errno = SUCCESS;
+	return true;
+}
 
-	new_entry->key = strdup(key);
-	if (new_entry->key == NULL) {
-		free(new_entry);
-		pvars_errno = FAILURE_PDICT_ADD_DICT_KEY_STRDUP_FAILED;
-		return;
-	}
+/**
+ * @brief Retrieves a list from a pdict_t variable
+ *
+ * @param The address of a dict.
+ * @param Char key
+ * @param The value to store the retrieved value
+ * @return bool
+ */
+bool pdict_get_list(const pdict_t *dict, const char *key, plist_t **out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
 
-	pdict_t *new_dict = pdict_copy(value);
-	if (new_dict == NULL) {
-		free(new_entry->key);
-		free(new_entry);
-		pvars_errno = FAILURE_PDICT_ADD_DICT_VALUE_PDICT_COPY_FAILED;
-		return;
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_GET_LIST_NULL_INPUT_DICT;
+		*out_value = NULL;
+		return false;
+	}
+	if (key == NULL) {
+		pvars_errno = FAILURE_PDICT_GET_LIST_NULL_INPUT_KEY;
+		*out_value = NULL;
+		return false;
+	}
+	if (out_value == NULL) {
+		pvars_errno = FAILURE_PDICT_GET_LIST_NULL_INPUT_OUT_VALUE;
+		return false;
 	}
 
-	new_entry->value.type = PVAR_TYPE_DICT;
-	new_entry->value.data.dt = new_dict;
+	pvar_t *current = pdict_find_value(dict, key);
 
-	new_entry->next = dict->buckets[bucket_index];
-	dict->buckets[bucket_index] = new_entry;
+	if (current != NULL) {
+		if (current->type != PVAR_TYPE_LIST) {
+			pvars_errno = FAILURE_PDICT_GET_LIST_WRONG_TYPE;
+			*out_value = NULL;
+			return false;
+		}
 
-	dict->count++;
-	
-	pvars_errno = SUCCESS;
+		*out_value = plist_copy(current->data.ls);
+		if (*out_value == NULL) {
+			pvars_errno = FAILURE_PDICT_GET_LIST_PLIST_COPY_FAILED;
+			return false;
+		}
+		
+		pvars_errno = SUCCESS;
+		return true;
+	}
+
+	pvars_errno = FAILURE_PDICT_GET_LIST_KEY_NOT_FOUND;
+	*out_value = NULL;
+	return false;
 }
 
 /**
- * @brief Retrieves a string from a pdict_t variable
+ * @brief Borrows a list from a pdict_t variable without copying it
+ *
+ * The returned pointer refers to the dict's own storage. It stays valid
+ * until the entry is modified or removed, or the dict is emptied or
+ * destroyed, and must not be freed by the caller.
  *
  * @param The address of a dict.
  * @param Char key
- * @param The value to store the retrieved value
+ * @param The value to store the borrowed pointer
  * @return bool
  */
-bool pdict_get_str(pdict_t *dict, const char *key, char **out_value)
+bool pdict_borrow_list(const pdict_t *dict, const char *key, const plist_t **out_value)
 {
 	pvars_errno = PERRNO_CLEAR;
 
 	if (dict == NULL) {
-		pvars_errno = FAILURE_PDICT_GET_STR_NULL_INPUT_DICT;
-		*out_value = NULL;
+		pvars_errno = FAILURE_PDICT_BORROW_LIST_NULL_INPUT_DICT;
 		return false;
 	}
 	if (key == NULL) {
-		pvars_errno = FAILURE_PDICT_GET_STR_NULL_INPUT_KEY;
-		*out_value = NULL;
+		pvars_errno = FAILURE_PDICT_BORROW_LIST_NULL_INPUT_KEY;
 		return false;
 	}
 	if (out_value == NULL) {
-		pvars_errno = FAILURE_PDICT_GET_STR_NULL_INPUT_OUT_VALUE;
+		pvars_errno = FAILURE_PDICT_BORROW_LIST_NULL_INPUT_OUT_VALUE;
+		return false;
+	}
+
+	const pvar_t *current = pdict_find_value(dict, key);
+
+	if (current == NULL) {
+		pvars_errno = FAILURE_PDICT_BORROW_LIST_KEY_NOT_FOUND;
+		*out_value = NULL;
 		return false;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
-
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			if (current->value.type != PVAR_TYPE_STRING) {
-				pvars_errno = FAILURE_PDICT_GET_STR_WRONG_TYPE;
-				*out_value = NULL;
-				return false;
-			}
-
-			*out_value = strdup(current->value.data.s);
-			if (*out_value == NULL) {
-				pvars_errno = FAILURE_PDICT_GET_STR_STRDUP_FAILED;
-				return false;
-			}
-			
-			pvars_errno = SUCCESS;
-			return true;
-		}
-		current = current->next;
+	if (current->type != PVAR_TYPE_LIST) {
+		pvars_errno = FAILURE_PDICT_BORROW_LIST_WRONG_TYPE;
+		*out_value = NULL;
+		return false;
 	}
 
-	pvars_errno = FAILURE_PDICT_GET_STR_KEY_NOT_FOUND;
-	*out_value = NULL;
-	return false;
+	*out_value = current->data.ls;
+
+	pvars_errno = SUCCESS;
+	return true;
 }
 
 /**
- * @brief Retrieves a list from a pdict_t variable
+ * @brief Retrieves a dict from a pdict_t variable
  *
  * @param The address of a dict.
  * @param Char key
  * @param The value to store the retrieved value
  * @return bool
  */
-bool pdict_get_list(pdict_t *dict, const char *key, plist_t **out_value)
+bool pdict_get_dict(const pdict_t *dict, const char *key, pdict_t **out_value)
 {
 	pvars_errno = PERRNO_CLEAR;
 
 	if (dict == NULL) {
-		pvars_errno = FAILURE_PDICT_GET_LIST_NULL_INPUT_DICT;
+		pvars_errno = FAILURE_PDICT_GET_DICT_NULL_INPUT_DICT;
 		*out_value = NULL;
 		return false;
 	}
 	if (key == NULL) {
-		pvars_errno = FAILURE_PDICT_GET_LIST_NULL_INPUT_KEY;
+		pvars_errno = FAILURE_PDICT_GET_DICT_NULL_INPUT_KEY;
 		*out_value = NULL;
 		return false;
 	}
 	if (out_value == NULL) {
-		pvars_errno = FAILURE_PDICT_GET_LIST_NULL_INPUT_OUT_VALUE;
+		pvars_errno = FAILURE_PDICT_GET_DICT_NULL_INPUT_OUT_VALUE;
 		return false;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
+	pvar_t *current = pdict_find_value(dict, key);
 
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			if (current->value.type != PVAR_TYPE_LIST) {
-				pvars_errno = FAILURE_PDICT_GET_LIST_WRONG_TYPE;
-				*out_value = NULL;
-				return false;
-			}
+	if (current != NULL) {
+		if (current->type != PVAR_TYPE_DICT) {
+			pvars_errno = FAILURE_PDICT_GET_DICT_WRONG_TYPE;
+			*out_value = NULL;
+			return false;
+		}
 
-			*out_value = plist_copy(current->value.data.ls);
-			if (*out_value == NULL) {
-				pvars_errno = FAILURE_PDICT_GET_LIST_PLIST_COPY_FAILED;
-				return false;
-			}
-			
-			pvars_errno = SUCCESS;
-			return true;
+		*out_value = pdict_copy(current->data.dt);
+		if (*out_value == NULL) {
+			pvars_errno = FAILURE_PDICT_GET_DICT_PDICT_COPY_FAILED;
+			return false;
 		}
-		current = current->next;
+		
+		pvars_errno = SUCCESS;
+		return true;
 	}
 
-	pvars_errno = FAILURE_PDICT_GET_LIST_KEY_NOT_FOUND;
+	pvars_errno = FAILURE_PDICT_GET_DICT_KEY_NOT_FOUND;
 	*out_value = NULL;
 	return false;
 }
 
 /**
- * @brief Retrieves a dict from a pdict_t variable
+ * @brief Borrows a dict from a pdict_t variable without copying it
+ *
+ * The returned pointer refers to the dict's own storage. It stays valid
+ * until the entry is modified or removed, or the dict is emptied or
+ * destroyed, and must not be freed by the caller.
  *
  * @param The address of a dict.
  * @param Char key
- * @param The value to store the retrieved value
+ * @param The value to store the borrowed pointer
  * @return bool
  */
-bool pdict_get_dict(pdict_t *dict, const char *key, pdict_t **out_value)
+bool pdict_borrow_dict(const pdict_t *dict, const char *key, const pdict_t **out_value)
 {
 	pvars_errno = PERRNO_CLEAR;
 
 	if (dict == NULL) {
-		pvars_errno = FAILURE_PDICT_GET_DICT_NULL_INPUT_DICT;
-		*out_value = NULL;
+		pvars_errno = FAILURE_PDICT_BORROW_DICT_NULL_INPUT_DICT;
 		return false;
 	}
 	if (key == NULL) {
-		pvars_errno = FAILURE_PDICT_GET_DICT_NULL_INPUT_KEY;
-		*out_value = NULL;
+		pvars_errno = FAILURE_PDICT_BORROW_DICT_NULL_INPUT_KEY;
 		return false;
 	}
 	if (out_value == NULL) {
-		pvars_errno = FAILURE_PDICT_GET_DICT_NULL_INPUT_OUT_VALUE;
+		pvars_errno = FAILURE_PDICT_BORROW_DICT_NULL_INPUT_OUT_VALUE;
 		return false;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
+	const pvar_t *current = pdict_find_value(dict, key);
 
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			if (current->value.type != PVAR_TYPE_DICT) {
-				pvars_errno = FAILURE_PDICT_GET_DICT_WRONG_TYPE;
-				*out_value = NULL;
-				return false;
-			}
+	if (current == NULL) {
+		pvars_errno = FAILURE_PDICT_BORROW_DICT_KEY_NOT_FOUND;
+		*out_value = NULL;
+		return false;
+	}
 
-			*out_value = pdict_copy(current->value.data.dt);
-			if (*out_value == NULL) {
-				pvars_errno = FAILURE_PDICT_GET_DICT_PDICT_COPY_FAILED;
-				return false;
-			}
-			
-			pvars_errno = SUCCESS;
-			return true;
-		}
-		current = current->next;
+	if (current->type != PVAR_TYPE_DICT) {
+		pvars_errno = FAILURE_PDICT_BORROW_DICT_WRONG_TYPE;
+		*out_value = NULL;
+		return false;
 	}
 
-	pvars_errno = FAILURE_PDICT_GET_DICT_KEY_NOT_FOUND;
-	*out_value = NULL;
-	return false;
+	*out_value = current->data.dt;
+
+	pvars_errno = SUCCESS;
+	return true;
 }
 
 /**
@@ -1137,7 +2690,7 @@ bool pdict_get_dict(pdict_t *dict, const char *key, pdict_t **out_value)
  * @param The value to store the retrieved value
  * @return bool
  */
-bool pdict_get_int(pdict_t *dict, const char *key, int *out_value)
+bool pdict_get_int(const pdict_t *dict, const char *key, int *out_value)
 {
 	pvars_errno = PERRNO_CLEAR;
 
@@ -1154,22 +2707,18 @@ bool pdict_get_int(pdict_t *dict, const char *key, int *out_value)
 		return false;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
+	pvar_t *current = pdict_find_value(dict, key);
 
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			if (current->value.type != PVAR_TYPE_INT) {
-				pvars_errno = FAILURE_PDICT_GET_INT_WRONG_TYPE;
-				return false;
-			}
-
-			*out_value = current->value.data.i;
-			
-			pvars_errno = SUCCESS;
-			return true;
+	if (current != NULL) {
+		if (current->type != PVAR_TYPE_INT) {
+			pvars_errno = FAILURE_PDICT_GET_INT_WRONG_TYPE;
+			return false;
 		}
-		current = current->next;
+
+		*out_value = current->data.i;
+		
+		pvars_errno = SUCCESS;
+		return true;
 	}
 
 	pvars_errno = FAILURE_PDICT_GET_INT_KEY_NOT_FOUND;
@@ -1184,7 +2733,7 @@ bool pdict_get_int(pdict_t *dict, const char *key, int *out_value)
  * @param The value to store the retrieved value
  * @return bool
  */
-bool pdict_get_double(pdict_t *dict, const char *key, double *out_value)
+bool pdict_get_double(const pdict_t *dict, const char *key, double *out_value)
 {
 	pvars_errno = PERRNO_CLEAR;
 
@@ -1201,22 +2750,18 @@ bool pdict_get_double(pdict_t *dict, const char *key, double *out_value)
 		return false;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
-
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			if (current->value.type != PVAR_TYPE_DOUBLE) {
-				pvars_errno = FAILURE_PDICT_GET_DOUBLE_WRONG_TYPE;
-				return false;
-			}
+	pvar_t *current = pdict_find_value(dict, key);
 
-			*out_value = current->value.data.d;
-			
-			pvars_errno = SUCCESS;
-			return true;
+	if (current != NULL) {
+		if (current->type != PVAR_TYPE_DOUBLE) {
+			pvars_errno = FAILURE_PDICT_GET_DOUBLE_WRONG_TYPE;
+			return false;
 		}
-		current = current->next;
+
+		*out_value = current->data.d;
+		
+		pvars_errno = SUCCESS;
+		return true;
 	}
 
 	pvars_errno = FAILURE_PDICT_GET_DOUBLE_KEY_NOT_FOUND;
@@ -1231,7 +2776,7 @@ bool pdict_get_double(pdict_t *dict, const char *key, double *out_value)
  * @param The value to store the retrieved value
  * @return bool
  */
-bool pdict_get_long(pdict_t *dict, const char *key, long *out_value)
+bool pdict_get_long(const pdict_t *dict, const char *key, long *out_value)
 {
 	pvars_errno = PERRNO_CLEAR;
 
@@ -1248,22 +2793,18 @@ bool pdict_get_long(pdict_t *dict, const char *key, long *out_value)
 		return false;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
-
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			if (current->value.type != PVAR_TYPE_LONG) {
-				pvars_errno = FAILURE_PDICT_GET_LONG_WRONG_TYPE;
-				return false;
-			}
+	pvar_t *current = pdict_find_value(dict, key);
 
-			*out_value = current->value.data.l;
-			
-			pvars_errno = SUCCESS;
-			return true;
+	if (current != NULL) {
+		if (current->type != PVAR_TYPE_LONG) {
+			pvars_errno = FAILURE_PDICT_GET_LONG_WRONG_TYPE;
+			return false;
 		}
-		current = current->next;
+
+		*out_value = current->data.l;
+		
+		pvars_errno = SUCCESS;
+		return true;
 	}
 
 	pvars_errno = FAILURE_PDICT_GET_LONG_KEY_NOT_FOUND;
@@ -1278,7 +2819,7 @@ bool pdict_get_long(pdict_t *dict, const char *key, long *out_value)
  * @param The value to store the retrieved value
  * @return bool
  */
-bool pdict_get_float(pdict_t *dict, const char *key, float *out_value)
+bool pdict_get_float(const pdict_t *dict, const char *key, float *out_value)
 {
 	pvars_errno = PERRNO_CLEAR;
 
@@ -1295,22 +2836,18 @@ bool pdict_get_float(pdict_t *dict, const char *key, float *out_value)
 		return false;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
-
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			if (current->value.type != PVAR_TYPE_FLOAT) {
-				pvars_errno = FAILURE_PDICT_GET_FLOAT_WRONG_TYPE;
-				return false;
-			}
+	pvar_t *current = pdict_find_value(dict, key);
 
-			*out_value = current->value.data.f;
-			
-			pvars_errno = SUCCESS;
-			return true;
+	if (current != NULL) {
+		if (current->type != PVAR_TYPE_FLOAT) {
+			pvars_errno = FAILURE_PDICT_GET_FLOAT_WRONG_TYPE;
+			return false;
 		}
-		current = current->next;
+
+		*out_value = current->data.f;
+		
+		pvars_errno = SUCCESS;
+		return true;
 	}
 
 	pvars_errno = FAILURE_PDICT_GET_FLOAT_KEY_NOT_FOUND;
@@ -1342,32 +2879,81 @@ void pdict_set_str(pdict_t *dict, const char *key, const char *value)
 		return;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
+	pvar_t *current = pdict_find_value(dict, key);
 
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			pvar_destroy_internal(&(current->value));
-
-			char *new_string = strdup(value);
-			if (new_string == NULL) {
-				pvars_errno = FAILURE_PDICT_SET_STR_VALUE_STRDUP_FAILED;
-				return;
-			}
+	if (current != NULL) {
+		/* Copied before the old value is released: value may be borrowed from it */
+		pvar_t new_value;
+		if (!pvar_set_str_in(dict->allocator, &new_value, value)) {
+			pvars_errno = FAILURE_PDICT_SET_STR_VALUE_STRDUP_FAILED;
+			return;
+		}
 
-			current->value.type = PVAR_TYPE_STRING;
-			current->value.data.s = new_string;
-			
-			pvars_errno = SUCCESS;
+		if (!pdict_unshare_value(dict, key, &current)) {
+			pvar_destroy_in(dict->allocator, &new_value);
 			return;
 		}
-		current = current->next;
+
+		pvar_destroy_in(dict->allocator, current);
+		*current = new_value;
+		
+		pvars_errno = SUCCESS;
+		return;
 	}
 	
 	pvars_errno = FAILURE_PDICT_SET_STR_VALUE_NOT_FOUND;
-    
-	// (Future) Check Load Factor and Resize
-	// You would place your load factor check and resize function call here.
+}
+
+/**
+ * @brief Replaces an element with len bytes, which may contain NULs, in a
+ * pdict_t variable
+ *
+ * @param The address of a dict.
+ * @param Char key
+ * @param The bytes to store in the dict
+ * @param Number of bytes
+ * @return void
+ */
+void pdict_set_strn(pdict_t *dict, const char *key, const char *value, size_t len)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_SET_STRN_NULL_INPUT_DICT;
+		return;
+	}
+	if (key == NULL) {
+		pvars_errno = FAILURE_PDICT_SET_STRN_NULL_INPUT_KEY;
+		return;
+	}
+	if (value == NULL) {
+		pvars_errno = FAILURE_PDICT_SET_STRN_NULL_INPUT_VALUE;
+		return;
+	}
+
+	pvar_t *current = pdict_find_value(dict, key);
+
+	if (current != NULL) {
+		/* Copied before the old value is released: value may be borrowed from it */
+		pvar_t new_value;
+		if (!pvar_set_strn_in(dict->allocator, &new_value, value, len)) {
+			pvars_errno = FAILURE_PDICT_SET_STRN_VALUE_STRDUP_FAILED;
+			return;
+		}
+
+		if (!pdict_unshare_value(dict, key, &current)) {
+			pvar_destroy_in(dict->allocator, &new_value);
+			return;
+		}
+
+		pvar_destroy_in(dict->allocator, current);
+		*current = new_value;
+		
+		pvars_errno = SUCCESS;
+		return;
+	}
+	
+	pvars_errno = FAILURE_PDICT_SET_STRN_VALUE_NOT_FOUND;
 }
 
 /**
@@ -1395,26 +2981,28 @@ void pdict_set_list(pdict_t *dict, const char *key, const plist_t *value)
 		return;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
-
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			pvar_destroy_internal(&(current->value));
+	pvar_t *current = pdict_find_value(dict, key);
 
-			plist_t *new_list = plist_copy(value);
-			if (new_list == NULL) {
-				pvars_errno = FAILURE_PDICT_SET_LIST_VALUE_PLIST_COPY_FAILED;
-				return;
-			}
+	if (current != NULL) {
+		// Copied before the old value is released: value may be borrowed from it
+		plist_t *new_list = plist_copy_in(dict->allocator, value);
+		if (new_list == NULL) {
+			pvars_errno = FAILURE_PDICT_SET_LIST_VALUE_PLIST_COPY_FAILED;
+			return;
+		}
 
-			current->value.type = PVAR_TYPE_LIST;
-			current->value.data.ls = new_list;
-			
-			pvars_errno = SUCCESS;
+		if (!pdict_unshare_value(dict, key, &current)) {
+			plist_destroy(new_list);
 			return;
 		}
-		current = current->next;
+
+		pvar_destroy_in(dict->allocator, current);
+
+		current->type = PVAR_TYPE_LIST;
+		current->data.ls = new_list;
+		
+		pvars_errno = SUCCESS;
+		return;
 	}
 	
 	pvars_errno = FAILURE_PDICT_SET_LIST_VALUE_NOT_FOUND;
@@ -1445,31 +3033,141 @@ void pdict_set_dict(pdict_t *dict, const char *key, const pdict_t *value)
 		return;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
-
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			pvar_destroy_internal(&(current->value));
+	pvar_t *current = pdict_find_value(dict, key);
 
-			pdict_t *new_dict = pdict_copy(value);
-			if (new_dict == NULL) {
-				pvars_errno = FAILURE_PDICT_SET_DICT_VALUE_PDICT_COPY_FAILED;
-				return;
-			}
+	if (current != NULL) {
+		// Copied before the old value is released: value may be borrowed from it
+		pdict_t *new_dict = pdict_copy_in(dict->allocator, value);
+		if (new_dict == NULL) {
+			pvars_errno = FAILURE_PDICT_SET_DICT_VALUE_PDICT_COPY_FAILED;
+			return;
+		}
 
-			current->value.type = PVAR_TYPE_DICT;
-			current->value.data.dt = new_dict;
-			
-			pvars_errno = SUCCESS;
+		if (!pdict_unshare_value(dict, key, &current)) {
+			pdict_destroy(new_dict);
 			return;
 		}
-		current = current->next;
+
+		pvar_destroy_in(dict->allocator, current);
+
+		current->type = PVAR_TYPE_DICT;
+		current->data.dt = new_dict;
+		
+		pvars_errno = SUCCESS;
+		return;
 	}
 	
 	pvars_errno = FAILURE_PDICT_SET_DICT_VALUE_NOT_FOUND;
 }
 
+/**
+ * @brief Replaces an element with a list in a pdict_t variable, taking
+ * ownership of it instead of copying
+ *
+ * The previous value is freed. On success the dict owns value; on failure
+ * ownership stays with the caller.
+ *
+ * @param The address of a dict.
+ * @param Char key
+ * @param The value to move into the dict
+ * @return void
+ */
+void pdict_set_list_take(pdict_t *dict, const char *key, plist_t *value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_SET_LIST_TAKE_NULL_INPUT_DICT;
+		return;
+	}
+	if (key == NULL) {
+		pvars_errno = FAILURE_PDICT_SET_LIST_TAKE_NULL_INPUT_KEY;
+		return;
+	}
+	if (value == NULL) {
+		pvars_errno = FAILURE_PDICT_SET_LIST_TAKE_NULL_INPUT_VALUE;
+		return;
+	}
+	if (value->allocator != dict->allocator) {
+		pvars_errno = FAILURE_PDICT_SET_LIST_TAKE_ALLOCATOR_MISMATCH;
+		return;
+	}
+
+	pvar_t *current = pdict_find_value(dict, key);
+
+	if (current != NULL) {
+		if (!pdict_unshare_value(dict, key, &current)) {
+			return;
+		}
+
+		pvar_destroy_in(dict->allocator, current);
+
+		current->type = PVAR_TYPE_LIST;
+		current->data.ls = value;
+		
+		pvars_errno = SUCCESS;
+		return;
+	}
+	
+	pvars_errno = FAILURE_PDICT_SET_LIST_TAKE_VALUE_NOT_FOUND;
+}
+
+/**
+ * @brief Replaces an element with a dict in a pdict_t variable, taking
+ * ownership of it instead of copying
+ *
+ * The previous value is freed. On success the dict owns value; on failure
+ * ownership stays with the caller.
+ *
+ * @param The address of a dict.
+ * @param Char key
+ * @param The value to move into the dict
+ * @return void
+ */
+void pdict_set_dict_take(pdict_t *dict, const char *key, pdict_t *value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_SET_DICT_TAKE_NULL_INPUT_DICT;
+		return;
+	}
+	if (key == NULL) {
+		pvars_errno = FAILURE_PDICT_SET_DICT_TAKE_NULL_INPUT_KEY;
+		return;
+	}
+	if (value == NULL) {
+		pvars_errno = FAILURE_PDICT_SET_DICT_TAKE_NULL_INPUT_VALUE;
+		return;
+	}
+	if (value->allocator != dict->allocator) {
+		pvars_errno = FAILURE_PDICT_SET_DICT_TAKE_ALLOCATOR_MISMATCH;
+		return;
+	}
+	if (value == dict) {
+		pvars_errno = FAILURE_PDICT_SET_DICT_TAKE_SELF_INSERT;
+		return;
+	}
+
+	pvar_t *current = pdict_find_value(dict, key);
+
+	if (current != NULL) {
+		if (!pdict_unshare_value(dict, key, &current)) {
+			return;
+		}
+
+		pvar_destroy_in(dict->allocator, current);
+
+		current->type = PVAR_TYPE_DICT;
+		current->data.dt = value;
+		
+		pvars_errno = SUCCESS;
+		return;
+	}
+	
+	pvars_errno = FAILURE_PDICT_SET_DICT_TAKE_VALUE_NOT_FOUND;
+}
+
 /**
  * @brief Replaces an element with an int in a pdict_t variable
  *
@@ -1491,21 +3189,21 @@ void pdict_set_int(pdict_t *dict, const char *key, int value)
 		return;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
+	pvar_t *current = pdict_find_value(dict, key);
 
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			pvar_destroy_internal(&(current->value));
-
-
-			current->value.type = PVAR_TYPE_INT;
-			current->value.data.i = value;
-			
-			pvars_errno = SUCCESS;
+	if (current != NULL) {
+		if (!pdict_unshare_value(dict, key, &current)) {
 			return;
 		}
-		current = current->next;
+
+		pvar_destroy_in(dict->allocator, current);
+
+
+		current->type = PVAR_TYPE_INT;
+		current->data.i = value;
+		
+		pvars_errno = SUCCESS;
+		return;
 	}
 	
 	pvars_errno = FAILURE_PDICT_SET_INT_VALUE_NOT_FOUND;
@@ -1532,21 +3230,21 @@ void pdict_set_double(pdict_t *dict, const char *key, double value)
 		return;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
-
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			pvar_destroy_internal(&(current->value));
-
+	pvar_t *current = pdict_find_value(dict, key);
 
-			current->value.type = PVAR_TYPE_DOUBLE;
-			current->value.data.d = value;
-			
-			pvars_errno = SUCCESS;
+	if (current != NULL) {
+		if (!pdict_unshare_value(dict, key, &current)) {
 			return;
 		}
-		current = current->next;
+
+		pvar_destroy_in(dict->allocator, current);
+
+
+		current->type = PVAR_TYPE_DOUBLE;
+		current->data.d = value;
+		
+		pvars_errno = SUCCESS;
+		return;
 	}
 	
 	pvars_errno = FAILURE_PDICT_SET_DOUBLE_VALUE_NOT_FOUND;
@@ -1573,21 +3271,21 @@ void pdict_set_long(pdict_t *dict, const char *key, long value)
 		return;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
+	pvar_t *current = pdict_find_value(dict, key);
 
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			pvar_destroy_internal(&(current->value));
-
-
-			current->value.type = PVAR_TYPE_LONG;
-			current->value.data.l = value;
-			
-			pvars_errno = SUCCESS;
+	if (current != NULL) {
+		if (!pdict_unshare_value(dict, key, &current)) {
 			return;
 		}
-		current = current->next;
+
+		pvar_destroy_in(dict->allocator, current);
+
+
+		current->type = PVAR_TYPE_LONG;
+		current->data.l = value;
+		
+		pvars_errno = SUCCESS;
+		return;
 	}
 	
 	pvars_errno = FAILURE_PDICT_SET_LONG_VALUE_NOT_FOUND;
@@ -1614,21 +3312,21 @@ void pdict_set_float(pdict_t *dict, const char *key, float value)
 		return;
 	}
 
-	size_t bucket_index = pdict_hash(key, dict->capacity);
-	pdict_entry_t *current = dict->buckets[bucket_index];
-
-	while (current != NULL) {
-		if (strcmp(current->key, key) == STRING_MATCH) {
-			pvar_destroy_internal(&(current->value));
-
+	pvar_t *current = pdict_find_value(dict, key);
 
-			current->value.type = PVAR_TYPE_FLOAT;
-			current->value.data.f = value;
-			
-			pvars_errno = SUCCESS;
+	if (current != NULL) {
+		if (!pdict_unshare_value(dict, key, &current)) {
 			return;
 		}
-		current = current->next;
+
+		pvar_destroy_in(dict->allocator, current);
+
+
+		current->type = PVAR_TYPE_FLOAT;
+		current->data.f = value;
+		
+		pvars_errno = SUCCESS;
+		return;
 	}
 	
 	pvars_errno = FAILURE_PDICT_SET_FLOAT_VALUE_NOT_FOUND;
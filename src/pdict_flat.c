@@ -0,0 +1,436 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<stddef.h>
+#include<stdlib.h>
+#include<string.h>
+
+#if defined(__SSE2__)
+#include<emmintrin.h>
+#endif
+
+#include"pvars.h"
+#include"pvars_internal.h"
+#include"perrno.h"
+#include"pdict_internal.h"
+#include"pmem_internal.h"
+
+/*
+ * PDICT_BACKEND_FLAT: an open addressing table in the style of SwissTable.
+ *
+ * Each slot has a control byte. EMPTY and DELETED have the high bit set;
+ * a full slot stores the low 7 bits of its hash (h2). Probing starts at
+ * slot (hash >> 7) & mask and inspects PDICT_GROUP_WIDTH control bytes at
+ * a time, so a lookup usually touches one cache line of control bytes and
+ * compares the full hash/key of only those slots whose h2 matches.
+ *
+ * The first PDICT_GROUP_WIDTH control bytes are mirrored after the end of
+ * the array, letting a group that starts near the end be loaded without
+ * wrapping.
+ */
+
+#define PDICT_CTRL_EMPTY ((unsigned char)0x80)
+#define PDICT_CTRL_DELETED ((unsigned char)0xFE)
+
+/**
+ * @brief Builds a bitmask of the group's control bytes equal to tag.
+ *
+ * @param group Pointer to PDICT_GROUP_WIDTH control bytes.
+ * @param tag The control byte to match.
+ * @return Bit i is set if group[i] == tag.
+ */
+static unsigned int pdict_group_match(const unsigned char *group, unsigned char tag)
+{
+#if defined(__SSE2__)
+	__m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+	return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)tag)));
+#else
+	unsigned int mask = 0;
+
+	for (unsigned int i = 0; i < PDICT_GROUP_WIDTH; i++) {
+		if (group[i] == tag) {
+			mask |= 1u << i;
+		}
+	}
+
+	return mask;
+#endif
+}
+
+/**
+ * @brief Builds a bitmask of the group's EMPTY or DELETED control bytes.
+ *
+ * @param group Pointer to PDICT_GROUP_WIDTH control bytes.
+ * @return Bit i is set if group[i] can take a new entry.
+ */
+static unsigned int pdict_group_match_free(const unsigned char *group)
+{
+#if defined(__SSE2__)
+	/* Free slots have the high bit set, full slots never do */
+	__m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+	return (unsigned int)_mm_movemask_epi8(ctrl);
+#else
+	unsigned int mask = 0;
+
+	for (unsigned int i = 0; i < PDICT_GROUP_WIDTH; i++) {
+		if (group[i] & 0x80) {
+			mask |= 1u << i;
+		}
+	}
+
+	return mask;
+#endif
+}
+
+/**
+ * @brief Returns the index of the lowest set bit of a non-zero mask.
+ */
+static unsigned int pdict_lowest_bit(unsigned int mask)
+{
+#if defined(__GNUC__)
+	return (unsigned int)__builtin_ctz(mask);
+#else
+	unsigned int index = 0;
+
+	while ((mask & 1u) == 0) {
+		mask >>= 1;
+		index++;
+	}
+
+	return index;
+#endif
+}
+
+/**
+ * @brief Returns how many of the top bits of a group's non-zero mask are
+ * clear, counting PDICT_GROUP_WIDTH bits.
+ */
+static unsigned int pdict_leading_zeros(unsigned int mask)
+{
+#if defined(__GNUC__)
+	return (unsigned int)__builtin_clz(mask) - (unsigned int)(sizeof(unsigned int) * 8 - PDICT_GROUP_WIDTH);
+#else
+	unsigned int count = 0;
+
+	for (unsigned int bit = 1u << (PDICT_GROUP_WIDTH - 1); (mask & bit) == 0; bit >>= 1) {
+		count++;
+	}
+
+	return count;
+#endif
+}
+
+/**
+ * @brief Writes a control byte, keeping the mirrored tail in sync.
+ */
+static void pdict_flat_set_ctrl(pdict_t *dict, size_t index, unsigned char tag)
+{
+	dict->ctrl[index] = tag;
+
+	if (index < PDICT_GROUP_WIDTH) {
+		dict->ctrl[dict->capacity + index] = tag;
+	}
+}
+
+/**
+ * @brief Returns the largest number of entries a flat table of the given
+ * capacity may hold.
+ */
+static size_t pdict_flat_max_count(const pdict_t *dict, size_t capacity)
+{
+	double load_factor = dict->max_load_factor;
+
+	if (load_factor > PDICT_FLAT_MAX_LOAD_FACTOR) {
+		load_factor = PDICT_FLAT_MAX_LOAD_FACTOR;
+	}
+
+	size_t max_count = (size_t)((double)capacity * load_factor);
+
+	/* At least one slot must stay EMPTY so that every probe terminates */
+	if (max_count >= capacity) {
+		max_count = capacity - 1;
+	}
+
+	return max_count < 1 ? 1 : max_count;
+}
+
+/**
+ * @brief Returns the flat table capacity (a power of two, at least
+ * PDICT_GROUP_WIDTH) needed to hold count entries.
+ *
+ * @param dict The dict whose load factor is used.
+ * @param count The number of entries to make room for.
+ */
+size_t pdict_flat_capacity_for(const pdict_t *dict, size_t count)
+{
+	size_t capacity = PDICT_GROUP_WIDTH;
+
+	while (pdict_flat_max_count(dict, capacity) < count) {
+		capacity *= 2;
+	}
+
+	return capacity;
+}
+
+/**
+ * @brief Allocates empty control and slot arrays of the given capacity.
+ *
+ * @param dict The dict to initialise. Its previous arrays are not freed.
+ * @param capacity Number of slots. Must be a power of two >= PDICT_GROUP_WIDTH.
+ * @return True on success, false if an allocation failed.
+ */
+bool pdict_flat_init(pdict_t *dict, size_t capacity)
+{
+	unsigned char *ctrl = pmem_malloc(dict->allocator, capacity + PDICT_GROUP_WIDTH);
+	if (ctrl == NULL) {
+		return false;
+	}
+
+	pdict_slot_t *slots = pmem_malloc(dict->allocator, capacity * sizeof(pdict_slot_t));
+	if (slots == NULL) {
+		pmem_free(dict->allocator, ctrl, capacity + PDICT_GROUP_WIDTH);
+		return false;
+	}
+
+	memset(ctrl, PDICT_CTRL_EMPTY, capacity + PDICT_GROUP_WIDTH);
+
+	dict->ctrl = ctrl;
+	dict->slots = slots;
+	dict->capacity = capacity;
+	dict->growth_left = pdict_flat_max_count(dict, capacity);
+
+	return true;
+}
+
+/**
+ * @brief Finds the slot index holding key.
+ *
+ * @param dict The dict to search.
+ * @param lookup The key to search for.
+ * @param out_index Receives the slot index when found.
+ * @return True if the key was found.
+ */
+static bool pdict_flat_find_index(const pdict_t *dict, const pdict_key_t *lookup, size_t *out_index)
+{
+	size_t mask = dict->capacity - 1;
+	size_t position = (lookup->hash >> 7) & mask;
+	unsigned char tag = (unsigned char)(lookup->hash & 0x7F);
+
+	for (size_t stride = PDICT_GROUP_WIDTH; ; stride += PDICT_GROUP_WIDTH) {
+		const unsigned char *group = dict->ctrl + position;
+		unsigned int match = pdict_group_match(group, tag);
+
+		while (match != 0) {
+			size_t index = (position + pdict_lowest_bit(match)) & mask;
+			const pdict_slot_t *slot = &dict->slots[index];
+
+			if (slot->hash == lookup->hash && (slot->key == lookup->str || (pstr_len(slot->key) == lookup->len &&
+					memcmp(slot->key, lookup->str, lookup->len) == STRING_MATCH))) {
+				*out_index = index;
+				return true;
+			}
+			match &= match - 1;
+		}
+
+		if (pdict_group_match(group, PDICT_CTRL_EMPTY) != 0) {
+			return false;
+		}
+
+		position = (position + stride) & mask;
+	}
+}
+
+/**
+ * @brief Returns the first EMPTY or DELETED slot on key's probe sequence.
+ */
+static size_t pdict_flat_find_free(const pdict_t *dict, size_t hash)
+{
+	size_t mask = dict->capacity - 1;
+	size_t position = (hash >> 7) & mask;
+
+	for (size_t stride = PDICT_GROUP_WIDTH; ; stride += PDICT_GROUP_WIDTH) {
+		unsigned int free_slots = pdict_group_match_free(dict->ctrl + position);
+
+		if (free_slots != 0) {
+			return (position + pdict_lowest_bit(free_slots)) & mask;
+		}
+
+		position = (position + stride) & mask;
+	}
+}
+
+/**
+ * @brief Moves every entry into freshly allocated arrays of new_capacity
+ * slots. Cached hashes are reused, so no key is hashed or compared.
+ *
+ * @param dict The dict to resize.
+ * @param new_capacity The new slot count (power of two >= PDICT_GROUP_WIDTH).
+ * @return True on success, false if allocation failed (the dict is unchanged).
+ */
+bool pdict_flat_resize(pdict_t *dict, size_t new_capacity)
+{
+	unsigned char *old_ctrl = dict->ctrl;
+	pdict_slot_t *old_slots = dict->slots;
+	size_t old_capacity = dict->capacity;
+
+	if (!pdict_flat_init(dict, new_capacity)) {
+		dict->ctrl = old_ctrl;
+		dict->slots = old_slots;
+		dict->capacity = old_capacity;
+		return false;
+	}
+
+	for (size_t i = 0; i < old_capacity; i++) {
+		if (old_ctrl[i] & 0x80) {
+			continue;
+		}
+
+		size_t index = pdict_flat_find_free(dict, old_slots[i].hash);
+		dict->slots[index] = old_slots[i];
+		pdict_flat_set_ctrl(dict, index, (unsigned char)(old_slots[i].hash & 0x7F));
+	}
+
+	dict->growth_left = dict->growth_left > dict->count ? dict->growth_left - dict->count : 0;
+
+	pmem_free(dict->allocator, old_ctrl, old_capacity + PDICT_GROUP_WIDTH);
+	pmem_free(dict->allocator, old_slots, old_capacity * sizeof(pdict_slot_t));
+
+	return true;
+}
+
+/**
+ * @brief Looks up the value stored under key.
+ *
+ * @param dict The dict to search.
+ * @param lookup The key to search for.
+ * @return A pointer to the value inside the table, or NULL if not found.
+ */
+pvar_t *pdict_flat_find(const pdict_t *dict, const pdict_key_t *lookup)
+{
+	size_t index;
+
+	if (!pdict_flat_find_index(dict, lookup, &index)) {
+		return NULL;
+	}
+
+	return &dict->slots[index].value;
+}
+
+/**
+ * @brief Stores a new entry. The key must not already be present.
+ *
+ * When the table reaches its load factor it is rebuilt at the same size if
+ * at most half of the used slots hold entries, dropping the tombstones, and
+ * grown (all at once) otherwise. If growing fails, tombstones are reclaimed
+ * in place when possible.
+ *
+ * @param dict The dict to insert into.
+ * @param lookup The key's length and hash.
+ * @param key A copy of the key. Ownership passes to the dict on success.
+ * @param value The value. Ownership passes to the dict on success.
+ * @return True on success, false if no slot could be made available.
+ */
+bool pdict_flat_insert(pdict_t *dict, const pdict_key_t *lookup, char *key, const pvar_t *value)
+{
+	size_t hash = lookup->hash;
+	size_t index = pdict_flat_find_free(dict, hash);
+
+	/* Reusing a tombstone never brings the table closer to full */
+	if (dict->ctrl[index] == PDICT_CTRL_EMPTY && dict->growth_left == 0) {
+		size_t max_count = pdict_flat_max_count(dict, dict->capacity);
+
+		/* Mostly tombstones: a same-size rebuild drops them without growing */
+		if (dict->count <= max_count / 2) {
+			if (!pdict_flat_resize(dict, dict->capacity)) {
+				return false;
+			}
+		} else if (!pdict_flat_resize(dict, dict->capacity * 2)) {
+			/* Out of memory: a same-size rebuild still drops the tombstones */
+			if (dict->count >= max_count || !pdict_flat_resize(dict, dict->capacity)) {
+				return false;
+			}
+		}
+		index = pdict_flat_find_free(dict, hash);
+	}
+
+	if (dict->ctrl[index] == PDICT_CTRL_EMPTY) {
+		dict->growth_left--;
+	}
+
+	dict->slots[index].key = key;
+	dict->slots[index].hash = hash;
+	dict->slots[index].value = *value;
+	pdict_flat_set_ctrl(dict, index, (unsigned char)(hash & 0x7F));
+
+	dict->count++;
+	return true;
+}
+
+/**
+ * @brief Removes key and frees its key string. The value is moved out.
+ *
+ * @param dict The dict to modify.
+ * @param lookup The key to remove.
+ * @param out_value Receives the removed value, now owned by the caller.
+ * @return True if the key was found and removed.
+ */
+bool pdict_flat_erase(pdict_t *dict, const pdict_key_t *lookup, pvar_t *out_value)
+{
+	size_t index;
+
+	if (!pdict_flat_find_index(dict, lookup, &index)) {
+		return false;
+	}
+
+	pdict_slot_t *slot = &dict->slots[index];
+	pdict_key_free(dict, slot->key);
+	*out_value = slot->value;
+
+	/*
+	 * A probe only passes this slot if it found every slot of a group
+	 * around it full. When the full run through the slot is shorter than a
+	 * group, no probe went past it, and it can go back to EMPTY.
+	 */
+	size_t before = (index - PDICT_GROUP_WIDTH) & (dict->capacity - 1);
+	unsigned int empty_before = pdict_group_match(dict->ctrl + before, PDICT_CTRL_EMPTY);
+	unsigned int empty_after = pdict_group_match(dict->ctrl + index, PDICT_CTRL_EMPTY);
+
+	if (empty_before != 0 && empty_after != 0
+		&& pdict_lowest_bit(empty_after) + pdict_leading_zeros(empty_before) < PDICT_GROUP_WIDTH) {
+		pdict_flat_set_ctrl(dict, index, PDICT_CTRL_EMPTY);
+		dict->growth_left++;
+	} else {
+		pdict_flat_set_ctrl(dict, index, PDICT_CTRL_DELETED);
+	}
+	dict->count--;
+
+	return true;
+}
+
+/**
+ * @brief Frees every key and value and marks all slots EMPTY.
+ *
+ * @param dict The dict to clear. Its arrays are kept.
+ */
+void pdict_flat_clear(pdict_t *dict)
+{
+	for (size_t i = 0; i < dict->capacity; i++) {
+		if (dict->ctrl[i] & 0x80) {
+			continue;
+		}
+
+		pdict_key_free(dict, dict->slots[i].key);
+		pvar_destroy_in(dict->allocator, &dict->slots[i].value);
+	}
+
+	memset(dict->ctrl, PDICT_CTRL_EMPTY, dict->capacity + PDICT_GROUP_WIDTH);
+	dict->count = 0;
+	dict->growth_left = pdict_flat_max_count(dict, dict->capacity);
+}
+
+/**
+ * @brief Returns true if slot index holds an entry.
+ */
+bool pdict_flat_is_full(const pdict_t *dict, size_t index)
+{
+	return (dict->ctrl[index] & 0x80) == 0;
+}
@@ -0,0 +1,236 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<stddef.h>
+#include<string.h>
+
+#include"pvars.h"
+#include"pdict_internal.h"
+#include"pmem_internal.h"
+
+/**
+ * @brief A block of entries for a PDICT_BACKEND_CHAINED dict. Unused entries
+ * are threaded through their 'next' pointers onto the dict's free list and
+ * have a NULL key.
+ */
+struct pdict_slab_t {
+	struct pdict_slab_t *next; // Older slab
+	size_t count;              // Entries in this slab
+	pdict_entry_t entries[];
+};
+
+/**
+ * @brief Returns the bytes held by a slab of count entries.
+ */
+static size_t pdict_slab_bytes(size_t count)
+{
+	return sizeof(pdict_slab_t) + count * sizeof(pdict_entry_t);
+}
+
+/**
+ * @brief Adds a slab of count entries to the dict and puts all of them on
+ * the free list.
+ *
+ * @return True on success, false if the slab could not be allocated.
+ */
+static bool pdict_slab_add(pdict_t *dict, size_t count)
+{
+	pdict_slab_t *slab = pmem_malloc(dict->allocator, pdict_slab_bytes(count));
+	if (slab == NULL) {
+		return false;
+	}
+
+	slab->count = count;
+	slab->next = dict->slabs;
+	dict->slabs = slab;
+	dict->slab_count++;
+	dict->slab_capacity += count;
+
+	/* Pushed in reverse so that entries are handed out in address order */
+	for (size_t i = count; i-- > 0;) {
+		slab->entries[i].key = NULL;
+		slab->entries[i].next = dict->free_entries;
+		dict->free_entries = &slab->entries[i];
+	}
+	dict->free_count += count;
+
+	return true;
+}
+
+/**
+ * @brief Adds a slab to the dict.
+ *
+ * Each slab is as large as all earlier ones together, within
+ * PDICT_SLAB_MIN_ENTRIES and PDICT_SLAB_MAX_ENTRIES, so the number of slabs
+ * grows logarithmically with the dict.
+ *
+ * @return True on success, false if the slab could not be allocated.
+ */
+static bool pdict_slab_grow(pdict_t *dict)
+{
+	size_t count = dict->slab_capacity;
+
+	if (count < PDICT_SLAB_MIN_ENTRIES) {
+		count = PDICT_SLAB_MIN_ENTRIES;
+	}
+	if (count > PDICT_SLAB_MAX_ENTRIES) {
+		count = PDICT_SLAB_MAX_ENTRIES;
+	}
+
+	return pdict_slab_add(dict, count);
+}
+
+/**
+ * @brief Makes sure count entries can be taken without adding a slab. The
+ * missing entries come in one slab of exactly that size, so a dict whose
+ * final size is known does not get PDICT_SLAB_MIN_ENTRIES of them.
+ *
+ * @param dict The dict the entries are for.
+ * @param count Number of entries needed.
+ * @return True on success, false if the slab could not be allocated.
+ */
+bool pdict_slab_reserve(pdict_t *dict, size_t count)
+{
+	if (dict->free_count >= count) {
+		return true;
+	}
+
+	return pdict_slab_add(dict, count - dict->free_count);
+}
+
+/**
+ * @brief Takes an entry from the dict's free list, adding a slab if needed.
+ *
+ * @param dict The dict the entry is for.
+ * @return An uninitialised entry, or NULL if a slab could not be allocated.
+ */
+pdict_entry_t *pdict_slab_alloc(pdict_t *dict)
+{
+	if (dict->free_entries == NULL && !pdict_slab_grow(dict)) {
+		return NULL;
+	}
+
+	pdict_entry_t *entry = dict->free_entries;
+	dict->free_entries = entry->next;
+	dict->free_count--;
+
+	return entry;
+}
+
+/**
+ * @brief Returns an entry to the dict's free list. Its key and value must
+ * already have been released.
+ *
+ * @param dict The dict owning the entry.
+ * @param entry The entry to recycle.
+ */
+void pdict_slab_release(pdict_t *dict, pdict_entry_t *entry)
+{
+	entry->key = NULL;
+	entry->next = dict->free_entries;
+	dict->free_entries = entry;
+	dict->free_count++;
+}
+
+/**
+ * @brief Frees the slabs none of whose entries are in use and rebuilds the
+ * free list from the rest.
+ *
+ * @param dict The dict to trim.
+ */
+void pdict_slab_trim(pdict_t *dict)
+{
+	if (dict->free_count == 0) {
+		return;
+	}
+
+	pdict_slab_t **link = &dict->slabs;
+
+	dict->free_entries = NULL;
+	dict->free_count = 0;
+
+	while (*link != NULL) {
+		pdict_slab_t *slab = *link;
+		size_t unused = 0;
+
+		for (size_t i = 0; i < slab->count; i++) {
+			unused += (slab->entries[i].key == NULL);
+		}
+
+		if (unused == slab->count) {
+			*link = slab->next;
+			dict->slab_count--;
+			dict->slab_capacity -= slab->count;
+			pmem_free(dict->allocator, slab, pdict_slab_bytes(slab->count));
+			continue;
+		}
+
+		for (size_t i = slab->count; i-- > 0;) {
+			if (slab->entries[i].key == NULL) {
+				slab->entries[i].next = dict->free_entries;
+				dict->free_entries = &slab->entries[i];
+			}
+		}
+		dict->free_count += unused;
+
+		link = &slab->next;
+	}
+}
+
+/**
+ * @brief Frees every slab of the dict, whether or not its entries are in use.
+ *
+ * @param dict The dict being destroyed.
+ */
+void pdict_slab_destroy(pdict_t *dict)
+{
+	pdict_slab_t *slab = dict->slabs;
+
+	while (slab != NULL) {
+		pdict_slab_t *next = slab->next;
+		pmem_free(dict->allocator, slab, pdict_slab_bytes(slab->count));
+		slab = next;
+	}
+
+	dict->slabs = NULL;
+	dict->free_entries = NULL;
+	dict->slab_count = 0;
+	dict->slab_capacity = 0;
+	dict->free_count = 0;
+}
+
+/**
+ * @brief Reports how the dict's entry slabs are used.
+ *
+ * Entries of a PDICT_BACKEND_CHAINED dict are carved out of slabs and
+ * recycled through a free list, so removing and re-adding keys does not
+ * touch the allocator. pdict_empty() keeps the slabs; pdict_shrink_to_fit()
+ * releases those that are entirely unused. A PDICT_BACKEND_FLAT dict stores
+ * its entries inline and reports zero slabs.
+ *
+ * @param dict The dict to query.
+ * @param out_stats Receives the statistics.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pdict_get_slab_stats(const pdict_t *dict, pdict_slab_stats_t *out_stats)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PDICT_GET_SLAB_STATS_NULL_INPUT;
+		return false;
+	}
+
+	if (out_stats == NULL) {
+		pvars_errno = FAILURE_PDICT_GET_SLAB_STATS_NULL_INPUT_OUT_VALUE;
+		return false;
+	}
+
+	out_stats->slab_count = dict->slab_count;
+	out_stats->entry_capacity = dict->slab_capacity;
+	out_stats->entries_free = dict->free_count;
+	out_stats->entries_in_use = dict->slab_capacity - dict->free_count;
+	out_stats->bytes = dict->slab_count * sizeof(pdict_slab_t) + dict->slab_capacity * sizeof(pdict_entry_t);
+
+	pvars_errno = SUCCESS;
+	return true;
+}
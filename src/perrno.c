@@ -35,6 +35,12 @@ const char *perror_message(void)
 			return "FAILURE: plist_ensure_capacity() failed in function plist_add_string()";
 		case FAILURE_PLIST_ADD_STR_STRDUP_FAILED:
 			return "FAILURE: strdup() failed in function plist_add_str()";
+		case FAILURE_PLIST_ADD_STRN_NULL_INPUT_LIST:
+			return "FAILURE: Null list passed to function plist_add_strn()";
+		case FAILURE_PLIST_ADD_STRN_NULL_STRING_INPUT:
+			return "FAILURE: NULL string passed to function plist_add_strn()";
+		case FAILURE_PLIST_ADD_STRN_STRDUP_FAILED:
+			return "FAILURE: Unable to allocate memory for the string in function plist_add_strn()";
 		case FAILURE_PLIST_GET_STR_NULL_INPUT:
 			return "FAILURE: NULL input passed to function plist_get_str()";
 		case FAILURE_PLIST_GET_STR_OUT_OF_BOUNDS:
@@ -45,6 +51,22 @@ const char *perror_message(void)
 			return "FAILURE: Cannot retrieve data: Element is not of the expected type (expected string) in function plist_get_str()";
 		case FAILURE_PLIST_GET_STR_STRDUP_FAILED:
 			return "FAILURE: strdup() failed in function plist_get_str()";
+		case FAILURE_PLIST_BORROW_STR_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_borrow_str()";
+		case FAILURE_PLIST_BORROW_STR_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_borrow_str()";
+		case FAILURE_PLIST_BORROW_STR_NULL_INPUT_OUT_VALUE:
+			return "FAILURE: NULL out_value passed to function plist_borrow_str()";
+		case FAILURE_PLIST_BORROW_STR_WRONG_TYPE:
+			return "FAILURE: Cannot borrow data: Element is not of the expected type (expected string) in function plist_borrow_str()";
+		case FAILURE_PLIST_BORROW_STRN_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_borrow_strn()";
+		case FAILURE_PLIST_BORROW_STRN_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_borrow_strn()";
+		case FAILURE_PLIST_BORROW_STRN_NULL_INPUT_OUT_VALUE:
+			return "FAILURE: NULL out_value or out_len passed to function plist_borrow_strn()";
+		case FAILURE_PLIST_BORROW_STRN_WRONG_TYPE:
+			return "FAILURE: Cannot borrow data: Element is not of the expected type (expected string) in function plist_borrow_strn()";
 		case FAILURE_PLIST_SET_STR_NULL_INPUT:
 			return "FAILURE: NULL input passed to function plist_set_str()";
 		case FAILURE_PLIST_SET_STR_OUT_OF_BOUNDS:
@@ -53,6 +75,14 @@ const char *perror_message(void)
 			return "FAILURE: NULL string input passed to function plist_set_str()";
 		case FAILURE_PLIST_SET_STR_STRDUP_FAILED:
 			return "FAILURE: Function strdup() failed to duplicate string in function plist_set_str()";
+		case FAILURE_PLIST_SET_STRN_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_set_strn()";
+		case FAILURE_PLIST_SET_STRN_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_set_strn()";
+		case FAILURE_PLIST_SET_STRN_NULL_STRING_INPUT:
+			return "FAILURE: NULL string input passed to function plist_set_strn()";
+		case FAILURE_PLIST_SET_STRN_STRDUP_FAILED:
+			return "FAILURE: Unable to allocate memory for the string in function plist_set_strn()";
 			
 		/* plist_add_int / plist_get_int / plist_set_int Failures */
 		case FAILURE_PLIST_ADD_INT_NULL_INPUT:
@@ -127,6 +157,14 @@ const char *perror_message(void)
 			return "FAILURE: plist_ensure_capacity() failed in function plist_add_list()";
 		case FAILURE_PLIST_ADD_LIST_PLIST_COPY_FAILED:
 			return "FAILURE: plist_copy() failed in function plist_add_list()";
+		case FAILURE_PLIST_ADD_LIST_TAKE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_add_list_take()";
+		case FAILURE_PLIST_ADD_LIST_TAKE_NULL_LIST_INPUT:
+			return "FAILURE: NULL list passed to function plist_add_list_take()";
+		case FAILURE_PLIST_ADD_LIST_TAKE_ALLOCATOR_MISMATCH:
+			return "FAILURE: The list was not created with the same allocator in function plist_add_list_take()";
+		case FAILURE_PLIST_ADD_LIST_TAKE_SELF_INSERT:
+			return "FAILURE: A list cannot be added to itself in function plist_add_list_take()";
 		case FAILURE_PLIST_GET_LIST_NULL_INPUT:
 			return "FAILURE: NULL input passed to function plist_get_list()";
 		case FAILURE_PLIST_GET_LIST_OUT_OF_BOUNDS:
@@ -137,6 +175,14 @@ const char *perror_message(void)
 			return "FAILURE: Cannot retrieve data: Element is not of the expected type (expected plist_t) in function plist_get_list()";
 		case FAILURE_PLIST_GET_LIST_PLIST_COPY_FAILED:
 			return "FAILURE: plist_copy() failed in function plist_get_list()";
+		case FAILURE_PLIST_BORROW_LIST_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_borrow_list()";
+		case FAILURE_PLIST_BORROW_LIST_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_borrow_list()";
+		case FAILURE_PLIST_BORROW_LIST_NULL_INPUT_OUT_VALUE:
+			return "FAILURE: NULL out_value passed to function plist_borrow_list()";
+		case FAILURE_PLIST_BORROW_LIST_WRONG_TYPE:
+			return "FAILURE: Cannot borrow data: Element is not of the expected type (expected list) in function plist_borrow_list()";
 		case FAILURE_PLIST_SET_LIST_NULL_INPUT:
 			return "FAILURE: NULL input passed to function plist_set_list()";
 		case FAILURE_PLIST_SET_LIST_OUT_OF_BOUNDS:
@@ -145,6 +191,16 @@ const char *perror_message(void)
 			return "FAILURE: NULL list input passed to function plist_set_list()";
 		case FAILURE_PLIST_SET_LIST_PLIST_COPY_FAILED:
 			return "FAILURE: plist_copy() failed in function plist_set_list()";
+		case FAILURE_PLIST_SET_LIST_TAKE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_set_list_take()";
+		case FAILURE_PLIST_SET_LIST_TAKE_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_set_list_take()";
+		case FAILURE_PLIST_SET_LIST_TAKE_NULL_LIST_INPUT:
+			return "FAILURE: NULL list passed to function plist_set_list_take()";
+		case FAILURE_PLIST_SET_LIST_TAKE_ALLOCATOR_MISMATCH:
+			return "FAILURE: The list was not created with the same allocator in function plist_set_list_take()";
+		case FAILURE_PLIST_SET_LIST_TAKE_SELF_INSERT:
+			return "FAILURE: A list cannot be stored in itself in function plist_set_list_take()";
 		
 		/* plist_add_dict plist_get_dict plist_set_dict Failures */
 		case FAILURE_PLIST_ADD_DICT_NULL_INPUT:
@@ -155,6 +211,12 @@ const char *perror_message(void)
 			return "FAILURE: plist_ensure_capacity() failed in function plist_add_dict()";
 		case FAILURE_PLIST_ADD_DICT_PDICT_COPY_FAILED:
 			return "FAILURE: pdict_copy() failed in function plist_add_dict()";
+		case FAILURE_PLIST_ADD_DICT_TAKE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_add_dict_take()";
+		case FAILURE_PLIST_ADD_DICT_TAKE_NULL_DICT_INPUT:
+			return "FAILURE: NULL dict passed to function plist_add_dict_take()";
+		case FAILURE_PLIST_ADD_DICT_TAKE_ALLOCATOR_MISMATCH:
+			return "FAILURE: The dict was not created with the same allocator in function plist_add_dict_take()";
 		case FAILURE_PLIST_GET_DICT_NULL_INPUT:
 			return "FAILURE: NULL input passed to function plist_get_dict()";
 		case FAILURE_PLIST_GET_DICT_OUT_OF_BOUNDS:
@@ -165,6 +227,14 @@ const char *perror_message(void)
 			return "FAILURE: Cannot retrieve data: Element is not of the expected type (expected pdict_t) in function plist_get_dict()";
 		case FAILURE_PLIST_GET_DICT_PDICT_COPY_FAILED:
 			return "FAILURE: pdict_copy() failed in function plist_get_dict()";
+		case FAILURE_PLIST_BORROW_DICT_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_borrow_dict()";
+		case FAILURE_PLIST_BORROW_DICT_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_borrow_dict()";
+		case FAILURE_PLIST_BORROW_DICT_NULL_INPUT_OUT_VALUE:
+			return "FAILURE: NULL out_value passed to function plist_borrow_dict()";
+		case FAILURE_PLIST_BORROW_DICT_WRONG_TYPE:
+			return "FAILURE: Cannot borrow data: Element is not of the expected type (expected dict) in function plist_borrow_dict()";
 		case FAILURE_PLIST_SET_DICT_NULL_INPUT:
 			return "FAILURE: NULL input passed to function plist_set_dict()";
 		case FAILURE_PLIST_SET_DICT_OUT_OF_BOUNDS:
@@ -173,6 +243,14 @@ const char *perror_message(void)
 			return "FAILURE: NULL dict input passed to function plist_set_dict()";
 		case FAILURE_PLIST_SET_DICT_PDICT_COPY_FAILED:
 			return "FAILURE: pdict_copy() failed in function plist_set_dict()";
+		case FAILURE_PLIST_SET_DICT_TAKE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_set_dict_take()";
+		case FAILURE_PLIST_SET_DICT_TAKE_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_set_dict_take()";
+		case FAILURE_PLIST_SET_DICT_TAKE_NULL_DICT_INPUT:
+			return "FAILURE: NULL dict passed to function plist_set_dict_take()";
+		case FAILURE_PLIST_SET_DICT_TAKE_ALLOCATOR_MISMATCH:
+			return "FAILURE: The dict was not created with the same allocator in function plist_set_dict_take()";
 		
 		/* plist_add_pvar Failures */
 		case FAILURE_PLIST_ADD_PVAR_NULL_INPUT:
@@ -184,10 +262,202 @@ const char *perror_message(void)
 		case FAILURE_PLIST_ADD_PVAR_PVAR_COPY_FAILED:
 			return "FAILURE: pvar_copy() failed in function plist_add_pvar()";
 
+		/* plist_extend_* Failures */
+		case FAILURE_PLIST_EXTEND_INTS_NULL_INPUT:
+			return "FAILURE: NULL input list passed to function plist_extend_ints()";
+		case FAILURE_PLIST_EXTEND_INTS_NULL_VALUES_INPUT:
+			return "FAILURE: NULL values array passed to function plist_extend_ints()";
+		case FAILURE_PLIST_EXTEND_INTS_REALLOC_FAILED:
+			return "FAILURE: Unable to grow list->elements in function plist_extend_ints()";
+		case FAILURE_PLIST_EXTEND_LONGS_NULL_INPUT:
+			return "FAILURE: NULL input list passed to function plist_extend_longs()";
+		case FAILURE_PLIST_EXTEND_LONGS_NULL_VALUES_INPUT:
+			return "FAILURE: NULL values array passed to function plist_extend_longs()";
+		case FAILURE_PLIST_EXTEND_LONGS_REALLOC_FAILED:
+			return "FAILURE: Unable to grow list->elements in function plist_extend_longs()";
+		case FAILURE_PLIST_EXTEND_DOUBLES_NULL_INPUT:
+			return "FAILURE: NULL input list passed to function plist_extend_doubles()";
+		case FAILURE_PLIST_EXTEND_DOUBLES_NULL_VALUES_INPUT:
+			return "FAILURE: NULL values array passed to function plist_extend_doubles()";
+		case FAILURE_PLIST_EXTEND_DOUBLES_REALLOC_FAILED:
+			return "FAILURE: Unable to grow list->elements in function plist_extend_doubles()";
+		case FAILURE_PLIST_EXTEND_FLOATS_NULL_INPUT:
+			return "FAILURE: NULL input list passed to function plist_extend_floats()";
+		case FAILURE_PLIST_EXTEND_FLOATS_NULL_VALUES_INPUT:
+			return "FAILURE: NULL values array passed to function plist_extend_floats()";
+		case FAILURE_PLIST_EXTEND_FLOATS_REALLOC_FAILED:
+			return "FAILURE: Unable to grow list->elements in function plist_extend_floats()";
+		case FAILURE_PLIST_EXTEND_STRS_NULL_INPUT:
+			return "FAILURE: NULL input list passed to function plist_extend_strs()";
+		case FAILURE_PLIST_EXTEND_STRS_NULL_VALUES_INPUT:
+			return "FAILURE: NULL values array passed to function plist_extend_strs()";
+		case FAILURE_PLIST_EXTEND_STRS_NULL_STRING_INPUT:
+			return "FAILURE: NULL string in the values passed to function plist_extend_strs()";
+		case FAILURE_PLIST_EXTEND_STRS_REALLOC_FAILED:
+			return "FAILURE: Unable to grow list->elements in function plist_extend_strs()";
+		case FAILURE_PLIST_EXTEND_STRS_STRDUP_FAILED:
+			return "FAILURE: Unable to allocate memory for a string in function plist_extend_strs()";
+		case FAILURE_PLIST_EXTEND_PVARS_NULL_INPUT:
+			return "FAILURE: NULL input list passed to function plist_extend_pvars()";
+		case FAILURE_PLIST_EXTEND_PVARS_NULL_VALUES_INPUT:
+			return "FAILURE: NULL values array passed to function plist_extend_pvars()";
+		case FAILURE_PLIST_EXTEND_PVARS_REALLOC_FAILED:
+			return "FAILURE: Unable to grow list->elements in function plist_extend_pvars()";
+		case FAILURE_PLIST_EXTEND_PVARS_PVAR_COPY_FAILED:
+			return "FAILURE: pvar_copy() failed in function plist_extend_pvars()";
+		case FAILURE_PLIST_EXTEND_NULL_INPUT:
+			return "FAILURE: NULL input list passed to function plist_extend()";
+		case FAILURE_PLIST_EXTEND_NULL_LIST_INPUT:
+			return "FAILURE: NULL source list passed to function plist_extend()";
+		case FAILURE_PLIST_EXTEND_REALLOC_FAILED:
+			return "FAILURE: Unable to grow list->elements in function plist_extend()";
+		case FAILURE_PLIST_EXTEND_PVAR_COPY_FAILED:
+			return "FAILURE: pvar_copy() failed in function plist_extend()";
+		case FAILURE_PLIST_INSERT_STR_NULL_INPUT_LIST:
+			return "FAILURE: NULL list passed to function plist_insert_str()";
+		case FAILURE_PLIST_INSERT_STR_NULL_STRING_INPUT:
+			return "FAILURE: NULL string passed to function plist_insert_str()";
+		case FAILURE_PLIST_INSERT_STR_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_insert_str()";
+		case FAILURE_PLIST_INSERT_STR_STRDUP_FAILED:
+			return "FAILURE: Unable to copy the string in function plist_insert_str()";
+		case FAILURE_PLIST_INSERT_STRN_NULL_INPUT_LIST:
+			return "FAILURE: NULL list passed to function plist_insert_strn()";
+		case FAILURE_PLIST_INSERT_STRN_NULL_STRING_INPUT:
+			return "FAILURE: NULL string passed to function plist_insert_strn()";
+		case FAILURE_PLIST_INSERT_STRN_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_insert_strn()";
+		case FAILURE_PLIST_INSERT_STRN_STRDUP_FAILED:
+			return "FAILURE: Unable to copy the string in function plist_insert_strn()";
+		case FAILURE_PLIST_INSERT_INT_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_insert_int()";
+		case FAILURE_PLIST_INSERT_INT_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_insert_int()";
+		case FAILURE_PLIST_INSERT_LONG_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_insert_long()";
+		case FAILURE_PLIST_INSERT_LONG_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_insert_long()";
+		case FAILURE_PLIST_INSERT_DOUBLE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_insert_double()";
+		case FAILURE_PLIST_INSERT_DOUBLE_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_insert_double()";
+		case FAILURE_PLIST_INSERT_FLOAT_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_insert_float()";
+		case FAILURE_PLIST_INSERT_FLOAT_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_insert_float()";
+		case FAILURE_PLIST_INSERT_LIST_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_insert_list()";
+		case FAILURE_PLIST_INSERT_LIST_NULL_LIST_INPUT:
+			return "FAILURE: NULL list passed to function plist_insert_list()";
+		case FAILURE_PLIST_INSERT_LIST_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_insert_list()";
+		case FAILURE_PLIST_INSERT_LIST_PLIST_COPY_FAILED:
+			return "FAILURE: plist_copy() failed in function plist_insert_list()";
+		case FAILURE_PLIST_INSERT_DICT_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_insert_dict()";
+		case FAILURE_PLIST_INSERT_DICT_NULL_DICT_INPUT:
+			return "FAILURE: NULL dict passed to function plist_insert_dict()";
+		case FAILURE_PLIST_INSERT_DICT_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_insert_dict()";
+		case FAILURE_PLIST_INSERT_DICT_PDICT_COPY_FAILED:
+			return "FAILURE: pdict_copy() failed in function plist_insert_dict()";
+		case FAILURE_PLIST_INSERT_PVAR_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_insert_pvar()";
+		case FAILURE_PLIST_INSERT_PVAR_NULL_PVAR_INPUT:
+			return "FAILURE: NULL pvar passed to function plist_insert_pvar()";
+		case FAILURE_PLIST_INSERT_PVAR_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_insert_pvar()";
+		case FAILURE_PLIST_INSERT_PVAR_PVAR_COPY_FAILED:
+			return "FAILURE: pvar_copy() failed in function plist_insert_pvar()";
+		case FAILURE_PLIST_INSERT_LIST_TAKE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_insert_list_take()";
+		case FAILURE_PLIST_INSERT_LIST_TAKE_NULL_LIST_INPUT:
+			return "FAILURE: NULL list passed to function plist_insert_list_take()";
+		case FAILURE_PLIST_INSERT_LIST_TAKE_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_insert_list_take()";
+		case FAILURE_PLIST_INSERT_LIST_TAKE_ALLOCATOR_MISMATCH:
+			return "FAILURE: The list was not created with the same allocator in function plist_insert_list_take()";
+		case FAILURE_PLIST_INSERT_LIST_TAKE_SELF_INSERT:
+			return "FAILURE: A list cannot be inserted into itself in function plist_insert_list_take()";
+		case FAILURE_PLIST_INSERT_DICT_TAKE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_insert_dict_take()";
+		case FAILURE_PLIST_INSERT_DICT_TAKE_NULL_DICT_INPUT:
+			return "FAILURE: NULL dict passed to function plist_insert_dict_take()";
+		case FAILURE_PLIST_INSERT_DICT_TAKE_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_insert_dict_take()";
+		case FAILURE_PLIST_INSERT_DICT_TAKE_ALLOCATOR_MISMATCH:
+			return "FAILURE: The dict was not created with the same allocator in function plist_insert_dict_take()";
+		case FAILURE_PLIST_RESERVE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_reserve()";
+		case FAILURE_PLIST_RESERVE_REALLOC_FAILED:
+			return "FAILURE: Unable to grow list->elements in function plist_reserve()";
+		case FAILURE_PLIST_SHRINK_TO_FIT_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_shrink_to_fit()";
+		case FAILURE_PLIST_SHRINK_TO_FIT_REALLOC_FAILED:
+			return "FAILURE: Unable to shrink list->elements in function plist_shrink_to_fit()";
+		case FAILURE_PLIST_SET_GROWTH_POLICY_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_set_growth_policy()";
+		case FAILURE_PLIST_SET_GROWTH_POLICY_UNKNOWN_POLICY:
+			return "FAILURE: Unknown growth policy passed to function plist_set_growth_policy()";
+		case FAILURE_PLIST_SET_GROWTH_POLICY_CHUNK_OUT_OF_BOUNDS:
+			return "FAILURE: Function plist_set_growth_policy() requires a chunk of at least 1 for PLIST_GROWTH_CHUNK";
+		case FAILURE_PLIST_CREATE_TYPED_UNSUPPORTED_TYPE:
+			return "FAILURE: Function plist_create_typed() requires PVAR_TYPE_INT, PVAR_TYPE_LONG, PVAR_TYPE_DOUBLE or PVAR_TYPE_FLOAT";
+		case FAILURE_PLIST_TYPED_LIST_TYPE_MISMATCH:
+			return "FAILURE: A typed list only stores values of its own type";
+		case FAILURE_PLIST_BORROW_SPAN_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_borrow_span()";
+		case FAILURE_PLIST_BORROW_SPAN_NOT_TYPED:
+			return "FAILURE: Function plist_borrow_span() requires a typed list";
+		case FAILURE_PLIST_BORROW_SPAN_MUTABLE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_borrow_span_mutable()";
+		case FAILURE_PLIST_BORROW_SPAN_MUTABLE_NOT_TYPED:
+			return "FAILURE: Function plist_borrow_span_mutable() requires a typed list";
+
+		/* Numeric reduction Failures */
+		case FAILURE_PLIST_SUM_NULL_INPUT:
+			return "FAILURE: NULL list or NULL output pointer passed to function plist_sum()";
+		case FAILURE_PLIST_SUM_NOT_NUMERIC:
+			return "FAILURE: Function plist_sum() found a value that is not a number";
+		case FAILURE_PLIST_MIN_NULL_INPUT:
+			return "FAILURE: NULL list or NULL output pointer passed to function plist_min()";
+		case FAILURE_PLIST_MIN_EMPTY_LIST:
+			return "FAILURE: Function plist_min() requires a non-empty list";
+		case FAILURE_PLIST_MIN_NOT_NUMERIC:
+			return "FAILURE: Function plist_min() found a value that is not a number";
+		case FAILURE_PLIST_MAX_NULL_INPUT:
+			return "FAILURE: NULL list or NULL output pointer passed to function plist_max()";
+		case FAILURE_PLIST_MAX_EMPTY_LIST:
+			return "FAILURE: Function plist_max() requires a non-empty list";
+		case FAILURE_PLIST_MAX_NOT_NUMERIC:
+			return "FAILURE: Function plist_max() found a value that is not a number";
+		case FAILURE_PLIST_MEAN_NULL_INPUT:
+			return "FAILURE: NULL list or NULL output pointer passed to function plist_mean()";
+		case FAILURE_PLIST_MEAN_EMPTY_LIST:
+			return "FAILURE: Function plist_mean() requires a non-empty list";
+		case FAILURE_PLIST_MEAN_NOT_NUMERIC:
+			return "FAILURE: Function plist_mean() found a value that is not a number";
+		case FAILURE_PLIST_VARIANCE_NULL_INPUT:
+			return "FAILURE: NULL list or NULL output pointer passed to function plist_variance()";
+		case FAILURE_PLIST_VARIANCE_EMPTY_LIST:
+			return "FAILURE: Function plist_variance() requires a non-empty list";
+		case FAILURE_PLIST_VARIANCE_NOT_NUMERIC:
+			return "FAILURE: Function plist_variance() found a value that is not a number";
+
 		/* plist_contains Failures */
 		case FAILURE_PLIST_CONTAINS_NULL_INPUT:
 			return "FAILURE: NULL input passed to function plist_contains()";
 		
+		/* plist_set_indexed / plist_index_of / plist_count_of Failures */
+		case FAILURE_PLIST_SET_INDEXED_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_set_indexed()";
+		case FAILURE_PLIST_INDEX_OF_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_index_of()";
+		case FAILURE_PLIST_INDEX_OF_NOT_FOUND:
+			return "FAILURE: Value not found in function plist_index_of()";
+		case FAILURE_PLIST_COUNT_OF_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_count_of()";
+		
 		/* plist_get_type Failures */
 		case FAILURE_PLIST_GET_TYPE_NULL_INPUT:
 			return "FAILURE: NULL input passed to function plist_get_type()";
@@ -205,6 +475,8 @@ const char *perror_message(void)
 			return "FAILURE: strdup() failed in function pvar_copy()";
 		case FAILURE_PVAR_COPY_PLIST_COPY_FAILED:
 			return "FAILURE: plist_copy() failed in function pvar_copy()";
+		case FAILURE_PVAR_COPY_PDICT_COPY_FAILED:
+			return "FAILURE: pdict_copy() failed in function pvar_copy()";
 		
 		/* plist_copy Failures */
 		case FAILURE_PLIST_COPY_NULL_INPUT:
@@ -223,6 +495,24 @@ const char *perror_message(void)
 			return "FAILURE: NULL input passed to function plist_remove()";
 		case FAILURE_PLIST_REMOVE_OUT_OF_BOUNDS:
 			return "FAILURE: Passed index is out of bounds in function plist_remove()";
+		case FAILURE_PLIST_POP_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_pop()";
+		case FAILURE_PLIST_POP_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_pop()";
+		case FAILURE_PLIST_POP_NULL_INPUT_OUT_VALUE:
+			return "FAILURE: NULL out_value passed to function plist_pop()";
+		case FAILURE_PLIST_POP_STRDUP_FAILED:
+			return "FAILURE: strdup() failed to move the string out of the arena in function plist_pop()";
+		case FAILURE_PLIST_REMOVE_RANGE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_remove_range()";
+		case FAILURE_PLIST_REMOVE_RANGE_OUT_OF_BOUNDS:
+			return "FAILURE: Passed range is out of bounds in function plist_remove_range()";
+		case FAILURE_PLIST_REMOVE_IF_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_remove_if()";
+		case FAILURE_PLIST_SWAP_REMOVE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function plist_swap_remove()";
+		case FAILURE_PLIST_SWAP_REMOVE_OUT_OF_BOUNDS:
+			return "FAILURE: Passed index is out of bounds in function plist_swap_remove()";
 			
 		/* pdict_create Failures */
 		case FAILURE_PDICT_CREATE_CAPACITY_OUT_OF_BOUNDS:
@@ -231,6 +521,26 @@ const char *perror_message(void)
 			return "FAILURE: malloc() failed to allocate memory to pdict_t *new_dict in function pdict_create()";
 		case FAILURE_PDICT_CREATE_NEW_DICT_BUCKETS_MALLOC_FAILED:
 			return "FAILURE: Unable to allocate memory to new_dict->buckets in function pdict_create()";
+		case FAILURE_PDICT_CREATE_UNKNOWN_BACKEND:
+			return "FAILURE: Unknown backend passed to function pdict_create_with_backend()";
+			
+		case FAILURE_PDICT_SET_DEFAULT_BACKEND_UNKNOWN_BACKEND:
+			return "FAILURE: Unknown backend passed to function pdict_set_default_backend()";
+		case FAILURE_PDICT_GET_BACKEND_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pdict_get_backend()";
+			
+		case FAILURE_PDICT_SET_HASH_FUNCTION_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pdict_set_hash_function()";
+		case FAILURE_PDICT_SET_HASH_FUNCTION_UNKNOWN_FUNCTION:
+			return "FAILURE: Unknown hash function passed to function pdict_set_hash_function()";
+		case FAILURE_PDICT_SET_HASH_FUNCTION_REHASH_MALLOC_FAILED:
+			return "FAILURE: Unable to allocate memory to rehash the dict in function pdict_set_hash_function()";
+		case FAILURE_PDICT_GET_HASH_FUNCTION_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pdict_get_hash_function()";
+		case FAILURE_PDICT_SET_HASH_SEED_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pdict_set_hash_seed()";
+		case FAILURE_PDICT_SET_HASH_SEED_REHASH_MALLOC_FAILED:
+			return "FAILURE: Unable to allocate memory to rehash the dict in function pdict_set_hash_seed()";
 			
 		/* pdict_entry_copy Failures */
 		case FAILURE_PDICT_ENTRY_COPY_NULL_INPUT:
@@ -257,6 +567,34 @@ const char *perror_message(void)
 			return "FAILURE: NULL key input passed to function pdict_remove()";
 		case FAILURE_PDICT_REMOVE_KEY_NOT_FOUND:
 			return "FAILURE: Key not found in function pdict_remove()";
+		case FAILURE_PDICT_POP_NULL_INPUT_DICT:
+			return "FAILURE: NULL dict input passed to function pdict_pop()";
+		case FAILURE_PDICT_POP_NULL_INPUT_KEY:
+			return "FAILURE: NULL key input passed to function pdict_pop()";
+		case FAILURE_PDICT_POP_NULL_INPUT_OUT_VALUE:
+			return "FAILURE: NULL out_value passed to function pdict_pop()";
+		case FAILURE_PDICT_POP_KEY_NOT_FOUND:
+			return "FAILURE: key not found in dict in function pdict_pop()";
+		case FAILURE_PDICT_POP_STRDUP_FAILED:
+			return "FAILURE: strdup() failed to move the string out of the arena in function pdict_pop()";
+		
+		/* pdict_reserve pdict_shrink_to_fit pdict_set_max_load_factor Failures */
+		case FAILURE_PDICT_RESERVE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pdict_reserve()";
+		case FAILURE_PDICT_RESERVE_BUCKETS_MALLOC_FAILED:
+			return "FAILURE: calloc() failed to allocate the new bucket array in function pdict_reserve()";
+		case FAILURE_PDICT_SHRINK_TO_FIT_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pdict_shrink_to_fit()";
+		case FAILURE_PDICT_SHRINK_TO_FIT_BUCKETS_MALLOC_FAILED:
+			return "FAILURE: calloc() failed to allocate the new bucket array in function pdict_shrink_to_fit()";
+		case FAILURE_PDICT_SET_MAX_LOAD_FACTOR_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pdict_set_max_load_factor()";
+		case FAILURE_PDICT_SET_MAX_LOAD_FACTOR_OUT_OF_BOUNDS:
+			return "FAILURE: Function pdict_set_max_load_factor() requires a load factor greater than 0";
+		case FAILURE_PDICT_GET_SLAB_STATS_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pdict_get_slab_stats()";
+		case FAILURE_PDICT_GET_SLAB_STATS_NULL_INPUT_OUT_VALUE:
+			return "FAILURE: NULL out_stats passed to function pdict_get_slab_stats()";
 		
 		/* pdict_print pdict_print_internal Failures */
 		case FAILURE_PDICT_PRINT_INTERNAL_NULL_INPUT:
@@ -277,6 +615,22 @@ const char *perror_message(void)
 			return "FAILURE: Unable to allocate memory to new_entry in function pdict_add_str()";
 		case FAILURE_PDICT_ADD_STR_KEY_STRDUP_FAILED:
 			return "FAILURE: strdup() failed to allocate memory to new_string in function pdict_add_str()";
+		case FAILURE_PDICT_ADD_STR_VALUE_STRDUP_FAILED:
+			return "FAILURE: Unable to allocate memory for the value in function pdict_add_str()";
+		case FAILURE_PDICT_ADD_STRN_NULL_INPUT_DICT:
+			return "FAILURE: NULL dict input passed to function pdict_add_strn()";
+		case FAILURE_PDICT_ADD_STRN_NULL_INPUT_KEY:
+			return "FAILURE: NULL key input passed to function pdict_add_strn()";
+		case FAILURE_PDICT_ADD_STRN_NULL_INPUT_VALUE:
+			return "FAILURE: NULL value input passed to function pdict_add_strn()";
+		case FAILURE_PDICT_ADD_STRN_KEY_EXISTS:
+			return "FAILURE: Key already exists in function pdict_add_strn()";
+		case FAILURE_PDICT_ADD_STRN_ENTRY_MALLOC_FAILED:
+			return "FAILURE: Unable to allocate memory to new_entry in function pdict_add_strn()";
+		case FAILURE_PDICT_ADD_STRN_KEY_STRDUP_FAILED:
+			return "FAILURE: Unable to allocate memory for the key in function pdict_add_strn()";
+		case FAILURE_PDICT_ADD_STRN_VALUE_STRDUP_FAILED:
+			return "FAILURE: Unable to allocate memory for the value in function pdict_add_strn()";
 		case FAILURE_PDICT_GET_STR_NULL_INPUT_DICT:
 			return "FAILURE: NULL dict input passed to function pdict_get_str(). *out_value set to NULL";
 		case FAILURE_PDICT_GET_STR_NULL_INPUT_KEY:
@@ -289,6 +643,26 @@ const char *perror_message(void)
 			return "FAILURE: strdup() failed to allocate memory to *out_value in function pdict_get_str(). *out_value set to NULL";
 		case FAILURE_PDICT_GET_STR_KEY_NOT_FOUND:
 			return "FAILURE: key not found in dict in function pdict_get_str(). *out_value set to NULL";
+		case FAILURE_PDICT_BORROW_STR_NULL_INPUT_DICT:
+			return "FAILURE: NULL dict input passed to function pdict_borrow_str()";
+		case FAILURE_PDICT_BORROW_STR_NULL_INPUT_KEY:
+			return "FAILURE: NULL key input passed to function pdict_borrow_str()";
+		case FAILURE_PDICT_BORROW_STR_NULL_INPUT_OUT_VALUE:
+			return "FAILURE: NULL out_value passed to function pdict_borrow_str()";
+		case FAILURE_PDICT_BORROW_STR_WRONG_TYPE:
+			return "FAILURE: Cannot borrow data: Element is not of the expected type (expected string) in function pdict_borrow_str(). *out_value set to NULL";
+		case FAILURE_PDICT_BORROW_STR_KEY_NOT_FOUND:
+			return "FAILURE: key not found in dict in function pdict_borrow_str(). *out_value set to NULL";
+		case FAILURE_PDICT_BORROW_STRN_NULL_INPUT_DICT:
+			return "FAILURE: NULL dict input passed to function pdict_borrow_strn()";
+		case FAILURE_PDICT_BORROW_STRN_NULL_INPUT_KEY:
+			return "FAILURE: NULL key input passed to function pdict_borrow_strn()";
+		case FAILURE_PDICT_BORROW_STRN_NULL_INPUT_OUT_VALUE:
+			return "FAILURE: NULL out_value or out_len passed to function pdict_borrow_strn()";
+		case FAILURE_PDICT_BORROW_STRN_WRONG_TYPE:
+			return "FAILURE: Cannot borrow data: Element is not of the expected type (expected string) in function pdict_borrow_strn(). *out_value set to NULL";
+		case FAILURE_PDICT_BORROW_STRN_KEY_NOT_FOUND:
+			return "FAILURE: key not found in dict in function pdict_borrow_strn(). *out_value set to NULL";
 		case FAILURE_PDICT_SET_STR_NULL_INPUT_DICT:
 			return "FAILURE: NULL dict input passed to function pdict_set_str()";
 		case FAILURE_PDICT_SET_STR_NULL_INPUT_KEY:
@@ -299,6 +673,16 @@ const char *perror_message(void)
 			return "FAILURE: strdup() failed to allocate memory to new_string in function pdict_set_str()";
 		case FAILURE_PDICT_SET_STR_VALUE_NOT_FOUND:
 			return "FAILURE: Key not found in function pdict_set_str()";
+		case FAILURE_PDICT_SET_STRN_NULL_INPUT_DICT:
+			return "FAILURE: NULL dict input passed to function pdict_set_strn()";
+		case FAILURE_PDICT_SET_STRN_NULL_INPUT_KEY:
+			return "FAILURE: NULL key input passed to function pdict_set_strn()";
+		case FAILURE_PDICT_SET_STRN_NULL_INPUT_VALUE:
+			return "FAILURE: NULL value input passed to function pdict_set_strn()";
+		case FAILURE_PDICT_SET_STRN_VALUE_STRDUP_FAILED:
+			return "FAILURE: Unable to allocate memory for the value in function pdict_set_strn()";
+		case FAILURE_PDICT_SET_STRN_VALUE_NOT_FOUND:
+			return "FAILURE: Key not found in function pdict_set_strn()";
 		
 		/* pdict_add_int pdict_get_int pdict_set_int Failures */
 		case FAILURE_PDICT_ADD_INT_NULL_INPUT_DICT:
@@ -427,6 +811,20 @@ const char *perror_message(void)
 			return "FAILURE: strdup() failed to allocate memory to new_entry->key in function pdict_add_list()";
 		case FAILURE_PDICT_ADD_LIST_VALUE_PLIST_COPY_FAILED:
 			return "FAILURE: plist_copy() failed to allocate memory to new_list in function pdict_add_list()";
+		case FAILURE_PDICT_ADD_LIST_TAKE_NULL_INPUT_DICT:
+			return "FAILURE: NULL dict input passed to function pdict_add_list_take()";
+		case FAILURE_PDICT_ADD_LIST_TAKE_NULL_INPUT_KEY:
+			return "FAILURE: NULL key input passed to function pdict_add_list_take()";
+		case FAILURE_PDICT_ADD_LIST_TAKE_NULL_INPUT_VALUE:
+			return "FAILURE: NULL value input passed to function pdict_add_list_take()";
+		case FAILURE_PDICT_ADD_LIST_TAKE_ALLOCATOR_MISMATCH:
+			return "FAILURE: The list was not created with the same allocator in function pdict_add_list_take()";
+		case FAILURE_PDICT_ADD_LIST_TAKE_KEY_EXISTS:
+			return "FAILURE: Key already exists in function pdict_add_list_take()";
+		case FAILURE_PDICT_ADD_LIST_TAKE_ENTRY_MALLOC_FAILED:
+			return "FAILURE: Unable to allocate memory to the new entry in function pdict_add_list_take()";
+		case FAILURE_PDICT_ADD_LIST_TAKE_KEY_STRDUP_FAILED:
+			return "FAILURE: Unable to allocate memory to the key in function pdict_add_list_take()";
 		case FAILURE_PDICT_GET_LIST_NULL_INPUT_DICT:
 			return "FAILURE: NULL dict input passed to function pdict_get_list(). *out_value set to NULL";
 		case FAILURE_PDICT_GET_LIST_NULL_INPUT_KEY:
@@ -439,6 +837,16 @@ const char *perror_message(void)
 			return "FAILURE: plist_copy() failed to allocate memory to *out_value in function pdict_get_list(). *out_value set to NULL";
 		case FAILURE_PDICT_GET_LIST_KEY_NOT_FOUND:
 			return "FAILURE: key not found in dict in function pdict_get_list(). *out_value set to NULL";
+		case FAILURE_PDICT_BORROW_LIST_NULL_INPUT_DICT:
+			return "FAILURE: NULL dict input passed to function pdict_borrow_list()";
+		case FAILURE_PDICT_BORROW_LIST_NULL_INPUT_KEY:
+			return "FAILURE: NULL key input passed to function pdict_borrow_list()";
+		case FAILURE_PDICT_BORROW_LIST_NULL_INPUT_OUT_VALUE:
+			return "FAILURE: NULL out_value passed to function pdict_borrow_list()";
+		case FAILURE_PDICT_BORROW_LIST_WRONG_TYPE:
+			return "FAILURE: Cannot borrow data: Element is not of the expected type (expected list) in function pdict_borrow_list(). *out_value set to NULL";
+		case FAILURE_PDICT_BORROW_LIST_KEY_NOT_FOUND:
+			return "FAILURE: key not found in dict in function pdict_borrow_list(). *out_value set to NULL";
 		case FAILURE_PDICT_SET_LIST_NULL_INPUT_DICT:
 			return "FAILURE: NULL dict input passed to function pdict_set_list()";
 		case FAILURE_PDICT_SET_LIST_NULL_INPUT_KEY:
@@ -449,6 +857,16 @@ const char *perror_message(void)
 			return "FAILURE: plist_copy() failed to allocate memory to new_list in function pdict_set_list()";
 		case FAILURE_PDICT_SET_LIST_VALUE_NOT_FOUND:
 			return "FAILURE: Key not found in function pdict_set_list()";
+		case FAILURE_PDICT_SET_LIST_TAKE_NULL_INPUT_DICT:
+			return "FAILURE: NULL dict input passed to function pdict_set_list_take()";
+		case FAILURE_PDICT_SET_LIST_TAKE_NULL_INPUT_KEY:
+			return "FAILURE: NULL key input passed to function pdict_set_list_take()";
+		case FAILURE_PDICT_SET_LIST_TAKE_NULL_INPUT_VALUE:
+			return "FAILURE: NULL value input passed to function pdict_set_list_take()";
+		case FAILURE_PDICT_SET_LIST_TAKE_ALLOCATOR_MISMATCH:
+			return "FAILURE: The list was not created with the same allocator in function pdict_set_list_take()";
+		case FAILURE_PDICT_SET_LIST_TAKE_VALUE_NOT_FOUND:
+			return "FAILURE: key not found in dict in function pdict_set_list_take()";
 		
 		/* pdict_add_dict pdict_get_dict Failures */
 		case FAILURE_PDICT_ADD_DICT_NULL_INPUT_DICT:
@@ -465,6 +883,22 @@ const char *perror_message(void)
 			return "FAILURE: strdup() failed to allocate memory to new_entry->key in function pdict_add_dict()";
 		case FAILURE_PDICT_ADD_DICT_VALUE_PDICT_COPY_FAILED:
 			return "FAILURE: pdict_copy() failed to allocate memory to new_dict in function pdict_add_dict()";
+		case FAILURE_PDICT_ADD_DICT_TAKE_NULL_INPUT_DICT:
+			return "FAILURE: NULL dict input passed to function pdict_add_dict_take()";
+		case FAILURE_PDICT_ADD_DICT_TAKE_NULL_INPUT_KEY:
+			return "FAILURE: NULL key input passed to function pdict_add_dict_take()";
+		case FAILURE_PDICT_ADD_DICT_TAKE_NULL_INPUT_VALUE:
+			return "FAILURE: NULL value input passed to function pdict_add_dict_take()";
+		case FAILURE_PDICT_ADD_DICT_TAKE_ALLOCATOR_MISMATCH:
+			return "FAILURE: The dict was not created with the same allocator in function pdict_add_dict_take()";
+		case FAILURE_PDICT_ADD_DICT_TAKE_KEY_EXISTS:
+			return "FAILURE: Key already exists in function pdict_add_dict_take()";
+		case FAILURE_PDICT_ADD_DICT_TAKE_ENTRY_MALLOC_FAILED:
+			return "FAILURE: Unable to allocate memory to the new entry in function pdict_add_dict_take()";
+		case FAILURE_PDICT_ADD_DICT_TAKE_KEY_STRDUP_FAILED:
+			return "FAILURE: Unable to allocate memory to the key in function pdict_add_dict_take()";
+		case FAILURE_PDICT_ADD_DICT_TAKE_SELF_INSERT:
+			return "FAILURE: A dict cannot be added to itself in function pdict_add_dict_take()";
 		case FAILURE_PDICT_GET_DICT_NULL_INPUT_DICT:
 			return "FAILURE: NULL dict input passed to function pdict_get_dict(). *out_value set to NULL";
 		case FAILURE_PDICT_GET_DICT_NULL_INPUT_KEY:
@@ -477,6 +911,16 @@ const char *perror_message(void)
 			return "FAILURE: pdict_copy() failed to allocate memory to *out_value in function pdict_get_dict(). *out_value set to NULL";
 		case FAILURE_PDICT_GET_DICT_KEY_NOT_FOUND:
 			return "FAILURE: key not found in dict in function pdict_get_dict(). *out_value set to NULL";
+		case FAILURE_PDICT_BORROW_DICT_NULL_INPUT_DICT:
+			return "FAILURE: NULL dict input passed to function pdict_borrow_dict()";
+		case FAILURE_PDICT_BORROW_DICT_NULL_INPUT_KEY:
+			return "FAILURE: NULL key input passed to function pdict_borrow_dict()";
+		case FAILURE_PDICT_BORROW_DICT_NULL_INPUT_OUT_VALUE:
+			return "FAILURE: NULL out_value passed to function pdict_borrow_dict()";
+		case FAILURE_PDICT_BORROW_DICT_WRONG_TYPE:
+			return "FAILURE: Cannot borrow data: Element is not of the expected type (expected dict) in function pdict_borrow_dict(). *out_value set to NULL";
+		case FAILURE_PDICT_BORROW_DICT_KEY_NOT_FOUND:
+			return "FAILURE: key not found in dict in function pdict_borrow_dict(). *out_value set to NULL";
 		case FAILURE_PDICT_SET_DICT_NULL_INPUT_DICT:
 			return "FAILURE: NULL dict input passed to function pdict_set_pdict()";
 		case FAILURE_PDICT_SET_DICT_NULL_INPUT_KEY:
@@ -487,6 +931,18 @@ const char *perror_message(void)
 			return "FAILURE: pdict_copy() failed to allocate memory to new_dict in function pdict_set_dict()";
 		case FAILURE_PDICT_SET_DICT_VALUE_NOT_FOUND:
 			return "FAILURE: Key not found in function pdict_set_dict()";
+		case FAILURE_PDICT_SET_DICT_TAKE_NULL_INPUT_DICT:
+			return "FAILURE: NULL dict input passed to function pdict_set_dict_take()";
+		case FAILURE_PDICT_SET_DICT_TAKE_NULL_INPUT_KEY:
+			return "FAILURE: NULL key input passed to function pdict_set_dict_take()";
+		case FAILURE_PDICT_SET_DICT_TAKE_NULL_INPUT_VALUE:
+			return "FAILURE: NULL value input passed to function pdict_set_dict_take()";
+		case FAILURE_PDICT_SET_DICT_TAKE_ALLOCATOR_MISMATCH:
+			return "FAILURE: The dict was not created with the same allocator in function pdict_set_dict_take()";
+		case FAILURE_PDICT_SET_DICT_TAKE_SELF_INSERT:
+			return "FAILURE: A dict cannot be stored in itself in function pdict_set_dict_take()";
+		case FAILURE_PDICT_SET_DICT_TAKE_VALUE_NOT_FOUND:
+			return "FAILURE: key not found in dict in function pdict_set_dict_take()";
 		
 		/* pdict_get_type Failures */
 		case FAILURE_PDICT_GET_TYPE_NULL_INPUT:
@@ -517,6 +973,188 @@ const char *perror_message(void)
 			return "FAILURE: plist_create() failed in function pdict_get_values()";
 		case FAILURE_PDICT_GET_VALUES_PLIST_ADD_PVAR_FAILED:
 			return "FAILURE: plist_add_pvar() failed in function pdict_get_values()";
+		
+		/* pvars_arena_t Failures */
+		case FAILURE_PVARS_ARENA_CREATE_CHUNK_SIZE_OUT_OF_BOUNDS:
+			return "FAILURE: chunk_size is too large in function pvars_arena_create()";
+		case FAILURE_PVARS_ARENA_CREATE_MALLOC_FAILED:
+			return "FAILURE: malloc() failed to allocate memory to the arena in function pvars_arena_create()";
+		case FAILURE_PVARS_ARENA_RESET_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pvars_arena_reset()";
+		case FAILURE_PVARS_ARENA_GET_USED_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pvars_arena_get_used()";
+		case FAILURE_PVARS_ARENA_GET_CHUNK_COUNT_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pvars_arena_get_chunk_count()";
+		
+		/* pvars_set_allocator Failures */
+		case FAILURE_PVARS_SET_ALLOCATOR_MISSING_HOOK:
+			return "FAILURE: Allocator with a NULL alloc, resize or release hook passed to function pvars_set_allocator()";
+		
+		/* pvars_get_intern_stats Failures */
+		case FAILURE_PVARS_GET_INTERN_STATS_NULL_INPUT_OUT_VALUE:
+			return "FAILURE: NULL out_stats passed to function pvars_get_intern_stats()";
+		
+		/* pvars_buffer_t pvars_serialize pvars_deserialize Failures */
+		case FAILURE_PVARS_BUFFER_INIT_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pvars_buffer_init()";
+		case FAILURE_PVARS_SERIALIZE_NULL_INPUT:
+			return "FAILURE: NULL value or uninitialised buffer passed to function pvars_serialize()";
+		case FAILURE_PVARS_SERIALIZE_UNKNOWN_TYPE:
+			return "FAILURE: Cannot encode variable: Variable type unknown! in function pvars_serialize()";
+		case FAILURE_PVARS_SERIALIZE_REALLOC_FAILED:
+			return "FAILURE: Unable to grow the output buffer in function pvars_serialize()";
+		case FAILURE_PVARS_DESERIALIZE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pvars_deserialize()";
+		case FAILURE_PVARS_DESERIALIZE_BAD_HEADER:
+			return "FAILURE: Input is not a document of a supported version in function pvars_deserialize()";
+		case FAILURE_PVARS_DESERIALIZE_TRUNCATED:
+			return "FAILURE: Input ends in the middle of a document in function pvars_deserialize()";
+		case FAILURE_PVARS_DESERIALIZE_MALFORMED:
+			return "FAILURE: Input holds an invalid tag, number or key in function pvars_deserialize()";
+		case FAILURE_PVARS_DESERIALIZE_TOO_DEEP:
+			return "FAILURE: Lists and dicts nested deeper than PVARS_SERIAL_MAX_DEPTH in function pvars_deserialize()";
+		case FAILURE_PVARS_DESERIALIZE_ALLOC_FAILED:
+			return "FAILURE: Unable to allocate the decoded value in function pvars_deserialize()";
+		case FAILURE_PVARS_IMAGE_WRITE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pvars_image_write()";
+		case FAILURE_PVARS_IMAGE_WRITE_UNKNOWN_TYPE:
+			return "FAILURE: Value of an unknown type in function pvars_image_write()";
+		case FAILURE_PVARS_IMAGE_WRITE_TOO_LARGE:
+			return "FAILURE: Dict with more entries than an image can index in function pvars_image_write()";
+		case FAILURE_PVARS_IMAGE_WRITE_REALLOC_FAILED:
+			return "FAILURE: Unable to grow the buffer in function pvars_image_write()";
+		case FAILURE_PVARS_IMAGE_OPEN_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pvars_image_open()";
+		case FAILURE_PVARS_IMAGE_OPEN_MISALIGNED:
+			return "FAILURE: Image not aligned to 8 bytes in function pvars_image_open()";
+		case FAILURE_PVARS_IMAGE_OPEN_BAD_HEADER:
+			return "FAILURE: Input is not an image of a supported version for this host in function pvars_image_open()";
+		case FAILURE_PVARS_IMAGE_OPEN_MALLOC_FAILED:
+			return "FAILURE: Unable to allocate the image handle in function pvars_image_open()";
+		case FAILURE_PVARS_IMAGE_MAP_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pvars_image_map()";
+		case FAILURE_PVARS_IMAGE_MAP_OPEN_FAILED:
+			return "FAILURE: Unable to open or stat the file in function pvars_image_map()";
+		case FAILURE_PVARS_IMAGE_MAP_MMAP_FAILED:
+			return "FAILURE: Unable to map the file in function pvars_image_map()";
+		case FAILURE_PVARS_IMAGE_MAP_BAD_HEADER:
+			return "FAILURE: File is not an image of a supported version for this host in function pvars_image_map()";
+		case FAILURE_PVARS_IMAGE_MAP_MALLOC_FAILED:
+			return "FAILURE: Unable to allocate the image handle in function pvars_image_map()";
+		case FAILURE_PVARS_IMAGE_ROOT_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pvars_image_root()";
+		case FAILURE_PVARS_IMAGE_CORRUPT:
+			return "FAILURE: Image holds a record or offset out of bounds";
+		case FAILURE_PVIEW_GET_TYPE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pview_get_type()";
+		case FAILURE_PVIEW_GET_SIZE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pview_get_size()";
+		case FAILURE_PVIEW_GET_SIZE_WRONG_TYPE:
+			return "FAILURE: View is not a list or dict in function pview_get_size()";
+		case FAILURE_PVIEW_GET_COLUMN_TYPE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pview_get_column_type()";
+		case FAILURE_PVIEW_GET_COLUMN_TYPE_WRONG_TYPE:
+			return "FAILURE: View is not a list in function pview_get_column_type()";
+		case FAILURE_PVIEW_LIST_GET_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pview_list_get()";
+		case FAILURE_PVIEW_LIST_GET_WRONG_TYPE:
+			return "FAILURE: View is not a list in function pview_list_get()";
+		case FAILURE_PVIEW_LIST_GET_OUT_OF_BOUNDS:
+			return "FAILURE: Index out of bounds in function pview_list_get()";
+		case FAILURE_PVIEW_DICT_GET_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pview_dict_get()";
+		case FAILURE_PVIEW_DICT_GET_WRONG_TYPE:
+			return "FAILURE: View is not a dict in function pview_dict_get()";
+		case FAILURE_PVIEW_DICT_GET_KEY_NOT_FOUND:
+			return "FAILURE: Key not found in function pview_dict_get()";
+		case FAILURE_PVIEW_DICT_ENTRY_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pview_dict_entry()";
+		case FAILURE_PVIEW_DICT_ENTRY_WRONG_TYPE:
+			return "FAILURE: View is not a dict in function pview_dict_entry()";
+		case FAILURE_PVIEW_DICT_ENTRY_OUT_OF_BOUNDS:
+			return "FAILURE: Index out of bounds in function pview_dict_entry()";
+		case FAILURE_PVIEW_GET_INT_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pview_get_int()";
+		case FAILURE_PVIEW_GET_INT_WRONG_TYPE:
+			return "FAILURE: View is not an int in function pview_get_int()";
+		case FAILURE_PVIEW_GET_LONG_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pview_get_long()";
+		case FAILURE_PVIEW_GET_LONG_WRONG_TYPE:
+			return "FAILURE: View is not a long in function pview_get_long()";
+		case FAILURE_PVIEW_GET_DOUBLE_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pview_get_double()";
+		case FAILURE_PVIEW_GET_DOUBLE_WRONG_TYPE:
+			return "FAILURE: View is not a double in function pview_get_double()";
+		case FAILURE_PVIEW_GET_FLOAT_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pview_get_float()";
+		case FAILURE_PVIEW_GET_FLOAT_WRONG_TYPE:
+			return "FAILURE: View is not a float in function pview_get_float()";
+		case FAILURE_PVIEW_BORROW_STR_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pview_borrow_str()";
+		case FAILURE_PVIEW_BORROW_STR_WRONG_TYPE:
+			return "FAILURE: View is not a string in function pview_borrow_str()";
+		case FAILURE_PVIEW_BORROW_STRN_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pview_borrow_strn()";
+		case FAILURE_PVIEW_BORROW_STRN_WRONG_TYPE:
+			return "FAILURE: View is not a string in function pview_borrow_strn()";
+		case FAILURE_PVIEW_BORROW_SPAN_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pview_borrow_span()";
+		case FAILURE_PVIEW_BORROW_SPAN_NOT_TYPED:
+			return "FAILURE: View is not a typed list in function pview_borrow_span()";
+		case FAILURE_PVARS_PARSE_JSON_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pvars_parse_json()";
+		case FAILURE_PVARS_PARSE_JSON_TOO_LARGE:
+			return "FAILURE: Input of 4 GiB or more in function pvars_parse_json()";
+		case FAILURE_PVARS_PARSE_JSON_SYNTAX:
+			return "FAILURE: Input is not a single JSON value in function pvars_parse_json()";
+		case FAILURE_PVARS_PARSE_JSON_BAD_STRING:
+			return "FAILURE: Unterminated string, bad escape, control character or NUL in a key in function pvars_parse_json()";
+		case FAILURE_PVARS_PARSE_JSON_BAD_NUMBER:
+			return "FAILURE: Malformed number or number out of the range of double in function pvars_parse_json()";
+		case FAILURE_PVARS_PARSE_JSON_DUPLICATE_KEY:
+			return "FAILURE: Object with a duplicate key in function pvars_parse_json()";
+		case FAILURE_PVARS_PARSE_JSON_TOO_DEEP:
+			return "FAILURE: Arrays and objects nested deeper than PVARS_JSON_MAX_DEPTH in function pvars_parse_json()";
+		case FAILURE_PVARS_PARSE_JSON_ALLOC_FAILED:
+			return "FAILURE: Unable to allocate the parsed value in function pvars_parse_json()";
+		
+		/* pvars_to_json pvars_to_json_fd Failures */
+		case FAILURE_PVARS_TO_JSON_NULL_INPUT:
+			return "FAILURE: NULL input or negative file descriptor passed to function pvars_to_json() or pvars_to_json_fd()";
+		case FAILURE_PVARS_TO_JSON_UNKNOWN_STYLE:
+			return "FAILURE: Unknown pvars_json_style passed to function pvars_to_json()";
+		case FAILURE_PVARS_TO_JSON_UNKNOWN_TYPE:
+			return "FAILURE: Value of an unknown type in function pvars_to_json()";
+		case FAILURE_PVARS_TO_JSON_NOT_FINITE:
+			return "FAILURE: NaN or infinity, which JSON cannot represent, in function pvars_to_json()";
+		case FAILURE_PVARS_TO_JSON_REALLOC_FAILED:
+			return "FAILURE: Unable to grow the output buffer in function pvars_to_json()";
+		case FAILURE_PVARS_TO_JSON_WRITE_FAILED:
+			return "FAILURE: write() failed in function pvars_to_json_fd()";
+		
+		/* pvars_stream_t Failures */
+		case FAILURE_PVARS_STREAM_CREATE_NULL_INPUT:
+			return "FAILURE: NULL callbacks passed to function pvars_stream_create()";
+		case FAILURE_PVARS_STREAM_CREATE_UNKNOWN_FORMAT:
+			return "FAILURE: Unknown pvars_stream_format passed to function pvars_stream_create()";
+		case FAILURE_PVARS_STREAM_CREATE_MALLOC_FAILED:
+			return "FAILURE: Unable to allocate the stream in function pvars_stream_create()";
+		case FAILURE_PVARS_STREAM_FEED_NULL_INPUT:
+			return "FAILURE: NULL stream or data passed to function pvars_stream_feed()";
+		case FAILURE_PVARS_STREAM_FINISH_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pvars_stream_finish()";
+		case FAILURE_PVARS_STREAM_GET_OFFSET_NULL_INPUT:
+			return "FAILURE: NULL input passed to function pvars_stream_get_offset()";
+		case FAILURE_PVARS_STREAM_STOPPED:
+			return "FAILURE: A callback stopped the stream in function pvars_stream_feed()";
+		case FAILURE_PVARS_STREAM_ALLOC_FAILED:
+			return "FAILURE: Unable to allocate a token or a selected subtree in function pvars_stream_feed()";
+		
+		/* Copy-on-write Failures */
+		case FAILURE_PLIST_UNSHARE_COPY_FAILED:
+			return "FAILURE: Unable to copy the shared contents of a list before modifying it";
+		case FAILURE_PDICT_UNSHARE_COPY_FAILED:
+			return "FAILURE: Unable to copy the shared contents of a dict before modifying it";
 
 		default:
 			return "Unknown error number";
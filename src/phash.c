@@ -0,0 +1,208 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<stdatomic.h>
+#include<stdio.h>
+#include<string.h>
+#include<time.h>
+
+#include"phash_internal.h"
+
+/* Default secret of wyhash (final version 4) */
+#define PHASH_WY_P0 0xa0761d6478bd642fULL
+#define PHASH_WY_P1 0xe7037ed1a0b428dbULL
+#define PHASH_WY_P2 0x8ebc6af09c88c6e3ULL
+#define PHASH_WY_P3 0x589965cc75374cc3ULL
+
+/**
+ * @brief Multiplies a and b into a 128-bit product, returning the low half
+ * in a and the high half in b.
+ */
+static void phash_mum(uint64_t *a, uint64_t *b)
+{
+#if defined(__SIZEOF_INT128__)
+	__uint128_t product = (__uint128_t)*a * *b;
+	*a = (uint64_t)product;
+	*b = (uint64_t)(product >> 64);
+#else
+	uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	uint64_t t = rl + (rm0 << 32);
+	uint64_t carry = t < rl;
+	uint64_t lo = t + (rm1 << 32);
+	carry += lo < t;
+	*a = lo;
+	*b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+}
+
+/**
+ * @brief Folds the 128-bit product of a and b into 64 bits.
+ */
+static uint64_t phash_mix(uint64_t a, uint64_t b)
+{
+	phash_mum(&a, &b);
+	return a ^ b;
+}
+
+/* Unaligned native byte order reads. Byte order changes the hash values, not their quality */
+static uint64_t phash_read8(const unsigned char *p)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static uint64_t phash_read4(const unsigned char *p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+/**
+ * @brief Hashes a byte string eight bytes at a time.
+ *
+ * This is wyhash (final version 4, public domain): each 16 byte block costs
+ * a single 64x64->128 bit multiply, and keys of up to 16 bytes are read with
+ * at most four overlapping loads and no loop.
+ *
+ * @param data The bytes to hash.
+ * @param len Number of bytes.
+ * @param seed Per-table seed.
+ * @return The 64-bit hash.
+ */
+uint64_t phash_wyhash(const void *data, size_t len, uint64_t seed)
+{
+	const unsigned char *p = data;
+	uint64_t a, b;
+
+	seed ^= phash_mix(seed ^ PHASH_WY_P0, PHASH_WY_P1);
+
+	if (len <= 16) {
+		if (len >= 4) {
+			/* Two possibly overlapping 4 byte reads from each end */
+			size_t shift = (len >> 3) << 2;
+			a = (phash_read4(p) << 32) | phash_read4(p + shift);
+			b = (phash_read4(p + len - 4) << 32) | phash_read4(p + len - 4 - shift);
+		} else if (len > 0) {
+			a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+			b = 0;
+		} else {
+			a = b = 0;
+		}
+	} else {
+		size_t i = len;
+
+		if (i > 48) {
+			uint64_t see1 = seed, see2 = seed;
+
+			do {
+				seed = phash_mix(phash_read8(p) ^ PHASH_WY_P1, phash_read8(p + 8) ^ seed);
+				see1 = phash_mix(phash_read8(p + 16) ^ PHASH_WY_P2, phash_read8(p + 24) ^ see1);
+				see2 = phash_mix(phash_read8(p + 32) ^ PHASH_WY_P3, phash_read8(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+
+			seed ^= see1 ^ see2;
+		}
+
+		while (i > 16) {
+			seed = phash_mix(phash_read8(p) ^ PHASH_WY_P1, phash_read8(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+
+		a = phash_read8(p + i - 16);
+		b = phash_read8(p + i - 8);
+	}
+
+	a ^= PHASH_WY_P1;
+	b ^= seed;
+	phash_mum(&a, &b);
+
+	return phash_mix(a ^ PHASH_WY_P0 ^ (uint64_t)len, b ^ PHASH_WY_P1);
+}
+
+/**
+ * @brief Hashes a byte string one byte at a time with DJB2.
+ *
+ * Kept for comparison and for callers that depend on its distribution. An
+ * fmix64 finaliser spreads the result over all 64 bits.
+ *
+ * @param data The bytes to hash.
+ * @param len Number of bytes.
+ * @param seed Per-table seed.
+ * @return The 64-bit hash.
+ */
+uint64_t phash_djb2(const void *data, size_t len, uint64_t seed)
+{
+	const unsigned char *p = data;
+	uint64_t hash = 5381 ^ seed;
+
+	// Standard DJB2 loop
+	for (size_t i = 0; i < len; i++) {
+		// hash * 33 + c
+		hash = ((hash << 5) + hash) + p[i];
+	}
+
+	/* MurmurHash3 fmix64 finaliser */
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	hash *= 0xc4ceb9fe1a85ec53ULL;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+/* Weyl sequence feeding phash_random_seed(), 0 until first use */
+static _Atomic uint64_t phash_seed_state = 0;
+
+/**
+ * @brief Gathers 64 bits of start-up entropy, preferring the OS generator.
+ */
+static uint64_t phash_entropy(void)
+{
+	uint64_t entropy = 0;
+	FILE *urandom = fopen("/dev/urandom", "rb");
+
+	if (urandom != NULL) {
+		if (fread(&entropy, sizeof(entropy), 1, urandom) != 1) {
+			entropy = 0;
+		}
+		fclose(urandom);
+	}
+
+	if (entropy == 0) {
+		/* Fallback: clock and address space layout */
+		struct timespec ts;
+		clock_gettime(CLOCK_REALTIME, &ts);
+		entropy = phash_mix((uint64_t)ts.tv_sec ^ PHASH_WY_P2, (uint64_t)ts.tv_nsec ^ (uint64_t)(uintptr_t)&ts);
+	}
+
+	return entropy;
+}
+
+/**
+ * @brief Returns a fresh seed for a hash table.
+ *
+ * The OS generator is read once per process; every call after that steps a
+ * shared counter and scrambles it (splitmix64), so seeds are unpredictable
+ * across processes and distinct between tables. Safe to call from any thread.
+ *
+ * @return A 64-bit seed.
+ */
+uint64_t phash_random_seed(void)
+{
+	if (atomic_load(&phash_seed_state) == 0) {
+		uint64_t expected = 0;
+		atomic_compare_exchange_strong(&phash_seed_state, &expected, phash_entropy() | 1);
+	}
+
+	uint64_t z = atomic_fetch_add(&phash_seed_state, 0x9e3779b97f4a7c15ULL);
+
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
@@ -0,0 +1,1294 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<limits.h>
+#include<stdint.h>
+#include<string.h>
+
+#if defined(_WIN32)
+#include<windows.h>
+#else
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<unistd.h>
+#endif
+
+#include"pvars.h"
+#include"perrno.h"
+#include"pvars_internal.h"
+#include"plist_internal.h"
+#include"pdict_internal.h"
+#include"phash_internal.h"
+#include"pmem_internal.h"
+#include"pstr_internal.h"
+#include"pserial_internal.h"
+
+/*
+ * Read-only images: pvars_image_write(), pvars_image_open()/map() and the
+ * pview_* accessors.
+ *
+ * An image is a tree of records that refer to each other by offset from
+ * the start of the image, so it can be used wherever it is loaded or
+ * mapped. Every record starts on an 8 byte boundary and numbers are stored
+ * in host order, so they are read in place:
+ *
+ *   header  magic, version, sizeof(long), byte order, image size, hash
+ *           seed, then the slot of the root value
+ *   slot    16 bytes: the bits of a number, or the offset of a string, list
+ *           or dict record, and a pvar_type
+ *   string  64-bit length, the bytes (which may include NULs), a NUL
+ *   list    64-bit count, column type, then count slots, or for a typed
+ *           list the packed array of numbers as plist_borrow_span() gives it
+ *   dict    64-bit count, 64-bit table mask, count entries in the dict's
+ *           table order, then a table of mask + 1 32-bit entry numbers
+ *           (entry index + 1, 0 for an empty slot) probed linearly
+ *   entry   the key's hash, the offset of the key string, the value's slot
+ *
+ * Keys are hashed with phash_wyhash() and the seed from the header, so the
+ * tables are built once by the writer. Equal keys of different dicts share
+ * one string record.
+ *
+ * The writer puts every list and dict record after the record that refers
+ * to it, and readers require it, so offsets only ever lead forward and
+ * a walk over any image ends.
+ *
+ * Opening an image only checks its header: records are bounds checked as
+ * they are reached, so a corrupt image is reported with
+ * FAILURE_PVARS_IMAGE_CORRUPT and never read past, and opening costs the
+ * same whatever the size of the image.
+ */
+
+#define PIMAGE_MAGIC "PVIM"
+#define PIMAGE_ALIGN 8
+#define PIMAGE_HASH_SEED 0x9e3779b97f4a7c15ull /* Seed of the key hashes written by this version */
+#define PIMAGE_MIN_TABLE 4
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define PIMAGE_BYTE_ORDER 2
+#else
+#define PIMAGE_BYTE_ORDER 1
+#endif
+
+typedef struct {
+	uint64_t data; // Bits of a number, or offset of a string, list or dict record
+	uint8_t type;  // A pvar_type
+	uint8_t pad[7];
+} pimage_slot_t;
+
+typedef struct {
+	char magic[4];
+	uint8_t version;
+	uint8_t long_size;  // sizeof(long) of the writer, the width of typed longs
+	uint8_t byte_order; // PIMAGE_BYTE_ORDER of the writer
+	uint8_t pad;
+	uint64_t size;      // Bytes in the image, this header included
+	uint64_t seed;      // Seed of the key hashes
+	pimage_slot_t root;
+} pimage_header_t;
+
+typedef struct {
+	uint64_t len;   // Bytes, excluding the NUL that follows them
+	char data[];
+} pimage_str_t;
+
+typedef struct {
+	uint64_t count;
+	uint8_t column; // A pvar_type, PVAR_TYPE_NONE for a list of slots
+	uint8_t pad[7];
+} pimage_list_t;
+
+typedef struct {
+	uint64_t count;
+	uint64_t mask;  // Table slots - 1, the number of slots being a power of two
+} pimage_dict_t;
+
+typedef struct {
+	uint64_t hash;  // phash_wyhash() of the key
+	uint64_t key;   // Offset of the key's string record
+	pimage_slot_t value;
+} pimage_entry_t;
+
+struct pvars_image_t {
+	const unsigned char *base; // First byte of the image
+	size_t size;               // Bytes in the image
+	uint64_t seed;             // Seed of the key hashes
+	size_t mapped;             // Bytes to unmap on close, 0 if the caller owns the memory
+	const pvars_allocator_t *allocator; // Allocator of this handle
+};
+
+/* --- Writing --- */
+
+/**
+ * @brief State of pvars_image_write().
+ */
+typedef struct {
+	pvars_buffer_t *buffer;
+	pdict_t *keys; // Offset of the string record of every key written so far
+} pimage_writer_t;
+
+/**
+ * @brief Appends a zeroed record, aligned to PIMAGE_ALIGN.
+ *
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+static bool pimage_alloc(pimage_writer_t *writer, size_t bytes, uint64_t *out_offset)
+{
+	pvars_buffer_t *buffer = writer->buffer;
+	size_t pad = (PIMAGE_ALIGN - buffer->size % PIMAGE_ALIGN) % PIMAGE_ALIGN;
+
+	if (bytes > SIZE_MAX - pad || !pvars_buffer_reserve(buffer, pad + bytes, FAILURE_PVARS_IMAGE_WRITE_REALLOC_FAILED)) {
+		pvars_errno = FAILURE_PVARS_IMAGE_WRITE_REALLOC_FAILED;
+		return false;
+	}
+
+	memset(buffer->data + buffer->size, 0, pad + bytes);
+	*out_offset = buffer->size + pad;
+	buffer->size += pad + bytes;
+	return true;
+}
+
+/**
+ * @brief Returns a record being written. Only valid until the next
+ * pimage_alloc(), which may move the buffer.
+ */
+static void *pimage_record(pimage_writer_t *writer, uint64_t offset)
+{
+	return writer->buffer->data + offset;
+}
+
+static bool pimage_write_str(pimage_writer_t *writer, const char *bytes, size_t len, uint64_t *out_offset)
+{
+	if (len > SIZE_MAX - sizeof(pimage_str_t) - 1) {
+		pvars_errno = FAILURE_PVARS_IMAGE_WRITE_REALLOC_FAILED;
+		return false;
+	}
+	if (!pimage_alloc(writer, sizeof(pimage_str_t) + len + 1, out_offset)) {
+		return false;
+	}
+
+	pimage_str_t *str = pimage_record(writer, *out_offset);
+	str->len = len;
+	memcpy(str->data, bytes, len);
+	return true;
+}
+
+/**
+ * @brief Writes a dict key once per image, reusing its record afterwards.
+ */
+static bool pimage_write_key(pimage_writer_t *writer, const char *key, uint64_t *out_offset)
+{
+	long offset;
+
+	if (pdict_get_long(writer->keys, key, &offset)) {
+		*out_offset = (uint64_t)offset;
+		return true;
+	}
+
+	if (!pimage_write_str(writer, key, pstr_len(key), out_offset)) {
+		return false;
+	}
+
+	/* Failing to remember the key only costs a duplicate record later */
+	pdict_add_long(writer->keys, key, (long)*out_offset);
+	return true;
+}
+
+static bool pimage_write_value(pimage_writer_t *writer, const pvar_t *value, uint64_t slot_offset);
+
+/**
+ * @brief Writes a list record and everything it holds.
+ */
+static bool pimage_write_list(pimage_writer_t *writer, const plist_t *list, uint64_t *out_offset)
+{
+	size_t width = list->column != PVAR_TYPE_NONE ? list->width : sizeof(pimage_slot_t);
+
+	if (list->count > (SIZE_MAX - sizeof(pimage_list_t)) / width) {
+		pvars_errno = FAILURE_PVARS_IMAGE_WRITE_REALLOC_FAILED;
+		return false;
+	}
+	if (!pimage_alloc(writer, sizeof(pimage_list_t) + list->count * width, out_offset)) {
+		return false;
+	}
+
+	pimage_list_t *record = pimage_record(writer, *out_offset);
+	record->count = list->count;
+	record->column = (uint8_t)list->column;
+
+	if (list->column != PVAR_TYPE_NONE) {
+		if (list->count > 0) {
+			memcpy(record + 1, list->values, list->count * width);
+		}
+		return true;
+	}
+
+	uint64_t slots = *out_offset + sizeof(pimage_list_t);
+	for (size_t i = 0; i < list->count; i++) {
+		if (!pimage_write_value(writer, &list->elements[i], slots + i * sizeof(pimage_slot_t))) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Writes a dict record, its hash table and everything it holds.
+ */
+static bool pimage_write_dict(pimage_writer_t *writer, const pdict_t *dict, uint64_t *out_offset)
+{
+	if (dict->count >= UINT32_MAX / 2) {
+		pvars_errno = FAILURE_PVARS_IMAGE_WRITE_TOO_LARGE;
+		return false;
+	}
+
+	/* Keeps the load factor at or below 1/2 */
+	size_t slots = PIMAGE_MIN_TABLE;
+	while (slots < dict->count * 2) {
+		slots *= 2;
+	}
+
+	size_t entries_size = dict->count * sizeof(pimage_entry_t);
+	if (!pimage_alloc(writer, sizeof(pimage_dict_t) + entries_size + slots * sizeof(uint32_t), out_offset)) {
+		return false;
+	}
+
+	pimage_dict_t *record = pimage_record(writer, *out_offset);
+	record->count = dict->count;
+	record->mask = slots - 1;
+
+	uint64_t entries = *out_offset + sizeof(pimage_dict_t);
+	uint64_t table = entries + entries_size;
+
+	pdict_iter_t iter;
+	const char *key;
+	pvar_t *value;
+	size_t i = 0;
+
+	pdict_iter_init(&iter, dict);
+	while (pdict_iter_next(&iter, &key, &value)) {
+		uint64_t key_offset;
+		if (!pimage_write_key(writer, key, &key_offset)) {
+			return false;
+		}
+
+		uint64_t hash = phash_wyhash(key, pstr_len(key), PIMAGE_HASH_SEED);
+		uint64_t entry_offset = entries + i * sizeof(pimage_entry_t);
+		pimage_entry_t *entry = pimage_record(writer, entry_offset);
+		entry->hash = hash;
+		entry->key = key_offset;
+
+		uint32_t *numbers = pimage_record(writer, table);
+		size_t slot = (size_t)hash & (slots - 1);
+		while (numbers[slot] != 0) {
+			slot = (slot + 1) & (slots - 1);
+		}
+		numbers[slot] = (uint32_t)(i + 1);
+
+		if (!pimage_write_value(writer, value, entry_offset + offsetof(pimage_entry_t, value))) {
+			return false;
+		}
+		i++;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Fills in a slot, writing the records the value refers to.
+ *
+ * @param writer The writer.
+ * @param value The value, as stored in a list or dict.
+ * @param slot_offset Offset of the slot, already allocated.
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+static bool pimage_write_value(pimage_writer_t *writer, const pvar_t *value, uint64_t slot_offset)
+{
+	uint64_t data = 0;
+	uint32_t narrow;
+
+	switch (value->type) {
+		case PVAR_TYPE_NONE:
+			break;
+		case PVAR_TYPE_STRING:
+			if (!pimage_write_str(writer, pvar_str(value), pvar_str_len(value), &data)) {
+				return false;
+			}
+			break;
+		case PVAR_TYPE_INT:
+			data = (uint64_t)(int64_t)value->data.i;
+			break;
+		case PVAR_TYPE_LONG:
+			data = (uint64_t)(int64_t)value->data.l;
+			break;
+		case PVAR_TYPE_DOUBLE:
+			memcpy(&data, &value->data.d, sizeof(double));
+			break;
+		case PVAR_TYPE_FLOAT:
+			memcpy(&narrow, &value->data.f, sizeof(float));
+			data = narrow;
+			break;
+		case PVAR_TYPE_LIST:
+			if (!pimage_write_list(writer, value->data.ls, &data)) {
+				return false;
+			}
+			break;
+		case PVAR_TYPE_DICT:
+			if (!pimage_write_dict(writer, value->data.dt, &data)) {
+				return false;
+			}
+			break;
+		default:
+			pvars_errno = FAILURE_PVARS_IMAGE_WRITE_UNKNOWN_TYPE;
+			return false;
+	}
+
+	pimage_slot_t *slot = pimage_record(writer, slot_offset);
+	slot->data = data;
+	slot->type = value->type;
+	return true;
+}
+
+/* --- Reading --- */
+
+/**
+ * @brief Returns the record at an offset, or NULL if it is misaligned or
+ * does not fit in the image.
+ */
+static const void *pimage_at(const pvars_image_t *image, uint64_t offset, uint64_t bytes)
+{
+	if (offset % PIMAGE_ALIGN != 0 || offset > image->size || bytes > image->size - offset) {
+		return NULL;
+	}
+	return image->base + offset;
+}
+
+/**
+ * @brief Finds a string record.
+ *
+ * @return True on success, false if the image is corrupt (with pvars_errno set).
+ */
+static bool pimage_str(const pvars_image_t *image, uint64_t offset, const char **out_bytes, size_t *out_len)
+{
+	const pimage_str_t *str = pimage_at(image, offset, sizeof(pimage_str_t));
+
+	if (str == NULL || str->len >= image->size - offset - sizeof(pimage_str_t) || str->data[str->len] != '\0') {
+		pvars_errno = FAILURE_PVARS_IMAGE_CORRUPT;
+		return false;
+	}
+
+	*out_bytes = str->data;
+	*out_len = (size_t)str->len;
+	return true;
+}
+
+/**
+ * @brief Width of the elements of a list record, 0 for an unknown column.
+ */
+static size_t pimage_width(uint8_t column)
+{
+	switch (column) {
+		case PVAR_TYPE_NONE:
+			return sizeof(pimage_slot_t);
+		case PVAR_TYPE_INT:
+			return sizeof(int);
+		case PVAR_TYPE_LONG:
+			return sizeof(long);
+		case PVAR_TYPE_DOUBLE:
+			return sizeof(double);
+		case PVAR_TYPE_FLOAT:
+			return sizeof(float);
+		default:
+			return 0;
+	}
+}
+
+/**
+ * @brief Finds a list record and checks that its elements fit in the image.
+ *
+ * @return The record, or NULL if the image is corrupt (with pvars_errno set).
+ */
+static const pimage_list_t *pimage_list(const pvars_image_t *image, uint64_t offset)
+{
+	const pimage_list_t *list = pimage_at(image, offset, sizeof(pimage_list_t));
+	size_t width = list != NULL ? pimage_width(list->column) : 0;
+
+	if (width == 0 || list->count > (image->size - offset - sizeof(pimage_list_t)) / width) {
+		pvars_errno = FAILURE_PVARS_IMAGE_CORRUPT;
+		return NULL;
+	}
+
+	return list;
+}
+
+/**
+ * @brief Finds a dict record and checks that its entries and table fit in
+ * the image.
+ *
+ * @return The record, or NULL if the image is corrupt (with pvars_errno set).
+ */
+static const pimage_dict_t *pimage_dict(const pvars_image_t *image, uint64_t offset)
+{
+	const pimage_dict_t *dict = pimage_at(image, offset, sizeof(pimage_dict_t));
+
+	if (dict == NULL || dict->mask >= UINT32_MAX || (dict->mask & (dict->mask + 1)) != 0 || dict->count > dict->mask) {
+		pvars_errno = FAILURE_PVARS_IMAGE_CORRUPT;
+		return NULL;
+	}
+
+	uint64_t room = image->size - offset - sizeof(pimage_dict_t);
+	uint64_t table = (dict->mask + 1) * sizeof(uint32_t);
+	if (table > room || dict->count > (room - table) / sizeof(pimage_entry_t)) {
+		pvars_errno = FAILURE_PVARS_IMAGE_CORRUPT;
+		return NULL;
+	}
+
+	return dict;
+}
+
+static const pimage_entry_t *pimage_entries(const pimage_dict_t *dict)
+{
+	return (const pimage_entry_t *)(const void *)(dict + 1);
+}
+
+static const uint32_t *pimage_table(const pimage_dict_t *dict)
+{
+	return (const uint32_t *)(const void *)(pimage_entries(dict) + dict->count);
+}
+
+static uint64_t pimage_dict_end(uint64_t offset, const pimage_dict_t *dict)
+{
+	return offset + sizeof(pimage_dict_t) + dict->count * sizeof(pimage_entry_t) + (dict->mask + 1) * sizeof(uint32_t);
+}
+
+/**
+ * @brief Makes a view of a slot of the record that ends at offset end.
+ *
+ * @return True on success, false if the slot refers to a list or dict
+ * before end, as a corrupt image may to make a walk loop (with pvars_errno
+ * set).
+ */
+static bool pimage_view(const pvars_image_t *image, const pimage_slot_t *slot, uint64_t end, pview_t *out_view)
+{
+	if ((slot->type == PVAR_TYPE_LIST || slot->type == PVAR_TYPE_DICT) && slot->data < end) {
+		pvars_errno = FAILURE_PVARS_IMAGE_CORRUPT;
+		return false;
+	}
+
+	out_view->image = image;
+	out_view->data = slot->data;
+	out_view->type = (pvar_type)slot->type;
+	return true;
+}
+
+/**
+ * @brief Checks the header of an image against this host.
+ */
+static bool pimage_check_header(const void *data, size_t size)
+{
+	const pimage_header_t *header = data;
+
+	return size >= sizeof(pimage_header_t)
+		&& memcmp(header->magic, PIMAGE_MAGIC, sizeof(header->magic)) == 0
+		&& header->version >= 1 && header->version <= PVARS_IMAGE_VERSION
+		&& header->long_size == sizeof(long)
+		&& header->byte_order == PIMAGE_BYTE_ORDER
+		&& header->size == size;
+}
+
+/**
+ * @brief Makes the handle of an image whose header has been checked.
+ */
+static pvars_image_t *pimage_create(const void *data, size_t size, size_t mapped)
+{
+	const pvars_allocator_t *allocator = pmem_default();
+	pvars_image_t *image = pmem_malloc(allocator, sizeof(pvars_image_t));
+	if (image == NULL) {
+		return NULL;
+	}
+
+	image->base = data;
+	image->size = size;
+	image->seed = ((const pimage_header_t *)data)->seed;
+	image->mapped = mapped;
+	image->allocator = allocator;
+	return image;
+}
+
+/**
+ * @brief Writes the image of a value to a buffer, replacing its contents.
+ *
+ * The image holds the value and everything nested in it, typed lists as
+ * packed arrays and dicts with their hash tables already built, so it can
+ * be saved to a file and later opened with pvars_image_map() and queried
+ * without decoding. Images are read by hosts with the same byte order and
+ * sizeof(long) as the writer.
+ *
+ * @param value The value to write: a plist_t or pdict_t wrapped in a pvar_t
+ * (.type PVAR_TYPE_LIST with .data.ls, or PVAR_TYPE_DICT with .data.dt), or
+ * any other value.
+ * @param buffer An initialised buffer. It is left empty on failure.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pvars_image_write(const pvar_t *value, pvars_buffer_t *buffer)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (value == NULL || buffer == NULL || buffer->allocator == NULL) {
+		pvars_errno = FAILURE_PVARS_IMAGE_WRITE_NULL_INPUT;
+		return false;
+	}
+
+	pimage_writer_t writer = { buffer, pdict_create(64) };
+	if (writer.keys == NULL) {
+		pvars_errno = FAILURE_PVARS_IMAGE_WRITE_REALLOC_FAILED;
+		return false;
+	}
+
+	/* A caller's value keeps its string in data.s */
+	pvar_t root = *value;
+	root.str_tag = PVAR_STR_PLAIN;
+
+	uint64_t offset;
+	buffer->size = 0;
+	bool done = pimage_alloc(&writer, sizeof(pimage_header_t), &offset)
+		&& pimage_write_value(&writer, &root, offsetof(pimage_header_t, root))
+		&& pimage_alloc(&writer, 0, &offset); /* Pads the image to a whole number of words */
+
+	int error = pvars_errno;
+	pdict_destroy(writer.keys);
+
+	if (!done) {
+		buffer->size = 0;
+		pvars_errno = error;
+		return false;
+	}
+
+	pimage_header_t *header = pimage_record(&writer, 0);
+	memcpy(header->magic, PIMAGE_MAGIC, sizeof(header->magic));
+	header->version = PVARS_IMAGE_VERSION;
+	header->long_size = sizeof(long);
+	header->byte_order = PIMAGE_BYTE_ORDER;
+	header->size = buffer->size;
+	header->seed = PIMAGE_HASH_SEED;
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Opens an image held in memory, without copying or decoding it.
+ *
+ * Only the header is read; the rest of the image is read, and bounds
+ * checked, by the pview_* accessors as they reach it.
+ *
+ * @param data The image, aligned to 8 bytes (as malloc() and mmap() return
+ * memory). It must stay valid and unchanged until pvars_image_close().
+ * @param size Size of the image, as written by pvars_image_write().
+ * @return The image, or NULL on failure (with pvars_errno set).
+ */
+pvars_image_t *pvars_image_open(const void *data, size_t size)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (data == NULL) {
+		pvars_errno = FAILURE_PVARS_IMAGE_OPEN_NULL_INPUT;
+		return NULL;
+	}
+
+	if ((uintptr_t)data % PIMAGE_ALIGN != 0) {
+		pvars_errno = FAILURE_PVARS_IMAGE_OPEN_MISALIGNED;
+		return NULL;
+	}
+
+	if (!pimage_check_header(data, size)) {
+		pvars_errno = FAILURE_PVARS_IMAGE_OPEN_BAD_HEADER;
+		return NULL;
+	}
+
+	pvars_image_t *image = pimage_create(data, size, 0);
+	if (image == NULL) {
+		pvars_errno = FAILURE_PVARS_IMAGE_OPEN_MALLOC_FAILED;
+		return NULL;
+	}
+
+	pvars_errno = SUCCESS;
+	return image;
+}
+
+#if defined(_WIN32)
+
+/**
+ * @brief Maps a whole file into memory, read only.
+ *
+ * @return SUCCESS, or the FAILURE_PVARS_IMAGE_MAP_* error to report.
+ */
+static perrno_t pimage_map_file(const char *path, void **out_data, size_t *out_size)
+{
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		return FAILURE_PVARS_IMAGE_MAP_OPEN_FAILED;
+	}
+
+	LARGE_INTEGER info;
+	if (!GetFileSizeEx(file, &info) || info.QuadPart < 0 || (uintmax_t)info.QuadPart > SIZE_MAX) {
+		CloseHandle(file);
+		return FAILURE_PVARS_IMAGE_MAP_OPEN_FAILED;
+	}
+
+	size_t size = (size_t)info.QuadPart;
+	if (size < sizeof(pimage_header_t)) {
+		CloseHandle(file);
+		return FAILURE_PVARS_IMAGE_MAP_BAD_HEADER;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (mapping == NULL) {
+		return FAILURE_PVARS_IMAGE_MAP_MMAP_FAILED;
+	}
+
+	/* The view keeps the mapping alive once its handle is closed */
+	void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+	CloseHandle(mapping);
+	if (data == NULL) {
+		return FAILURE_PVARS_IMAGE_MAP_MMAP_FAILED;
+	}
+
+	*out_data = data;
+	*out_size = size;
+	return SUCCESS;
+}
+
+static void pimage_unmap_file(const void *data, size_t size)
+{
+	(void)size;
+	UnmapViewOfFile(data);
+}
+
+#else
+
+/**
+ * @brief Maps a whole file into memory, read only.
+ *
+ * @return SUCCESS, or the FAILURE_PVARS_IMAGE_MAP_* error to report.
+ */
+static perrno_t pimage_map_file(const char *path, void **out_data, size_t *out_size)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return FAILURE_PVARS_IMAGE_MAP_OPEN_FAILED;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size < 0 || (uintmax_t)info.st_size > SIZE_MAX) {
+		close(fd);
+		return FAILURE_PVARS_IMAGE_MAP_OPEN_FAILED;
+	}
+
+	size_t size = (size_t)info.st_size;
+	if (size < sizeof(pimage_header_t)) {
+		close(fd);
+		return FAILURE_PVARS_IMAGE_MAP_BAD_HEADER;
+	}
+
+	void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		return FAILURE_PVARS_IMAGE_MAP_MMAP_FAILED;
+	}
+
+	*out_data = data;
+	*out_size = size;
+	return SUCCESS;
+}
+
+static void pimage_unmap_file(const void *data, size_t size)
+{
+	munmap((void *)data, size);
+}
+
+#endif
+
+/**
+ * @brief Maps an image file into memory, read only, and opens it.
+ *
+ * Pages are read from the file as the image is queried, so opening takes
+ * the same time whatever the size of the file, and processes mapping the
+ * same file share its pages.
+ *
+ * @param path Path of a file holding exactly one image.
+ * @return The image, to be closed with pvars_image_close(), or NULL on
+ * failure (with pvars_errno set).
+ */
+pvars_image_t *pvars_image_map(const char *path)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (path == NULL) {
+		pvars_errno = FAILURE_PVARS_IMAGE_MAP_NULL_INPUT;
+		return NULL;
+	}
+
+	void *data;
+	size_t size;
+	perrno_t failure = pimage_map_file(path, &data, &size);
+	if (failure != SUCCESS) {
+		pvars_errno = failure;
+		return NULL;
+	}
+
+	if (!pimage_check_header(data, size)) {
+		pimage_unmap_file(data, size);
+		pvars_errno = FAILURE_PVARS_IMAGE_MAP_BAD_HEADER;
+		return NULL;
+	}
+
+	pvars_image_t *image = pimage_create(data, size, size);
+	if (image == NULL) {
+		pimage_unmap_file(data, size);
+		pvars_errno = FAILURE_PVARS_IMAGE_MAP_MALLOC_FAILED;
+		return NULL;
+	}
+
+	pvars_errno = SUCCESS;
+	return image;
+}
+
+/**
+ * @brief Closes an image, unmapping it if it was opened by
+ * pvars_image_map(). Views into the image become invalid.
+ *
+ * @param image The image to close. NULL is ignored.
+ */
+void pvars_image_close(pvars_image_t *image)
+{
+	if (image == NULL) {
+		return;
+	}
+
+	if (image->mapped > 0) {
+		pimage_unmap_file(image->base, image->mapped);
+	}
+	pmem_free(image->allocator, image, sizeof(pvars_image_t));
+}
+
+/**
+ * @brief Gets a view of the value an image was written from.
+ *
+ * @param image The image.
+ * @param out_view Receives the view.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pvars_image_root(const pvars_image_t *image, pview_t *out_view)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (image == NULL || out_view == NULL) {
+		pvars_errno = FAILURE_PVARS_IMAGE_ROOT_NULL_INPUT;
+		return false;
+	}
+
+	if (!pimage_view(image, &((const pimage_header_t *)(const void *)image->base)->root, sizeof(pimage_header_t), out_view)) {
+		return false;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Returns the type of a value in an image.
+ *
+ * @param view The value.
+ * @return Its type, PVAR_TYPE_NONE on failure (with pvars_errno set).
+ */
+pvar_type pview_get_type(const pview_t *view)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (view == NULL || view->image == NULL) {
+		pvars_errno = FAILURE_PVIEW_GET_TYPE_NULL_INPUT;
+		return PVAR_TYPE_NONE;
+	}
+
+	pvars_errno = SUCCESS;
+	return view->type;
+}
+
+/**
+ * @brief Returns the number of elements of a list, or of entries of a
+ * dict, in an image.
+ *
+ * @param view The list or dict.
+ * @return The size, 0 on failure (with pvars_errno set).
+ */
+size_t pview_get_size(const pview_t *view)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (view == NULL || view->image == NULL) {
+		pvars_errno = FAILURE_PVIEW_GET_SIZE_NULL_INPUT;
+		return 0;
+	}
+
+	if (view->type == PVAR_TYPE_LIST) {
+		const pimage_list_t *list = pimage_list(view->image, view->data);
+		if (list == NULL) {
+			return 0;
+		}
+		pvars_errno = SUCCESS;
+		return (size_t)list->count;
+	}
+
+	if (view->type == PVAR_TYPE_DICT) {
+		const pimage_dict_t *dict = pimage_dict(view->image, view->data);
+		if (dict == NULL) {
+			return 0;
+		}
+		pvars_errno = SUCCESS;
+		return (size_t)dict->count;
+	}
+
+	pvars_errno = FAILURE_PVIEW_GET_SIZE_WRONG_TYPE;
+	return 0;
+}
+
+/**
+ * @brief Returns the type every element of a list in an image has, if it
+ * was written from a typed list (see plist_create_typed()).
+ *
+ * @param view The list.
+ * @return The column type, PVAR_TYPE_NONE for a list of mixed values or
+ * on failure (with pvars_errno set).
+ */
+pvar_type pview_get_column_type(const pview_t *view)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (view == NULL || view->image == NULL) {
+		pvars_errno = FAILURE_PVIEW_GET_COLUMN_TYPE_NULL_INPUT;
+		return PVAR_TYPE_NONE;
+	}
+
+	if (view->type != PVAR_TYPE_LIST) {
+		pvars_errno = FAILURE_PVIEW_GET_COLUMN_TYPE_WRONG_TYPE;
+		return PVAR_TYPE_NONE;
+	}
+
+	const pimage_list_t *list = pimage_list(view->image, view->data);
+	if (list == NULL) {
+		return PVAR_TYPE_NONE;
+	}
+
+	pvars_errno = SUCCESS;
+	return (pvar_type)list->column;
+}
+
+/**
+ * @brief Gets a view of an element of a list in an image.
+ *
+ * @param list The list.
+ * @param index Index of the element.
+ * @param out_view Receives the view.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pview_list_get(const pview_t *list, size_t index, pview_t *out_view)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL || list->image == NULL || out_view == NULL) {
+		pvars_errno = FAILURE_PVIEW_LIST_GET_NULL_INPUT;
+		return false;
+	}
+
+	if (list->type != PVAR_TYPE_LIST) {
+		pvars_errno = FAILURE_PVIEW_LIST_GET_WRONG_TYPE;
+		return false;
+	}
+
+	const pimage_list_t *record = pimage_list(list->image, list->data);
+	if (record == NULL) {
+		return false;
+	}
+
+	if (index >= record->count) {
+		pvars_errno = FAILURE_PVIEW_LIST_GET_OUT_OF_BOUNDS;
+		return false;
+	}
+
+	const void *values = record + 1;
+	pimage_slot_t slot = { 0, record->column, { 0 } };
+	uint32_t narrow;
+
+	switch (record->column) {
+		case PVAR_TYPE_NONE:
+			slot = ((const pimage_slot_t *)values)[index];
+			break;
+		case PVAR_TYPE_INT:
+			slot.data = (uint64_t)(int64_t)((const int *)values)[index];
+			break;
+		case PVAR_TYPE_LONG:
+			slot.data = (uint64_t)(int64_t)((const long *)values)[index];
+			break;
+		case PVAR_TYPE_DOUBLE:
+			memcpy(&slot.data, (const double *)values + index, sizeof(double));
+			break;
+		default:
+			memcpy(&narrow, (const float *)values + index, sizeof(float));
+			slot.data = narrow;
+			break;
+	}
+
+	uint64_t end = list->data + sizeof(pimage_list_t) + record->count * pimage_width(record->column);
+	if (!pimage_view(list->image, &slot, end, out_view)) {
+		return false;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Looks up a key of a dict in an image, through the hash table
+ * stored with it.
+ *
+ * @param dict The dict.
+ * @param key The key.
+ * @param out_view Receives a view of the key's value.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pview_dict_get(const pview_t *dict, const char *key, pview_t *out_view)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL || dict->image == NULL || key == NULL || out_view == NULL) {
+		pvars_errno = FAILURE_PVIEW_DICT_GET_NULL_INPUT;
+		return false;
+	}
+
+	if (dict->type != PVAR_TYPE_DICT) {
+		pvars_errno = FAILURE_PVIEW_DICT_GET_WRONG_TYPE;
+		return false;
+	}
+
+	const pimage_dict_t *record = pimage_dict(dict->image, dict->data);
+	if (record == NULL) {
+		return false;
+	}
+
+	const pimage_entry_t *entries = pimage_entries(record);
+	const uint32_t *table = pimage_table(record);
+	size_t len = strlen(key);
+	uint64_t hash = phash_wyhash(key, len, dict->image->seed);
+
+	/* Bounded by the table size, should a corrupt table have no empty slot */
+	for (uint64_t probe = 0, slot = hash & record->mask; probe <= record->mask; probe++, slot = (slot + 1) & record->mask) {
+		uint32_t number = table[slot];
+		if (number == 0) {
+			break;
+		}
+		if (number > record->count) {
+			pvars_errno = FAILURE_PVARS_IMAGE_CORRUPT;
+			return false;
+		}
+
+		const pimage_entry_t *entry = &entries[number - 1];
+		if (entry->hash != hash) {
+			continue;
+		}
+
+		const char *bytes;
+		size_t bytes_len;
+		if (!pimage_str(dict->image, entry->key, &bytes, &bytes_len)) {
+			return false;
+		}
+		if (bytes_len == len && memcmp(bytes, key, len) == 0) {
+			if (!pimage_view(dict->image, &entry->value, pimage_dict_end(dict->data, record), out_view)) {
+				return false;
+			}
+			pvars_errno = SUCCESS;
+			return true;
+		}
+	}
+
+	pvars_errno = FAILURE_PVIEW_DICT_GET_KEY_NOT_FOUND;
+	return false;
+}
+
+/**
+ * @brief Gets an entry of a dict in an image by position, to walk the dict
+ * in the table order it was written in.
+ *
+ * @param dict The dict.
+ * @param index Position of the entry, below pview_get_size().
+ * @param out_key If not NULL, receives the key, valid until the image is
+ * closed.
+ * @param out_view If not NULL, receives a view of the value.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pview_dict_entry(const pview_t *dict, size_t index, const char **out_key, pview_t *out_view)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (dict == NULL || dict->image == NULL) {
+		pvars_errno = FAILURE_PVIEW_DICT_ENTRY_NULL_INPUT;
+		return false;
+	}
+
+	if (dict->type != PVAR_TYPE_DICT) {
+		pvars_errno = FAILURE_PVIEW_DICT_ENTRY_WRONG_TYPE;
+		return false;
+	}
+
+	const pimage_dict_t *record = pimage_dict(dict->image, dict->data);
+	if (record == NULL) {
+		return false;
+	}
+
+	if (index >= record->count) {
+		pvars_errno = FAILURE_PVIEW_DICT_ENTRY_OUT_OF_BOUNDS;
+		return false;
+	}
+
+	const pimage_entry_t *entry = &pimage_entries(record)[index];
+	const char *key;
+	size_t len;
+
+	if (!pimage_str(dict->image, entry->key, &key, &len)) {
+		return false;
+	}
+
+	if (out_key != NULL) {
+		*out_key = key;
+	}
+	if (out_view != NULL && !pimage_view(dict->image, &entry->value, pimage_dict_end(dict->data, record), out_view)) {
+		return false;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Borrows the packed array of a typed list in an image, in place.
+ *
+ * @param list The list, written from a typed list (see plist_create_typed()).
+ * @param out_data Receives the array of int, long, double or float, as told
+ * by pview_get_column_type(). It is read only and valid until the image is
+ * closed.
+ * @param out_count Receives the number of elements.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pview_borrow_span(const pview_t *list, const void **out_data, size_t *out_count)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL || list->image == NULL || out_data == NULL || out_count == NULL) {
+		pvars_errno = FAILURE_PVIEW_BORROW_SPAN_NULL_INPUT;
+		return false;
+	}
+
+	if (list->type != PVAR_TYPE_LIST) {
+		pvars_errno = FAILURE_PVIEW_BORROW_SPAN_NOT_TYPED;
+		return false;
+	}
+
+	const pimage_list_t *record = pimage_list(list->image, list->data);
+	if (record == NULL) {
+		return false;
+	}
+
+	if (record->column == PVAR_TYPE_NONE) {
+		pvars_errno = FAILURE_PVIEW_BORROW_SPAN_NOT_TYPED;
+		return false;
+	}
+
+	*out_data = record + 1;
+	*out_count = (size_t)record->count;
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Borrows a string in an image, in place.
+ *
+ * @param view The string.
+ * @param out_value Receives the NUL terminated string, valid until the
+ * image is closed.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pview_borrow_str(const pview_t *view, const char **out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (view == NULL || view->image == NULL || out_value == NULL) {
+		pvars_errno = FAILURE_PVIEW_BORROW_STR_NULL_INPUT;
+		return false;
+	}
+
+	if (view->type != PVAR_TYPE_STRING) {
+		pvars_errno = FAILURE_PVIEW_BORROW_STR_WRONG_TYPE;
+		return false;
+	}
+
+	size_t len;
+	if (!pimage_str(view->image, view->data, out_value, &len)) {
+		return false;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Borrows a string in an image with its length, which tells where
+ * it ends if it contains NUL bytes.
+ *
+ * @param view The string.
+ * @param out_value Receives the string, valid until the image is closed.
+ * @param out_len Receives its length in bytes.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pview_borrow_strn(const pview_t *view, const char **out_value, size_t *out_len)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (view == NULL || view->image == NULL || out_value == NULL || out_len == NULL) {
+		pvars_errno = FAILURE_PVIEW_BORROW_STRN_NULL_INPUT;
+		return false;
+	}
+
+	if (view->type != PVAR_TYPE_STRING) {
+		pvars_errno = FAILURE_PVIEW_BORROW_STRN_WRONG_TYPE;
+		return false;
+	}
+
+	if (!pimage_str(view->image, view->data, out_value, out_len)) {
+		return false;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Gets an int in an image.
+ *
+ * @param view The value.
+ * @param out_value Receives the int.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pview_get_int(const pview_t *view, int *out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (view == NULL || view->image == NULL || out_value == NULL) {
+		pvars_errno = FAILURE_PVIEW_GET_INT_NULL_INPUT;
+		return false;
+	}
+
+	if (view->type != PVAR_TYPE_INT) {
+		pvars_errno = FAILURE_PVIEW_GET_INT_WRONG_TYPE;
+		return false;
+	}
+
+	int64_t number = (int64_t)view->data;
+	if (number < INT_MIN || number > INT_MAX) {
+		pvars_errno = FAILURE_PVARS_IMAGE_CORRUPT;
+		return false;
+	}
+
+	*out_value = (int)number;
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Gets a long in an image.
+ *
+ * @param view The value.
+ * @param out_value Receives the long.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pview_get_long(const pview_t *view, long *out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (view == NULL || view->image == NULL || out_value == NULL) {
+		pvars_errno = FAILURE_PVIEW_GET_LONG_NULL_INPUT;
+		return false;
+	}
+
+	if (view->type != PVAR_TYPE_LONG) {
+		pvars_errno = FAILURE_PVIEW_GET_LONG_WRONG_TYPE;
+		return false;
+	}
+
+	int64_t number = (int64_t)view->data;
+	if (number < LONG_MIN || number > LONG_MAX) {
+		pvars_errno = FAILURE_PVARS_IMAGE_CORRUPT;
+		return false;
+	}
+
+	*out_value = (long)number;
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Gets a double in an image.
+ *
+ * @param view The value.
+ * @param out_value Receives the double.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pview_get_double(const pview_t *view, double *out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (view == NULL || view->image == NULL || out_value == NULL) {
+		pvars_errno = FAILURE_PVIEW_GET_DOUBLE_NULL_INPUT;
+		return false;
+	}
+
+	if (view->type != PVAR_TYPE_DOUBLE) {
+		pvars_errno = FAILURE_PVIEW_GET_DOUBLE_WRONG_TYPE;
+		return false;
+	}
+
+	memcpy(out_value, &view->data, sizeof(double));
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Gets a float in an image.
+ *
+ * @param view The value.
+ * @param out_value Receives the float.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pview_get_float(const pview_t *view, float *out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (view == NULL || view->image == NULL || out_value == NULL) {
+		pvars_errno = FAILURE_PVIEW_GET_FLOAT_NULL_INPUT;
+		return false;
+	}
+
+	if (view->type != PVAR_TYPE_FLOAT) {
+		pvars_errno = FAILURE_PVIEW_GET_FLOAT_WRONG_TYPE;
+		return false;
+	}
+
+	uint32_t narrow = (uint32_t)view->data;
+	memcpy(out_value, &narrow, sizeof(float));
+
+	pvars_errno = SUCCESS;
+	return true;
+}
@@ -0,0 +1,307 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<pthread.h>
+#include<stdatomic.h>
+#include<string.h>
+
+#include"pvars.h"
+#include"perrno.h"
+#include"pintern_internal.h"
+#include"pstr_internal.h"
+#include"pmem_internal.h"
+
+#define PINTERN_SHARD_BITS 4 /* The pool is split into 1 << PINTERN_SHARD_BITS independently locked tables */
+#define PINTERN_SHARDS (1u << PINTERN_SHARD_BITS)
+#define PINTERN_MIN_CAPACITY 64
+
+/**
+ * @brief One lock-protected part of the key pool: an open addressing table
+ * of pooled strings, probed linearly from their hash. Keys are spread over
+ * the shards by the top bits of their hash, so threads adding different
+ * keys rarely wait for each other.
+ */
+typedef struct {
+	pthread_mutex_t lock;
+	char **keys;        // Pooled strings (pstr_create() data pointers), NULL for an empty slot
+	size_t capacity;    // Slots in 'keys', a power of two or 0
+	size_t count;       // Distinct keys
+	size_t references;  // Sum of the keys' refs
+	size_t bytes;       // Memory held by the keys
+	size_t bytes_saved; // Memory the extra references would have needed as copies
+} pintern_shard_t;
+
+static pintern_shard_t pintern_shards[PINTERN_SHARDS];
+static pthread_once_t pintern_once = PTHREAD_ONCE_INIT;
+static _Atomic bool pintern_enabled = false;
+
+/**
+ * @brief Initialises the shard locks. Run once through pthread_once().
+ */
+static void pintern_init(void)
+{
+	for (size_t i = 0; i < PINTERN_SHARDS; i++) {
+		pthread_mutex_init(&pintern_shards[i].lock, NULL);
+	}
+}
+
+/**
+ * @brief Returns the header of a pooled key, which the pool may update.
+ */
+static pstr_t *pintern_header(char *key)
+{
+	return (pstr_t *)(void *)(key - offsetof(pstr_t, data));
+}
+
+/**
+ * @brief Returns the shard holding keys with the given hash, locked.
+ */
+static pintern_shard_t *pintern_lock(uint64_t hash)
+{
+	pthread_once(&pintern_once, pintern_init);
+
+	pintern_shard_t *shard = &pintern_shards[hash >> (64 - PINTERN_SHARD_BITS)];
+	pthread_mutex_lock(&shard->lock);
+	return shard;
+}
+
+/**
+ * @brief Rebuilds a shard's table with new_capacity slots.
+ *
+ * @return True on success, false if the table could not be allocated.
+ */
+static bool pintern_resize(pintern_shard_t *shard, size_t new_capacity)
+{
+	char **keys = pmem_calloc(pmem_heap(), new_capacity, sizeof(char *));
+	if (keys == NULL) {
+		return false;
+	}
+
+	for (size_t i = 0; i < shard->capacity; i++) {
+		if (shard->keys[i] == NULL) {
+			continue;
+		}
+
+		size_t index = (size_t)pstr_header(shard->keys[i])->hash & (new_capacity - 1);
+		while (keys[index] != NULL) {
+			index = (index + 1) & (new_capacity - 1);
+		}
+		keys[index] = shard->keys[i];
+	}
+
+	pmem_free(pmem_heap(), shard->keys, shard->capacity * sizeof(char *));
+	shard->keys = keys;
+	shard->capacity = new_capacity;
+	return true;
+}
+
+/**
+ * @brief Removes the key in slot index, shifting later keys of the same
+ * probe run back so that no tombstones are needed.
+ */
+static void pintern_erase(pintern_shard_t *shard, size_t index)
+{
+	size_t mask = shard->capacity - 1;
+	size_t hole = index;
+
+	for (size_t next = (hole + 1) & mask; shard->keys[next] != NULL; next = (next + 1) & mask) {
+		size_t home = (size_t)pstr_header(shard->keys[next])->hash & mask;
+
+		/* Move the key into the hole unless its home lies cyclically in (hole, next] */
+		if (((next - home) & mask) >= ((next - hole) & mask)) {
+			shard->keys[hole] = shard->keys[next];
+			hole = next;
+		}
+	}
+
+	shard->keys[hole] = NULL;
+}
+
+/**
+ * @brief Returns the pooled copy of len bytes, adding it to the pool if
+ * needed, and takes a reference on it.
+ *
+ * @param bytes The key bytes.
+ * @param len Number of bytes.
+ * @return The pooled key, to be released with pintern_release(), or NULL if
+ * memory ran out.
+ */
+char *pintern_acquire(const char *bytes, size_t len)
+{
+	uint64_t hash = pstr_hash_bytes(bytes, len);
+	pintern_shard_t *shard = pintern_lock(hash);
+	char *key = NULL;
+
+	if (shard->capacity > 0) {
+		size_t mask = shard->capacity - 1;
+
+		for (size_t index = (size_t)hash & mask; shard->keys[index] != NULL; index = (index + 1) & mask) {
+			pstr_t *header = pintern_header(shard->keys[index]);
+
+			if (header->hash == hash && header->len == len && memcmp(header->data, bytes, len) == 0) {
+				header->refs++;
+				shard->references++;
+				shard->bytes_saved += pstr_size(len);
+				key = header->data;
+				break;
+			}
+		}
+	}
+
+	if (key == NULL) {
+		/* Keeps the load factor at or below 1/2 */
+		if ((shard->count + 1) * 2 > shard->capacity) {
+			size_t new_capacity = shard->capacity > 0 ? shard->capacity * 2 : PINTERN_MIN_CAPACITY;
+			if (!pintern_resize(shard, new_capacity)) {
+				pthread_mutex_unlock(&shard->lock);
+				return NULL;
+			}
+		}
+
+		key = pstr_create(pmem_heap(), bytes, len, true);
+		if (key != NULL) {
+			pstr_t *header = pintern_header(key);
+			header->flags |= PSTR_FLAG_INTERNED;
+			header->refs = 1;
+
+			size_t index = (size_t)hash & (shard->capacity - 1);
+			while (shard->keys[index] != NULL) {
+				index = (index + 1) & (shard->capacity - 1);
+			}
+			shard->keys[index] = key;
+			shard->count++;
+			shard->references++;
+			shard->bytes += pstr_size(len);
+		}
+	}
+
+	pthread_mutex_unlock(&shard->lock);
+	return key;
+}
+
+/**
+ * @brief Takes another reference on a pooled key, without looking it up.
+ *
+ * @param key A key returned by pintern_acquire().
+ * @return key.
+ */
+char *pintern_retain(char *key)
+{
+	pstr_t *header = pintern_header(key);
+	pintern_shard_t *shard = pintern_lock(header->hash);
+
+	header->refs++;
+	shard->references++;
+	shard->bytes_saved += pstr_size(header->len);
+
+	pthread_mutex_unlock(&shard->lock);
+	return key;
+}
+
+/**
+ * @brief Drops a reference on a pooled key, freeing it with the last one.
+ *
+ * @param key A key returned by pintern_acquire() or pintern_retain().
+ */
+void pintern_release(char *key)
+{
+	pstr_t *header = pintern_header(key);
+	pintern_shard_t *shard = pintern_lock(header->hash);
+	size_t size = pstr_size(header->len);
+
+	shard->references--;
+
+	if (--header->refs > 0) {
+		shard->bytes_saved -= size;
+		pthread_mutex_unlock(&shard->lock);
+		return;
+	}
+
+	size_t mask = shard->capacity - 1;
+	size_t index = (size_t)header->hash & mask;
+	while (shard->keys[index] != key) {
+		index = (index + 1) & mask;
+	}
+	pintern_erase(shard, index);
+
+	shard->count--;
+	shard->bytes -= size;
+	pstr_free(pmem_heap(), key);
+
+	/* An unused pool holds no memory */
+	if (shard->count == 0) {
+		pmem_free(pmem_heap(), shard->keys, shard->capacity * sizeof(char *));
+		shard->keys = NULL;
+		shard->capacity = 0;
+	}
+
+	pthread_mutex_unlock(&shard->lock);
+}
+
+/**
+ * @brief Turns key interning on or off for dicts created afterwards.
+ *
+ * While it is on, new dicts store each key once in a process wide pool and
+ * their entries share it, so thousands of dicts with the same key names hold
+ * one copy of each name, and pdict_copy() takes a reference instead of
+ * copying keys. Pooled keys are allocated on the heap, whatever the dict's
+ * allocator, and the pool is safe to use from any thread. Dicts built in an
+ * arena never intern their keys. Existing dicts keep the mode they were
+ * created with.
+ *
+ * @param enabled True to intern keys, false to give every entry its own copy.
+ */
+void pvars_set_key_interning(bool enabled)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	atomic_store(&pintern_enabled, enabled);
+
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Tells whether dicts created now will intern their keys.
+ *
+ * @return True if key interning is on.
+ */
+bool pvars_get_key_interning(void)
+{
+	return atomic_load(&pintern_enabled);
+}
+
+/**
+ * @brief Reports the size of the key pool and the memory it saves.
+ *
+ * @param out_stats Receives the statistics.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pvars_get_intern_stats(pvars_intern_stats_t *out_stats)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (out_stats == NULL) {
+		pvars_errno = FAILURE_PVARS_GET_INTERN_STATS_NULL_INPUT_OUT_VALUE;
+		return false;
+	}
+
+	pthread_once(&pintern_once, pintern_init);
+
+	out_stats->unique_keys = 0;
+	out_stats->references = 0;
+	out_stats->bytes = 0;
+	out_stats->bytes_saved = 0;
+
+	for (size_t i = 0; i < PINTERN_SHARDS; i++) {
+		pintern_shard_t *shard = &pintern_shards[i];
+
+		pthread_mutex_lock(&shard->lock);
+		out_stats->unique_keys += shard->count;
+		out_stats->references += shard->references;
+		out_stats->bytes += shard->bytes + shard->capacity * sizeof(char *);
+		out_stats->bytes_saved += shard->bytes_saved;
+		pthread_mutex_unlock(&shard->lock);
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
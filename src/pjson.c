@@ -0,0 +1,1198 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<limits.h>
+#include<locale.h>
+#include<math.h>
+#include<pthread.h>
+#include<stdint.h>
+#include<stdlib.h>
+#include<string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include<immintrin.h>
+#define PJSON_AVX2 1
+#endif
+
+#include"pvars.h"
+#include"perrno.h"
+#include"pvars_internal.h"
+#include"plist_internal.h"
+#include"pdict_internal.h"
+#include"pmem_internal.h"
+#include"pjson_internal.h"
+
+/*
+ * JSON text to values: pvars_parse_json() and pvars_parse_json_in().
+ *
+ * Parsing runs in two stages over the whole input, as simdjson does.
+ *
+ * Stage 1 reads the input 64 bytes at a time and turns each block into
+ * bit masks: quotes, backslashes, operators ({}[]:,) and whitespace. From
+ * them it works out which bytes are escaped and which lie inside strings
+ * (a prefix XOR of the unescaped quotes, carried from block to block), and
+ * records the position of every operator outside strings, every opening
+ * quote and the first byte of every number or literal. On x86 the masks
+ * come from AVX2 compares when the CPU has them, checked once at run time;
+ * elsewhere a table lookup per byte builds them.
+ *
+ * A second pass over those positions counts the elements of every array
+ * and object, so that stage 2 creates each list and dict at its final
+ * size.
+ *
+ * Stage 2 walks the positions and builds the values. Strings without
+ * escapes are copied straight from the input, found by a scan eight bytes
+ * at a time; numbers with an exact double are converted without strtod().
+ *
+ * Mapping of JSON to values:
+ *
+ *   object          pdict_t (duplicate keys are refused)
+ *   array           plist_t
+ *   string          PVAR_TYPE_STRING, bytes as they are after unescaping
+ *   integer         PVAR_TYPE_LONG, or PVAR_TYPE_DOUBLE past the range of long
+ *   other numbers   PVAR_TYPE_DOUBLE
+ *   true, false     PVAR_TYPE_INT 1 and 0
+ *   null            PVAR_TYPE_NONE
+ *
+ * Strings are not checked to be valid UTF-8, as nowhere else in the
+ * library; \u escapes are written out as UTF-8.
+ */
+
+#define PJSON_BLOCK 64              /* Bytes classified at once by stage 1 */
+#define PJSON_MIN_POSITIONS 1024
+#define PJSON_MAX_EXACT_POWER 22    /* Largest power of ten a double holds exactly */
+#define PJSON_MAX_EXACT_MANTISSA (1ull << 53)
+#define PJSON_MAX_DIGITS 19         /* Decimal digits that always fit in a uint64_t */
+
+/* Character classes of stage 1 */
+#define PJSON_QUOTE 0x1
+#define PJSON_BACKSLASH 0x2
+#define PJSON_OPERATOR 0x4
+#define PJSON_SPACE 0x8
+
+static const unsigned char pjson_class[256] = {
+	['"'] = PJSON_QUOTE,
+	['\\'] = PJSON_BACKSLASH,
+	['{'] = PJSON_OPERATOR, ['}'] = PJSON_OPERATOR,
+	['['] = PJSON_OPERATOR, [']'] = PJSON_OPERATOR,
+	[':'] = PJSON_OPERATOR, [','] = PJSON_OPERATOR,
+	[' '] = PJSON_SPACE, ['\t'] = PJSON_SPACE, ['\n'] = PJSON_SPACE, ['\r'] = PJSON_SPACE,
+};
+
+static const double pjson_powers[PJSON_MAX_EXACT_POWER + 1] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+ * @brief The bit masks of one block: bit i stands for byte i.
+ */
+typedef struct {
+	uint64_t quote;
+	uint64_t backslash;
+	uint64_t op;
+	uint64_t space;
+} pjson_block_t;
+
+typedef void (*pjson_classify_t)(const unsigned char *bytes, pjson_block_t *out_block);
+
+/**
+ * @brief State of pvars_parse_json().
+ */
+typedef struct {
+	const unsigned char *json;
+	size_t len;
+	uint32_t *positions;    // Offsets of the structural characters, from stage 1
+	size_t count;           // Positions found
+	size_t capacity;        // Positions allocated
+	size_t next;            // Next position for stage 2 to read
+	uint32_t *sizes;        // Elements of every array and object, in order of their opening
+	size_t sizes_capacity;
+	size_t containers;      // Next entry of 'sizes' for stage 2
+	pjson_scratch_t scratch; // Unescaped strings and numbers for strtod()
+	size_t depth;           // Arrays and objects entered and not yet left
+	const pvars_allocator_t *allocator; // Allocator of the lists and dicts built
+} pjson_parser_t;
+
+/* --- Stage 1 --- */
+
+static void pjson_classify_scalar(const unsigned char *bytes, pjson_block_t *out_block)
+{
+	uint64_t quote = 0;
+	uint64_t backslash = 0;
+	uint64_t op = 0;
+	uint64_t space = 0;
+
+	for (unsigned i = 0; i < PJSON_BLOCK; i++) {
+		unsigned kind = pjson_class[bytes[i]];
+		quote |= (uint64_t)(kind & PJSON_QUOTE) << i;
+		backslash |= (uint64_t)((kind & PJSON_BACKSLASH) >> 1) << i;
+		op |= (uint64_t)((kind & PJSON_OPERATOR) >> 2) << i;
+		space |= (uint64_t)((kind & PJSON_SPACE) >> 3) << i;
+	}
+
+	out_block->quote = quote;
+	out_block->backslash = backslash;
+	out_block->op = op;
+	out_block->space = space;
+}
+
+#if defined(PJSON_AVX2)
+
+/**
+ * @brief Classifies 32 bytes. '[' and ']' differ from '{' and '}' only by
+ * the 0x20 bit, so setting it folds the four brackets onto two compares.
+ */
+__attribute__((target("avx2")))
+static void pjson_classify_half_avx2(__m256i bytes, uint32_t *out_masks)
+{
+	__m256i folded = _mm256_or_si256(bytes, _mm256_set1_epi8(0x20));
+
+	__m256i quote = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('"'));
+	__m256i backslash = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\\'));
+	__m256i op = _mm256_or_si256(
+		_mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+		_mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(','))));
+	__m256i space = _mm256_or_si256(
+		_mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\t'))),
+		_mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\r'))));
+
+	out_masks[0] = (uint32_t)_mm256_movemask_epi8(quote);
+	out_masks[1] = (uint32_t)_mm256_movemask_epi8(backslash);
+	out_masks[2] = (uint32_t)_mm256_movemask_epi8(op);
+	out_masks[3] = (uint32_t)_mm256_movemask_epi8(space);
+}
+
+__attribute__((target("avx2")))
+static void pjson_classify_avx2(const unsigned char *bytes, pjson_block_t *out_block)
+{
+	uint32_t low[4];
+	uint32_t high[4];
+
+	pjson_classify_half_avx2(_mm256_loadu_si256((const __m256i *)(const void *)bytes), low);
+	pjson_classify_half_avx2(_mm256_loadu_si256((const __m256i *)(const void *)(bytes + 32)), high);
+
+	out_block->quote = low[0] | (uint64_t)high[0] << 32;
+	out_block->backslash = low[1] | (uint64_t)high[1] << 32;
+	out_block->op = low[2] | (uint64_t)high[2] << 32;
+	out_block->space = low[3] | (uint64_t)high[3] << 32;
+}
+
+#endif /* PJSON_AVX2 */
+
+/**
+ * @brief Finds the bytes of a block that follow an escaping backslash.
+ * A backslash escapes the next byte unless it is itself escaped, so runs
+ * of backslashes pair up. Backslashes are rare, so they are walked one by
+ * one.
+ *
+ * @param backslash Backslashes of the block.
+ * @param carry In: 1 if the first byte is escaped by the previous block.
+ * Out: 1 if the first byte of the next block is escaped.
+ * @return The escaped bytes.
+ */
+static uint64_t pjson_escaped(uint64_t backslash, uint64_t *carry)
+{
+	uint64_t escaped = *carry;
+
+	backslash &= ~escaped;
+	*carry = 0;
+
+	while (backslash != 0) {
+		unsigned i = (unsigned)__builtin_ctzll(backslash);
+		if (i == PJSON_BLOCK - 1) {
+			*carry = 1;
+			break;
+		}
+		escaped |= 2ull << i;
+		backslash &= ~(3ull << i);
+	}
+
+	return escaped;
+}
+
+/**
+ * @brief Sets every bit from an odd numbered quote up to the next quote:
+ * bit i becomes the XOR of bits 0 to i.
+ */
+static uint64_t pjson_prefix_xor(uint64_t bits)
+{
+	bits ^= bits << 1;
+	bits ^= bits << 2;
+	bits ^= bits << 4;
+	bits ^= bits << 8;
+	bits ^= bits << 16;
+	bits ^= bits << 32;
+	return bits;
+}
+
+static bool pjson_reserve_positions(pjson_parser_t *parser, size_t extra)
+{
+	if (parser->capacity - parser->count >= extra) {
+		return true;
+	}
+
+	size_t new_capacity = parser->capacity > 0 ? parser->capacity * 2 : PJSON_MIN_POSITIONS;
+	while (new_capacity - parser->count < extra) {
+		new_capacity *= 2;
+	}
+
+	uint32_t *positions = parser->positions == NULL
+		? pmem_malloc(pmem_default(), new_capacity * sizeof(uint32_t))
+		: pmem_realloc(pmem_default(), parser->positions, parser->capacity * sizeof(uint32_t), new_capacity * sizeof(uint32_t));
+	if (positions == NULL) {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_ALLOC_FAILED;
+		return false;
+	}
+
+	parser->positions = positions;
+	parser->capacity = new_capacity;
+	return true;
+}
+
+/**
+ * @brief Appends base plus the index of every set bit of bits. The
+ * positions are written eight at a time whatever their number, so that the
+ * loop is rarely mispredicted; up to 64 entries past out may be written.
+ *
+ * @return The end of the positions written.
+ */
+static inline uint32_t *pjson_flatten(uint32_t *out, uint32_t base, uint64_t bits)
+{
+	uint32_t *end = out + __builtin_popcountll(bits);
+
+	while (out < end) {
+		for (unsigned i = 0; i < 8; i++) {
+			/* The top bit keeps ctz defined once bits runs out */
+			out[i] = base + (uint32_t)__builtin_ctzll(bits | 1ull << 63);
+			bits &= bits - 1;
+		}
+		out += 8;
+	}
+
+	return end;
+}
+
+/**
+ * @brief Stage 1 with the given classifier, which is inlined into each of
+ * pjson_index_scalar() and pjson_index_avx2().
+ *
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+static inline __attribute__((always_inline)) bool pjson_index_with(pjson_parser_t *parser, pjson_classify_t classify)
+{
+	uint64_t escape_carry = 0;
+	uint64_t string_carry = 0; // All ones while inside a string
+	uint64_t scalar_carry = 0; // 1 if the previous block ended inside a number or literal
+	unsigned char tail[PJSON_BLOCK];
+
+	for (size_t base = 0; base < parser->len; base += PJSON_BLOCK) {
+		const unsigned char *bytes = parser->json + base;
+		if (parser->len - base < PJSON_BLOCK) {
+			memset(tail, ' ', sizeof(tail));
+			memcpy(tail, bytes, parser->len - base);
+			bytes = tail;
+		}
+
+		pjson_block_t block;
+		classify(bytes, &block);
+
+		uint64_t quote = block.quote;
+		if (block.backslash != 0 || escape_carry != 0) {
+			quote &= ~pjson_escaped(block.backslash, &escape_carry);
+		}
+		/* Opening quotes and string contents, not closing quotes */
+		uint64_t in_string = pjson_prefix_xor(quote) ^ string_carry;
+		string_carry = 0 - (in_string >> 63);
+
+		uint64_t scalar = ~(block.op | block.space | quote | in_string);
+		uint64_t starts = scalar & ~(scalar << 1 | scalar_carry);
+		scalar_carry = scalar >> 63;
+
+		uint64_t structural = (block.op & ~in_string) | (quote & in_string) | starts;
+
+		if (!pjson_reserve_positions(parser, PJSON_BLOCK)) {
+			return false;
+		}
+
+		uint32_t *out = pjson_flatten(parser->positions + parser->count, (uint32_t)base, structural);
+		parser->count = (size_t)(out - parser->positions);
+	}
+
+	if (string_carry != 0) {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_BAD_STRING;
+		return false;
+	}
+
+	return true;
+}
+
+static bool pjson_index_scalar(pjson_parser_t *parser)
+{
+	return pjson_index_with(parser, pjson_classify_scalar);
+}
+
+#if defined(PJSON_AVX2)
+
+__attribute__((target("avx2,popcnt")))
+static bool pjson_index_avx2(pjson_parser_t *parser)
+{
+	return pjson_index_with(parser, pjson_classify_avx2);
+}
+
+#endif /* PJSON_AVX2 */
+
+static bool (*pjson_index_blocks)(pjson_parser_t *parser) = pjson_index_scalar;
+static pthread_once_t pjson_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Picks the stage 1 loop for this CPU. Runs once per process,
+ * through pthread_once().
+ */
+static void pjson_init(void)
+{
+#if defined(PJSON_AVX2)
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) {
+		pjson_index_blocks = pjson_index_avx2;
+	}
+#endif
+}
+
+/**
+ * @brief Stage 1: records the position of every structural character.
+ *
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+static bool pjson_index(pjson_parser_t *parser)
+{
+	pthread_once(&pjson_once, pjson_init);
+	return pjson_index_blocks(parser);
+}
+
+/**
+ * @brief Counts the elements of every array and object from the commas
+ * directly inside them. The counts only size containers; stage 2 checks
+ * the structure.
+ *
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+static bool pjson_size_containers(pjson_parser_t *parser)
+{
+	uint32_t stack[PVARS_JSON_MAX_DEPTH];
+	size_t depth = 0;
+	size_t opened = 0;
+
+	/* Every array or object beyond the innermost open ones is closed by a later position */
+	parser->sizes_capacity = parser->count / 2 + PVARS_JSON_MAX_DEPTH + 1;
+	parser->sizes = pmem_malloc(pmem_default(), parser->sizes_capacity * sizeof(uint32_t));
+	if (parser->sizes == NULL) {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_ALLOC_FAILED;
+		return false;
+	}
+
+	for (size_t i = 0; i < parser->count; i++) {
+		unsigned char c = parser->json[parser->positions[i]];
+
+		switch (c) {
+			case '[':
+			case '{':
+				if (depth == PVARS_JSON_MAX_DEPTH) {
+					pvars_errno = FAILURE_PVARS_PARSE_JSON_TOO_DEEP;
+					return false;
+				}
+				{
+					unsigned char following = i + 1 < parser->count ? parser->json[parser->positions[i + 1]] : 0;
+					parser->sizes[opened] = following == ']' || following == '}' ? 0 : 1;
+				}
+				stack[depth++] = (uint32_t)opened++;
+				break;
+			case ',':
+				if (depth > 0) {
+					parser->sizes[stack[depth - 1]]++;
+				}
+				break;
+			case ']':
+			case '}':
+				if (depth > 0) {
+					depth--;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+
+	return true;
+}
+
+/* --- Stage 2 --- */
+
+/**
+ * @brief Returns the next structural character and moves past it, or 0
+ * at the end of the input.
+ */
+static unsigned char pjson_next_char(pjson_parser_t *parser)
+{
+	if (parser->next == parser->count) {
+		return 0;
+	}
+	return parser->json[parser->positions[parser->next++]];
+}
+
+static unsigned char pjson_peek_char(const pjson_parser_t *parser)
+{
+	if (parser->next == parser->count) {
+		return 0;
+	}
+	return parser->json[parser->positions[parser->next]];
+}
+
+/**
+ * @brief Tells whether a number or literal may end before this byte.
+ */
+static bool pjson_ends_scalar(const pjson_parser_t *parser, const unsigned char *p)
+{
+	return p == parser->json + parser->len || (pjson_class[*p] & (PJSON_OPERATOR | PJSON_SPACE)) != 0;
+}
+
+static int pjson_hex(unsigned char c)
+{
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	c |= 0x20;
+	if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	}
+	return -1;
+}
+
+/**
+ * @brief Reads the four hex digits of a \u escape.
+ *
+ * @return The code unit, or -1 if the digits are missing or invalid.
+ */
+static long pjson_code_unit(const unsigned char *p, const unsigned char *end)
+{
+	if (end - p < 4) {
+		return -1;
+	}
+
+	long unit = 0;
+	for (int i = 0; i < 4; i++) {
+		int digit = pjson_hex(p[i]);
+		if (digit < 0) {
+			return -1;
+		}
+		unit = unit * 16 + digit;
+	}
+	return unit;
+}
+
+/**
+ * @brief Writes a code point as UTF-8.
+ *
+ * @return The byte after the last one written.
+ */
+static char *pjson_put_utf8(char *out, unsigned long code)
+{
+	if (code < 0x80) {
+		*out++ = (char)code;
+	} else if (code < 0x800) {
+		*out++ = (char)(0xC0 | (code >> 6));
+		*out++ = (char)(0x80 | (code & 0x3F));
+	} else if (code < 0x10000) {
+		*out++ = (char)(0xE0 | (code >> 12));
+		*out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+		*out++ = (char)(0x80 | (code & 0x3F));
+	} else {
+		*out++ = (char)(0xF0 | (code >> 18));
+		*out++ = (char)(0x80 | ((code >> 12) & 0x3F));
+		*out++ = (char)(0x80 | ((code >> 6) & 0x3F));
+		*out++ = (char)(0x80 | (code & 0x3F));
+	}
+	return out;
+}
+
+/**
+ * @brief Makes the scratch buffer hold at least size bytes.
+ *
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+bool pjson_scratch_reserve(pjson_scratch_t *scratch, size_t size)
+{
+	if (size <= scratch->capacity) {
+		return true;
+	}
+
+	char *bytes = scratch->bytes == NULL
+		? pmem_malloc(scratch->allocator, size)
+		: pmem_realloc(scratch->allocator, scratch->bytes, scratch->capacity, size);
+	if (bytes == NULL) {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_ALLOC_FAILED;
+		return false;
+	}
+
+	scratch->bytes = bytes;
+	scratch->capacity = size;
+	return true;
+}
+
+void pjson_scratch_release(pjson_scratch_t *scratch)
+{
+	if (scratch->bytes != NULL) {
+		pmem_free(scratch->allocator, scratch->bytes, scratch->capacity);
+	}
+	scratch->bytes = NULL;
+	scratch->capacity = 0;
+}
+
+/**
+ * @brief Unescapes a string into the scratch buffer.
+ *
+ * @param scratch The scratch buffer.
+ * @param start First byte of the string, after the opening quote.
+ * @param p First backslash or control character.
+ * @param end Bound of the string: its closing quote lies before end.
+ * @param out_bytes Receives the unescaped bytes, valid until the scratch
+ * buffer is next used. At least one byte of the buffer follows them.
+ * @param out_len Receives their number.
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+bool pjson_unescape(pjson_scratch_t *scratch, const unsigned char *start, const unsigned char *p, const unsigned char *end, const char **out_bytes, size_t *out_len)
+{
+	/* Unescaping never lengthens a string, and the closing quote is within the bound */
+	if (!pjson_scratch_reserve(scratch, (size_t)(end - start))) {
+		return false;
+	}
+
+	char *out = scratch->bytes;
+	memcpy(out, start, (size_t)(p - start));
+	out += p - start;
+
+	while (p < end && *p != '"') {
+		if (*p != '\\' || end - p < 2) {
+			/* A control character, or a backslash ending the input */
+			pvars_errno = FAILURE_PVARS_PARSE_JSON_BAD_STRING;
+			return false;
+		}
+
+		unsigned char escape = p[1];
+		p += 2;
+
+		switch (escape) {
+			case '"':
+			case '\\':
+			case '/':
+				*out++ = (char)escape;
+				break;
+			case 'b':
+				*out++ = '\b';
+				break;
+			case 'f':
+				*out++ = '\f';
+				break;
+			case 'n':
+				*out++ = '\n';
+				break;
+			case 'r':
+				*out++ = '\r';
+				break;
+			case 't':
+				*out++ = '\t';
+				break;
+			case 'u':
+				{
+					long unit = pjson_code_unit(p, end);
+					unsigned long code = (unsigned long)unit;
+					p += 4;
+
+					if (unit >= 0xD800 && unit <= 0xDBFF) {
+						/* A high surrogate must be followed by an escaped low one */
+						long low = end - p >= 6 && p[0] == '\\' && p[1] == 'u' ? pjson_code_unit(p + 2, end) : -1;
+						if (low < 0xDC00 || low > 0xDFFF) {
+							unit = -1;
+						} else {
+							code = 0x10000 + (((unsigned long)unit - 0xD800) << 10) + ((unsigned long)low - 0xDC00);
+							p += 6;
+						}
+					} else if (unit >= 0xDC00 && unit <= 0xDFFF) {
+						unit = -1;
+					}
+
+					if (unit < 0) {
+						pvars_errno = FAILURE_PVARS_PARSE_JSON_BAD_STRING;
+						return false;
+					}
+					out = pjson_put_utf8(out, code);
+				}
+				break;
+			default:
+				pvars_errno = FAILURE_PVARS_PARSE_JSON_BAD_STRING;
+				return false;
+		}
+
+		const unsigned char *run = pjson_scan_string(p, end);
+		memcpy(out, p, (size_t)(run - p));
+		out += run - p;
+		p = run;
+	}
+
+	if (p == end) {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_BAD_STRING;
+		return false;
+	}
+
+	*out_bytes = scratch->bytes;
+	*out_len = (size_t)(out - scratch->bytes);
+	return true;
+}
+
+/**
+ * @brief Reads a string. Strings without escapes are returned in place.
+ *
+ * @param parser The parser, past the string's opening quote.
+ * @param position Offset of the opening quote.
+ * @param out_bytes Receives the bytes, valid until the next string.
+ * @param out_len Receives their number.
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+static bool pjson_parse_string(pjson_parser_t *parser, size_t position, const char **out_bytes, size_t *out_len)
+{
+	const unsigned char *start = parser->json + position + 1;
+	const unsigned char *p = pjson_scan_string(start, parser->json + parser->len);
+
+	if (p < parser->json + parser->len && *p == '"') {
+		*out_bytes = (const char *)start;
+		*out_len = (size_t)(p - start);
+		return true;
+	}
+
+	/* The string ends before the next structural character */
+	const unsigned char *bound = parser->json + (parser->next < parser->count ? parser->positions[parser->next] : parser->len);
+	return pjson_unescape(&parser->scratch, start, p, bound, out_bytes, out_len);
+}
+
+/**
+ * @brief Converts a number that has no exact fast conversion with
+ * strtod(), which expects the decimal point of the current locale.
+ */
+static bool pjson_strtod(pjson_scratch_t *scratch, const unsigned char *start, size_t len, double *out_value)
+{
+	if (!pjson_scratch_reserve(scratch, len + 1)) {
+		return false;
+	}
+
+	memcpy(scratch->bytes, start, len);
+	scratch->bytes[len] = '\0';
+
+	char *point = memchr(scratch->bytes, '.', len);
+	if (point != NULL) {
+		*point = *localeconv()->decimal_point;
+	}
+
+	double value = strtod(scratch->bytes, NULL);
+	if (!isfinite(value)) {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_BAD_NUMBER;
+		return false;
+	}
+
+	*out_value = value;
+	return true;
+}
+
+/**
+ * @brief Reads a number.
+ *
+ * Up to 19 significant digits are gathered in an integer with a decimal
+ * exponent. Integers that fit become longs; otherwise a mantissa below
+ * 2^53 with an exponent within 22 converts exactly with one multiplication
+ * or division, and anything else goes through strtod().
+ *
+ * @param scratch The scratch buffer, for strtod().
+ * @param start First byte of the number.
+ * @param end End of the input.
+ * @param out_value Receives the number.
+ * @return The byte after the number, or NULL on failure (with pvars_errno
+ * set). What follows the number is left to the caller to check.
+ */
+const unsigned char *pjson_read_number(pjson_scratch_t *scratch, const unsigned char *start, const unsigned char *end, pvar_t *out_value)
+{
+	const unsigned char *p = start;
+
+	bool negative = *p == '-';
+	if (negative) {
+		p++;
+	}
+
+	uint64_t mantissa = 0;
+	int digits = 0;         // Significant digits in mantissa
+	bool truncated = false; // Significant digits were dropped
+	long exponent = 0;
+
+	if (p == end || *p < '0' || *p > '9') {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_BAD_NUMBER;
+		return NULL;
+	}
+
+	if (*p == '0') {
+		p++;
+	} else {
+		for (; p < end && *p >= '0' && *p <= '9'; p++) {
+			if (digits < PJSON_MAX_DIGITS) {
+				mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+				digits++;
+			} else {
+				truncated = truncated || *p != '0';
+				exponent++;
+			}
+		}
+	}
+
+	bool integer = true;
+
+	if (p < end && *p == '.') {
+		integer = false;
+		p++;
+		if (p == end || *p < '0' || *p > '9') {
+			pvars_errno = FAILURE_PVARS_PARSE_JSON_BAD_NUMBER;
+			return NULL;
+		}
+		for (; p < end && *p >= '0' && *p <= '9'; p++) {
+			if (digits < PJSON_MAX_DIGITS) {
+				mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+				digits += mantissa > 0;
+				exponent--;
+			} else {
+				truncated = truncated || *p != '0';
+			}
+		}
+	}
+
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		integer = false;
+		p++;
+		bool negative_exponent = p < end && *p == '-';
+		if (p < end && (*p == '-' || *p == '+')) {
+			p++;
+		}
+		if (p == end || *p < '0' || *p > '9') {
+			pvars_errno = FAILURE_PVARS_PARSE_JSON_BAD_NUMBER;
+			return NULL;
+		}
+
+		long written = 0;
+		for (; p < end && *p >= '0' && *p <= '9'; p++) {
+			/* Past any double's range either way; strtod() settles it */
+			if (written < 100000) {
+				written = written * 10 + (*p - '0');
+			}
+		}
+		exponent += negative_exponent ? -written : written;
+	}
+
+	if (integer && exponent == 0) {
+		if (!negative && mantissa <= (uint64_t)LONG_MAX) {
+			out_value->data.l = (long)mantissa;
+			out_value->type = PVAR_TYPE_LONG;
+			return p;
+		}
+		if (negative && mantissa <= (uint64_t)LONG_MAX + 1) {
+			out_value->data.l = mantissa == (uint64_t)LONG_MAX + 1 ? LONG_MIN : -(long)mantissa;
+			out_value->type = PVAR_TYPE_LONG;
+			return p;
+		}
+	}
+
+	double value;
+	if (!truncated && mantissa <= PJSON_MAX_EXACT_MANTISSA && exponent >= -PJSON_MAX_EXACT_POWER && exponent <= PJSON_MAX_EXACT_POWER) {
+		value = (double)mantissa;
+		value = exponent < 0 ? value / pjson_powers[-exponent] : value * pjson_powers[exponent];
+		value = negative ? -value : value;
+	} else if (!pjson_strtod(scratch, start, (size_t)(p - start), &value)) {
+		return NULL;
+	}
+
+	out_value->data.d = value;
+	out_value->type = PVAR_TYPE_DOUBLE;
+	return p;
+}
+
+/**
+ * @brief Reads a number, which must be followed by an operator, whitespace
+ * or the end of the input.
+ */
+static bool pjson_parse_number(pjson_parser_t *parser, size_t position, pvar_t *out_value)
+{
+	const unsigned char *p = pjson_read_number(&parser->scratch, parser->json + position, parser->json + parser->len, out_value);
+	if (p == NULL) {
+		return false;
+	}
+
+	if (!pjson_ends_scalar(parser, p)) {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_BAD_NUMBER;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Reads true, false or null.
+ */
+static bool pjson_parse_literal(pjson_parser_t *parser, size_t position, pvar_t *out_value)
+{
+	const unsigned char *p = parser->json + position;
+	size_t left = parser->len - position;
+
+	if (left >= 4 && memcmp(p, "true", 4) == 0 && pjson_ends_scalar(parser, p + 4)) {
+		out_value->data.i = 1;
+		out_value->type = PVAR_TYPE_INT;
+		return true;
+	}
+	if (left >= 5 && memcmp(p, "false", 5) == 0 && pjson_ends_scalar(parser, p + 5)) {
+		out_value->data.i = 0;
+		out_value->type = PVAR_TYPE_INT;
+		return true;
+	}
+	if (left >= 4 && memcmp(p, "null", 4) == 0 && pjson_ends_scalar(parser, p + 4)) {
+		out_value->type = PVAR_TYPE_NONE;
+		return true;
+	}
+
+	pvars_errno = FAILURE_PVARS_PARSE_JSON_SYNTAX;
+	return false;
+}
+
+/**
+ * @brief Destroys a list or dict being built without touching pvars_errno.
+ */
+static void pjson_discard(plist_t *list, pdict_t *dict)
+{
+	int error = pvars_errno;
+
+	if (list != NULL) {
+		plist_destroy(list);
+	}
+	if (dict != NULL) {
+		pdict_destroy(dict);
+	}
+
+	pvars_errno = error;
+}
+
+static bool pjson_parse_value(pjson_parser_t *parser, const pvars_allocator_t *allocator, pvar_t *out_value);
+
+/**
+ * @brief Reads the elements of an array, after its opening bracket.
+ */
+static bool pjson_parse_list(pjson_parser_t *parser, size_t size, plist_t **out_list)
+{
+	plist_t *list = plist_create_with_allocator(parser->allocator, size > 0 ? (long int)size : 1);
+	if (list == NULL) {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_ALLOC_FAILED;
+		return false;
+	}
+
+	if (pjson_peek_char(parser) == ']') {
+		parser->next++;
+		*out_list = list;
+		return true;
+	}
+
+	for (;;) {
+		pvar_t element;
+
+		if (!pjson_parse_value(parser, list->allocator, &element)) {
+			pjson_discard(list, NULL);
+			return false;
+		}
+
+		if (!plist_append_take(list, &element)) {
+			pvar_destroy_in(list->allocator, &element);
+			pvars_errno = FAILURE_PVARS_PARSE_JSON_ALLOC_FAILED;
+			pjson_discard(list, NULL);
+			return false;
+		}
+
+		unsigned char c = pjson_next_char(parser);
+		if (c == ']') {
+			break;
+		}
+		if (c != ',') {
+			pvars_errno = FAILURE_PVARS_PARSE_JSON_SYNTAX;
+			pjson_discard(list, NULL);
+			return false;
+		}
+	}
+
+	*out_list = list;
+	return true;
+}
+
+/**
+ * @brief Reads the members of an object, after its opening brace.
+ */
+static bool pjson_parse_dict(pjson_parser_t *parser, size_t size, pdict_t **out_dict)
+{
+	pdict_t *dict = pdict_create_sized(parser->allocator, size);
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_ALLOC_FAILED;
+		return false;
+	}
+
+	if (pjson_peek_char(parser) == '}') {
+		parser->next++;
+		*out_dict = dict;
+		return true;
+	}
+
+	for (;;) {
+		if (pjson_next_char(parser) != '"') {
+			pvars_errno = FAILURE_PVARS_PARSE_JSON_SYNTAX;
+			pjson_discard(NULL, dict);
+			return false;
+		}
+
+		const char *key;
+		size_t len;
+		if (!pjson_parse_string(parser, parser->positions[parser->next - 1], &key, &len)) {
+			pjson_discard(NULL, dict);
+			return false;
+		}
+
+		/* Keys are C strings in the dict API */
+		if (memchr(key, '\0', len) != NULL) {
+			pvars_errno = FAILURE_PVARS_PARSE_JSON_BAD_STRING;
+			pjson_discard(NULL, dict);
+			return false;
+		}
+
+		/* An unescaped key lives in the scratch buffer, which the value may reuse */
+		char *copy = NULL;
+		if (key == parser->scratch.bytes) {
+			copy = pmem_strndup(pmem_default(), key, len);
+			if (copy == NULL) {
+				pvars_errno = FAILURE_PVARS_PARSE_JSON_ALLOC_FAILED;
+				pjson_discard(NULL, dict);
+				return false;
+			}
+			key = copy;
+		}
+
+		pvar_t value;
+		bool done = pjson_next_char(parser) == ':';
+		if (!done) {
+			pvars_errno = FAILURE_PVARS_PARSE_JSON_SYNTAX;
+		} else if ((done = pjson_parse_value(parser, dict->allocator, &value))
+			&& !(done = pdict_insert_take(dict, key, len, &value, FAILURE_PVARS_PARSE_JSON_DUPLICATE_KEY, FAILURE_PVARS_PARSE_JSON_ALLOC_FAILED))) {
+			perrno_t failure = pvars_errno;
+			pvar_destroy_in(dict->allocator, &value);
+			pvars_errno = failure;
+		}
+
+		if (copy != NULL) {
+			pmem_free(pmem_default(), copy, len + 1);
+		}
+		if (!done) {
+			pjson_discard(NULL, dict);
+			return false;
+		}
+
+		unsigned char c = pjson_next_char(parser);
+		if (c == '}') {
+			break;
+		}
+		if (c != ',') {
+			pvars_errno = FAILURE_PVARS_PARSE_JSON_SYNTAX;
+			pjson_discard(NULL, dict);
+			return false;
+		}
+	}
+
+	*out_dict = dict;
+	return true;
+}
+
+/**
+ * @brief Reads one value at the next structural position.
+ *
+ * @param parser The parser.
+ * @param allocator Allocator of the list or dict the value goes into, or
+ * NULL for a value handed to the caller, whose string is a plain C string.
+ * @param out_value Receives the value.
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+static bool pjson_parse_value(pjson_parser_t *parser, const pvars_allocator_t *allocator, pvar_t *out_value)
+{
+	memset(out_value, 0, sizeof(pvar_t));
+
+	if (parser->next == parser->count) {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_SYNTAX;
+		return false;
+	}
+
+	size_t position = parser->positions[parser->next++];
+	unsigned char c = parser->json[position];
+	bool done;
+
+	switch (c) {
+		case '"':
+			{
+				const char *bytes;
+				size_t len;
+				if (!pjson_parse_string(parser, position, &bytes, &len)) {
+					return false;
+				}
+
+				if (allocator == NULL) {
+					out_value->data.s = pmem_strndup(pmem_heap(), bytes, len);
+					done = out_value->data.s != NULL;
+					out_value->type = PVAR_TYPE_STRING;
+				} else {
+					done = pvar_set_strn_in(allocator, out_value, bytes, len);
+				}
+				if (!done) {
+					out_value->type = PVAR_TYPE_NONE;
+					pvars_errno = FAILURE_PVARS_PARSE_JSON_ALLOC_FAILED;
+					return false;
+				}
+			}
+			return true;
+		case '-':
+		case '0': case '1': case '2': case '3': case '4':
+		case '5': case '6': case '7': case '8': case '9':
+			return pjson_parse_number(parser, position, out_value);
+		case 't':
+		case 'f':
+		case 'n':
+			return pjson_parse_literal(parser, position, out_value);
+		case '[':
+		case '{':
+			break;
+		default:
+			pvars_errno = FAILURE_PVARS_PARSE_JSON_SYNTAX;
+			return false;
+	}
+
+	if (parser->depth >= PVARS_JSON_MAX_DEPTH) {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_TOO_DEEP;
+		return false;
+	}
+
+	size_t size = parser->sizes[parser->containers++];
+
+	parser->depth++;
+	if (c == '{') {
+		done = pjson_parse_dict(parser, size, &out_value->data.dt);
+	} else {
+		done = pjson_parse_list(parser, size, &out_value->data.ls);
+	}
+	parser->depth--;
+
+	if (done) {
+		out_value->type = c == '{' ? PVAR_TYPE_DICT : PVAR_TYPE_LIST;
+	}
+	return done;
+}
+
+/**
+ * @brief Runs both stages over json, building lists and dicts with
+ * allocator. See pvars_parse_json().
+ */
+static bool pjson_parse(const pvars_allocator_t *allocator, const char *json, size_t len, pvar_t *out_value)
+{
+	if (json == NULL || out_value == NULL) {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_NULL_INPUT;
+		return false;
+	}
+
+	if (len >= UINT32_MAX) {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_TOO_LARGE;
+		return false;
+	}
+
+	pjson_parser_t parser;
+	memset(&parser, 0, sizeof(parser));
+	parser.json = (const unsigned char *)json;
+	parser.len = len;
+	parser.allocator = allocator;
+	parser.scratch.allocator = pmem_default();
+
+	pvar_t value;
+	bool done = pjson_index(&parser) && pjson_size_containers(&parser) && pjson_parse_value(&parser, NULL, &value);
+
+	if (done && parser.next != parser.count) {
+		pvar_destroy(&value);
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_SYNTAX;
+		done = false;
+	}
+
+	if (parser.positions != NULL) {
+		pmem_free(pmem_default(), parser.positions, parser.capacity * sizeof(uint32_t));
+	}
+	if (parser.sizes != NULL) {
+		pmem_free(pmem_default(), parser.sizes, parser.sizes_capacity * sizeof(uint32_t));
+	}
+	pjson_scratch_release(&parser.scratch);
+
+	if (!done) {
+		return false;
+	}
+
+	*out_value = value;
+	return true;
+}
+
+/**
+ * @brief Parses a JSON text into a value, building lists and dicts
+ * directly.
+ *
+ * Objects become dicts, arrays lists, integers longs (doubles past the
+ * range of long), other numbers doubles, true and false the ints 1 and 0,
+ * and null an empty value (PVAR_TYPE_NONE). Any JSON value may be at the
+ * top level. The text is fully validated: anything but one value
+ * surrounded by whitespace, duplicate keys, keys containing \u0000 and
+ * nesting deeper than PVARS_JSON_MAX_DEPTH are refused.
+ *
+ * @param json The text. It need not be NUL terminated.
+ * @param len Its length in bytes, below 4 GiB.
+ * @param out_value Receives the value, to be released with pvar_destroy().
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pvars_parse_json(const char *json, size_t len, pvar_t *out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (!pjson_parse(NULL, json, len, out_value)) {
+		return false;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Parses a JSON text like pvars_parse_json(), allocating every list
+ * and dict, and the strings inside them, from an arena.
+ *
+ * Building the tree costs more than reading the text on the heap; an
+ * arena takes most of that away for documents that are read and dropped.
+ * pvar_destroy() on the value only frees a string at the top level; the
+ * rest goes with the arena (see parena.h).
+ *
+ * @param arena The arena to allocate from, or NULL for the process wide allocator.
+ * @param json The text. It need not be NUL terminated.
+ * @param len Its length in bytes, below 4 GiB.
+ * @param out_value Receives the value.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pvars_parse_json_in(pvars_arena_t *arena, const char *json, size_t len, pvar_t *out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (!pjson_parse(arena != NULL ? parena_allocator(arena) : NULL, json, len, out_value)) {
+		return false;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
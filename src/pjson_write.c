@@ -0,0 +1,809 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<errno.h>
+#include<limits.h>
+#include<math.h>
+#include<stdint.h>
+#include<string.h>
+
+#if defined(_WIN32)
+#include<io.h>
+#else
+#include<unistd.h>
+#endif
+
+#include"pvars.h"
+#include"perrno.h"
+#include"pvars_internal.h"
+#include"plist_internal.h"
+#include"pdict_internal.h"
+#include"pmem_internal.h"
+#include"pstr_internal.h"
+#include"pserial_internal.h"
+#include"pjson_internal.h"
+
+/*
+ * Values to JSON text: pvars_to_json() and pvars_to_json_fd().
+ *
+ * Text is appended to a pvars_buffer_t. For a file descriptor the buffer
+ * is a private one, handed to write(2) whenever it passes
+ * PJSON_FLUSH_SIZE between two elements, so memory stays bounded by the
+ * largest string rather than by the document.
+ *
+ * Integers are formatted two digits at a time from a table. Doubles and
+ * floats are written with the fewest digits that read back to the same
+ * value, found with Grisu2 (Loitsch, "Printing Floating-Point Numbers
+ * Quickly and Accurately with Integers", 2010) in the layout RapidJSON
+ * uses: integers of 64 bits only, no locale, no printf(). Grisu2 always
+ * round-trips; on rare inputs it gives a digit more than the shortest.
+ *
+ * Mapping of values to JSON:
+ *
+ *   pdict_t               object, in table order
+ *   plist_t               array, typed lists included
+ *   PVAR_TYPE_STRING      string; quotes, backslashes and control
+ *                         characters are escaped, other bytes copied
+ *   PVAR_TYPE_INT, LONG   integer
+ *   PVAR_TYPE_DOUBLE, FLOAT  number with a fraction or an exponent, so
+ *                         that pvars_parse_json() reads a double back
+ *   PVAR_TYPE_NONE        null
+ *
+ * NaN and infinities have no JSON form and are refused.
+ */
+
+#define PJSON_FLUSH_SIZE (64u * 1024u) /* Output held before write(2) is called */
+#define PJSON_NUMBER_MAX 32            /* Longest number written: sign, 17 digits, '.', zeros, exponent */
+#define PJSON_ESCAPE_MAX 6             /* Longest escape, \u00XX */
+
+/* "00" to "99", for formatting integers two digits at a time */
+static const char pjson_digit_pairs[201] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+static const char pjson_hex_digits[] = "0123456789abcdef";
+
+static const uint64_t pjson_pow10[20] = {
+	1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull,
+	1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+	100000000000000ull, 1000000000000000ull, 10000000000000000ull, 100000000000000000ull,
+	1000000000000000000ull, 10000000000000000000ull
+};
+
+/**
+ * @brief State of pvars_to_json() and pvars_to_json_fd().
+ */
+typedef struct {
+	pvars_buffer_t *buffer;
+	int fd;                 // Descriptor the buffer is flushed to, or -1
+	pvars_json_style style;
+	size_t depth;           // Arrays and objects entered, for indentation
+} pjson_writer_t;
+
+/* --- Numbers --- */
+
+/**
+ * @brief Writes the decimal digits of value.
+ *
+ * @return The number of characters written, at most 20.
+ */
+static size_t pjson_put_uint(char *out, uint64_t value)
+{
+	char digits[20];
+	char *p = digits + sizeof(digits);
+
+	while (value >= 100) {
+		size_t pair = (size_t)(value % 100) * 2;
+		value /= 100;
+		p -= 2;
+		memcpy(p, pjson_digit_pairs + pair, 2);
+	}
+	if (value >= 10) {
+		p -= 2;
+		memcpy(p, pjson_digit_pairs + value * 2, 2);
+	} else {
+		*--p = (char)('0' + value);
+	}
+
+	size_t len = (size_t)(digits + sizeof(digits) - p);
+	memcpy(out, p, len);
+	return len;
+}
+
+static size_t pjson_put_long(char *out, long value)
+{
+	if (value < 0) {
+		*out = '-';
+		return 1 + pjson_put_uint(out + 1, 0 - (uint64_t)value);
+	}
+	return pjson_put_uint(out, (uint64_t)value);
+}
+
+/**
+ * @brief A floating point number f * 2^e with a 64-bit significand, the
+ * working type of Grisu2.
+ */
+typedef struct {
+	uint64_t f;
+	int e;
+} pjson_diyfp_t;
+
+/* 10^k for k = -348, -340, ..., 340, normalised, rounded to nearest */
+static const pjson_diyfp_t pjson_cached_powers[] = {
+	{ 0xfa8fd5a0081c0288ull, -1220 }, { 0xbaaee17fa23ebf76ull, -1193 }, { 0x8b16fb203055ac76ull, -1166 },
+	{ 0xcf42894a5dce35eaull, -1140 }, { 0x9a6bb0aa55653b2dull, -1113 }, { 0xe61acf033d1a45dfull, -1087 },
+	{ 0xab70fe17c79ac6caull, -1060 }, { 0xff77b1fcbebcdc4full, -1034 }, { 0xbe5691ef416bd60cull, -1007 },
+	{ 0x8dd01fad907ffc3cull, -980 }, { 0xd3515c2831559a83ull, -954 }, { 0x9d71ac8fada6c9b5ull, -927 },
+	{ 0xea9c227723ee8bcbull, -901 }, { 0xaecc49914078536dull, -874 }, { 0x823c12795db6ce57ull, -847 },
+	{ 0xc21094364dfb5637ull, -821 }, { 0x9096ea6f3848984full, -794 }, { 0xd77485cb25823ac7ull, -768 },
+	{ 0xa086cfcd97bf97f4ull, -741 }, { 0xef340a98172aace5ull, -715 }, { 0xb23867fb2a35b28eull, -688 },
+	{ 0x84c8d4dfd2c63f3bull, -661 }, { 0xc5dd44271ad3cdbaull, -635 }, { 0x936b9fcebb25c996ull, -608 },
+	{ 0xdbac6c247d62a584ull, -582 }, { 0xa3ab66580d5fdaf6ull, -555 }, { 0xf3e2f893dec3f126ull, -529 },
+	{ 0xb5b5ada8aaff80b8ull, -502 }, { 0x87625f056c7c4a8bull, -475 }, { 0xc9bcff6034c13053ull, -449 },
+	{ 0x964e858c91ba2655ull, -422 }, { 0xdff9772470297ebdull, -396 }, { 0xa6dfbd9fb8e5b88full, -369 },
+	{ 0xf8a95fcf88747d94ull, -343 }, { 0xb94470938fa89bcfull, -316 }, { 0x8a08f0f8bf0f156bull, -289 },
+	{ 0xcdb02555653131b6ull, -263 }, { 0x993fe2c6d07b7facull, -236 }, { 0xe45c10c42a2b3b06ull, -210 },
+	{ 0xaa242499697392d3ull, -183 }, { 0xfd87b5f28300ca0eull, -157 }, { 0xbce5086492111aebull, -130 },
+	{ 0x8cbccc096f5088ccull, -103 }, { 0xd1b71758e219652cull, -77 }, { 0x9c40000000000000ull, -50 },
+	{ 0xe8d4a51000000000ull, -24 }, { 0xad78ebc5ac620000ull, 3 }, { 0x813f3978f8940984ull, 30 },
+	{ 0xc097ce7bc90715b3ull, 56 }, { 0x8f7e32ce7bea5c70ull, 83 }, { 0xd5d238a4abe98068ull, 109 },
+	{ 0x9f4f2726179a2245ull, 136 }, { 0xed63a231d4c4fb27ull, 162 }, { 0xb0de65388cc8ada8ull, 189 },
+	{ 0x83c7088e1aab65dbull, 216 }, { 0xc45d1df942711d9aull, 242 }, { 0x924d692ca61be758ull, 269 },
+	{ 0xda01ee641a708deaull, 295 }, { 0xa26da3999aef774aull, 322 }, { 0xf209787bb47d6b85ull, 348 },
+	{ 0xb454e4a179dd1877ull, 375 }, { 0x865b86925b9bc5c2ull, 402 }, { 0xc83553c5c8965d3dull, 428 },
+	{ 0x952ab45cfa97a0b3ull, 455 }, { 0xde469fbd99a05fe3ull, 481 }, { 0xa59bc234db398c25ull, 508 },
+	{ 0xf6c69a72a3989f5cull, 534 }, { 0xb7dcbf5354e9beceull, 561 }, { 0x88fcf317f22241e2ull, 588 },
+	{ 0xcc20ce9bd35c78a5ull, 614 }, { 0x98165af37b2153dfull, 641 }, { 0xe2a0b5dc971f303aull, 667 },
+	{ 0xa8d9d1535ce3b396ull, 694 }, { 0xfb9b7cd9a4a7443cull, 720 }, { 0xbb764c4ca7a44410ull, 747 },
+	{ 0x8bab8eefb6409c1aull, 774 }, { 0xd01fef10a657842cull, 800 }, { 0x9b10a4e5e9913129ull, 827 },
+	{ 0xe7109bfba19c0c9dull, 853 }, { 0xac2820d9623bf429ull, 880 }, { 0x80444b5e7aa7cf85ull, 907 },
+	{ 0xbf21e44003acdd2dull, 933 }, { 0x8e679c2f5e44ff8full, 960 }, { 0xd433179d9c8cb841ull, 986 },
+	{ 0x9e19db92b4e31ba9ull, 1013 }, { 0xeb96bf6ebadf77d9ull, 1039 }, { 0xaf87023b9bf0ee6bull, 1066 }
+};
+
+/**
+ * @brief Returns the upper 64 bits of the product, rounded.
+ */
+static pjson_diyfp_t pjson_multiply(pjson_diyfp_t x, pjson_diyfp_t y)
+{
+	pjson_diyfp_t product;
+
+#if defined(__SIZEOF_INT128__)
+	__uint128_t full = (__uint128_t)x.f * y.f;
+	uint64_t high = (uint64_t)(full >> 64);
+	uint64_t low = (uint64_t)full;
+	product.f = high + (low >> 63);
+#else
+	uint64_t a = x.f >> 32, b = x.f & 0xFFFFFFFFu, c = y.f >> 32, d = y.f & 0xFFFFFFFFu;
+	uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+	uint64_t middle = (bd >> 32) + (ad & 0xFFFFFFFFu) + (bc & 0xFFFFFFFFu);
+	middle += 1u << 31; /* Rounding */
+	product.f = ac + (ad >> 32) + (bc >> 32) + (middle >> 32);
+#endif
+
+	product.e = x.e + y.e + 64;
+	return product;
+}
+
+static pjson_diyfp_t pjson_normalize(pjson_diyfp_t x)
+{
+	int shift = __builtin_clzll(x.f);
+	x.f <<= shift;
+	x.e -= shift;
+	return x;
+}
+
+/**
+ * @brief Returns a cached power of ten c = 10^-K whose product with a
+ * number of binary exponent e has its exponent in [-60, -32], so that
+ * the integral part of the product fits in 32 bits.
+ */
+static pjson_diyfp_t pjson_cached_power(int e, int *out_k)
+{
+	double dk = (-61 - e) * 0.30102999566398114 + 347; /* log10(2) */
+	int k = (int)dk;
+	if (dk - k > 0.0) {
+		k++;
+	}
+
+	unsigned index = (unsigned)((k >> 3) + 1);
+	*out_k = -(-348 + (int)(index << 3));
+	return pjson_cached_powers[index];
+}
+
+/**
+ * @brief Moves the last digit down while that brings the number closer to
+ * the exact value and keeps it inside the rounding interval.
+ */
+static void pjson_grisu_round(char *digits, int len, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t distance)
+{
+	while (rest < distance && delta - rest >= ten_kappa
+		&& (rest + ten_kappa < distance || distance - rest > rest + ten_kappa - distance)) {
+		digits[len - 1]--;
+		rest += ten_kappa;
+	}
+}
+
+static int pjson_count_digits(uint32_t n)
+{
+	int count = 1;
+	while (count < 10 && n >= pjson_pow10[count]) {
+		count++;
+	}
+	return count;
+}
+
+/**
+ * @brief Generates the digits of the scaled number w, stopping as soon as
+ * they identify a number within delta of the upper boundary high.
+ */
+static int pjson_grisu_digits(pjson_diyfp_t w, pjson_diyfp_t high, uint64_t delta, char *digits, int *k)
+{
+	const pjson_diyfp_t one = { 1ull << -high.e, high.e };
+	const uint64_t distance = high.f - w.f;
+	uint32_t integral = (uint32_t)(high.f >> -one.e);
+	uint64_t fraction = high.f & (one.f - 1);
+	int kappa = pjson_count_digits(integral);
+	int len = 0;
+
+	while (kappa > 0) {
+		uint32_t power = (uint32_t)pjson_pow10[kappa - 1];
+		uint32_t digit = integral / power;
+		integral %= power;
+		if (digit != 0 || len != 0) {
+			digits[len++] = (char)('0' + digit);
+		}
+		kappa--;
+
+		uint64_t rest = ((uint64_t)integral << -one.e) + fraction;
+		if (rest <= delta) {
+			*k += kappa;
+			pjson_grisu_round(digits, len, delta, rest, pjson_pow10[kappa] << -one.e, distance);
+			return len;
+		}
+	}
+
+	for (;;) {
+		fraction *= 10;
+		delta *= 10;
+		char digit = (char)(fraction >> -one.e);
+		if (digit != 0 || len != 0) {
+			digits[len++] = (char)('0' + digit);
+		}
+		fraction &= one.f - 1;
+		kappa--;
+
+		if (fraction < delta) {
+			*k += kappa;
+			int index = -kappa;
+			pjson_grisu_round(digits, len, delta, fraction, one.f, distance * (index < 20 ? pjson_pow10[index] : 0));
+			return len;
+		}
+	}
+}
+
+/**
+ * @brief Finds the shortest digits of the positive number f * 2^e, within
+ * the interval of numbers that round to it.
+ *
+ * @param f Significand, with the hidden bit of a normal number set.
+ * @param e Binary exponent.
+ * @param lower_closer True if the next number down is closer than the next
+ * one up (f is a power of two above the smallest normal number).
+ * @param digits Receives the digits, at most 17.
+ * @param out_k Receives the decimal exponent: the value is digits * 10^k.
+ * @return The number of digits.
+ */
+static int pjson_grisu2(uint64_t f, int e, bool lower_closer, char *digits, int *out_k)
+{
+	pjson_diyfp_t high = pjson_normalize((pjson_diyfp_t){ (f << 1) + 1, e - 1 });
+	pjson_diyfp_t low = lower_closer ? (pjson_diyfp_t){ (f << 2) - 1, e - 2 } : (pjson_diyfp_t){ (f << 1) - 1, e - 1 };
+	low.f <<= low.e - high.e;
+	low.e = high.e;
+
+	pjson_diyfp_t power = pjson_cached_power(high.e, out_k);
+	pjson_diyfp_t w = pjson_multiply(pjson_normalize((pjson_diyfp_t){ f, e }), power);
+	pjson_diyfp_t scaled_high = pjson_multiply(high, power);
+	pjson_diyfp_t scaled_low = pjson_multiply(low, power);
+
+	/* Stay strictly inside the interval despite the rounding of the products */
+	scaled_low.f++;
+	scaled_high.f--;
+
+	return pjson_grisu_digits(w, scaled_high, scaled_high.f - scaled_low.f, digits, out_k);
+}
+
+static size_t pjson_put_exponent(char *out, int k)
+{
+	size_t len = 0;
+
+	if (k < 0) {
+		out[len++] = '-';
+		k = -k;
+	}
+	return len + pjson_put_uint(out + len, (uint64_t)k);
+}
+
+/**
+ * @brief Lays out len digits with decimal exponent k (the value is
+ * digits * 10^k) as a JSON number that keeps a fraction or an exponent:
+ * 1200.0, 1.25, 0.00125 or 1.25e-7.
+ *
+ * @param out Holds the digits on entry; needs PJSON_NUMBER_MAX bytes.
+ * @return The number of characters.
+ */
+static size_t pjson_prettify(char *out, int len, int k)
+{
+	int point = len + k; /* 10^(point - 1) <= value < 10^point */
+
+	if (k >= 0 && point <= 21) {
+		/* Integral: digits, zeros, ".0" */
+		memset(out + len, '0', (size_t)k);
+		out[point] = '.';
+		out[point + 1] = '0';
+		return (size_t)point + 2;
+	}
+	if (point > 0 && point <= 21) {
+		memmove(out + point + 1, out + point, (size_t)(len - point));
+		out[point] = '.';
+		return (size_t)len + 1;
+	}
+	if (point > -6 && point <= 0) {
+		int offset = 2 - point;
+		memmove(out + offset, out, (size_t)len);
+		out[0] = '0';
+		out[1] = '.';
+		memset(out + 2, '0', (size_t)(offset - 2));
+		return (size_t)(len + offset);
+	}
+	if (len == 1) {
+		out[1] = 'e';
+		return 2 + pjson_put_exponent(out + 2, point - 1);
+	}
+
+	memmove(out + 2, out + 1, (size_t)len - 1);
+	out[1] = '.';
+	out[len + 1] = 'e';
+	return (size_t)len + 2 + pjson_put_exponent(out + len + 2, point - 1);
+}
+
+/**
+ * @brief Writes a finite number given by its sign, significand and binary
+ * exponent.
+ */
+static size_t pjson_put_real(char *out, bool negative, uint64_t f, int e, bool lower_closer)
+{
+	size_t len = 0;
+
+	if (negative) {
+		out[len++] = '-';
+	}
+	if (f == 0) {
+		memcpy(out + len, "0.0", 3);
+		return len + 3;
+	}
+
+	int k;
+	int digits = pjson_grisu2(f, e, lower_closer, out + len, &k);
+	return len + pjson_prettify(out + len, digits, k);
+}
+
+static size_t pjson_put_double(char *out, double value)
+{
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	uint64_t mantissa = bits & ((1ull << 52) - 1);
+	int biased = (int)((bits >> 52) & 0x7FF);
+	bool negative = (bits >> 63) != 0;
+
+	if (biased == 0) {
+		return pjson_put_real(out, negative, mantissa, -1074, false);
+	}
+	return pjson_put_real(out, negative, mantissa | 1ull << 52, biased - 1075, mantissa == 0 && biased > 1);
+}
+
+/**
+ * @brief Writes the shortest digits that read back to value as a float.
+ */
+static size_t pjson_put_float(char *out, float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	uint64_t mantissa = bits & ((1u << 23) - 1);
+	int biased = (int)((bits >> 23) & 0xFF);
+	bool negative = (bits >> 31) != 0;
+
+	if (biased == 0) {
+		return pjson_put_real(out, negative, mantissa, -149, false);
+	}
+	return pjson_put_real(out, negative, mantissa | 1u << 23, biased - 150, mantissa == 0 && biased > 1);
+}
+
+/* --- Text --- */
+
+static bool pjson_reserve(pjson_writer_t *writer, size_t extra)
+{
+	return pvars_buffer_reserve(writer->buffer, extra, FAILURE_PVARS_TO_JSON_REALLOC_FAILED);
+}
+
+/* The writers below expect the caller to have reserved room for them */
+
+static void pjson_put_byte(pjson_writer_t *writer, char byte)
+{
+	writer->buffer->data[writer->buffer->size++] = (unsigned char)byte;
+}
+
+static void pjson_put_bytes(pjson_writer_t *writer, const void *bytes, size_t len)
+{
+	memcpy(writer->buffer->data + writer->buffer->size, bytes, len);
+	writer->buffer->size += len;
+}
+
+/**
+ * @brief Writes up to len bytes to a descriptor, through _write() on
+ * Windows.
+ *
+ * @return Bytes written, or -1 on failure (with errno set).
+ */
+static long pjson_write_fd(int fd, const void *data, size_t len)
+{
+#if defined(_WIN32)
+	/* _write() takes an unsigned int count */
+	return _write(fd, data, len < INT_MAX ? (unsigned int)len : INT_MAX);
+#else
+	return (long)write(fd, data, len);
+#endif
+}
+
+/**
+ * @brief Hands everything in the buffer to write(2) and empties it.
+ * Interrupted and partial writes are resumed.
+ *
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+static bool pjson_flush(pjson_writer_t *writer)
+{
+	pvars_buffer_t *buffer = writer->buffer;
+	size_t done = 0;
+
+	while (done < buffer->size) {
+		long written = pjson_write_fd(writer->fd, buffer->data + done, buffer->size - done);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			pvars_errno = FAILURE_PVARS_TO_JSON_WRITE_FAILED;
+			return false;
+		}
+		done += (size_t)written;
+	}
+
+	buffer->size = 0;
+	return true;
+}
+
+/**
+ * @brief Flushes a full buffer when writing to a descriptor. Called between
+ * elements.
+ */
+static bool pjson_after_element(pjson_writer_t *writer)
+{
+	return writer->fd < 0 || writer->buffer->size < PJSON_FLUSH_SIZE || pjson_flush(writer);
+}
+
+/**
+ * @brief Starts a new line at the current depth, in the pretty style.
+ */
+static bool pjson_put_newline(pjson_writer_t *writer)
+{
+	if (writer->style != PVARS_JSON_PRETTY) {
+		return true;
+	}
+
+	if (!pjson_reserve(writer, 1 + 2 * writer->depth)) {
+		return false;
+	}
+	pjson_put_byte(writer, '\n');
+	memset(writer->buffer->data + writer->buffer->size, ' ', 2 * writer->depth);
+	writer->buffer->size += 2 * writer->depth;
+	return true;
+}
+
+/**
+ * @brief Writes a quoted string. Runs without anything to escape, found
+ * eight bytes at a time, are copied whole.
+ */
+static bool pjson_put_string(pjson_writer_t *writer, const char *bytes, size_t len)
+{
+	const unsigned char *p = (const unsigned char *)bytes;
+	const unsigned char *end = p + len;
+
+	if (len > SIZE_MAX - 2 || !pjson_reserve(writer, len + 2)) {
+		pvars_errno = FAILURE_PVARS_TO_JSON_REALLOC_FAILED;
+		return false;
+	}
+	pjson_put_byte(writer, '"');
+
+	for (;;) {
+		const unsigned char *special = pjson_scan_string(p, end);
+		pjson_put_bytes(writer, p, (size_t)(special - p));
+		p = special;
+		if (p == end) {
+			break;
+		}
+
+		/* The escape replaces one byte; the rest and the closing quote are still reserved */
+		if (!pjson_reserve(writer, PJSON_ESCAPE_MAX + (size_t)(end - p))) {
+			return false;
+		}
+
+		char escape = 0;
+		switch (*p) {
+			case '"': escape = '"'; break;
+			case '\\': escape = '\\'; break;
+			case '\b': escape = 'b'; break;
+			case '\f': escape = 'f'; break;
+			case '\n': escape = 'n'; break;
+			case '\r': escape = 'r'; break;
+			case '\t': escape = 't'; break;
+			default: break;
+		}
+
+		pjson_put_byte(writer, '\\');
+		if (escape != 0) {
+			pjson_put_byte(writer, escape);
+		} else {
+			char code[5] = { 'u', '0', '0', pjson_hex_digits[*p >> 4], pjson_hex_digits[*p & 0xF] };
+			pjson_put_bytes(writer, code, sizeof(code));
+		}
+		p++;
+	}
+
+	pjson_put_byte(writer, '"');
+	return true;
+}
+
+/* --- Values --- */
+
+static bool pjson_write_value(pjson_writer_t *writer, const pvar_t *value);
+
+/**
+ * @brief Writes an array, one element per line in the pretty style.
+ */
+static bool pjson_write_list(pjson_writer_t *writer, const plist_t *list)
+{
+	if (!pjson_reserve(writer, 2)) {
+		return false;
+	}
+	pjson_put_byte(writer, '[');
+	if (list->count == 0) {
+		pjson_put_byte(writer, ']');
+		return true;
+	}
+
+	writer->depth++;
+	for (size_t i = 0; i < list->count; i++) {
+		if (i > 0) {
+			if (!pjson_reserve(writer, 1)) {
+				return false;
+			}
+			pjson_put_byte(writer, ',');
+		}
+
+		pvar_t scratch;
+		if (!pjson_put_newline(writer) || !pjson_write_value(writer, plist_element(list, i, &scratch)) || !pjson_after_element(writer)) {
+			return false;
+		}
+	}
+	writer->depth--;
+
+	if (!pjson_put_newline(writer) || !pjson_reserve(writer, 1)) {
+		return false;
+	}
+	pjson_put_byte(writer, ']');
+	return true;
+}
+
+/**
+ * @brief Writes an object, its members in table order.
+ */
+static bool pjson_write_dict(pjson_writer_t *writer, const pdict_t *dict)
+{
+	if (!pjson_reserve(writer, 2)) {
+		return false;
+	}
+	pjson_put_byte(writer, '{');
+	if (dict->count == 0) {
+		pjson_put_byte(writer, '}');
+		return true;
+	}
+
+	pdict_iter_t iter;
+	const char *key;
+	pvar_t *value;
+	bool first = true;
+
+	writer->depth++;
+	pdict_iter_init(&iter, dict);
+	while (pdict_iter_next(&iter, &key, &value)) {
+		if (!first) {
+			if (!pjson_reserve(writer, 1)) {
+				return false;
+			}
+			pjson_put_byte(writer, ',');
+		}
+		first = false;
+
+		if (!pjson_put_newline(writer) || !pjson_put_string(writer, key, pstr_len(key)) || !pjson_reserve(writer, 2)) {
+			return false;
+		}
+		pjson_put_byte(writer, ':');
+		if (writer->style == PVARS_JSON_PRETTY) {
+			pjson_put_byte(writer, ' ');
+		}
+
+		if (!pjson_write_value(writer, value) || !pjson_after_element(writer)) {
+			return false;
+		}
+	}
+	writer->depth--;
+
+	if (!pjson_put_newline(writer) || !pjson_reserve(writer, 1)) {
+		return false;
+	}
+	pjson_put_byte(writer, '}');
+	return true;
+}
+
+/**
+ * @brief Writes one value, as stored in a list or dict.
+ *
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+static bool pjson_write_value(pjson_writer_t *writer, const pvar_t *value)
+{
+	if (value->type == PVAR_TYPE_STRING) {
+		return pjson_put_string(writer, pvar_str(value), pvar_str_len(value));
+	}
+	if (value->type == PVAR_TYPE_LIST) {
+		return pjson_write_list(writer, value->data.ls);
+	}
+	if (value->type == PVAR_TYPE_DICT) {
+		return pjson_write_dict(writer, value->data.dt);
+	}
+
+	if (!pjson_reserve(writer, PJSON_NUMBER_MAX)) {
+		return false;
+	}
+
+	char *out = (char *)writer->buffer->data + writer->buffer->size;
+	size_t len;
+
+	switch (value->type) {
+		case PVAR_TYPE_NONE:
+			memcpy(out, "null", 4);
+			len = 4;
+			break;
+		case PVAR_TYPE_INT:
+			len = pjson_put_long(out, value->data.i);
+			break;
+		case PVAR_TYPE_LONG:
+			len = pjson_put_long(out, value->data.l);
+			break;
+		case PVAR_TYPE_DOUBLE:
+			if (!isfinite(value->data.d)) {
+				pvars_errno = FAILURE_PVARS_TO_JSON_NOT_FINITE;
+				return false;
+			}
+			len = pjson_put_double(out, value->data.d);
+			break;
+		case PVAR_TYPE_FLOAT:
+			if (!isfinite(value->data.f)) {
+				pvars_errno = FAILURE_PVARS_TO_JSON_NOT_FINITE;
+				return false;
+			}
+			len = pjson_put_float(out, value->data.f);
+			break;
+		default:
+			pvars_errno = FAILURE_PVARS_TO_JSON_UNKNOWN_TYPE;
+			return false;
+	}
+
+	writer->buffer->size += len;
+	return true;
+}
+
+/**
+ * @brief Appends the JSON text of a value to a buffer.
+ *
+ * Dicts become objects (members in table order), lists arrays, strings
+ * strings, ints and longs integers, doubles and floats numbers with the
+ * fewest digits that read back exactly, and empty values null. Doubles
+ * and floats always carry a fraction or an exponent (1.0, 2.5e-7, 1e30),
+ * so that pvars_parse_json() gives doubles back.
+ *
+ * @param value The value to write: a plist_t or pdict_t wrapped in a
+ * pvar_t (.type PVAR_TYPE_LIST with .data.ls, or PVAR_TYPE_DICT with
+ * .data.dt), or any other value.
+ * @param buffer An initialised buffer. Nothing is appended on failure.
+ * @param style PVARS_JSON_COMPACT or PVARS_JSON_PRETTY.
+ * @return True on success, False on failure (with pvars_errno set), in
+ * particular for a NaN or an infinity.
+ */
+bool pvars_to_json(const pvar_t *value, pvars_buffer_t *buffer, pvars_json_style style)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (value == NULL || buffer == NULL || buffer->allocator == NULL) {
+		pvars_errno = FAILURE_PVARS_TO_JSON_NULL_INPUT;
+		return false;
+	}
+
+	if (style != PVARS_JSON_COMPACT && style != PVARS_JSON_PRETTY) {
+		pvars_errno = FAILURE_PVARS_TO_JSON_UNKNOWN_STYLE;
+		return false;
+	}
+
+	size_t start = buffer->size;
+
+	/* A caller's value keeps its string in data.s */
+	pvar_t root = *value;
+	root.str_tag = PVAR_STR_PLAIN;
+
+	pjson_writer_t writer = { buffer, -1, style, 0 };
+	if (!pjson_write_value(&writer, &root)) {
+		buffer->size = start;
+		return false;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Writes the JSON text of a value to a file descriptor, as
+ * pvars_to_json() would lay it out, through a buffer of PJSON_FLUSH_SIZE
+ * bytes.
+ *
+ * @param value The value to write.
+ * @param fd An open descriptor: a file, pipe or socket. It is not closed.
+ * @param style PVARS_JSON_COMPACT or PVARS_JSON_PRETTY.
+ * @return True on success, False on failure (with pvars_errno set). Part
+ * of the text may have been written when a failure is reported.
+ */
+bool pvars_to_json_fd(const pvar_t *value, int fd, pvars_json_style style)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (value == NULL || fd < 0) {
+		pvars_errno = FAILURE_PVARS_TO_JSON_NULL_INPUT;
+		return false;
+	}
+
+	if (style != PVARS_JSON_COMPACT && style != PVARS_JSON_PRETTY) {
+		pvars_errno = FAILURE_PVARS_TO_JSON_UNKNOWN_STYLE;
+		return false;
+	}
+
+	pvars_buffer_t buffer;
+	pvars_buffer_init(&buffer);
+
+	pvar_t root = *value;
+	root.str_tag = PVAR_STR_PLAIN;
+
+	pjson_writer_t writer = { &buffer, fd, style, 0 };
+	bool done = pjson_write_value(&writer, &root) && pjson_flush(&writer);
+
+	pvars_buffer_release(&buffer);
+
+	if (!done) {
+		return false;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
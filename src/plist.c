@@ -1,5 +1,7 @@
 #define _POSIX_C_SOURCE 200809L
 
+#include<stdatomic.h>
+#include<stdint.h>
 #include<stdlib.h>
 #include<string.h>
 
@@ -7,6 +9,10 @@
 #include"perrno.h"
 #include"pvars_internal.h"
 #include"plist_internal.h"
+#include"pmem_internal.h"
+#include"pstr_internal.h"
+
+static plist_t *plist_create_column(const pvars_allocator_t *allocator, long int initial_capacity, pvar_type column);
 
 /**
  * @brief Creates and initializes a new plist_t structure.
@@ -20,6 +26,81 @@
  * @return A pointer to the newly created plist_t structure, or NULL on failure.
  */
 plist_t *plist_create(long int initial_capacity)
+{
+	return plist_create_in(NULL, initial_capacity);
+}
+
+/**
+ * @brief Creates a new plist_t structure whose memory comes from an arena.
+ *
+ * The elements array, every string added to the list and every list or
+ * dict copied into it are allocated from arena. plist_destroy() is then a
+ * no-op: the whole tree is released with the arena (see parena.h).
+ * Functions that return new data to the caller, such as plist_get_str(),
+ * still allocate it on the heap.
+ *
+ * @param arena The arena to allocate from, or NULL for the process wide allocator.
+ * @param initial_capacity The starting capacity for the list. Must be >= 1.
+ * @return A pointer to the newly created plist_t structure, or NULL on failure.
+ */
+plist_t *plist_create_in(pvars_arena_t *arena, long int initial_capacity)
+{
+	return plist_create_with_allocator(arena != NULL ? parena_allocator(arena) : NULL, initial_capacity);
+}
+
+/**
+ * @brief Creates a new plist_t structure whose memory comes from the given
+ * allocator.
+ *
+ * The list keeps the allocator for its whole life: the elements array,
+ * strings and nested copies are allocated with it and returned to it.
+ *
+ * @param allocator The allocator to use, or NULL for the process wide one
+ * (see pvars_set_allocator()). It must outlive the list.
+ * @param initial_capacity The starting capacity for the list. Must be >= 1.
+ * @return A pointer to the newly created plist_t structure, or NULL on failure.
+ */
+plist_t *plist_create_with_allocator(const pvars_allocator_t *allocator, long int initial_capacity)
+{
+	return plist_create_column(allocator, initial_capacity, PVAR_TYPE_NONE);
+}
+
+/**
+ * @brief Creates a typed list: every element has the given numeric type and
+ * is stored unboxed, so a list of doubles is a packed double[] rather than
+ * an array of 16-byte pvar_t.
+ *
+ * The usual accessors work unchanged (plist_add_double(), plist_get_double(),
+ * plist_set_double(), insert, remove, pop, copy...), and values of any other
+ * type are refused with FAILURE_PLIST_TYPED_LIST_TYPE_MISMATCH.
+ * plist_borrow_span() exposes the numbers for numeric code without copying.
+ *
+ * @param type PVAR_TYPE_INT, PVAR_TYPE_LONG, PVAR_TYPE_DOUBLE or PVAR_TYPE_FLOAT.
+ * @param initial_capacity The starting capacity for the list. Must be >= 1.
+ * @return A pointer to the newly created plist_t structure, or NULL on failure.
+ */
+plist_t *plist_create_typed(pvar_type type, long int initial_capacity)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (type != PVAR_TYPE_INT && type != PVAR_TYPE_LONG && type != PVAR_TYPE_DOUBLE && type != PVAR_TYPE_FLOAT) {
+		pvars_errno = FAILURE_PLIST_CREATE_TYPED_UNSUPPORTED_TYPE;
+		return NULL;
+	}
+
+	return plist_create_column(NULL, initial_capacity, type);
+}
+
+/**
+ * @brief Creates a list of pvar_t, or a typed list if column is a numeric
+ * type.
+ *
+ * @param allocator The allocator to use, or NULL for the process wide one.
+ * @param initial_capacity The starting capacity for the list. Must be >= 1.
+ * @param column PVAR_TYPE_NONE, or the type of every element.
+ * @return A pointer to the newly created plist_t structure, or NULL on failure.
+ */
+static plist_t *plist_create_column(const pvars_allocator_t *allocator, long int initial_capacity, pvar_type column)
 {
 	pvars_errno = PERRNO_CLEAR;
 	
@@ -28,32 +109,85 @@ plist_t *plist_create(long int initial_capacity)
 		return NULL;
 	}
 
-	plist_t *new_list = malloc(sizeof(plist_t));
+	if (allocator == NULL) {
+		allocator = pmem_default();
+	}
+
+	plist_t *new_list = pmem_malloc(allocator, sizeof(plist_t));
 	if (new_list == NULL) {
 		pvars_errno = FAILURE_PLIST_CREATE_NEW_LIST_MALLOC_FAILED;
 		return NULL;
 	}
 
+	size_t width = sizeof(pvar_t);
+
+	switch (column) {
+		case PVAR_TYPE_INT:
+			width = sizeof(int);
+			break;
+		case PVAR_TYPE_LONG:
+			width = sizeof(long);
+			break;
+		case PVAR_TYPE_DOUBLE:
+			width = sizeof(double);
+			break;
+		case PVAR_TYPE_FLOAT:
+			width = sizeof(float);
+			break;
+		default:
+			break;
+	}
+
 	// Use calloc for pvar_t structs: initializes type to PVAR_TYPE_NONE (0) and data union to zero (NULL pointer)
-	new_list->elements = calloc((size_t)initial_capacity, sizeof(pvar_t));
-	if (new_list->elements == NULL) {
-		free(new_list);
+	new_list->values = pmem_calloc(allocator, (size_t)initial_capacity, width);
+	if (new_list->values == NULL) {
+		pmem_free(allocator, new_list, sizeof(plist_t));
 		pvars_errno = FAILURE_PLIST_CREATE_NEW_LIST_DATA_MALLOC_FAILED;
 		return NULL;
 	}
 	
 	new_list->capacity = (size_t)initial_capacity;
+	new_list->front = 0;
+	new_list->width = width;
+	new_list->column = column;
 	new_list->count = 0;
+	new_list->allocator = allocator;
+	new_list->growth = PLIST_GROWTH_DOUBLE;
+	new_list->growth_chunk = 0;
+	new_list->indexed = false;
+	atomic_init(&new_list->index, NULL);
+	new_list->lent = false;
+	atomic_init(&new_list->share, NULL);
 
 	return new_list;
 }
 
 /**
- * @brief Deep copy a list.
+ * @brief Copy a list.
+ *
+ * The copy behaves as an independent deep copy, but costs O(1): it shares
+ * the elements of src until either list is modified, and the first change
+ * through either one copies the elements for that list alone. Nested lists
+ * and dicts are shared the same way, so only the path that is written to
+ * is ever copied. Lists in an arena are copied eagerly.
  *
  * @param list of elements
  */
 plist_t *plist_copy(const plist_t *src)
+{
+	return plist_copy_in(NULL, src);
+}
+
+/**
+ * @brief Copy a list with the given allocator (NULL for the process wide
+ * one). The copy shares the elements of src if both use the same allocator
+ * (see plist_copy()), and is a deep copy otherwise.
+ *
+ * @param allocator Where the copy is allocated.
+ * @param src The list to copy.
+ * @return The copy, or NULL on failure.
+ */
+plist_t *plist_copy_in(const pvars_allocator_t *allocator, const plist_t *src)
 {
 	/* pvars_errno must be clear on each call to determine if pvar_copy fails recursively. See pvar_copy */
 	pvars_errno = PERRNO_CLEAR;
@@ -61,8 +195,31 @@ plist_t *plist_copy(const plist_t *src)
 		pvars_errno = FAILURE_PLIST_COPY_NULL_INPUT;
 		return NULL;
 	}
+
+	if (allocator == NULL) {
+		allocator = pmem_default();
+	}
+
+	if (allocator == src->allocator && !parena_owns(allocator)) {
+		plist_t *new_list = pmem_malloc(allocator, sizeof(plist_t));
+		/* Sharing only records another handle, src is left as it was */
+		pshare_t *share = new_list != NULL ? pshare_acquire(allocator, &((plist_t *)src)->share) : NULL;
+
+		if (share == NULL) {
+			pmem_free(allocator, new_list, sizeof(plist_t));
+			pvars_errno = FAILURE_PLIST_COPY_PLIST_CREATE_FAILED;
+			return NULL;
+		}
+
+		memcpy(new_list, src, offsetof(plist_t, share));
+		atomic_init(&new_list->index, NULL);
+		atomic_init(&new_list->share, share);
+
+		pvars_errno = SUCCESS;
+		return new_list;
+	}
 	
-	plist_t *new_list = plist_create(src->capacity);
+	plist_t *new_list = plist_create_column(allocator, src->capacity, src->column);
 	
 	if (new_list == NULL) {
 		pvars_errno = FAILURE_PLIST_COPY_PLIST_CREATE_FAILED;
@@ -70,9 +227,18 @@ plist_t *plist_copy(const plist_t *src)
 	}
 	
 	new_list->count = src->count;
+	new_list->growth = src->growth;
+	new_list->growth_chunk = src->growth_chunk;
+	new_list->indexed = src->indexed;
+
+	if (src->column != PVAR_TYPE_NONE) {
+		memcpy(new_list->values, src->values, src->count * src->width);
+		pvars_errno = SUCCESS;
+		return new_list;
+	}
 	
 	for (size_t i = 0; i < src->count; i++) {
-		pvar_t new_var = pvar_copy(&src->elements[i]);
+		pvar_t new_var = pvar_copy_in(new_list->allocator, &src->elements[i]);
 		if (!(pvars_errno == SUCCESS)) {
 			pvars_errno = FAILURE_PLIST_COPY_PVAR_COPY_FAILED;
 			plist_destroy(new_list);
@@ -88,350 +254,2134 @@ plist_t *plist_copy(const plist_t *src)
 
 
 /**
- * @brief Ensures there is capacity for one more element, resizing if necessary.
- * * @param list The list to check.
- * @return True if capacity is available/resized successfully, false otherwise.
+ * @brief Returns the address of slot index of a list's array.
  */
-static bool plist_ensure_capacity(plist_t *list)
+static unsigned char *plist_slot(const plist_t *list, size_t index)
 {
-	if (list->count < list->capacity) {
-		pvars_errno = SUCCESS;
-		return true;
-	}
-
-	size_t old_capacity = list->capacity;
-	size_t new_capacity = list->capacity * 2;
-	
-	// Reallocate pvar_t array
-	pvar_t *new_elements = (pvar_t *)realloc(list->elements, new_capacity * sizeof(pvar_t));
-
-	if (new_elements == NULL) {
-		pvars_errno = FAILURE_PLIST_ADD_REALLOC_FAILED; 
-		return false;
-	}
-	
-	list->elements = new_elements;
-
-	// Initialize new memory slots to PVAR_TYPE_NONE (zeroing the entire struct is safe)
-	// We use list->elements + old_capacity to get the start of the new block
-	memset(list->elements + old_capacity, 0, (new_capacity - old_capacity) * sizeof(pvar_t));
-
-	list->capacity = new_capacity;
-	pvars_errno = SUCCESS;
-	return true;
+	return (unsigned char *)list->values + index * list->width;
 }
 
 /**
- * @brief Removes the element at a given index, shifting subsequent elements.
- *
- * Frees the data of the removed element, shifts the remaining elements down,
- * and decrements the count.
+ * @brief Destroys count elements and frees an elements array laid out like
+ * the list's own (same allocator, slot width and capacity).
  *
- * @param list The list to modify.
- * @param index The index of the element to remove.
+ * @param list The list the array belongs or belonged to.
+ * @param values The first element.
+ * @param front Number of unused slots before values.
+ * @param count Number of elements in use.
  */
-void plist_remove(plist_t *list, size_t index)
+static void plist_free_elements(const plist_t *list, void *values, size_t front, size_t count)
 {
-	pvars_errno = PERRNO_CLEAR;
+	if (list->column == PVAR_TYPE_NONE) {
+		pvar_t *elements = values;
 
-	if (list == NULL) {
-		pvars_errno = FAILURE_PLIST_REMOVE_NULL_INPUT;
-		return;
+		for (size_t i = 0; i < count; i++) {
+			pvar_destroy_in(list->allocator, &elements[i]);
+		}
 	}
 
-	if (index >= list->count) {
-		pvars_errno = FAILURE_PLIST_REMOVE_OUT_OF_BOUNDS;
+	pmem_free(list->allocator, (unsigned char *)values - front * list->width, (front + list->capacity) * list->width);
+}
+
+/**
+ * @brief Destroys count elements starting at index start. Values of a typed
+ * list own no memory and are left as they are.
+ */
+static void plist_release(plist_t *list, size_t start, size_t count)
+{
+	if (list->column != PVAR_TYPE_NONE) {
 		return;
 	}
 
-	pvar_destroy_internal(&list->elements[index]);
-
-	// Shift all subsequent elements down
-	for (size_t i = index; i < list->count - 1; i++) {
-		list->elements[i] = list->elements[i+1];
+	for (size_t i = start; i < start + count; i++) {
+		pvar_destroy_in(list->allocator, &list->elements[i]);
 	}
-
-	memset(&list->elements[list->count - 1], 0, sizeof(pvar_t));
-	
-	list->count--;
-	pvars_errno = SUCCESS;
 }
 
 /**
- * @brief Adds a single string to the list.
+ * @brief Gives the list elements of its own before it is modified, if it
+ * shares them with copies (see plist_copy()), and drops its hash index.
  *
- * The string is duplicated using strdup and stored in a new pvar_t element.
+ * The elements are copied shallowly: strings are duplicated, nested lists
+ * and dicts are shared again. The values of a typed list are copied as a
+ * block.
  *
- * @param list The list to add to.
- * @param value The string to add (will be duplicated).
+ * @param list The list about to be modified.
+ * @return True on success, false if the copy failed (with pvars_errno set).
  */
-void plist_add_str(plist_t *list, const char *value)
+static bool plist_unshare(plist_t *list)
 {
-	pvars_errno = PERRNO_CLEAR;
+	pshare_t *share = atomic_load(&list->share);
 
-	if (list == NULL) {
-		pvars_errno = FAILURE_PLIST_ADD_STR_NULL_INPUT_LIST;
-		return;
+	/* Every change goes through here, so the index never outlives one */
+	plist_index_drop(list);
+
+	if (share == NULL) {
+		return true;
 	}
 
-	if (value == NULL) {
-		pvars_errno = FAILURE_PLIST_ADD_STR_NULL_STRING_INPUT;
-		return;
+	if (!pshare_is_shared(share)) {
+		/* The other handles are gone, the elements are ours */
+		pshare_release(list->allocator, share);
+		atomic_store(&list->share, NULL);
+		return true;
 	}
 
-	/* Resize capacity if needed */
-	if (!plist_ensure_capacity(list)) {
-		// plist_ensure_capacity sets the error code
-		return;
+	void *values = pmem_calloc(list->allocator, list->capacity, list->width);
+	if (values == NULL) {
+		pvars_errno = FAILURE_PLIST_UNSHARE_COPY_FAILED;
+		return false;
 	}
 
-	// Store the string
-	char *new_str = strdup(value);
+	if (list->column != PVAR_TYPE_NONE) {
+		memcpy(values, list->values, list->count * list->width);
+	} else {
+		pvar_t *elements = values;
 
-	if (new_str == NULL) {
-		pvars_errno = FAILURE_PLIST_ADD_STR_STRDUP_FAILED;
-		return;
+		for (size_t i = 0; i < list->count; i++) {
+			elements[i] = pvar_copy_in(list->allocator, &list->elements[i]);
+			if (pvars_errno != SUCCESS) {
+				plist_free_elements(list, values, 0, i);
+				pvars_errno = FAILURE_PLIST_UNSHARE_COPY_FAILED;
+				return false;
+			}
+		}
 	}
 
-	// Populate the pvar_t struct fields
-	list->elements[list->count].data.s = new_str;
-	list->elements[list->count].type = PVAR_TYPE_STRING;
+	void *shared = list->values;
+	size_t shared_front = list->front;
+	list->values = values;
+	list->front = 0;
+	atomic_store(&list->share, NULL);
 
-	list->count++;
+	/* The other handles may all have let go while the elements were copied */
+	if (pshare_release(list->allocator, share)) {
+		plist_free_elements(list, shared, shared_front, list->count);
+	}
+
+	return true;
 }
 
 /**
- * @brief Adds a single integer value to the list.
+ * @brief Returns the capacity a list grows to under its growth policy in
+ * order to hold needed elements.
  *
- * @param list The list to add to.
- * @param value The integer value to store.
+ * @param list The list about to grow.
+ * @param needed Number of elements it must hold, more than its capacity.
+ * @return The new capacity, at least needed.
  */
-void plist_add_int(plist_t *list, int value)
+static size_t plist_grown_capacity(const plist_t *list, size_t needed)
 {
-	pvars_errno = PERRNO_CLEAR;
-	
-	if (list == NULL) {
-		pvars_errno = FAILURE_PLIST_ADD_INT_NULL_INPUT;
-		return;
+	const size_t max = SIZE_MAX / sizeof(pvar_t);
+	size_t capacity = list->capacity;
+
+	if (list->growth == PLIST_GROWTH_CHUNK) {
+		size_t chunks = (needed - capacity - 1) / list->growth_chunk + 1;
+		return chunks <= (max - capacity) / list->growth_chunk ? capacity + chunks * list->growth_chunk : needed;
 	}
 
-	/* Resize capacity if needed */
-	if (!plist_ensure_capacity(list)) {
-		// plist_ensure_capacity sets the error code (FAILURE_PLIST_ADD_REALLOC_FAILED)
-		return;
+	while (capacity < needed) {
+		size_t step = list->growth == PLIST_GROWTH_HALF ? (capacity + 1) / 2 : capacity;
+		capacity = step <= max - capacity ? capacity + step : needed;
 	}
-	
-	// Data stored directly in the union (no heap allocation needed)
-	list->elements[list->count].data.i = value;
-	list->elements[list->count].type = PVAR_TYPE_INT;
 
-	list->count++;
+	return capacity;
 }
 
 /**
- * @brief Adds a single double value to the list.
+ * @brief Moves the elements down to the start of the array, giving the
+ * unused front slots back to the end.
  *
- * @param list The list to add to.
- * @param value The double value to store.
+ * @param list The list, whose elements are its own.
  */
-void plist_add_double(plist_t *list, double value)
+static void plist_compact_front(plist_t *list)
 {
-	pvars_errno = PERRNO_CLEAR;
-	
-	if (list == NULL) {
-		pvars_errno = FAILURE_PLIST_ADD_DOUBLE_NULL_INPUT;
+	if (list->front == 0) {
 		return;
 	}
 
-	/* Resize capacity if needed */
-	if (!plist_ensure_capacity(list)) {
-		// plist_ensure_capacity sets the error code (FAILURE_PLIST_ADD_REALLOC_FAILED)
-		return;
-	}
-	
-	// Data stored directly in the union (no heap allocation needed)
-	list->elements[list->count].data.d = value;
-	list->elements[list->count].type = PVAR_TYPE_DOUBLE;
+	unsigned char *start = plist_slot(list, 0) - list->front * list->width;
 
-	list->count++;
+	memmove(start, list->values, list->count * list->width);
+	memset(start + list->count * list->width, 0, (list->front < list->count ? list->front : list->count) * list->width);
+
+	list->values = start;
+	list->capacity += list->front;
+	list->front = 0;
 }
 
 /**
- * @brief Adds a single long value to the list.
+ * @brief Resizes the elements array of a list to new_capacity slots, which
+ * must hold its elements, zeroing any new slots. Unused front slots are
+ * given up.
  *
- * @param list The list to add to.
- * @param value The long value to store.
+ * @param list The list, whose elements are its own.
+ * @param new_capacity The new number of slots, at least 1.
+ * @return True on success, false if the array could not be reallocated.
  */
-void plist_add_long(plist_t *list, long value)
+static bool plist_resize_now(plist_t *list, size_t new_capacity)
 {
-	pvars_errno = PERRNO_CLEAR;
-	
-	if (list == NULL) {
-		pvars_errno = FAILURE_PLIST_ADD_LONG_NULL_INPUT;
-		return;
-	}
+	plist_compact_front(list);
 
-	/* Resize capacity if needed */
-	if (!plist_ensure_capacity(list)) {
-		// plist_ensure_capacity sets the error code (FAILURE_PLIST_ADD_REALLOC_FAILED)
-		return;
-	}
-	
-	// Data stored directly in the union (no heap allocation needed)
-	list->elements[list->count].data.l = value;
-	list->elements[list->count].type = PVAR_TYPE_LONG;
+	size_t old_capacity = list->capacity;
 
-	list->count++;
-}
+	// Reallocate the array
+	void *new_values = pmem_realloc(list->allocator, list->values, old_capacity * list->width, new_capacity * list->width);
 
-/**
- * @brief Adds a single float value to the list.
- *
- * @param list The list to add to.
- * @param value The float value to store.
- */
-void plist_add_float(plist_t *list, float value)
-{
-	pvars_errno = PERRNO_CLEAR;
-	
-	if (list == NULL) {
-		pvars_errno = FAILURE_PLIST_ADD_FLOAT_NULL_INPUT;
-		return;
+	if (new_values == NULL) {
+		return false;
 	}
+	
+	list->values = new_values;
 
-	/* Resize capacity if needed */
-	if (!plist_ensure_capacity(list)) {
-		// plist_ensure_capacity sets the error code (FAILURE_PLIST_ADD_REALLOC_FAILED)
-		return;
+	// Initialize new memory slots to PVAR_TYPE_NONE (zeroing the entire struct is safe)
+	// We use the slot at old_capacity to get the start of the new block
+	if (new_capacity > old_capacity) {
+		memset(plist_slot(list, old_capacity), 0, (new_capacity - old_capacity) * list->width);
 	}
-	
-	// Data stored directly in the union (no heap allocation needed)
-	list->elements[list->count].data.f = value;
-	list->elements[list->count].type = PVAR_TYPE_FLOAT;
 
-	list->count++;
+	list->capacity = new_capacity;
+	return true;
 }
 
 /**
- * @brief Adds a single list to the list.
+ * @brief Ensures there is capacity for extra more elements, resizing if
+ * necessary, and that the list's elements are its own.
  *
- * The list is stored in a new pvar_t element.
+ * The capacity grows by the list's growth policy until it is large enough
+ * (see plist_set_growth_policy()).
  *
- * @param list The list to add to.
- * @param value The list to add.
+ * @param list The list to check.
+ * @param extra Number of elements about to be added.
+ * @return True if capacity is available/resized successfully, false otherwise.
  */
-void plist_add_list(plist_t *list, const plist_t *value)
+static bool plist_ensure_room(plist_t *list, size_t extra)
 {
-	pvars_errno = PERRNO_CLEAR;
+	if (!plist_unshare(list)) {
+		return false;
+	}
 
-	if (list == NULL) {
-		pvars_errno = FAILURE_PLIST_ADD_LIST_NULL_INPUT;
-		return;
+	if (extra <= list->capacity - list->count) {
+		pvars_errno = SUCCESS;
+		return true;
 	}
 
-	if (value == NULL) {
-		pvars_errno = FAILURE_PLIST_ADD_LIST_NULL_LIST_INPUT;
-		return;
+	if (extra > SIZE_MAX / sizeof(pvar_t) - list->count) {
+		pvars_errno = FAILURE_PLIST_ADD_REALLOC_FAILED;
+		return false;
 	}
 
-	/* Resize capacity if needed */
-	if (!plist_ensure_capacity(list)) {
-		// plist_ensure_capacity sets the error code
-		return;
+	size_t needed = list->count + extra;
+
+	/*
+	 * Slots freed at the front are reused once they outnumber the elements,
+	 * so a list used as a queue stays in place and moving it is amortised.
+	 * Otherwise the array grows as if it had no front space.
+	 */
+	if (list->front >= list->count && needed <= list->front + list->capacity) {
+		plist_compact_front(list);
+		pvars_errno = SUCCESS;
+		return true;
 	}
 
-	plist_t *new_list = plist_copy(value);
-	if (new_list == NULL) {
-		pvars_errno = FAILURE_PLIST_ADD_LIST_PLIST_COPY_FAILED;
-		return;
+	plist_compact_front(list);
+	if (needed <= list->capacity) {
+		if (list->capacity >= SIZE_MAX / sizeof(pvar_t)) {
+			pvars_errno = FAILURE_PLIST_ADD_REALLOC_FAILED;
+			return false;
+		}
+		needed = list->capacity + 1;
+	}
+
+	if (!plist_resize_now(list, plist_grown_capacity(list, needed))) {
+		pvars_errno = FAILURE_PLIST_ADD_REALLOC_FAILED; 
+		return false;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Ensures there is capacity for one more element, resizing if
+ * necessary, and that the list's elements are its own.
+ * * @param list The list to check.
+ * @return True if capacity is available/resized successfully, false otherwise.
+ */
+static bool plist_ensure_capacity(plist_t *list)
+{
+	return plist_ensure_room(list, 1);
+}
+
+/**
+ * @brief Ensures there is at least one unused slot before the first
+ * element, and that the list's elements are its own.
+ *
+ * The array is copied with front space sized by the growth policy, as if
+ * the list grew at the end, so inserting at the front one element at a
+ * time stays amortised O(1).
+ *
+ * @param list The list to check.
+ * @return True on success, false otherwise (with pvars_errno set).
+ */
+static bool plist_ensure_front(plist_t *list)
+{
+	if (!plist_unshare(list)) {
+		return false;
+	}
+
+	if (list->front > 0) {
+		return true;
+	}
+
+	if (list->capacity >= SIZE_MAX / sizeof(pvar_t)) {
+		pvars_errno = FAILURE_PLIST_ADD_REALLOC_FAILED;
+		return false;
+	}
+
+	size_t new_capacity = plist_grown_capacity(list, list->capacity + 1);
+	size_t front = new_capacity - list->capacity;
+
+	unsigned char *start = pmem_calloc(list->allocator, new_capacity, list->width);
+	if (start == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_REALLOC_FAILED;
+		return false;
+	}
+
+	memcpy(start + front * list->width, list->values, list->count * list->width);
+	pmem_free(list->allocator, list->values, list->capacity * list->width);
+
+	list->values = start + front * list->width;
+	list->front = front;
+	return true;
+}
+
+/**
+ * @brief Opens a zeroed slot at index for an insertion, moving whichever
+ * side of it is shorter. Inserting at the front uses the unused slots
+ * before the first element.
+ *
+ * @param list The list to insert into.
+ * @param index Where the new element goes, at most list->count.
+ * @return The slot (a pvar_t, or a packed value in a typed list), counted
+ * in list->count, or NULL if the list could not grow (with pvars_errno set).
+ */
+static void *plist_open_slot(plist_t *list, size_t index)
+{
+	if (index < list->count - index && (index == 0 || list->front > 0)) {
+		if (!plist_ensure_front(list)) {
+			return NULL;
+		}
+
+		list->values = plist_slot(list, 0) - list->width;
+		list->front--;
+		list->capacity++;
+		memmove(plist_slot(list, 0), plist_slot(list, 1), index * list->width);
+	} else {
+		if (!plist_ensure_capacity(list)) {
+			return NULL;
+		}
+
+		memmove(plist_slot(list, index + 1), plist_slot(list, index), (list->count - index) * list->width);
+	}
+
+	memset(plist_slot(list, index), 0, list->width);
+	list->count++;
+	pvars_errno = SUCCESS;
+	return plist_slot(list, index);
+}
+
+/**
+ * @brief Releases elements written past the end of the list by a bulk add
+ * that failed part way, leaving the slots zeroed again.
+ *
+ * @param list The list.
+ * @param added Number of elements written after list->count.
+ */
+static void plist_discard_tail(plist_t *list, size_t added)
+{
+	pvar_t *tail = list->elements + list->count;
+
+	for (size_t i = 0; i < added; i++) {
+		pvar_destroy_in(list->allocator, &tail[i]);
+	}
+
+	memset(tail, 0, added * sizeof(pvar_t));
+}
+
+/**
+ * @brief Returns the element at index, unpacking a value of a typed list
+ * into scratch.
+ *
+ * @param list The list.
+ * @param index Index of an element.
+ * @param scratch Holds the unpacked value of a typed list.
+ * @return The element, valid until the list or scratch changes.
+ */
+const pvar_t *plist_element(const plist_t *list, size_t index, pvar_t *scratch)
+{
+	if (list->column == PVAR_TYPE_NONE) {
+		return &list->elements[index];
+	}
+
+	memset(scratch, 0, sizeof(pvar_t));
+	scratch->type = list->column;
+
+	switch (list->column) {
+		case PVAR_TYPE_INT:
+			scratch->data.i = ((const int *)list->values)[index];
+			break;
+		case PVAR_TYPE_LONG:
+			scratch->data.l = ((const long *)list->values)[index];
+			break;
+		case PVAR_TYPE_DOUBLE:
+			scratch->data.d = ((const double *)list->values)[index];
+			break;
+		case PVAR_TYPE_FLOAT:
+			scratch->data.f = ((const float *)list->values)[index];
+			break;
+		default:
+			break;
+	}
+
+	return scratch;
+}
+
+/**
+ * @brief Packs a number into slot index of a typed list.
+ *
+ * @param list A typed list.
+ * @param index The slot.
+ * @param value A value of the list's type.
+ */
+static void plist_store(plist_t *list, size_t index, const pvar_t *value)
+{
+	switch (list->column) {
+		case PVAR_TYPE_INT:
+			((int *)list->values)[index] = value->data.i;
+			break;
+		case PVAR_TYPE_LONG:
+			((long *)list->values)[index] = value->data.l;
+			break;
+		case PVAR_TYPE_DOUBLE:
+			((double *)list->values)[index] = value->data.d;
+			break;
+		case PVAR_TYPE_FLOAT:
+			((float *)list->values)[index] = value->data.f;
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief Tells whether a value of the given type may be stored in the list:
+ * any type in a list of pvar_t, only its own in a typed list.
+ *
+ * @return True if it may, false otherwise (with pvars_errno set).
+ */
+static bool plist_accepts(const plist_t *list, pvar_type type)
+{
+	if (list->column == PVAR_TYPE_NONE || list->column == type) {
+		return true;
+	}
+
+	pvars_errno = FAILURE_PLIST_TYPED_LIST_TYPE_MISMATCH;
+	return false;
+}
+
+/**
+ * @brief Fills view with an element as the API hands values out: strings
+ * are plain C strings in data.s, pointing into the element.
+ *
+ * @param list The list.
+ * @param index Index of an element.
+ * @param view Receives the value.
+ * @return view.
+ */
+static const pvar_t *plist_element_view(const plist_t *list, size_t index, pvar_t *view)
+{
+	const pvar_t *element = plist_element(list, index, view);
+
+	*view = *element;
+
+	if (view->type == PVAR_TYPE_STRING) {
+		view->data.s = (char *)pvar_str(element);
+		view->str_tag = PVAR_STR_PLAIN;
+	}
+
+	return view;
+}
+
+/**
+ * @brief Closes a gap of count released elements at start with one memmove
+ * of whichever side of it is shorter, zeroing the vacated slots. Closing it
+ * from the front leaves the slots as front space, so removing the first
+ * element costs O(1).
+ *
+ * @param list The list, whose elements are its own.
+ * @param start Index of the first released element.
+ * @param count Number of released elements.
+ */
+static void plist_close_gap(plist_t *list, size_t start, size_t count)
+{
+	size_t after = list->count - start - count;
+
+	if (start < after) {
+		memmove(plist_slot(list, count), plist_slot(list, 0), start * list->width);
+		memset(plist_slot(list, 0), 0, count * list->width);
+		list->values = plist_slot(list, count);
+		list->front += count;
+		list->capacity -= count;
+	} else {
+		memmove(plist_slot(list, start), plist_slot(list, start + count), after * list->width);
+		memset(plist_slot(list, list->count - count), 0, count * list->width);
+	}
+
+	list->count -= count;
+}
+
+/**
+ * @brief Removes the element at a given index, shifting subsequent elements.
+ *
+ * Frees the data of the removed element, closes the gap by moving the
+ * shorter side of the list (so removing the first or last element is O(1))
+ * and decrements the count. To remove many elements, plist_remove_range()
+ * and plist_remove_if() shift the tail once rather than once per element.
+ *
+ * @param list The list to modify.
+ * @param index The index of the element to remove.
+ */
+void plist_remove(plist_t *list, size_t index)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_REMOVE_NULL_INPUT;
+		return;
+	}
+
+	if (index >= list->count) {
+		pvars_errno = FAILURE_PLIST_REMOVE_OUT_OF_BOUNDS;
+		return;
+	}
+
+	if (!plist_unshare(list)) {
+		return;
+	}
+
+	plist_release(list, index, 1);
+
+	plist_close_gap(list, index, 1);
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Removes the element at a given index and hands its value to the
+ * caller, shifting subsequent elements.
+ *
+ * Strings, lists and dicts are moved, not copied. The caller owns
+ * *out_value and releases it with pvar_destroy(). A string popped from a
+ * list with its own allocator or arena is copied to the heap first; lists
+ * and dicts keep their allocator.
+ *
+ * Popping index 0 or the last index is O(1), so with plist_insert_*() at
+ * index 0 and plist_add_*() a list works as a double-ended queue.
+ *
+ * @param list The list to modify.
+ * @param index The index of the element to remove.
+ * @param out_value Receives the removed value.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool plist_pop(plist_t *list, size_t index, pvar_t *out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_POP_NULL_INPUT;
+		return false;
+	}
+
+	if (index >= list->count) {
+		pvars_errno = FAILURE_PLIST_POP_OUT_OF_BOUNDS;
+		return false;
+	}
+
+	if (out_value == NULL) {
+		pvars_errno = FAILURE_PLIST_POP_NULL_INPUT_OUT_VALUE;
+		return false;
+	}
+
+	if (!plist_unshare(list)) {
+		return false;
+	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		plist_element(list, index, out_value);
+	} else {
+		*out_value = list->elements[index];
+	}
+
+	/* The caller gets a plain heap string in data.s, whatever the list stored */
+	if (out_value->type == PVAR_TYPE_STRING) {
+		char *heap_string = pvar_str_to_heap(out_value);
+		if (heap_string == NULL) {
+			out_value->type = PVAR_TYPE_NONE;
+			pvars_errno = FAILURE_PLIST_POP_STRDUP_FAILED;
+			return false;
+		}
+		pvar_destroy_in(list->allocator, out_value);
+		out_value->type = PVAR_TYPE_STRING;
+		out_value->str_tag = PVAR_STR_PLAIN;
+		out_value->data.s = heap_string;
+	}
+
+	plist_close_gap(list, index, 1);
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Removes count elements starting at index start, moving the rest of
+ * the list down once.
+ *
+ * @param list The list to modify.
+ * @param start The index of the first element to remove.
+ * @param count Number of elements to remove. 0 removes nothing.
+ */
+void plist_remove_range(plist_t *list, size_t start, size_t count)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_REMOVE_RANGE_NULL_INPUT;
+		return;
+	}
+
+	if (start > list->count || count > list->count - start) {
+		pvars_errno = FAILURE_PLIST_REMOVE_RANGE_OUT_OF_BOUNDS;
+		return;
+	}
+
+	if (count == 0) {
+		pvars_errno = SUCCESS;
+		return;
+	}
+
+	if (!plist_unshare(list)) {
+		return;
+	}
+
+	plist_release(list, start, count);
+
+	plist_close_gap(list, start, count);
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Removes every element for which predicate returns true, keeping
+ * the order of the others.
+ *
+ * The list is compacted in a single pass, so filtering costs O(n) however
+ * many elements go. The predicate is called once per element, in order,
+ * with a value laid out as the API returns them (a string in data.s, valid
+ * for the call only). It must not modify the list.
+ *
+ * @param list The list to filter.
+ * @param predicate Returns true for elements to remove.
+ * @param ctx Passed through to predicate.
+ * @return The number of elements removed.
+ */
+size_t plist_remove_if(plist_t *list, plist_predicate predicate, void *ctx)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL || predicate == NULL) {
+		pvars_errno = FAILURE_PLIST_REMOVE_IF_NULL_INPUT;
+		return 0;
+	}
+
+	pvar_t value;
+	size_t kept = 0;
+
+	/* Elements before the first match stay where they are, even in a shared list */
+	for (; kept < list->count; kept++) {
+		if (predicate(plist_element_view(list, kept, &value), ctx)) {
+			break;
+		}
+	}
+
+	if (kept == list->count) {
+		pvars_errno = SUCCESS;
+		return 0;
+	}
+
+	if (!plist_unshare(list)) {
+		return 0;
+	}
+
+	plist_release(list, kept, 1);
+
+	for (size_t i = kept + 1; i < list->count; i++) {
+		if (predicate(plist_element_view(list, i, &value), ctx)) {
+			plist_release(list, i, 1);
+		} else {
+			memcpy(plist_slot(list, kept++), plist_slot(list, i), list->width);
+		}
+	}
+
+	size_t removed = list->count - kept;
+	memset(plist_slot(list, kept), 0, removed * list->width);
+	list->count = kept;
+
+	pvars_errno = SUCCESS;
+	return removed;
+}
+
+/**
+ * @brief Removes the element at a given index in O(1) by moving the last
+ * element into its place. The order of the list is not kept.
+ *
+ * @param list The list to modify.
+ * @param index The index of the element to remove.
+ */
+void plist_swap_remove(plist_t *list, size_t index)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_SWAP_REMOVE_NULL_INPUT;
+		return;
+	}
+
+	if (index >= list->count) {
+		pvars_errno = FAILURE_PLIST_SWAP_REMOVE_OUT_OF_BOUNDS;
+		return;
+	}
+
+	if (!plist_unshare(list)) {
+		return;
+	}
+
+	plist_release(list, index, 1);
+
+	list->count--;
+	memmove(plist_slot(list, index), plist_slot(list, list->count), list->width);
+	memset(plist_slot(list, list->count), 0, list->width);
+
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Adds a single string to the list.
+ *
+ * Strings shorter than PVAR_INLINE_STR_SIZE are stored inside the new
+ * pvar_t element, longer ones are duplicated.
+ *
+ * @param list The list to add to.
+ * @param value The string to add (will be duplicated).
+ */
+void plist_add_str(plist_t *list, const char *value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_STR_NULL_INPUT_LIST;
+		return;
+	}
+
+	if (value == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_STR_NULL_STRING_INPUT;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_STRING)) {
+		return;
+	}
+
+	// Copy the string first: value may be borrowed from this list, which can move when it grows
+	pvar_t new_pvar;
+
+	if (!pvar_set_str_in(list->allocator, &new_pvar, value)) {
+		pvars_errno = FAILURE_PLIST_ADD_STR_STRDUP_FAILED;
+		return;
+	}
+
+	/* Resize capacity if needed */
+	if (!plist_ensure_capacity(list)) {
+		// plist_ensure_capacity sets the error code
+		pvar_destroy_in(list->allocator, &new_pvar);
+		return;
+	}
+
+	list->elements[list->count] = new_pvar;
+
+	list->count++;
+}
+
+/**
+ * @brief Adds len bytes to the list as a string.
+ *
+ * Unlike plist_add_str() the bytes may contain NULs, so binary data can be
+ * stored as it is. Read it back with plist_borrow_strn().
+ *
+ * @param list The list to add to.
+ * @param value The bytes to add (will be copied).
+ * @param len Number of bytes.
+ */
+void plist_add_strn(plist_t *list, const char *value, size_t len)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_STRN_NULL_INPUT_LIST;
+		return;
+	}
+
+	if (value == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_STRN_NULL_STRING_INPUT;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_STRING)) {
+		return;
+	}
+
+	// Copy the bytes first: value may be borrowed from this list, which can move when it grows
+	pvar_t new_pvar;
+
+	if (!pvar_set_strn_in(list->allocator, &new_pvar, value, len)) {
+		pvars_errno = FAILURE_PLIST_ADD_STRN_STRDUP_FAILED;
+		return;
+	}
+
+	/* Resize capacity if needed */
+	if (!plist_ensure_capacity(list)) {
+		// plist_ensure_capacity sets the error code
+		pvar_destroy_in(list->allocator, &new_pvar);
+		return;
+	}
+
+	list->elements[list->count] = new_pvar;
+
+	list->count++;
+}
+
+/**
+ * @brief Adds a single integer value to the list.
+ *
+ * @param list The list to add to.
+ * @param value The integer value to store.
+ */
+void plist_add_int(plist_t *list, int value)
+{
+	pvars_errno = PERRNO_CLEAR;
+	
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_INT_NULL_INPUT;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_INT)) {
+		return;
+	}
+
+	/* Resize capacity if needed */
+	if (!plist_ensure_capacity(list)) {
+		// plist_ensure_capacity sets the error code (FAILURE_PLIST_ADD_REALLOC_FAILED)
+		return;
+	}
+	
+	if (list->column != PVAR_TYPE_NONE) {
+		((int *)list->values)[list->count++] = value;
+		return;
+	}
+
+	// Data stored directly in the union (no heap allocation needed)
+	list->elements[list->count].data.i = value;
+	list->elements[list->count].type = PVAR_TYPE_INT;
+
+	list->count++;
+}
+
+/**
+ * @brief Adds a single double value to the list.
+ *
+ * @param list The list to add to.
+ * @param value The double value to store.
+ */
+void plist_add_double(plist_t *list, double value)
+{
+	pvars_errno = PERRNO_CLEAR;
+	
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_DOUBLE_NULL_INPUT;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_DOUBLE)) {
+		return;
+	}
+
+	/* Resize capacity if needed */
+	if (!plist_ensure_capacity(list)) {
+		// plist_ensure_capacity sets the error code (FAILURE_PLIST_ADD_REALLOC_FAILED)
+		return;
+	}
+	
+	if (list->column != PVAR_TYPE_NONE) {
+		((double *)list->values)[list->count++] = value;
+		return;
+	}
+
+	// Data stored directly in the union (no heap allocation needed)
+	list->elements[list->count].data.d = value;
+	list->elements[list->count].type = PVAR_TYPE_DOUBLE;
+
+	list->count++;
+}
+
+/**
+ * @brief Adds a single long value to the list.
+ *
+ * @param list The list to add to.
+ * @param value The long value to store.
+ */
+void plist_add_long(plist_t *list, long value)
+{
+	pvars_errno = PERRNO_CLEAR;
+	
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_LONG_NULL_INPUT;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_LONG)) {
+		return;
+	}
+
+	/* Resize capacity if needed */
+	if (!plist_ensure_capacity(list)) {
+		// plist_ensure_capacity sets the error code (FAILURE_PLIST_ADD_REALLOC_FAILED)
+		return;
+	}
+	
+	if (list->column != PVAR_TYPE_NONE) {
+		((long *)list->values)[list->count++] = value;
+		return;
+	}
+
+	// Data stored directly in the union (no heap allocation needed)
+	list->elements[list->count].data.l = value;
+	list->elements[list->count].type = PVAR_TYPE_LONG;
+
+	list->count++;
+}
+
+/**
+ * @brief Adds a single float value to the list.
+ *
+ * @param list The list to add to.
+ * @param value The float value to store.
+ */
+void plist_add_float(plist_t *list, float value)
+{
+	pvars_errno = PERRNO_CLEAR;
+	
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_FLOAT_NULL_INPUT;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_FLOAT)) {
+		return;
+	}
+
+	/* Resize capacity if needed */
+	if (!plist_ensure_capacity(list)) {
+		// plist_ensure_capacity sets the error code (FAILURE_PLIST_ADD_REALLOC_FAILED)
+		return;
+	}
+	
+	if (list->column != PVAR_TYPE_NONE) {
+		((float *)list->values)[list->count++] = value;
+		return;
+	}
+
+	// Data stored directly in the union (no heap allocation needed)
+	list->elements[list->count].data.f = value;
+	list->elements[list->count].type = PVAR_TYPE_FLOAT;
+
+	list->count++;
+}
+
+/**
+ * @brief Adds a single list to the list.
+ *
+ * The list is stored in a new pvar_t element.
+ *
+ * @param list The list to add to.
+ * @param value The list to add.
+ */
+void plist_add_list(plist_t *list, const plist_t *value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_LIST_NULL_INPUT;
+		return;
+	}
+
+	if (value == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_LIST_NULL_LIST_INPUT;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_LIST)) {
+		return;
+	}
+
+	// Copy first: value may be this list, whose elements are unshared when it grows
+	plist_t *new_list = plist_copy_in(list->allocator, value);
+	if (new_list == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_LIST_PLIST_COPY_FAILED;
+		return;
+	}
+
+	/* Resize capacity if needed */
+	if (!plist_ensure_capacity(list)) {
+		// plist_ensure_capacity sets the error code
+		plist_destroy(new_list);
+		return;
+	}
+	
+	// Populate the pvar_t struct fields
+	list->elements[list->count].data.ls = new_list;
+	list->elements[list->count].type = PVAR_TYPE_LIST;
+
+	list->count++;
+}
+
+/**
+ * @brief Adds a single dict to the list.
+ *
+ * The dict is duplicated using pdict_copy and stored in a new pvar_t element.
+ *
+ * @param list The list to add to.
+ * @param value The dict to add (will be duplicated).
+ */
+void plist_add_dict(plist_t *list, const pdict_t *value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_DICT_NULL_INPUT;
+		return;
+	}
+
+	if (value == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_DICT_NULL_DICT_INPUT;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_DICT)) {
+		return;
+	}
+
+	pdict_t *new_dict = pdict_copy_in(list->allocator, value);
+
+	if (new_dict == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_DICT_PDICT_COPY_FAILED;
+		return;
+	}
+
+	/* Resize capacity if needed */
+	if (!plist_ensure_capacity(list)) {
+		// plist_ensure_capacity sets the error code
+		pdict_destroy(new_dict);
+		return;
+	}
+
+	list->elements[list->count].data.dt = new_dict;
+	list->elements[list->count].type = PVAR_TYPE_DICT;
+
+	list->count++;
+}
+
+/**
+ * @brief Adds a list to the list, taking ownership of it instead of copying.
+ *
+ * On success the list owns value and frees it when the element is removed
+ * or the list is destroyed; the caller must not use or free it afterwards.
+ * On failure ownership stays with the caller.
+ *
+ * @param list The list to add to.
+ * @param value The list to move into the list.
+ */
+void plist_add_list_take(plist_t *list, plist_t *value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_LIST_TAKE_NULL_INPUT;
+		return;
+	}
+
+	if (value == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_LIST_TAKE_NULL_LIST_INPUT;
+		return;
+	}
+
+	if (value->allocator != list->allocator) {
+		pvars_errno = FAILURE_PLIST_ADD_LIST_TAKE_ALLOCATOR_MISMATCH;
+		return;
+	}
+
+	if (value == list) {
+		pvars_errno = FAILURE_PLIST_ADD_LIST_TAKE_SELF_INSERT;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_LIST)) {
+		return;
+	}
+
+	/* Resize capacity if needed */
+	if (!plist_ensure_capacity(list)) {
+		// plist_ensure_capacity sets the error code
+		return;
+	}
+
+	list->elements[list->count].data.ls = value;
+	list->elements[list->count].type = PVAR_TYPE_LIST;
+
+	list->count++;
+}
+
+/**
+ * @brief Adds a dict to the list, taking ownership of it instead of copying.
+ *
+ * On success the list owns value and frees it when the element is removed
+ * or the list is destroyed; the caller must not use or free it afterwards.
+ * On failure ownership stays with the caller.
+ *
+ * @param list The list to add to.
+ * @param value The dict to move into the list.
+ */
+void plist_add_dict_take(plist_t *list, pdict_t *value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_DICT_TAKE_NULL_INPUT;
+		return;
+	}
+
+	if (value == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_DICT_TAKE_NULL_DICT_INPUT;
+		return;
+	}
+
+	if (value->allocator != list->allocator) {
+		pvars_errno = FAILURE_PLIST_ADD_DICT_TAKE_ALLOCATOR_MISMATCH;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_DICT)) {
+		return;
+	}
+
+	/* Resize capacity if needed */
+	if (!plist_ensure_capacity(list)) {
+		// plist_ensure_capacity sets the error code
+		return;
+	}
+
+	list->elements[list->count].data.dt = value;
+	list->elements[list->count].type = PVAR_TYPE_DICT;
+
+	list->count++;
+}
+
+/**
+ * @brief Adds a single pvar to the list.
+ *
+ * The dict is duplicated using pvar_copy and stored in a new pvar_t element.
+ *
+ * @param list The list to add to.
+ * @param value The pvar to add (will be duplicated).
+ */
+void plist_add_pvar(plist_t *list, const pvar_t *value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_PVAR_NULL_INPUT;
+		return;
+	}
+
+	if (value == NULL) {
+		pvars_errno = FAILURE_PLIST_ADD_PVAR_NULL_PVAR_INPUT;
+		return;
+	}
+
+	if (!plist_accepts(list, (pvar_type)value->type)) {
+		return;
+	}
+
+	/* A caller's value keeps its string in data.s */
+	pvar_t source = *value;
+	source.str_tag = PVAR_STR_PLAIN;
+
+	// Copy first: value may hold this list, whose elements are unshared when it grows
+	pvar_t new_pvar = pvar_copy_in(list->allocator, &source);
+
+	if (pvars_errno != SUCCESS) {
+		pvars_errno = FAILURE_PLIST_ADD_PVAR_PVAR_COPY_FAILED;
+		return;
+	}
+
+	/* Resize capacity if needed */
+	if (!plist_ensure_capacity(list)) {
+		pvar_destroy_in(list->allocator, &new_pvar);
+		pvars_errno = FAILURE_PLIST_ADD_PVAR_PLIST_ENSURE_CAPACITY_FAILED;
+		return;
+	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		plist_store(list, list->count, &new_pvar);
+	} else {
+		list->elements[list->count] = new_pvar;
+	}
+
+	list->count++;
+}
+
+/**
+ * @brief Appends a value already in stored form, taking ownership of it.
+ * Used by decoders, which build values with the list's allocator and so
+ * need no second copy.
+ *
+ * @param list A list of pvar_t.
+ * @param value The value; its string, if any, was made with pvar_set_strn_in()
+ * and the list's allocator.
+ * @return True on success, false if the list could not grow (the value is
+ * still the caller's).
+ */
+bool plist_append_take(plist_t *list, const pvar_t *value)
+{
+	if (!plist_ensure_capacity(list)) {
+		return false;
+	}
+
+	list->elements[list->count] = *value;
+	list->count++;
+	return true;
+}
+
+/**
+ * @brief Adds count integer values to the end of the list.
+ *
+ * The list grows at most once and the values are stored in a single pass,
+ * which is much cheaper than calling plist_add_int() for each value.
+ *
+ * @param list The list to add to.
+ * @param values The values to store.
+ * @param count Number of values.
+ */
+void plist_extend_ints(plist_t *list, const int *values, size_t count)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_EXTEND_INTS_NULL_INPUT;
+		return;
+	}
+
+	if (values == NULL && count > 0) {
+		pvars_errno = FAILURE_PLIST_EXTEND_INTS_NULL_VALUES_INPUT;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_INT)) {
+		return;
+	}
+
+	if (!plist_ensure_room(list, count)) {
+		pvars_errno = FAILURE_PLIST_EXTEND_INTS_REALLOC_FAILED;
+		return;
+	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		memcpy(plist_slot(list, list->count), values, count * sizeof(int));
+		list->count += count;
+		pvars_errno = SUCCESS;
+		return;
+	}
+
+	pvar_t *tail = list->elements + list->count;
+
+	for (size_t i = 0; i < count; i++) {
+		tail[i].data.i = values[i];
+		tail[i].type = PVAR_TYPE_INT;
+	}
+
+	list->count += count;
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Adds count long values to the end of the list.
+ *
+ * The list grows at most once and the values are stored in a single pass,
+ * which is much cheaper than calling plist_add_long() for each value.
+ *
+ * @param list The list to add to.
+ * @param values The values to store.
+ * @param count Number of values.
+ */
+void plist_extend_longs(plist_t *list, const long *values, size_t count)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_EXTEND_LONGS_NULL_INPUT;
+		return;
+	}
+
+	if (values == NULL && count > 0) {
+		pvars_errno = FAILURE_PLIST_EXTEND_LONGS_NULL_VALUES_INPUT;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_LONG)) {
+		return;
+	}
+
+	if (!plist_ensure_room(list, count)) {
+		pvars_errno = FAILURE_PLIST_EXTEND_LONGS_REALLOC_FAILED;
+		return;
+	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		memcpy(plist_slot(list, list->count), values, count * sizeof(long));
+		list->count += count;
+		pvars_errno = SUCCESS;
+		return;
+	}
+
+	pvar_t *tail = list->elements + list->count;
+
+	for (size_t i = 0; i < count; i++) {
+		tail[i].data.l = values[i];
+		tail[i].type = PVAR_TYPE_LONG;
+	}
+
+	list->count += count;
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Adds count double values to the end of the list.
+ *
+ * The list grows at most once and the values are stored in a single pass,
+ * which is much cheaper than calling plist_add_double() for each value.
+ *
+ * @param list The list to add to.
+ * @param values The values to store.
+ * @param count Number of values.
+ */
+void plist_extend_doubles(plist_t *list, const double *values, size_t count)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_EXTEND_DOUBLES_NULL_INPUT;
+		return;
+	}
+
+	if (values == NULL && count > 0) {
+		pvars_errno = FAILURE_PLIST_EXTEND_DOUBLES_NULL_VALUES_INPUT;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_DOUBLE)) {
+		return;
+	}
+
+	if (!plist_ensure_room(list, count)) {
+		pvars_errno = FAILURE_PLIST_EXTEND_DOUBLES_REALLOC_FAILED;
+		return;
+	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		memcpy(plist_slot(list, list->count), values, count * sizeof(double));
+		list->count += count;
+		pvars_errno = SUCCESS;
+		return;
+	}
+
+	pvar_t *tail = list->elements + list->count;
+
+	for (size_t i = 0; i < count; i++) {
+		tail[i].data.d = values[i];
+		tail[i].type = PVAR_TYPE_DOUBLE;
+	}
+
+	list->count += count;
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Adds count float values to the end of the list.
+ *
+ * The list grows at most once and the values are stored in a single pass,
+ * which is much cheaper than calling plist_add_float() for each value.
+ *
+ * @param list The list to add to.
+ * @param values The values to store.
+ * @param count Number of values.
+ */
+void plist_extend_floats(plist_t *list, const float *values, size_t count)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_EXTEND_FLOATS_NULL_INPUT;
+		return;
+	}
+
+	if (values == NULL && count > 0) {
+		pvars_errno = FAILURE_PLIST_EXTEND_FLOATS_NULL_VALUES_INPUT;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_FLOAT)) {
+		return;
+	}
+
+	if (!plist_ensure_room(list, count)) {
+		pvars_errno = FAILURE_PLIST_EXTEND_FLOATS_REALLOC_FAILED;
+		return;
+	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		memcpy(plist_slot(list, list->count), values, count * sizeof(float));
+		list->count += count;
+		pvars_errno = SUCCESS;
+		return;
+	}
+
+	pvar_t *tail = list->elements + list->count;
+
+	for (size_t i = 0; i < count; i++) {
+		tail[i].data.f = values[i];
+		tail[i].type = PVAR_TYPE_FLOAT;
+	}
+
+	list->count += count;
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Adds count strings to the end of the list.
+ *
+ * The list grows at most once. Every string is checked before anything is
+ * added, and if a copy fails the strings already added are removed again,
+ * so the list is either extended by all of them or left unchanged. The
+ * strings must not be borrowed from list itself.
+ *
+ * @param list The list to add to.
+ * @param values The strings to add (will be duplicated).
+ * @param count Number of strings.
+ */
+void plist_extend_strs(plist_t *list, const char *const *values, size_t count)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_EXTEND_STRS_NULL_INPUT;
+		return;
+	}
+
+	if (values == NULL && count > 0) {
+		pvars_errno = FAILURE_PLIST_EXTEND_STRS_NULL_VALUES_INPUT;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_STRING)) {
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (values[i] == NULL) {
+			pvars_errno = FAILURE_PLIST_EXTEND_STRS_NULL_STRING_INPUT;
+			return;
+		}
+	}
+
+	if (!plist_ensure_room(list, count)) {
+		pvars_errno = FAILURE_PLIST_EXTEND_STRS_REALLOC_FAILED;
+		return;
+	}
+
+	pvar_t *tail = list->elements + list->count;
+
+	for (size_t i = 0; i < count; i++) {
+		if (!pvar_set_str_in(list->allocator, &tail[i], values[i])) {
+			plist_discard_tail(list, i);
+			pvars_errno = FAILURE_PLIST_EXTEND_STRS_STRDUP_FAILED;
+			return;
+		}
+	}
+
+	list->count += count;
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Adds copies of count pvars to the end of the list.
+ *
+ * The list grows at most once. If a copy fails the values already added
+ * are removed again, so the list is either extended by all of them or left
+ * unchanged. The values must not be borrowed from list itself.
+ *
+ * @param list The list to add to.
+ * @param values The values to add (will be duplicated).
+ * @param count Number of values.
+ */
+void plist_extend_pvars(plist_t *list, const pvar_t *values, size_t count)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_EXTEND_PVARS_NULL_INPUT;
+		return;
+	}
+
+	if (values == NULL && count > 0) {
+		pvars_errno = FAILURE_PLIST_EXTEND_PVARS_NULL_VALUES_INPUT;
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (!plist_accepts(list, (pvar_type)values[i].type)) {
+			return;
+		}
+	}
+
+	if (!plist_ensure_room(list, count)) {
+		pvars_errno = FAILURE_PLIST_EXTEND_PVARS_REALLOC_FAILED;
+		return;
+	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		for (size_t i = 0; i < count; i++) {
+			plist_store(list, list->count + i, &values[i]);
+		}
+
+		list->count += count;
+		pvars_errno = SUCCESS;
+		return;
+	}
+
+	pvar_t *tail = list->elements + list->count;
+
+	for (size_t i = 0; i < count; i++) {
+		/* A caller's value keeps its string in data.s */
+		pvar_t source = values[i];
+		source.str_tag = PVAR_STR_PLAIN;
+
+		tail[i] = pvar_copy_in(list->allocator, &source);
+		if (pvars_errno != SUCCESS) {
+			plist_discard_tail(list, i);
+			pvars_errno = FAILURE_PLIST_EXTEND_PVARS_PVAR_COPY_FAILED;
+			return;
+		}
+	}
+
+	list->count += count;
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Adds copies of every element of src to the end of the list.
+ *
+ * The list grows at most once, and is either extended by all of src or left
+ * unchanged. src may be list itself, which then holds its elements twice.
+ *
+ * @param list The list to add to.
+ * @param src The list whose elements are added.
+ */
+void plist_extend(plist_t *list, const plist_t *src)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_EXTEND_NULL_INPUT;
+		return;
+	}
+
+	if (src == NULL) {
+		pvars_errno = FAILURE_PLIST_EXTEND_NULL_LIST_INPUT;
+		return;
+	}
+
+	pvar_t scratch;
+
+	if (list->column != PVAR_TYPE_NONE && src->column != list->column) {
+		for (size_t i = 0; i < src->count; i++) {
+			if (!plist_accepts(list, (pvar_type)plist_element(src, i, &scratch)->type)) {
+				return;
+			}
+		}
+	}
+
+	// Read before the list grows: src may be list itself
+	size_t count = src->count;
+
+	if (!plist_ensure_room(list, count)) {
+		pvars_errno = FAILURE_PLIST_EXTEND_REALLOC_FAILED;
+		return;
+	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		if (src->column == list->column) {
+			memcpy(plist_slot(list, list->count), src->values, count * list->width);
+		} else {
+			for (size_t i = 0; i < count; i++) {
+				plist_store(list, list->count + i, plist_element(src, i, &scratch));
+			}
+		}
+
+		list->count += count;
+		pvars_errno = SUCCESS;
+		return;
+	}
+
+	pvar_t *tail = list->elements + list->count;
+
+	for (size_t i = 0; i < count; i++) {
+		tail[i] = pvar_copy_in(list->allocator, plist_element(src, i, &scratch));
+		if (pvars_errno != SUCCESS) {
+			plist_discard_tail(list, i);
+			pvars_errno = FAILURE_PLIST_EXTEND_PVAR_COPY_FAILED;
+			return;
+		}
+	}
+
+	list->count += count;
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Inserts a string into the list at index, moving later elements up.
+ *
+ * Inserting at index 0 or near the front moves the earlier elements down
+ * into unused slots before the first element instead, so pushing to the
+ * front is amortised O(1) like adding to the end.
+ *
+ * @param list The list to insert into.
+ * @param index Where the new element goes, from 0 to plist_get_size(list).
+ * @param value The string to insert (will be duplicated).
+ */
+void plist_insert_str(plist_t *list, size_t index, const char *value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_INSERT_STR_NULL_INPUT_LIST;
+		return;
+	}
+
+	if (value == NULL) {
+		pvars_errno = FAILURE_PLIST_INSERT_STR_NULL_STRING_INPUT;
+		return;
+	}
+
+	if (index > list->count) {
+		pvars_errno = FAILURE_PLIST_INSERT_STR_OUT_OF_BOUNDS;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_STRING)) {
+		return;
+	}
+
+	// Copy the string first: value may be borrowed from this list, which moves when a slot is opened
+	pvar_t new_pvar;
+
+	if (!pvar_set_str_in(list->allocator, &new_pvar, value)) {
+		pvars_errno = FAILURE_PLIST_INSERT_STR_STRDUP_FAILED;
+		return;
+	}
+
+	pvar_t *slot = plist_open_slot(list, index);
+	if (slot == NULL) {
+		pvar_destroy_in(list->allocator, &new_pvar);
+		return;
+	}
+
+	*slot = new_pvar;
+}
+
+/**
+ * @brief Inserts len bytes as a string into the list at index, moving later elements up.
+ *
+ * The bytes may contain NULs, see plist_add_strn().
+ *
+ * @param list The list to insert into.
+ * @param index Where the new element goes, from 0 to plist_get_size(list).
+ * @param value The bytes to insert (will be copied).
+ * @param len Number of bytes.
+ */
+void plist_insert_strn(plist_t *list, size_t index, const char *value, size_t len)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_INSERT_STRN_NULL_INPUT_LIST;
+		return;
+	}
+
+	if (value == NULL) {
+		pvars_errno = FAILURE_PLIST_INSERT_STRN_NULL_STRING_INPUT;
+		return;
+	}
+
+	if (index > list->count) {
+		pvars_errno = FAILURE_PLIST_INSERT_STRN_OUT_OF_BOUNDS;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_STRING)) {
+		return;
+	}
+
+	// Copy the string first: value may be borrowed from this list, which moves when a slot is opened
+	pvar_t new_pvar;
+
+	if (!pvar_set_strn_in(list->allocator, &new_pvar, value, len)) {
+		pvars_errno = FAILURE_PLIST_INSERT_STRN_STRDUP_FAILED;
+		return;
+	}
+
+	pvar_t *slot = plist_open_slot(list, index);
+	if (slot == NULL) {
+		pvar_destroy_in(list->allocator, &new_pvar);
+		return;
+	}
+
+	*slot = new_pvar;
+}
+
+/**
+ * @brief Inserts an integer value into the list at index, moving later elements up.
+ *
+ * @param list The list to insert into.
+ * @param index Where the new element goes, from 0 to plist_get_size(list).
+ * @param value The integer value to store.
+ */
+void plist_insert_int(plist_t *list, size_t index, int value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_INSERT_INT_NULL_INPUT;
+		return;
+	}
+
+	if (index > list->count) {
+		pvars_errno = FAILURE_PLIST_INSERT_INT_OUT_OF_BOUNDS;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_INT)) {
+		return;
+	}
+
+	void *slot = plist_open_slot(list, index);
+	if (slot == NULL) {
+		// plist_open_slot sets the error code (FAILURE_PLIST_ADD_REALLOC_FAILED)
+		return;
+	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		*(int *)slot = value;
+		return;
+	}
+
+	((pvar_t *)slot)->data.i = value;
+	((pvar_t *)slot)->type = PVAR_TYPE_INT;
+}
+
+/**
+ * @brief Inserts a long value into the list at index, moving later elements up.
+ *
+ * @param list The list to insert into.
+ * @param index Where the new element goes, from 0 to plist_get_size(list).
+ * @param value The long value to store.
+ */
+void plist_insert_long(plist_t *list, size_t index, long value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_INSERT_LONG_NULL_INPUT;
+		return;
+	}
+
+	if (index > list->count) {
+		pvars_errno = FAILURE_PLIST_INSERT_LONG_OUT_OF_BOUNDS;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_LONG)) {
+		return;
+	}
+
+	void *slot = plist_open_slot(list, index);
+	if (slot == NULL) {
+		// plist_open_slot sets the error code (FAILURE_PLIST_ADD_REALLOC_FAILED)
+		return;
+	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		*(long *)slot = value;
+		return;
+	}
+
+	((pvar_t *)slot)->data.l = value;
+	((pvar_t *)slot)->type = PVAR_TYPE_LONG;
+}
+
+/**
+ * @brief Inserts a double value into the list at index, moving later elements up.
+ *
+ * @param list The list to insert into.
+ * @param index Where the new element goes, from 0 to plist_get_size(list).
+ * @param value The double value to store.
+ */
+void plist_insert_double(plist_t *list, size_t index, double value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_INSERT_DOUBLE_NULL_INPUT;
+		return;
+	}
+
+	if (index > list->count) {
+		pvars_errno = FAILURE_PLIST_INSERT_DOUBLE_OUT_OF_BOUNDS;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_DOUBLE)) {
+		return;
+	}
+
+	void *slot = plist_open_slot(list, index);
+	if (slot == NULL) {
+		// plist_open_slot sets the error code (FAILURE_PLIST_ADD_REALLOC_FAILED)
+		return;
+	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		*(double *)slot = value;
+		return;
+	}
+
+	((pvar_t *)slot)->data.d = value;
+	((pvar_t *)slot)->type = PVAR_TYPE_DOUBLE;
+}
+
+/**
+ * @brief Inserts a float value into the list at index, moving later elements up.
+ *
+ * @param list The list to insert into.
+ * @param index Where the new element goes, from 0 to plist_get_size(list).
+ * @param value The float value to store.
+ */
+void plist_insert_float(plist_t *list, size_t index, float value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_INSERT_FLOAT_NULL_INPUT;
+		return;
+	}
+
+	if (index > list->count) {
+		pvars_errno = FAILURE_PLIST_INSERT_FLOAT_OUT_OF_BOUNDS;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_FLOAT)) {
+		return;
+	}
+
+	void *slot = plist_open_slot(list, index);
+	if (slot == NULL) {
+		// plist_open_slot sets the error code (FAILURE_PLIST_ADD_REALLOC_FAILED)
+		return;
+	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		*(float *)slot = value;
+		return;
+	}
+
+	((pvar_t *)slot)->data.f = value;
+	((pvar_t *)slot)->type = PVAR_TYPE_FLOAT;
+}
+
+/**
+ * @brief Inserts a copy of a list into the list at index, moving later elements up.
+ *
+ * @param list The list to insert into.
+ * @param index Where the new element goes, from 0 to plist_get_size(list).
+ * @param value The list to insert (will be copied).
+ */
+void plist_insert_list(plist_t *list, size_t index, const plist_t *value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_INSERT_LIST_NULL_INPUT;
+		return;
+	}
+
+	if (value == NULL) {
+		pvars_errno = FAILURE_PLIST_INSERT_LIST_NULL_LIST_INPUT;
+		return;
+	}
+
+	if (index > list->count) {
+		pvars_errno = FAILURE_PLIST_INSERT_LIST_OUT_OF_BOUNDS;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_LIST)) {
+		return;
+	}
+
+	// Copy first: value may be this list, whose elements are unshared when a slot is opened
+	plist_t *new_value = plist_copy_in(list->allocator, value);
+	if (new_value == NULL) {
+		pvars_errno = FAILURE_PLIST_INSERT_LIST_PLIST_COPY_FAILED;
+		return;
+	}
+
+	pvar_t *slot = plist_open_slot(list, index);
+	if (slot == NULL) {
+		plist_destroy(new_value);
+		return;
+	}
+
+	slot->data.ls = new_value;
+	slot->type = PVAR_TYPE_LIST;
+}
+
+/**
+ * @brief Inserts a copy of a dict into the list at index, moving later elements up.
+ *
+ * @param list The list to insert into.
+ * @param index Where the new element goes, from 0 to plist_get_size(list).
+ * @param value The dict to insert (will be copied).
+ */
+void plist_insert_dict(plist_t *list, size_t index, const pdict_t *value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_INSERT_DICT_NULL_INPUT;
+		return;
+	}
+
+	if (value == NULL) {
+		pvars_errno = FAILURE_PLIST_INSERT_DICT_NULL_DICT_INPUT;
+		return;
+	}
+
+	if (index > list->count) {
+		pvars_errno = FAILURE_PLIST_INSERT_DICT_OUT_OF_BOUNDS;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_DICT)) {
+		return;
+	}
+
+	// Copy first: value may be this list, whose elements are unshared when a slot is opened
+	pdict_t *new_value = pdict_copy_in(list->allocator, value);
+	if (new_value == NULL) {
+		pvars_errno = FAILURE_PLIST_INSERT_DICT_PDICT_COPY_FAILED;
+		return;
+	}
+
+	pvar_t *slot = plist_open_slot(list, index);
+	if (slot == NULL) {
+		pdict_destroy(new_value);
+		return;
+	}
+
+	slot->data.dt = new_value;
+	slot->type = PVAR_TYPE_DICT;
+}
+
+/**
+ * @brief Inserts a copy of a pvar into the list at index, moving later elements up.
+ *
+ * @param list The list to insert into.
+ * @param index Where the new element goes, from 0 to plist_get_size(list).
+ * @param value The pvar to insert (will be copied).
+ */
+void plist_insert_pvar(plist_t *list, size_t index, const pvar_t *value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_INSERT_PVAR_NULL_INPUT;
+		return;
+	}
+
+	if (value == NULL) {
+		pvars_errno = FAILURE_PLIST_INSERT_PVAR_NULL_PVAR_INPUT;
+		return;
+	}
+
+	if (index > list->count) {
+		pvars_errno = FAILURE_PLIST_INSERT_PVAR_OUT_OF_BOUNDS;
+		return;
+	}
+
+	if (!plist_accepts(list, (pvar_type)value->type)) {
+		return;
+	}
+
+	/* A caller's value keeps its string in data.s */
+	pvar_t source = *value;
+	source.str_tag = PVAR_STR_PLAIN;
+
+	// Copy first: value may hold this list, whose elements are unshared when a slot is opened
+	pvar_t new_pvar = pvar_copy_in(list->allocator, &source);
+
+	if (pvars_errno != SUCCESS) {
+		pvars_errno = FAILURE_PLIST_INSERT_PVAR_PVAR_COPY_FAILED;
+		return;
+	}
+
+	void *slot = plist_open_slot(list, index);
+	if (slot == NULL) {
+		pvar_destroy_in(list->allocator, &new_pvar);
+		return;
+	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		plist_store(list, index, &new_pvar);
+		return;
 	}
-	
-	// Populate the pvar_t struct fields
-	list->elements[list->count].data.ls = new_list;
-	list->elements[list->count].type = PVAR_TYPE_LIST;
 
-	list->count++;
+	*(pvar_t *)slot = new_pvar;
 }
 
 /**
- * @brief Adds a single dict to the list.
+ * @brief Inserts a list into the list at index, moving later elements up.
  *
- * The dict is duplicated using pdict_copy and stored in a new pvar_t element.
+ * Ownership of value moves to the list as with plist_add_list_take();
+ * on failure it stays with the caller.
  *
- * @param list The list to add to.
- * @param value The dict to add (will be duplicated).
+ * @param list The list to insert into.
+ * @param index Where the new element goes, from 0 to plist_get_size(list).
+ * @param value The list to move into the list.
  */
-void plist_add_dict(plist_t *list, const pdict_t *value)
+void plist_insert_list_take(plist_t *list, size_t index, plist_t *value)
 {
 	pvars_errno = PERRNO_CLEAR;
 
 	if (list == NULL) {
-		pvars_errno = FAILURE_PLIST_ADD_DICT_NULL_INPUT;
+		pvars_errno = FAILURE_PLIST_INSERT_LIST_TAKE_NULL_INPUT;
 		return;
 	}
 
 	if (value == NULL) {
-		pvars_errno = FAILURE_PLIST_ADD_DICT_NULL_DICT_INPUT;
+		pvars_errno = FAILURE_PLIST_INSERT_LIST_TAKE_NULL_LIST_INPUT;
 		return;
 	}
 
-	/* Resize capacity if needed */
-	if (!plist_ensure_capacity(list)) {
-		// plist_ensure_capacity sets the error code
+	if (index > list->count) {
+		pvars_errno = FAILURE_PLIST_INSERT_LIST_TAKE_OUT_OF_BOUNDS;
 		return;
 	}
 
-	pdict_t *new_dict = pdict_copy(value);
+	if (value->allocator != list->allocator) {
+		pvars_errno = FAILURE_PLIST_INSERT_LIST_TAKE_ALLOCATOR_MISMATCH;
+		return;
+	}
 
-	if (new_dict == NULL) {
-		pvars_errno = FAILURE_PLIST_ADD_DICT_PDICT_COPY_FAILED;
+	if (value == list) {
+		pvars_errno = FAILURE_PLIST_INSERT_LIST_TAKE_SELF_INSERT;
 		return;
 	}
 
-	list->elements[list->count].data.dt = new_dict;
-	list->elements[list->count].type = PVAR_TYPE_DICT;
+	if (!plist_accepts(list, PVAR_TYPE_LIST)) {
+		return;
+	}
 
-	list->count++;
+	pvar_t *slot = plist_open_slot(list, index);
+	if (slot == NULL) {
+		return;
+	}
+
+	slot->data.ls = value;
+	slot->type = PVAR_TYPE_LIST;
 }
 
 /**
- * @brief Adds a single pvar to the list.
+ * @brief Inserts a dict into the list at index, moving later elements up.
  *
- * The dict is duplicated using pvar_copy and stored in a new pvar_t element.
+ * Ownership of value moves to the list as with plist_add_dict_take();
+ * on failure it stays with the caller.
  *
- * @param list The list to add to.
- * @param value The pvar to add (will be duplicated).
+ * @param list The list to insert into.
+ * @param index Where the new element goes, from 0 to plist_get_size(list).
+ * @param value The dict to move into the list.
  */
-void plist_add_pvar(plist_t *list, const pvar_t *value)
+void plist_insert_dict_take(plist_t *list, size_t index, pdict_t *value)
 {
 	pvars_errno = PERRNO_CLEAR;
 
 	if (list == NULL) {
-		pvars_errno = FAILURE_PLIST_ADD_PVAR_NULL_INPUT;
+		pvars_errno = FAILURE_PLIST_INSERT_DICT_TAKE_NULL_INPUT;
 		return;
 	}
 
 	if (value == NULL) {
-		pvars_errno = FAILURE_PLIST_ADD_PVAR_NULL_PVAR_INPUT;
+		pvars_errno = FAILURE_PLIST_INSERT_DICT_TAKE_NULL_DICT_INPUT;
 		return;
 	}
 
-	/* Resize capacity if needed */
-	if (!plist_ensure_capacity(list)) {
-		pvars_errno = FAILURE_PLIST_ADD_PVAR_PLIST_ENSURE_CAPACITY_FAILED;
+	if (index > list->count) {
+		pvars_errno = FAILURE_PLIST_INSERT_DICT_TAKE_OUT_OF_BOUNDS;
 		return;
 	}
 
-	pvar_t new_pvar = pvar_copy(value);
+	if (value->allocator != list->allocator) {
+		pvars_errno = FAILURE_PLIST_INSERT_DICT_TAKE_ALLOCATOR_MISMATCH;
+		return;
+	}
 
-	if (pvars_errno != SUCCESS) {
-		pvars_errno = FAILURE_PLIST_ADD_PVAR_PVAR_COPY_FAILED;
+	if (!plist_accepts(list, PVAR_TYPE_DICT)) {
 		return;
 	}
 
-	list->elements[list->count] = new_pvar;
+	pvar_t *slot = plist_open_slot(list, index);
+	if (slot == NULL) {
+		return;
+	}
 
-	list->count++;
+	slot->data.dt = value;
+	slot->type = PVAR_TYPE_DICT;
 }
 
 /**
@@ -447,36 +2397,67 @@ void plist_empty(plist_t *list)
 		return;
 	}
 
-	for (size_t i = 0; i < list->count; i++) {
-		pvar_destroy_internal(&list->elements[i]);
+	pshare_t *share = atomic_load(&list->share);
+
+	plist_index_drop(list);
+	list->lent = false;
+
+	/* Shared elements are left to the other handles, not copied */
+	if (pshare_is_shared(share)) {
+		void *values = pmem_calloc(list->allocator, list->capacity, list->width);
+		if (values == NULL) {
+			pvars_errno = FAILURE_PLIST_UNSHARE_COPY_FAILED;
+			return;
+		}
+
+		void *shared = list->values;
+		size_t shared_front = list->front;
+		list->values = values;
+		list->front = 0;
+		atomic_store(&list->share, NULL);
+
+		if (pshare_release(list->allocator, share)) {
+			plist_free_elements(list, shared, shared_front, list->count);
+		}
+
+		list->count = 0;
+		return;
 	}
 
-	/* Reset count to 0 */
+	plist_release(list, 0, list->count);
+
+	/* Reset count to 0, the next element goes at the start of the array */
+	memset(list->values, 0, list->count * list->width);
+	list->values = plist_slot(list, 0) - list->front * list->width;
+	list->capacity += list->front;
+	list->front = 0;
 	list->count = 0;
 }
 
 /**
  * @brief Destroys the list, freeing all associated memory.
  *
- * Calls plist_empty() to free element data, then frees the elements array,
- * and finally frees the list structure itself.
+ * Frees element data and the elements array, unless they are still shared
+ * with a copy, and finally frees the list structure itself. A list created
+ * in an arena is left alone: it is released together with the arena.
  *
  * @param list The list to destroy.
  */
 void plist_destroy(plist_t *list)
 {
-	if (list == NULL) {
+	if (list == NULL || parena_owns(list->allocator)) {
 		pvars_errno = SUCCESS; 
 		return;
 	}
 
-	plist_empty(list);
+	plist_index_drop(list);
 
-	if (list->elements != NULL) {
-		free(list->elements);
+	/* Elements still shared with a copy stay with the copy */
+	if (pshare_release(list->allocator, atomic_load(&list->share)) && list->elements != NULL) {
+		plist_free_elements(list, list->values, list->front, list->count);
 	}
 
-	free(list);
+	pmem_free(list->allocator, list, sizeof(plist_t));
 	pvars_errno = SUCCESS;
 }
 
@@ -518,11 +2499,12 @@ void plist_print_internal(const plist_t *list)
 			printf(", ");
 		}
 		
-		pvar_t current = list->elements[i];
+		pvar_t scratch;
+		pvar_t current = *plist_element(list, i, &scratch);
 
 		switch (current.type) {
 			case PVAR_TYPE_STRING:
-				printf("\'%s\'", current.data.s);
+				printf("\'%s\'", pvar_str(&current));
 				break;
 			case PVAR_TYPE_INT:
 				printf("%d", current.data.i);
@@ -587,7 +2569,142 @@ size_t plist_get_capacity(const plist_t *list)
 		return 0;
 	}
 	
-	return list->capacity;
+	return list->front + list->capacity;
+}
+
+/**
+ * @brief Makes room for expected_count elements in total, so that adding up
+ * to that many elements does not reallocate. The capacity is set to exactly
+ * expected_count; the growth policy is not applied.
+ *
+ * @param list The list to grow.
+ * @param expected_count Number of elements the list should hold without
+ * growing. Nothing happens if the capacity is already that large.
+ */
+void plist_reserve(plist_t *list, size_t expected_count)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_RESERVE_NULL_INPUT;
+		return;
+	}
+
+	if (expected_count <= list->capacity) {
+		pvars_errno = SUCCESS;
+		return;
+	}
+
+	if (expected_count > SIZE_MAX / sizeof(pvar_t)) {
+		pvars_errno = FAILURE_PLIST_RESERVE_REALLOC_FAILED;
+		return;
+	}
+
+	if (!plist_unshare(list)) {
+		return;
+	}
+
+	/* Slots left at the front by removals count towards the capacity */
+	if (expected_count <= list->front + list->capacity) {
+		plist_compact_front(list);
+		pvars_errno = SUCCESS;
+		return;
+	}
+
+	if (!plist_resize_now(list, expected_count)) {
+		pvars_errno = FAILURE_PLIST_RESERVE_REALLOC_FAILED;
+		return;
+	}
+
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Shrinks the elements array to the number of elements in the list
+ * (at least one slot), returning the memory a list that once grew large
+ * still holds after most of its elements were removed.
+ *
+ * @param list The list to shrink.
+ */
+void plist_shrink_to_fit(plist_t *list)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_SHRINK_TO_FIT_NULL_INPUT;
+		return;
+	}
+
+	size_t needed = list->count > 0 ? list->count : 1;
+	if (needed >= list->front + list->capacity) {
+		pvars_errno = SUCCESS;
+		return;
+	}
+
+	if (!plist_unshare(list)) {
+		return;
+	}
+
+	if (!plist_resize_now(list, needed)) {
+		pvars_errno = FAILURE_PLIST_SHRINK_TO_FIT_REALLOC_FAILED;
+		return;
+	}
+
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Sets how the list grows when an add finds it full.
+ *
+ * PLIST_GROWTH_DOUBLE (the default) reallocates least often, PLIST_GROWTH_HALF
+ * leaves less of the array unused, and PLIST_GROWTH_CHUNK adds chunk slots at
+ * a time, which bounds the unused space but makes growing by n elements cost
+ * O(n / chunk) reallocs. Copies of the list keep its policy.
+ *
+ * @param list The list to configure.
+ * @param policy The growth policy.
+ * @param chunk Slots added per step under PLIST_GROWTH_CHUNK, must be >= 1.
+ * Ignored by the other policies.
+ */
+void plist_set_growth_policy(plist_t *list, plist_growth_policy policy, size_t chunk)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_SET_GROWTH_POLICY_NULL_INPUT;
+		return;
+	}
+
+	if (policy != PLIST_GROWTH_DOUBLE && policy != PLIST_GROWTH_HALF && policy != PLIST_GROWTH_CHUNK) {
+		pvars_errno = FAILURE_PLIST_SET_GROWTH_POLICY_UNKNOWN_POLICY;
+		return;
+	}
+
+	if (policy == PLIST_GROWTH_CHUNK && chunk < 1) {
+		pvars_errno = FAILURE_PLIST_SET_GROWTH_POLICY_CHUNK_OUT_OF_BOUNDS;
+		return;
+	}
+
+	list->growth = policy;
+	list->growth_chunk = policy == PLIST_GROWTH_CHUNK ? chunk : 0;
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Returns how the list grows when it is full.
+ *
+ * @param list The list to query.
+ * @return The growth policy, or PLIST_GROWTH_DOUBLE if the list is NULL.
+ */
+plist_growth_policy plist_get_growth_policy(const plist_t *list)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		return PLIST_GROWTH_DOUBLE;
+	}
+
+	return list->growth;
 }
 
 /**
@@ -610,10 +2727,107 @@ pvar_type plist_get_type(const plist_t *list, size_t index)
 		pvars_errno = FAILURE_PLIST_GET_TYPE_OUT_OF_BOUNDS;
 		return PVAR_TYPE_NONE;
 	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		return list->column;
+	}
 	
 	return list->elements[index].type;
 }
 
+/**
+ * @brief Returns the type every element of a typed list has.
+ *
+ * @param list The list to query.
+ * @return The element type of a list made by plist_create_typed(), or
+ * PVAR_TYPE_NONE for a list that may hold any type (or a NULL list).
+ */
+pvar_type plist_get_column_type(const plist_t *list)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		return PVAR_TYPE_NONE;
+	}
+
+	return list->column;
+}
+
+/**
+ * @brief Borrows the packed numbers of a typed list without copying them.
+ *
+ * *out_data points to plist_get_size() values of the list's type (an int,
+ * long, double or float array; see plist_get_column_type()). It stays valid
+ * until the list is modified, emptied or destroyed, and must not be written
+ * through: copies of the list may share it. Use plist_borrow_span_mutable()
+ * to change values in place.
+ *
+ * @param list A typed list.
+ * @param out_data Receives the address of the first value.
+ * @param out_count Receives the number of values.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool plist_borrow_span(const plist_t *list, const void **out_data, size_t *out_count)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL || out_data == NULL || out_count == NULL) {
+		pvars_errno = FAILURE_PLIST_BORROW_SPAN_NULL_INPUT;
+		return false;
+	}
+
+	if (list->column == PVAR_TYPE_NONE) {
+		pvars_errno = FAILURE_PLIST_BORROW_SPAN_NOT_TYPED;
+		return false;
+	}
+
+	*out_data = list->values;
+	*out_count = list->count;
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Borrows the packed numbers of a typed list for writing in place.
+ *
+ * Like plist_borrow_span(), but the list first takes its own copy of values
+ * it shares with copies, so writes through *out_data change this list only.
+ * Adding or removing elements invalidates the pointer. Writes through it
+ * bypass the hash index of an indexed list, so searches scan the list
+ * until it is emptied or plist_set_indexed() is called again.
+ *
+ * @param list A typed list.
+ * @param out_data Receives the address of the first value.
+ * @param out_count Receives the number of values.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool plist_borrow_span_mutable(plist_t *list, void **out_data, size_t *out_count)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL || out_data == NULL || out_count == NULL) {
+		pvars_errno = FAILURE_PLIST_BORROW_SPAN_MUTABLE_NULL_INPUT;
+		return false;
+	}
+
+	if (list->column == PVAR_TYPE_NONE) {
+		pvars_errno = FAILURE_PLIST_BORROW_SPAN_MUTABLE_NOT_TYPED;
+		return false;
+	}
+
+	if (!plist_unshare(list)) {
+		return false;
+	}
+	list->lent = true;
+
+	*out_data = list->values;
+	*out_count = list->count;
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
 /**
  * @brief Retrieves the string value at a given index.
  *
@@ -643,19 +2857,113 @@ bool plist_get_str(const plist_t *list, size_t index, char **out_value)
 		return false;
 	}
 	
-	pvar_t *element = &list->elements[index];
+	pvar_t scratch;
+	const pvar_t *element = plist_element(list, index, &scratch);
 
 	if (element->type != PVAR_TYPE_STRING) {
 		pvars_errno = FAILURE_PLIST_GET_STR_WRONG_TYPE;
 		return false;
 	}
 	
-	*out_value = strdup(element->data.s);
-	if (*out_value == NULL) {
-		pvars_errno = FAILURE_PLIST_GET_STR_STRDUP_FAILED;
+	*out_value = strdup(pvar_str(element));
+	if (*out_value == NULL) {
+		pvars_errno = FAILURE_PLIST_GET_STR_STRDUP_FAILED;
+		return false;
+	}
+	
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Borrows the string value at a given index without copying it.
+ *
+ * The returned pointer refers to the list's own storage. It stays valid
+ * until the element is modified or removed, or the list is emptied or
+ * destroyed, and must not be freed by the caller. A string shorter than
+ * PVAR_INLINE_STR_SIZE lives inside the element, so adding to the list or
+ * removing an earlier element invalidates the pointer as well.
+ *
+ * @param list The list to read from.
+ * @param index The index of the element to borrow.
+ * @param out_value Pointer where the borrowed string should be stored.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool plist_borrow_str(const plist_t *list, size_t index, const char **out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_BORROW_STR_NULL_INPUT;
+		return false;
+	}
+
+	if (index >= list->count) {
+		pvars_errno = FAILURE_PLIST_BORROW_STR_OUT_OF_BOUNDS;
+		return false;
+	}
+	
+	if (out_value == NULL) {
+		pvars_errno = FAILURE_PLIST_BORROW_STR_NULL_INPUT_OUT_VALUE;
+		return false;
+	}
+	
+	pvar_t scratch;
+	const pvar_t *element = plist_element(list, index, &scratch);
+
+	if (element->type != PVAR_TYPE_STRING) {
+		pvars_errno = FAILURE_PLIST_BORROW_STR_WRONG_TYPE;
+		return false;
+	}
+	
+	*out_value = pvar_str(element);
+	
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Borrows the string value at a given index together with its length.
+ *
+ * The length counts every byte, including embedded NULs. The pointer follows
+ * the same rules as plist_borrow_str().
+ *
+ * @param list The list to read from.
+ * @param index The index of the element to borrow.
+ * @param out_value Pointer where the borrowed bytes should be stored.
+ * @param out_len Pointer where their length should be stored.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool plist_borrow_strn(const plist_t *list, size_t index, const char **out_value, size_t *out_len)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_BORROW_STRN_NULL_INPUT;
+		return false;
+	}
+
+	if (index >= list->count) {
+		pvars_errno = FAILURE_PLIST_BORROW_STRN_OUT_OF_BOUNDS;
+		return false;
+	}
+	
+	if (out_value == NULL || out_len == NULL) {
+		pvars_errno = FAILURE_PLIST_BORROW_STRN_NULL_INPUT_OUT_VALUE;
+		return false;
+	}
+	
+	pvar_t scratch;
+	const pvar_t *element = plist_element(list, index, &scratch);
+
+	if (element->type != PVAR_TYPE_STRING) {
+		pvars_errno = FAILURE_PLIST_BORROW_STRN_WRONG_TYPE;
 		return false;
 	}
 	
+	*out_value = pvar_str(element);
+	*out_len = pvar_str_len(element);
+	
 	pvars_errno = SUCCESS;
 	return true;
 }
@@ -683,7 +2991,8 @@ bool plist_get_int(const plist_t *list, size_t index, int *out_value)
 		return false;
 	}
 	
-	pvar_t *element = &list->elements[index];
+	pvar_t scratch;
+	const pvar_t *element = plist_element(list, index, &scratch);
 
 	// Check type before accessing data.i
 	if (element->type != PVAR_TYPE_INT) {
@@ -720,7 +3029,8 @@ bool plist_get_double(const plist_t *list, size_t index, double *out_value)
 		return false;
 	}
 	
-	pvar_t *element = &list->elements[index];
+	pvar_t scratch;
+	const pvar_t *element = plist_element(list, index, &scratch);
 
 	// Check type before accessing data.d
 	if (element->type != PVAR_TYPE_DOUBLE) {
@@ -757,7 +3067,8 @@ bool plist_get_long(const plist_t *list, size_t index, long *out_value)
 		return false;
 	}
 	
-	pvar_t *element = &list->elements[index];
+	pvar_t scratch;
+	const pvar_t *element = plist_element(list, index, &scratch);
 
 	// Check type before accessing data.i
 	if (element->type != PVAR_TYPE_LONG) {
@@ -794,7 +3105,8 @@ bool plist_get_float(const plist_t *list, size_t index, float *out_value)
 		return false;
 	}
 	
-	pvar_t *element = &list->elements[index];
+	pvar_t scratch;
+	const pvar_t *element = plist_element(list, index, &scratch);
 
 	// Check type before accessing data.d
 	if (element->type != PVAR_TYPE_FLOAT) {
@@ -814,6 +3126,9 @@ bool plist_get_float(const plist_t *list, size_t index, float *out_value)
  * Performs boundary checks and checks if the element's type is PVAR_TYPE_LIST.
  * The retrieved value is written to the pointer `out_value`.
  *
+ * The caller owns the retrieved list and destroys it. It is a copy-on-write
+ * copy (see plist_copy()), so retrieving it costs O(1) whatever its size.
+ *
  * @param list The list to read from.
  * @param index The index of the element to retrieve.
  * @param out_value Pointer where the retrieved list value should be stored.
@@ -836,7 +3151,8 @@ bool plist_get_list(const plist_t *list, size_t index, plist_t **out_value)
 		return false;
 	}
 	
-	pvar_t *element = &list->elements[index];
+	pvar_t scratch;
+	const pvar_t *element = plist_element(list, index, &scratch);
 
 	if (element->type != PVAR_TYPE_LIST) {
 		pvars_errno = FAILURE_PLIST_GET_LIST_WRONG_TYPE;
@@ -853,12 +3169,60 @@ bool plist_get_list(const plist_t *list, size_t index, plist_t **out_value)
 	return true;
 }
 
+/**
+ * @brief Borrows the list value at a given index without copying it.
+ *
+ * The returned pointer refers to the list's own storage. It stays valid
+ * until the element is modified or removed, or the list is emptied or
+ * destroyed, and must not be freed by the caller.
+ *
+ * @param list The list to read from.
+ * @param index The index of the element to borrow.
+ * @param out_value Pointer where the borrowed list should be stored.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool plist_borrow_list(const plist_t *list, size_t index, const plist_t **out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_BORROW_LIST_NULL_INPUT;
+		return false;
+	}
+
+	if (index >= list->count) {
+		pvars_errno = FAILURE_PLIST_BORROW_LIST_OUT_OF_BOUNDS;
+		return false;
+	}
+	
+	if (out_value == NULL) {
+		pvars_errno = FAILURE_PLIST_BORROW_LIST_NULL_INPUT_OUT_VALUE;
+		return false;
+	}
+	
+	pvar_t scratch;
+	const pvar_t *element = plist_element(list, index, &scratch);
+
+	if (element->type != PVAR_TYPE_LIST) {
+		pvars_errno = FAILURE_PLIST_BORROW_LIST_WRONG_TYPE;
+		return false;
+	}
+	
+	*out_value = element->data.ls;
+	
+	pvars_errno = SUCCESS;
+	return true;
+}
+
 /**
  * @brief Retrieves the dict value at a given index.
  *
  * Performs boundary checks and checks if the element's type is PVAR_TYPE_DICT.
  * The retrieved value is written to the pointer `out_value`.
  *
+ * The caller owns the retrieved dict and destroys it. It is a copy-on-write
+ * copy (see pdict_copy()), so retrieving it costs O(1) whatever its size.
+ *
  * @param list The list to read from.
  * @param index The index of the element to retrieve.
  * @param out_value Pointer where the retrieved dict value should be stored.
@@ -881,7 +3245,8 @@ bool plist_get_dict(const plist_t *list, size_t index, pdict_t **out_value)
 		return false;
 	}
 	
-	pvar_t *element = &list->elements[index];
+	pvar_t scratch;
+	const pvar_t *element = plist_element(list, index, &scratch);
 
 	if (element->type != PVAR_TYPE_DICT) {
 		pvars_errno = FAILURE_PLIST_GET_DICT_WRONG_TYPE;
@@ -898,13 +3263,59 @@ bool plist_get_dict(const plist_t *list, size_t index, pdict_t **out_value)
 	return true;
 }
 
+/**
+ * @brief Borrows the dict value at a given index without copying it.
+ *
+ * The returned pointer refers to the list's own storage. It stays valid
+ * until the element is modified or removed, or the list is emptied or
+ * destroyed, and must not be freed by the caller.
+ *
+ * @param list The list to read from.
+ * @param index The index of the element to borrow.
+ * @param out_value Pointer where the borrowed dict should be stored.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool plist_borrow_dict(const plist_t *list, size_t index, const pdict_t **out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_BORROW_DICT_NULL_INPUT;
+		return false;
+	}
+
+	if (index >= list->count) {
+		pvars_errno = FAILURE_PLIST_BORROW_DICT_OUT_OF_BOUNDS;
+		return false;
+	}
+	
+	if (out_value == NULL) {
+		pvars_errno = FAILURE_PLIST_BORROW_DICT_NULL_INPUT_OUT_VALUE;
+		return false;
+	}
+	
+	pvar_t scratch;
+	const pvar_t *element = plist_element(list, index, &scratch);
+
+	if (element->type != PVAR_TYPE_DICT) {
+		pvars_errno = FAILURE_PLIST_BORROW_DICT_WRONG_TYPE;
+		return false;
+	}
+	
+	*out_value = element->data.dt;
+	
+	pvars_errno = SUCCESS;
+	return true;
+}
+
 
 
 /**
  * @brief Sets the string value at a given index.
  *
  * The existing content of the element is freed first (if it was a string).
- * A copy of the new string is stored, and the element's type is set to STRING.
+ * A copy of the new string is stored, inline if it is shorter than
+ * PVAR_INLINE_STR_SIZE, and the element's type is set to STRING.
  *
  * @param list The list to modify.
  * @param index The index of the element to set.
@@ -924,23 +3335,85 @@ void plist_set_str(plist_t *list, size_t index, const char *new_string)
 		return;
 	}
 
+	if (!plist_accepts(list, PVAR_TYPE_STRING)) {
+		return;
+	}
+
 	if (new_string == NULL) {
 		pvars_errno = FAILURE_PLIST_SET_STR_NULL_STRING_INPUT;
 		return;
 	}
 	
+	// Copied before the old value is released: new_string may be borrowed from it
+	pvar_t new_pvar;
+
+	if (!pvar_set_str_in(list->allocator, &new_pvar, new_string)) {
+		pvars_errno = FAILURE_PLIST_SET_STR_STRDUP_FAILED;
+		return;
+	}
+
+	if (!plist_unshare(list)) {
+		pvar_destroy_in(list->allocator, &new_pvar);
+		return;
+	}
+
 	pvar_t *element = &list->elements[index];
 
-	pvar_destroy_internal(element);
+	pvar_destroy_in(list->allocator, element);
+	*element = new_pvar;
+}
 
-	char *current_str = strdup(new_string);
-	if (current_str == NULL) {
-		pvars_errno = FAILURE_PLIST_SET_STR_STRDUP_FAILED;
+/**
+ * @brief Sets the string value at a given index from len bytes, which may
+ * contain NULs.
+ *
+ * @param list The list to modify.
+ * @param index The index of the element to set.
+ * @param new_string The bytes to store (will be copied).
+ * @param len Number of bytes.
+ */
+void plist_set_strn(plist_t *list, size_t index, const char *new_string, size_t len)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_SET_STRN_NULL_INPUT;
+		return;
+	}
+
+	if (index >= list->count) {
+		pvars_errno = FAILURE_PLIST_SET_STRN_OUT_OF_BOUNDS;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_STRING)) {
+		return;
+	}
+
+	if (new_string == NULL) {
+		pvars_errno = FAILURE_PLIST_SET_STRN_NULL_STRING_INPUT;
+		return;
+	}
+	
+	// Copied before the old value is released: new_string may be borrowed from it
+	pvar_t new_pvar;
+
+	if (!pvar_set_strn_in(list->allocator, &new_pvar, new_string, len)) {
+		pvars_errno = FAILURE_PLIST_SET_STRN_STRDUP_FAILED;
 		return;
 	}
 
-	element->data.s = current_str;
-	element->type = PVAR_TYPE_STRING;
+	if (!plist_unshare(list)) {
+		pvar_destroy_in(list->allocator, &new_pvar);
+		return;
+	}
+
+	pvar_t *element = &list->elements[index];
+
+	pvar_destroy_in(list->allocator, element);
+	*element = new_pvar;
+
+	pvars_errno = SUCCESS;
 }
 
 /**
@@ -966,10 +3439,23 @@ void plist_set_int(plist_t *list, size_t index, int new_value)
 		pvars_errno = FAILURE_PLIST_SET_INT_OUT_OF_BOUNDS;
 		return;
 	}
+
+	if (!plist_accepts(list, PVAR_TYPE_INT)) {
+		return;
+	}
 	
+	if (!plist_unshare(list)) {
+		return;
+	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		((int *)list->values)[index] = new_value;
+		return;
+	}
+
 	pvar_t *element = &list->elements[index];
 
-	pvar_destroy_internal(element);
+	pvar_destroy_in(list->allocator, element);
 
 	element->data.i = new_value;
 	element->type = PVAR_TYPE_INT;
@@ -998,10 +3484,23 @@ void plist_set_double(plist_t *list, size_t index, double new_value)
 		pvars_errno = FAILURE_PLIST_SET_DOUBLE_OUT_OF_BOUNDS;
 		return;
 	}
+
+	if (!plist_accepts(list, PVAR_TYPE_DOUBLE)) {
+		return;
+	}
 	
+	if (!plist_unshare(list)) {
+		return;
+	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		((double *)list->values)[index] = new_value;
+		return;
+	}
+
 	pvar_t *element = &list->elements[index];
 
-	pvar_destroy_internal(element);
+	pvar_destroy_in(list->allocator, element);
 
 	element->data.d = new_value;
 	element->type = PVAR_TYPE_DOUBLE;
@@ -1030,10 +3529,23 @@ void plist_set_long(plist_t *list, size_t index, long new_value)
 		pvars_errno = FAILURE_PLIST_SET_LONG_OUT_OF_BOUNDS;
 		return;
 	}
+
+	if (!plist_accepts(list, PVAR_TYPE_LONG)) {
+		return;
+	}
 	
+	if (!plist_unshare(list)) {
+		return;
+	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		((long *)list->values)[index] = new_value;
+		return;
+	}
+
 	pvar_t *element = &list->elements[index];
 
-	pvar_destroy_internal(element);
+	pvar_destroy_in(list->allocator, element);
 
 	element->data.l = new_value;
 	element->type = PVAR_TYPE_LONG;
@@ -1062,10 +3574,23 @@ void plist_set_float(plist_t *list, size_t index, float new_value)
 		pvars_errno = FAILURE_PLIST_SET_FLOAT_OUT_OF_BOUNDS;
 		return;
 	}
+
+	if (!plist_accepts(list, PVAR_TYPE_FLOAT)) {
+		return;
+	}
 	
+	if (!plist_unshare(list)) {
+		return;
+	}
+
+	if (list->column != PVAR_TYPE_NONE) {
+		((float *)list->values)[index] = new_value;
+		return;
+	}
+
 	pvar_t *element = &list->elements[index];
 
-	pvar_destroy_internal(element);
+	pvar_destroy_in(list->allocator, element);
 
 	element->data.f = new_value;
 	element->type = PVAR_TYPE_FLOAT;
@@ -1095,20 +3620,29 @@ void plist_set_list(plist_t *list, size_t index, const plist_t *new_list)
 		return;
 	}
 
+	if (!plist_accepts(list, PVAR_TYPE_LIST)) {
+		return;
+	}
+
 	if (new_list == NULL) {
 		pvars_errno = FAILURE_PLIST_SET_LIST_NULL_LIST_INPUT;
 		return;
 	}
 
-	plist_t *deep_list = plist_copy(new_list);
+	plist_t *deep_list = plist_copy_in(list->allocator, new_list);
 	if (deep_list == NULL) {
 		pvars_errno = FAILURE_PLIST_SET_LIST_PLIST_COPY_FAILED;
 		return;
 	}
 		
+	if (!plist_unshare(list)) {
+		plist_destroy(deep_list);
+		return;
+	}
+
 	pvar_t *element = &list->elements[index];
 
-	pvar_destroy_internal(element);
+	pvar_destroy_in(list->allocator, element);
 
 	element->data.ls = deep_list;
 	element->type = PVAR_TYPE_LIST;
@@ -1138,29 +3672,149 @@ void plist_set_dict(plist_t *list, size_t index, const pdict_t *new_dict)
 		return;
 	}
 
+	if (!plist_accepts(list, PVAR_TYPE_DICT)) {
+		return;
+	}
+
 	if (new_dict == NULL) {
 		pvars_errno = FAILURE_PLIST_SET_DICT_NULL_DICT_INPUT;
 		return;
 	}
 	
-	pvar_t *element = &list->elements[index];
-
-	pvar_destroy_internal(element);
-
-	pdict_t *current_dict = pdict_copy(new_dict);
+	pdict_t *current_dict = pdict_copy_in(list->allocator, new_dict);
 	if (current_dict == NULL) {
 		pvars_errno = FAILURE_PLIST_SET_DICT_PDICT_COPY_FAILED;
 		return;
 	}
 
+	if (!plist_unshare(list)) {
+		pdict_destroy(current_dict);
+		return;
+	}
+
+	pvar_t *element = &list->elements[index];
+
+	pvar_destroy_in(list->allocator, element);
+
 	element->data.dt = current_dict;
 	element->type = PVAR_TYPE_DICT;
 }
 
+/**
+ * @brief Sets the list value at a given index, taking ownership of it
+ * instead of copying.
+ *
+ * The existing content of the element is freed first. On success the list
+ * owns new_list; on failure ownership stays with the caller.
+ *
+ * @param list The list to modify.
+ * @param index The index of the element to set.
+ * @param new_list The list to move into the list.
+ */
+void plist_set_list_take(plist_t *list, size_t index, plist_t *new_list)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_SET_LIST_TAKE_NULL_INPUT;
+		return;
+	}
+
+	if (index >= list->count) {
+		pvars_errno = FAILURE_PLIST_SET_LIST_TAKE_OUT_OF_BOUNDS;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_LIST)) {
+		return;
+	}
+
+	if (new_list == NULL) {
+		pvars_errno = FAILURE_PLIST_SET_LIST_TAKE_NULL_LIST_INPUT;
+		return;
+	}
+
+	if (new_list->allocator != list->allocator) {
+		pvars_errno = FAILURE_PLIST_SET_LIST_TAKE_ALLOCATOR_MISMATCH;
+		return;
+	}
+
+	if (new_list == list) {
+		pvars_errno = FAILURE_PLIST_SET_LIST_TAKE_SELF_INSERT;
+		return;
+	}
+
+	if (!plist_unshare(list)) {
+		return;
+	}
+
+	pvar_t *element = &list->elements[index];
+
+	pvar_destroy_in(list->allocator, element);
+
+	element->data.ls = new_list;
+	element->type = PVAR_TYPE_LIST;
+}
+
+/**
+ * @brief Sets the dict value at a given index, taking ownership of it
+ * instead of copying.
+ *
+ * The existing content of the element is freed first. On success the list
+ * owns new_dict; on failure ownership stays with the caller.
+ *
+ * @param list The list to modify.
+ * @param index The index of the element to set.
+ * @param new_dict The dict to move into the list.
+ */
+void plist_set_dict_take(plist_t *list, size_t index, pdict_t *new_dict)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_SET_DICT_TAKE_NULL_INPUT;
+		return;
+	}
+
+	if (index >= list->count) {
+		pvars_errno = FAILURE_PLIST_SET_DICT_TAKE_OUT_OF_BOUNDS;
+		return;
+	}
+
+	if (!plist_accepts(list, PVAR_TYPE_DICT)) {
+		return;
+	}
+
+	if (new_dict == NULL) {
+		pvars_errno = FAILURE_PLIST_SET_DICT_TAKE_NULL_DICT_INPUT;
+		return;
+	}
+
+	if (new_dict->allocator != list->allocator) {
+		pvars_errno = FAILURE_PLIST_SET_DICT_TAKE_ALLOCATOR_MISMATCH;
+		return;
+	}
+
+	if (!plist_unshare(list)) {
+		return;
+	}
+
+	pvar_t *element = &list->elements[index];
+
+	pvar_destroy_in(list->allocator, element);
+
+	element->data.dt = new_dict;
+	element->type = PVAR_TYPE_DICT;
+}
+
 
 /**
  * @brief Checks for item in list.
  *
+ * A string is measured and hashed once; elements are then rejected on
+ * length and cached hash before their bytes are compared. Lists marked
+ * with plist_set_indexed() are searched through a hash index instead.
+ *
  * @param list of elements
  * @param element to find in list
  */
@@ -1173,12 +3827,9 @@ bool plist_contains(const plist_t *list, pvar_t *element_to_find)
 		return false;
 	}
 
-	for (size_t i = 0; i < list->count; i++) {
-		/* Return true if pvar_equals returns true */
-		if (pvar_equals(&list->elements[i], element_to_find)) {
-			return true;
-		}
-	}
-	
-	return false;
+	size_t index = 0;
+	bool found = plist_search(list, element_to_find, &index, NULL);
+
+	pvars_errno = SUCCESS;
+	return found;
 }
@@ -0,0 +1,353 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<stdatomic.h>
+#include<stdint.h>
+#include<string.h>
+
+#include"pvars.h"
+#include"perrno.h"
+#include"pvars_internal.h"
+#include"plist_internal.h"
+#include"pmem_internal.h"
+#include"pstr_internal.h"
+
+/*
+ * Searching lists: plist_contains(), plist_index_of() and plist_count_of().
+ *
+ * A list marked with plist_set_indexed() gets a hash index the first time
+ * it is searched: an open addressing table, probed linearly, holding the
+ * position of every string, int, long and empty element. The index is
+ * dropped by the next change to the list (see plist_unshare()) and rebuilt
+ * by the next search, so it suits lists that are searched far more often
+ * than they change. Equal values share a probe run in list order, and no
+ * element is ever deleted from a built index, so the first match found is
+ * the first in the list.
+ *
+ * Doubles and floats compare equal within an epsilon (see pvar_equals()),
+ * which no hash can follow, and lists and dicts never compare equal; those
+ * values are always found by scanning.
+ */
+
+#define PLIST_INDEX_MIN_COUNT 16 /* Shorter lists are scanned, indexed or not */
+#define PLIST_INDEX_MIN_SLOTS 16
+
+/**
+ * @brief One slot of the index.
+ */
+typedef struct {
+	uint64_t hash;   // plist_value_hash() of the element
+	size_t position; // Element index + 1, 0 for an empty slot
+} plist_index_slot_t;
+
+struct plist_index_t {
+	size_t mask;  // Slots - 1, the number of slots being a power of two
+	size_t bytes; // Size of the allocation
+	plist_index_slot_t slots[];
+};
+
+/**
+ * @brief Tells whether values of a type can be found through the index.
+ */
+static bool plist_hashable(pvar_type type)
+{
+	return type == PVAR_TYPE_STRING || type == PVAR_TYPE_INT || type == PVAR_TYPE_LONG || type == PVAR_TYPE_NONE;
+}
+
+/**
+ * @brief Hashes a value of a hashable type. Ints and longs with equal
+ * values hash alike; the comparison tells them apart.
+ */
+static uint64_t plist_value_hash(const pvar_t *value)
+{
+	int64_t number;
+
+	switch (value->type) {
+		case PVAR_TYPE_STRING:
+			if (value->str_tag == PVAR_STR_HEADER) {
+				const pstr_t *header = pstr_header(value->data.s);
+				if (header->flags & PSTR_FLAG_HASHED) {
+					return header->hash;
+				}
+			}
+			return pstr_hash_bytes(pvar_str(value), pvar_str_len(value));
+		case PVAR_TYPE_INT:
+			number = value->data.i;
+			return pstr_hash_bytes(&number, sizeof(number));
+		case PVAR_TYPE_LONG:
+			number = value->data.l;
+			return pstr_hash_bytes(&number, sizeof(number));
+		default:
+			return 0;
+	}
+}
+
+/**
+ * @brief Compares an element with the value searched for, without touching
+ * pvars_errno.
+ *
+ * @param element The element.
+ * @param needle The value, holding a plain string.
+ * @param len Length of the needle's string.
+ * @param hash pstr_hash_bytes() of the needle's string.
+ * @return True if they are equal as defined by pvar_equals().
+ */
+static bool plist_matches(const pvar_t *element, const pvar_t *needle, size_t len, uint64_t hash)
+{
+	if (element->type != needle->type) {
+		return false;
+	}
+
+	switch (needle->type) {
+		case PVAR_TYPE_STRING:
+			return pvar_str_equals(element, needle->data.s, len, hash);
+		case PVAR_TYPE_LIST:
+		case PVAR_TYPE_DICT:
+			return false;
+		default:
+			return pvar_equals((pvar_t *)element, (pvar_t *)needle);
+	}
+}
+
+/**
+ * @brief Builds the index of a list.
+ *
+ * @return The index, or NULL if it could not be allocated.
+ */
+static plist_index_t *plist_index_build(const plist_t *list)
+{
+	pvar_t scratch;
+	size_t hashable = 0;
+
+	for (size_t i = 0; i < list->count; i++) {
+		hashable += plist_hashable((pvar_type)plist_element(list, i, &scratch)->type);
+	}
+
+	/* Keeps the load factor at or below 1/2 */
+	size_t slots = PLIST_INDEX_MIN_SLOTS;
+	while (slots < hashable * 2) {
+		slots *= 2;
+	}
+
+	size_t bytes = sizeof(plist_index_t) + slots * sizeof(plist_index_slot_t);
+	plist_index_t *index = pmem_calloc(list->allocator, 1, bytes);
+	if (index == NULL) {
+		return NULL;
+	}
+
+	index->mask = slots - 1;
+	index->bytes = bytes;
+
+	for (size_t i = 0; i < list->count; i++) {
+		const pvar_t *element = plist_element(list, i, &scratch);
+		if (!plist_hashable((pvar_type)element->type)) {
+			continue;
+		}
+
+		uint64_t hash = plist_value_hash(element);
+		size_t slot = (size_t)hash & index->mask;
+		while (index->slots[slot].position != 0) {
+			slot = (slot + 1) & index->mask;
+		}
+		index->slots[slot].hash = hash;
+		index->slots[slot].position = i + 1;
+	}
+
+	return index;
+}
+
+/**
+ * @brief Returns the index of an indexed list, building it if needed.
+ *
+ * Searches only read the list, so several threads may race to build the
+ * index; the first to publish it wins and the others free their copies.
+ *
+ * @return The index, or NULL if the list is not indexed, too short to
+ * benefit, or the index could not be allocated.
+ */
+static const plist_index_t *plist_index_get(const plist_t *list)
+{
+	if (!list->indexed || list->lent || list->count < PLIST_INDEX_MIN_COUNT) {
+		return NULL;
+	}
+
+	plist_t *cache = (plist_t *)list;
+	plist_index_t *index = atomic_load(&cache->index);
+	if (index != NULL) {
+		return index;
+	}
+
+	plist_index_t *built = plist_index_build(list);
+	if (built == NULL) {
+		return NULL;
+	}
+
+	if (!atomic_compare_exchange_strong(&cache->index, &index, built)) {
+		pmem_free(list->allocator, built, built->bytes);
+		return index;
+	}
+
+	return built;
+}
+
+/**
+ * @brief Frees the index of a list, if it has one. Called before every
+ * change to the list.
+ */
+void plist_index_drop(plist_t *list)
+{
+	plist_index_t *index = atomic_exchange(&list->index, NULL);
+
+	if (index != NULL) {
+		pmem_free(list->allocator, index, index->bytes);
+	}
+}
+
+/**
+ * @brief Looks for a value in a list, through its index if it has one.
+ *
+ * @param list The list.
+ * @param value The value to find.
+ * @param out_index Receives the index of the first match, if any.
+ * @param out_count If not NULL, receives the number of matches, which
+ * means searching past the first one.
+ * @return True if the value was found.
+ */
+bool plist_search(const plist_t *list, const pvar_t *value, size_t *out_index, size_t *out_count)
+{
+	/* A caller's value keeps its string in data.s */
+	pvar_t needle = *value;
+	needle.str_tag = PVAR_STR_PLAIN;
+
+	size_t len = needle.type == PVAR_TYPE_STRING ? strlen(needle.data.s) : 0;
+	size_t matches = 0;
+	pvar_t scratch;
+
+	if (list->column != PVAR_TYPE_NONE && needle.type != list->column) {
+		if (out_count != NULL) {
+			*out_count = 0;
+		}
+		return false;
+	}
+
+	const plist_index_t *index = plist_hashable((pvar_type)needle.type) ? plist_index_get(list) : NULL;
+	uint64_t hash = needle.type == PVAR_TYPE_STRING || index != NULL ? plist_value_hash(&needle) : 0;
+
+	if (index != NULL) {
+		for (size_t slot = (size_t)hash & index->mask; index->slots[slot].position != 0; slot = (slot + 1) & index->mask) {
+			size_t position = index->slots[slot].position - 1;
+
+			if (index->slots[slot].hash != hash || !plist_matches(plist_element(list, position, &scratch), &needle, len, hash)) {
+				continue;
+			}
+			if (matches++ == 0) {
+				*out_index = position;
+			}
+			if (out_count == NULL) {
+				break;
+			}
+		}
+	} else {
+		for (size_t i = 0; i < list->count; i++) {
+			if (!plist_matches(plist_element(list, i, &scratch), &needle, len, hash)) {
+				continue;
+			}
+			if (matches++ == 0) {
+				*out_index = i;
+			}
+			if (out_count == NULL) {
+				break;
+			}
+		}
+	}
+
+	if (out_count != NULL) {
+		*out_count = matches;
+	}
+	return matches > 0;
+}
+
+/**
+ * @brief Gives a list a hash index for searches, or takes it away.
+ *
+ * An indexed list answers plist_contains(), plist_index_of() and
+ * plist_count_of() for strings, ints and longs in about constant time.
+ * The index is built by the first search, takes 32 to 64 bytes per element
+ * and is rebuilt by the first search after each change, so it pays off for
+ * lists that are searched many times between changes. Once a span is
+ * borrowed with plist_borrow_span_mutable(), searches scan the list, since
+ * writes through the span would leave the index stale; calling this
+ * function again, once those writes are done, lets them use it again.
+ * Copies of an indexed list are indexed too.
+ *
+ * @param list The list.
+ * @param indexed True to index the list, false to scan it on every search.
+ */
+void plist_set_indexed(plist_t *list, bool indexed)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL) {
+		pvars_errno = FAILURE_PLIST_SET_INDEXED_NULL_INPUT;
+		return;
+	}
+
+	list->indexed = indexed;
+	list->lent = false;
+	plist_index_drop(list);
+
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Finds the first element of a list equal to a value.
+ *
+ * Values are compared as by plist_contains().
+ *
+ * @param list The list to search.
+ * @param value The value to find.
+ * @param out_index Receives the index of the first equal element.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool plist_index_of(const plist_t *list, const pvar_t *value, size_t *out_index)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL || value == NULL || out_index == NULL) {
+		pvars_errno = FAILURE_PLIST_INDEX_OF_NULL_INPUT;
+		return false;
+	}
+
+	if (!plist_search(list, value, out_index, NULL)) {
+		pvars_errno = FAILURE_PLIST_INDEX_OF_NOT_FOUND;
+		return false;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Counts the elements of a list equal to a value.
+ *
+ * Values are compared as by plist_contains().
+ *
+ * @param list The list to search.
+ * @param value The value to count.
+ * @return The number of equal elements, 0 on failure (with pvars_errno set).
+ */
+size_t plist_count_of(const plist_t *list, const pvar_t *value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL || value == NULL) {
+		pvars_errno = FAILURE_PLIST_COUNT_OF_NULL_INPUT;
+		return 0;
+	}
+
+	size_t index = 0;
+	size_t count = 0;
+	plist_search(list, value, &index, &count);
+
+	pvars_errno = SUCCESS;
+	return count;
+}
@@ -0,0 +1,513 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<math.h>
+#include<pthread.h>
+#include<stddef.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include<immintrin.h>
+#define PLIST_REDUCE_AVX2 1
+#endif
+
+#include"pvars.h"
+#include"perrno.h"
+#include"plist_internal.h"
+
+/*
+ * Numeric reductions over a list: plist_sum(), plist_min(), plist_max(),
+ * plist_mean() and plist_variance().
+ *
+ * A typed list (plist_create_typed()) is reduced straight from its packed
+ * array by a kernel for its column type. On x86 the kernels for doubles,
+ * floats and ints use AVX2 when the CPU has it, which is checked once at
+ * run time, so the library needs no special build flags; everywhere else,
+ * and for longs, portable kernels with four independent accumulators run
+ * instead. A list of pvar_t is walked one element at a time and may mix
+ * the four number types.
+ *
+ * All results are doubles. Sums are accumulated in double precision in an
+ * order that depends on the kernel, so the last bits of a sum of doubles
+ * may differ between machines. A NaN anywhere in a list makes its minimum
+ * and maximum NaN, as it does its sum, whichever kernel runs.
+ */
+
+/* The smaller and larger of x and a running result, NaN once either is NaN */
+#define PLIST_MIN(x, min) ((x) < (min) || (x) != (x) ? (x) : (min))
+#define PLIST_MAX(x, max) ((x) > (max) || (x) != (x) ? (x) : (max))
+
+/**
+ * @brief The reductions for one column type. range and deviation are only
+ * called with count > 0.
+ */
+typedef struct {
+	double (*sum)(const void *values, size_t count);
+	void (*range)(const void *values, size_t count, double *out_min, double *out_max);
+	double (*deviation)(const void *values, size_t count, double mean); // Sum of squared differences from mean
+} plist_reduce_kernels_t;
+
+/**
+ * @brief Defines the portable kernels for packed values of type 'type'.
+ * Four accumulators keep four additions in flight instead of one.
+ */
+#define PLIST_REDUCE_SCALAR_KERNELS(name, type) \
+static double plist_sum_##name(const void *values, size_t count) \
+{ \
+	const type *v = values; \
+	double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0; \
+	size_t i = 0; \
+	for (; i + 4 <= count; i += 4) { \
+		s0 += (double)v[i]; \
+		s1 += (double)v[i + 1]; \
+		s2 += (double)v[i + 2]; \
+		s3 += (double)v[i + 3]; \
+	} \
+	for (; i < count; i++) { \
+		s0 += (double)v[i]; \
+	} \
+	return (s0 + s1) + (s2 + s3); \
+} \
+static void plist_range_##name(const void *values, size_t count, double *out_min, double *out_max) \
+{ \
+	const type *v = values; \
+	double min = (double)v[0], max = (double)v[0]; \
+	for (size_t i = 1; i < count; i++) { \
+		double x = (double)v[i]; \
+		min = PLIST_MIN(x, min); \
+		max = PLIST_MAX(x, max); \
+	} \
+	*out_min = min; \
+	*out_max = max; \
+} \
+static double plist_deviation_##name(const void *values, size_t count, double mean) \
+{ \
+	const type *v = values; \
+	double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0; \
+	size_t i = 0; \
+	for (; i + 4 <= count; i += 4) { \
+		double d0 = (double)v[i] - mean, d1 = (double)v[i + 1] - mean; \
+		double d2 = (double)v[i + 2] - mean, d3 = (double)v[i + 3] - mean; \
+		s0 += d0 * d0; \
+		s1 += d1 * d1; \
+		s2 += d2 * d2; \
+		s3 += d3 * d3; \
+	} \
+	for (; i < count; i++) { \
+		double d = (double)v[i] - mean; \
+		s0 += d * d; \
+	} \
+	return (s0 + s1) + (s2 + s3); \
+}
+
+PLIST_REDUCE_SCALAR_KERNELS(int, int)
+PLIST_REDUCE_SCALAR_KERNELS(long, long)
+PLIST_REDUCE_SCALAR_KERNELS(double, double)
+PLIST_REDUCE_SCALAR_KERNELS(float, float)
+
+#if defined(PLIST_REDUCE_AVX2)
+
+/* Loads four packed values as four doubles */
+#define PLIST_LOAD4_DOUBLE(p) _mm256_loadu_pd(p)
+#define PLIST_LOAD4_FLOAT(p) _mm256_cvtps_pd(_mm_loadu_ps(p))
+#define PLIST_LOAD4_INT(p) _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i *)(const void *)(p)))
+
+/**
+ * @brief Adds the four lanes of v.
+ */
+__attribute__((target("avx2")))
+static double plist_hsum_avx2(__m256d v)
+{
+	__m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+	return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+/**
+ * @brief Defines the AVX2 kernels for packed values of type 'type', eight
+ * values per iteration in two vectors of four doubles.
+ */
+#define PLIST_REDUCE_AVX2_KERNELS(name, type, load4) \
+__attribute__((target("avx2"))) \
+static double plist_sum_##name##_avx2(const void *values, size_t count) \
+{ \
+	const type *v = values; \
+	__m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(); \
+	size_t i = 0; \
+	for (; i + 8 <= count; i += 8) { \
+		s0 = _mm256_add_pd(s0, load4(v + i)); \
+		s1 = _mm256_add_pd(s1, load4(v + i + 4)); \
+	} \
+	double sum = plist_hsum_avx2(_mm256_add_pd(s0, s1)); \
+	for (; i < count; i++) { \
+		sum += (double)v[i]; \
+	} \
+	return sum; \
+} \
+__attribute__((target("avx2"))) \
+static void plist_range_##name##_avx2(const void *values, size_t count, double *out_min, double *out_max) \
+{ \
+	const type *v = values; \
+	double min = (double)v[0], max = (double)v[0]; \
+	size_t i = 0; \
+	if (count >= 4) { \
+		/* min/max_pd drop NaNs, so they are tracked apart */ \
+		__m256d lo = load4(v), hi = lo, nan = _mm256_cmp_pd(lo, lo, _CMP_UNORD_Q); \
+		for (i = 4; i + 4 <= count; i += 4) { \
+			__m256d x = load4(v + i); \
+			lo = _mm256_min_pd(lo, x); \
+			hi = _mm256_max_pd(hi, x); \
+			nan = _mm256_or_pd(nan, _mm256_cmp_pd(x, x, _CMP_UNORD_Q)); \
+		} \
+		double lanes[4]; \
+		_mm256_storeu_pd(lanes, lo); \
+		min = lanes[0]; \
+		for (size_t j = 1; j < 4; j++) { \
+			min = lanes[j] < min ? lanes[j] : min; \
+		} \
+		_mm256_storeu_pd(lanes, hi); \
+		max = lanes[0]; \
+		for (size_t j = 1; j < 4; j++) { \
+			max = lanes[j] > max ? lanes[j] : max; \
+		} \
+		if (_mm256_movemask_pd(nan) != 0) { \
+			min = max = (double)NAN; \
+		} \
+	} \
+	for (; i < count; i++) { \
+		double x = (double)v[i]; \
+		min = PLIST_MIN(x, min); \
+		max = PLIST_MAX(x, max); \
+	} \
+	*out_min = min; \
+	*out_max = max; \
+} \
+__attribute__((target("avx2"))) \
+static double plist_deviation_##name##_avx2(const void *values, size_t count, double mean) \
+{ \
+	const type *v = values; \
+	__m256d m = _mm256_set1_pd(mean); \
+	__m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd(); \
+	size_t i = 0; \
+	for (; i + 8 <= count; i += 8) { \
+		__m256d d0 = _mm256_sub_pd(load4(v + i), m); \
+		__m256d d1 = _mm256_sub_pd(load4(v + i + 4), m); \
+		s0 = _mm256_add_pd(s0, _mm256_mul_pd(d0, d0)); \
+		s1 = _mm256_add_pd(s1, _mm256_mul_pd(d1, d1)); \
+	} \
+	double sum = plist_hsum_avx2(_mm256_add_pd(s0, s1)); \
+	for (; i < count; i++) { \
+		double d = (double)v[i] - mean; \
+		sum += d * d; \
+	} \
+	return sum; \
+}
+
+PLIST_REDUCE_AVX2_KERNELS(int, int, PLIST_LOAD4_INT)
+PLIST_REDUCE_AVX2_KERNELS(double, double, PLIST_LOAD4_DOUBLE)
+PLIST_REDUCE_AVX2_KERNELS(float, float, PLIST_LOAD4_FLOAT)
+
+#endif /* PLIST_REDUCE_AVX2 */
+
+/* Kernels by column type, indexed by plist_reduce_column() */
+static plist_reduce_kernels_t plist_reduce_kernels[4] = {
+	{ plist_sum_int, plist_range_int, plist_deviation_int },
+	{ plist_sum_long, plist_range_long, plist_deviation_long },
+	{ plist_sum_double, plist_range_double, plist_deviation_double },
+	{ plist_sum_float, plist_range_float, plist_deviation_float },
+};
+static pthread_once_t plist_reduce_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Switches the kernels to the best ones the CPU supports. Run once
+ * through pthread_once().
+ */
+static void plist_reduce_init(void)
+{
+#if defined(PLIST_REDUCE_AVX2)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		plist_reduce_kernels[0] = (plist_reduce_kernels_t){ plist_sum_int_avx2, plist_range_int_avx2, plist_deviation_int_avx2 };
+		plist_reduce_kernels[2] = (plist_reduce_kernels_t){ plist_sum_double_avx2, plist_range_double_avx2, plist_deviation_double_avx2 };
+		plist_reduce_kernels[3] = (plist_reduce_kernels_t){ plist_sum_float_avx2, plist_range_float_avx2, plist_deviation_float_avx2 };
+	}
+#endif
+}
+
+/**
+ * @brief Returns the kernels for a typed list's column.
+ */
+static const plist_reduce_kernels_t *plist_reduce_column(const plist_t *list)
+{
+	pthread_once(&plist_reduce_once, plist_reduce_init);
+
+	switch (list->column) {
+		case PVAR_TYPE_INT:
+			return &plist_reduce_kernels[0];
+		case PVAR_TYPE_LONG:
+			return &plist_reduce_kernels[1];
+		case PVAR_TYPE_DOUBLE:
+			return &plist_reduce_kernels[2];
+		default:
+			return &plist_reduce_kernels[3];
+	}
+}
+
+/**
+ * @brief Reads a numeric element of a list of pvar_t as a double.
+ *
+ * @return False if the element is not an int, long, double or float.
+ */
+static bool plist_number(const pvar_t *element, double *out_value)
+{
+	switch (element->type) {
+		case PVAR_TYPE_INT:
+			*out_value = (double)element->data.i;
+			return true;
+		case PVAR_TYPE_LONG:
+			*out_value = (double)element->data.l;
+			return true;
+		case PVAR_TYPE_DOUBLE:
+			*out_value = element->data.d;
+			return true;
+		case PVAR_TYPE_FLOAT:
+			*out_value = (double)element->data.f;
+			return true;
+		default:
+			return false;
+	}
+}
+
+/**
+ * @brief Sums the list's values.
+ *
+ * @return False if the list holds a value that is not a number.
+ */
+static bool plist_reduce_sum(const plist_t *list, double *out_sum)
+{
+	if (list->column != PVAR_TYPE_NONE) {
+		*out_sum = plist_reduce_column(list)->sum(list->values, list->count);
+		return true;
+	}
+
+	double sum = 0.0;
+	for (size_t i = 0; i < list->count; i++) {
+		double x;
+		if (!plist_number(&list->elements[i], &x)) {
+			return false;
+		}
+		sum += x;
+	}
+
+	*out_sum = sum;
+	return true;
+}
+
+/**
+ * @brief Finds the smallest and largest of the values of a non-empty list.
+ *
+ * @return False if the list holds a value that is not a number.
+ */
+static bool plist_reduce_range(const plist_t *list, double *out_min, double *out_max)
+{
+	if (list->column != PVAR_TYPE_NONE) {
+		plist_reduce_column(list)->range(list->values, list->count, out_min, out_max);
+		return true;
+	}
+
+	double min = 0.0, max = 0.0;
+	for (size_t i = 0; i < list->count; i++) {
+		double x;
+		if (!plist_number(&list->elements[i], &x)) {
+			return false;
+		}
+		min = i == 0 ? x : PLIST_MIN(x, min);
+		max = i == 0 ? x : PLIST_MAX(x, max);
+	}
+
+	*out_min = min;
+	*out_max = max;
+	return true;
+}
+
+/**
+ * @brief Sums the squared differences between the values of a non-empty
+ * list and their mean. Only called after plist_reduce_sum() has succeeded,
+ * so every value is a number.
+ */
+static double plist_reduce_deviation(const plist_t *list, double mean)
+{
+	if (list->column != PVAR_TYPE_NONE) {
+		return plist_reduce_column(list)->deviation(list->values, list->count, mean);
+	}
+
+	double sum = 0.0;
+	for (size_t i = 0; i < list->count; i++) {
+		double x = 0.0;
+		plist_number(&list->elements[i], &x);
+		sum += (x - mean) * (x - mean);
+	}
+
+	return sum;
+}
+
+/**
+ * @brief Adds up the numbers in a list.
+ *
+ * The list may hold ints, longs, doubles and floats, or be a typed list of
+ * any of them; an empty list sums to 0.
+ *
+ * @param list The list.
+ * @param out_value Receives the sum.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool plist_sum(const plist_t *list, double *out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL || out_value == NULL) {
+		pvars_errno = FAILURE_PLIST_SUM_NULL_INPUT;
+		return false;
+	}
+
+	if (!plist_reduce_sum(list, out_value)) {
+		pvars_errno = FAILURE_PLIST_SUM_NOT_NUMERIC;
+		return false;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Finds the smallest number in a list.
+ *
+ * @param list A non-empty list of numbers.
+ * @param out_value Receives the smallest value, as a double, or NaN if
+ * the list holds a NaN.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool plist_min(const plist_t *list, double *out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL || out_value == NULL) {
+		pvars_errno = FAILURE_PLIST_MIN_NULL_INPUT;
+		return false;
+	}
+
+	if (list->count == 0) {
+		pvars_errno = FAILURE_PLIST_MIN_EMPTY_LIST;
+		return false;
+	}
+
+	double max;
+	if (!plist_reduce_range(list, out_value, &max)) {
+		pvars_errno = FAILURE_PLIST_MIN_NOT_NUMERIC;
+		return false;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Finds the largest number in a list.
+ *
+ * @param list A non-empty list of numbers.
+ * @param out_value Receives the largest value, as a double, or NaN if
+ * the list holds a NaN.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool plist_max(const plist_t *list, double *out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL || out_value == NULL) {
+		pvars_errno = FAILURE_PLIST_MAX_NULL_INPUT;
+		return false;
+	}
+
+	if (list->count == 0) {
+		pvars_errno = FAILURE_PLIST_MAX_EMPTY_LIST;
+		return false;
+	}
+
+	double min;
+	if (!plist_reduce_range(list, &min, out_value)) {
+		pvars_errno = FAILURE_PLIST_MAX_NOT_NUMERIC;
+		return false;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Computes the arithmetic mean of the numbers in a list.
+ *
+ * @param list A non-empty list of numbers.
+ * @param out_value Receives the mean.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool plist_mean(const plist_t *list, double *out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL || out_value == NULL) {
+		pvars_errno = FAILURE_PLIST_MEAN_NULL_INPUT;
+		return false;
+	}
+
+	if (list->count == 0) {
+		pvars_errno = FAILURE_PLIST_MEAN_EMPTY_LIST;
+		return false;
+	}
+
+	double sum;
+	if (!plist_reduce_sum(list, &sum)) {
+		pvars_errno = FAILURE_PLIST_MEAN_NOT_NUMERIC;
+		return false;
+	}
+
+	*out_value = sum / (double)list->count;
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Computes the population variance of the numbers in a list: the
+ * mean of the squared differences from their mean.
+ *
+ * The values are read twice, once for the mean and once for the
+ * differences, which stays accurate when the values are large and close
+ * together. Multiply by n / (n - 1) for the sample variance.
+ *
+ * @param list A non-empty list of numbers.
+ * @param out_value Receives the variance.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool plist_variance(const plist_t *list, double *out_value)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (list == NULL || out_value == NULL) {
+		pvars_errno = FAILURE_PLIST_VARIANCE_NULL_INPUT;
+		return false;
+	}
+
+	if (list->count == 0) {
+		pvars_errno = FAILURE_PLIST_VARIANCE_EMPTY_LIST;
+		return false;
+	}
+
+	double sum;
+	if (!plist_reduce_sum(list, &sum)) {
+		pvars_errno = FAILURE_PLIST_VARIANCE_NOT_NUMERIC;
+		return false;
+	}
+
+	double mean = sum / (double)list->count;
+	*out_value = plist_reduce_deviation(list, mean) / (double)list->count;
+
+	pvars_errno = SUCCESS;
+	return true;
+}
@@ -0,0 +1,175 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<stdatomic.h>
+#include<stdint.h>
+#include<stdlib.h>
+#include<string.h>
+
+#include"pvars.h"
+#include"perrno.h"
+#include"pmem_internal.h"
+
+static void *pmem_libc_alloc(size_t size, void *ctx)
+{
+	(void)ctx;
+	return malloc(size);
+}
+
+static void *pmem_libc_resize(void *ptr, size_t old_size, size_t new_size, void *ctx)
+{
+	(void)old_size;
+	(void)ctx;
+	return realloc(ptr, new_size);
+}
+
+static void pmem_libc_release(void *ptr, size_t size, void *ctx)
+{
+	(void)size;
+	(void)ctx;
+	free(ptr);
+}
+
+/* The C library allocator, used until pvars_set_allocator() is called */
+static const pvars_allocator_t pmem_libc = {
+	pmem_libc_alloc,
+	pmem_libc_resize,
+	pmem_libc_release,
+	NULL
+};
+
+/* Allocator picked up by containers at creation */
+static const pvars_allocator_t *_Atomic pmem_global = &pmem_libc;
+
+/**
+ * @brief Sets the allocator used by every list, dict and arena created from
+ * now on.
+ *
+ * Existing containers keep the allocator they were created with, so the
+ * allocator must stay valid until all of them are destroyed. Strings
+ * returned by the get functions are still allocated with malloc() and
+ * released by the caller with free().
+ *
+ * @param allocator The allocator, or NULL to restore the C library's.
+ */
+void pvars_set_allocator(const pvars_allocator_t *allocator)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (allocator == NULL) {
+		atomic_store(&pmem_global, &pmem_libc);
+		pvars_errno = SUCCESS;
+		return;
+	}
+
+	if (allocator->alloc == NULL || allocator->resize == NULL || allocator->release == NULL) {
+		pvars_errno = FAILURE_PVARS_SET_ALLOCATOR_MISSING_HOOK;
+		return;
+	}
+
+	atomic_store(&pmem_global, allocator);
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Returns the allocator new containers are created with.
+ *
+ * @return The process wide allocator. Never NULL.
+ */
+const pvars_allocator_t *pvars_get_allocator(void)
+{
+	pvars_errno = SUCCESS;
+	return atomic_load(&pmem_global);
+}
+
+/**
+ * @brief Returns the process wide allocator without touching pvars_errno.
+ */
+const pvars_allocator_t *pmem_default(void)
+{
+	return atomic_load(&pmem_global);
+}
+
+/**
+ * @brief Returns the C library allocator. Values handed out to the caller,
+ * such as popped strings, are allocated with it.
+ */
+const pvars_allocator_t *pmem_heap(void)
+{
+	return &pmem_libc;
+}
+
+/**
+ * @brief Allocates size bytes.
+ */
+void *pmem_malloc(const pvars_allocator_t *allocator, size_t size)
+{
+	return allocator->alloc(size, allocator->ctx);
+}
+
+/**
+ * @brief Allocates count zeroed objects of size bytes.
+ */
+void *pmem_calloc(const pvars_allocator_t *allocator, size_t count, size_t size)
+{
+	if (allocator == &pmem_libc) {
+		/* calloc() may get zeroed pages from the system for free */
+		return calloc(count, size);
+	}
+
+	if (size != 0 && count > SIZE_MAX / size) {
+		return NULL;
+	}
+
+	void *ptr = allocator->alloc(count * size, allocator->ctx);
+	if (ptr != NULL) {
+		memset(ptr, 0, count * size);
+	}
+
+	return ptr;
+}
+
+/**
+ * @brief Resizes an allocation of old_size bytes to new_size bytes.
+ */
+void *pmem_realloc(const pvars_allocator_t *allocator, void *ptr, size_t old_size, size_t new_size)
+{
+	return allocator->resize(ptr, old_size, new_size, allocator->ctx);
+}
+
+/**
+ * @brief Copies the first len bytes of str into a new NUL terminated string.
+ */
+char *pmem_strndup(const pvars_allocator_t *allocator, const char *str, size_t len)
+{
+	if (len == SIZE_MAX) {
+		return NULL;
+	}
+
+	char *copy = pmem_malloc(allocator, len + 1);
+	if (copy == NULL) {
+		return NULL;
+	}
+
+	memcpy(copy, str, len);
+	copy[len] = '\0';
+
+	return copy;
+}
+
+/**
+ * @brief strdup() through an allocator.
+ */
+char *pmem_strdup(const pvars_allocator_t *allocator, const char *str)
+{
+	return pmem_strndup(allocator, str, strlen(str));
+}
+
+/**
+ * @brief Returns size bytes at ptr to the allocator. NULL is ignored.
+ */
+void pmem_free(const pvars_allocator_t *allocator, void *ptr, size_t size)
+{
+	if (ptr != NULL) {
+		allocator->release(ptr, size, allocator->ctx);
+	}
+}
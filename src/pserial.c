@@ -0,0 +1,889 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<limits.h>
+#include<stdint.h>
+#include<string.h>
+
+#include"pvars.h"
+#include"perrno.h"
+#include"pvars_internal.h"
+#include"plist_internal.h"
+#include"pdict_internal.h"
+#include"pmem_internal.h"
+#include"pstr_internal.h"
+#include"pserial_internal.h"
+
+/*
+ * Binary encoding of values: pvars_serialize() and pvars_deserialize().
+ *
+ *   document := 'P' 'V' version value
+ *   value    := tag payload, the tag being the value's pvar_type
+ *
+ *   PVAR_TYPE_NONE    nothing
+ *   PVAR_TYPE_STRING  varint length, then the bytes (which may include NULs)
+ *   PVAR_TYPE_INT     zigzag varint
+ *   PVAR_TYPE_LONG    zigzag varint
+ *   PVAR_TYPE_DOUBLE  8 bytes, IEEE 754, little endian
+ *   PVAR_TYPE_FLOAT   4 bytes, IEEE 754, little endian
+ *   PVAR_TYPE_LIST    varint count, then count values
+ *   PVAR_TYPE_DICT    varint count, then count times: varint key length,
+ *                     key bytes, value
+ *
+ * A typed list (plist_create_typed()) is tagged PVAR_TYPE_LIST |
+ * PSERIAL_TAG_TYPED and followed by its column type, a varint count and the
+ * bare payloads without tags, so it decodes to a typed list again. Varints
+ * are LEB128: seven bits per byte, least significant first, the high bit
+ * set on every byte but the last. Zigzag maps 0, -1, 1, -2... to 0, 1, 2,
+ * 3... so small negative numbers stay short.
+ */
+
+#define PSERIAL_MIN_CAPACITY 64
+#define PSERIAL_CHUNK 256      /* Values of a typed list decoded per plist_extend_*() call */
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define PSERIAL_LITTLE_ENDIAN 1
+#endif
+
+/**
+ * @brief Makes room for extra more bytes at the end of a buffer, doubling
+ * its capacity as needed.
+ *
+ * @param buffer The buffer.
+ * @param extra Bytes needed past buffer->size.
+ * @param failure Error reported if the buffer cannot grow.
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+bool pvars_buffer_reserve(pvars_buffer_t *buffer, size_t extra, perrno_t failure)
+{
+	if (buffer->capacity - buffer->size >= extra) {
+		return true;
+	}
+
+	size_t needed = buffer->size + extra;
+	if (needed < buffer->size) {
+		pvars_errno = failure;
+		return false;
+	}
+
+	size_t new_capacity = buffer->capacity > 0 ? buffer->capacity : PSERIAL_MIN_CAPACITY;
+	while (new_capacity < needed) {
+		new_capacity = new_capacity <= SIZE_MAX / 2 ? new_capacity * 2 : needed;
+	}
+
+	unsigned char *data = buffer->data == NULL
+		? pmem_malloc(buffer->allocator, new_capacity)
+		: pmem_realloc(buffer->allocator, buffer->data, buffer->capacity, new_capacity);
+	if (data == NULL) {
+		pvars_errno = failure;
+		return false;
+	}
+
+	buffer->data = data;
+	buffer->capacity = new_capacity;
+	return true;
+}
+
+static bool pserial_reserve(pvars_buffer_t *buffer, size_t extra)
+{
+	return pvars_buffer_reserve(buffer, extra, FAILURE_PVARS_SERIALIZE_REALLOC_FAILED);
+}
+
+/* The writers below expect the caller to have reserved room for them */
+
+static void pserial_put_byte(pvars_buffer_t *buffer, unsigned char byte)
+{
+	buffer->data[buffer->size++] = byte;
+}
+
+static void pserial_put_varint(pvars_buffer_t *buffer, uint64_t value)
+{
+	unsigned char *p = buffer->data + buffer->size;
+
+	while (value >= 0x80) {
+		*p++ = (unsigned char)(value | 0x80);
+		value >>= 7;
+	}
+	*p++ = (unsigned char)value;
+
+	buffer->size = (size_t)(p - buffer->data);
+}
+
+static void pserial_put_fixed(pvars_buffer_t *buffer, uint64_t bits, size_t bytes)
+{
+	for (size_t i = 0; i < bytes; i++) {
+		buffer->data[buffer->size++] = (unsigned char)(bits >> (8 * i));
+	}
+}
+
+static uint64_t pserial_zigzag(int64_t value)
+{
+	return ((uint64_t)value << 1) ^ (0 - ((uint64_t)value >> 63));
+}
+
+static uint64_t pserial_double_bits(double value)
+{
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static uint64_t pserial_float_bits(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static bool pserial_write_value(pvars_buffer_t *buffer, const pvar_t *value);
+
+/**
+ * @brief Encodes the values of a typed list.
+ */
+static bool pserial_write_column(pvars_buffer_t *buffer, const plist_t *list)
+{
+	if (!pserial_reserve(buffer, 2 + PSERIAL_VARINT_MAX)) {
+		return false;
+	}
+	pserial_put_byte(buffer, PVAR_TYPE_LIST | PSERIAL_TAG_TYPED);
+	pserial_put_byte(buffer, (unsigned char)list->column);
+	pserial_put_varint(buffer, list->count);
+
+	switch (list->column) {
+		case PVAR_TYPE_INT:
+			for (size_t i = 0; i < list->count; i++) {
+				if (!pserial_reserve(buffer, PSERIAL_VARINT_MAX)) {
+					return false;
+				}
+				pserial_put_varint(buffer, pserial_zigzag(((const int *)list->values)[i]));
+			}
+			return true;
+		case PVAR_TYPE_LONG:
+			for (size_t i = 0; i < list->count; i++) {
+				if (!pserial_reserve(buffer, PSERIAL_VARINT_MAX)) {
+					return false;
+				}
+				pserial_put_varint(buffer, pserial_zigzag(((const long *)list->values)[i]));
+			}
+			return true;
+		default:
+			break;
+	}
+
+	/* Doubles and floats are fixed width: the packed array is the encoding on little endian hosts */
+	if (list->count > (SIZE_MAX - buffer->size) / list->width || !pserial_reserve(buffer, list->count * list->width)) {
+		pvars_errno = FAILURE_PVARS_SERIALIZE_REALLOC_FAILED;
+		return false;
+	}
+
+#if defined(PSERIAL_LITTLE_ENDIAN)
+	memcpy(buffer->data + buffer->size, list->values, list->count * list->width);
+	buffer->size += list->count * list->width;
+#else
+	for (size_t i = 0; i < list->count; i++) {
+		if (list->column == PVAR_TYPE_DOUBLE) {
+			pserial_put_fixed(buffer, pserial_double_bits(((const double *)list->values)[i]), sizeof(double));
+		} else {
+			pserial_put_fixed(buffer, pserial_float_bits(((const float *)list->values)[i]), sizeof(float));
+		}
+	}
+#endif
+
+	return true;
+}
+
+/**
+ * @brief Encodes a list and its elements.
+ */
+static bool pserial_write_list(pvars_buffer_t *buffer, const plist_t *list)
+{
+	if (list->column != PVAR_TYPE_NONE) {
+		return pserial_write_column(buffer, list);
+	}
+
+	if (!pserial_reserve(buffer, 1 + PSERIAL_VARINT_MAX)) {
+		return false;
+	}
+	pserial_put_byte(buffer, PVAR_TYPE_LIST);
+	pserial_put_varint(buffer, list->count);
+
+	for (size_t i = 0; i < list->count; i++) {
+		if (!pserial_write_value(buffer, &list->elements[i])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Encodes a dict's entries, in table order.
+ */
+static bool pserial_write_dict(pvars_buffer_t *buffer, const pdict_t *dict)
+{
+	if (!pserial_reserve(buffer, 1 + PSERIAL_VARINT_MAX)) {
+		return false;
+	}
+	pserial_put_byte(buffer, PVAR_TYPE_DICT);
+	pserial_put_varint(buffer, dict->count);
+
+	pdict_iter_t iter;
+	const char *key;
+	pvar_t *value;
+
+	pdict_iter_init(&iter, dict);
+	while (pdict_iter_next(&iter, &key, &value)) {
+		size_t len = pstr_len(key);
+
+		if (!pserial_reserve(buffer, PSERIAL_VARINT_MAX + len)) {
+			return false;
+		}
+		pserial_put_varint(buffer, len);
+		memcpy(buffer->data + buffer->size, key, len);
+		buffer->size += len;
+
+		if (!pserial_write_value(buffer, value)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Encodes one value, as stored in a list or dict.
+ *
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+static bool pserial_write_value(pvars_buffer_t *buffer, const pvar_t *value)
+{
+	switch (value->type) {
+		case PVAR_TYPE_NONE:
+			if (!pserial_reserve(buffer, 1)) {
+				return false;
+			}
+			pserial_put_byte(buffer, PVAR_TYPE_NONE);
+			return true;
+		case PVAR_TYPE_STRING:
+			{
+				size_t len = pvar_str_len(value);
+				if (!pserial_reserve(buffer, 1 + PSERIAL_VARINT_MAX + len)) {
+					return false;
+				}
+				pserial_put_byte(buffer, PVAR_TYPE_STRING);
+				pserial_put_varint(buffer, len);
+				memcpy(buffer->data + buffer->size, pvar_str(value), len);
+				buffer->size += len;
+			}
+			return true;
+		case PVAR_TYPE_INT:
+			if (!pserial_reserve(buffer, 1 + PSERIAL_VARINT_MAX)) {
+				return false;
+			}
+			pserial_put_byte(buffer, PVAR_TYPE_INT);
+			pserial_put_varint(buffer, pserial_zigzag(value->data.i));
+			return true;
+		case PVAR_TYPE_LONG:
+			if (!pserial_reserve(buffer, 1 + PSERIAL_VARINT_MAX)) {
+				return false;
+			}
+			pserial_put_byte(buffer, PVAR_TYPE_LONG);
+			pserial_put_varint(buffer, pserial_zigzag(value->data.l));
+			return true;
+		case PVAR_TYPE_DOUBLE:
+			if (!pserial_reserve(buffer, 1 + sizeof(double))) {
+				return false;
+			}
+			pserial_put_byte(buffer, PVAR_TYPE_DOUBLE);
+			pserial_put_fixed(buffer, pserial_double_bits(value->data.d), sizeof(double));
+			return true;
+		case PVAR_TYPE_FLOAT:
+			if (!pserial_reserve(buffer, 1 + sizeof(float))) {
+				return false;
+			}
+			pserial_put_byte(buffer, PVAR_TYPE_FLOAT);
+			pserial_put_fixed(buffer, pserial_float_bits(value->data.f), sizeof(float));
+			return true;
+		case PVAR_TYPE_LIST:
+			return pserial_write_list(buffer, value->data.ls);
+		case PVAR_TYPE_DICT:
+			return pserial_write_dict(buffer, value->data.dt);
+		default:
+			pvars_errno = FAILURE_PVARS_SERIALIZE_UNKNOWN_TYPE;
+			return false;
+	}
+}
+
+/**
+ * @brief Position of a decoder in its input.
+ */
+typedef struct {
+	const unsigned char *p;   // Next byte to read
+	const unsigned char *end; // One past the last byte
+	size_t depth;             // Lists and dicts entered and not yet left
+} pserial_reader_t;
+
+static size_t pserial_remaining(const pserial_reader_t *reader)
+{
+	return (size_t)(reader->end - reader->p);
+}
+
+static bool pserial_get_varint(pserial_reader_t *reader, uint64_t *out_value)
+{
+	uint64_t value = 0;
+
+	for (unsigned shift = 0; shift < 64; shift += 7) {
+		if (reader->p == reader->end) {
+			pvars_errno = FAILURE_PVARS_DESERIALIZE_TRUNCATED;
+			return false;
+		}
+
+		unsigned char byte = *reader->p++;
+		value |= (uint64_t)(byte & 0x7F) << shift;
+
+		if ((byte & 0x80) == 0) {
+			*out_value = value;
+			return true;
+		}
+	}
+
+	pvars_errno = FAILURE_PVARS_DESERIALIZE_MALFORMED;
+	return false;
+}
+
+static bool pserial_get_fixed(pserial_reader_t *reader, size_t bytes, uint64_t *out_bits)
+{
+	if (pserial_remaining(reader) < bytes) {
+		pvars_errno = FAILURE_PVARS_DESERIALIZE_TRUNCATED;
+		return false;
+	}
+
+	uint64_t bits = 0;
+	for (size_t i = 0; i < bytes; i++) {
+		bits |= (uint64_t)reader->p[i] << (8 * i);
+	}
+	reader->p += bytes;
+
+	*out_bits = bits;
+	return true;
+}
+
+/**
+ * @brief Reads a zigzag varint into a signed range.
+ */
+static bool pserial_get_signed(pserial_reader_t *reader, int64_t min, int64_t max, int64_t *out_value)
+{
+	uint64_t encoded;
+	if (!pserial_get_varint(reader, &encoded)) {
+		return false;
+	}
+
+	int64_t value = (int64_t)(encoded >> 1) ^ -(int64_t)(encoded & 1);
+	if (value < min || value > max) {
+		pvars_errno = FAILURE_PVARS_DESERIALIZE_MALFORMED;
+		return false;
+	}
+
+	*out_value = value;
+	return true;
+}
+
+/**
+ * @brief Reads a count of items that take at least min_bytes each, which
+ * must fit in the rest of the input.
+ */
+static bool pserial_get_count(pserial_reader_t *reader, size_t min_bytes, size_t *out_count)
+{
+	uint64_t count;
+	if (!pserial_get_varint(reader, &count)) {
+		return false;
+	}
+
+	if (count > pserial_remaining(reader) / min_bytes) {
+		pvars_errno = FAILURE_PVARS_DESERIALIZE_TRUNCATED;
+		return false;
+	}
+
+	*out_count = (size_t)count;
+	return true;
+}
+
+static bool pserial_read_value(pserial_reader_t *reader, const pvars_allocator_t *allocator, pvar_t *out_value);
+
+/**
+ * @brief Frees a partly decoded list or dict, keeping the error that
+ * stopped the decoder (destroying resets pvars_errno).
+ */
+static void pserial_discard(plist_t *list, pdict_t *dict)
+{
+	perrno_t failure = pvars_errno;
+
+	plist_destroy(list);
+	pdict_destroy(dict);
+
+	pvars_errno = failure;
+}
+
+/**
+ * @brief Decodes the payload of a typed list, after its tag.
+ */
+static bool pserial_read_column(pserial_reader_t *reader, plist_t **out_list)
+{
+	if (reader->p == reader->end) {
+		pvars_errno = FAILURE_PVARS_DESERIALIZE_TRUNCATED;
+		return false;
+	}
+
+	pvar_type column = (pvar_type)*reader->p++;
+	size_t width = 1;
+
+	switch (column) {
+		case PVAR_TYPE_INT:
+		case PVAR_TYPE_LONG:
+			break;
+		case PVAR_TYPE_DOUBLE:
+			width = sizeof(double);
+			break;
+		case PVAR_TYPE_FLOAT:
+			width = sizeof(float);
+			break;
+		default:
+			pvars_errno = FAILURE_PVARS_DESERIALIZE_MALFORMED;
+			return false;
+	}
+
+	size_t count;
+	if (!pserial_get_count(reader, width, &count)) {
+		return false;
+	}
+
+	plist_t *list = plist_create_typed(column, count > 0 ? (long int)count : 1);
+	if (list == NULL) {
+		pvars_errno = FAILURE_PVARS_DESERIALIZE_ALLOC_FAILED;
+		return false;
+	}
+
+	union {
+		int i[PSERIAL_CHUNK];
+		long l[PSERIAL_CHUNK];
+		double d[PSERIAL_CHUNK];
+		float f[PSERIAL_CHUNK];
+	} chunk;
+
+	for (size_t done = 0; done < count; ) {
+		size_t n = count - done < PSERIAL_CHUNK ? count - done : PSERIAL_CHUNK;
+		int64_t number;
+		uint64_t bits = 0;
+
+		for (size_t i = 0; i < n; i++) {
+			switch (column) {
+				case PVAR_TYPE_INT:
+					if (!pserial_get_signed(reader, INT_MIN, INT_MAX, &number)) {
+						pserial_discard(list, NULL);
+						return false;
+					}
+					chunk.i[i] = (int)number;
+					break;
+				case PVAR_TYPE_LONG:
+					if (!pserial_get_signed(reader, LONG_MIN, LONG_MAX, &number)) {
+						pserial_discard(list, NULL);
+						return false;
+					}
+					chunk.l[i] = (long)number;
+					break;
+				case PVAR_TYPE_DOUBLE:
+					pserial_get_fixed(reader, sizeof(double), &bits);
+					memcpy(&chunk.d[i], &bits, sizeof(double));
+					break;
+				default:
+					{
+						pserial_get_fixed(reader, sizeof(float), &bits);
+						uint32_t narrow = (uint32_t)bits;
+						memcpy(&chunk.f[i], &narrow, sizeof(float));
+					}
+					break;
+			}
+		}
+
+		switch (column) {
+			case PVAR_TYPE_INT:
+				plist_extend_ints(list, chunk.i, n);
+				break;
+			case PVAR_TYPE_LONG:
+				plist_extend_longs(list, chunk.l, n);
+				break;
+			case PVAR_TYPE_DOUBLE:
+				plist_extend_doubles(list, chunk.d, n);
+				break;
+			default:
+				plist_extend_floats(list, chunk.f, n);
+				break;
+		}
+		if (pvars_errno != SUCCESS) {
+			pvars_errno = FAILURE_PVARS_DESERIALIZE_ALLOC_FAILED;
+			pserial_discard(list, NULL);
+			return false;
+		}
+
+		done += n;
+	}
+
+	*out_list = list;
+	return true;
+}
+
+/**
+ * @brief Decodes the payload of a list, after its tag.
+ */
+static bool pserial_read_list(pserial_reader_t *reader, plist_t **out_list)
+{
+	size_t count;
+	if (!pserial_get_count(reader, 1, &count)) {
+		return false;
+	}
+
+	plist_t *list = plist_create(count > 0 ? (long int)count : 1);
+	if (list == NULL) {
+		pvars_errno = FAILURE_PVARS_DESERIALIZE_ALLOC_FAILED;
+		return false;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		pvar_t element;
+
+		if (!pserial_read_value(reader, list->allocator, &element)) {
+			pserial_discard(list, NULL);
+			return false;
+		}
+
+		if (!plist_append_take(list, &element)) {
+			pvar_destroy_in(list->allocator, &element);
+			pvars_errno = FAILURE_PVARS_DESERIALIZE_ALLOC_FAILED;
+			pserial_discard(list, NULL);
+			return false;
+		}
+	}
+
+	*out_list = list;
+	return true;
+}
+
+/**
+ * @brief Decodes the payload of a dict, after its tag.
+ */
+static bool pserial_read_dict(pserial_reader_t *reader, pdict_t **out_dict)
+{
+	size_t count;
+	/* An entry takes at least a key length and a tag */
+	if (!pserial_get_count(reader, 2, &count)) {
+		return false;
+	}
+
+	pdict_t *dict = pdict_create(count > 0 ? (long int)count : 1);
+	if (dict == NULL) {
+		pvars_errno = FAILURE_PVARS_DESERIALIZE_ALLOC_FAILED;
+		return false;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		uint64_t len;
+		if (!pserial_get_varint(reader, &len)) {
+			pserial_discard(NULL, dict);
+			return false;
+		}
+		if (len > pserial_remaining(reader)) {
+			pvars_errno = FAILURE_PVARS_DESERIALIZE_TRUNCATED;
+			pserial_discard(NULL, dict);
+			return false;
+		}
+
+		/* Keys are C strings in the dict API */
+		const char *key = (const char *)reader->p;
+		if (memchr(key, '\0', (size_t)len) != NULL) {
+			pvars_errno = FAILURE_PVARS_DESERIALIZE_MALFORMED;
+			pserial_discard(NULL, dict);
+			return false;
+		}
+		reader->p += len;
+
+		pvar_t value;
+		if (!pserial_read_value(reader, dict->allocator, &value)) {
+			pserial_discard(NULL, dict);
+			return false;
+		}
+
+		if (!pdict_insert_take(dict, key, (size_t)len, &value, FAILURE_PVARS_DESERIALIZE_MALFORMED, FAILURE_PVARS_DESERIALIZE_ALLOC_FAILED)) {
+			perrno_t failure = pvars_errno;
+			pvar_destroy_in(dict->allocator, &value);
+			pvars_errno = failure;
+			pserial_discard(NULL, dict);
+			return false;
+		}
+	}
+
+	*out_dict = dict;
+	return true;
+}
+
+/**
+ * @brief Decodes one value.
+ *
+ * @param reader The input.
+ * @param allocator Allocator of the list or dict the value goes into, or
+ * NULL for a value handed to the caller, whose string is a plain C string.
+ * @param out_value Receives the value.
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+static bool pserial_read_value(pserial_reader_t *reader, const pvars_allocator_t *allocator, pvar_t *out_value)
+{
+	if (reader->p == reader->end) {
+		pvars_errno = FAILURE_PVARS_DESERIALIZE_TRUNCATED;
+		return false;
+	}
+
+	memset(out_value, 0, sizeof(pvar_t));
+	unsigned char tag = *reader->p++;
+	int64_t number;
+	uint64_t bits;
+	bool done;
+
+	switch (tag) {
+		case PVAR_TYPE_NONE:
+			return true;
+		case PVAR_TYPE_STRING:
+			{
+				uint64_t len;
+				if (!pserial_get_varint(reader, &len)) {
+					return false;
+				}
+				if (len > pserial_remaining(reader)) {
+					pvars_errno = FAILURE_PVARS_DESERIALIZE_TRUNCATED;
+					return false;
+				}
+
+				const char *bytes = (const char *)reader->p;
+				reader->p += len;
+
+				if (allocator == NULL) {
+					out_value->data.s = pmem_strndup(pmem_heap(), bytes, (size_t)len);
+					done = out_value->data.s != NULL;
+					out_value->type = PVAR_TYPE_STRING;
+				} else {
+					done = pvar_set_strn_in(allocator, out_value, bytes, (size_t)len);
+				}
+				if (!done) {
+					out_value->type = PVAR_TYPE_NONE;
+					pvars_errno = FAILURE_PVARS_DESERIALIZE_ALLOC_FAILED;
+					return false;
+				}
+			}
+			return true;
+		case PVAR_TYPE_INT:
+			if (!pserial_get_signed(reader, INT_MIN, INT_MAX, &number)) {
+				return false;
+			}
+			out_value->data.i = (int)number;
+			out_value->type = PVAR_TYPE_INT;
+			return true;
+		case PVAR_TYPE_LONG:
+			if (!pserial_get_signed(reader, LONG_MIN, LONG_MAX, &number)) {
+				return false;
+			}
+			out_value->data.l = (long)number;
+			out_value->type = PVAR_TYPE_LONG;
+			return true;
+		case PVAR_TYPE_DOUBLE:
+			if (!pserial_get_fixed(reader, sizeof(double), &bits)) {
+				return false;
+			}
+			memcpy(&out_value->data.d, &bits, sizeof(double));
+			out_value->type = PVAR_TYPE_DOUBLE;
+			return true;
+		case PVAR_TYPE_FLOAT:
+			if (!pserial_get_fixed(reader, sizeof(float), &bits)) {
+				return false;
+			}
+			{
+				uint32_t narrow = (uint32_t)bits;
+				memcpy(&out_value->data.f, &narrow, sizeof(float));
+			}
+			out_value->type = PVAR_TYPE_FLOAT;
+			return true;
+		case PVAR_TYPE_LIST:
+		case PVAR_TYPE_LIST | PSERIAL_TAG_TYPED:
+		case PVAR_TYPE_DICT:
+			break;
+		default:
+			pvars_errno = FAILURE_PVARS_DESERIALIZE_MALFORMED;
+			return false;
+	}
+
+	if (reader->depth >= PVARS_SERIAL_MAX_DEPTH) {
+		pvars_errno = FAILURE_PVARS_DESERIALIZE_TOO_DEEP;
+		return false;
+	}
+
+	reader->depth++;
+	if (tag == PVAR_TYPE_DICT) {
+		done = pserial_read_dict(reader, &out_value->data.dt);
+	} else if (tag == PVAR_TYPE_LIST) {
+		done = pserial_read_list(reader, &out_value->data.ls);
+	} else {
+		done = pserial_read_column(reader, &out_value->data.ls);
+	}
+	reader->depth--;
+
+	if (done) {
+		out_value->type = tag == PVAR_TYPE_DICT ? PVAR_TYPE_DICT : PVAR_TYPE_LIST;
+	}
+	return done;
+}
+
+/**
+ * @brief Prepares an empty buffer that uses the process wide allocator.
+ *
+ * @param buffer The buffer to initialise.
+ */
+void pvars_buffer_init(pvars_buffer_t *buffer)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (buffer == NULL) {
+		pvars_errno = FAILURE_PVARS_BUFFER_INIT_NULL_INPUT;
+		return;
+	}
+
+	buffer->data = NULL;
+	buffer->size = 0;
+	buffer->capacity = 0;
+	buffer->allocator = pmem_default();
+
+	pvars_errno = SUCCESS;
+}
+
+/**
+ * @brief Empties a buffer but keeps its memory, so that the next documents
+ * written to it need not allocate.
+ *
+ * @param buffer The buffer to empty. NULL is ignored.
+ */
+void pvars_buffer_clear(pvars_buffer_t *buffer)
+{
+	if (buffer != NULL) {
+		buffer->size = 0;
+	}
+}
+
+/**
+ * @brief Frees the memory of a buffer and leaves it empty, ready for reuse.
+ *
+ * @param buffer The buffer to release. NULL is ignored.
+ */
+void pvars_buffer_release(pvars_buffer_t *buffer)
+{
+	if (buffer == NULL) {
+		return;
+	}
+
+	if (buffer->data != NULL) {
+		pmem_free(buffer->allocator, buffer->data, buffer->capacity);
+	}
+
+	buffer->data = NULL;
+	buffer->size = 0;
+	buffer->capacity = 0;
+}
+
+/**
+ * @brief Appends the binary encoding of a value to a buffer.
+ *
+ * Every type round-trips through pvars_deserialize(), nested lists and
+ * dicts included, as do strings with NUL bytes inside containers and typed
+ * lists (see plist_create_typed()). Numbers are stored exactly, dicts in
+ * their table order. Several documents may be written one after another
+ * into the same buffer.
+ *
+ * @param value The value to encode: a plist_t or pdict_t wrapped in a pvar_t
+ * (.type PVAR_TYPE_LIST with .data.ls, or PVAR_TYPE_DICT with .data.dt), or
+ * any other value.
+ * @param buffer An initialised buffer. Nothing is appended on failure.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pvars_serialize(const pvar_t *value, pvars_buffer_t *buffer)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (value == NULL || buffer == NULL || buffer->allocator == NULL) {
+		pvars_errno = FAILURE_PVARS_SERIALIZE_NULL_INPUT;
+		return false;
+	}
+
+	size_t start = buffer->size;
+
+	/* A caller's value keeps its string in data.s */
+	pvar_t root = *value;
+	root.str_tag = PVAR_STR_PLAIN;
+
+	if (!pserial_reserve(buffer, PSERIAL_HEADER_SIZE)) {
+		return false;
+	}
+	pserial_put_byte(buffer, PSERIAL_MAGIC_0);
+	pserial_put_byte(buffer, PSERIAL_MAGIC_1);
+	pserial_put_byte(buffer, PVARS_SERIAL_VERSION);
+
+	if (!pserial_write_value(buffer, &root)) {
+		buffer->size = start;
+		return false;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Decodes a document written by pvars_serialize().
+ *
+ * The input is fully validated: truncated or corrupt documents are
+ * reported, never read past, and nesting deeper than
+ * PVARS_SERIAL_MAX_DEPTH is refused.
+ *
+ * @param data The encoded bytes.
+ * @param size Number of bytes available, which may run past the document.
+ * @param out_value Receives the value, to be released with pvar_destroy().
+ * @param out_used If not NULL, receives the size of the document, where the
+ * next one in the input starts.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pvars_deserialize(const void *data, size_t size, pvar_t *out_value, size_t *out_used)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (data == NULL || out_value == NULL) {
+		pvars_errno = FAILURE_PVARS_DESERIALIZE_NULL_INPUT;
+		return false;
+	}
+
+	const unsigned char *bytes = data;
+	if (size < PSERIAL_HEADER_SIZE) {
+		pvars_errno = FAILURE_PVARS_DESERIALIZE_TRUNCATED;
+		return false;
+	}
+	if (bytes[0] != PSERIAL_MAGIC_0 || bytes[1] != PSERIAL_MAGIC_1 || bytes[2] == 0 || bytes[2] > PVARS_SERIAL_VERSION) {
+		pvars_errno = FAILURE_PVARS_DESERIALIZE_BAD_HEADER;
+		return false;
+	}
+
+	pserial_reader_t reader = { bytes + PSERIAL_HEADER_SIZE, bytes + size, 0 };
+	pvar_t value;
+
+	if (!pserial_read_value(&reader, NULL, &value)) {
+		return false;
+	}
+
+	*out_value = value;
+	if (out_used != NULL) {
+		*out_used = (size_t)(reader.p - bytes);
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
@@ -0,0 +1,86 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<stdatomic.h>
+
+#include"pvars.h"
+#include"pshare_internal.h"
+#include"pmem_internal.h"
+
+/*
+ * Copy-on-write support for lists and dicts.
+ *
+ * plist_copy() and pdict_copy() make a new handle that points at the same
+ * contents as the source and count the handles in a pshare_t, created the
+ * first time the contents are shared. Reads go straight to the contents.
+ * The first write through any handle copies the contents for that handle
+ * alone (nested lists and dicts are shared again, one level down) and drops
+ * its reference, so every handle behaves like an independent deep copy.
+ *
+ * Only the count is atomic: handles sharing contents may be used from
+ * different threads, but one handle is still used by one thread at a time.
+ */
+
+/**
+ * @brief Takes a reference on shared contents for a new handle, creating
+ * the count the first time the contents are shared.
+ *
+ * @param allocator Allocator of the contents, used for the count.
+ * @param share The count field of the source handle, NULL while unshared.
+ * @return The count, now including the new handle, or NULL if it could not
+ * be allocated.
+ */
+pshare_t *pshare_acquire(const pvars_allocator_t *allocator, pshare_t *_Atomic *share)
+{
+	pshare_t *current = atomic_load(share);
+
+	if (current == NULL) {
+		pshare_t *created = pmem_malloc(allocator, sizeof(pshare_t));
+		if (created == NULL) {
+			return NULL;
+		}
+		atomic_init(&created->refs, 1);
+
+		/* Two handles copied at once from different threads both try; the loser uses the winner's count */
+		if (atomic_compare_exchange_strong(share, &current, created)) {
+			current = created;
+		} else {
+			pmem_free(allocator, created, sizeof(pshare_t));
+		}
+	}
+
+	atomic_fetch_add(&current->refs, 1);
+	return current;
+}
+
+/**
+ * @brief Drops a handle's reference on shared contents.
+ *
+ * @param allocator Allocator of the contents.
+ * @param share The handle's count, or NULL if the contents were never shared.
+ * @return True if this was the last reference, so the caller now owns the
+ * contents and must free them, false if other handles still use them.
+ */
+bool pshare_release(const pvars_allocator_t *allocator, pshare_t *share)
+{
+	if (share == NULL) {
+		return true;
+	}
+
+	if (atomic_fetch_sub(&share->refs, 1) > 1) {
+		return false;
+	}
+
+	pmem_free(allocator, share, sizeof(pshare_t));
+	return true;
+}
+
+/**
+ * @brief Tells whether contents are used by more than one handle.
+ *
+ * @param share The handle's count, or NULL if the contents were never shared.
+ * @return True if the contents must be copied before they are modified.
+ */
+bool pshare_is_shared(const pshare_t *share)
+{
+	return share != NULL && atomic_load(&share->refs) > 1;
+}
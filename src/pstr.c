@@ -0,0 +1,98 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<stdatomic.h>
+#include<string.h>
+
+#include"pstr_internal.h"
+#include"pmem_internal.h"
+#include"phash_internal.h"
+
+/* Seed of pstr_hash_bytes(), drawn on first use */
+static _Atomic uint64_t pstr_seed = 0;
+
+/**
+ * @brief Hashes bytes with the process-wide string seed.
+ *
+ * All cached string hashes use this one seed, so two strings with equal
+ * bytes always have equal hashes, whichever container they live in.
+ *
+ * @param bytes The bytes to hash.
+ * @param len Number of bytes.
+ * @return The 64-bit hash.
+ */
+uint64_t pstr_hash_bytes(const void *bytes, size_t len)
+{
+	uint64_t seed = atomic_load_explicit(&pstr_seed, memory_order_relaxed);
+
+	if (seed == 0) {
+		uint64_t expected = 0;
+		uint64_t fresh = phash_random_seed() | 1;
+
+		seed = atomic_compare_exchange_strong(&pstr_seed, &expected, fresh) ? fresh : expected;
+	}
+
+	return phash_wyhash(bytes, len, seed);
+}
+
+/**
+ * @brief Allocates a header and a NUL terminated copy of len bytes.
+ *
+ * @param allocator Where the string is allocated.
+ * @param bytes The bytes to copy. They may contain NULs.
+ * @param len Number of bytes.
+ * @param hashed Whether to compute and cache the hash now.
+ * @return A pointer to the copied bytes, or NULL if the allocation failed.
+ */
+char *pstr_create(const pvars_allocator_t *allocator, const char *bytes, size_t len, bool hashed)
+{
+	if (len > SIZE_MAX - sizeof(pstr_t) - 1) {
+		return NULL;
+	}
+
+	pstr_t *str = pmem_malloc(allocator, pstr_size(len));
+	if (str == NULL) {
+		return NULL;
+	}
+
+	memcpy(str->data, bytes, len);
+	str->data[len] = '\0';
+	str->len = len;
+	str->hash = 0;
+	str->flags = 0;
+	str->refs = 0;
+
+	if (hashed) {
+		str->hash = pstr_hash_bytes(bytes, len);
+		str->flags |= PSTR_FLAG_HASHED;
+	}
+	if (memchr(bytes, '\0', len) != NULL) {
+		str->flags |= PSTR_FLAG_BINARY;
+	}
+
+	return str->data;
+}
+
+/**
+ * @brief Returns a string made by pstr_create() to its allocator. NULL is
+ * ignored.
+ *
+ * @param allocator The allocator the string came from.
+ * @param str The string to free.
+ */
+void pstr_free(const pvars_allocator_t *allocator, char *str)
+{
+	if (str == NULL) {
+		return;
+	}
+
+	pstr_t *header = (pstr_t *)(void *)(str - offsetof(pstr_t, data));
+	pmem_free(allocator, header, pstr_size(header->len));
+}
+
+/**
+ * @brief Returns the bytes allocated for a string of len bytes.
+ */
+size_t pstr_size(size_t len)
+{
+	return sizeof(pstr_t) + len + 1;
+}
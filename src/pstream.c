@@ -0,0 +1,477 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<stdint.h>
+#include<string.h>
+
+#include"pvars.h"
+#include"perrno.h"
+#include"pvars_internal.h"
+#include"plist_internal.h"
+#include"pdict_internal.h"
+#include"pmem_internal.h"
+#include"pstream_internal.h"
+
+/*
+ * Streams: pvars_stream_create(), pvars_stream_feed() and
+ * pvars_stream_finish().
+ *
+ * A stream is a push parser. Each format has a grammar (src/pstream_json.c
+ * and src/pstream_binary.c) that reads a chunk byte by byte as a state
+ * machine, keeping a token cut by the end of a chunk in the token buffer,
+ * and reports what it reads as events: begin, key, string, scalar and end.
+ * The events are passed on to the callbacks here, or, inside a list or
+ * dict claimed by select(), turned into that list or dict with the same
+ * internal helpers as pvars_parse_json() and pvars_deserialize(). Memory
+ * use is the longest token, the open frames and the subtree being built,
+ * whatever the length of the input.
+ */
+
+#define PSTREAM_MIN_CAPACITY 64
+#define PSTREAM_MAX_HINT 1024 /* Most elements reserved up front for a list or dict being built */
+
+/**
+ * @brief Makes room for n items of size bytes in an array, doubling its
+ * capacity as needed.
+ */
+static bool pstream_grow(const pvars_allocator_t *allocator, void **items, size_t *capacity, size_t n, size_t size)
+{
+	if (n <= *capacity) {
+		return true;
+	}
+
+	size_t new_capacity = *capacity > 0 ? *capacity : PSTREAM_MIN_CAPACITY;
+	while (new_capacity < n) {
+		if (new_capacity > SIZE_MAX / 2 / size) {
+			pvars_errno = FAILURE_PVARS_STREAM_ALLOC_FAILED;
+			return false;
+		}
+		new_capacity *= 2;
+	}
+
+	void *grown = *items == NULL
+		? pmem_malloc(allocator, new_capacity * size)
+		: pmem_realloc(allocator, *items, *capacity * size, new_capacity * size);
+	if (grown == NULL) {
+		pvars_errno = FAILURE_PVARS_STREAM_ALLOC_FAILED;
+		return false;
+	}
+
+	*items = grown;
+	*capacity = new_capacity;
+	return true;
+}
+
+/**
+ * @brief Appends bytes to the unfinished token, keeping room for a
+ * terminator after them.
+ *
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+bool pstream_token_append(pvars_stream_t *stream, const void *bytes, size_t len)
+{
+	if (len >= SIZE_MAX - stream->token_size) {
+		pvars_errno = FAILURE_PVARS_STREAM_ALLOC_FAILED;
+		return false;
+	}
+	if (!pstream_grow(stream->allocator, (void **)&stream->token, &stream->token_capacity, stream->token_size + len + 1, 1)) {
+		return false;
+	}
+
+	memcpy(stream->token + stream->token_size, bytes, len);
+	stream->token_size += len;
+	return true;
+}
+
+/**
+ * @brief Passes on what a callback returned, setting
+ * FAILURE_PVARS_STREAM_STOPPED if it was false.
+ */
+static bool pstream_check(bool proceed)
+{
+	if (!proceed) {
+		pvars_errno = FAILURE_PVARS_STREAM_STOPPED;
+	}
+	return proceed;
+}
+
+/**
+ * @brief Adds a value to the innermost list or dict being built, taking
+ * ownership of it: it is destroyed if it cannot be added.
+ */
+static bool pstream_build_add(pvars_stream_t *stream, pvar_t *value)
+{
+	pstream_build_t *parent = &stream->builds[stream->building - 1];
+	perrno_t failure;
+
+	if (parent->value.type == PVAR_TYPE_DICT) {
+		pdict_t *dict = parent->value.data.dt;
+		if (pdict_insert_take(dict, parent->key, parent->key_len, value, stream->duplicate_failure, FAILURE_PVARS_STREAM_ALLOC_FAILED)) {
+			return true;
+		}
+		failure = pvars_errno;
+		pvar_destroy_in(dict->allocator, value);
+		pvars_errno = failure;
+		return false;
+	}
+
+	plist_t *list = parent->value.data.ls;
+	if (list->column == PVAR_TYPE_NONE) {
+		if (plist_append_take(list, value)) {
+			return true;
+		}
+		pvar_destroy_in(list->allocator, value);
+		pvars_errno = FAILURE_PVARS_STREAM_ALLOC_FAILED;
+		return false;
+	}
+
+	/* The binary grammar only gives a typed list values of its column type */
+	switch (list->column) {
+		case PVAR_TYPE_INT:
+			plist_extend_ints(list, &value->data.i, 1);
+			break;
+		case PVAR_TYPE_LONG:
+			plist_extend_longs(list, &value->data.l, 1);
+			break;
+		case PVAR_TYPE_DOUBLE:
+			plist_extend_doubles(list, &value->data.d, 1);
+			break;
+		default:
+			plist_extend_floats(list, &value->data.f, 1);
+			break;
+	}
+	if (pvars_errno != SUCCESS) {
+		pvars_errno = FAILURE_PVARS_STREAM_ALLOC_FAILED;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Reports the start of a list or dict, or starts building it.
+ *
+ * @param stream The stream.
+ * @param type PVAR_TYPE_LIST or PVAR_TYPE_DICT.
+ * @param column Column type of a typed list, PVAR_TYPE_NONE otherwise.
+ * @param count Elements or entries, if the format says, or 0.
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+bool pstream_begin(pvars_stream_t *stream, pvar_type type, pvar_type column, uint64_t count)
+{
+	size_t depth = stream->depth++;
+
+	if (stream->building == 0) {
+		if (stream->callbacks.select == NULL || !stream->callbacks.select(stream->context, type, depth)) {
+			bool (*start)(void *) = type == PVAR_TYPE_DICT ? stream->callbacks.start_dict : stream->callbacks.start_list;
+			return start == NULL || pstream_check(start(stream->context));
+		}
+	}
+
+	size_t old_capacity = stream->build_capacity;
+	if (!pstream_grow(stream->allocator, (void **)&stream->builds, &stream->build_capacity, stream->building + 1, sizeof(pstream_build_t))) {
+		return false;
+	}
+	/* New frames have no key buffer yet */
+	memset(stream->builds + old_capacity, 0, (stream->build_capacity - old_capacity) * sizeof(pstream_build_t));
+
+	/* Counts read from the input are only a hint: it may end before them */
+	long int hint = count < PSTREAM_MAX_HINT ? (long int)count : PSTREAM_MAX_HINT;
+	pstream_build_t *build = &stream->builds[stream->building];
+	memset(&build->value, 0, sizeof(pvar_t));
+
+	if (type == PVAR_TYPE_DICT) {
+		build->value.data.dt = pdict_create_sized(NULL, (size_t)hint);
+	} else if (column != PVAR_TYPE_NONE) {
+		build->value.data.ls = plist_create_typed(column, hint > 0 ? hint : 1);
+	} else {
+		build->value.data.ls = plist_create(hint > 0 ? hint : 1);
+	}
+	if (build->value.data.ls == NULL) {
+		pvars_errno = FAILURE_PVARS_STREAM_ALLOC_FAILED;
+		return false;
+	}
+
+	build->value.type = (uint8_t)type;
+	build->key_len = 0;
+	stream->building++;
+	return true;
+}
+
+/**
+ * @brief Reports the key of the next member of a dict, or keeps it for
+ * the dict being built.
+ */
+bool pstream_key(pvars_stream_t *stream, const char *key, size_t len)
+{
+	if (stream->building == 0) {
+		return stream->callbacks.key == NULL || pstream_check(stream->callbacks.key(stream->context, key, len));
+	}
+
+	pstream_build_t *build = &stream->builds[stream->building - 1];
+	if (!pstream_grow(stream->allocator, (void **)&build->key, &build->key_capacity, len + 1, 1)) {
+		return false;
+	}
+
+	memcpy(build->key, key, len);
+	build->key[len] = '\0';
+	build->key_len = len;
+	return true;
+}
+
+/**
+ * @brief Reports a string, or adds it to the list or dict being built.
+ */
+bool pstream_string(pvars_stream_t *stream, const char *bytes, size_t len)
+{
+	if (stream->building == 0) {
+		return stream->callbacks.string == NULL || pstream_check(stream->callbacks.string(stream->context, bytes, len));
+	}
+
+	const pstream_build_t *parent = &stream->builds[stream->building - 1];
+	const pvars_allocator_t *allocator = parent->value.type == PVAR_TYPE_DICT
+		? parent->value.data.dt->allocator
+		: parent->value.data.ls->allocator;
+
+	pvar_t value;
+	memset(&value, 0, sizeof(pvar_t));
+	if (!pvar_set_strn_in(allocator, &value, bytes, len)) {
+		pvars_errno = FAILURE_PVARS_STREAM_ALLOC_FAILED;
+		return false;
+	}
+
+	return pstream_build_add(stream, &value);
+}
+
+/**
+ * @brief Reports a number or empty value, or adds it to the list or dict
+ * being built.
+ */
+bool pstream_scalar(pvars_stream_t *stream, const pvar_t *value)
+{
+	if (stream->building == 0) {
+		return stream->callbacks.value == NULL || pstream_check(stream->callbacks.value(stream->context, value));
+	}
+
+	pvar_t copy = *value;
+	return pstream_build_add(stream, &copy);
+}
+
+/**
+ * @brief Reports the end of a list or dict, or finishes building it and
+ * adds it to its parent or hands it to subtree().
+ */
+bool pstream_end(pvars_stream_t *stream)
+{
+	stream->depth--;
+
+	if (stream->building == 0) {
+		return stream->callbacks.end == NULL || pstream_check(stream->callbacks.end(stream->context));
+	}
+
+	pvar_t value = stream->builds[--stream->building].value;
+	if (stream->building > 0) {
+		return pstream_build_add(stream, &value);
+	}
+
+	if (stream->callbacks.subtree == NULL) {
+		pvar_destroy(&value);
+		return true;
+	}
+	return pstream_check(stream->callbacks.subtree(stream->context, &value));
+}
+
+/**
+ * @brief Drops what is half read, leaving the stream as created, without
+ * touching pvars_errno.
+ */
+static void pstream_reset(pvars_stream_t *stream)
+{
+	perrno_t failure = pvars_errno;
+
+	/* Lists and dicts being built are not yet linked to their parents */
+	while (stream->building > 0) {
+		pvar_destroy(&stream->builds[--stream->building].value);
+	}
+
+	stream->failure = SUCCESS;
+	stream->offset = 0;
+	stream->depth = 0;
+	stream->token_size = 0;
+	memset(&stream->grammar, 0, sizeof(stream->grammar));
+
+	pvars_errno = failure;
+}
+
+/**
+ * @brief Creates a stream that reads documents in the given format.
+ *
+ * @param format Encoding of the input.
+ * @param callbacks What to call as the input is read. It is copied.
+ * @param context Passed to every callback.
+ * @return The stream, to be destroyed with pvars_stream_destroy(), or NULL
+ * on failure (with pvars_errno set).
+ */
+pvars_stream_t *pvars_stream_create(pvars_stream_format format, const pvars_stream_callbacks_t *callbacks, void *context)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (callbacks == NULL) {
+		pvars_errno = FAILURE_PVARS_STREAM_CREATE_NULL_INPUT;
+		return NULL;
+	}
+
+	if (format != PVARS_STREAM_JSON && format != PVARS_STREAM_BINARY) {
+		pvars_errno = FAILURE_PVARS_STREAM_CREATE_UNKNOWN_FORMAT;
+		return NULL;
+	}
+
+	const pvars_allocator_t *allocator = pmem_default();
+	pvars_stream_t *stream = pmem_calloc(allocator, 1, sizeof(pvars_stream_t));
+	if (stream == NULL) {
+		pvars_errno = FAILURE_PVARS_STREAM_CREATE_MALLOC_FAILED;
+		return NULL;
+	}
+
+	stream->allocator = allocator;
+	stream->scratch.allocator = allocator;
+
+	stream->format = format;
+	stream->callbacks = *callbacks;
+	stream->context = context;
+	stream->failure = SUCCESS;
+	stream->duplicate_failure = format == PVARS_STREAM_JSON ? FAILURE_PVARS_PARSE_JSON_DUPLICATE_KEY : FAILURE_PVARS_DESERIALIZE_MALFORMED;
+
+	pvars_errno = SUCCESS;
+	return stream;
+}
+
+/**
+ * @brief Destroys a stream, and any list or dict it was building.
+ *
+ * @param stream The stream to destroy. NULL is ignored.
+ */
+void pvars_stream_destroy(pvars_stream_t *stream)
+{
+	if (stream == NULL) {
+		return;
+	}
+
+	pstream_reset(stream);
+
+	for (size_t i = 0; i < stream->build_capacity; i++) {
+		if (stream->builds[i].key != NULL) {
+			pmem_free(stream->allocator, stream->builds[i].key, stream->builds[i].key_capacity);
+		}
+	}
+	if (stream->builds != NULL) {
+		pmem_free(stream->allocator, stream->builds, stream->build_capacity * sizeof(pstream_build_t));
+	}
+	if (stream->token != NULL) {
+		pmem_free(stream->allocator, stream->token, stream->token_capacity);
+	}
+	pjson_scratch_release(&stream->scratch);
+
+	pmem_free(stream->allocator, stream, sizeof(pvars_stream_t));
+}
+
+/**
+ * @brief Reads the next chunk of input, calling the callbacks for
+ * everything it completes.
+ *
+ * Chunks may be cut anywhere, inside a token or a multi-byte character
+ * alike. Input that pvars_parse_json() or pvars_deserialize() would
+ * refuse fails with the same error, except that a duplicate key is only
+ * noticed in a list or dict claimed by select(). Once the stream has
+ * failed or been stopped, it fails again with the same error until
+ * pvars_stream_finish().
+ *
+ * @param stream The stream.
+ * @param data The bytes. They need not stay valid after the call.
+ * @param size Their number.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pvars_stream_feed(pvars_stream_t *stream, const void *data, size_t size)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (stream == NULL || (data == NULL && size > 0)) {
+		pvars_errno = FAILURE_PVARS_STREAM_FEED_NULL_INPUT;
+		return false;
+	}
+
+	if (stream->failure != SUCCESS) {
+		pvars_errno = stream->failure;
+		return false;
+	}
+
+	size_t used = 0;
+	bool done = size == 0 || (stream->format == PVARS_STREAM_JSON
+		? pstream_json_feed(stream, data, size, &used)
+		: pstream_binary_feed(stream, data, size, &used));
+
+	stream->offset += used;
+	if (!done) {
+		stream->failure = pvars_errno;
+		return false;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Ends the input, which must stop between two documents, and
+ * leaves the stream ready for new input, as if just created.
+ *
+ * A number at the very end of JSON input is only complete here. No
+ * document at all is fine.
+ *
+ * @param stream The stream.
+ * @return True on success, False on failure (with pvars_errno set).
+ */
+bool pvars_stream_finish(pvars_stream_t *stream)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (stream == NULL) {
+		pvars_errno = FAILURE_PVARS_STREAM_FINISH_NULL_INPUT;
+		return false;
+	}
+
+	bool done = stream->failure == SUCCESS;
+	if (!done) {
+		pvars_errno = stream->failure;
+	} else if (stream->format == PVARS_STREAM_JSON) {
+		done = pstream_json_finish(stream);
+	} else {
+		done = pstream_binary_finish(stream);
+	}
+
+	pstream_reset(stream);
+	if (!done) {
+		return false;
+	}
+
+	pvars_errno = SUCCESS;
+	return true;
+}
+
+/**
+ * @brief Returns the number of bytes the stream has read since it was
+ * created or last finished. After a failure, it is at or just past the
+ * byte or token that failed.
+ *
+ * @param stream The stream to query.
+ * @return The offset, or 0 if the stream is NULL.
+ */
+uint64_t pvars_stream_get_offset(const pvars_stream_t *stream)
+{
+	pvars_errno = PERRNO_CLEAR;
+
+	if (stream == NULL) {
+		pvars_errno = FAILURE_PVARS_STREAM_GET_OFFSET_NULL_INPUT;
+		return 0;
+	}
+
+	pvars_errno = SUCCESS;
+	return stream->offset;
+}
@@ -0,0 +1,383 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<limits.h>
+#include<stdint.h>
+#include<string.h>
+
+#include"pvars.h"
+#include"perrno.h"
+#include"pserial_internal.h"
+#include"pstream_internal.h"
+
+/*
+ * Binary grammar of streams (see src/pstream.c), for the encoding of
+ * src/pserial.c.
+ *
+ * The decoder waits for one field at a time: a header, a tag, a column
+ * type, a varint, the fixed bytes of a double or float, or the bytes of a
+ * string or key, any of which may be cut by the end of a chunk. Each open
+ * list or dict keeps a frame counting the elements still to come, which
+ * decides the field after a value: the next key, element or tag, or the
+ * end of the list or dict. Values and errors match pvars_deserialize().
+ */
+
+/**
+ * @brief Waits for a varint standing for field.
+ */
+static void pstream_binary_expect_varint(pstream_binary_t *binary, pstream_field field)
+{
+	binary->state = PSTREAM_BINARY_VARINT;
+	binary->field = (uint8_t)field;
+	binary->varint = 0;
+	binary->shift = 0;
+}
+
+/**
+ * @brief Waits for the bytes of a double or float.
+ */
+static void pstream_binary_expect_fixed(pstream_binary_t *binary, pstream_field field)
+{
+	binary->state = PSTREAM_BINARY_FIXED;
+	binary->field = (uint8_t)field;
+	binary->need = field == PSTREAM_FIELD_DOUBLE ? sizeof(double) : sizeof(float);
+	binary->have = 0;
+}
+
+/**
+ * @brief Chooses the field after a complete value, ending every list and
+ * dict that has no element left.
+ *
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+static bool pstream_binary_next(pvars_stream_t *stream)
+{
+	pstream_binary_t *binary = &stream->grammar.binary;
+
+	for (;;) {
+		if (stream->depth == 0) {
+			/* The document is complete */
+			binary->state = PSTREAM_BINARY_HEADER;
+			binary->have = 0;
+			return true;
+		}
+
+		pstream_frame_t *frame = &binary->frames[stream->depth - 1];
+		if (frame->remaining == 0) {
+			if (!pstream_end(stream)) {
+				return false;
+			}
+			continue;
+		}
+		frame->remaining--;
+
+		if (frame->type == PVAR_TYPE_DICT) {
+			pstream_binary_expect_varint(binary, PSTREAM_FIELD_KEY_LEN);
+			return true;
+		}
+
+		switch (frame->column) {
+			case PVAR_TYPE_INT:
+				pstream_binary_expect_varint(binary, PSTREAM_FIELD_INT);
+				break;
+			case PVAR_TYPE_LONG:
+				pstream_binary_expect_varint(binary, PSTREAM_FIELD_LONG);
+				break;
+			case PVAR_TYPE_DOUBLE:
+				pstream_binary_expect_fixed(binary, PSTREAM_FIELD_DOUBLE);
+				break;
+			case PVAR_TYPE_FLOAT:
+				pstream_binary_expect_fixed(binary, PSTREAM_FIELD_FLOAT);
+				break;
+			default:
+				binary->state = PSTREAM_BINARY_TAG;
+				break;
+		}
+		return true;
+	}
+}
+
+/**
+ * @brief Reports a number or empty value and moves past it.
+ */
+static bool pstream_binary_scalar(pvars_stream_t *stream, const pvar_t *value)
+{
+	return pstream_scalar(stream, value) && pstream_binary_next(stream);
+}
+
+/**
+ * @brief Acts on a complete string or key, held in the token buffer.
+ */
+static bool pstream_binary_bytes_done(pvars_stream_t *stream)
+{
+	pstream_binary_t *binary = &stream->grammar.binary;
+	const char *bytes = "";
+	size_t len = stream->token_size;
+
+	/* The token buffer always has room for a terminator, once it exists */
+	if (stream->token != NULL) {
+		stream->token[len] = '\0';
+		bytes = stream->token;
+	}
+
+	if (binary->field == PSTREAM_FIELD_STRING) {
+		return pstream_string(stream, bytes, len) && pstream_binary_next(stream);
+	}
+
+	/* Keys are C strings in the dict API */
+	if (memchr(bytes, '\0', len) != NULL) {
+		pvars_errno = FAILURE_PVARS_DESERIALIZE_MALFORMED;
+		return false;
+	}
+	if (!pstream_key(stream, bytes, len)) {
+		return false;
+	}
+	binary->state = PSTREAM_BINARY_TAG;
+	return true;
+}
+
+/**
+ * @brief Opens a list or dict whose count has been read.
+ */
+static bool pstream_binary_begin(pvars_stream_t *stream, pvar_type type, pvar_type column, uint64_t count)
+{
+	pstream_frame_t *frame = &stream->grammar.binary.frames[stream->depth];
+	frame->remaining = count;
+	frame->type = (uint8_t)type;
+	frame->column = (uint8_t)column;
+
+	return pstream_begin(stream, type, column, count) && pstream_binary_next(stream);
+}
+
+/**
+ * @brief Acts on a complete varint.
+ */
+static bool pstream_binary_varint_done(pvars_stream_t *stream, uint64_t varint)
+{
+	pstream_binary_t *binary = &stream->grammar.binary;
+	int64_t number = (int64_t)(varint >> 1) ^ -(int64_t)(varint & 1);
+	pvar_t value;
+
+	memset(&value, 0, sizeof(pvar_t));
+
+	switch (binary->field) {
+		case PSTREAM_FIELD_INT:
+			if (number < INT_MIN || number > INT_MAX) {
+				break;
+			}
+			value.data.i = (int)number;
+			value.type = PVAR_TYPE_INT;
+			return pstream_binary_scalar(stream, &value);
+		case PSTREAM_FIELD_LONG:
+			if (number < LONG_MIN || number > LONG_MAX) {
+				break;
+			}
+			value.data.l = (long)number;
+			value.type = PVAR_TYPE_LONG;
+			return pstream_binary_scalar(stream, &value);
+		case PSTREAM_FIELD_STRING_LEN:
+		case PSTREAM_FIELD_KEY_LEN:
+			if (varint >= SIZE_MAX) {
+				pvars_errno = FAILURE_PVARS_STREAM_ALLOC_FAILED;
+				return false;
+			}
+			binary->state = PSTREAM_BINARY_BYTES;
+			binary->field = binary->field == PSTREAM_FIELD_STRING_LEN ? PSTREAM_FIELD_STRING : PSTREAM_FIELD_KEY;
+			binary->need = varint;
+			binary->have = 0;
+			stream->token_size = 0;
+			return varint > 0 || pstream_binary_bytes_done(stream);
+		case PSTREAM_FIELD_LIST_COUNT:
+			return pstream_binary_begin(stream, PVAR_TYPE_LIST, PVAR_TYPE_NONE, varint);
+		case PSTREAM_FIELD_DICT_COUNT:
+			return pstream_binary_begin(stream, PVAR_TYPE_DICT, PVAR_TYPE_NONE, varint);
+		default:
+			return pstream_binary_begin(stream, PVAR_TYPE_LIST, binary->column, varint);
+	}
+
+	pvars_errno = FAILURE_PVARS_DESERIALIZE_MALFORMED;
+	return false;
+}
+
+/**
+ * @brief Acts on the complete bytes of a double or float.
+ */
+static bool pstream_binary_fixed_done(pvars_stream_t *stream)
+{
+	pstream_binary_t *binary = &stream->grammar.binary;
+	uint64_t bits = 0;
+	pvar_t value;
+
+	for (size_t i = 0; i < binary->need; i++) {
+		bits |= (uint64_t)binary->fixed[i] << (8 * i);
+	}
+
+	memset(&value, 0, sizeof(pvar_t));
+	if (binary->field == PSTREAM_FIELD_DOUBLE) {
+		memcpy(&value.data.d, &bits, sizeof(double));
+		value.type = PVAR_TYPE_DOUBLE;
+	} else {
+		uint32_t narrow = (uint32_t)bits;
+		memcpy(&value.data.f, &narrow, sizeof(float));
+		value.type = PVAR_TYPE_FLOAT;
+	}
+
+	return pstream_binary_scalar(stream, &value);
+}
+
+/**
+ * @brief Acts on the tag of a value.
+ */
+static bool pstream_binary_tag(pvars_stream_t *stream, unsigned char tag)
+{
+	pstream_binary_t *binary = &stream->grammar.binary;
+	pvar_t value;
+
+	switch (tag) {
+		case PVAR_TYPE_NONE:
+			memset(&value, 0, sizeof(pvar_t));
+			return pstream_binary_scalar(stream, &value);
+		case PVAR_TYPE_STRING:
+			pstream_binary_expect_varint(binary, PSTREAM_FIELD_STRING_LEN);
+			return true;
+		case PVAR_TYPE_INT:
+			pstream_binary_expect_varint(binary, PSTREAM_FIELD_INT);
+			return true;
+		case PVAR_TYPE_LONG:
+			pstream_binary_expect_varint(binary, PSTREAM_FIELD_LONG);
+			return true;
+		case PVAR_TYPE_DOUBLE:
+			pstream_binary_expect_fixed(binary, PSTREAM_FIELD_DOUBLE);
+			return true;
+		case PVAR_TYPE_FLOAT:
+			pstream_binary_expect_fixed(binary, PSTREAM_FIELD_FLOAT);
+			return true;
+		case PVAR_TYPE_LIST:
+		case PVAR_TYPE_LIST | PSERIAL_TAG_TYPED:
+		case PVAR_TYPE_DICT:
+			break;
+		default:
+			pvars_errno = FAILURE_PVARS_DESERIALIZE_MALFORMED;
+			return false;
+	}
+
+	if (stream->depth >= PVARS_SERIAL_MAX_DEPTH) {
+		pvars_errno = FAILURE_PVARS_DESERIALIZE_TOO_DEEP;
+		return false;
+	}
+
+	if (tag == PVAR_TYPE_DICT) {
+		pstream_binary_expect_varint(binary, PSTREAM_FIELD_DICT_COUNT);
+	} else if (tag == PVAR_TYPE_LIST) {
+		pstream_binary_expect_varint(binary, PSTREAM_FIELD_LIST_COUNT);
+	} else {
+		binary->state = PSTREAM_BINARY_COLUMN;
+	}
+	return true;
+}
+
+/**
+ * @brief Reads a chunk of binary input.
+ *
+ * @param stream The stream.
+ * @param data The chunk.
+ * @param size Its length, above 0.
+ * @param out_used Receives the bytes read before the one that failed, or
+ * size.
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+bool pstream_binary_feed(pvars_stream_t *stream, const unsigned char *data, size_t size, size_t *out_used)
+{
+	pstream_binary_t *binary = &stream->grammar.binary;
+	const unsigned char *end = data + size;
+	const unsigned char *p = data;
+	bool done = true;
+
+	while (p < end && done) {
+		const unsigned char *start = p;
+		size_t n;
+
+		switch (binary->state) {
+			case PSTREAM_BINARY_HEADER:
+				{
+					unsigned char byte = *p++;
+					bool valid = binary->have == 0 ? byte == PSERIAL_MAGIC_0
+						: binary->have == 1 ? byte == PSERIAL_MAGIC_1
+						: byte != 0 && byte <= PVARS_SERIAL_VERSION;
+					if (!valid) {
+						pvars_errno = FAILURE_PVARS_DESERIALIZE_BAD_HEADER;
+						done = false;
+					} else if (++binary->have == PSERIAL_HEADER_SIZE) {
+						binary->state = PSTREAM_BINARY_TAG;
+					}
+				}
+				break;
+			case PSTREAM_BINARY_TAG:
+				done = pstream_binary_tag(stream, *p++);
+				break;
+			case PSTREAM_BINARY_COLUMN:
+				binary->column = *p++;
+				if (binary->column != PVAR_TYPE_INT && binary->column != PVAR_TYPE_LONG
+					&& binary->column != PVAR_TYPE_DOUBLE && binary->column != PVAR_TYPE_FLOAT) {
+					pvars_errno = FAILURE_PVARS_DESERIALIZE_MALFORMED;
+					done = false;
+				} else {
+					pstream_binary_expect_varint(binary, PSTREAM_FIELD_COLUMN_COUNT);
+				}
+				break;
+			case PSTREAM_BINARY_VARINT:
+				{
+					unsigned char byte = *p++;
+					binary->varint |= (uint64_t)(byte & 0x7F) << binary->shift;
+					if ((byte & 0x80) == 0) {
+						done = pstream_binary_varint_done(stream, binary->varint);
+					} else if ((binary->shift += 7) >= 64) {
+						pvars_errno = FAILURE_PVARS_DESERIALIZE_MALFORMED;
+						done = false;
+					}
+				}
+				break;
+			case PSTREAM_BINARY_FIXED:
+				n = (size_t)(binary->need - binary->have) < (size_t)(end - p) ? (size_t)(binary->need - binary->have) : (size_t)(end - p);
+				memcpy(binary->fixed + binary->have, p, n);
+				binary->have += n;
+				p += n;
+				if (binary->have == binary->need) {
+					done = pstream_binary_fixed_done(stream);
+				}
+				break;
+			default:
+				/* A string or key may be far longer than a chunk */
+				n = binary->need - binary->have < (uint64_t)(end - p) ? (size_t)(binary->need - binary->have) : (size_t)(end - p);
+				done = pstream_token_append(stream, p, n);
+				binary->have += n;
+				p += n;
+				if (done && binary->have == binary->need) {
+					done = pstream_binary_bytes_done(stream);
+				}
+				break;
+		}
+
+		if (!done) {
+			p = start;
+		}
+	}
+
+	*out_used = (size_t)(p - data);
+	return done;
+}
+
+/**
+ * @brief Checks that the binary input ended between two documents.
+ *
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+bool pstream_binary_finish(pvars_stream_t *stream)
+{
+	const pstream_binary_t *binary = &stream->grammar.binary;
+
+	if (binary->state != PSTREAM_BINARY_HEADER || binary->have != 0) {
+		pvars_errno = FAILURE_PVARS_DESERIALIZE_TRUNCATED;
+		return false;
+	}
+	return true;
+}
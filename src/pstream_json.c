@@ -0,0 +1,371 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<stdint.h>
+#include<string.h>
+
+#include"pvars.h"
+#include"perrno.h"
+#include"pjson_internal.h"
+#include"pstream_internal.h"
+
+/*
+ * JSON grammar of streams (see src/pstream.c).
+ *
+ * Between tokens every byte is an operator, whitespace or the first byte
+ * of a token, checked against what the grammar expects next. Strings are
+ * copied into the token buffer a run at a time, found by the same
+ * eight-byte scan as pvars_parse_json(); numbers and literals run until
+ * the next operator or whitespace. A complete token is converted by the
+ * helpers of src/pjson.c, so values and errors match pvars_parse_json().
+ */
+
+/* Bytes that end a number or literal: operators and whitespace */
+static const bool pstream_json_delimiter[256] = {
+	['{'] = true, ['}'] = true, ['['] = true, [']'] = true, [':'] = true, [','] = true,
+	[' '] = true, ['\t'] = true, ['\n'] = true, ['\r'] = true,
+};
+
+/**
+ * @brief Tells whether a value may start here, and a key if key is set.
+ */
+static bool pstream_json_accepts(const pstream_json_t *json, bool key)
+{
+	switch (json->expect) {
+		case PSTREAM_JSON_VALUE:
+		case PSTREAM_JSON_VALUE_OR_CLOSE:
+			return !key;
+		case PSTREAM_JSON_KEY_OR_CLOSE:
+		case PSTREAM_JSON_KEY:
+			return key;
+		default:
+			return false;
+	}
+}
+
+/**
+ * @brief Moves past a complete value: to the next document at depth 0, to
+ * a comma or closing bracket inside an array or object.
+ */
+static void pstream_json_after_value(pvars_stream_t *stream)
+{
+	stream->grammar.json.expect = stream->depth == 0 ? PSTREAM_JSON_VALUE : PSTREAM_JSON_COMMA_OR_CLOSE;
+}
+
+/**
+ * @brief Helpers of src/pjson.c report allocation failures as theirs.
+ */
+static bool pstream_json_alloc_failure(void)
+{
+	if (pvars_errno == FAILURE_PVARS_PARSE_JSON_ALLOC_FAILED) {
+		pvars_errno = FAILURE_PVARS_STREAM_ALLOC_FAILED;
+	}
+	return false;
+}
+
+/**
+ * @brief Unescapes the string in the token buffer, which ends with its
+ * closing quote, and reports it as a key or a value.
+ */
+static bool pstream_json_string_done(pvars_stream_t *stream)
+{
+	pstream_json_t *json = &stream->grammar.json;
+	const unsigned char *start = (const unsigned char *)stream->token;
+	const unsigned char *end = start + stream->token_size;
+	char *bytes = stream->token;
+	size_t len = stream->token_size - 1;
+
+	if (json->escapes) {
+		const char *unescaped;
+		if (!pjson_unescape(&stream->scratch, start, pjson_scan_string(start, end), end, &unescaped, &len)) {
+			return pstream_json_alloc_failure();
+		}
+		bytes = stream->scratch.bytes;
+	}
+	/* Over the closing quote, or within the scratch buffer */
+	bytes[len] = '\0';
+
+	if (json->expect == PSTREAM_JSON_VALUE || json->expect == PSTREAM_JSON_VALUE_OR_CLOSE) {
+		if (!pstream_string(stream, bytes, len)) {
+			return false;
+		}
+		pstream_json_after_value(stream);
+		return true;
+	}
+
+	/* Keys are C strings in the dict API */
+	if (memchr(bytes, '\0', len) != NULL) {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_BAD_STRING;
+		return false;
+	}
+	json->expect = PSTREAM_JSON_COLON;
+	return pstream_key(stream, bytes, len);
+}
+
+/**
+ * @brief Converts the number or literal in the token buffer and reports it.
+ */
+static bool pstream_json_scalar_done(pvars_stream_t *stream)
+{
+	const unsigned char *start = (const unsigned char *)stream->token;
+	const unsigned char *end = start + stream->token_size;
+	size_t len = stream->token_size;
+
+	pvar_t value;
+	memset(&value, 0, sizeof(pvar_t));
+
+	if (*start == '-' || (*start >= '0' && *start <= '9')) {
+		const unsigned char *p = pjson_read_number(&stream->scratch, start, end, &value);
+		if (p == NULL) {
+			return pstream_json_alloc_failure();
+		}
+		if (p != end) {
+			pvars_errno = FAILURE_PVARS_PARSE_JSON_BAD_NUMBER;
+			return false;
+		}
+	} else if (len == 4 && memcmp(start, "true", 4) == 0) {
+		value.data.i = 1;
+		value.type = PVAR_TYPE_INT;
+	} else if (len == 5 && memcmp(start, "false", 5) == 0) {
+		value.data.i = 0;
+		value.type = PVAR_TYPE_INT;
+	} else if (len != 4 || memcmp(start, "null", 4) != 0) {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_SYNTAX;
+		return false;
+	}
+
+	if (!pstream_scalar(stream, &value)) {
+		return false;
+	}
+	pstream_json_after_value(stream);
+	return true;
+}
+
+/**
+ * @brief Reads on in a string, up to its closing quote or the end of the
+ * chunk.
+ *
+ * @return Where reading stopped, or NULL on failure (with pvars_errno set).
+ */
+static const unsigned char *pstream_json_string(pvars_stream_t *stream, const unsigned char *p, const unsigned char *end)
+{
+	pstream_json_t *json = &stream->grammar.json;
+
+	for (;;) {
+		if (json->escaped) {
+			if (p == end) {
+				return p;
+			}
+			if (!pstream_token_append(stream, p, 1)) {
+				return NULL;
+			}
+			p++;
+			json->escaped = false;
+		}
+
+		const unsigned char *run = pjson_scan_string(p, end);
+		if (!pstream_token_append(stream, p, (size_t)(run - p))) {
+			return NULL;
+		}
+		p = run;
+
+		if (p == end) {
+			return p;
+		}
+		if (*p != '"' && *p != '\\') {
+			pvars_errno = FAILURE_PVARS_PARSE_JSON_BAD_STRING;
+			return NULL;
+		}
+		if (!pstream_token_append(stream, p, 1)) {
+			return NULL;
+		}
+
+		if (*p++ == '\\') {
+			json->escaped = true;
+			json->escapes = true;
+			continue;
+		}
+
+		json->lex = PSTREAM_LEX_NONE;
+		return pstream_json_string_done(stream) ? p : NULL;
+	}
+}
+
+/**
+ * @brief Reads on in a number or literal, up to the byte after it or the
+ * end of the chunk.
+ *
+ * @return Where reading stopped, or NULL on failure (with pvars_errno set).
+ */
+static const unsigned char *pstream_json_scalar(pvars_stream_t *stream, const unsigned char *p, const unsigned char *end)
+{
+	const unsigned char *run = p;
+	while (run < end && !pstream_json_delimiter[*run]) {
+		run++;
+	}
+
+	if (!pstream_token_append(stream, p, (size_t)(run - p))) {
+		return NULL;
+	}
+	if (run == end) {
+		return run;
+	}
+
+	stream->grammar.json.lex = PSTREAM_LEX_NONE;
+	return pstream_json_scalar_done(stream) ? run : NULL;
+}
+
+/**
+ * @brief Reads the byte after a token: whitespace, an operator or the
+ * start of the next token.
+ *
+ * @return Where reading stopped, or NULL on failure (with pvars_errno set).
+ */
+static const unsigned char *pstream_json_operator(pvars_stream_t *stream, const unsigned char *p, const unsigned char *end)
+{
+	pstream_json_t *json = &stream->grammar.json;
+	unsigned char c = *p;
+	pvar_type type;
+
+	switch (c) {
+		case ' ':
+		case '\t':
+		case '\n':
+		case '\r':
+			while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+				p++;
+			}
+			return p;
+		case '"':
+			if (!pstream_json_accepts(json, false) && !pstream_json_accepts(json, true)) {
+				break;
+			}
+			json->lex = PSTREAM_LEX_STRING;
+			json->escaped = false;
+			json->escapes = false;
+			stream->token_size = 0;
+			return p + 1;
+		case '[':
+		case '{':
+			if (!pstream_json_accepts(json, false)) {
+				break;
+			}
+			if (stream->depth >= PVARS_JSON_MAX_DEPTH) {
+				pvars_errno = FAILURE_PVARS_PARSE_JSON_TOO_DEEP;
+				return NULL;
+			}
+
+			type = c == '{' ? PVAR_TYPE_DICT : PVAR_TYPE_LIST;
+			json->kinds[stream->depth] = (uint8_t)type;
+			json->expect = c == '{' ? PSTREAM_JSON_KEY_OR_CLOSE : PSTREAM_JSON_VALUE_OR_CLOSE;
+			return pstream_begin(stream, type, PVAR_TYPE_NONE, 0) ? p + 1 : NULL;
+		case ']':
+		case '}':
+			type = c == '}' ? PVAR_TYPE_DICT : PVAR_TYPE_LIST;
+			if (stream->depth == 0 || json->kinds[stream->depth - 1] != type) {
+				break;
+			}
+			if (json->expect != PSTREAM_JSON_COMMA_OR_CLOSE
+				&& json->expect != (c == '}' ? PSTREAM_JSON_KEY_OR_CLOSE : PSTREAM_JSON_VALUE_OR_CLOSE)) {
+				break;
+			}
+
+			if (!pstream_end(stream)) {
+				return NULL;
+			}
+			pstream_json_after_value(stream);
+			return p + 1;
+		case ',':
+			if (json->expect != PSTREAM_JSON_COMMA_OR_CLOSE) {
+				break;
+			}
+			json->expect = json->kinds[stream->depth - 1] == PVAR_TYPE_DICT ? PSTREAM_JSON_KEY : PSTREAM_JSON_VALUE;
+			return p + 1;
+		case ':':
+			if (json->expect != PSTREAM_JSON_COLON) {
+				break;
+			}
+			json->expect = PSTREAM_JSON_VALUE;
+			return p + 1;
+		default:
+			if (!pstream_json_accepts(json, false)) {
+				break;
+			}
+			/* A number or literal, checked once it is complete */
+			json->lex = PSTREAM_LEX_SCALAR;
+			stream->token_size = 0;
+			return p;
+	}
+
+	pvars_errno = FAILURE_PVARS_PARSE_JSON_SYNTAX;
+	return NULL;
+}
+
+/**
+ * @brief Reads a chunk of JSON input.
+ *
+ * @param stream The stream.
+ * @param data The chunk.
+ * @param size Its length, above 0.
+ * @param out_used Receives the bytes read before the one that failed, or
+ * size.
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+bool pstream_json_feed(pvars_stream_t *stream, const unsigned char *data, size_t size, size_t *out_used)
+{
+	const unsigned char *end = data + size;
+	const unsigned char *p = data;
+
+	while (p < end) {
+		const unsigned char *next;
+
+		switch (stream->grammar.json.lex) {
+			case PSTREAM_LEX_STRING:
+				next = pstream_json_string(stream, p, end);
+				break;
+			case PSTREAM_LEX_SCALAR:
+				next = pstream_json_scalar(stream, p, end);
+				break;
+			default:
+				next = pstream_json_operator(stream, p, end);
+				break;
+		}
+
+		if (next == NULL) {
+			*out_used = (size_t)(p - data);
+			return false;
+		}
+		p = next;
+	}
+
+	*out_used = size;
+	return true;
+}
+
+/**
+ * @brief Checks that the JSON input ended between two documents,
+ * completing a number or literal it ended with.
+ *
+ * @return True on success, false on failure (with pvars_errno set).
+ */
+bool pstream_json_finish(pvars_stream_t *stream)
+{
+	pstream_json_t *json = &stream->grammar.json;
+
+	if (json->lex == PSTREAM_LEX_STRING) {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_BAD_STRING;
+		return false;
+	}
+
+	if (json->lex == PSTREAM_LEX_SCALAR) {
+		json->lex = PSTREAM_LEX_NONE;
+		if (!pstream_json_scalar_done(stream)) {
+			return false;
+		}
+	}
+
+	if (stream->depth > 0) {
+		pvars_errno = FAILURE_PVARS_PARSE_JSON_SYNTAX;
+		return false;
+	}
+	return true;
+}
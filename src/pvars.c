@@ -1,10 +1,14 @@
 #define _POSIX_C_SOURCE 200809L
 
 #include<math.h>     // For fabs() and fabsf()
-#include<float.h>    // For FLT_EPSILON and DBL_EPSILON#include"pvars.h"
+#include<float.h>    // For FLT_EPSILON and DBL_EPSILON
+#include<string.h>   // For memcpy() and strlen()
 
 #include"pvars.h"
 #include"pvars_internal.h"
+#include"pdict_internal.h"
+#include"pmem_internal.h"
+#include"pstr_internal.h"
 
 /**
  * @brief Frees the dynamically allocated data inside a pvar_t struct.
@@ -13,6 +17,20 @@
  * @param pvar_t to be destroyed
  */
 void pvar_destroy_internal(pvar_t *pvar)
+{
+	pvar_destroy_in(pmem_heap(), pvar);
+}
+
+/**
+ * @brief Frees the data inside a pvar_t struct that belongs to a container
+ * using allocator.
+ *
+ * Strings are returned to allocator. Nested lists and dicts know their own
+ * allocator, and destroying them is a no-op for arena memory.
+ * @param allocator The allocator of the container holding the value.
+ * @param pvar_t to be destroyed
+ */
+void pvar_destroy_in(const pvars_allocator_t *allocator, pvar_t *pvar)
 {
 	if (pvar == NULL || pvar->type == PVAR_TYPE_NONE) {
 		return;
@@ -20,10 +38,13 @@ void pvar_destroy_internal(pvar_t *pvar)
 
 	switch (pvar->type) {
 		case PVAR_TYPE_STRING:
-			if (pvar->data.s != NULL) {
-				free(pvar->data.s);
-				pvar->data.s = NULL;
+			if (pvar->str_tag == PVAR_STR_HEADER) {
+				pstr_free(allocator, pvar->data.s);
+			} else if (pvar->str_tag == PVAR_STR_PLAIN && pvar->data.s != NULL) {
+				pmem_free(allocator, pvar->data.s, strlen(pvar->data.s) + 1);
 			}
+			pvar->data.s = NULL;
+			pvar->str_tag = PVAR_STR_PLAIN;
 			break;
 		case PVAR_TYPE_LIST:
 			if (pvar->data.ls != NULL) {
@@ -49,6 +70,154 @@ void pvar_destroy_internal(pvar_t *pvar)
 	pvar->type = PVAR_TYPE_NONE;
 }
 
+/**
+ * @brief Frees a value the caller owns, such as one returned by plist_pop()
+ * or pdict_pop(), and resets it to PVAR_TYPE_NONE.
+ *
+ * @param pvar The value to release. NULL is ignored.
+ */
+void pvar_destroy(pvar_t *pvar)
+{
+	/* Values owned by the caller always hold a plain string */
+	if (pvar != NULL && pvar->type == PVAR_TYPE_STRING) {
+		pvar->str_tag = PVAR_STR_PLAIN;
+	}
+
+	pvar_destroy_internal(pvar);
+}
+
+/**
+ * @brief Makes pvar a PVAR_TYPE_STRING holding a copy of len bytes.
+ *
+ * Strings shorter than PVAR_INLINE_STR_SIZE are copied into the pvar itself,
+ * longer ones get a length-prefixed copy from allocator with its hash
+ * cached. Any previous content of pvar is overwritten, not released.
+ *
+ * @param allocator Where a long string is allocated.
+ * @param pvar The variable to fill.
+ * @param bytes The bytes to copy. They may contain NULs.
+ * @param len Number of bytes.
+ * @return True on success, false if the copy could not be allocated, in which
+ * case pvar is unchanged.
+ */
+bool pvar_set_strn_in(const pvars_allocator_t *allocator, pvar_t *pvar, const char *bytes, size_t len)
+{
+	if (len < PVAR_INLINE_STR_SIZE) {
+		char *inline_str = (char *)pvar;
+
+		memmove(inline_str, bytes, len);
+		inline_str[len] = '\0';
+		pvar->str_tag = (uint8_t)(len + 1);
+	} else {
+		char *copy = pstr_create(allocator, bytes, len, true);
+		if (copy == NULL) {
+			return false;
+		}
+		pvar->data.s = copy;
+		pvar->str_tag = PVAR_STR_HEADER;
+	}
+
+	pvar->type = PVAR_TYPE_STRING;
+	return true;
+}
+
+/**
+ * @brief Makes pvar a PVAR_TYPE_STRING holding a copy of str. See
+ * pvar_set_strn_in().
+ */
+bool pvar_set_str_in(const pvars_allocator_t *allocator, pvar_t *pvar, const char *str)
+{
+	return pvar_set_strn_in(allocator, pvar, str, strlen(str));
+}
+
+/**
+ * @brief Returns the string held by a PVAR_TYPE_STRING variable, wherever it
+ * is stored.
+ *
+ * @param pvar A string variable.
+ * @return Its characters, NUL terminated. An inline string moves with the pvar.
+ */
+const char *pvar_str(const pvar_t *pvar)
+{
+	if (pvar->str_tag == PVAR_STR_PLAIN || pvar->str_tag == PVAR_STR_HEADER) {
+		return pvar->data.s;
+	}
+	return (const char *)pvar;
+}
+
+/**
+ * @brief Returns the length of the string held by a PVAR_TYPE_STRING variable.
+ *
+ * Only plain strings are measured with strlen(); the others carry their
+ * length and may contain NULs.
+ *
+ * @param pvar A string variable.
+ * @return Its length in bytes.
+ */
+size_t pvar_str_len(const pvar_t *pvar)
+{
+	switch (pvar->str_tag) {
+		case PVAR_STR_PLAIN:
+			return strlen(pvar->data.s);
+		case PVAR_STR_HEADER:
+			return pstr_len(pvar->data.s);
+		default:
+			return (size_t)pvar->str_tag - 1;
+	}
+}
+
+/**
+ * @brief Tells whether a variable holds a string stored inside the pvar.
+ *
+ * @param pvar The variable to check.
+ * @return True for an inline string, false otherwise.
+ */
+bool pvar_is_inline_str(const pvar_t *pvar)
+{
+	return pvar->type == PVAR_TYPE_STRING && pvar->str_tag != PVAR_STR_PLAIN && pvar->str_tag != PVAR_STR_HEADER;
+}
+
+/**
+ * @brief Copies the string of a PVAR_TYPE_STRING variable into a plain heap
+ * string, as handed to callers by plist_pop() and pdict_pop().
+ *
+ * @param pvar A string variable.
+ * @return The copy, to be released with free(), or NULL on failure.
+ */
+char *pvar_str_to_heap(const pvar_t *pvar)
+{
+	return pmem_strndup(pmem_heap(), pvar_str(pvar), pvar_str_len(pvar));
+}
+
+/**
+ * @brief Compares a string variable with len bytes whose pstr_hash_bytes()
+ * value is hash.
+ *
+ * Lengths are compared first, then cached hashes, so the bytes are only read
+ * when both match.
+ *
+ * @param pvar The variable to compare.
+ * @param bytes The bytes to compare against.
+ * @param len Number of bytes.
+ * @param hash pstr_hash_bytes(bytes, len).
+ * @return True if pvar is a string holding exactly those bytes.
+ */
+bool pvar_str_equals(const pvar_t *pvar, const char *bytes, size_t len, uint64_t hash)
+{
+	if (pvar->type != PVAR_TYPE_STRING || pvar_str_len(pvar) != len) {
+		return false;
+	}
+
+	if (pvar->str_tag == PVAR_STR_HEADER) {
+		const pstr_t *header = pstr_header(pvar->data.s);
+		if ((header->flags & PSTR_FLAG_HASHED) && header->hash != hash) {
+			return false;
+		}
+	}
+
+	return memcmp(pvar_str(pvar), bytes, len) == 0;
+}
+
 /**
  * @brief Compares two variables.
  *
@@ -71,10 +240,23 @@ bool pvar_equals(pvar_t *a, pvar_t *b)
 	
 	switch (a->type) {
 		case PVAR_TYPE_STRING:
-			/* Extra curly braces creates new scope for the int declaration. Compilers with stricter standars should be satisfied */
+			/* Extra curly braces creates new scope for the declarations. Compilers with stricter standars should be satisfied */
 			{
-				int strcmp_result = strcmp(a->data.s, b->data.s);
-				if (strcmp_result != 0) {
+				size_t len = pvar_str_len(a);
+				if (len != pvar_str_len(b)) {
+					return false;
+				}
+
+				/* Cached hashes settle most mismatches between long strings */
+				if (a->str_tag == PVAR_STR_HEADER && b->str_tag == PVAR_STR_HEADER) {
+					const pstr_t *header_a = pstr_header(a->data.s);
+					const pstr_t *header_b = pstr_header(b->data.s);
+					if ((header_a->flags & header_b->flags & PSTR_FLAG_HASHED) && header_a->hash != header_b->hash) {
+						return false;
+					}
+				}
+
+				if (memcmp(pvar_str(a), pvar_str(b), len) != 0) {
 					return false;
 				}
 			}
@@ -103,12 +285,20 @@ bool pvar_equals(pvar_t *a, pvar_t *b)
 	}
 }
 
-pvar_t pvar_copy(const pvar_t *src)
+/**
+ * @brief Deep copies a variable with the given allocator.
+ *
+ * @param allocator Where the copy's strings, lists and dicts are allocated.
+ * @param src The variable to copy.
+ * @return The copy. pvars_errno is SUCCESS unless the copy failed.
+ */
+pvar_t pvar_copy_in(const pvars_allocator_t *allocator, const pvar_t *src)
 {
 	/* pvars_errno must be clear on each call to determine if pvar_copy fails recursively. See plist_copy */
 	pvars_errno = PERRNO_CLEAR;
 	pvar_t new_pvar;
 	new_pvar.type = PVAR_TYPE_NONE;
+	new_pvar.str_tag = PVAR_STR_PLAIN;
 	if (src == NULL) {
 		pvars_errno = FAILURE_PVAR_COPY_NULL_INPUT;
 		return new_pvar;
@@ -116,20 +306,15 @@ pvar_t pvar_copy(const pvar_t *src)
 	
 	switch (src->type) {
 		case PVAR_TYPE_STRING:
-			/* Extra curly braces creates new scope for the char * declaration. Compilers with stricter standars should be satisfied */
-			{
-				char *new_string = strdup(src->data.s);
-				if (new_string == NULL) {
-					pvars_errno = FAILURE_PVAR_COPY_STRDUP_FAILED;
-					return new_pvar;
-				}
-				new_pvar.data.s = new_string;
+			if (!pvar_set_strn_in(allocator, &new_pvar, pvar_str(src), pvar_str_len(src))) {
+				pvars_errno = FAILURE_PVAR_COPY_STRDUP_FAILED;
+				return new_pvar;
 			}
 			break;
 		case PVAR_TYPE_LIST:
 			/* Extra curly braces creates new scope for the plist_t * declaration. Compilers with stricter standars should be satisfied */
 			{
-				plist_t *new_list = plist_copy(src->data.ls);
+				plist_t *new_list = plist_copy_in(allocator, src->data.ls);
 				if (new_list == NULL) {
 					pvars_errno = FAILURE_PVAR_COPY_PLIST_COPY_FAILED;
 					return new_pvar;
@@ -137,8 +322,16 @@ pvar_t pvar_copy(const pvar_t *src)
 				new_pvar.data.ls = new_list;
 			}
 			break;
-		//case PVAR_TYPE_DICT:
-		//	break;
+		case PVAR_TYPE_DICT:
+			{
+				pdict_t *new_dict = pdict_copy_in(allocator, src->data.dt);
+				if (new_dict == NULL) {
+					pvars_errno = FAILURE_PVAR_COPY_PDICT_COPY_FAILED;
+					return new_pvar;
+				}
+				new_pvar.data.dt = new_dict;
+			}
+			break;
 		//case PVAR_TYPE_TUPLE:
 		//	break;
 		case PVAR_TYPE_INT:
@@ -0,0 +1,1012 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include<stdio.h>
+#include<stdlib.h>
+#include<string.h>
+#include<time.h>
+
+#include"pvars.h"
+#include"perrno.h"
+#include"phash_internal.h"
+
+/*
+ * Micro benchmarks for libpvars.
+ *
+ * Build and run with `make bench`. An optional argument sets the number of
+ * keys, e.g. `./bench_pvars 1000000`.
+ */
+
+#define BENCH_DEFAULT_KEYS 200000
+#define BENCH_KEY_SIZE 32
+#define BENCH_HASH_BYTES (64u * 1024u * 1024u) /* Bytes hashed per key length */
+
+/**
+ * @brief Returns a monotonic timestamp in seconds.
+ */
+static double bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Prints one result line in nanoseconds per operation.
+ */
+static void bench_report(const char *backend, const char *operation, double seconds, size_t operations)
+{
+	printf("%-8s %-10s %10.1f ns/op\n", backend, operation, seconds * 1e9 / (double)operations);
+}
+
+/**
+ * @brief Times inserts, successful lookups and failed lookups on a dict.
+ *
+ * @param name Label printed with the results.
+ * @param backend The dict backend to measure.
+ * @param keys Keys to insert.
+ * @param misses Keys that are never inserted.
+ * @param count Number of entries in keys and misses.
+ */
+static void bench_pdict(const char *name, pdict_backend backend, char (*keys)[BENCH_KEY_SIZE], char (*misses)[BENCH_KEY_SIZE], size_t count)
+{
+	pdict_t *dict = pdict_create_with_backend(16, backend);
+	if (dict == NULL) {
+		fprintf(stderr, "%s\n", perror_message());
+		return;
+	}
+
+	double start = bench_now();
+	for (size_t i = 0; i < count; i++) {
+		pdict_add_long(dict, keys[i], (long)i);
+	}
+	bench_report(name, "insert", bench_now() - start, count);
+
+	long value;
+	long checksum = 0;
+
+	start = bench_now();
+	for (size_t i = 0; i < count; i++) {
+		if (pdict_get_long(dict, keys[i], &value)) {
+			checksum += value;
+		}
+	}
+	bench_report(name, "hit", bench_now() - start, count);
+
+	start = bench_now();
+	for (size_t i = 0; i < count; i++) {
+		checksum += pdict_contains(dict, misses[i]);
+	}
+	bench_report(name, "miss", bench_now() - start, count);
+
+	/* Keeps the lookups from being optimised away */
+	if (checksum == -1) {
+		putchar('\n');
+	}
+
+	pdict_destroy(dict);
+}
+
+/**
+ * @brief Times a hash function over many keys of one length.
+ *
+ * @param name Label printed with the results.
+ * @param hash The function to measure.
+ * @param buffer Source bytes, at least len + 64 long.
+ * @param len Key length in bytes.
+ */
+static void bench_hash(const char *name, uint64_t (*hash)(const void *, size_t, uint64_t), const char *buffer, size_t len)
+{
+	size_t operations = BENCH_HASH_BYTES / len;
+	uint64_t checksum = 0;
+
+	double start = bench_now();
+	for (size_t i = 0; i < operations; i++) {
+		/* Chaining the seed measures latency and stops calls being merged */
+		checksum += hash(buffer + (i & 63), len, checksum);
+	}
+	double seconds = bench_now() - start;
+
+	printf("%-8s %4zu B  %8.2f ns/hash  %7.2f GB/s\n", name, len,
+		seconds * 1e9 / (double)operations, (double)operations * (double)len / seconds / 1e9);
+
+	/* Keeps the hashes from being optimised away */
+	if (checksum == 1) {
+		putchar('\n');
+	}
+}
+
+/**
+ * @brief Times building and releasing a scratch document: a list of small
+ * dicts with string values.
+ *
+ * @param name Label printed with the results.
+ * @param arena Arena to build in, or NULL for the heap.
+ * @param keys Keys to use.
+ * @param count Number of dicts in the document.
+ */
+static void bench_tree(const char *name, pvars_arena_t *arena, char (*keys)[BENCH_KEY_SIZE], size_t count)
+{
+	double start = bench_now();
+
+	plist_t *document = plist_create_in(arena, 16);
+	for (size_t i = 0; i < count; i++) {
+		pdict_t *record = pdict_create_in(arena, 8);
+		for (size_t j = 0; j < 8; j++) {
+			pdict_add_str(record, keys[j % count], keys[i]);
+		}
+		plist_add_dict_take(document, record);
+	}
+	double built = bench_now();
+
+	/* The pool is measured while the document holds its references */
+	pvars_intern_stats_t stats;
+	bool pooled = pvars_get_key_interning() && pvars_get_intern_stats(&stats);
+	double counted = bench_now();
+
+	if (arena != NULL) {
+		pvars_arena_reset(arena);
+	} else {
+		plist_destroy(document);
+	}
+	double released = bench_now();
+
+	bench_report(name, "build", built - start, count);
+	bench_report(name, "release", released - counted, count);
+	if (pooled) {
+		printf("%-8s %zu keys, %zu references, %zu bytes pooled, %zu bytes saved\n",
+			name, stats.unique_keys, stats.references, stats.bytes, stats.bytes_saved);
+	}
+}
+
+/**
+ * @brief Times copying a large document and the first write to the copy,
+ * which unshares only the path to the written value.
+ *
+ * @param keys Keys to use.
+ * @param count Number of dicts in the document.
+ */
+static void bench_copy(char (*keys)[BENCH_KEY_SIZE], size_t count)
+{
+	plist_t *document = plist_create(16);
+	for (size_t i = 0; i < count; i++) {
+		pdict_t *record = pdict_create(8);
+		for (size_t j = 0; j < 8; j++) {
+			pdict_add_str(record, keys[j % count], keys[i]);
+		}
+		plist_add_dict_take(document, record);
+	}
+
+	double start = bench_now();
+	plist_t *copy = plist_copy(document);
+	double copied = bench_now();
+
+	pdict_t *record = NULL;
+	plist_get_dict(copy, 0, &record);
+	pdict_set_long(record, keys[0], 1);
+	plist_set_dict_take(copy, 0, record);
+	double written = bench_now();
+
+	printf("%-8s %-10s %10.1f ns\n", "cow", "copy", (copied - start) * 1e9);
+	printf("%-8s %-10s %10.1f ns\n", "cow", "write", (written - copied) * 1e9);
+
+	plist_destroy(copy);
+	plist_destroy(document);
+}
+
+/**
+ * @brief Times filling a list with doubles one call at a time and with a
+ * single bulk call, for a list of pvar_t and for a typed list of doubles.
+ *
+ * @param count Number of values.
+ */
+static void bench_extend(size_t count)
+{
+	double *values = malloc(count * sizeof(double));
+	if (values == NULL) {
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		values[i] = (double)i * 0.5;
+	}
+
+	plist_t *list = plist_create(16);
+	double start = bench_now();
+	for (size_t i = 0; i < count; i++) {
+		plist_add_double(list, values[i]);
+	}
+	bench_report("plist", "add", bench_now() - start, count);
+	plist_destroy(list);
+
+	list = plist_create(16);
+	start = bench_now();
+	plist_extend_doubles(list, values, count);
+	bench_report("plist", "extend", bench_now() - start, count);
+	plist_destroy(list);
+
+	list = plist_create_typed(PVAR_TYPE_DOUBLE, 16);
+	start = bench_now();
+	for (size_t i = 0; i < count; i++) {
+		plist_add_double(list, values[i]);
+	}
+	bench_report("typed", "add", bench_now() - start, count);
+	plist_destroy(list);
+
+	list = plist_create_typed(PVAR_TYPE_DOUBLE, 16);
+	start = bench_now();
+	plist_extend_doubles(list, values, count);
+	bench_report("typed", "extend", bench_now() - start, count);
+	plist_destroy(list);
+
+	free(values);
+}
+
+/**
+ * @brief Times plist_sum() and plist_variance() over a typed list of
+ * doubles, and plist_sum() over the same values as a list of pvar_t.
+ *
+ * @param count Number of values.
+ */
+static void bench_reduce(size_t count)
+{
+	plist_t *typed = plist_create_typed(PVAR_TYPE_DOUBLE, 16);
+	plist_t *boxed = plist_create(16);
+	double result = 0.0;
+	double checksum = 0.0;
+
+	for (size_t i = 0; i < count; i++) {
+		plist_add_double(typed, (double)(i % 1000) * 0.25);
+		plist_add_double(boxed, (double)(i % 1000) * 0.25);
+	}
+
+	double start = bench_now();
+	for (size_t pass = 0; pass < 16; pass++) {
+		plist_sum(boxed, &result);
+		checksum += result;
+	}
+	bench_report("plist", "sum", bench_now() - start, count * 16);
+
+	start = bench_now();
+	for (size_t pass = 0; pass < 16; pass++) {
+		plist_sum(typed, &result);
+		checksum += result;
+	}
+	bench_report("typed", "sum", bench_now() - start, count * 16);
+
+	start = bench_now();
+	for (size_t pass = 0; pass < 16; pass++) {
+		plist_variance(typed, &result);
+		checksum += result;
+	}
+	bench_report("typed", "variance", bench_now() - start, count * 16);
+
+	/* Keeps the reductions from being optimised away */
+	if (checksum == -1.0) {
+		putchar('\n');
+	}
+
+	plist_destroy(boxed);
+	plist_destroy(typed);
+}
+
+/* Removes every value whose index leaves remainder 0, 1 or 2 modulo 10 */
+static bool bench_remove_predicate(const pvar_t *value, void *ctx)
+{
+	(void)ctx;
+	return value->data.l % 10 < 3;
+}
+
+/**
+ * @brief Times dropping 30% of a list with one plist_remove_if() call, and
+ * with plist_remove() on a list a tenth of the size, which moves the tail
+ * once per removal.
+ *
+ * @param count Number of values.
+ */
+static void bench_remove(size_t count)
+{
+	size_t small = count / 10 > 0 ? count / 10 : 1;
+	plist_t *list = plist_create(16);
+
+	for (size_t i = 0; i < count; i++) {
+		plist_add_long(list, (long)i);
+	}
+	double start = bench_now();
+	size_t removed = plist_remove_if(list, bench_remove_predicate, NULL);
+	bench_report("plist", "remove_if", bench_now() - start, removed > 0 ? removed : 1);
+	plist_destroy(list);
+
+	list = plist_create(16);
+	for (size_t i = 0; i < small; i++) {
+		plist_add_long(list, (long)i);
+	}
+	removed = 0;
+	start = bench_now();
+	for (size_t i = 0; i < plist_get_size(list); ) {
+		long value = 0;
+		plist_get_long(list, i, &value);
+		if (value % 10 < 3) {
+			plist_remove(list, i);
+			removed++;
+		} else {
+			i++;
+		}
+	}
+	bench_report("plist", "remove", bench_now() - start, removed > 0 ? removed : 1);
+	plist_destroy(list);
+}
+
+/**
+ * @brief Times plist_contains() on a list of keys, scanning and through
+ * the hash index of plist_set_indexed().
+ *
+ * @param keys Keys to put in the list and to look up.
+ * @param count Number of keys.
+ */
+static void bench_contains(char (*keys)[BENCH_KEY_SIZE], size_t count)
+{
+	plist_t *list = plist_create(16);
+	size_t lookups = count < 1000 ? count : 1000;
+	size_t found = 0;
+	pvar_t value = { .type = PVAR_TYPE_STRING };
+
+	for (size_t i = 0; i < count; i++) {
+		plist_add_str(list, keys[i]);
+	}
+
+	double start = bench_now();
+	for (size_t i = 0; i < lookups; i++) {
+		value.data.s = keys[(i * 7919) % count];
+		found += plist_contains(list, &value);
+	}
+	bench_report("plist", "scan", bench_now() - start, lookups);
+
+	plist_set_indexed(list, true);
+	start = bench_now();
+	plist_contains(list, &value);
+	bench_report("plist", "index", bench_now() - start, 1);
+
+	start = bench_now();
+	for (size_t i = 0; i < count; i++) {
+		value.data.s = keys[(i * 7919) % count];
+		found += plist_contains(list, &value);
+	}
+	bench_report("plist", "lookup", bench_now() - start, count);
+
+	/* Keeps the lookups from being optimised away */
+	if (found == 0) {
+		putchar('\n');
+	}
+
+	plist_destroy(list);
+}
+
+/**
+ * @brief Times a list used as a work queue: values added at the back and
+ * popped from the front, with the queue holding about 1000 of them.
+ *
+ * @param count Number of values passed through the queue.
+ */
+static void bench_queue(size_t count)
+{
+	plist_t *queue = plist_create(16);
+	pvar_t value;
+
+	double start = bench_now();
+	for (size_t i = 0; i < count; i++) {
+		plist_add_long(queue, (long)i);
+		if (i >= 1000) {
+			plist_pop(queue, 0, &value);
+		}
+	}
+	bench_report("plist", "queue", bench_now() - start, count);
+	plist_destroy(queue);
+}
+
+/**
+ * @brief Times encoding a document of small dicts with pvars_serialize()
+ * into a reused buffer, and decoding it with pvars_deserialize().
+ *
+ * @param keys Keys to use.
+ * @param count Number of dicts in the document.
+ */
+static void bench_serialize(char (*keys)[BENCH_KEY_SIZE], size_t count)
+{
+	plist_t *document = plist_create(16);
+	for (size_t i = 0; i < count; i++) {
+		pdict_t *record = pdict_create(8);
+		for (size_t j = 0; j < 4; j++) {
+			pdict_add_str(record, keys[j % count], keys[i]);
+		}
+		for (size_t j = 4; j < 8; j++) {
+			pdict_add_long(record, keys[j % count], (long)(i * j));
+		}
+		plist_add_dict_take(document, record);
+	}
+
+	pvars_buffer_t buffer;
+	pvars_buffer_init(&buffer);
+	pvar_t root = { .data.ls = document, .type = PVAR_TYPE_LIST };
+
+	/* The first pass sizes the buffer, the second is timed */
+	pvars_serialize(&root, &buffer);
+	pvars_buffer_clear(&buffer);
+	double start = bench_now();
+	pvars_serialize(&root, &buffer);
+	double encoded = bench_now() - start;
+
+	pvar_t decoded;
+	start = bench_now();
+	bool done = pvars_deserialize(buffer.data, buffer.size, &decoded, NULL);
+	double seconds = bench_now() - start;
+
+	bench_report("binary", "encode", encoded, count);
+	bench_report("binary", "decode", seconds, count);
+	printf("%-8s %-10s %10.1f MB/s  %zu bytes\n", "binary", "decode", (double)buffer.size / seconds / 1e6, buffer.size);
+
+	if (done) {
+		pvar_destroy(&decoded);
+	}
+	pvars_buffer_release(&buffer);
+	plist_destroy(document);
+}
+
+/**
+ * @brief Times writing the same document as bench_serialize() as an image,
+ * opening it, and reading one field of every dict in place.
+ *
+ * @param keys Keys to use.
+ * @param count Number of dicts in the document.
+ */
+static void bench_image(char (*keys)[BENCH_KEY_SIZE], size_t count)
+{
+	plist_t *document = plist_create(16);
+	for (size_t i = 0; i < count; i++) {
+		pdict_t *record = pdict_create(8);
+		for (size_t j = 0; j < 4; j++) {
+			pdict_add_str(record, keys[j % count], keys[i]);
+		}
+		for (size_t j = 4; j < 8; j++) {
+			pdict_add_long(record, keys[j % count], (long)(i * j));
+		}
+		plist_add_dict_take(document, record);
+	}
+
+	pvars_buffer_t buffer;
+	pvars_buffer_init(&buffer);
+	pvar_t root = { .data.ls = document, .type = PVAR_TYPE_LIST };
+
+	double start = bench_now();
+	pvars_image_write(&root, &buffer);
+	double written = bench_now();
+	pvars_image_t *image = pvars_image_open(buffer.data, buffer.size);
+	double opened = bench_now();
+
+	pview_t list;
+	pview_t record;
+	pview_t field;
+	long total = 0;
+	long value;
+	pvars_image_root(image, &list);
+	for (size_t i = 0; i < count; i++) {
+		if (pview_list_get(&list, i, &record) && pview_dict_get(&record, keys[5 % count], &field) && pview_get_long(&field, &value)) {
+			total += value;
+		}
+	}
+	double read = bench_now();
+
+	bench_report("image", "write", written - start, count);
+	bench_report("image", "open", opened - written, 1);
+	bench_report("image", "lookup", read - opened, count);
+	printf("%-8s %-10s %10zu bytes  (checksum %ld)\n", "image", "size", buffer.size, total);
+
+	pvars_image_close(image);
+	pvars_buffer_release(&buffer);
+	plist_destroy(document);
+}
+
+/**
+ * @brief Cursor of bench_json_naive().
+ */
+typedef struct {
+	const char *p;
+	const char *end;
+} bench_json_cursor_t;
+
+static void bench_json_skip(bench_json_cursor_t *cursor)
+{
+	while (cursor->p < cursor->end && (*cursor->p == ' ' || *cursor->p == '\n' || *cursor->p == '\t' || *cursor->p == '\r')) {
+		cursor->p++;
+	}
+}
+
+/**
+ * @brief Copies the string at the cursor, handling \" and \\ only.
+ */
+static char *bench_json_string(bench_json_cursor_t *cursor)
+{
+	const char *start = ++cursor->p;
+	while (cursor->p < cursor->end && *cursor->p != '"') {
+		cursor->p += *cursor->p == '\\' ? 2 : 1;
+	}
+
+	char *copy = malloc((size_t)(cursor->p - start) + 1);
+	size_t len = 0;
+	for (const char *q = start; q < cursor->p; q++) {
+		if (*q == '\\') {
+			q++;
+		}
+		copy[len++] = *q;
+	}
+	copy[len] = '\0';
+	cursor->p++;
+	return copy;
+}
+
+static bool bench_json_value(bench_json_cursor_t *cursor, plist_t *list, pdict_t *dict, const char *key);
+
+/**
+ * @brief Parses a value and adds it to list, or to dict under key, with
+ * the public plist_add_*() and pdict_add_*() calls: the way JSON was
+ * converted by hand before pvars_parse_json().
+ */
+static bool bench_json_value(bench_json_cursor_t *cursor, plist_t *list, pdict_t *dict, const char *key)
+{
+	bench_json_skip(cursor);
+	if (cursor->p == cursor->end) {
+		return false;
+	}
+
+	char c = *cursor->p;
+	if (c == '{' || c == '[') {
+		plist_t *inner_list = c == '[' ? plist_create(4) : NULL;
+		pdict_t *inner_dict = c == '{' ? pdict_create(4) : NULL;
+		char close = c == '[' ? ']' : '}';
+
+		cursor->p++;
+		bench_json_skip(cursor);
+		while (cursor->p < cursor->end && *cursor->p != close) {
+			char *member = NULL;
+			if (inner_dict != NULL) {
+				member = bench_json_string(cursor);
+				bench_json_skip(cursor);
+				cursor->p++; /* ':' */
+			}
+			bool done = bench_json_value(cursor, inner_list, inner_dict, member);
+			free(member);
+			if (!done) {
+				plist_destroy(inner_list);
+				pdict_destroy(inner_dict);
+				return false;
+			}
+			bench_json_skip(cursor);
+			if (cursor->p < cursor->end && *cursor->p == ',') {
+				cursor->p++;
+				bench_json_skip(cursor);
+			}
+		}
+		cursor->p++;
+
+		if (inner_list != NULL) {
+			list != NULL ? plist_add_list_take(list, inner_list) : pdict_add_list_take(dict, key, inner_list);
+		} else {
+			list != NULL ? plist_add_dict_take(list, inner_dict) : pdict_add_dict_take(dict, key, inner_dict);
+		}
+		return true;
+	}
+
+	if (c == '"') {
+		char *string = bench_json_string(cursor);
+		list != NULL ? plist_add_str(list, string) : pdict_add_str(dict, key, string);
+		free(string);
+		return true;
+	}
+
+	if (c == 't' || c == 'f' || c == 'n') {
+		int flag = c == 't';
+		cursor->p += c == 'f' ? 5 : 4;
+		list != NULL ? plist_add_int(list, flag) : pdict_add_int(dict, key, flag);
+		return true;
+	}
+
+	char *number_end;
+	const char *start = cursor->p;
+	long integer = strtol(start, &number_end, 10);
+	if (*number_end == '.' || *number_end == 'e' || *number_end == 'E') {
+		double real = strtod(start, &number_end);
+		list != NULL ? plist_add_double(list, real) : pdict_add_double(dict, key, real);
+	} else {
+		list != NULL ? plist_add_long(list, integer) : pdict_add_long(dict, key, integer);
+	}
+	cursor->p = number_end;
+	return number_end != start;
+}
+
+/**
+ * @brief Parses JSON with bench_json_value(). The text must be NUL
+ * terminated, as strtol() and strtod() read it in place.
+ */
+static plist_t *bench_json_naive(const char *json, size_t len)
+{
+	bench_json_cursor_t cursor = { json, json + len };
+	plist_t *root = plist_create(1);
+
+	if (!bench_json_value(&cursor, root, NULL, NULL)) {
+		plist_destroy(root);
+		return NULL;
+	}
+	return root;
+}
+
+/**
+ * @brief Times pvars_parse_json() and pvars_parse_json_in() against a
+ * naive recursive descent parser on an array of records, in MB/s.
+ *
+ * @param count Number of records.
+ */
+static void bench_json(size_t count)
+{
+	size_t capacity = count * 256 + 16;
+	char *json = malloc(capacity);
+	if (json == NULL) {
+		return;
+	}
+
+	size_t len = (size_t)snprintf(json, capacity, "[");
+	for (size_t i = 0; i < count; i++) {
+		len += (size_t)snprintf(json + len, capacity - len,
+			"%s\n  {\"id\": %zu, \"name\": \"user %zu\", \"email\": \"user%zu@example.com\", \"score\": %zu.%zu,"
+			" \"active\": %s, \"tags\": [\"alpha\", \"beta\", \"gamma\"], \"address\": {\"city\": \"City \\\"%zu\\\"\", \"zip\": \"%05zu\"}}",
+			i > 0 ? "," : "", i, i, i, i / 4, i % 100, i % 3 ? "true" : "false", i % 97, i % 100000);
+	}
+	len += (size_t)snprintf(json + len, capacity - len, "\n]");
+
+	/* Best of three, as the trees are large enough for the timings to wander */
+	double naive_seconds = 0.0;
+	double heap_seconds = 0.0;
+	double arena_seconds = 0.0;
+	pvars_arena_t *arena = pvars_arena_create(1024 * 1024);
+	for (int round = 0; round < 3; round++) {
+		double start = bench_now();
+		plist_t *naive = bench_json_naive(json, len);
+		double seconds = bench_now() - start;
+		naive_seconds = round == 0 || seconds < naive_seconds ? seconds : naive_seconds;
+		plist_destroy(naive);
+
+		pvar_t value;
+		start = bench_now();
+		bool done = pvars_parse_json(json, len, &value);
+		seconds = bench_now() - start;
+		heap_seconds = round == 0 || seconds < heap_seconds ? seconds : heap_seconds;
+		if (done) {
+			pvar_destroy(&value);
+		}
+
+		start = bench_now();
+		pvars_parse_json_in(arena, json, len, &value);
+		seconds = bench_now() - start;
+		arena_seconds = round == 0 || seconds < arena_seconds ? seconds : arena_seconds;
+		pvars_arena_reset(arena);
+	}
+	pvars_arena_destroy(arena);
+
+	printf("%-8s %-10s %10.1f MB/s, %zu bytes\n", "naive", "parse", (double)len / naive_seconds / 1e6, len);
+	printf("%-8s %-10s %10.1f MB/s  %.1fx\n", "heap", "parse", (double)len / heap_seconds / 1e6, naive_seconds / heap_seconds);
+	printf("%-8s %-10s %10.1f MB/s  %.1fx\n", "arena", "parse", (double)len / arena_seconds / 1e6, naive_seconds / arena_seconds);
+
+	free(json);
+}
+
+/**
+ * @brief Times pvars_to_json() against formatting the same records with
+ * snprintf(), and writing them to /dev/null with pvars_to_json_fd().
+ *
+ * @param count Number of records.
+ */
+static void bench_to_json(size_t count)
+{
+	plist_t *document = plist_create(16);
+	for (size_t i = 0; i < count; i++) {
+		pdict_t *record = pdict_create(8);
+		pdict_add_long(record, "id", (long)i * 7919);
+		pdict_add_str(record, "name", "user name");
+		pdict_add_double(record, "score", (double)i * 0.37);
+		pdict_add_double(record, "ratio", 1.0 / (double)(i + 1));
+		pdict_add_double(record, "latitude", 48.8566 + (double)(i % 1000) * 1e-4);
+		pdict_add_int(record, "count", (int)(i % 1000));
+		plist_add_dict_take(document, record);
+	}
+
+	/* What printing by hand costs: every number through snprintf() */
+	size_t capacity = count * 160 + 16;
+	char *text = malloc(capacity);
+	if (text == NULL) {
+		plist_destroy(document);
+		return;
+	}
+	double start = bench_now();
+	size_t len = 1;
+	text[0] = '[';
+	for (size_t i = 0; i < count; i++) {
+		len += (size_t)snprintf(text + len, capacity - len,
+			"%s{\"id\":%ld,\"name\":\"%s\",\"score\":%.17g,\"ratio\":%.17g,\"latitude\":%.17g,\"count\":%d}",
+			i > 0 ? "," : "", (long)i * 7919, "user name", (double)i * 0.37, 1.0 / (double)(i + 1), 48.8566 + (double)(i % 1000) * 1e-4, (int)(i % 1000));
+	}
+	text[len++] = ']';
+	double printed = bench_now() - start;
+	free(text);
+
+	pvars_buffer_t buffer;
+	pvars_buffer_init(&buffer);
+	pvar_t root = { .data.ls = document, .type = PVAR_TYPE_LIST };
+
+	/* The first pass sizes the buffer, the second is timed */
+	pvars_to_json(&root, &buffer, PVARS_JSON_COMPACT);
+	pvars_buffer_clear(&buffer);
+	start = bench_now();
+	pvars_to_json(&root, &buffer, PVARS_JSON_COMPACT);
+	double compact = bench_now() - start;
+	size_t compact_size = buffer.size;
+
+	pvars_buffer_clear(&buffer);
+	pvars_to_json(&root, &buffer, PVARS_JSON_PRETTY);
+	pvars_buffer_clear(&buffer);
+	start = bench_now();
+	pvars_to_json(&root, &buffer, PVARS_JSON_PRETTY);
+	double pretty = bench_now() - start;
+
+	double to_fd = 0.0;
+	FILE *null = fopen("/dev/null", "w");
+	if (null != NULL) {
+		start = bench_now();
+		pvars_to_json_fd(&root, fileno(null), PVARS_JSON_COMPACT);
+		to_fd = bench_now() - start;
+		fclose(null);
+	}
+
+	bench_report("printf", "format", printed, count);
+	printf("%-8s %-10s %10.1f MB/s\n", "printf", "format", (double)len / printed / 1e6);
+	bench_report("json", "compact", compact, count);
+	printf("%-8s %-10s %10.1f MB/s  %.1fx, %zu bytes\n", "json", "compact", (double)compact_size / compact / 1e6, printed / compact, compact_size);
+	bench_report("json", "pretty", pretty, count);
+	bench_report("json", "fd", to_fd, count);
+
+	pvars_buffer_release(&buffer);
+	plist_destroy(document);
+}
+
+/**
+ * @brief Counts what a stream reports, keeping the ids of active records
+ * as a filter would.
+ */
+typedef struct {
+	size_t events;
+	size_t records;
+	long total;
+} bench_stream_t;
+
+static bool bench_stream_event(void *context)
+{
+	((bench_stream_t *)context)->events++;
+	return true;
+}
+
+static bool bench_stream_key(void *context, const char *key, size_t len)
+{
+	(void)key;
+	(void)len;
+	return bench_stream_event(context);
+}
+
+static bool bench_stream_value(void *context, const pvar_t *value)
+{
+	(void)value;
+	return bench_stream_event(context);
+}
+
+static bool bench_stream_select(void *context, pvar_type type, size_t depth)
+{
+	(void)context;
+	return type == PVAR_TYPE_DICT && depth == 0;
+}
+
+static bool bench_stream_subtree(void *context, pvar_t *value)
+{
+	bench_stream_t *counts = context;
+	int active = 0;
+	long id = 0;
+
+	counts->records++;
+	if (pdict_get_int(value->data.dt, "active", &active) && active && pdict_get_long(value->data.dt, "id", &id)) {
+		counts->total += id;
+	}
+	pvar_destroy(value);
+	return true;
+}
+
+/**
+ * @brief Feeds input to a new stream in chunks of 64 KiB and returns the
+ * seconds taken.
+ */
+static double bench_stream_run(pvars_stream_format format, const pvars_stream_callbacks_t *callbacks, bench_stream_t *counts, const void *data, size_t size)
+{
+	const size_t chunk = 64 * 1024;
+	memset(counts, 0, sizeof(*counts));
+
+	double start = bench_now();
+	pvars_stream_t *stream = pvars_stream_create(format, callbacks, counts);
+	for (size_t offset = 0; offset < size; offset += chunk) {
+		pvars_stream_feed(stream, (const char *)data + offset, size - offset < chunk ? size - offset : chunk);
+	}
+	pvars_stream_finish(stream);
+	pvars_stream_destroy(stream);
+	return bench_now() - start;
+}
+
+/**
+ * @brief Times streams over the records of bench_json(), one per line,
+ * and over the same records encoded one after the other: reporting every
+ * event, and building each record to read two fields from it, in MB/s.
+ * pvars_parse_json() on the whole text is the baseline, though it needs
+ * all of the records in memory at once.
+ *
+ * @param count Number of records.
+ */
+static void bench_stream(size_t count)
+{
+	size_t capacity = count * 256 + 16;
+	char *json = malloc(capacity);
+	if (json == NULL) {
+		return;
+	}
+
+	size_t len = 0;
+	for (size_t i = 0; i < count; i++) {
+		len += (size_t)snprintf(json + len, capacity - len,
+			"{\"id\": %zu, \"name\": \"user %zu\", \"email\": \"user%zu@example.com\", \"score\": %zu.%zu,"
+			" \"active\": %s, \"tags\": [\"alpha\", \"beta\", \"gamma\"], \"address\": {\"city\": \"City \\\"%zu\\\"\", \"zip\": \"%05zu\"}}\n",
+			i, i, i, i / 4, i % 100, i % 3 ? "true" : "false", i % 97, i % 100000);
+	}
+
+	const pvars_stream_callbacks_t events = {
+		.start_list = bench_stream_event,
+		.start_dict = bench_stream_event,
+		.key = bench_stream_key,
+		.string = bench_stream_key,
+		.value = bench_stream_value,
+		.end = bench_stream_event,
+	};
+	const pvars_stream_callbacks_t records = {
+		.select = bench_stream_select,
+		.subtree = bench_stream_subtree,
+	};
+	bench_stream_t counts;
+
+	/* The baseline parses the same records as one array */
+	double start = bench_now();
+	json[len - 1] = ']';
+	char *array = malloc(len + 1);
+	pvar_t value;
+	bool done = false;
+	if (array != NULL) {
+		array[0] = '[';
+		for (size_t i = 0; i < len; i++) {
+			array[i + 1] = json[i] == '\n' ? ',' : json[i];
+		}
+		start = bench_now();
+		done = pvars_parse_json(array, len + 1, &value);
+	}
+	double parsed = bench_now() - start;
+	json[len - 1] = '\n';
+	free(array);
+
+	double scanned = bench_stream_run(PVARS_STREAM_JSON, &events, &counts, json, len);
+	size_t scanned_events = counts.events;
+	double built = bench_stream_run(PVARS_STREAM_JSON, &records, &counts, json, len);
+
+	printf("%-8s %-10s %10.1f MB/s, %zu bytes\n", "parse", "json", (double)len / parsed / 1e6, len);
+	printf("%-8s %-10s %10.1f MB/s  %zu events\n", "stream", "events", (double)len / scanned / 1e6, scanned_events);
+	printf("%-8s %-10s %10.1f MB/s  %zu records (checksum %ld)\n", "stream", "records", (double)len / built / 1e6, counts.records, counts.total);
+
+	/* The same records, each encoded as a document of its own */
+	pvars_buffer_t binary;
+	pvars_buffer_init(&binary);
+	if (done) {
+		for (size_t i = 0; i < count; i++) {
+			const pdict_t *dict = NULL;
+			plist_borrow_dict(value.data.ls, i, &dict);
+			pvar_t record = { .type = PVAR_TYPE_DICT, .data.dt = (pdict_t *)dict };
+			pvars_serialize(&record, &binary);
+		}
+		pvar_destroy(&value);
+	}
+
+	scanned = bench_stream_run(PVARS_STREAM_BINARY, &events, &counts, binary.data, binary.size);
+	built = bench_stream_run(PVARS_STREAM_BINARY, &records, &counts, binary.data, binary.size);
+	printf("%-8s %-10s %10.1f MB/s, %zu bytes\n", "binary", "events", (double)binary.size / scanned / 1e6, binary.size);
+	printf("%-8s %-10s %10.1f MB/s  %zu records (checksum %ld)\n", "binary", "records", (double)binary.size / built / 1e6, counts.records, counts.total);
+
+	pvars_buffer_release(&binary);
+	free(json);
+}
+
+int main(int argc, char **argv)
+{
+	size_t count = BENCH_DEFAULT_KEYS;
+
+	if (argc > 1) {
+		count = (size_t)strtoul(argv[1], NULL, 10);
+	}
+	if (count == 0) {
+		count = BENCH_DEFAULT_KEYS;
+	}
+
+	char (*keys)[BENCH_KEY_SIZE] = malloc(count * sizeof(*keys));
+	char (*misses)[BENCH_KEY_SIZE] = malloc(count * sizeof(*misses));
+	if (keys == NULL || misses == NULL) {
+		fprintf(stderr, "Unable to allocate %zu benchmark keys\n", count);
+		free(keys);
+		free(misses);
+		return 1;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		snprintf(keys[i], BENCH_KEY_SIZE, "user:%zu:name", i);
+		snprintf(misses[i], BENCH_KEY_SIZE, "user:%zu:mail", i);
+	}
+
+	static const size_t hash_lengths[] = { 8, 32, 256 };
+	char hash_buffer[256 + 64];
+
+	for (size_t i = 0; i < sizeof(hash_buffer); i++) {
+		hash_buffer[i] = (char)('a' + i % 26);
+	}
+
+	printf("--- hash: short, medium and long keys ---\n");
+	for (size_t i = 0; i < sizeof(hash_lengths) / sizeof(hash_lengths[0]); i++) {
+		bench_hash("djb2", phash_djb2, hash_buffer, hash_lengths[i]);
+		bench_hash("wyhash", phash_wyhash, hash_buffer, hash_lengths[i]);
+	}
+
+	printf("--- plist: %zu values ---\n", count);
+	bench_extend(count);
+	bench_reduce(count);
+	bench_remove(count);
+	bench_queue(count);
+	bench_contains(keys, count);
+
+	printf("--- pdict: %zu keys ---\n", count);
+	bench_pdict("chained", PDICT_BACKEND_CHAINED, keys, misses, count);
+	bench_pdict("flat", PDICT_BACKEND_FLAT, keys, misses, count);
+
+	pvars_arena_t *arena = pvars_arena_create(0);
+	if (arena != NULL) {
+		printf("--- document: %zu dicts of 8 strings ---\n", count);
+		bench_tree("heap", NULL, keys, count);
+		bench_tree("arena", arena, keys, count);
+		pvars_arena_destroy(arena);
+	}
+
+	printf("--- serialize: %zu dicts of 4 strings and 4 longs ---\n", count);
+	bench_serialize(keys, count);
+	bench_image(keys, count);
+
+	printf("--- json: %zu records ---\n", count);
+	bench_json(count);
+	bench_to_json(count);
+	bench_stream(count);
+
+	printf("--- copy-on-write: %zu dicts of 8 strings ---\n", count);
+	bench_copy(keys, count);
+
+	/* The same document with its keys in the intern pool */
+	pvars_set_key_interning(true);
+	bench_tree("interned", NULL, keys, count);
+	pvars_set_key_interning(false);
+
+	free(keys);
+	free(misses);
+
+	return 0;
+}
@@ -3,12 +3,16 @@
 #include<stdio.h>
 #include<math.h>
 #include<float.h>
+#include<limits.h>
+#include<stdlib.h>
 #include<string.h>
+#include<pthread.h>
 
 #include"pvars.h"
 #include"pvars_internal.h" 
 #include"plist_internal.h" 
 #include"pdict_internal.h"
+#include"pserial_internal.h"
 #include"perrno.h"
 
 #define ASSERT_TRUE(condition, message) \
@@ -76,21 +80,21 @@ int test_plist_add_str(void)
 	ASSERT_TRUE(list->count == 1, "Expected a count of 1 at index 0.");
 	ASSERT_TRUE(list->capacity == 1, "Expected a capacity of 1 at index 0.");
 	ASSERT_TRUE(pvars_errno == SUCCESS, "pvars_errno expected success at index 0.");
-	ASSERT_TRUE(strcmp(list->elements[0].data.s, "libpvars") == 0, "strings are not equal at index 0.");
+	ASSERT_TRUE(strcmp(pvar_str(&list->elements[0]), "libpvars") == 0, "strings are not equal at index 0.");
 	
 	/* Index 1 */
 	plist_add_str(list, "test suite");
 	ASSERT_TRUE(list->count == 2, "Expected a count of 2 at index 1.");
 	ASSERT_TRUE(list->capacity == 2, "Expected a capacity of 2 at index 1.");
 	ASSERT_TRUE(pvars_errno == SUCCESS, "pvars_errno expected success at index 1.");
-	ASSERT_TRUE(strcmp(list->elements[1].data.s, "test suite") == 0, "strings are not equal at index 1.");
+	ASSERT_TRUE(strcmp(pvar_str(&list->elements[1]), "test suite") == 0, "strings are not equal at index 1.");
 	
 	/* Index 2 */
 	plist_add_str(list, "API");
 	ASSERT_TRUE(list->count == 3, "Expected a count of 3 at index 2.");
 	ASSERT_TRUE(list->capacity == 4, "Expected a capacity of 4 at index 2.");
 	ASSERT_TRUE(pvars_errno == SUCCESS, "pvars_errno expected success at index 2.");
-	ASSERT_TRUE(strcmp(list->elements[2].data.s, "API") == 0, "strings are not equal at index 2.");
+	ASSERT_TRUE(strcmp(pvar_str(&list->elements[2]), "API") == 0, "strings are not equal at index 2.");
 	
 	/* Test for a graceful fail when NULL is passed in */
 	/* Index 3 */
@@ -885,23 +889,23 @@ int test_plist_set_str(void)
 	
 	/* Index 0 */
 	plist_set_str(list, 0, "low-level");
-	ASSERT_TRUE(strcmp(list->elements[0].data.s, "low-level") == 0, "Expected strings to match at index 0.");
+	ASSERT_TRUE(strcmp(pvar_str(&list->elements[0]), "low-level") == 0, "Expected strings to match at index 0.");
 	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 0.");
 	
 	/* Index 1 */
 	plist_set_str(list, 1, "network");
-	ASSERT_TRUE(strcmp(list->elements[1].data.s, "network") == 0, "Expected strings to match at index 1.");
+	ASSERT_TRUE(strcmp(pvar_str(&list->elements[1]), "network") == 0, "Expected strings to match at index 1.");
 	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 1.");
 	
 	/* Index 2 */
 	/* Replacing different type */
 	plist_set_str(list, 2, "compiled");
-	ASSERT_TRUE(strcmp(list->elements[2].data.s, "compiled") == 0, "Expected strings to match at index 2.");
+	ASSERT_TRUE(strcmp(pvar_str(&list->elements[2]), "compiled") == 0, "Expected strings to match at index 2.");
 	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 2.");
 	
 	/* Index 3 */
 	plist_set_str(list, 3, "assembly");
-	ASSERT_TRUE(strcmp(list->elements[3].data.s, "assembly") == 0, "Expected strings to match at index 3.");
+	ASSERT_TRUE(strcmp(pvar_str(&list->elements[3]), "assembly") == 0, "Expected strings to match at index 3.");
 	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 3.");
 	
 	/* Index 4 */
@@ -1173,8 +1177,8 @@ int test_plist_set_list(void)
 	plist_destroy(list_child5);
 	value = NULL;
 	plist_get_list(list, 1, &value);
-	ASSERT_TRUE(strcmp(value->elements[0].data.s, "API") == 0, "Expected strings to match at index 1.");
-	ASSERT_TRUE(strcmp(value->elements[1].data.s, "C") == 0, "Expected strings to match at index 1.");
+	ASSERT_TRUE(strcmp(pvar_str(&value->elements[0]), "API") == 0, "Expected strings to match at index 1.");
+	ASSERT_TRUE(strcmp(pvar_str(&value->elements[1]), "C") == 0, "Expected strings to match at index 1.");
 	plist_destroy(value);
 	
 	/* Index 2 */
@@ -1429,7 +1433,7 @@ int test_plist_contains(void)
 	result = plist_contains(list, &string);
 	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 0.");
 	ASSERT_TRUE(result == true, "Expected result == true at index 0.");
-	pvar_destroy_internal(&string);
+	pvar_destroy(&string);
 	
 	/* Index 1 */
 	result = plist_contains(list, &integer);
@@ -1494,7 +1498,7 @@ int test_plist_add_pvar(void)
 	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 0.");
 	result = plist_contains(list, &string);
 	ASSERT_TRUE(result == true, "Expected result == true at index 0.");
-	pvar_destroy_internal(&string);
+	pvar_destroy(&string);
 	
 	/* Index 1 */
 	plist_add_pvar(list, &integer);
@@ -1527,6 +1531,3025 @@ int test_plist_add_pvar(void)
 	TEST_END();
 }
 
+/* ------------------------------------------------------------- */
+/* Test 27: pdict growth, pdict_reserve(), pdict_shrink_to_fit() */
+/* ------------------------------------------------------------- */
+int test_pdict_resize(void)
+{
+	pdict_t *dict = pdict_create(1);
+	char key[32];
+	int value;
+	
+	/* Index 0 */
+	/* Every key must stay reachable while buckets migrate between tables */
+	for (int i = 0; i < 5000; i++) {
+		snprintf(key, sizeof(key), "key%d", i);
+		pdict_add_int(dict, key, i);
+		ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 0.");
+	}
+	ASSERT_TRUE(pdict_get_size(dict) == 5000, "Expected size == 5000 at index 0.");
+	ASSERT_TRUE(pdict_get_capacity(dict) >= 4096, "Expected the dict to have grown at index 0.");
+	ASSERT_TRUE((double)dict->count <= (double)dict->capacity * pdict_get_max_load_factor(dict), "Expected load factor to be respected at index 0.");
+	for (int i = 0; i < 5000; i++) {
+		snprintf(key, sizeof(key), "key%d", i);
+		ASSERT_TRUE(pdict_get_int(dict, key, &value) && value == i, "Expected every key to be found at index 0.");
+	}
+	
+	/* Index 1 */
+	for (int i = 0; i < 5000; i += 2) {
+		snprintf(key, sizeof(key), "key%d", i);
+		pdict_remove(dict, key);
+		ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 1.");
+	}
+	pdict_shrink_to_fit(dict);
+	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 1.");
+	ASSERT_TRUE(dict->old_buckets == NULL, "Expected no rehash in progress at index 1.");
+	ASSERT_TRUE(pdict_get_capacity(dict) == 4096, "Expected capacity == 4096 at index 1.");
+	for (int i = 1; i < 5000; i += 2) {
+		snprintf(key, sizeof(key), "key%d", i);
+		ASSERT_TRUE(pdict_get_int(dict, key, &value) && value == i, "Expected odd keys to be found at index 1.");
+	}
+	ASSERT_TRUE(!pdict_contains(dict, "key0"), "Expected key0 to be removed at index 1.");
+	
+	/* Index 2 */
+	pdict_set_max_load_factor(dict, 2.0);
+	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 2.");
+	pdict_reserve(dict, 100000);
+	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 2.");
+	ASSERT_TRUE(pdict_get_capacity(dict) == 65536, "Expected capacity == 65536 at index 2.");
+	ASSERT_TRUE(pdict_get_int(dict, "key4999", &value) && value == 4999, "Expected key4999 to be found at index 2.");
+	
+	/* Index 3 */
+	pdict_t *copy = pdict_copy(dict);
+	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 3.");
+	ASSERT_TRUE(pdict_get_size(copy) == 2500, "Expected size == 2500 at index 3.");
+	ASSERT_TRUE(pdict_get_max_load_factor(copy) == 2.0, "Expected the copy to keep the load factor at index 3.");
+	pdict_destroy(copy);
+	
+	/* Index 4 */
+	pdict_set_max_load_factor(dict, 0.0);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_SET_MAX_LOAD_FACTOR_OUT_OF_BOUNDS, "Expected FAILURE_PDICT_SET_MAX_LOAD_FACTOR_OUT_OF_BOUNDS at index 4.");
+	pdict_reserve(NULL, 10);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_RESERVE_NULL_INPUT, "Expected FAILURE_PDICT_RESERVE_NULL_INPUT at index 4.");
+	pdict_shrink_to_fit(NULL);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_SHRINK_TO_FIT_NULL_INPUT, "Expected FAILURE_PDICT_SHRINK_TO_FIT_NULL_INPUT at index 4.");
+	
+	pdict_destroy(dict);
+	
+	TEST_END();
+}
+
+/* --------------------------- */
+/* Test 28: pdict flat backend */
+/* --------------------------- */
+int test_pdict_flat_backend(void)
+{
+	pdict_t *dict = pdict_create_with_backend(1, PDICT_BACKEND_FLAT);
+	char key[32];
+	int value;
+	char *str;
+	
+	/* Index 0 */
+	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 0.");
+	ASSERT_TRUE(pdict_get_backend(dict) == PDICT_BACKEND_FLAT, "Expected PDICT_BACKEND_FLAT at index 0.");
+	ASSERT_TRUE(pdict_get_capacity(dict) == PDICT_GROUP_WIDTH, "Expected capacity == PDICT_GROUP_WIDTH at index 0.");
+	
+	/* Index 1 */
+	/* Grow through several resizes and check every key after each batch */
+	for (int i = 0; i < 5000; i++) {
+		snprintf(key, sizeof(key), "key%d", i);
+		pdict_add_int(dict, key, i);
+		ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 1.");
+	}
+	pdict_add_int(dict, "key42", 0);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_ADD_INT_KEY_EXISTS, "Expected FAILURE_PDICT_ADD_INT_KEY_EXISTS at index 1.");
+	ASSERT_TRUE(pdict_get_size(dict) == 5000, "Expected size == 5000 at index 1.");
+	ASSERT_TRUE((pdict_get_capacity(dict) & (pdict_get_capacity(dict) - 1)) == 0, "Expected a power of two capacity at index 1.");
+	ASSERT_TRUE((double)dict->count <= (double)dict->capacity * PDICT_FLAT_MAX_LOAD_FACTOR, "Expected load factor to be respected at index 1.");
+	for (int i = 0; i < 5000; i++) {
+		snprintf(key, sizeof(key), "key%d", i);
+		ASSERT_TRUE(pdict_get_int(dict, key, &value) && value == i, "Expected every key to be found at index 1.");
+	}
+	ASSERT_TRUE(!pdict_contains(dict, "key5000"), "Expected key5000 to be missing at index 1.");
+	
+	/* Index 2 */
+	/* Tombstones must not break probing or leak capacity */
+	for (int round = 0; round < 4; round++) {
+		for (int i = 0; i < 5000; i += 2) {
+			snprintf(key, sizeof(key), "key%d", i);
+			pdict_remove(dict, key);
+			ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 2.");
+		}
+		for (int i = 0; i < 5000; i += 2) {
+			snprintf(key, sizeof(key), "key%d", i);
+			pdict_add_int(dict, key, i + round);
+			ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 2.");
+		}
+	}
+	ASSERT_TRUE(pdict_get_size(dict) == 5000, "Expected size == 5000 at index 2.");
+	ASSERT_TRUE(pdict_get_capacity(dict) <= 8192, "Expected no growth from tombstones at index 2.");
+	/* Churn over distinct keys leaves tombstones no later insert reuses */
+	pdict_t *churn = pdict_create_with_backend(16, PDICT_BACKEND_FLAT);
+	for (int i = 0; i < 100000; i++) {
+		snprintf(key, sizeof(key), "k%d", i);
+		pdict_add_int(churn, key, i);
+		ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 2.");
+		pdict_remove(churn, key);
+		ASSERT_TRUE(pvars_errno == SUCCESS && pdict_get_size(churn) == 0, "Expected an empty dict at index 2.");
+	}
+	pdict_add_int(churn, "last", 1);
+	ASSERT_TRUE(pdict_get_int(churn, "last", &value) && value == 1, "Expected last == 1 at index 2.");
+	ASSERT_TRUE(pdict_get_capacity(churn) <= 2 * PDICT_GROUP_WIDTH, "Expected no growth from churn at index 2.");
+	pdict_destroy(churn);
+	ASSERT_TRUE(pdict_get_int(dict, "key10", &value) && value == 13, "Expected key10 == 13 at index 2.");
+	ASSERT_TRUE(pdict_get_int(dict, "key11", &value) && value == 11, "Expected key11 == 11 at index 2.");
+	pdict_remove(dict, "missing");
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_REMOVE_KEY_NOT_FOUND, "Expected FAILURE_PDICT_REMOVE_KEY_NOT_FOUND at index 2.");
+	
+	/* Index 3 */
+	pdict_set_str(dict, "key7", "seven");
+	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 3.");
+	ASSERT_TRUE(pdict_get_type(dict, "key7") == PVAR_TYPE_STRING, "Expected PVAR_TYPE_STRING at index 3.");
+	pdict_t *copy = pdict_copy(dict);
+	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 3.");
+	ASSERT_TRUE(pdict_get_backend(copy) == PDICT_BACKEND_FLAT, "Expected the copy to keep the backend at index 3.");
+	ASSERT_TRUE(pdict_get_size(copy) == 5000, "Expected size == 5000 at index 3.");
+	ASSERT_TRUE(pdict_get_str(copy, "key7", &str) && strcmp(str, "seven") == 0, "Expected key7 == seven at index 3.");
+	free(str);
+	plist_t *keys = pdict_get_keys(copy);
+	ASSERT_TRUE(plist_get_size(keys) == 5000, "Expected 5000 keys at index 3.");
+	plist_destroy(keys);
+	pdict_destroy(copy);
+	
+	/* Index 4 */
+	for (int i = 0; i < 5000; i++) {
+		snprintf(key, sizeof(key), "key%d", i);
+		pdict_remove(dict, key);
+	}
+	pdict_shrink_to_fit(dict);
+	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 4.");
+	ASSERT_TRUE(pdict_get_capacity(dict) == PDICT_GROUP_WIDTH, "Expected capacity == PDICT_GROUP_WIDTH at index 4.");
+	pdict_reserve(dict, 1000);
+	ASSERT_TRUE(pdict_get_capacity(dict) == 2048, "Expected capacity == 2048 at index 4.");
+	pdict_add_str(dict, "a", "b");
+	pdict_empty(dict);
+	ASSERT_TRUE(pdict_get_size(dict) == 0 && !pdict_contains(dict, "a"), "Expected an empty dict at index 4.");
+	pdict_destroy(dict);
+	
+	/* Index 5 */
+	pdict_set_default_backend(PDICT_BACKEND_FLAT);
+	dict = pdict_create(10);
+	ASSERT_TRUE(pdict_get_backend(dict) == PDICT_BACKEND_FLAT, "Expected PDICT_BACKEND_FLAT by default at index 5.");
+	pdict_destroy(dict);
+	pdict_set_default_backend(PDICT_BACKEND_CHAINED);
+	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 5.");
+	pdict_set_default_backend((pdict_backend)42);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_SET_DEFAULT_BACKEND_UNKNOWN_BACKEND, "Expected FAILURE_PDICT_SET_DEFAULT_BACKEND_UNKNOWN_BACKEND at index 5.");
+	ASSERT_TRUE(pdict_create_with_backend(10, (pdict_backend)42) == NULL, "Expected NULL at index 5.");
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_CREATE_UNKNOWN_BACKEND, "Expected FAILURE_PDICT_CREATE_UNKNOWN_BACKEND at index 5.");
+	pdict_get_backend(NULL);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_GET_BACKEND_NULL_INPUT, "Expected FAILURE_PDICT_GET_BACKEND_NULL_INPUT at index 5.");
+	
+	TEST_END();
+}
+
+/* ------------------------------------ */
+/* Test 29: pdict cached hashes/lengths */
+/* ------------------------------------ */
+int test_pdict_cached_hash(void)
+{
+	/* One bucket: every lookup walks a chain of long shared-prefix keys */
+	pdict_t *dict = pdict_create(1);
+	char key[64];
+	int value;
+	
+	/* Index 0 */
+	pdict_set_max_load_factor(dict, 1000.0);
+	for (int i = 0; i < 200; i++) {
+		snprintf(key, sizeof(key), "metrics.host.cpu.core%d.user", i);
+		pdict_add_int(dict, key, i);
+		ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 0.");
+	}
+	ASSERT_TRUE(pdict_get_capacity(dict) == 1, "Expected a single bucket at index 0.");
+	for (int i = 0; i < 200; i++) {
+		snprintf(key, sizeof(key), "metrics.host.cpu.core%d.user", i);
+		ASSERT_TRUE(pdict_get_int(dict, key, &value) && value == i, "Expected every key to be found at index 0.");
+	}
+	ASSERT_TRUE(!pdict_contains(dict, "metrics.host.cpu.core1.use"), "Expected a prefix not to match at index 0.");
+	ASSERT_TRUE(!pdict_contains(dict, "metrics.host.cpu.core1.users"), "Expected a longer key not to match at index 0.");
+	
+	/* Index 1 */
+	pdict_entry_t *entry = dict->buckets[0];
+	while (entry != NULL) {
+		ASSERT_TRUE(pstr_len(entry->key) == strlen(entry->key), "Expected the stored key length at index 1.");
+		ASSERT_TRUE(entry->hash == pdict_hash_key(dict, entry->key, pstr_len(entry->key)), "Expected the cached hash at index 1.");
+		entry = entry->next;
+	}
+	
+	/* Index 2 */
+	/* Migration reuses the cached hashes */
+	pdict_set_max_load_factor(dict, 1.0);
+	pdict_reserve(dict, 200);
+	ASSERT_TRUE(pdict_get_capacity(dict) == 256, "Expected capacity == 256 at index 2.");
+	pdict_t *copy = pdict_copy(dict);
+	ASSERT_TRUE(copy->buckets[0] == NULL || (copy->buckets[0]->hash & 255) == 0, "Expected entries in their hashed bucket at index 2.");
+	for (int i = 0; i < 200; i++) {
+		snprintf(key, sizeof(key), "metrics.host.cpu.core%d.user", i);
+		ASSERT_TRUE(pdict_get_int(copy, key, &value) && value == i, "Expected every key to be found at index 2.");
+	}
+	pdict_destroy(copy);
+	pdict_destroy(dict);
+	
+	/* Index 3 */
+	dict = pdict_create_with_backend(1, PDICT_BACKEND_FLAT);
+	pdict_add_int(dict, "metrics.host.cpu.core17.user", 17);
+	pdict_add_int(dict, "", 0);
+	ASSERT_TRUE(pdict_get_int(dict, "", &value) && value == 0, "Expected the empty key to be found at index 3.");
+	for (size_t i = 0; i < dict->capacity; i++) {
+		if (pdict_flat_is_full(dict, i)) {
+			ASSERT_TRUE(pstr_len(dict->slots[i].key) == strlen(dict->slots[i].key), "Expected the stored key length at index 3.");
+		}
+	}
+	pdict_remove(dict, "metrics.host.cpu.core17.user");
+	ASSERT_TRUE(pvars_errno == SUCCESS && pdict_get_size(dict) == 1, "Expected size == 1 at index 3.");
+	pdict_destroy(dict);
+	
+	TEST_END();
+}
+
+/* ---------------------------------------------------------- */
+/* Test 30: pdict hash functions, seeds, power of two buckets */
+/* ---------------------------------------------------------- */
+int test_pdict_hash_function(void)
+{
+	pdict_t *dicts[2];
+	char key[80];
+	int value;
+	
+	/* Index 0 */
+	dicts[0] = pdict_create(10);
+	dicts[1] = pdict_create_with_backend(10, PDICT_BACKEND_FLAT);
+	ASSERT_TRUE(pdict_get_capacity(dicts[0]) == 16, "Expected capacity == 16 at index 0.");
+	ASSERT_TRUE(pdict_get_hash_function(dicts[0]) == PDICT_HASH_WYHASH, "Expected PDICT_HASH_WYHASH at index 0.");
+	ASSERT_TRUE(dicts[0]->seed != dicts[1]->seed, "Expected distinct seeds at index 0.");
+	
+	for (int d = 0; d < 2; d++) {
+		pdict_t *dict = dicts[d];
+		
+		/* Index 1 */
+		/* Keys of every length up to 64 exercise each branch of the word hash */
+		for (int i = 0; i < 1000; i++) {
+			snprintf(key, sizeof(key), "%.*s%d", i % 60, "metrics.host.cpu.core.user.system.idle.iowait.irq.softirq.steal", i);
+			pdict_add_int(dict, key, i);
+			ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 1.");
+		}
+		ASSERT_TRUE((pdict_get_capacity(dict) & (pdict_get_capacity(dict) - 1)) == 0, "Expected a power of two capacity at index 1.");
+		
+		/* Index 2 */
+		pdict_set_hash_function(dict, PDICT_HASH_DJB2);
+		ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 2.");
+		ASSERT_TRUE(pdict_get_hash_function(dict) == PDICT_HASH_DJB2, "Expected PDICT_HASH_DJB2 at index 2.");
+		pdict_set_hash_seed(dict, 42);
+		ASSERT_TRUE(pvars_errno == SUCCESS && dict->seed == 42, "Expected seed == 42 at index 2.");
+		for (int i = 0; i < 1000; i++) {
+			snprintf(key, sizeof(key), "%.*s%d", i % 60, "metrics.host.cpu.core.user.system.idle.iowait.irq.softirq.steal", i);
+			ASSERT_TRUE(pdict_get_int(dict, key, &value) && value == i, "Expected every key to be found at index 2.");
+		}
+		
+		/* Index 3 */
+		pdict_t *copy = pdict_copy(dict);
+		ASSERT_TRUE(pdict_get_hash_function(copy) == PDICT_HASH_DJB2 && copy->seed == 42, "Expected the copy to keep the hash at index 3.");
+		pdict_set_hash_function(copy, PDICT_HASH_WYHASH);
+		pdict_remove(copy, "0");
+		ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pvars_errno == SUCCESS at index 3.");
+		for (int i = 1; i < 1000; i++) {
+			snprintf(key, sizeof(key), "%.*s%d", i % 60, "metrics.host.cpu.core.user.system.idle.iowait.irq.softirq.steal", i);
+			ASSERT_TRUE(pdict_get_int(copy, key, &value) && value == i, "Expected every key to be found at index 3.");
+		}
+		pdict_destroy(copy);
+		pdict_destroy(dict);
+	}
+	
+	/* Index 4 */
+	/* Every prefix of a long key must hash differently */
+	const char *text = "The quick brown fox jumps over the lazy dog, then naps in the sun.";
+	for (size_t i = 0; i < strlen(text); i++) {
+		ASSERT_TRUE(phash_wyhash(text, i, 7) == phash_wyhash(text, i, 7), "Expected a stable hash at index 4.");
+		ASSERT_TRUE(phash_wyhash(text, i, 7) != phash_wyhash(text, i, 8), "Expected the seed to change the hash at index 4.");
+		for (size_t j = 0; j < i; j++) {
+			ASSERT_TRUE(phash_wyhash(text, i, 7) != phash_wyhash(text, j, 7), "Expected distinct prefix hashes at index 4.");
+		}
+	}
+	
+	/* Index 5 */
+	pdict_set_hash_function(NULL, PDICT_HASH_DJB2);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_SET_HASH_FUNCTION_NULL_INPUT, "Expected FAILURE_PDICT_SET_HASH_FUNCTION_NULL_INPUT at index 5.");
+	dicts[0] = pdict_create(1);
+	pdict_set_hash_function(dicts[0], (pdict_hash_function)42);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_SET_HASH_FUNCTION_UNKNOWN_FUNCTION, "Expected FAILURE_PDICT_SET_HASH_FUNCTION_UNKNOWN_FUNCTION at index 5.");
+	pdict_destroy(dicts[0]);
+	pdict_get_hash_function(NULL);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_GET_HASH_FUNCTION_NULL_INPUT, "Expected FAILURE_PDICT_GET_HASH_FUNCTION_NULL_INPUT at index 5.");
+	pdict_set_hash_seed(NULL, 1);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_SET_HASH_SEED_NULL_INPUT, "Expected FAILURE_PDICT_SET_HASH_SEED_NULL_INPUT at index 5.");
+	
+	TEST_END();
+}
+
+/* ---------------------------------------------- */
+/* Test 31: plist_borrow_*() and pdict_borrow_*() */
+/* ---------------------------------------------- */
+int test_borrow_accessors(void)
+{
+	plist_t *list = plist_create(4);
+	pdict_t *dict = pdict_create(4);
+	plist_t *inner_list = plist_create(1);
+	pdict_t *inner_dict = pdict_create(1);
+	const char *str;
+	const plist_t *borrowed_list;
+	const pdict_t *borrowed_dict;
+	
+	plist_add_int(inner_list, 7);
+	pdict_add_int(inner_dict, "seven", 7);
+	
+	plist_add_str(list, "hello");
+	plist_add_list(list, inner_list);
+	plist_add_dict(list, inner_dict);
+	plist_add_int(list, 1);
+	
+	pdict_add_str(dict, "greeting", "hello");
+	pdict_add_list(dict, "list", inner_list);
+	pdict_add_dict(dict, "dict", inner_dict);
+	pdict_add_int(dict, "one", 1);
+	
+	/* Index 0 */
+	/* Borrowed pointers are the container's own storage */
+	ASSERT_TRUE(plist_borrow_str(list, 0, &str), "Expected plist_borrow_str to succeed at index 0.");
+	ASSERT_TRUE(str == pvar_str(&list->elements[0]) && strcmp(str, "hello") == 0, "Expected the stored string at index 0.");
+	ASSERT_TRUE(plist_borrow_list(list, 1, &borrowed_list), "Expected plist_borrow_list to succeed at index 0.");
+	ASSERT_TRUE(borrowed_list == list->elements[1].data.ls && plist_get_size(borrowed_list) == 1, "Expected the stored list at index 0.");
+	ASSERT_TRUE(plist_borrow_dict(list, 2, &borrowed_dict), "Expected plist_borrow_dict to succeed at index 0.");
+	ASSERT_TRUE(borrowed_dict == list->elements[2].data.dt && pdict_contains(borrowed_dict, "seven"), "Expected the stored dict at index 0.");
+	
+	/* Index 1 */
+	ASSERT_TRUE(pdict_borrow_str(dict, "greeting", &str) && strcmp(str, "hello") == 0, "Expected pdict_borrow_str to succeed at index 1.");
+	ASSERT_TRUE(pdict_borrow_list(dict, "list", &borrowed_list) && plist_get_size(borrowed_list) == 1, "Expected pdict_borrow_list to succeed at index 1.");
+	ASSERT_TRUE(borrowed_list != inner_list, "Expected the dict's own copy at index 1.");
+	ASSERT_TRUE(pdict_borrow_dict(dict, "dict", &borrowed_dict) && pdict_contains(borrowed_dict, "seven"), "Expected pdict_borrow_dict to succeed at index 1.");
+	
+	/* Index 2 */
+	/* Nested reads need no allocation at any level */
+	int value;
+	ASSERT_TRUE(pdict_borrow_dict(dict, "dict", &borrowed_dict), "Expected pdict_borrow_dict to succeed at index 2.");
+	ASSERT_TRUE(pdict_get_int(borrowed_dict, "seven", &value) && value == 7, "Expected the nested value at index 2.");
+	
+	/* Index 3 */
+	ASSERT_TRUE(!plist_borrow_str(list, 3, &str), "Expected plist_borrow_str to fail at index 3.");
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_BORROW_STR_WRONG_TYPE, "Expected FAILURE_PLIST_BORROW_STR_WRONG_TYPE at index 3.");
+	ASSERT_TRUE(!plist_borrow_list(list, 4, &borrowed_list), "Expected plist_borrow_list to fail at index 3.");
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_BORROW_LIST_OUT_OF_BOUNDS, "Expected FAILURE_PLIST_BORROW_LIST_OUT_OF_BOUNDS at index 3.");
+	ASSERT_TRUE(!plist_borrow_dict(NULL, 0, &borrowed_dict), "Expected plist_borrow_dict to fail at index 3.");
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_BORROW_DICT_NULL_INPUT, "Expected FAILURE_PLIST_BORROW_DICT_NULL_INPUT at index 3.");
+	ASSERT_TRUE(!plist_borrow_dict(list, 2, NULL), "Expected plist_borrow_dict to fail at index 3.");
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_BORROW_DICT_NULL_INPUT_OUT_VALUE, "Expected FAILURE_PLIST_BORROW_DICT_NULL_INPUT_OUT_VALUE at index 3.");
+	
+	/* Index 4 */
+	ASSERT_TRUE(!pdict_borrow_str(dict, "one", &str) && str == NULL, "Expected pdict_borrow_str to fail at index 4.");
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_BORROW_STR_WRONG_TYPE, "Expected FAILURE_PDICT_BORROW_STR_WRONG_TYPE at index 4.");
+	ASSERT_TRUE(!pdict_borrow_list(dict, "missing", &borrowed_list) && borrowed_list == NULL, "Expected pdict_borrow_list to fail at index 4.");
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_BORROW_LIST_KEY_NOT_FOUND, "Expected FAILURE_PDICT_BORROW_LIST_KEY_NOT_FOUND at index 4.");
+	ASSERT_TRUE(!pdict_borrow_dict(dict, NULL, &borrowed_dict), "Expected pdict_borrow_dict to fail at index 4.");
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_BORROW_DICT_NULL_INPUT_KEY, "Expected FAILURE_PDICT_BORROW_DICT_NULL_INPUT_KEY at index 4.");
+	ASSERT_TRUE(!pdict_borrow_dict(NULL, "dict", &borrowed_dict), "Expected pdict_borrow_dict to fail at index 4.");
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_BORROW_DICT_NULL_INPUT_DICT, "Expected FAILURE_PDICT_BORROW_DICT_NULL_INPUT_DICT at index 4.");
+	
+	plist_destroy(inner_list);
+	pdict_destroy(inner_dict);
+	plist_destroy(list);
+	pdict_destroy(dict);
+	
+	TEST_END();
+}
+
+
+/* --------------------------------------------- */
+/* Test 32: *_take() and *_pop() ownership moves */
+/* --------------------------------------------- */
+int test_take_pop(void)
+{
+	plist_t *list = plist_create(2);
+	pdict_t *dict = pdict_create(2);
+	pdict_t *flat = pdict_create_with_backend(2, PDICT_BACKEND_FLAT);
+	plist_t *inner_list = plist_create(1);
+	pdict_t *inner_dict = pdict_create(1);
+	pvar_t popped;
+	
+	plist_add_int(inner_list, 7);
+	pdict_add_int(inner_dict, "seven", 7);
+	
+	/* Index 0 */
+	/* The list stores the given pointers, not copies */
+	plist_add_list_take(list, inner_list);
+	ASSERT_TRUE(list->elements[0].data.ls == inner_list && list->elements[0].type == PVAR_TYPE_LIST, "Expected the taken list at index 0.");
+	plist_add_dict_take(list, inner_dict);
+	ASSERT_TRUE(list->elements[1].data.dt == inner_dict && list->elements[1].type == PVAR_TYPE_DICT, "Expected the taken dict at index 0.");
+	
+	/* Index 1 */
+	/* Popping hands the same pointers back and shifts the rest down */
+	ASSERT_TRUE(plist_pop(list, 0, &popped), "Expected plist_pop to succeed at index 1.");
+	ASSERT_TRUE(popped.type == PVAR_TYPE_LIST && popped.data.ls == inner_list, "Expected the original list at index 1.");
+	ASSERT_TRUE(plist_get_size(list) == 1 && list->elements[0].data.dt == inner_dict, "Expected the dict to shift down at index 1.");
+	ASSERT_TRUE(plist_pop(list, 0, &popped) && popped.data.dt == inner_dict, "Expected the original dict at index 1.");
+	ASSERT_TRUE(plist_get_size(list) == 0, "Expected an empty list at index 1.");
+	
+	/* Index 2 */
+	plist_add_int(list, 1);
+	plist_set_list_take(list, 0, inner_list);
+	ASSERT_TRUE(list->elements[0].type == PVAR_TYPE_LIST && list->elements[0].data.ls == inner_list, "Expected plist_set_list_take to store the pointer at index 2.");
+	plist_set_dict_take(list, 0, inner_dict);
+	ASSERT_TRUE(list->elements[0].type == PVAR_TYPE_DICT && list->elements[0].data.dt == inner_dict, "Expected plist_set_dict_take to store the pointer at index 2.");
+	/* inner_list was freed by the set above, the list now owns inner_dict */
+	inner_list = NULL;
+	
+	/* Index 3 */
+	/* Both dict backends move values in and out */
+	pdict_t *dicts[] = { dict, flat };
+	for (size_t i = 0; i < 2; i++) {
+		plist_t *owned_list = plist_create(1);
+		pdict_t *owned_dict = pdict_create(1);
+		
+		pdict_add_list_take(dicts[i], "list", owned_list);
+		ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pdict_add_list_take to succeed at index 3.");
+		pdict_add_dict_take(dicts[i], "dict", owned_dict);
+		ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pdict_add_dict_take to succeed at index 3.");
+		
+		const plist_t *borrowed_list;
+		ASSERT_TRUE(pdict_borrow_list(dicts[i], "list", &borrowed_list) && borrowed_list == owned_list, "Expected the taken list at index 3.");
+		
+		ASSERT_TRUE(pdict_pop(dicts[i], "dict", &popped), "Expected pdict_pop to succeed at index 3.");
+		ASSERT_TRUE(popped.type == PVAR_TYPE_DICT && popped.data.dt == owned_dict, "Expected the original dict at index 3.");
+		ASSERT_TRUE(!pdict_contains(dicts[i], "dict") && pdict_get_size(dicts[i]) == 1, "Expected the key to be gone at index 3.");
+		
+		pdict_set_dict_take(dicts[i], "list", owned_dict);
+		ASSERT_TRUE(pvars_errno == SUCCESS, "Expected pdict_set_dict_take to succeed at index 3.");
+		
+		plist_t *replacement = plist_create(1);
+		pdict_add_int(dicts[i], "n", 1);
+		pdict_set_list_take(dicts[i], "n", replacement);
+		ASSERT_TRUE(pdict_borrow_list(dicts[i], "n", &borrowed_list) && borrowed_list == replacement, "Expected pdict_set_list_take to store the pointer at index 3.");
+		
+		ASSERT_TRUE(pdict_pop(dicts[i], "n", &popped) && popped.data.ls == replacement, "Expected the replacement list at index 3.");
+		pvar_destroy(&popped);
+		ASSERT_TRUE(popped.type == PVAR_TYPE_NONE, "Expected pvar_destroy to reset the value at index 3.");
+	}
+	
+	/* Index 4 */
+	/* On failure the caller keeps ownership */
+	plist_t *kept = plist_create(1);
+	pdict_add_list_take(dict, "list", kept);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_ADD_LIST_TAKE_KEY_EXISTS, "Expected FAILURE_PDICT_ADD_LIST_TAKE_KEY_EXISTS at index 4.");
+	pdict_set_list_take(dict, "missing", kept);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_SET_LIST_TAKE_VALUE_NOT_FOUND, "Expected FAILURE_PDICT_SET_LIST_TAKE_VALUE_NOT_FOUND at index 4.");
+	plist_set_list_take(list, 5, kept);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_SET_LIST_TAKE_OUT_OF_BOUNDS, "Expected FAILURE_PLIST_SET_LIST_TAKE_OUT_OF_BOUNDS at index 4.");
+	plist_destroy(kept);
+	
+	/* Index 5 */
+	plist_add_list_take(list, list);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_ADD_LIST_TAKE_SELF_INSERT, "Expected FAILURE_PLIST_ADD_LIST_TAKE_SELF_INSERT at index 5.");
+	pdict_add_dict_take(dict, "self", dict);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_ADD_DICT_TAKE_SELF_INSERT, "Expected FAILURE_PDICT_ADD_DICT_TAKE_SELF_INSERT at index 5.");
+	plist_add_dict_take(list, NULL);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_ADD_DICT_TAKE_NULL_DICT_INPUT, "Expected FAILURE_PLIST_ADD_DICT_TAKE_NULL_DICT_INPUT at index 5.");
+	ASSERT_TRUE(!plist_pop(list, 1, &popped), "Expected plist_pop to fail at index 5.");
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_POP_OUT_OF_BOUNDS, "Expected FAILURE_PLIST_POP_OUT_OF_BOUNDS at index 5.");
+	ASSERT_TRUE(!plist_pop(list, 0, NULL), "Expected plist_pop to fail at index 5.");
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_POP_NULL_INPUT_OUT_VALUE, "Expected FAILURE_PLIST_POP_NULL_INPUT_OUT_VALUE at index 5.");
+	ASSERT_TRUE(!pdict_pop(dict, "missing", &popped), "Expected pdict_pop to fail at index 5.");
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_POP_KEY_NOT_FOUND, "Expected FAILURE_PDICT_POP_KEY_NOT_FOUND at index 5.");
+	ASSERT_TRUE(!pdict_pop(NULL, "list", &popped), "Expected pdict_pop to fail at index 5.");
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_POP_NULL_INPUT_DICT, "Expected FAILURE_PDICT_POP_NULL_INPUT_DICT at index 5.");
+	
+	plist_destroy(list);
+	pdict_destroy(dict);
+	pdict_destroy(flat);
+	
+	TEST_END();
+}
+
+
+/* ------------------------------------------------------------ */
+/* Test 33: pvars_arena_t, plist_create_in(), pdict_create_in() */
+/* ------------------------------------------------------------ */
+int test_arena(void)
+{
+	pvars_arena_t *arena = pvars_arena_create(4096);
+	ASSERT_TRUE(arena != NULL && pvars_errno == SUCCESS, "Expected pvars_arena_create to succeed.");
+	ASSERT_TRUE(pvars_arena_get_used(arena) == 0 && pvars_arena_get_chunk_count(arena) == 0, "Expected an arena to start empty.");
+	
+	/* Index 0 */
+	/* A growing list that is the latest allocation is extended in place */
+	plist_t *list = plist_create_in(arena, 1);
+	ASSERT_TRUE(list != NULL && list->allocator->ctx == arena, "Expected plist_create_in to succeed at index 0.");
+	pvar_t *first_elements = list->elements;
+	for (int i = 0; i < 64; i++) {
+		plist_add_int(list, i);
+	}
+	ASSERT_TRUE(list->elements == first_elements && plist_get_size(list) == 64, "Expected the elements to grow in place at index 0.");
+	ASSERT_TRUE(pvars_arena_get_chunk_count(arena) == 1, "Expected a single chunk at index 0.");
+	
+	/* Index 1 */
+	/* Strings, copies and nested containers all come from the arena */
+	pdict_set_default_backend(PDICT_BACKEND_FLAT);
+	pdict_t *flat = pdict_create_in(arena, 4);
+	pdict_set_default_backend(PDICT_BACKEND_CHAINED);
+	pdict_t *dict = pdict_create_in(arena, 2);
+	ASSERT_TRUE(flat != NULL && dict != NULL && flat->backend == PDICT_BACKEND_FLAT, "Expected pdict_create_in to succeed at index 1.");
+	
+	char key[32];
+	for (int i = 0; i < 200; i++) {
+		snprintf(key, sizeof(key), "key%d", i);
+		pdict_add_str(dict, key, "value");
+		pdict_add_int(flat, key, i);
+	}
+	ASSERT_TRUE(pdict_get_size(dict) == 200 && pdict_get_size(flat) == 200, "Expected both dicts to grow at index 1.");
+	ASSERT_TRUE(pvars_arena_get_chunk_count(arena) > 1, "Expected more chunks at index 1.");
+	
+	plist_t *heap_list = plist_create(1);
+	plist_add_str(heap_list, "copied");
+	pdict_add_list(dict, "list", heap_list);
+	pdict_add_dict_take(dict, "flat", flat);
+	plist_add_dict(list, dict);
+	plist_destroy(heap_list);
+	
+	const plist_t *borrowed_list;
+	ASSERT_TRUE(pdict_borrow_list(dict, "list", &borrowed_list) && borrowed_list->allocator->ctx == arena, "Expected the copy to live in the arena at index 1.");
+	ASSERT_TRUE(list->elements[64].data.dt->allocator->ctx == arena, "Expected the copied dict to live in the arena at index 1.");
+	ASSERT_TRUE(pdict_borrow_list(list->elements[64].data.dt, "list", &borrowed_list) && borrowed_list->allocator->ctx == arena, "Expected nested copies to live in the arena at index 1.");
+	
+	/* Index 2 */
+	/* Values returned to the caller are heap allocated */
+	char *str = NULL;
+	ASSERT_TRUE(pdict_get_str(dict, "key7", &str) && strcmp(str, "value") == 0, "Expected pdict_get_str to succeed at index 2.");
+	free(str);
+	pvar_t popped;
+	ASSERT_TRUE(pdict_pop(dict, "key8", &popped) && popped.type == PVAR_TYPE_STRING && strcmp(popped.data.s, "value") == 0, "Expected pdict_pop to succeed at index 2.");
+	pvar_destroy(&popped);
+	ASSERT_TRUE(plist_pop(list, 64, &popped) && popped.data.dt->allocator->ctx == arena, "Expected plist_pop to succeed at index 2.");
+	pvar_destroy(&popped);
+	plist_t *keys = pdict_get_keys(dict);
+	ASSERT_TRUE(keys != NULL && keys->allocator == pvars_get_allocator(), "Expected pdict_get_keys to return a heap list at index 2.");
+	plist_destroy(keys);
+	
+	/* Index 3 */
+	/* Containers with different allocators cannot be moved into each other */
+	plist_t *other = plist_create(1);
+	plist_add_list_take(list, other);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_ADD_LIST_TAKE_ALLOCATOR_MISMATCH, "Expected FAILURE_PLIST_ADD_LIST_TAKE_ALLOCATOR_MISMATCH at index 3.");
+	pdict_set_list_take(dict, "key9", other);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_SET_LIST_TAKE_ALLOCATOR_MISMATCH, "Expected FAILURE_PDICT_SET_LIST_TAKE_ALLOCATOR_MISMATCH at index 3.");
+	plist_destroy(other);
+	
+	/* Index 4 */
+	/* Destroying an arena container leaves the memory to the arena */
+	size_t used = pvars_arena_get_used(arena);
+	pdict_destroy(dict);
+	plist_destroy(list);
+	ASSERT_TRUE(pvars_arena_get_used(arena) == used, "Expected destroy to be a no-op at index 4.");
+	
+	/* Index 5 */
+	/* A reset keeps one chunk and the arena can be reused */
+	pvars_arena_reset(arena);
+	ASSERT_TRUE(pvars_errno == SUCCESS && pvars_arena_get_chunk_count(arena) == 1 && pvars_arena_get_used(arena) == 0, "Expected pvars_arena_reset to succeed at index 5.");
+	list = plist_create_in(arena, 1000);
+	ASSERT_TRUE(list != NULL && pvars_arena_get_chunk_count(arena) == 2, "Expected an oversized chunk at index 5.");
+	plist_add_str(list, "after reset");
+	ASSERT_TRUE(plist_borrow_str(list, 0, (const char **)&str) && strcmp(str, "after reset") == 0, "Expected the arena to be reusable at index 5.");
+	
+	/* Index 6 */
+	pvars_arena_reset(NULL);
+	ASSERT_TRUE(pvars_errno == FAILURE_PVARS_ARENA_RESET_NULL_INPUT, "Expected FAILURE_PVARS_ARENA_RESET_NULL_INPUT at index 6.");
+	pvars_arena_get_used(NULL);
+	ASSERT_TRUE(pvars_errno == FAILURE_PVARS_ARENA_GET_USED_NULL_INPUT, "Expected FAILURE_PVARS_ARENA_GET_USED_NULL_INPUT at index 6.");
+	pvars_arena_get_chunk_count(NULL);
+	ASSERT_TRUE(pvars_errno == FAILURE_PVARS_ARENA_GET_CHUNK_COUNT_NULL_INPUT, "Expected FAILURE_PVARS_ARENA_GET_CHUNK_COUNT_NULL_INPUT at index 6.");
+	ASSERT_TRUE(plist_create_in(arena, 0) == NULL && pvars_errno == FAILURE_PLIST_CREATE_CAPACITY_OUT_OF_BOUNDS, "Expected FAILURE_PLIST_CREATE_CAPACITY_OUT_OF_BOUNDS at index 6.");
+	
+	pvars_arena_destroy(arena);
+	
+	TEST_END();
+}
+
+
+/* Counting allocator for Test 34. Each block carries its size so that the sizes passed back can be checked */
+typedef struct {
+	size_t live_bytes;
+	size_t allocations;
+	size_t releases;
+	size_t size_mismatches;
+} test_counts_t;
+
+#define TEST_HEADER 16
+
+static void *test_counting_alloc(size_t size, void *ctx)
+{
+	test_counts_t *counts = ctx;
+	unsigned char *block = malloc(size + TEST_HEADER);
+	if (block == NULL) {
+		return NULL;
+	}
+	memcpy(block, &size, sizeof(size));
+	counts->live_bytes += size;
+	counts->allocations++;
+	return block + TEST_HEADER;
+}
+
+static void test_counting_release(void *ptr, size_t size, void *ctx)
+{
+	test_counts_t *counts = ctx;
+	unsigned char *block = (unsigned char *)ptr - TEST_HEADER;
+	size_t stored;
+	memcpy(&stored, block, sizeof(stored));
+	if (stored != size) {
+		counts->size_mismatches++;
+	}
+	counts->live_bytes -= stored;
+	counts->releases++;
+	free(block);
+}
+
+static void *test_counting_resize(void *ptr, size_t old_size, size_t new_size, void *ctx)
+{
+	void *moved = test_counting_alloc(new_size, ctx);
+	if (moved != NULL && ptr != NULL) {
+		memcpy(moved, ptr, old_size < new_size ? old_size : new_size);
+		test_counting_release(ptr, old_size, ctx);
+	}
+	return moved;
+}
+
+/* ------------------------------------------------------------------- */
+/* Test 34: pvars_set_allocator(), plist/pdict_create_with_allocator() */
+/* ------------------------------------------------------------------- */
+int test_allocator(void)
+{
+	test_counts_t counts = { 0, 0, 0, 0 };
+	pvars_allocator_t counting = { test_counting_alloc, test_counting_resize, test_counting_release, &counts };
+	const pvars_allocator_t *libc = pvars_get_allocator();
+	
+	/* Index 0 */
+	/* A per-container allocator sees every allocation of the tree, with matching sizes */
+	plist_t *list = plist_create_with_allocator(&counting, 1);
+	pdict_t *dict = pdict_create_with_allocator(&counting, 2);
+	pdict_t *flat = pdict_create_with_backend(2, PDICT_BACKEND_FLAT);
+	ASSERT_TRUE(list != NULL && dict != NULL && counts.allocations == 4, "Expected both containers to use the allocator at index 0.");
+	ASSERT_TRUE(flat->allocator == libc, "Expected other containers to keep the default allocator at index 0.");
+	
+	char key[32];
+	for (int i = 0; i < 100; i++) {
+		snprintf(key, sizeof(key), "key%d", i);
+		plist_add_str(list, key);
+		pdict_add_str(dict, key, key);
+		pdict_add_int(flat, key, i);
+	}
+	plist_add_dict(list, flat);
+	pdict_add_list(dict, "list", list);
+	ASSERT_TRUE(list->elements[100].data.dt->allocator == &counting, "Expected copies to use the allocator at index 0.");
+	
+	pdict_remove(dict, "key5");
+	plist_set_str(list, 0, "replaced");
+	plist_remove(list, 1);
+	pvar_t popped;
+	ASSERT_TRUE(pdict_pop(dict, "key6", &popped) && strcmp(popped.data.s, "key6") == 0, "Expected pdict_pop to succeed at index 0.");
+	pvar_destroy(&popped);
+	ASSERT_TRUE(plist_pop(list, 0, &popped) && strcmp(popped.data.s, "replaced") == 0, "Expected plist_pop to succeed at index 0.");
+	pvar_destroy(&popped);
+	
+	pdict_destroy(flat);
+	plist_destroy(list);
+	pdict_destroy(dict);
+	ASSERT_TRUE(counts.live_bytes == 0 && counts.allocations == counts.releases, "Expected every allocation to be released at index 0.");
+	ASSERT_TRUE(counts.size_mismatches == 0, "Expected every release to pass the allocated size at index 0.");
+	
+	/* Index 1 */
+	/* The process wide allocator is captured at creation */
+	pvars_set_allocator(&counting);
+	ASSERT_TRUE(pvars_errno == SUCCESS && pvars_get_allocator() == &counting, "Expected pvars_set_allocator to succeed at index 1.");
+	list = plist_create(1);
+	pvars_arena_t *arena = pvars_arena_create(1024);
+	pvars_set_allocator(NULL);
+	ASSERT_TRUE(pvars_get_allocator() == libc, "Expected NULL to restore the default allocator at index 1.");
+	
+	size_t allocations = counts.allocations;
+	plist_add_str(list, "counted");
+	pdict_t *scratch = pdict_create_in(arena, 4);
+	pdict_add_str(scratch, "scratch", "counted");
+	ASSERT_TRUE(counts.allocations > allocations, "Expected the captured allocator to be used at index 1.");
+	
+	plist_destroy(list);
+	pvars_arena_destroy(arena);
+	ASSERT_TRUE(counts.live_bytes == 0 && counts.size_mismatches == 0, "Expected every allocation to be released at index 1.");
+	
+	/* Index 2 */
+	pvars_allocator_t incomplete = { test_counting_alloc, NULL, test_counting_release, &counts };
+	pvars_set_allocator(&incomplete);
+	ASSERT_TRUE(pvars_errno == FAILURE_PVARS_SET_ALLOCATOR_MISSING_HOOK, "Expected FAILURE_PVARS_SET_ALLOCATOR_MISSING_HOOK at index 2.");
+	ASSERT_TRUE(pvars_get_allocator() == libc, "Expected the allocator to be unchanged at index 2.");
+	
+	/* Index 3 */
+	/* Moving a container between allocators is refused */
+	list = plist_create(1);
+	plist_t *counted = plist_create_with_allocator(&counting, 1);
+	plist_add_list_take(list, counted);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_ADD_LIST_TAKE_ALLOCATOR_MISMATCH, "Expected FAILURE_PLIST_ADD_LIST_TAKE_ALLOCATOR_MISMATCH at index 3.");
+	plist_destroy(counted);
+	plist_destroy(list);
+	ASSERT_TRUE(counts.live_bytes == 0, "Expected every allocation to be released at index 3.");
+	
+	TEST_END();
+}
+
+
+/* -------------------------------------------------- */
+/* Test 35: pdict entry slabs, pdict_get_slab_stats() */
+/* -------------------------------------------------- */
+int test_pdict_slabs(void)
+{
+	test_counts_t counts = { 0, 0, 0, 0 };
+	pvars_allocator_t counting = { test_counting_alloc, test_counting_resize, test_counting_release, &counts };
+	pdict_slab_stats_t stats;
+	char key[32];
+	
+	/* Index 0 */
+	/* Removed entries are reused, so churn does not allocate new slabs */
+	pdict_t *dict = pdict_create_with_allocator(&counting, 64);
+	for (int i = 0; i < 100; i++) {
+		snprintf(key, sizeof(key), "key:%d", i);
+		pdict_add_int(dict, key, i);
+	}
+	pdict_get_slab_stats(dict, &stats);
+	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected SUCCESS at index 0.");
+	ASSERT_TRUE(stats.entries_in_use == 100, "Expected 100 entries in use at index 0.");
+	ASSERT_TRUE(stats.entries_in_use + stats.entries_free == stats.entry_capacity, "Expected consistent occupancy at index 0.");
+	
+	size_t slabs = stats.slab_count;
+	size_t allocations = counts.allocations;
+	for (int cycle = 0; cycle < 10; cycle++) {
+		for (int i = 0; i < 100; i++) {
+			snprintf(key, sizeof(key), "key:%d", i);
+			pdict_remove(dict, key);
+		}
+		for (int i = 0; i < 100; i++) {
+			snprintf(key, sizeof(key), "key:%d", i);
+			pdict_add_int(dict, key, i);
+		}
+	}
+	pdict_get_slab_stats(dict, &stats);
+	ASSERT_TRUE(stats.slab_count == slabs, "Expected no new slabs after churn at index 0.");
+	ASSERT_TRUE(counts.allocations - allocations == 10 * 100, "Expected only key allocations during churn at index 0.");
+	
+	/* Index 1 */
+	/* pdict_empty() keeps the slabs, pdict_shrink_to_fit() returns them */
+	pdict_empty(dict);
+	pdict_get_slab_stats(dict, &stats);
+	ASSERT_TRUE(stats.slab_count == slabs && stats.entries_in_use == 0, "Expected the slabs to be kept at index 1.");
+	ASSERT_TRUE(stats.entries_free == stats.entry_capacity && stats.bytes > 0, "Expected every entry to be free at index 1.");
+	
+	pdict_add_int(dict, "kept", 1);
+	pdict_shrink_to_fit(dict);
+	pdict_get_slab_stats(dict, &stats);
+	ASSERT_TRUE(stats.slab_count == 1 && stats.entries_in_use == 1, "Expected one slab to remain at index 1.");
+	int value = 0;
+	ASSERT_TRUE(pdict_get_int(dict, "kept", &value) && value == 1, "Expected the kept entry to survive at index 1.");
+	
+	pdict_remove(dict, "kept");
+	pdict_shrink_to_fit(dict);
+	pdict_get_slab_stats(dict, &stats);
+	ASSERT_TRUE(stats.slab_count == 0 && stats.bytes == 0, "Expected no slabs at index 1.");
+	
+	/* Index 2 */
+	/* Copies get slabs of their own */
+	for (int i = 0; i < 40; i++) {
+		snprintf(key, sizeof(key), "key:%d", i);
+		pdict_add_int(dict, key, i);
+	}
+	pdict_t *copy = pdict_copy(dict);
+	pdict_get_slab_stats(copy, &stats);
+	ASSERT_TRUE(stats.entries_in_use == 40, "Expected 40 copied entries at index 2.");
+	ASSERT_TRUE(pdict_get_int(copy, "key:39", &value) && value == 39, "Expected the copy to hold key:39 at index 2.");
+	pdict_destroy(copy);
+	pdict_destroy(dict);
+	ASSERT_TRUE(counts.live_bytes == 0, "Expected every allocation to be released at index 2.");
+	
+	/* Index 3 */
+	/* The flat backend stores entries inline */
+	dict = pdict_create_with_backend(8, PDICT_BACKEND_FLAT);
+	pdict_add_int(dict, "a", 1);
+	pdict_get_slab_stats(dict, &stats);
+	ASSERT_TRUE(pvars_errno == SUCCESS && stats.slab_count == 0 && stats.entry_capacity == 0, "Expected no slabs for a flat dict at index 3.");
+	
+	/* Index 4 */
+	pdict_get_slab_stats(NULL, &stats);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_GET_SLAB_STATS_NULL_INPUT, "Expected FAILURE_PDICT_GET_SLAB_STATS_NULL_INPUT at index 4.");
+	pdict_get_slab_stats(dict, NULL);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_GET_SLAB_STATS_NULL_INPUT_OUT_VALUE, "Expected FAILURE_PDICT_GET_SLAB_STATS_NULL_INPUT_OUT_VALUE at index 4.");
+	pdict_destroy(dict);
+	
+	TEST_END();
+}
+
+
+/* ------------------------------------------- */
+/* Test 36: Short strings stored inside pvar_t */
+/* ------------------------------------------- */
+int test_inline_strings(void)
+{
+	test_counts_t counts = { 0, 0, 0, 0 };
+	pvars_allocator_t counting = { test_counting_alloc, test_counting_resize, test_counting_release, &counts };
+	const char *borrowed = NULL;
+	char *copied = NULL;
+	
+	/* Index 0 */
+	/* Strings shorter than PVAR_INLINE_STR_SIZE do not allocate */
+	ASSERT_TRUE(sizeof(pvar_t) == 16, "Expected pvar_t to stay 16 bytes at index 0.");
+	plist_t *list = plist_create_with_allocator(&counting, 8);
+	size_t allocations = counts.allocations;
+	plist_add_str(list, "ok");
+	plist_add_str(list, "");
+	plist_add_str(list, "thirteen_char");
+	ASSERT_TRUE(counts.allocations == allocations, "Expected no allocations for short strings at index 0.");
+	ASSERT_TRUE(pvar_is_inline_str(&list->elements[2]), "Expected a 13 character string to be inline at index 0.");
+	plist_add_str(list, "fourteen_chars");
+	ASSERT_TRUE(counts.allocations == allocations + 1, "Expected one allocation for a long string at index 0.");
+	ASSERT_TRUE(!pvar_is_inline_str(&list->elements[3]), "Expected a 14 character string on the heap at index 0.");
+	
+	/* Index 1 */
+	ASSERT_TRUE(plist_borrow_str(list, 0, &borrowed) && strcmp(borrowed, "ok") == 0, "Expected to borrow 'ok' at index 1.");
+	ASSERT_TRUE(plist_borrow_str(list, 1, &borrowed) && strcmp(borrowed, "") == 0, "Expected to borrow '' at index 1.");
+	ASSERT_TRUE(plist_get_str(list, 2, &copied) && strcmp(copied, "thirteen_char") == 0, "Expected to get 'thirteen_char' at index 1.");
+	free(copied);
+	
+	/* Index 2 */
+	/* Switching between inline and heap storage, including from a borrowed pointer */
+	plist_set_str(list, 0, "a much longer replacement");
+	plist_set_str(list, 3, "short");
+	ASSERT_TRUE(plist_borrow_str(list, 3, &borrowed) && strcmp(borrowed, "short") == 0, "Expected 'short' at index 2.");
+	plist_set_str(list, 3, borrowed + 1);
+	ASSERT_TRUE(plist_borrow_str(list, 3, &borrowed) && strcmp(borrowed, "hort") == 0, "Expected 'hort' at index 2.");
+	plist_set_str(list, 0, "a much longer replacement" + 2);
+	ASSERT_TRUE(plist_borrow_str(list, 0, &borrowed) && strcmp(borrowed, "much longer replacement") == 0, "Expected the long string at index 2.");
+	
+	/* Index 3 */
+	/* Adding a borrowed inline string while the list grows */
+	plist_t *small = plist_create(1);
+	plist_add_str(small, "grow");
+	for (int i = 0; i < 4; i++) {
+		plist_borrow_str(small, 0, &borrowed);
+		plist_add_str(small, borrowed);
+	}
+	ASSERT_TRUE(plist_get_size(small) == 5 && plist_borrow_str(small, 4, &borrowed) && strcmp(borrowed, "grow") == 0, "Expected five copies at index 3.");
+	
+	/* Index 4 */
+	/* Copies, comparisons and pops */
+	plist_t *copy = plist_copy(list);
+	ASSERT_TRUE(plist_borrow_str(copy, 2, &borrowed) && strcmp(borrowed, "thirteen_char") == 0, "Expected the copy to hold 'thirteen_char' at index 4.");
+	pvar_t needle = { .type = PVAR_TYPE_STRING, .data.s = "hort" };
+	ASSERT_TRUE(plist_contains(copy, &needle), "Expected plist_contains to find 'hort' at index 4.");
+	plist_destroy(copy);
+	
+	pvar_t popped;
+	ASSERT_TRUE(plist_pop(small, 0, &popped) && popped.type == PVAR_TYPE_STRING && strcmp(popped.data.s, "grow") == 0, "Expected a heap string from plist_pop at index 4.");
+	pvar_destroy(&popped);
+	plist_destroy(small);
+	
+	/* Index 5 */
+	/* Dict values */
+	pdict_t *dict = pdict_create_with_allocator(&counting, 8);
+	allocations = counts.allocations;
+	pdict_add_str(dict, "status", "OK");
+	ASSERT_TRUE(counts.allocations == allocations + 2, "Expected only the key and entry slab to be allocated at index 5.");
+	pdict_set_str(dict, "status", "a value too long to inline");
+	pdict_borrow_str(dict, "status", &borrowed);
+	pdict_set_str(dict, "status", borrowed + 21);
+	ASSERT_TRUE(pdict_borrow_str(dict, "status", &borrowed) && strcmp(borrowed, "nline") == 0, "Expected 'nline' at index 5.");
+	ASSERT_TRUE(pdict_pop(dict, "status", &popped) && strcmp(popped.data.s, "nline") == 0, "Expected a heap string from pdict_pop at index 5.");
+	pvar_destroy(&popped);
+	
+	pdict_destroy(dict);
+	plist_destroy(list);
+	ASSERT_TRUE(counts.live_bytes == 0, "Expected every allocation to be released at index 5.");
+	
+	TEST_END();
+}
+
+
+/* ------------------------------------------------------ */
+/* Test 37: Length-prefixed strings, plist/pdict *_strn() */
+/* ------------------------------------------------------ */
+int test_length_prefixed_strings(void)
+{
+	static const char blob[] = "binary\0blob with\0 embedded NULs";
+	static const char tiny[] = "a\0b";
+	const size_t blob_len = sizeof(blob) - 1;
+	const char *borrowed = NULL;
+	size_t len = 0;
+	
+	/* Index 0 */
+	/* Bytes after a NUL survive inline and heap storage */
+	plist_t *list = plist_create(2);
+	plist_add_strn(list, tiny, 3);
+	plist_add_strn(list, blob, blob_len);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(list) == 2, "Expected two strings at index 0.");
+	ASSERT_TRUE(plist_borrow_strn(list, 0, &borrowed, &len) && len == 3 && memcmp(borrowed, tiny, 3) == 0, "Expected the inline bytes at index 0.");
+	ASSERT_TRUE(plist_borrow_strn(list, 1, &borrowed, &len) && len == blob_len && memcmp(borrowed, blob, blob_len) == 0, "Expected the heap bytes at index 0.");
+	
+	/* Index 1 */
+	/* Heap strings carry their length, hash and flags */
+	const pstr_t *header = pstr_header(list->elements[1].data.s);
+	ASSERT_TRUE(list->elements[1].str_tag == PVAR_STR_HEADER && header->len == blob_len, "Expected a length-prefixed string at index 1.");
+	ASSERT_TRUE((header->flags & PSTR_FLAG_BINARY) && (header->flags & PSTR_FLAG_HASHED), "Expected the binary and hashed flags at index 1.");
+	ASSERT_TRUE(header->hash == pstr_hash_bytes(blob, blob_len), "Expected the cached hash at index 1.");
+	
+	/* Index 2 */
+	/* Equality compares length and hash before the bytes */
+	plist_add_str(list, "a string of exactly 32 bytes!!!!");
+	plist_add_str(list, "a string of exactly 32 bytes????");
+	ASSERT_TRUE(!pvar_equals(&list->elements[2], &list->elements[3]), "Expected strings of equal length to differ at index 2.");
+	pvar_t needle = { .type = PVAR_TYPE_STRING, .data.s = "a string of exactly 32 bytes????" };
+	ASSERT_TRUE(plist_contains(list, &needle), "Expected plist_contains to find the string at index 2.");
+	needle.data.s = "a string of exactly 32 bytes....";
+	ASSERT_TRUE(!plist_contains(list, &needle), "Expected plist_contains to miss the string at index 2.");
+	needle.data.s = "binary";
+	ASSERT_TRUE(!plist_contains(list, &needle), "Expected a prefix before a NUL not to match at index 2.");
+	
+	/* Index 3 */
+	/* Copies, replacement and pops keep every byte */
+	plist_t *copy = plist_copy(list);
+	ASSERT_TRUE(plist_borrow_strn(copy, 1, &borrowed, &len) && len == blob_len && memcmp(borrowed, blob, blob_len) == 0, "Expected the copied bytes at index 3.");
+	ASSERT_TRUE(pvar_equals(&list->elements[1], &copy->elements[1]), "Expected the copy to compare equal at index 3.");
+	plist_set_strn(copy, 0, blob, blob_len);
+	ASSERT_TRUE(pvars_errno == SUCCESS && pvar_equals(&copy->elements[0], &copy->elements[1]), "Expected plist_set_strn to store the bytes at index 3.");
+	pvar_t popped;
+	ASSERT_TRUE(plist_pop(copy, 0, &popped) && memcmp(popped.data.s, blob, blob_len + 1) == 0, "Expected plist_pop to keep every byte at index 3.");
+	pvar_destroy(&popped);
+	plist_destroy(copy);
+	
+	/* Index 4 */
+	/* Dict values and keys */
+	pdict_t *dict = pdict_create(8);
+	pdict_add_strn(dict, "blob", blob, blob_len);
+	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected SUCCESS from pdict_add_strn at index 4.");
+	ASSERT_TRUE(pdict_borrow_strn(dict, "blob", &borrowed, &len) && len == blob_len && memcmp(borrowed, blob, blob_len) == 0, "Expected the stored bytes at index 4.");
+	pdict_set_strn(dict, "blob", tiny, 3);
+	ASSERT_TRUE(pdict_borrow_strn(dict, "blob", &borrowed, &len) && len == 3 && memcmp(borrowed, tiny, 3) == 0, "Expected the replaced bytes at index 4.");
+	pdict_add_strn(dict, "blob", tiny, 3);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_ADD_STRN_KEY_EXISTS, "Expected FAILURE_PDICT_ADD_STRN_KEY_EXISTS at index 4.");
+	pdict_set_strn(dict, "missing", tiny, 3);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_SET_STRN_VALUE_NOT_FOUND, "Expected FAILURE_PDICT_SET_STRN_VALUE_NOT_FOUND at index 4.");
+	pdict_entry_t *entry = NULL;
+	for (size_t i = 0; i < dict->capacity && entry == NULL; i++) {
+		entry = dict->buckets[i];
+	}
+	ASSERT_TRUE(entry != NULL && pstr_len(entry->key) == 4 && strcmp(entry->key, "blob") == 0, "Expected a length-prefixed key at index 4.");
+	
+	/* Index 5 */
+	plist_add_strn(NULL, blob, blob_len);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_ADD_STRN_NULL_INPUT_LIST, "Expected FAILURE_PLIST_ADD_STRN_NULL_INPUT_LIST at index 5.");
+	plist_borrow_strn(list, 0, &borrowed, NULL);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_BORROW_STRN_NULL_INPUT_OUT_VALUE, "Expected FAILURE_PLIST_BORROW_STRN_NULL_INPUT_OUT_VALUE at index 5.");
+	plist_set_strn(list, 9, blob, blob_len);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_SET_STRN_OUT_OF_BOUNDS, "Expected FAILURE_PLIST_SET_STRN_OUT_OF_BOUNDS at index 5.");
+	pdict_add_int(dict, "number", 1);
+	pdict_borrow_strn(dict, "number", &borrowed, &len);
+	ASSERT_TRUE(pvars_errno == FAILURE_PDICT_BORROW_STRN_WRONG_TYPE, "Expected FAILURE_PDICT_BORROW_STRN_WRONG_TYPE at index 5.");
+	
+	pdict_destroy(dict);
+	plist_destroy(list);
+	
+	TEST_END();
+}
+
+
+/* ------------------------------------------------------------ */
+/* Test 38: pvars_set_key_interning(), pvars_get_intern_stats() */
+/* ------------------------------------------------------------ */
+int test_key_interning(void)
+{
+	static const char *names[] = { "id", "name", "email", "a key longer than sixteen bytes" };
+	const size_t name_count = sizeof(names) / sizeof(names[0]);
+	pvars_intern_stats_t stats;
+	pdict_t *dicts[3];
+	pdict_iter_t iter;
+	const char *key_a = NULL;
+	const char *key_b = NULL;
+	pvar_t *value = NULL;
+	
+	/* Index 0 */
+	/* Dicts built while interning is on share one copy of each key */
+	ASSERT_TRUE(!pvars_get_key_interning(), "Expected key interning to be off by default at index 0.");
+	pvars_set_key_interning(true);
+	ASSERT_TRUE(pvars_errno == SUCCESS && pvars_get_key_interning(), "Expected key interning to be on at index 0.");
+	for (size_t i = 0; i < 3; i++) {
+		dicts[i] = pdict_create_with_backend(4, i == 2 ? PDICT_BACKEND_FLAT : PDICT_BACKEND_CHAINED);
+		for (size_t j = 0; j < name_count; j++) {
+			pdict_add_long(dicts[i], names[j], (long)j);
+		}
+	}
+	ASSERT_TRUE(pvars_get_intern_stats(&stats) && pvars_errno == SUCCESS, "Expected pvars_get_intern_stats to succeed at index 0.");
+	ASSERT_TRUE(stats.unique_keys == name_count && stats.references == 3 * name_count, "Expected one pooled key per name at index 0.");
+	ASSERT_TRUE(stats.bytes > 0 && stats.bytes_saved > 0, "Expected the pool to report its memory at index 0.");
+	
+	/* Index 1 */
+	/* Entries point at the pooled key, and lookups still work */
+	pdict_iter_init(&iter, dicts[0]);
+	ASSERT_TRUE(pdict_iter_next(&iter, &key_a, &value), "Expected an entry at index 1.");
+	pdict_iter_init(&iter, dicts[2]);
+	while (pdict_iter_next(&iter, &key_b, &value) && strcmp(key_a, key_b) != 0) {
+	}
+	ASSERT_TRUE(key_a == key_b, "Expected both dicts to share the key at index 1.");
+	long number = -1;
+	ASSERT_TRUE(pdict_get_long(dicts[2], "email", &number) && number == 2, "Expected to find an interned key at index 1.");
+#if SIZE_MAX > UINT32_MAX
+	/* A key shared past 2^32 times keeps counting */
+	pstr_t *pooled = (pstr_t *)pstr_header(key_a);
+	size_t refs = pooled->refs;
+	pooled->refs = (size_t)UINT32_MAX + refs;
+	pdict_t *more = pdict_create(4);
+	pdict_add_long(more, key_a, 1);
+	pdict_destroy(more);
+	ASSERT_TRUE(pooled->refs == (size_t)UINT32_MAX + refs, "Expected the reference count not to wrap at index 1.");
+	pooled->refs = refs;
+#endif
+	
+	/* Index 2 */
+	/* Copies take references instead of copying keys once they are written to */
+	pdict_t *copy = pdict_copy(dicts[1]);
+	pdict_set_long(copy, "id", 10);
+	pvars_get_intern_stats(&stats);
+	ASSERT_TRUE(stats.unique_keys == name_count && stats.references == 4 * name_count, "Expected pdict_copy to share the keys at index 2.");
+	pdict_iter_init(&iter, copy);
+	while (pdict_iter_next(&iter, &key_b, &value) && strcmp(key_a, key_b) != 0) {
+	}
+	ASSERT_TRUE(key_a == key_b, "Expected the copy to hold the pooled key at index 2.");
+	pdict_destroy(copy);
+	
+	/* Index 3 */
+	/* Removing the last reference frees a key */
+	for (size_t i = 0; i < 3; i++) {
+		pdict_remove(dicts[i], "id");
+	}
+	pvars_get_intern_stats(&stats);
+	ASSERT_TRUE(stats.unique_keys == name_count - 1 && stats.references == 3 * (name_count - 1), "Expected the removed key to leave the pool at index 3.");
+	
+	/* Index 4 */
+	/* Arena dicts and dicts created with interning off keep their own keys */
+	pvars_arena_t *arena = pvars_arena_create(0);
+	pdict_t *scratch = pdict_create_in(arena, 4);
+	pdict_add_long(scratch, "name", 1);
+	pvars_set_key_interning(false);
+	pdict_t *plain = pdict_create(4);
+	pdict_add_long(plain, "name", 1);
+	pdict_add_long(dicts[0], "extra", 1);
+	pvars_get_intern_stats(&stats);
+	ASSERT_TRUE(stats.unique_keys == name_count && stats.references == 3 * (name_count - 1) + 1, "Expected only the interning dict to use the pool at index 4.");
+	pdict_iter_init(&iter, plain);
+	ASSERT_TRUE(pdict_iter_next(&iter, &key_b, &value) && !(pstr_header(key_b)->flags & PSTR_FLAG_INTERNED), "Expected a private key at index 4.");
+	pdict_destroy(plain);
+	pvars_arena_destroy(arena);
+	
+	/* Index 5 */
+	/* Destroying the dicts empties the pool */
+	for (size_t i = 0; i < 3; i++) {
+		pdict_destroy(dicts[i]);
+	}
+	pvars_get_intern_stats(&stats);
+	ASSERT_TRUE(stats.unique_keys == 0 && stats.references == 0 && stats.bytes == 0 && stats.bytes_saved == 0, "Expected an empty pool at index 5.");
+	
+	/* Index 6 */
+	pvars_get_intern_stats(NULL);
+	ASSERT_TRUE(pvars_errno == FAILURE_PVARS_GET_INTERN_STATS_NULL_INPUT_OUT_VALUE, "Expected FAILURE_PVARS_GET_INTERN_STATS_NULL_INPUT_OUT_VALUE at index 6.");
+	
+	TEST_END();
+}
+
+
+/* Shared by the threads of Test 39 */
+typedef struct {
+	const pdict_t *root;
+	int failed;
+} test_cow_worker_t;
+
+/* Copies the shared root, rewrites the copy and checks the root is unchanged */
+static void *test_cow_worker(void *arg)
+{
+	test_cow_worker_t *worker = arg;
+	long value = 0;
+
+	for (int round = 0; round < 200; round++) {
+		pdict_t *copy = pdict_copy(worker->root);
+		plist_t *items = NULL;
+
+		if (copy == NULL || !pdict_get_list(copy, "items", &items)) {
+			worker->failed = 1;
+			pdict_destroy(copy);
+			return NULL;
+		}
+		plist_set_long(items, 0, -1);
+		pdict_set_list_take(copy, "items", items);
+		pdict_set_long(copy, "version", round);
+
+		if (!pdict_get_long(worker->root, "version", &value) || value != 1) {
+			worker->failed = 1;
+		}
+		pdict_destroy(copy);
+	}
+
+	return NULL;
+}
+
+/* ------------------------------------------------------------- */
+/* Test 39: Copy-on-write plist_copy(), pdict_copy() and getters */
+/* ------------------------------------------------------------- */
+int test_copy_on_write(void)
+{
+	long value = 0;
+	
+	/* Index 0 */
+	/* A copy shares the elements until one side is written to */
+	plist_t *list = plist_create(4);
+	plist_add_long(list, 1);
+	plist_add_str(list, "a string too long to be stored inline");
+	plist_t *copy = plist_copy(list);
+	ASSERT_TRUE(copy != NULL && pvars_errno == SUCCESS, "Expected plist_copy to succeed at index 0.");
+	ASSERT_TRUE(copy->elements == list->elements && plist_get_size(copy) == 2, "Expected the copy to share the elements at index 0.");
+	plist_set_long(copy, 0, 2);
+	ASSERT_TRUE(pvars_errno == SUCCESS && copy->elements != list->elements, "Expected a write to unshare the copy at index 0.");
+	ASSERT_TRUE(plist_get_long(list, 0, &value) && value == 1, "Expected the source to keep its value at index 0.");
+	ASSERT_TRUE(plist_get_long(copy, 0, &value) && value == 2, "Expected the copy to hold the new value at index 0.");
+	
+	/* Index 1 */
+	/* The last handle writes in place */
+	plist_t *second = plist_copy(list);
+	pvar_t *shared = list->elements;
+	plist_destroy(list);
+	plist_add_int(second, 3);
+	ASSERT_TRUE(second->elements == shared, "Expected the remaining handle to keep the elements at index 1.");
+	ASSERT_TRUE(plist_get_size(second) == 3 && plist_get_size(copy) == 2, "Expected independent sizes at index 1.");
+	plist_destroy(second);
+	
+	/* Index 2 */
+	/* Getters hand out copies that share nested containers */
+	pdict_t *root = pdict_create(8);
+	pdict_add_long(root, "version", 1);
+	pdict_add_list(root, "items", copy);
+	const plist_t *borrowed = NULL;
+	plist_t *items = NULL;
+	ASSERT_TRUE(pdict_borrow_list(root, "items", &borrowed) && pdict_get_list(root, "items", &items), "Expected the nested list at index 2.");
+	ASSERT_TRUE(items->elements == borrowed->elements, "Expected pdict_get_list to share the nested list at index 2.");
+	plist_add_long(items, 4);
+	ASSERT_TRUE(plist_get_size(borrowed) == 2 && plist_get_size(items) == 3, "Expected the nested list to stay unchanged at index 2.");
+	plist_destroy(items);
+	
+	/* Index 3 */
+	/* Dict copies, removal and emptying */
+	pdict_t *dict_copy = pdict_copy(root);
+	ASSERT_TRUE(dict_copy != NULL && dict_copy->buckets == root->buckets, "Expected pdict_copy to share the entries at index 3.");
+	pdict_remove(dict_copy, "version");
+	ASSERT_TRUE(pvars_errno == SUCCESS && !pdict_contains(dict_copy, "version") && pdict_contains(root, "version"), "Expected pdict_remove to unshare the copy at index 3.");
+	pdict_t *emptied = pdict_copy(root);
+	pdict_empty(emptied);
+	ASSERT_TRUE(pdict_get_size(emptied) == 0 && pdict_get_size(root) == 2, "Expected pdict_empty to leave the source intact at index 3.");
+	plist_t *list_copy = plist_copy(copy);
+	plist_empty(list_copy);
+	ASSERT_TRUE(plist_get_size(list_copy) == 0 && plist_get_size(copy) == 2, "Expected plist_empty to leave the source intact at index 3.");
+	pdict_destroy(emptied);
+	pdict_destroy(dict_copy);
+	plist_destroy(list_copy);
+	
+	/* Index 4 */
+	/* A container can be added to itself */
+	plist_add_list(copy, copy);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(copy) == 3, "Expected plist_add_list to add the list to itself at index 4.");
+	ASSERT_TRUE(plist_borrow_list(copy, 2, &borrowed) && plist_get_size(borrowed) == 2, "Expected the inner list to keep two elements at index 4.");
+	pdict_add_dict(root, "self", root);
+	ASSERT_TRUE(pvars_errno == SUCCESS && pdict_get_size(root) == 3, "Expected pdict_add_dict to add the dict to itself at index 4.");
+	const pdict_t *inner = NULL;
+	ASSERT_TRUE(pdict_borrow_dict(root, "self", &inner) && pdict_get_size(inner) == 2, "Expected the inner dict to keep two entries at index 4.");
+	pdict_remove(root, "self");
+	
+	/* Index 5 */
+	/* Containers in an arena are copied eagerly */
+	pvars_arena_t *arena = pvars_arena_create(0);
+	plist_t *scratch = plist_create_in(arena, 4);
+	plist_add_long(scratch, 1);
+	plist_add_list(scratch, copy);
+	ASSERT_TRUE(plist_borrow_list(scratch, 1, &borrowed) && borrowed->elements != copy->elements, "Expected a deep copy into the arena at index 5.");
+	pvars_arena_destroy(arena);
+	
+	/* Index 6 */
+	/* Threads copying and rewriting one shared tree */
+	pthread_t threads[4];
+	test_cow_worker_t workers[4];
+	for (int i = 0; i < 4; i++) {
+		workers[i].root = root;
+		workers[i].failed = 0;
+		pthread_create(&threads[i], NULL, test_cow_worker, &workers[i]);
+	}
+	for (int i = 0; i < 4; i++) {
+		pthread_join(threads[i], NULL);
+		ASSERT_TRUE(!workers[i].failed, "Expected every thread to see the original tree at index 6.");
+	}
+	ASSERT_TRUE(pdict_borrow_list(root, "items", &borrowed) && plist_get_long(borrowed, 0, &value) && value == 2, "Expected the shared tree to be unchanged at index 6.");
+	
+	plist_destroy(copy);
+	pdict_destroy(root);
+	
+	TEST_END();
+}
+
+
+/* ----------------------------------------- */
+/* Test 40: plist_extend_*(), plist_extend() */
+/* ----------------------------------------- */
+int test_plist_extend(void)
+{
+	static const int ints[] = { 1, 2, 3, 4, 5 };
+	static const long longs[] = { 10L, 20L };
+	static const double doubles[] = { 0.5, 1.5, 2.5 };
+	static const float floats[] = { 0.25f };
+	static const char *const strs[] = { "short", "a string too long to be stored inline" };
+	int int_value = 0;
+	long long_value = 0;
+	double double_value = 0.0;
+	float float_value = 0.0f;
+	const char *borrowed = NULL;
+	
+	/* Index 0 */
+	/* Numbers are appended in order, growing the list once */
+	plist_t *list = plist_create(1);
+	plist_extend_ints(list, ints, 5);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(list) == 5 && plist_get_capacity(list) == 8, "Expected five ints in a list grown once at index 0.");
+	ASSERT_TRUE(plist_get_int(list, 4, &int_value) && int_value == 5, "Expected the last int at index 0.");
+	plist_extend_longs(list, longs, 2);
+	plist_extend_doubles(list, doubles, 3);
+	plist_extend_floats(list, floats, 1);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(list) == 11, "Expected eleven elements at index 0.");
+	ASSERT_TRUE(plist_get_long(list, 6, &long_value) && long_value == 20L, "Expected the second long at index 0.");
+	ASSERT_TRUE(plist_get_double(list, 9, &double_value) && double_value == 2.5, "Expected the third double at index 0.");
+	ASSERT_TRUE(plist_get_float(list, 10, &float_value) && float_value == 0.25f, "Expected the float at index 0.");
+	plist_extend_ints(list, NULL, 0);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(list) == 11, "Expected an empty extend to do nothing at index 0.");
+	
+	/* Index 1 */
+	/* Strings and pvars are copied */
+	plist_extend_strs(list, strs, 2);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_borrow_str(list, 12, &borrowed) && strcmp(borrowed, strs[1]) == 0 && borrowed != strs[1], "Expected a copied string at index 1.");
+	pvar_t values[2] = { { .type = PVAR_TYPE_STRING, .data.s = "pvar" }, { .type = PVAR_TYPE_LIST, .data.ls = list } };
+	plist_t *other = plist_create(4);
+	plist_extend_pvars(other, values, 2);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(other) == 2, "Expected two pvars at index 1.");
+	const plist_t *nested = NULL;
+	ASSERT_TRUE(plist_borrow_list(other, 1, &nested) && nested != list && plist_get_size(nested) == 13, "Expected a copy of the nested list at index 1.");
+	
+	/* Index 2 */
+	/* A list may extend another list or itself */
+	plist_extend(other, list);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(other) == 15, "Expected plist_extend to append every element at index 2.");
+	ASSERT_TRUE(plist_borrow_str(other, 13, &borrowed) && strcmp(borrowed, "short") == 0, "Expected the copied inline string at index 2.");
+	plist_extend(list, list);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(list) == 26, "Expected the list to hold its elements twice at index 2.");
+	ASSERT_TRUE(plist_borrow_str(list, 25, &borrowed) && strcmp(borrowed, strs[1]) == 0, "Expected the repeated string at index 2.");
+	
+	/* Index 3 */
+	/* Invalid input leaves the list unchanged */
+	static const char *const holes[] = { "one", NULL };
+	plist_extend_strs(list, holes, 2);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_EXTEND_STRS_NULL_STRING_INPUT && plist_get_size(list) == 26, "Expected FAILURE_PLIST_EXTEND_STRS_NULL_STRING_INPUT at index 3.");
+	plist_extend_doubles(NULL, doubles, 3);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_EXTEND_DOUBLES_NULL_INPUT, "Expected FAILURE_PLIST_EXTEND_DOUBLES_NULL_INPUT at index 3.");
+	plist_extend_longs(list, NULL, 2);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_EXTEND_LONGS_NULL_VALUES_INPUT, "Expected FAILURE_PLIST_EXTEND_LONGS_NULL_VALUES_INPUT at index 3.");
+	plist_extend(list, NULL);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_EXTEND_NULL_LIST_INPUT, "Expected FAILURE_PLIST_EXTEND_NULL_LIST_INPUT at index 3.");
+	
+	plist_destroy(other);
+	plist_destroy(list);
+	
+	TEST_END();
+}
+
+
+/* ---------------------------------------------------------- */
+/* Test 41: plist_reserve(), plist_shrink_to_fit(), growth    */
+/* ---------------------------------------------------------- */
+int test_plist_sizing(void)
+{
+	static const int ints[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+	int int_value = 0;
+	
+	/* Index 0 */
+	/* The default policy doubles the capacity */
+	plist_t *list = plist_create(1);
+	ASSERT_TRUE(plist_get_growth_policy(list) == PLIST_GROWTH_DOUBLE, "Expected the doubling policy by default at index 0.");
+	plist_extend_ints(list, ints, 5);
+	ASSERT_TRUE(plist_get_capacity(list) == 8, "Expected a capacity of 8 at index 0.");
+	plist_destroy(list);
+	
+	/* Index 1 */
+	/* Growing by half: 1, 2, 3, 5, 8 */
+	list = plist_create(1);
+	plist_set_growth_policy(list, PLIST_GROWTH_HALF, 0);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_growth_policy(list) == PLIST_GROWTH_HALF, "Expected the 1.5x policy at index 1.");
+	for (int i = 0; i < 5; i++) {
+		plist_add_int(list, i);
+	}
+	ASSERT_TRUE(plist_get_capacity(list) == 5, "Expected a capacity of 5 at index 1.");
+	plist_add_int(list, 5);
+	ASSERT_TRUE(plist_get_capacity(list) == 8, "Expected a capacity of 8 at index 1.");
+	plist_destroy(list);
+	
+	/* Index 2 */
+	/* Growing by fixed chunks, bulk adds round up to whole chunks */
+	list = plist_create(1);
+	plist_set_growth_policy(list, PLIST_GROWTH_CHUNK, 4);
+	for (int i = 0; i < 5; i++) {
+		plist_add_int(list, i);
+	}
+	ASSERT_TRUE(plist_get_capacity(list) == 5, "Expected a capacity of 5 at index 2.");
+	plist_add_int(list, 5);
+	ASSERT_TRUE(plist_get_capacity(list) == 9, "Expected a capacity of 9 at index 2.");
+	plist_extend_ints(list, ints, 10);
+	ASSERT_TRUE(plist_get_size(list) == 16 && plist_get_capacity(list) == 17, "Expected a capacity of 17 at index 2.");
+	
+	/* Index 3 */
+	/* Copies keep the policy */
+	plist_t *copy = plist_copy(list);
+	plist_add_int(copy, 16);
+	plist_add_int(copy, 17);
+	ASSERT_TRUE(plist_get_growth_policy(copy) == PLIST_GROWTH_CHUNK && plist_get_capacity(copy) == 21, "Expected the copy to grow by chunks at index 3.");
+	ASSERT_TRUE(plist_get_size(list) == 16 && plist_get_capacity(list) == 17, "Expected the original unchanged at index 3.");
+	plist_destroy(copy);
+	plist_destroy(list);
+	
+	/* Index 4 */
+	/* Reserve sets the capacity exactly and never shrinks */
+	list = plist_create(1);
+	plist_reserve(list, 100);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_capacity(list) == 100, "Expected a capacity of 100 at index 4.");
+	plist_reserve(list, 10);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_capacity(list) == 100, "Expected the capacity kept at index 4.");
+	plist_extend_ints(list, ints, 10);
+	ASSERT_TRUE(plist_get_capacity(list) == 100, "Expected no growth after reserving at index 4.");
+	
+	/* Index 5 */
+	/* A drained list gives its memory back */
+	plist_shrink_to_fit(list);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_capacity(list) == 10, "Expected a capacity of 10 at index 5.");
+	ASSERT_TRUE(plist_get_int(list, 9, &int_value) && int_value == 10, "Expected the elements kept at index 5.");
+	plist_add_int(list, 11);
+	ASSERT_TRUE(plist_get_size(list) == 11 && plist_get_capacity(list) == 20, "Expected the list to grow again at index 5.");
+	plist_empty(list);
+	plist_shrink_to_fit(list);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_capacity(list) == 1, "Expected an empty list to keep one slot at index 5.");
+	plist_add_int(list, 1);
+	plist_add_int(list, 2);
+	ASSERT_TRUE(plist_get_size(list) == 2 && plist_get_capacity(list) == 2, "Expected the shrunk list to grow at index 5.");
+	
+	/* Index 6 */
+	/* Resizing a shared list leaves the other handle alone */
+	plist_reserve(list, 64);
+	copy = plist_copy(list);
+	plist_shrink_to_fit(copy);
+	ASSERT_TRUE(plist_get_capacity(copy) == 2 && plist_get_capacity(list) == 64, "Expected only the copy shrunk at index 6.");
+	plist_reserve(list, 128);
+	ASSERT_TRUE(plist_get_capacity(list) == 128 && plist_get_int(copy, 1, &int_value) && int_value == 2, "Expected the copy intact at index 6.");
+	plist_destroy(copy);
+	
+	/* Index 7 */
+	/* Invalid input */
+	plist_set_growth_policy(list, PLIST_GROWTH_CHUNK, 0);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_SET_GROWTH_POLICY_CHUNK_OUT_OF_BOUNDS, "Expected a chunk error at index 7.");
+	plist_set_growth_policy(list, (plist_growth_policy)42, 1);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_SET_GROWTH_POLICY_UNKNOWN_POLICY, "Expected a policy error at index 7.");
+	ASSERT_TRUE(plist_get_growth_policy(list) == PLIST_GROWTH_DOUBLE, "Expected the policy unchanged at index 7.");
+	plist_reserve(list, SIZE_MAX);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_RESERVE_REALLOC_FAILED && plist_get_capacity(list) == 128, "Expected an impossible reserve to fail at index 7.");
+	plist_reserve(NULL, 1);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_RESERVE_NULL_INPUT, "Expected a NULL error at index 7.");
+	plist_shrink_to_fit(NULL);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_SHRINK_TO_FIT_NULL_INPUT, "Expected a NULL error at index 7.");
+	plist_set_growth_policy(NULL, PLIST_GROWTH_HALF, 0);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_SET_GROWTH_POLICY_NULL_INPUT, "Expected a NULL error at index 7.");
+	plist_destroy(list);
+	
+	TEST_END();
+}
+
+
+/* Used by Test 42: removes ints divisible by *ctx and strings starting with 'x' */
+static bool test_remove_predicate(const pvar_t *value, void *ctx)
+{
+	if (value->type == PVAR_TYPE_INT) {
+		return value->data.i % *(int *)ctx == 0;
+	}
+	return value->type == PVAR_TYPE_STRING && value->data.s[0] == 'x';
+}
+
+/* ---------------------------------------------------------- */
+/* Test 42: plist_remove_range(), plist_remove_if(),          */
+/* plist_swap_remove()                                        */
+/* ---------------------------------------------------------- */
+int test_plist_remove_batch(void)
+{
+	int int_value = 0;
+	int divisor = 3;
+	const char *borrowed = NULL;
+	
+	/* Index 0 */
+	/* A range is removed and the tail moves down */
+	plist_t *list = plist_create(16);
+	for (int i = 0; i < 10; i++) {
+		plist_add_int(list, i);
+	}
+	plist_remove_range(list, 2, 3);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(list) == 7, "Expected seven elements at index 0.");
+	ASSERT_TRUE(plist_get_int(list, 1, &int_value) && int_value == 1, "Expected 1 kept at index 0.");
+	ASSERT_TRUE(plist_get_int(list, 2, &int_value) && int_value == 5, "Expected 5 moved down at index 0.");
+	ASSERT_TRUE(plist_get_int(list, 6, &int_value) && int_value == 9, "Expected 9 last at index 0.");
+	ASSERT_TRUE(plist_get_type(list, 7) == PVAR_TYPE_NONE, "Expected the vacated slot cleared at index 0.");
+	
+	/* Index 1 */
+	/* Empty, whole and out of bounds ranges */
+	plist_remove_range(list, 7, 0);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(list) == 7, "Expected an empty range to remove nothing at index 1.");
+	plist_remove_range(list, 5, 3);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_REMOVE_RANGE_OUT_OF_BOUNDS && plist_get_size(list) == 7, "Expected a range past the end to fail at index 1.");
+	plist_remove_range(list, 1, SIZE_MAX);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_REMOVE_RANGE_OUT_OF_BOUNDS, "Expected an overflowing range to fail at index 1.");
+	plist_remove_range(list, 0, 7);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(list) == 0, "Expected an empty list at index 1.");
+	
+	/* Index 2 */
+	/* Filtering keeps the order of the survivors and frees the others */
+	plist_add_str(list, "xs");
+	for (int i = 1; i <= 9; i++) {
+		plist_add_int(list, i);
+	}
+	plist_add_str(list, "keep");
+	plist_add_str(list, "x: a string too long to be stored inline");
+	plist_add_str(list, "a string too long to be stored inline, kept");
+	size_t removed = plist_remove_if(list, test_remove_predicate, &divisor);
+	ASSERT_TRUE(pvars_errno == SUCCESS && removed == 5 && plist_get_size(list) == 8, "Expected five elements removed at index 2.");
+	ASSERT_TRUE(plist_get_int(list, 0, &int_value) && int_value == 1, "Expected 1 first at index 2.");
+	ASSERT_TRUE(plist_get_int(list, 2, &int_value) && int_value == 4, "Expected 4 third at index 2.");
+	ASSERT_TRUE(plist_get_int(list, 5, &int_value) && int_value == 8, "Expected 8 sixth at index 2.");
+	ASSERT_TRUE(plist_borrow_str(list, 6, &borrowed) && strcmp(borrowed, "keep") == 0, "Expected the short string kept at index 2.");
+	ASSERT_TRUE(plist_borrow_str(list, 7, &borrowed) && strcmp(borrowed, "a string too long to be stored inline, kept") == 0, "Expected the long string kept at index 2.");
+	ASSERT_TRUE(plist_get_type(list, 8) == PVAR_TYPE_NONE, "Expected the vacated slots cleared at index 2.");
+	
+	/* Index 3 */
+	/* Filtering a copy leaves the original alone */
+	plist_t *copy = plist_copy(list);
+	divisor = 2;
+	removed = plist_remove_if(copy, test_remove_predicate, &divisor);
+	ASSERT_TRUE(removed == 3 && plist_get_size(copy) == 5 && plist_get_size(list) == 8, "Expected only the copy filtered at index 3.");
+	ASSERT_TRUE(plist_get_int(list, 1, &int_value) && int_value == 2, "Expected the original intact at index 3.");
+	divisor = 1000;
+	removed = plist_remove_if(copy, test_remove_predicate, &divisor);
+	ASSERT_TRUE(pvars_errno == SUCCESS && removed == 0 && plist_get_size(copy) == 5, "Expected nothing removed at index 3.");
+	plist_destroy(copy);
+	
+	/* Index 4 */
+	/* Swap removal moves the last element into the hole */
+	plist_swap_remove(list, 1);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(list) == 7, "Expected seven elements at index 4.");
+	ASSERT_TRUE(plist_borrow_str(list, 1, &borrowed) && strcmp(borrowed, "a string too long to be stored inline, kept") == 0, "Expected the last element moved at index 4.");
+	plist_swap_remove(list, 6);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(list) == 6 && plist_get_type(list, 6) == PVAR_TYPE_NONE, "Expected the last element removed at index 4.");
+	plist_swap_remove(list, 6);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_SWAP_REMOVE_OUT_OF_BOUNDS, "Expected an out of bounds error at index 4.");
+	
+	/* Index 5 */
+	/* NULL input */
+	plist_remove_range(NULL, 0, 0);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_REMOVE_RANGE_NULL_INPUT, "Expected a NULL error at index 5.");
+	ASSERT_TRUE(plist_remove_if(list, NULL, NULL) == 0 && pvars_errno == FAILURE_PLIST_REMOVE_IF_NULL_INPUT, "Expected a NULL error at index 5.");
+	plist_swap_remove(NULL, 0);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_SWAP_REMOVE_NULL_INPUT, "Expected a NULL error at index 5.");
+	plist_destroy(list);
+	
+	TEST_END();
+}
+
+
+/* ---------------------------------------------------------- */
+/* Test 43: plist_insert_*(), O(1) pops at both ends          */
+/* ---------------------------------------------------------- */
+int test_plist_insert(void)
+{
+	int int_value = 0;
+	long long_value = 0;
+	double double_value = 0.0;
+	float float_value = 0.0f;
+	const char *borrowed = NULL;
+	size_t len = 0;
+	pvar_t popped;
+	
+	/* Index 0 */
+	/* Inserting at the front, the back and in the middle */
+	plist_t *list = plist_create(1);
+	plist_insert_int(list, 0, 3);
+	plist_insert_int(list, 0, 1);
+	plist_insert_int(list, 2, 5);
+	plist_insert_long(list, 1, 2L);
+	plist_insert_double(list, 3, 4.5);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(list) == 5, "Expected five elements at index 0.");
+	ASSERT_TRUE(plist_get_int(list, 0, &int_value) && int_value == 1, "Expected 1 first at index 0.");
+	ASSERT_TRUE(plist_get_long(list, 1, &long_value) && long_value == 2L, "Expected 2L second at index 0.");
+	ASSERT_TRUE(plist_get_int(list, 2, &int_value) && int_value == 3, "Expected 3 third at index 0.");
+	ASSERT_TRUE(plist_get_double(list, 3, &double_value) && double_value == 4.5, "Expected 4.5 fourth at index 0.");
+	ASSERT_TRUE(plist_get_int(list, 4, &int_value) && int_value == 5, "Expected 5 last at index 0.");
+	
+	/* Index 1 */
+	/* Strings, floats and copies */
+	plist_insert_str(list, 0, "head");
+	plist_insert_strn(list, 6, "a\0b", 3);
+	plist_insert_float(list, 1, 0.5f);
+	plist_insert_str(list, 4, "a string too long to be stored inline");
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(list) == 9, "Expected nine elements at index 1.");
+	ASSERT_TRUE(plist_borrow_str(list, 0, &borrowed) && strcmp(borrowed, "head") == 0, "Expected the string first at index 1.");
+	ASSERT_TRUE(plist_get_float(list, 1, &float_value) && float_value == 0.5f, "Expected the float second at index 1.");
+	ASSERT_TRUE(plist_borrow_str(list, 4, &borrowed) && strcmp(borrowed, "a string too long to be stored inline") == 0, "Expected the long string at index 1.");
+	ASSERT_TRUE(plist_borrow_strn(list, 8, &borrowed, &len) && len == 3 && memcmp(borrowed, "a\0b", 3) == 0, "Expected the bytes last at index 1.");
+	plist_insert_list(list, 0, list);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(list) == 10 && plist_get_type(list, 0) == PVAR_TYPE_LIST, "Expected a copy of the list inserted into itself at index 1.");
+	const plist_t *inner = NULL;
+	ASSERT_TRUE(plist_borrow_list(list, 0, &inner) && plist_get_size(inner) == 9, "Expected the inserted copy unchanged at index 1.");
+	pdict_t *dict = pdict_create(4);
+	pdict_add_int(dict, "id", 7);
+	plist_insert_dict(list, 10, dict);
+	plist_insert_dict_take(list, 1, dict);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_type(list, 1) == PVAR_TYPE_DICT && plist_get_type(list, 11) == PVAR_TYPE_DICT, "Expected two dicts at index 1.");
+	plist_insert_list_take(list, 2, plist_create(1));
+	pvar_t value = { .data.s = "pvar", .type = PVAR_TYPE_STRING };
+	plist_insert_pvar(list, 3, &value);
+	ASSERT_TRUE(plist_get_size(list) == 14 && plist_borrow_str(list, 3, &borrowed) && strcmp(borrowed, "pvar") == 0, "Expected the pvar at index 1.");
+	plist_destroy(list);
+	
+	/* Index 2 */
+	/* Pushing to the front repeatedly */
+	list = plist_create(1);
+	for (int i = 0; i < 1000; i++) {
+		plist_insert_int(list, 0, i);
+	}
+	ASSERT_TRUE(plist_get_size(list) == 1000 && plist_get_capacity(list) <= 2048, "Expected front space to grow by doubling at index 2.");
+	ASSERT_TRUE(plist_get_int(list, 0, &int_value) && int_value == 999, "Expected the last push first at index 2.");
+	ASSERT_TRUE(plist_get_int(list, 999, &int_value) && int_value == 0, "Expected the first push last at index 2.");
+	plist_add_int(list, -1);
+	ASSERT_TRUE(plist_get_int(list, 1000, &int_value) && int_value == -1, "Expected an add at the end at index 2.");
+	plist_destroy(list);
+	
+	/* Index 3 */
+	/* A queue: add at the back, pop at the front, memory stays bounded */
+	list = plist_create(4);
+	int expected = 0;
+	bool in_order = true;
+	for (int i = 0; i < 10000; i++) {
+		plist_add_int(list, i);
+		if (i % 4 != 3) {
+			continue;
+		}
+		for (int j = 0; j < 3; j++) {
+			in_order = in_order && plist_pop(list, 0, &popped) && popped.data.i == expected++;
+		}
+	}
+	ASSERT_TRUE(in_order && plist_get_size(list) == 2500, "Expected elements popped in order at index 3.");
+	ASSERT_TRUE(plist_get_capacity(list) <= 8192, "Expected the array not to grow past twice the queue at index 3.");
+	while (plist_get_size(list) > 0) {
+		in_order = in_order && plist_pop(list, 0, &popped) && popped.data.i == expected++;
+	}
+	ASSERT_TRUE(in_order && expected == 10000, "Expected the queue drained in order at index 3.");
+	
+	/* Index 4 */
+	/* A drained queue starts again at the beginning of its array */
+	size_t capacity = plist_get_capacity(list);
+	for (int i = 0; i < 100; i++) {
+		plist_add_int(list, i);
+		plist_pop(list, 0, &popped);
+	}
+	ASSERT_TRUE(plist_get_capacity(list) == capacity, "Expected a steady queue not to grow at index 4.");
+	plist_insert_int(list, 0, 2);
+	plist_insert_int(list, 0, 1);
+	plist_add_int(list, 3);
+	plist_shrink_to_fit(list);
+	ASSERT_TRUE(plist_get_capacity(list) == 3 && plist_get_int(list, 0, &int_value) && int_value == 1, "Expected the front space released at index 4.");
+	ASSERT_TRUE(plist_get_int(list, 2, &int_value) && int_value == 3, "Expected 3 last at index 4.");
+	plist_remove(list, 0);
+	plist_empty(list);
+	ASSERT_TRUE(plist_get_capacity(list) == 3 && plist_get_size(list) == 0, "Expected the capacity kept by empty at index 4.");
+	plist_destroy(list);
+	
+	/* Index 5 */
+	/* Inserting into a copy leaves the original alone */
+	list = plist_create(4);
+	for (int i = 0; i < 4; i++) {
+		plist_add_int(list, i);
+	}
+	plist_pop(list, 0, &popped);
+	plist_t *copy = plist_copy(list);
+	plist_insert_int(copy, 0, 100);
+	plist_pop(copy, 3, &popped);
+	ASSERT_TRUE(plist_get_size(list) == 3 && plist_get_int(list, 0, &int_value) && int_value == 1, "Expected the original intact at index 5.");
+	ASSERT_TRUE(plist_get_size(copy) == 3 && plist_get_int(copy, 0, &int_value) && int_value == 100, "Expected the copy changed at index 5.");
+	plist_destroy(copy);
+	
+	/* Index 6 */
+	/* Invalid input */
+	plist_insert_int(list, 4, 0);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_INSERT_INT_OUT_OF_BOUNDS && plist_get_size(list) == 3, "Expected an out of bounds error at index 6.");
+	plist_insert_str(list, 0, NULL);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_INSERT_STR_NULL_STRING_INPUT, "Expected a NULL string error at index 6.");
+	plist_insert_list_take(list, 0, list);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_INSERT_LIST_TAKE_SELF_INSERT, "Expected a self insert error at index 6.");
+	plist_insert_double(NULL, 0, 1.0);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_INSERT_DOUBLE_NULL_INPUT, "Expected a NULL error at index 6.");
+	plist_destroy(list);
+	
+	TEST_END();
+}
+
+
+/* Used by Test 44: removes negative doubles */
+static bool test_negative_predicate(const pvar_t *value, void *ctx)
+{
+	(void)ctx;
+	return value->type == PVAR_TYPE_DOUBLE && value->data.d < 0.0;
+}
+
+/* ---------------------------------------------------------- */
+/* Test 44: plist_create_typed(), plist_borrow_span()         */
+/* ---------------------------------------------------------- */
+int test_plist_typed(void)
+{
+	static const double samples[] = { 1.5, -2.0, 3.5, -4.0 };
+	double double_value = 0.0;
+	int int_value = 0;
+	const void *data = NULL;
+	void *mutable_data = NULL;
+	size_t count = 0;
+	pvar_t popped;
+	
+	/* Index 0 */
+	/* The usual accessors work on packed doubles */
+	plist_t *list = plist_create_typed(PVAR_TYPE_DOUBLE, 2);
+	ASSERT_TRUE(list != NULL && plist_get_column_type(list) == PVAR_TYPE_DOUBLE, "Expected a typed list at index 0.");
+	plist_add_double(list, 0.5);
+	plist_extend_doubles(list, samples, 4);
+	plist_insert_double(list, 0, -0.5);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(list) == 6, "Expected six doubles at index 0.");
+	ASSERT_TRUE(plist_get_double(list, 0, &double_value) && double_value == -0.5, "Expected -0.5 first at index 0.");
+	ASSERT_TRUE(plist_get_double(list, 5, &double_value) && double_value == -4.0, "Expected -4.0 last at index 0.");
+	ASSERT_TRUE(plist_get_type(list, 3) == PVAR_TYPE_DOUBLE, "Expected PVAR_TYPE_DOUBLE at index 0.");
+	plist_set_double(list, 1, 10.0);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_double(list, 1, &double_value) && double_value == 10.0, "Expected 10.0 set at index 0.");
+	
+	/* Index 1 */
+	/* The span is the packed array itself */
+	ASSERT_TRUE(plist_borrow_span(list, &data, &count) && count == 6, "Expected a span of six values at index 1.");
+	const double *doubles = data;
+	ASSERT_TRUE(doubles[0] == -0.5 && doubles[1] == 10.0 && doubles[2] == 1.5 && doubles[5] == -4.0, "Expected the values in order at index 1.");
+	
+	/* Index 2 */
+	/* Values of other types are refused */
+	plist_add_int(list, 1);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_TYPED_LIST_TYPE_MISMATCH && plist_get_size(list) == 6, "Expected an int refused at index 2.");
+	plist_add_str(list, "text");
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_TYPED_LIST_TYPE_MISMATCH, "Expected a string refused at index 2.");
+	plist_set_long(list, 0, 1L);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_TYPED_LIST_TYPE_MISMATCH, "Expected a long refused by set at index 2.");
+	ASSERT_TRUE(!plist_get_int(list, 0, &int_value) && pvars_errno == FAILURE_PLIST_GET_INT_WRONG_TYPE, "Expected a wrong type error at index 2.");
+	pvar_t value = { .data.d = 7.0, .type = PVAR_TYPE_DOUBLE };
+	plist_add_pvar(list, &value);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(list) == 7 && plist_contains(list, &value), "Expected a double pvar added at index 2.");
+	value.type = PVAR_TYPE_FLOAT;
+	plist_insert_pvar(list, 0, &value);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_TYPED_LIST_TYPE_MISMATCH && plist_get_size(list) == 7, "Expected a float pvar refused at index 2.");
+	
+	/* Index 3 */
+	/* Copies share the array until one of them writes to it */
+	plist_t *copy = plist_copy(list);
+	ASSERT_TRUE(plist_get_column_type(copy) == PVAR_TYPE_DOUBLE, "Expected the copy typed at index 3.");
+	ASSERT_TRUE(plist_borrow_span_mutable(copy, &mutable_data, &count) && count == 7, "Expected a mutable span at index 3.");
+	((double *)mutable_data)[0] = 100.0;
+	ASSERT_TRUE(plist_get_double(copy, 0, &double_value) && double_value == 100.0, "Expected the copy written at index 3.");
+	ASSERT_TRUE(plist_get_double(list, 0, &double_value) && double_value == -0.5, "Expected the original intact at index 3.");
+	plist_destroy(copy);
+	
+	/* Index 4 */
+	/* Removal */
+	ASSERT_TRUE(plist_remove_if(list, test_negative_predicate, NULL) == 3 && plist_get_size(list) == 4, "Expected three negatives removed at index 4.");
+	ASSERT_TRUE(plist_pop(list, 0, &popped) && popped.type == PVAR_TYPE_DOUBLE && popped.data.d == 10.0, "Expected 10.0 popped at index 4.");
+	plist_swap_remove(list, 0);
+	plist_remove(list, 0);
+	ASSERT_TRUE(plist_get_size(list) == 1 && plist_get_double(list, 0, &double_value) && double_value == 3.5, "Expected 3.5 left at index 4.");
+	
+	/* Index 5 */
+	/* Extending between typed lists and lists of pvar_t */
+	plist_t *mixed = plist_create(4);
+	plist_add_double(mixed, 8.0);
+	plist_extend(list, mixed);
+	plist_extend(list, list);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(list) == 4, "Expected four doubles at index 5.");
+	plist_extend(mixed, list);
+	ASSERT_TRUE(pvars_errno == SUCCESS && plist_get_size(mixed) == 5 && plist_get_double(mixed, 4, &double_value) && double_value == 8.0, "Expected the doubles added to a plain list at index 5.");
+	plist_add_str(mixed, "text");
+	plist_extend(list, mixed);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_TYPED_LIST_TYPE_MISMATCH && plist_get_size(list) == 4, "Expected a mixed list refused at index 5.");
+	plist_destroy(mixed);
+	
+	/* Index 6 */
+	/* A typed list nested in a dict stays typed */
+	pdict_t *dict = pdict_create(4);
+	pdict_add_list(dict, "series", list);
+	const plist_t *nested = NULL;
+	ASSERT_TRUE(pdict_borrow_list(dict, "series", &nested) && plist_get_column_type(nested) == PVAR_TYPE_DOUBLE && plist_get_size(nested) == 4, "Expected a typed copy in the dict at index 6.");
+	pdict_destroy(dict);
+	plist_destroy(list);
+	
+	/* Index 7 */
+	/* Ints used as a queue */
+	list = plist_create_typed(PVAR_TYPE_INT, 1);
+	for (int i = 0; i < 100; i++) {
+		plist_insert_int(list, 0, i);
+	}
+	plist_shrink_to_fit(list);
+	ASSERT_TRUE(plist_get_size(list) == 100 && plist_get_capacity(list) == 100, "Expected a hundred ints at index 7.");
+	bool in_order = true;
+	for (int i = 99; i >= 0; i--) {
+		in_order = in_order && plist_pop(list, 0, &popped) && popped.data.i == i;
+	}
+	ASSERT_TRUE(in_order && plist_get_size(list) == 0, "Expected the ints popped in order at index 7.");
+	plist_destroy(list);
+	
+	/* Index 8 */
+	/* Invalid input */
+	ASSERT_TRUE(plist_create_typed(PVAR_TYPE_STRING, 4) == NULL && pvars_errno == FAILURE_PLIST_CREATE_TYPED_UNSUPPORTED_TYPE, "Expected strings refused at index 8.");
+	ASSERT_TRUE(plist_create_typed(PVAR_TYPE_LONG, 0) == NULL && pvars_errno == FAILURE_PLIST_CREATE_CAPACITY_OUT_OF_BOUNDS, "Expected a capacity error at index 8.");
+	list = plist_create(1);
+	ASSERT_TRUE(!plist_borrow_span(list, &data, &count) && pvars_errno == FAILURE_PLIST_BORROW_SPAN_NOT_TYPED, "Expected an untyped list refused at index 8.");
+	ASSERT_TRUE(plist_get_column_type(list) == PVAR_TYPE_NONE, "Expected no column type at index 8.");
+	ASSERT_TRUE(!plist_borrow_span_mutable(NULL, &mutable_data, &count) && pvars_errno == FAILURE_PLIST_BORROW_SPAN_MUTABLE_NULL_INPUT, "Expected a NULL error at index 8.");
+	plist_destroy(list);
+	
+	TEST_END();
+}
+
+
+/* --------------------------------------------------------------------------------- */
+/* Test 45: plist_sum(), plist_min(), plist_max(), plist_mean() and plist_variance() */
+/* --------------------------------------------------------------------------------- */
+int test_plist_reduce(void)
+{
+	static const pvar_type columns[] = { PVAR_TYPE_INT, PVAR_TYPE_LONG, PVAR_TYPE_DOUBLE, PVAR_TYPE_FLOAT };
+	double value = 0.0;
+	
+	/* Index 0 */
+	/* 1..1003 in every column type, shuffled so min and max sit mid-list */
+	for (size_t c = 0; c < sizeof(columns) / sizeof(columns[0]); c++) {
+		plist_t *list = plist_create_typed(columns[c], 16);
+		for (int i = 0; i < 1003; i++) {
+			int x = (i * 7) % 1003 + 1;
+			switch (columns[c]) {
+				case PVAR_TYPE_INT:
+					plist_add_int(list, x);
+					break;
+				case PVAR_TYPE_LONG:
+					plist_add_long(list, (long)x);
+					break;
+				case PVAR_TYPE_DOUBLE:
+					plist_add_double(list, (double)x);
+					break;
+				default:
+					plist_add_float(list, (float)x);
+					break;
+			}
+		}
+		ASSERT_TRUE(plist_sum(list, &value) && pvars_errno == SUCCESS && value == 503506.0, "Expected the sum of 1..1003 at index 0.");
+		ASSERT_TRUE(plist_min(list, &value) && value == 1.0, "Expected a minimum of 1 at index 0.");
+		ASSERT_TRUE(plist_max(list, &value) && value == 1003.0, "Expected a maximum of 1003 at index 0.");
+		ASSERT_TRUE(plist_mean(list, &value) && value == 502.0, "Expected a mean of 502 at index 0.");
+		ASSERT_TRUE(plist_variance(list, &value) && value == 83834.0, "Expected a variance of 83834 at index 0.");
+		plist_destroy(list);
+	}
+	
+	/* Index 1 */
+	/* Short typed lists, below the width of one vector */
+	plist_t *list = plist_create_typed(PVAR_TYPE_DOUBLE, 4);
+	plist_add_double(list, -2.5);
+	ASSERT_TRUE(plist_min(list, &value) && value == -2.5 && plist_max(list, &value) && value == -2.5, "Expected -2.5 as min and max at index 1.");
+	ASSERT_TRUE(plist_variance(list, &value) && value == 0.0, "Expected no variance at index 1.");
+	plist_add_double(list, 4.5);
+	plist_add_double(list, 1.0);
+	ASSERT_TRUE(plist_sum(list, &value) && value == 3.0, "Expected a sum of 3 at index 1.");
+	ASSERT_TRUE(plist_max(list, &value) && value == 4.5, "Expected a maximum of 4.5 at index 1.");
+	plist_destroy(list);
+	/* A NaN in the vector body, in the tail or first makes min and max NaN on every CPU */
+	static const size_t nan_at[] = { 0, 10, 36 };
+	for (size_t c = 2; c < sizeof(columns) / sizeof(columns[0]); c++) {
+		for (size_t n = 0; n < sizeof(nan_at) / sizeof(nan_at[0]); n++) {
+			list = plist_create_typed(columns[c], 40);
+			for (size_t i = 0; i < 37; i++) {
+				double x = i == nan_at[n] ? (double)NAN : (double)i - 18.0;
+				if (columns[c] == PVAR_TYPE_DOUBLE) {
+					plist_add_double(list, x);
+				} else {
+					plist_add_float(list, (float)x);
+				}
+			}
+			ASSERT_TRUE(plist_min(list, &value) && isnan(value), "Expected a NaN minimum at index 1.");
+			ASSERT_TRUE(plist_max(list, &value) && isnan(value), "Expected a NaN maximum at index 1.");
+			plist_destroy(list);
+		}
+	}
+	
+	/* Index 2 */
+	/* A list of pvar_t mixing number types */
+	list = plist_create(4);
+	plist_add_int(list, 3);
+	plist_add_long(list, -5L);
+	plist_add_double(list, 2.5);
+	plist_add_float(list, 1.5f);
+	ASSERT_TRUE(plist_sum(list, &value) && value == 2.0, "Expected a sum of 2 at index 2.");
+	ASSERT_TRUE(plist_min(list, &value) && value == -5.0, "Expected a minimum of -5 at index 2.");
+	ASSERT_TRUE(plist_max(list, &value) && value == 3.0, "Expected a maximum of 3 at index 2.");
+	ASSERT_TRUE(plist_mean(list, &value) && value == 0.5, "Expected a mean of 0.5 at index 2.");
+	ASSERT_TRUE(plist_variance(list, &value) && value == 10.375, "Expected a variance of 10.375 at index 2.");
+	plist_t *mixed = plist_copy(list);
+	plist_add_double(mixed, (double)NAN);
+	plist_add_int(mixed, 100);
+	ASSERT_TRUE(plist_min(mixed, &value) && isnan(value) && plist_max(mixed, &value) && isnan(value), "Expected a NaN minimum and maximum at index 2.");
+	plist_destroy(mixed);
+	
+	/* Index 3 */
+	/* Values that are not numbers */
+	value = 42.0;
+	plist_add_str(list, "text");
+	ASSERT_TRUE(!plist_sum(list, &value) && pvars_errno == FAILURE_PLIST_SUM_NOT_NUMERIC && value == 42.0, "Expected a sum error at index 3.");
+	ASSERT_TRUE(!plist_min(list, &value) && pvars_errno == FAILURE_PLIST_MIN_NOT_NUMERIC, "Expected a min error at index 3.");
+	ASSERT_TRUE(!plist_max(list, &value) && pvars_errno == FAILURE_PLIST_MAX_NOT_NUMERIC, "Expected a max error at index 3.");
+	ASSERT_TRUE(!plist_mean(list, &value) && pvars_errno == FAILURE_PLIST_MEAN_NOT_NUMERIC, "Expected a mean error at index 3.");
+	ASSERT_TRUE(!plist_variance(list, &value) && pvars_errno == FAILURE_PLIST_VARIANCE_NOT_NUMERIC, "Expected a variance error at index 3.");
+	
+	/* Index 4 */
+	/* Empty lists */
+	plist_empty(list);
+	ASSERT_TRUE(plist_sum(list, &value) && value == 0.0, "Expected an empty sum of 0 at index 4.");
+	ASSERT_TRUE(!plist_min(list, &value) && pvars_errno == FAILURE_PLIST_MIN_EMPTY_LIST, "Expected a min error at index 4.");
+	ASSERT_TRUE(!plist_max(list, &value) && pvars_errno == FAILURE_PLIST_MAX_EMPTY_LIST, "Expected a max error at index 4.");
+	ASSERT_TRUE(!plist_mean(list, &value) && pvars_errno == FAILURE_PLIST_MEAN_EMPTY_LIST, "Expected a mean error at index 4.");
+	ASSERT_TRUE(!plist_variance(list, &value) && pvars_errno == FAILURE_PLIST_VARIANCE_EMPTY_LIST, "Expected a variance error at index 4.");
+	
+	/* Index 5 */
+	/* NULL input */
+	ASSERT_TRUE(!plist_sum(NULL, &value) && pvars_errno == FAILURE_PLIST_SUM_NULL_INPUT, "Expected a NULL error at index 5.");
+	ASSERT_TRUE(!plist_variance(list, NULL) && pvars_errno == FAILURE_PLIST_VARIANCE_NULL_INPUT, "Expected a NULL error at index 5.");
+	plist_destroy(list);
+	
+	TEST_END();
+}
+
+
+/* ---------------------------------------------------------------- */
+/* Test 46: plist_set_indexed(), plist_index_of(), plist_count_of() */
+/* ---------------------------------------------------------------- */
+int test_plist_index(void)
+{
+	char buffer[64];
+	size_t index = 0;
+	pvar_t value = { .type = PVAR_TYPE_STRING };
+	
+	/* Index 0 */
+	/* Short and long strings, every tenth one twice */
+	plist_t *list = plist_create(16);
+	plist_t *scanned = plist_create(16);
+	for (int i = 0; i < 1000; i++) {
+		snprintf(buffer, sizeof(buffer), i % 2 == 0 ? "u%d" : "a much longer user name %d", i);
+		plist_add_str(list, buffer);
+		plist_add_str(scanned, buffer);
+	}
+	for (int i = 0; i < 1000; i += 10) {
+		snprintf(buffer, sizeof(buffer), i % 2 == 0 ? "u%d" : "a much longer user name %d", i);
+		plist_add_str(list, buffer);
+		plist_add_str(scanned, buffer);
+	}
+	plist_set_indexed(list, true);
+	ASSERT_TRUE(pvars_errno == SUCCESS, "Expected the list indexed at index 0.");
+	bool agree = true;
+	for (int i = 0; i < 1200; i++) {
+		snprintf(buffer, sizeof(buffer), i % 2 == 0 ? "u%d" : "a much longer user name %d", i);
+		value.data.s = buffer;
+		size_t indexed_at = 0, scanned_at = 0;
+		bool indexed_found = plist_index_of(list, &value, &indexed_at);
+		bool scanned_found = plist_index_of(scanned, &value, &scanned_at);
+		agree = agree && indexed_found == scanned_found && indexed_at == scanned_at;
+		agree = agree && plist_count_of(list, &value) == plist_count_of(scanned, &value);
+		agree = agree && plist_contains(list, &value) == (i < 1000);
+	}
+	ASSERT_TRUE(agree, "Expected the index and a scan to agree at index 0.");
+	value.data.s = "u20";
+	ASSERT_TRUE(plist_index_of(list, &value, &index) && index == 20 && plist_count_of(list, &value) == 2, "Expected u20 first at 20 and twice at index 0.");
+	value.data.s = "u1";
+	ASSERT_TRUE(plist_count_of(list, &value) == 0 && !plist_index_of(list, &value, &index) && pvars_errno == FAILURE_PLIST_INDEX_OF_NOT_FOUND, "Expected u1 not found at index 0.");
+	plist_destroy(scanned);
+	
+	/* Index 1 */
+	/* Changes are seen by the next search */
+	value.data.s = "u0";
+	plist_remove(list, 0);
+	ASSERT_TRUE(plist_index_of(list, &value, &index) && index == 999 && plist_count_of(list, &value) == 1, "Expected the second u0 found at index 1.");
+	plist_set_str(list, 1, "new");
+	value.data.s = "new";
+	ASSERT_TRUE(plist_index_of(list, &value, &index) && index == 1, "Expected a set value found at index 1.");
+	plist_insert_str(list, 0, "new");
+	ASSERT_TRUE(plist_index_of(list, &value, &index) && index == 0 && plist_count_of(list, &value) == 2, "Expected an inserted value found at index 1.");
+	plist_add_int(list, 7);
+	plist_add_long(list, 7L);
+	pvar_t number = { .data.i = 7, .type = PVAR_TYPE_INT };
+	ASSERT_TRUE(plist_index_of(list, &number, &index) && index == plist_get_size(list) - 2 && plist_count_of(list, &number) == 1, "Expected the int 7 alone at index 1.");
+	
+	/* Index 2 */
+	/* Copies keep their own index */
+	plist_t *copy = plist_copy(list);
+	plist_empty(copy);
+	ASSERT_TRUE(!plist_contains(copy, &value) && plist_count_of(list, &value) == 2, "Expected the original index intact at index 2.");
+	plist_add_str(copy, "new");
+	ASSERT_TRUE(plist_index_of(copy, &value, &index) && index == 0, "Expected the copy searched at index 2.");
+	plist_destroy(copy);
+	plist_destroy(list);
+	
+	/* Index 3 */
+	/* Typed lists, and doubles which are always scanned */
+	list = plist_create_typed(PVAR_TYPE_LONG, 16);
+	plist_set_indexed(list, true);
+	for (long i = 0; i < 500; i++) {
+		plist_add_long(list, i % 100);
+	}
+	pvar_t lng = { .data.l = 42, .type = PVAR_TYPE_LONG };
+	ASSERT_TRUE(plist_index_of(list, &lng, &index) && index == 42 && plist_count_of(list, &lng) == 5, "Expected 42 five times at index 3.");
+	ASSERT_TRUE(plist_count_of(list, &number) == 0 && pvars_errno == SUCCESS, "Expected no ints in a list of longs at index 3.");
+	plist_destroy(list);
+	/* Writes through a mutable span are seen by searches */
+	list = plist_create_typed(PVAR_TYPE_INT, 16);
+	plist_set_indexed(list, true);
+	for (int i = 0; i < 100; i++) {
+		plist_add_int(list, i);
+	}
+	void *span = NULL;
+	size_t count = 0;
+	ASSERT_TRUE(plist_borrow_span_mutable(list, &span, &count) && count == 100, "Expected a mutable span at index 3.");
+	pvar_t written = { .data.i = 1000, .type = PVAR_TYPE_INT };
+	ASSERT_TRUE(!plist_index_of(list, &written, &index), "Expected 1000 missing before the write at index 3.");
+	((int *)span)[5] = 1000;
+	ASSERT_TRUE(plist_index_of(list, &written, &index) && index == 5, "Expected 1000 written through the span found at index 3.");
+	((int *)span)[6] = 1000;
+	plist_set_indexed(list, true);
+	ASSERT_TRUE(plist_count_of(list, &written) == 2 && atomic_load(&list->index) != NULL, "Expected the index used again after the writes at index 3.");
+	plist_destroy(list);
+	list = plist_create(16);
+	plist_set_indexed(list, true);
+	for (int i = 0; i < 100; i++) {
+		plist_add_double(list, i * 0.5);
+	}
+	pvar_t dbl = { .data.d = 12.5, .type = PVAR_TYPE_DOUBLE };
+	ASSERT_TRUE(plist_index_of(list, &dbl, &index) && index == 25, "Expected 12.5 found at index 3.");
+	plist_set_indexed(list, false);
+	ASSERT_TRUE(plist_count_of(list, &dbl) == 1, "Expected 12.5 once at index 3.");
+	
+	/* Index 4 */
+	/* NULL input */
+	plist_set_indexed(NULL, true);
+	ASSERT_TRUE(pvars_errno == FAILURE_PLIST_SET_INDEXED_NULL_INPUT, "Expected a NULL error at index 4.");
+	ASSERT_TRUE(!plist_index_of(list, NULL, &index) && pvars_errno == FAILURE_PLIST_INDEX_OF_NULL_INPUT, "Expected a NULL error at index 4.");
+	ASSERT_TRUE(plist_count_of(NULL, &dbl) == 0 && pvars_errno == FAILURE_PLIST_COUNT_OF_NULL_INPUT, "Expected a NULL error at index 4.");
+	plist_destroy(list);
+	
+	TEST_END();
+}
+
+
+/* ---------------------------------------------------------- */
+/* Test 47: pvars_serialize(), pvars_deserialize()            */
+/* ---------------------------------------------------------- */
+int test_pvars_serialize(void)
+{
+	pvars_buffer_t buffer;
+	pvar_t decoded;
+	size_t used = 0;
+	const char *borrowed = NULL;
+	size_t len = 0;
+	int int_value = 0;
+	long long_value = 0;
+	double double_value = 0.0;
+	float float_value = 0.0f;
+	
+	/* Index 0 */
+	/* A document with every type */
+	pdict_t *document = pdict_create(8);
+	pdict_add_str(document, "name", "a string long enough to need a header");
+	pdict_add_strn(document, "binary", "a\0b", 3);
+	pdict_add_int(document, "int", -123456);
+	pdict_add_long(document, "long", 1L << 40);
+	pdict_add_double(document, "double", 0.1);
+	pdict_add_float(document, "float", -2.5f);
+	plist_t *items = plist_create(4);
+	plist_add_str(items, "short");
+	plist_add_int(items, INT_MIN);
+	plist_add_long(items, LONG_MAX);
+	pvar_t none = { .type = PVAR_TYPE_NONE };
+	plist_add_pvar(items, &none);
+	pdict_t *inner = pdict_create(2);
+	pdict_add_int(inner, "depth", 2);
+	plist_add_dict_take(items, inner);
+	plist_add_list_take(items, plist_create(1));
+	pdict_add_list_take(document, "items", items);
+	plist_t *series = plist_create_typed(PVAR_TYPE_DOUBLE, 4);
+	for (int i = 0; i < 1000; i++) {
+		plist_add_double(series, i * 0.25);
+	}
+	pdict_add_list_take(document, "series", series);
+	plist_t *counters = plist_create_typed(PVAR_TYPE_INT, 4);
+	for (int i = -300; i < 300; i++) {
+		plist_add_int(counters, i * 1000);
+	}
+	pdict_add_list_take(document, "counters", counters);
+	pdict_add_dict_take(document, "empty", pdict_create(1));
+	
+	pvars_buffer_init(&buffer);
+	pvar_t root = { .data.dt = document, .type = PVAR_TYPE_DICT };
+	ASSERT_TRUE(pvars_serialize(&root, &buffer) && pvars_errno == SUCCESS && buffer.size > 3, "Expected the document encoded at index 0.");
+	ASSERT_TRUE(buffer.data[0] == 'P' && buffer.data[1] == 'V' && buffer.data[2] == PVARS_SERIAL_VERSION, "Expected a header at index 0.");
+	ASSERT_TRUE(buffer.size < 1000 * sizeof(double) + 600 * 3 + 200, "Expected a compact encoding at index 0.");
+	
+	/* Index 1 */
+	/* Every value comes back */
+	ASSERT_TRUE(pvars_deserialize(buffer.data, buffer.size, &decoded, &used) && used == buffer.size && decoded.type == PVAR_TYPE_DICT, "Expected the document decoded at index 1.");
+	pdict_t *copy = decoded.data.dt;
+	ASSERT_TRUE(pdict_get_size(copy) == 10, "Expected ten keys at index 1.");
+	ASSERT_TRUE(pdict_borrow_str(copy, "name", &borrowed) && strcmp(borrowed, "a string long enough to need a header") == 0, "Expected the name at index 1.");
+	ASSERT_TRUE(pdict_borrow_strn(copy, "binary", &borrowed, &len) && len == 3 && memcmp(borrowed, "a\0b", 3) == 0, "Expected the binary string at index 1.");
+	ASSERT_TRUE(pdict_get_int(copy, "int", &int_value) && int_value == -123456, "Expected the int at index 1.");
+	ASSERT_TRUE(pdict_get_long(copy, "long", &long_value) && long_value == 1L << 40, "Expected the long at index 1.");
+	ASSERT_TRUE(pdict_get_double(copy, "double", &double_value) && double_value == 0.1, "Expected the double exactly at index 1.");
+	ASSERT_TRUE(pdict_get_float(copy, "float", &float_value) && float_value == -2.5f, "Expected the float at index 1.");
+	const plist_t *list = NULL;
+	ASSERT_TRUE(pdict_borrow_list(copy, "items", &list) && plist_get_size(list) == 6, "Expected six items at index 1.");
+	ASSERT_TRUE(plist_borrow_str(list, 0, &borrowed) && strcmp(borrowed, "short") == 0, "Expected the short string at index 1.");
+	ASSERT_TRUE(plist_get_int(list, 1, &int_value) && int_value == INT_MIN, "Expected INT_MIN at index 1.");
+	ASSERT_TRUE(plist_get_long(list, 2, &long_value) && long_value == LONG_MAX, "Expected LONG_MAX at index 1.");
+	ASSERT_TRUE(plist_get_type(list, 3) == PVAR_TYPE_NONE && plist_get_type(list, 5) == PVAR_TYPE_LIST, "Expected an empty value and list at index 1.");
+	const pdict_t *nested = NULL;
+	ASSERT_TRUE(plist_borrow_dict(list, 4, &nested) && pdict_get_int(nested, "depth", &int_value) && int_value == 2, "Expected the nested dict at index 1.");
+	ASSERT_TRUE(pdict_borrow_list(copy, "series", &list) && plist_get_column_type(list) == PVAR_TYPE_DOUBLE && plist_get_size(list) == 1000, "Expected a typed series at index 1.");
+	ASSERT_TRUE(plist_get_double(list, 999, &double_value) && double_value == 249.75, "Expected the last sample at index 1.");
+	ASSERT_TRUE(pdict_borrow_list(copy, "counters", &list) && plist_get_column_type(list) == PVAR_TYPE_INT && plist_get_size(list) == 600, "Expected typed counters at index 1.");
+	ASSERT_TRUE(plist_get_int(list, 0, &int_value) && int_value == -300000, "Expected the first counter at index 1.");
+	ASSERT_TRUE(pdict_borrow_dict(copy, "empty", &nested) && pdict_get_size(nested) == 0, "Expected an empty dict at index 1.");
+	pvar_destroy(&decoded);
+	
+	/* Index 2 */
+	/* Documents written back to back, and values that are not containers */
+	pvars_buffer_clear(&buffer);
+	pvar_t text = { .data.s = "plain", .type = PVAR_TYPE_STRING };
+	pvar_t number = { .data.l = -1, .type = PVAR_TYPE_LONG };
+	ASSERT_TRUE(pvars_serialize(&text, &buffer) && pvars_serialize(&number, &buffer), "Expected two documents at index 2.");
+	ASSERT_TRUE(pvars_deserialize(buffer.data, buffer.size, &decoded, &used) && decoded.type == PVAR_TYPE_STRING && strcmp(decoded.data.s, "plain") == 0, "Expected the string first at index 2.");
+	pvar_destroy(&decoded);
+	ASSERT_TRUE(used == 10 && pvars_deserialize(buffer.data + used, buffer.size - used, &decoded, NULL) && decoded.type == PVAR_TYPE_LONG && decoded.data.l == -1, "Expected the long second at index 2.");
+	
+	/* Index 3 */
+	/* Every truncation of a document is refused */
+	pvars_buffer_clear(&buffer);
+	pvars_serialize(&root, &buffer);
+	bool refused = true;
+	for (size_t cut = 0; cut < buffer.size; cut++) {
+		refused = refused && !pvars_deserialize(buffer.data, cut, &decoded, NULL) && pvars_errno == FAILURE_PVARS_DESERIALIZE_TRUNCATED;
+	}
+	ASSERT_TRUE(refused, "Expected every truncation refused at index 3.");
+	pdict_destroy(document);
+	
+	/* Index 4 */
+	/* Corrupt input */
+	static const unsigned char bad_magic[] = { 'P', 'X', 1, 0 };
+	static const unsigned char bad_tag[] = { 'P', 'V', 1, 9 };
+	static const unsigned char big_int[] = { 'P', 'V', 1, PVAR_TYPE_INT, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F };
+	static const unsigned char duplicate_key[] = { 'P', 'V', 1, PVAR_TYPE_DICT, 2, 1, 'k', PVAR_TYPE_NONE, 1, 'k', PVAR_TYPE_NONE };
+	static const unsigned char nul_key[] = { 'P', 'V', 1, PVAR_TYPE_DICT, 1, 1, 0, PVAR_TYPE_NONE };
+	static const unsigned char huge_count[] = { 'P', 'V', 1, PVAR_TYPE_LIST, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F };
+	ASSERT_TRUE(!pvars_deserialize(bad_magic, sizeof(bad_magic), &decoded, NULL) && pvars_errno == FAILURE_PVARS_DESERIALIZE_BAD_HEADER, "Expected a bad header at index 4.");
+	ASSERT_TRUE(!pvars_deserialize(bad_tag, sizeof(bad_tag), &decoded, NULL) && pvars_errno == FAILURE_PVARS_DESERIALIZE_MALFORMED, "Expected a bad tag at index 4.");
+	ASSERT_TRUE(!pvars_deserialize(big_int, sizeof(big_int), &decoded, NULL) && pvars_errno == FAILURE_PVARS_DESERIALIZE_MALFORMED, "Expected an int out of range at index 4.");
+	ASSERT_TRUE(!pvars_deserialize(duplicate_key, sizeof(duplicate_key), &decoded, NULL) && pvars_errno == FAILURE_PVARS_DESERIALIZE_MALFORMED, "Expected a duplicate key refused at index 4.");
+	ASSERT_TRUE(!pvars_deserialize(nul_key, sizeof(nul_key), &decoded, NULL) && pvars_errno == FAILURE_PVARS_DESERIALIZE_MALFORMED, "Expected a NUL in a key refused at index 4.");
+	ASSERT_TRUE(!pvars_deserialize(huge_count, sizeof(huge_count), &decoded, NULL) && pvars_errno == FAILURE_PVARS_DESERIALIZE_TRUNCATED, "Expected a huge count refused at index 4.");
+	
+	/* Index 5 */
+	/* Nesting limit */
+	unsigned char *deep = malloc(PVARS_SERIAL_MAX_DEPTH * 2 + 8);
+	memcpy(deep, "PV\x01", 3);
+	for (size_t i = 0; i <= PVARS_SERIAL_MAX_DEPTH; i++) {
+		deep[3 + 2 * i] = PVAR_TYPE_LIST;
+		deep[4 + 2 * i] = 1;
+	}
+	deep[3 + 2 * (PVARS_SERIAL_MAX_DEPTH + 1)] = PVAR_TYPE_NONE;
+	ASSERT_TRUE(!pvars_deserialize(deep, 4 + 2 * (PVARS_SERIAL_MAX_DEPTH + 1), &decoded, NULL) && pvars_errno == FAILURE_PVARS_DESERIALIZE_TOO_DEEP, "Expected deep nesting refused at index 5.");
+	free(deep);
+	
+	/* Index 6 */
+	/* NULL input */
+	ASSERT_TRUE(!pvars_serialize(NULL, &buffer) && pvars_errno == FAILURE_PVARS_SERIALIZE_NULL_INPUT, "Expected a NULL error at index 6.");
+	ASSERT_TRUE(!pvars_deserialize(NULL, 4, &decoded, NULL) && pvars_errno == FAILURE_PVARS_DESERIALIZE_NULL_INPUT, "Expected a NULL error at index 6.");
+	pvars_buffer_init(NULL);
+	ASSERT_TRUE(pvars_errno == FAILURE_PVARS_BUFFER_INIT_NULL_INPUT, "Expected a NULL error at index 6.");
+	pvars_buffer_release(&buffer);
+	ASSERT_TRUE(buffer.data == NULL && buffer.size == 0, "Expected an empty buffer at index 6.");
+	
+	TEST_END();
+}
+
+
+/* ----------------------------------------------------------- */
+/* Test 48: pvars_image_write(), pvars_image_open/map(), pview */
+/* ----------------------------------------------------------- */
+int test_pvars_image(void)
+{
+	pvars_buffer_t buffer;
+	pview_t root;
+	pview_t view;
+	pview_t inner_view;
+	const char *borrowed = NULL;
+	const void *span = NULL;
+	size_t len = 0;
+	int int_value = 0;
+	long long_value = 0;
+	double double_value = 0.0;
+	float float_value = 0.0f;
+	
+	/* Index 0 */
+	/* A document with every type, and a dict large enough to probe */
+	pdict_t *document = pdict_create(8);
+	pdict_add_str(document, "name", "a string long enough to need a header");
+	pdict_add_strn(document, "binary", "a\0b", 3);
+	pdict_add_int(document, "int", INT_MIN);
+	pdict_add_long(document, "long", LONG_MAX);
+	pdict_add_double(document, "double", 0.1);
+	pdict_add_float(document, "float", -2.5f);
+	plist_t *items = plist_create(4);
+	plist_add_str(items, "short");
+	plist_add_int(items, 7);
+	pvar_t none = { .type = PVAR_TYPE_NONE };
+	plist_add_pvar(items, &none);
+	pdict_t *inner = pdict_create(2);
+	pdict_add_int(inner, "depth", 2);
+	pdict_add_str(inner, "name", "inner");
+	plist_add_dict_take(items, inner);
+	pdict_add_list_take(document, "items", items);
+	plist_t *series = plist_create_typed(PVAR_TYPE_DOUBLE, 4);
+	for (int i = 0; i < 1000; i++) {
+		plist_add_double(series, i * 0.25);
+	}
+	pdict_add_list_take(document, "series", series);
+	plist_t *counters = plist_create_typed(PVAR_TYPE_INT, 4);
+	for (int i = 0; i < 100; i++) {
+		plist_add_int(counters, i - 50);
+	}
+	pdict_add_list_take(document, "counters", counters);
+	pdict_t *wide = pdict_create(8);
+	char key[16];
+	for (int i = 0; i < 500; i++) {
+		snprintf(key, sizeof(key), "key%d", i);
+		pdict_add_int(wide, key, i);
+	}
+	pdict_add_dict_take(document, "wide", wide);
+	
+	pvars_buffer_init(&buffer);
+	pvar_t value = { .data.dt = document, .type = PVAR_TYPE_DICT };
+	ASSERT_TRUE(pvars_image_write(&value, &buffer) && pvars_errno == SUCCESS && buffer.size % 8 == 0, "Expected the image written at index 0.");
+	ASSERT_TRUE(memcmp(buffer.data, "PVIM", 4) == 0, "Expected a header at index 0.");
+	
+	/* Index 1 */
+	/* Every value is read in place */
+	pvars_image_t *image = pvars_image_open(buffer.data, buffer.size);
+	ASSERT_TRUE(image != NULL && pvars_errno == SUCCESS, "Expected the image opened at index 1.");
+	ASSERT_TRUE(pvars_image_root(image, &root) && pview_get_type(&root) == PVAR_TYPE_DICT && pview_get_size(&root) == 10, "Expected a root dict of ten keys at index 1.");
+	ASSERT_TRUE(pview_dict_get(&root, "name", &view) && pview_borrow_str(&view, &borrowed) && strcmp(borrowed, "a string long enough to need a header") == 0, "Expected the name at index 1.");
+	ASSERT_TRUE(borrowed > (const char *)buffer.data && borrowed < (const char *)buffer.data + buffer.size, "Expected the name borrowed from the image at index 1.");
+	ASSERT_TRUE(pview_dict_get(&root, "binary", &view) && pview_borrow_strn(&view, &borrowed, &len) && len == 3 && memcmp(borrowed, "a\0b", 3) == 0, "Expected the binary string at index 1.");
+	ASSERT_TRUE(pview_dict_get(&root, "int", &view) && pview_get_int(&view, &int_value) && int_value == INT_MIN, "Expected the int at index 1.");
+	ASSERT_TRUE(pview_dict_get(&root, "long", &view) && pview_get_long(&view, &long_value) && long_value == LONG_MAX, "Expected the long at index 1.");
+	ASSERT_TRUE(pview_dict_get(&root, "double", &view) && pview_get_double(&view, &double_value) && double_value == 0.1, "Expected the double at index 1.");
+	ASSERT_TRUE(pview_dict_get(&root, "float", &view) && pview_get_float(&view, &float_value) && float_value == -2.5f, "Expected the float at index 1.");
+	
+	/* Index 2 */
+	/* Lists, nested dicts and empty values */
+	ASSERT_TRUE(pview_dict_get(&root, "items", &view) && pview_get_size(&view) == 4 && pview_get_column_type(&view) == PVAR_TYPE_NONE, "Expected four items at index 2.");
+	ASSERT_TRUE(pview_list_get(&view, 0, &inner_view) && pview_borrow_str(&inner_view, &borrowed) && strcmp(borrowed, "short") == 0, "Expected the short string at index 2.");
+	ASSERT_TRUE(pview_list_get(&view, 2, &inner_view) && pview_get_type(&inner_view) == PVAR_TYPE_NONE, "Expected the empty value at index 2.");
+	ASSERT_TRUE(pview_list_get(&view, 3, &inner_view) && pview_dict_get(&inner_view, "depth", &inner_view) && pview_get_int(&inner_view, &int_value) && int_value == 2, "Expected the nested dict at index 2.");
+	ASSERT_TRUE(!pview_list_get(&view, 4, &inner_view) && pvars_errno == FAILURE_PVIEW_LIST_GET_OUT_OF_BOUNDS, "Expected the end of the list reported at index 2.");
+	ASSERT_TRUE(!pview_get_int(&view, &int_value) && pvars_errno == FAILURE_PVIEW_GET_INT_WRONG_TYPE, "Expected a list refused as an int at index 2.");
+	
+	/* Index 3 */
+	/* Typed lists are borrowed as aligned arrays */
+	ASSERT_TRUE(pview_dict_get(&root, "series", &view) && pview_get_column_type(&view) == PVAR_TYPE_DOUBLE, "Expected a typed series at index 3.");
+	ASSERT_TRUE(pview_borrow_span(&view, &span, &len) && len == 1000 && (uintptr_t)span % sizeof(double) == 0, "Expected an aligned span at index 3.");
+	ASSERT_TRUE(((const double *)span)[999] == 249.75, "Expected the last sample in the span at index 3.");
+	ASSERT_TRUE(pview_list_get(&view, 4, &inner_view) && pview_get_double(&inner_view, &double_value) && double_value == 1.0, "Expected one sample as a double at index 3.");
+	ASSERT_TRUE(pview_dict_get(&root, "counters", &view) && pview_list_get(&view, 0, &inner_view) && pview_get_int(&inner_view, &int_value) && int_value == -50, "Expected a negative int from a typed list at index 3.");
+	ASSERT_TRUE(pview_dict_get(&root, "items", &view) && !pview_borrow_span(&view, &span, &len) && pvars_errno == FAILURE_PVIEW_BORROW_SPAN_NOT_TYPED, "Expected a list of mixed values refused at index 3.");
+	
+	/* Index 4 */
+	/* Every key of a large dict is found, missing ones are not */
+	ASSERT_TRUE(pview_dict_get(&root, "wide", &view) && pview_get_size(&view) == 500, "Expected 500 keys at index 4.");
+	bool all_found = true;
+	for (int i = 0; i < 500; i++) {
+		snprintf(key, sizeof(key), "key%d", i);
+		all_found = all_found && pview_dict_get(&view, key, &inner_view) && pview_get_int(&inner_view, &int_value) && int_value == i;
+	}
+	ASSERT_TRUE(all_found, "Expected every key found at index 4.");
+	ASSERT_TRUE(!pview_dict_get(&view, "key500", &inner_view) && pvars_errno == FAILURE_PVIEW_DICT_GET_KEY_NOT_FOUND, "Expected a missing key reported at index 4.");
+	const char *entry_key = NULL;
+	size_t walked = 0;
+	for (size_t i = 0; pview_dict_entry(&view, i, &entry_key, &inner_view); i++) {
+		walked += pview_dict_get(&view, entry_key, &inner_view);
+	}
+	ASSERT_TRUE(walked == 500 && pvars_errno == FAILURE_PVIEW_DICT_ENTRY_OUT_OF_BOUNDS, "Expected the entries walked in order at index 4.");
+	pvars_image_close(image);
+	
+	/* Index 5 */
+	/* Images are mapped from files */
+	const char *path = "test_image.tmp";
+	FILE *file = fopen(path, "wb");
+	ASSERT_TRUE(file != NULL && fwrite(buffer.data, 1, buffer.size, file) == buffer.size && fclose(file) == 0, "Expected the image saved at index 5.");
+	image = pvars_image_map(path);
+	ASSERT_TRUE(image != NULL && pvars_errno == SUCCESS, "Expected the image mapped at index 5.");
+	ASSERT_TRUE(pvars_image_root(image, &root) && pview_dict_get(&root, "wide", &view) && pview_dict_get(&view, "key123", &view) && pview_get_int(&view, &int_value) && int_value == 123, "Expected a key read from the mapping at index 5.");
+	pvars_image_close(image);
+	remove(path);
+	ASSERT_TRUE(pvars_image_map(path) == NULL && pvars_errno == FAILURE_PVARS_IMAGE_MAP_OPEN_FAILED, "Expected a missing file reported at index 5.");
+	
+	/* Index 6 */
+	/* Bad headers and corrupt records are reported, never read past */
+	ASSERT_TRUE(pvars_image_open(buffer.data, buffer.size - 8) == NULL && pvars_errno == FAILURE_PVARS_IMAGE_OPEN_BAD_HEADER, "Expected a truncated image refused at index 6.");
+	ASSERT_TRUE(pvars_image_open(buffer.data + 4, buffer.size - 4) == NULL && pvars_errno == FAILURE_PVARS_IMAGE_OPEN_MISALIGNED, "Expected a misaligned image refused at index 6.");
+	buffer.data[0] = 'X';
+	ASSERT_TRUE(pvars_image_open(buffer.data, buffer.size) == NULL && pvars_errno == FAILURE_PVARS_IMAGE_OPEN_BAD_HEADER, "Expected a bad magic refused at index 6.");
+	buffer.data[0] = 'P';
+	image = pvars_image_open(buffer.data, buffer.size);
+	ASSERT_TRUE(image != NULL && pvars_image_root(image, &root), "Expected the image opened again at index 6.");
+	view = root;
+	view.data = buffer.size - 8;
+	ASSERT_TRUE(pview_get_size(&view) == 0 && pvars_errno == FAILURE_PVARS_IMAGE_CORRUPT, "Expected a dict past the end reported at index 6.");
+	view.data = 3;
+	ASSERT_TRUE(!pview_dict_get(&view, "name", &inner_view) && pvars_errno == FAILURE_PVARS_IMAGE_CORRUPT, "Expected a misaligned dict reported at index 6.");
+	pvars_image_close(image);
+	/* A list whose element points back at the list itself, [[1]] patched */
+	plist_t *outer = plist_create(1);
+	plist_t *nested = plist_create(1);
+	plist_add_int(nested, 1);
+	plist_add_list_take(outer, nested);
+	pvar_t looped = { .data.ls = outer, .type = PVAR_TYPE_LIST };
+	ASSERT_TRUE(pvars_image_write(&looped, &buffer), "Expected the nested list written at index 6.");
+	image = pvars_image_open(buffer.data, buffer.size);
+	ASSERT_TRUE(image != NULL && pvars_image_root(image, &root) && pview_list_get(&root, 0, &view), "Expected the nested list read at index 6.");
+	pvars_image_close(image);
+	uint64_t self = root.data;
+	memcpy(buffer.data + self + 16, &self, sizeof(self));
+	image = pvars_image_open(buffer.data, buffer.size);
+	ASSERT_TRUE(image != NULL && pvars_image_root(image, &root), "Expected the patched image opened at index 6.");
+	ASSERT_TRUE(!pview_list_get(&root, 0, &view) && pvars_errno == FAILURE_PVARS_IMAGE_CORRUPT, "Expected a self-referencing list reported at index 6.");
+	pvars_image_close(image);
+	plist_destroy(outer);
+	
+	/* Index 7 */
+	/* Scalar roots, reused buffers and NULL inputs */
+	pvar_t number = { .data.l = -9, .type = PVAR_TYPE_LONG };
+	ASSERT_TRUE(pvars_image_write(&number, &buffer) && (image = pvars_image_open(buffer.data, buffer.size)) != NULL, "Expected a scalar image at index 7.");
+	ASSERT_TRUE(pvars_image_root(image, &root) && pview_get_long(&root, &long_value) && long_value == -9, "Expected the scalar read back at index 7.");
+	ASSERT_TRUE(!pview_get_size(&root) && pvars_errno == FAILURE_PVIEW_GET_SIZE_WRONG_TYPE, "Expected a scalar without a size at index 7.");
+	pvars_image_close(image);
+	/* An image is closed through the allocator it was opened with */
+	test_counts_t counts = { 0, 0, 0, 0 };
+	pvars_allocator_t counting = { test_counting_alloc, test_counting_resize, test_counting_release, &counts };
+	const pvars_allocator_t *libc = pvars_get_allocator();
+	pvars_set_allocator(&counting);
+	image = pvars_image_open(buffer.data, buffer.size);
+	pvars_set_allocator(libc);
+	pvars_image_close(image);
+	ASSERT_TRUE(image != NULL && counts.allocations == 1 && counts.live_bytes == 0 && counts.size_mismatches == 0, "Expected the handle returned to its allocator at index 7.");
+	ASSERT_TRUE(!pvars_image_write(NULL, &buffer) && pvars_errno == FAILURE_PVARS_IMAGE_WRITE_NULL_INPUT, "Expected a NULL value refused at index 7.");
+	ASSERT_TRUE(pvars_image_open(NULL, 0) == NULL && pvars_errno == FAILURE_PVARS_IMAGE_OPEN_NULL_INPUT, "Expected a NULL image refused at index 7.");
+	ASSERT_TRUE(!pvars_image_root(NULL, &root) && pvars_errno == FAILURE_PVARS_IMAGE_ROOT_NULL_INPUT, "Expected a NULL root refused at index 7.");
+	ASSERT_TRUE(!pview_dict_get(NULL, "key", &view) && pvars_errno == FAILURE_PVIEW_DICT_GET_NULL_INPUT, "Expected a NULL view refused at index 7.");
+	pvars_image_close(NULL);
+	
+	pvars_buffer_release(&buffer);
+	pdict_destroy(document);
+	
+	TEST_END();
+}
+
+
+/* ---------------------------------------------------------- */
+/* Test 49: pvars_parse_json()                                */
+/* ---------------------------------------------------------- */
+int test_pvars_parse_json(void)
+{
+	pvar_t value;
+	const char *borrowed = NULL;
+	size_t len = 0;
+	int int_value = 0;
+	long long_value = 0;
+	double double_value = 0.0;
+	const plist_t *list = NULL;
+	const pdict_t *dict = NULL;
+	
+	/* Index 0 */
+	/* Every JSON type */
+	const char *text = " {\"name\": \"pvars\", \"count\": 42, \"ratio\": -0.125, \"big\": 1e300,\n"
+		"\t\"on\": true, \"off\": false, \"nothing\": null, \"items\": [1, \"two\", [3.5, []], {}],\r\n"
+		"\"nested\": {\"deep\": {\"deeper\": [-7]}}} ";
+	ASSERT_TRUE(pvars_parse_json(text, strlen(text), &value) && pvars_errno == SUCCESS && value.type == PVAR_TYPE_DICT, "Expected an object parsed at index 0.");
+	pdict_t *root = value.data.dt;
+	ASSERT_TRUE(pdict_get_size(root) == 9, "Expected nine keys at index 0.");
+	ASSERT_TRUE(pdict_borrow_str(root, "name", &borrowed) && strcmp(borrowed, "pvars") == 0, "Expected the name at index 0.");
+	ASSERT_TRUE(pdict_get_long(root, "count", &long_value) && long_value == 42, "Expected an integer as a long at index 0.");
+	ASSERT_TRUE(pdict_get_double(root, "ratio", &double_value) && double_value == -0.125, "Expected a fraction as a double at index 0.");
+	ASSERT_TRUE(pdict_get_double(root, "big", &double_value) && double_value == 1e300, "Expected an exponent as a double at index 0.");
+	ASSERT_TRUE(pdict_get_int(root, "on", &int_value) && int_value == 1 && pdict_get_int(root, "off", &int_value) && int_value == 0, "Expected booleans as ints at index 0.");
+	ASSERT_TRUE(pdict_get_type(root, "nothing") == PVAR_TYPE_NONE && pdict_contains(root, "nothing"), "Expected null as an empty value at index 0.");
+	ASSERT_TRUE(pdict_borrow_list(root, "items", &list) && plist_get_size(list) == 4, "Expected four items at index 0.");
+	ASSERT_TRUE(plist_borrow_str(list, 1, &borrowed) && strcmp(borrowed, "two") == 0, "Expected a string item at index 0.");
+	ASSERT_TRUE(plist_get_type(list, 3) == PVAR_TYPE_DICT && plist_borrow_list(list, 2, &list) && plist_get_double(list, 0, &double_value) && double_value == 3.5, "Expected nested containers at index 0.");
+	ASSERT_TRUE(pdict_borrow_dict(root, "nested", &dict) && pdict_borrow_dict(dict, "deep", &dict) && pdict_borrow_list(dict, "deeper", &list) && plist_get_long(list, 0, &long_value) && long_value == -7, "Expected deep nesting at index 0.");
+	pvar_destroy(&value);
+	
+	/* Index 1 */
+	/* Escapes, including ones split across 64 byte blocks */
+	char escaped[256];
+	snprintf(escaped, sizeof(escaped), "[\"%s\\\\\\\"q\\n\\u00e9\\ud83d\\ude00\\/\", \"%s\\\\\"]", "0123456789012345678901234567890123456789012345678901234", "0123456789012345678901234567890123456789012345678");
+	ASSERT_TRUE(pvars_parse_json(escaped, strlen(escaped), &value) && value.type == PVAR_TYPE_LIST && plist_get_size(value.data.ls) == 2, "Expected escaped strings parsed at index 1.");
+	ASSERT_TRUE(plist_borrow_strn(value.data.ls, 0, &borrowed, &len) && len == 55 + 11 && memcmp(borrowed + 55, "\\\"q\n\xc3\xa9\xf0\x9f\x98\x80/", 11) == 0, "Expected every escape decoded at index 1.");
+	ASSERT_TRUE(plist_borrow_strn(value.data.ls, 1, &borrowed, &len) && len == 50 && borrowed[49] == '\\', "Expected a trailing escaped backslash at index 1.");
+	pvar_destroy(&value);
+	
+	/* Index 2 */
+	/* Numbers at the edges of long and double */
+	const char *numbers = "[9223372036854775807, -9223372036854775808, 9223372036854775808, 0.1, 1.7976931348623157e308, 5e-324, -0, 123456789012345678901234567890, 1E2, 2.5e+1]";
+	ASSERT_TRUE(pvars_parse_json(numbers, strlen(numbers), &value) && plist_get_size(value.data.ls) == 10, "Expected numbers parsed at index 2.");
+	list = value.data.ls;
+	ASSERT_TRUE(plist_get_long(list, 0, &long_value) && long_value == LONG_MAX, "Expected LONG_MAX at index 2.");
+	ASSERT_TRUE(plist_get_long(list, 1, &long_value) && long_value == LONG_MIN, "Expected LONG_MIN at index 2.");
+	ASSERT_TRUE(plist_get_double(list, 2, &double_value) && double_value == 9223372036854775808.0, "Expected a larger integer as a double at index 2.");
+	ASSERT_TRUE(plist_get_double(list, 3, &double_value) && double_value == 0.1, "Expected 0.1 exactly at index 2.");
+	ASSERT_TRUE(plist_get_double(list, 4, &double_value) && double_value == 1.7976931348623157e308, "Expected the largest double at index 2.");
+	ASSERT_TRUE(plist_get_double(list, 5, &double_value) && double_value == 5e-324, "Expected the smallest double at index 2.");
+	ASSERT_TRUE(plist_get_long(list, 6, &long_value) && long_value == 0, "Expected -0 as a long at index 2.");
+	ASSERT_TRUE(plist_get_double(list, 7, &double_value) && double_value == 123456789012345678901234567890.0, "Expected a long integer rounded at index 2.");
+	ASSERT_TRUE(plist_get_double(list, 8, &double_value) && double_value == 100.0 && plist_get_double(list, 9, &double_value) && double_value == 25.0, "Expected exponents at index 2.");
+	pvar_destroy(&value);
+	
+	/* Index 3 */
+	/* Scalars at the top level */
+	ASSERT_TRUE(pvars_parse_json("\"top\"", 5, &value) && value.type == PVAR_TYPE_STRING && strcmp(value.data.s, "top") == 0, "Expected a top level string at index 3.");
+	pvar_destroy(&value);
+	ASSERT_TRUE(pvars_parse_json(" 17 ", 4, &value) && value.type == PVAR_TYPE_LONG && value.data.l == 17, "Expected a top level number at index 3.");
+	ASSERT_TRUE(pvars_parse_json("[1, 2]garbage", 6, &value) && plist_get_size(value.data.ls) == 2, "Expected only len bytes read at index 3.");
+	pvar_destroy(&value);
+	
+	/* Index 4 */
+	/* A large document crosses many blocks */
+	size_t large_size = 200000;
+	char *large = malloc(large_size);
+	size_t used = (size_t)snprintf(large, large_size, "[");
+	for (int i = 0; used < large_size - 100; i++) {
+		used += (size_t)snprintf(large + used, large_size - used, "%s{\"id\": %d, \"tag\": \"t\\\"%d\", \"v\": %d.5}", i > 0 ? ", " : "", i, i, i);
+	}
+	large[used++] = ']';
+	ASSERT_TRUE(pvars_parse_json(large, used, &value) && plist_get_size(value.data.ls) > 1000, "Expected a large document parsed at index 4.");
+	const pdict_t *last = NULL;
+	size_t last_index = plist_get_size(value.data.ls) - 1;
+	ASSERT_TRUE(plist_borrow_dict(value.data.ls, last_index, &last) && pdict_get_long(last, "id", &long_value) && (size_t)long_value == last_index, "Expected the last record at index 4.");
+	ASSERT_TRUE(pdict_borrow_str(last, "tag", &borrowed) && borrowed[0] == 't' && borrowed[1] == '"', "Expected its escaped tag at index 4.");
+	pvar_destroy(&value);
+	free(large);
+	
+	/* Index 5 */
+	/* Malformed input is refused */
+	const char *syntax[] = { "", "   ", "[1,]", "[1 2]", "{\"a\" 1}", "{\"a\":1,}", "{1:2}", "[1]]", "[[1]", "tru", "nul", "truex", "[1]x", "\"a\" \"b\"", "{\"a\":}" };
+	bool refused = true;
+	for (size_t i = 0; i < sizeof(syntax) / sizeof(syntax[0]); i++) {
+		refused = refused && !pvars_parse_json(syntax[i], strlen(syntax[i]), &value) && pvars_errno == FAILURE_PVARS_PARSE_JSON_SYNTAX;
+	}
+	ASSERT_TRUE(refused, "Expected syntax errors at index 5.");
+	const char *strings[] = { "\"abc", "[\"a\\x\"]", "[\"\\u12\"]", "[\"\\ud800\"]", "[\"\\udc00\"]", "[\"tab\there\"]", "{\"a\\u0000b\": 1}" };
+	for (size_t i = 0; i < sizeof(strings) / sizeof(strings[0]); i++) {
+		refused = refused && !pvars_parse_json(strings[i], strlen(strings[i]), &value) && pvars_errno == FAILURE_PVARS_PARSE_JSON_BAD_STRING;
+	}
+	ASSERT_TRUE(refused, "Expected string errors at index 5.");
+	const char *numbers_bad[] = { "-", "01", "1.", ".5", "1e", "1e+", "1.5.3", "1e400", "-1e400", "0x10" };
+	for (size_t i = 0; i < sizeof(numbers_bad) / sizeof(numbers_bad[0]); i++) {
+		refused = refused && !pvars_parse_json(numbers_bad[i], strlen(numbers_bad[i]), &value) && (pvars_errno == FAILURE_PVARS_PARSE_JSON_BAD_NUMBER || pvars_errno == FAILURE_PVARS_PARSE_JSON_SYNTAX);
+	}
+	ASSERT_TRUE(refused, "Expected number errors at index 5.");
+	ASSERT_TRUE(!pvars_parse_json("{\"a\": 1, \"a\": 2}", 16, &value) && pvars_errno == FAILURE_PVARS_PARSE_JSON_DUPLICATE_KEY, "Expected a duplicate key refused at index 5.");
+	
+	/* Index 6 */
+	/* Nesting is limited */
+	char deep[2 * PVARS_JSON_MAX_DEPTH + 4];
+	memset(deep, '[', PVARS_JSON_MAX_DEPTH);
+	memset(deep + PVARS_JSON_MAX_DEPTH, ']', PVARS_JSON_MAX_DEPTH);
+	ASSERT_TRUE(pvars_parse_json(deep, 2 * PVARS_JSON_MAX_DEPTH, &value) && value.type == PVAR_TYPE_LIST, "Expected the deepest nesting parsed at index 6.");
+	pvar_destroy(&value);
+	memset(deep, '[', PVARS_JSON_MAX_DEPTH + 1);
+	memset(deep + PVARS_JSON_MAX_DEPTH + 1, ']', PVARS_JSON_MAX_DEPTH + 1);
+	ASSERT_TRUE(!pvars_parse_json(deep, 2 * PVARS_JSON_MAX_DEPTH + 2, &value) && pvars_errno == FAILURE_PVARS_PARSE_JSON_TOO_DEEP, "Expected deeper nesting refused at index 6.");
+	
+	/* Index 7 */
+	/* NULL inputs */
+	ASSERT_TRUE(!pvars_parse_json(NULL, 0, &value) && pvars_errno == FAILURE_PVARS_PARSE_JSON_NULL_INPUT, "Expected NULL text refused at index 7.");
+	ASSERT_TRUE(!pvars_parse_json("1", 1, NULL) && pvars_errno == FAILURE_PVARS_PARSE_JSON_NULL_INPUT, "Expected a NULL output refused at index 7.");
+	
+	/* Index 8 */
+	/* Parsing into an arena */
+	pvars_arena_t *arena = pvars_arena_create(1024);
+	const char *in_arena = "{\"name\": \"a string longer than the inline size\", \"list\": [1, {\"b\": \"c\\n\"}]}";
+	ASSERT_TRUE(pvars_parse_json_in(arena, in_arena, strlen(in_arena), &value) && value.type == PVAR_TYPE_DICT && pvars_errno == SUCCESS, "Expected a dict parsed into the arena at index 8.");
+	ASSERT_TRUE(pvars_arena_get_used(arena) > 0, "Expected the arena used at index 8.");
+	ASSERT_TRUE(pdict_borrow_str(value.data.dt, "name", &borrowed) && strcmp(borrowed, "a string longer than the inline size") == 0, "Expected the long string at index 8.");
+	ASSERT_TRUE(pdict_borrow_list(value.data.dt, "list", &list) && plist_borrow_dict(list, 1, &dict) && pdict_borrow_str(dict, "b", &borrowed) && strcmp(borrowed, "c\n") == 0, "Expected the nested string at index 8.");
+	ASSERT_TRUE(!pvars_parse_json_in(arena, "[1,", 3, &value) && pvars_errno == FAILURE_PVARS_PARSE_JSON_SYNTAX, "Expected a syntax error in the arena at index 8.");
+	ASSERT_TRUE(pvars_parse_json_in(arena, "\"top\"", 5, &value) && value.type == PVAR_TYPE_STRING && strcmp(value.data.s, "top") == 0, "Expected a top level string at index 8.");
+	pvar_destroy(&value);
+	pvars_arena_destroy(arena);
+	
+	TEST_END();
+}
+
+
+/* ---------------------------------------------------------- */
+/* Test 50: pvars_to_json(), pvars_to_json_fd()               */
+/* ---------------------------------------------------------- */
+/* Appends the JSON text of value to buffer as a C string, for comparisons */
+static const char *test_to_json(const pvar_t *value, pvars_buffer_t *buffer, pvars_json_style style)
+{
+	pvars_buffer_clear(buffer);
+	if (!pvars_to_json(value, buffer, style) || !pvars_buffer_reserve(buffer, 1, FAILURE_PVARS_TO_JSON_REALLOC_FAILED)) {
+		return "";
+	}
+	buffer->data[buffer->size] = '\0';
+	return (const char *)buffer->data;
+}
+
+int test_pvars_to_json(void)
+{
+	pvars_buffer_t buffer;
+	pvar_t value;
+	pvars_buffer_init(&buffer);
+	
+	/* Index 0 */
+	/* Numbers: integers exact, doubles and floats shortest with a fraction or an exponent */
+	value = (pvar_t){ .type = PVAR_TYPE_NONE };
+	ASSERT_TRUE(strcmp(test_to_json(&value, &buffer, PVARS_JSON_COMPACT), "null") == 0 && pvars_errno == SUCCESS, "Expected null at index 0.");
+	value = (pvar_t){ .type = PVAR_TYPE_INT, .data.i = INT_MIN };
+	ASSERT_TRUE(strcmp(test_to_json(&value, &buffer, PVARS_JSON_COMPACT), "-2147483648") == 0, "Expected INT_MIN at index 0.");
+	value = (pvar_t){ .type = PVAR_TYPE_LONG, .data.l = LONG_MIN };
+	char expected[64];
+	snprintf(expected, sizeof(expected), "%ld", LONG_MIN);
+	ASSERT_TRUE(strcmp(test_to_json(&value, &buffer, PVARS_JSON_COMPACT), expected) == 0, "Expected LONG_MIN at index 0.");
+	const double doubles[] = { 0.0, -0.0, 1.0, 0.1, -2.5, 100.0, 1e21, 1.5e-7, 0.000001, 5e-324, 1.7976931348623157e308, 123456.789 };
+	const char *double_texts[] = { "0.0", "-0.0", "1.0", "0.1", "-2.5", "100.0", "1e21", "1.5e-7", "0.000001", "5e-324", "1.7976931348623157e308", "123456.789" };
+	bool matched = true;
+	for (size_t i = 0; i < sizeof(doubles) / sizeof(doubles[0]); i++) {
+		value = (pvar_t){ .type = PVAR_TYPE_DOUBLE, .data.d = doubles[i] };
+		matched = matched && strcmp(test_to_json(&value, &buffer, PVARS_JSON_COMPACT), double_texts[i]) == 0;
+	}
+	ASSERT_TRUE(matched, "Expected the shortest doubles at index 0.");
+	value = (pvar_t){ .type = PVAR_TYPE_FLOAT, .data.f = 0.1f };
+	ASSERT_TRUE(strcmp(test_to_json(&value, &buffer, PVARS_JSON_COMPACT), "0.1") == 0, "Expected the shortest float at index 0.");
+	value = (pvar_t){ .type = PVAR_TYPE_FLOAT, .data.f = FLT_MAX };
+	ASSERT_TRUE(strcmp(test_to_json(&value, &buffer, PVARS_JSON_COMPACT), "3.4028235e38") == 0, "Expected FLT_MAX at index 0.");
+	
+	/* Index 1 */
+	/* Every double written reads back exactly */
+	uint64_t state = 0x9E3779B97F4A7C15ull;
+	bool exact = true;
+	for (int i = 0; i < 100000 && exact; i++) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		double number;
+		memcpy(&number, &state, sizeof(number));
+		if (!isfinite(number)) {
+			continue;
+		}
+		value = (pvar_t){ .type = PVAR_TYPE_DOUBLE, .data.d = number };
+		exact = strtod(test_to_json(&value, &buffer, PVARS_JSON_COMPACT), NULL) == number;
+	}
+	ASSERT_TRUE(exact, "Expected random doubles to round-trip at index 1.");
+	
+	/* Index 2 */
+	/* Strings are escaped */
+	value = (pvar_t){ .type = PVAR_TYPE_STRING, .data.s = "quote \" backslash \\ tab \t newline \n bell \a caf\xc3\xa9" };
+	ASSERT_TRUE(strcmp(test_to_json(&value, &buffer, PVARS_JSON_COMPACT), "\"quote \\\" backslash \\\\ tab \\t newline \\n bell \\u0007 caf\xc3\xa9\"") == 0, "Expected escapes at index 2.");
+	plist_t *list = plist_create(2);
+	plist_add_strn(list, "a\0b", 3);
+	value = (pvar_t){ .type = PVAR_TYPE_LIST, .data.ls = list };
+	ASSERT_TRUE(strcmp(test_to_json(&value, &buffer, PVARS_JSON_COMPACT), "[\"a\\u0000b\"]") == 0, "Expected an escaped NUL at index 2.");
+	plist_destroy(list);
+	
+	/* Index 3 */
+	/* Containers, compact and pretty */
+	pdict_t *document = pdict_create(4);
+	plist_t *items = plist_create(4);
+	plist_add_int(items, 1);
+	plist_add_str(items, "two");
+	plist_add_list_take(items, plist_create(1));
+	plist_add_dict_take(items, pdict_create(1));
+	pdict_add_list_take(document, "items", items);
+	value = (pvar_t){ .type = PVAR_TYPE_DICT, .data.dt = document };
+	ASSERT_TRUE(strcmp(test_to_json(&value, &buffer, PVARS_JSON_COMPACT), "{\"items\":[1,\"two\",[],{}]}") == 0, "Expected compact text at index 3.");
+	ASSERT_TRUE(strcmp(test_to_json(&value, &buffer, PVARS_JSON_PRETTY), "{\n  \"items\": [\n    1,\n    \"two\",\n    [],\n    {}\n  ]\n}") == 0, "Expected pretty text at index 3.");
+	plist_t *typed = plist_create_typed(PVAR_TYPE_DOUBLE, 4);
+	plist_add_double(typed, 0.5);
+	plist_add_double(typed, -3.0);
+	value = (pvar_t){ .type = PVAR_TYPE_LIST, .data.ls = typed };
+	ASSERT_TRUE(strcmp(test_to_json(&value, &buffer, PVARS_JSON_COMPACT), "[0.5,-3.0]") == 0, "Expected a typed list at index 3.");
+	plist_destroy(typed);
+	
+	/* Index 4 */
+	/* Text parses back to the same values */
+	pdict_add_str(document, "name", "a string long enough to need a header");
+	pdict_add_long(document, "long", -(1L << 40));
+	pdict_add_double(document, "double", 2.0 / 3.0);
+	for (int i = 0; i < 100; i++) {
+		char key[16];
+		snprintf(key, sizeof(key), "key%d", i);
+		pdict_add_int(document, key, i * i);
+	}
+	value = (pvar_t){ .type = PVAR_TYPE_DICT, .data.dt = document };
+	pvar_t parsed;
+	const char *text = test_to_json(&value, &buffer, PVARS_JSON_PRETTY);
+	ASSERT_TRUE(pvars_parse_json(text, strlen(text), &parsed) && parsed.type == PVAR_TYPE_DICT, "Expected the text parsed at index 4.");
+	long long_value = 0;
+	double double_value = 0.0;
+	const char *borrowed = NULL;
+	ASSERT_TRUE(pdict_get_long(parsed.data.dt, "long", &long_value) && long_value == -(1L << 40), "Expected the long back at index 4.");
+	ASSERT_TRUE(pdict_get_double(parsed.data.dt, "double", &double_value) && double_value == 2.0 / 3.0, "Expected the double back at index 4.");
+	ASSERT_TRUE(pdict_borrow_str(parsed.data.dt, "name", &borrowed) && strcmp(borrowed, "a string long enough to need a header") == 0, "Expected the string back at index 4.");
+	ASSERT_TRUE(pdict_get_long(parsed.data.dt, "key99", &long_value) && long_value == 99 * 99 && pdict_get_size(parsed.data.dt) == 104, "Expected every key back at index 4.");
+	pvar_destroy(&parsed);
+	
+	/* Index 5 */
+	/* Failures leave the buffer as it was */
+	ASSERT_TRUE(pvars_to_json(&value, &buffer, PVARS_JSON_COMPACT), "Expected the document appended at index 5.");
+	size_t size = buffer.size;
+	pdict_add_double(document, "nan", NAN);
+	ASSERT_TRUE(!pvars_to_json(&value, &buffer, PVARS_JSON_COMPACT) && pvars_errno == FAILURE_PVARS_TO_JSON_NOT_FINITE && buffer.size == size, "Expected NaN refused at index 5.");
+	pdict_remove(document, "nan");
+	ASSERT_TRUE(!pvars_to_json(&value, &buffer, (pvars_json_style)7) && pvars_errno == FAILURE_PVARS_TO_JSON_UNKNOWN_STYLE, "Expected an unknown style refused at index 5.");
+	ASSERT_TRUE(!pvars_to_json(NULL, &buffer, PVARS_JSON_COMPACT) && pvars_errno == FAILURE_PVARS_TO_JSON_NULL_INPUT, "Expected a NULL value refused at index 5.");
+	ASSERT_TRUE(!pvars_to_json(&value, NULL, PVARS_JSON_COMPACT) && pvars_errno == FAILURE_PVARS_TO_JSON_NULL_INPUT, "Expected a NULL buffer refused at index 5.");
+	
+	/* Index 6 */
+	/* Writing to a file descriptor, through several flushes */
+	plist_t *records = plist_create(16);
+	for (int i = 0; i < 5000; i++) {
+		pdict_t *record = pdict_create(4);
+		pdict_add_int(record, "id", i);
+		pdict_add_str(record, "name", "a record with a longer name");
+		pdict_add_double(record, "score", i * 0.125);
+		plist_add_dict_take(records, record);
+	}
+	pvar_t all = { .type = PVAR_TYPE_LIST, .data.ls = records };
+	text = test_to_json(&all, &buffer, PVARS_JSON_PRETTY);
+	ASSERT_TRUE(buffer.size > 3 * 64 * 1024, "Expected a document larger than the flush size at index 6.");
+	FILE *file = tmpfile();
+	ASSERT_TRUE(file != NULL && pvars_to_json_fd(&all, fileno(file), PVARS_JSON_PRETTY) && pvars_errno == SUCCESS, "Expected the document written at index 6.");
+	char *written = malloc(buffer.size + 1);
+	rewind(file);
+	ASSERT_TRUE(written != NULL && fread(written, 1, buffer.size + 1, file) == buffer.size && memcmp(written, text, buffer.size) == 0, "Expected the same text as the buffer at index 6.");
+	free(written);
+	fclose(file);
+	FILE *read_only = fopen("/dev/null", "r");
+	ASSERT_TRUE(read_only != NULL && !pvars_to_json_fd(&all, fileno(read_only), PVARS_JSON_COMPACT) && pvars_errno == FAILURE_PVARS_TO_JSON_WRITE_FAILED, "Expected a failed write reported at index 6.");
+	fclose(read_only);
+	ASSERT_TRUE(!pvars_to_json_fd(&all, -1, PVARS_JSON_COMPACT) && pvars_errno == FAILURE_PVARS_TO_JSON_NULL_INPUT, "Expected a negative descriptor refused at index 6.");
+	plist_destroy(records);
+	
+	pdict_destroy(document);
+	pvars_buffer_release(&buffer);
+	
+	TEST_END();
+}
+
+
+/* ------------------------------------------------------------------------------------ */
+/* Test 51: pvars_stream_create(), pvars_stream_feed(), pvars_stream_finish()           */
+/* ------------------------------------------------------------------------------------ */
+/* Writes every event of a stream to a transcript, building the subtrees at one depth */
+typedef struct {
+	pvars_buffer_t transcript;
+	size_t select_depth; /* Depth of the lists and dicts to build, SIZE_MAX for none */
+	size_t events;       /* Events seen */
+	size_t stop_after;   /* Events before a callback stops the stream, SIZE_MAX for never */
+} test_stream_t;
+
+static bool test_stream_log(test_stream_t *log, const char *text, size_t len)
+{
+	if (!pvars_buffer_reserve(&log->transcript, len, FAILURE_PVARS_SERIALIZE_REALLOC_FAILED)) {
+		return false;
+	}
+	memcpy(log->transcript.data + log->transcript.size, text, len);
+	log->transcript.size += len;
+	return ++log->events < log->stop_after;
+}
+
+/* Tells whether the transcript holds len bytes, which may include NULs */
+static bool test_stream_contains(const test_stream_t *log, const char *bytes, size_t len)
+{
+	for (size_t i = 0; i + len <= log->transcript.size; i++) {
+		if (memcmp(log->transcript.data + i, bytes, len) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool test_stream_start_list(void *context)
+{
+	return test_stream_log(context, "[", 1);
+}
+
+static bool test_stream_start_dict(void *context)
+{
+	return test_stream_log(context, "{", 1);
+}
+
+static bool test_stream_end(void *context)
+{
+	return test_stream_log(context, ")", 1);
+}
+
+static bool test_stream_key(void *context, const char *key, size_t len)
+{
+	return test_stream_log(context, "k", 1) && key[len] == '\0' && test_stream_log(context, key, len) && test_stream_log(context, ":", 1);
+}
+
+static bool test_stream_string(void *context, const char *bytes, size_t len)
+{
+	return test_stream_log(context, "s", 1) && bytes[len] == '\0' && test_stream_log(context, bytes, len) && test_stream_log(context, ";", 1);
+}
+
+static bool test_stream_value(void *context, const pvar_t *value)
+{
+	char text[64];
+	switch (value->type) {
+		case PVAR_TYPE_INT:
+			snprintf(text, sizeof(text), "i%d;", value->data.i);
+			break;
+		case PVAR_TYPE_LONG:
+			snprintf(text, sizeof(text), "l%ld;", value->data.l);
+			break;
+		case PVAR_TYPE_DOUBLE:
+			snprintf(text, sizeof(text), "d%.17g;", value->data.d);
+			break;
+		case PVAR_TYPE_FLOAT:
+			snprintf(text, sizeof(text), "f%.9g;", value->data.f);
+			break;
+		default:
+			snprintf(text, sizeof(text), "n;");
+			break;
+	}
+	return test_stream_log(context, text, strlen(text));
+}
+
+typedef struct {
+	const char *key;
+	const pvar_t *value;
+} test_entry_t;
+
+static int test_entry_order(const void *a, const void *b)
+{
+	return strcmp(((const test_entry_t *)a)->key, ((const test_entry_t *)b)->key);
+}
+
+/* Writes a value to a transcript as the events it would give, with the keys of every dict in order, so that values built in different orders compare equal */
+static bool test_stream_canonical(test_stream_t *log, const pvar_t *value)
+{
+	if (value->type == PVAR_TYPE_STRING) {
+		return test_stream_string(log, pvar_str(value), pvar_str_len(value));
+	}
+	
+	if (value->type == PVAR_TYPE_LIST) {
+		bool done = test_stream_start_list(log);
+		for (size_t i = 0; done && i < plist_get_size(value->data.ls); i++) {
+			pvar_t scratch;
+			done = test_stream_canonical(log, plist_element(value->data.ls, i, &scratch));
+		}
+		return done && test_stream_end(log);
+	}
+	
+	if (value->type != PVAR_TYPE_DICT) {
+		return test_stream_value(log, value);
+	}
+	
+	size_t count = pdict_get_size(value->data.dt);
+	test_entry_t *entries = malloc((count > 0 ? count : 1) * sizeof(test_entry_t));
+	pdict_iter_t iter;
+	pvar_t *entry_value;
+	size_t n = 0;
+	pdict_iter_init(&iter, value->data.dt);
+	while (entries != NULL && pdict_iter_next(&iter, &entries[n].key, &entry_value)) {
+		entries[n++].value = entry_value;
+	}
+	qsort(entries, n, sizeof(test_entry_t), test_entry_order);
+	
+	bool done = entries != NULL && test_stream_start_dict(log);
+	for (size_t i = 0; done && i < n; i++) {
+		done = test_stream_key(log, entries[i].key, strlen(entries[i].key)) && test_stream_canonical(log, entries[i].value);
+	}
+	free(entries);
+	return done && test_stream_end(log);
+}
+
+static bool test_stream_select(void *context, pvar_type type, size_t depth)
+{
+	(void)type;
+	return depth == ((test_stream_t *)context)->select_depth;
+}
+
+static bool test_stream_subtree(void *context, pvar_t *value)
+{
+	bool done = test_stream_log(context, "T", 1) && test_stream_canonical(context, value);
+	pvar_destroy(value);
+	return done;
+}
+
+static const pvars_stream_callbacks_t test_stream_callbacks = {
+	.start_list = test_stream_start_list,
+	.start_dict = test_stream_start_dict,
+	.key = test_stream_key,
+	.string = test_stream_string,
+	.value = test_stream_value,
+	.end = test_stream_end,
+	.select = test_stream_select,
+	.subtree = test_stream_subtree,
+};
+
+/* Streams data in chunks of chunk bytes, or of random sizes up to 64 if chunk is 0, and returns the transcript as a C string, or NULL on failure */
+static const char *test_stream_run(test_stream_t *log, pvars_stream_format format, const void *data, size_t size, size_t chunk)
+{
+	pvars_buffer_clear(&log->transcript);
+	log->events = 0;
+
+	pvars_stream_t *stream = pvars_stream_create(format, &test_stream_callbacks, log);
+	uint64_t state = 0x2545F4914F6CDD1Dull;
+	bool done = stream != NULL;
+
+	for (size_t offset = 0; done && offset < size; ) {
+		size_t n = chunk;
+		if (n == 0) {
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+			n = 1 + (size_t)(state % 64);
+		}
+		n = n < size - offset ? n : size - offset;
+		done = pvars_stream_feed(stream, (const char *)data + offset, n);
+		offset += n;
+	}
+	done = done && pvars_stream_finish(stream);
+
+	perrno_t failure = pvars_errno;
+	pvars_stream_destroy(stream);
+	if (!pvars_buffer_reserve(&log->transcript, 1, FAILURE_PVARS_SERIALIZE_REALLOC_FAILED)) {
+		return NULL;
+	}
+	log->transcript.data[log->transcript.size] = '\0';
+	pvars_errno = failure;
+	return done ? (const char *)log->transcript.data : NULL;
+}
+
+int test_pvars_stream(void)
+{
+	test_stream_t log = { .select_depth = SIZE_MAX, .stop_after = SIZE_MAX };
+	pvars_buffer_init(&log.transcript);
+	pvars_buffer_t input;
+	pvars_buffer_init(&input);
+	
+	/* Index 0 */
+	/* Events of a JSON document, whole and a byte at a time */
+	const char *json = " {\"a\": [1, -2.5, true, false, null, \"x\\ny\"], \"b\\u00e9\": {}, \"c\": []} 7 \"s\"\n[1e400]";
+	const char *events = "{ka:[l1;d-2.5;i1;i0;n;sx\ny;)kb\xc3\xa9:{)kc:[))l7;ss;[";
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_JSON, json, strlen(json), strlen(json)) == NULL && pvars_errno == FAILURE_PVARS_PARSE_JSON_BAD_NUMBER, "Expected a number out of range refused at index 0.");
+	ASSERT_TRUE(strcmp((const char *)log.transcript.data, events) == 0, "Expected the events before the failure at index 0.");
+	json = " {\"a\": [1, -2.5, true, false, null, \"x\\ny\"], \"b\\u00e9\": {}, \"c\": []} 7 \"s\"\n[1e300]\n-0";
+	const char *whole = test_stream_run(&log, PVARS_STREAM_JSON, json, strlen(json), strlen(json));
+	ASSERT_TRUE(whole != NULL && strcmp(whole, "{ka:[l1;d-2.5;i1;i0;n;sx\ny;)kb\xc3\xa9:{)kc:[))l7;ss;[d1.0000000000000001e+300;)l0;") == 0 && pvars_errno == SUCCESS, "Expected every event at index 0.");
+	const char *bytewise = test_stream_run(&log, PVARS_STREAM_JSON, json, strlen(json), 1);
+	ASSERT_TRUE(bytewise != NULL && strcmp(bytewise, "{ka:[l1;d-2.5;i1;i0;n;sx\ny;)kb\xc3\xa9:{)kc:[))l7;ss;[d1.0000000000000001e+300;)l0;") == 0, "Expected the same events a byte at a time at index 0.");
+	
+	/* Index 1 */
+	/* Records with escapes, surrogate pairs and long strings, in chunks of any size */
+	for (int i = 0; i < 500; i++) {
+		pdict_t *record = pdict_create(8);
+		char name[96];
+		snprintf(name, sizeof(name), "record \"%d\" with a \\ and a tab\t, long enough to need a header", i);
+		pdict_add_int(record, "id", i);
+		pdict_add_str(record, "name", name);
+		pdict_add_double(record, "score", i / 7.0);
+		pdict_add_long(record, "big", -(1L << 50) * (i % 3));
+		plist_t *tags = plist_create(4);
+		plist_add_str(tags, "caf\xc3\xa9 \xf0\x9f\x98\x80");
+		plist_add_list_take(tags, plist_create(1));
+		pdict_add_list_take(record, "tags", tags);
+		pvar_t value = { .type = PVAR_TYPE_DICT, .data.dt = record };
+		ASSERT_TRUE(pvars_to_json(&value, &input, i % 2 == 0 ? PVARS_JSON_COMPACT : PVARS_JSON_PRETTY), "Expected a record written at index 1.");
+		pdict_destroy(record);
+		ASSERT_TRUE(pvars_buffer_reserve(&input, 1, FAILURE_PVARS_SERIALIZE_REALLOC_FAILED), "Expected room for a newline at index 1.");
+		input.data[input.size++] = '\n';
+	}
+	/* A surrogate pair, as another writer would escape it */
+	const char *escaped = "[\"\\ud83d\\ude00\", \"\\u0000\"]";
+	ASSERT_TRUE(pvars_buffer_reserve(&input, strlen(escaped), FAILURE_PVARS_SERIALIZE_REALLOC_FAILED), "Expected room for the escapes at index 1.");
+	memcpy(input.data + input.size, escaped, strlen(escaped));
+	input.size += strlen(escaped);
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_JSON, input.data, input.size, input.size) != NULL, "Expected the records read at index 1.");
+	size_t expected_size = log.transcript.size;
+	char *expected = malloc(expected_size);
+	ASSERT_TRUE(expected != NULL && test_stream_contains(&log, "s\xf0\x9f\x98\x80;s\0;)", 10), "Expected the surrogate pair and NUL decoded at index 1.");
+	memcpy(expected, log.transcript.data, expected_size);
+	const char *chunked = test_stream_run(&log, PVARS_STREAM_JSON, input.data, input.size, 1);
+	ASSERT_TRUE(chunked != NULL && log.transcript.size == expected_size && memcmp(chunked, expected, expected_size) == 0, "Expected the same events a byte at a time at index 1.");
+	chunked = test_stream_run(&log, PVARS_STREAM_JSON, input.data, input.size, 0);
+	ASSERT_TRUE(chunked != NULL && log.transcript.size == expected_size && memcmp(chunked, expected, expected_size) == 0, "Expected the same events in random chunks at index 1.");
+	free(expected);
+	
+	/* Index 2 */
+	/* Records built as subtrees match pvars_parse_json() */
+	log.select_depth = 0;
+	chunked = test_stream_run(&log, PVARS_STREAM_JSON, input.data, input.size, 0);
+	ASSERT_TRUE(chunked != NULL && strncmp(chunked, "T{", 2) == 0, "Expected the records built at index 2.");
+	test_stream_t parsed = { .select_depth = SIZE_MAX, .stop_after = SIZE_MAX };
+	pvars_buffer_init(&parsed.transcript);
+	const char *line = (const char *)input.data;
+	bool matched = true;
+	for (int i = 0; i <= 500 && matched; i++) {
+		/* Compact records take a line, pretty ones end with a line holding "}", and the escapes come last */
+		const char *stop = i == 500 ? (const char *)input.data + input.size : i % 2 == 0 ? strchr(line, '\n') : strstr(line, "\n}\n") + 2;
+		pvar_t value;
+		matched = pvars_parse_json(line, (size_t)(stop - line), &value) && test_stream_log(&parsed, "T", 1) && test_stream_canonical(&parsed, &value);
+		pvar_destroy(&value);
+		line = stop + 1;
+	}
+	ASSERT_TRUE(matched && parsed.transcript.size == log.transcript.size && memcmp(parsed.transcript.data, chunked, parsed.transcript.size) == 0, "Expected every record as pvars_parse_json() reads it at index 2.");
+	pvars_buffer_release(&parsed.transcript);
+	log.select_depth = 1;
+	json = "{\"a\": {\"b\": [1, {\"c\": \"d\"}]}, \"e\": 2}";
+	chunked = test_stream_run(&log, PVARS_STREAM_JSON, json, strlen(json), 3);
+	ASSERT_TRUE(chunked != NULL && strcmp(chunked, "{ka:T{kb:[l1;{kc:sd;)))ke:l2;)") == 0, "Expected a nested subtree at index 2.");
+	json = "[{\"a\": 1, \"a\": 2}]";
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_JSON, json, strlen(json), 1) == NULL && pvars_errno == FAILURE_PVARS_PARSE_JSON_DUPLICATE_KEY, "Expected a duplicate key refused in a subtree at index 2.");
+	log.select_depth = SIZE_MAX;
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_JSON, json, strlen(json), 1) != NULL, "Expected a duplicate key passed on outside subtrees at index 2.");
+	
+	/* Index 3 */
+	/* Binary documents, one after the other, match what was serialized */
+	pvars_buffer_t binary;
+	pvars_buffer_init(&binary);
+	test_stream_t originals = { .select_depth = SIZE_MAX, .stop_after = SIZE_MAX };
+	pvars_buffer_init(&originals.transcript);
+	for (int i = 0; i < 50; i++) {
+		pdict_t *record = pdict_create(8);
+		pdict_add_int(record, "id", -i);
+		pdict_add_str(record, "name", "a name long enough to need a header");
+		pdict_add_float(record, "ratio", i / 3.0f);
+		pdict_add_long(record, "big", LONG_MIN + i);
+		plist_t *column = plist_create_typed(i % 2 == 0 ? PVAR_TYPE_DOUBLE : PVAR_TYPE_INT, 4);
+		for (int j = 0; j < i; j++) {
+			if (i % 2 == 0) {
+				plist_add_double(column, j * 0.5);
+			} else {
+				plist_add_int(column, j - 20);
+			}
+		}
+		pdict_add_list_take(record, "column", column);
+		plist_t *mixed = plist_create(4);
+		plist_add_strn(mixed, "nul\0inside", 10);
+		plist_add_str(mixed, "");
+		plist_add_dict_take(mixed, pdict_create(1));
+		pdict_add_list_take(record, "mixed", mixed);
+		pvar_t value = { .type = PVAR_TYPE_DICT, .data.dt = record };
+		ASSERT_TRUE(pvars_serialize(&value, &binary), "Expected a record serialized at index 3.");
+		ASSERT_TRUE(test_stream_log(&originals, "T", 1) && test_stream_canonical(&originals, &value), "Expected a record written at index 3.");
+		pdict_destroy(record);
+	}
+	pvar_t scalar = { .type = PVAR_TYPE_LONG, .data.l = 42 };
+	ASSERT_TRUE(pvars_serialize(&scalar, &binary), "Expected a scalar serialized at index 3.");
+	log.select_depth = 0;
+	chunked = test_stream_run(&log, PVARS_STREAM_BINARY, binary.data, binary.size, 1);
+	ASSERT_TRUE(chunked != NULL && log.transcript.size == originals.transcript.size + 4 && memcmp(chunked, originals.transcript.data, originals.transcript.size) == 0 && strcmp(chunked + originals.transcript.size, "l42;") == 0, "Expected every binary record built at index 3.");
+	log.select_depth = SIZE_MAX;
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_BINARY, binary.data, binary.size, binary.size) != NULL, "Expected the binary records read at index 3.");
+	expected_size = log.transcript.size;
+	expected = malloc(expected_size);
+	ASSERT_TRUE(expected != NULL && test_stream_contains(&log, "kcolumn:[d0;d0.5;", 17) && test_stream_contains(&log, "snul\0inside;s;{)", 16), "Expected typed lists and strings as events at index 3.");
+	memcpy(expected, log.transcript.data, expected_size);
+	chunked = test_stream_run(&log, PVARS_STREAM_BINARY, binary.data, binary.size, 0);
+	ASSERT_TRUE(chunked != NULL && log.transcript.size == expected_size && memcmp(chunked, expected, expected_size) == 0, "Expected the same binary events in random chunks at index 3.");
+	free(expected);
+	
+	/* Index 4 */
+	/* Malformed input fails as the one-shot readers do, and the stream starts over after finishing */
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_JSON, "[1,]", 4, 1) == NULL && pvars_errno == FAILURE_PVARS_PARSE_JSON_SYNTAX, "Expected a trailing comma refused at index 4.");
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_JSON, "[01]", 4, 1) == NULL && pvars_errno == FAILURE_PVARS_PARSE_JSON_BAD_NUMBER, "Expected a leading zero refused at index 4.");
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_JSON, "[tru]", 5, 2) == NULL && pvars_errno == FAILURE_PVARS_PARSE_JSON_SYNTAX, "Expected a bad literal refused at index 4.");
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_JSON, "\"a\\x\"", 5, 1) == NULL && pvars_errno == FAILURE_PVARS_PARSE_JSON_BAD_STRING, "Expected a bad escape refused at index 4.");
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_JSON, "{\"a\\u0000\": 1}", 14, 1) == NULL && pvars_errno == FAILURE_PVARS_PARSE_JSON_BAD_STRING, "Expected a NUL in a key refused at index 4.");
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_JSON, "[1] [2", 6, 1) == NULL && pvars_errno == FAILURE_PVARS_PARSE_JSON_SYNTAX, "Expected an unfinished document refused at index 4.");
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_JSON, "\"open", 5, 1) == NULL && pvars_errno == FAILURE_PVARS_PARSE_JSON_BAD_STRING, "Expected an unfinished string refused at index 4.");
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_BINARY, binary.data, binary.size - 1, 7) == NULL && pvars_errno == FAILURE_PVARS_DESERIALIZE_TRUNCATED, "Expected a truncated document refused at index 4.");
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_BINARY, "PX", 2, 1) == NULL && pvars_errno == FAILURE_PVARS_DESERIALIZE_BAD_HEADER, "Expected a bad header refused at index 4.");
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_BINARY, "PV\x01\x2a", 4, 1) == NULL && pvars_errno == FAILURE_PVARS_DESERIALIZE_MALFORMED, "Expected a bad tag refused at index 4.");
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_JSON, "", 0, 1) != NULL && log.transcript.size == 0, "Expected empty input accepted at index 4.");
+	pvars_stream_t *stream = pvars_stream_create(PVARS_STREAM_JSON, &test_stream_callbacks, &log);
+	ASSERT_TRUE(pvars_stream_feed(stream, "[1, 2] [3,,", 11) == false && pvars_errno == FAILURE_PVARS_PARSE_JSON_SYNTAX && pvars_stream_get_offset(stream) == 10, "Expected the offset of the failure at index 4.");
+	ASSERT_TRUE(!pvars_stream_feed(stream, "4]", 2) && pvars_errno == FAILURE_PVARS_PARSE_JSON_SYNTAX, "Expected the failure to stick at index 4.");
+	ASSERT_TRUE(!pvars_stream_finish(stream) && pvars_errno == FAILURE_PVARS_PARSE_JSON_SYNTAX && pvars_stream_get_offset(stream) == 0, "Expected finishing to report the failure at index 4.");
+	ASSERT_TRUE(pvars_stream_feed(stream, "[5]", 3) && pvars_stream_finish(stream), "Expected the stream to start over at index 4.");
+	pvars_stream_destroy(stream);
+	
+	/* Index 5 */
+	/* Callbacks stop the stream; missing ones are skipped */
+	log.stop_after = 3;
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_JSON, "[1, 2, 3, 4]", 12, 1) == NULL && pvars_errno == FAILURE_PVARS_STREAM_STOPPED && log.events == 3, "Expected the stream stopped at index 5.");
+	log.stop_after = SIZE_MAX;
+	pvars_stream_callbacks_t none = { 0 };
+	stream = pvars_stream_create(PVARS_STREAM_BINARY, &none, NULL);
+	ASSERT_TRUE(stream != NULL && pvars_stream_feed(stream, binary.data, binary.size) && pvars_stream_finish(stream), "Expected a stream without callbacks at index 5.");
+	pvars_stream_destroy(stream);
+	
+	/* Index 6 */
+	/* Nesting up to the limit, and a subtree being built when the stream is destroyed */
+	char deep[2 * PVARS_JSON_MAX_DEPTH + 2];
+	memset(deep, '[', PVARS_JSON_MAX_DEPTH);
+	memset(deep + PVARS_JSON_MAX_DEPTH, ']', PVARS_JSON_MAX_DEPTH);
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_JSON, deep, 2 * PVARS_JSON_MAX_DEPTH, 5) != NULL, "Expected the deepest nesting at index 6.");
+	memset(deep, '[', PVARS_JSON_MAX_DEPTH + 1);
+	memset(deep + PVARS_JSON_MAX_DEPTH + 1, ']', PVARS_JSON_MAX_DEPTH + 1);
+	ASSERT_TRUE(test_stream_run(&log, PVARS_STREAM_JSON, deep, 2 * PVARS_JSON_MAX_DEPTH + 2, 5) == NULL && pvars_errno == FAILURE_PVARS_PARSE_JSON_TOO_DEEP, "Expected deeper nesting refused at index 6.");
+	log.select_depth = 2;
+	stream = pvars_stream_create(PVARS_STREAM_JSON, &test_stream_callbacks, &log);
+	json = "[[[{\"a\": [\"a string long enough to need a header\"";
+	ASSERT_TRUE(pvars_stream_feed(stream, json, strlen(json)), "Expected a partial subtree at index 6.");
+	pvars_stream_destroy(stream);
+	log.select_depth = SIZE_MAX;
+	
+	/* Index 7 */
+	/* The stream keeps its allocator when the process wide one changes */
+	test_counts_t counts = { 0, 0, 0, 0 };
+	pvars_allocator_t counting = { test_counting_alloc, test_counting_resize, test_counting_release, &counts };
+	const pvars_allocator_t *libc = pvars_get_allocator();
+	log.select_depth = 1;
+	pvars_set_allocator(&counting);
+	stream = pvars_stream_create(PVARS_STREAM_JSON, &test_stream_callbacks, &log);
+	json = "[{\"a\": \"an escaped\\nstring, long enough to need a header";
+	ASSERT_TRUE(stream != NULL && pvars_stream_feed(stream, json, strlen(json)), "Expected a partial string at index 7.");
+	pvars_set_allocator(libc);
+	json = "\", \"b\": [1.5, 2]}, 3, {\"c\": \"\\u00e9\"}]";
+	ASSERT_TRUE(pvars_stream_feed(stream, json, strlen(json)) && pvars_stream_finish(stream), "Expected the stream finished with another allocator at index 7.");
+	json = "[{\"d\": [\"a subtree left unfinished\"";
+	ASSERT_TRUE(pvars_stream_feed(stream, json, strlen(json)), "Expected a partial subtree at index 7.");
+	pvars_stream_destroy(stream);
+	log.select_depth = SIZE_MAX;
+	ASSERT_TRUE(counts.allocations > 0 && counts.live_bytes == 0 && counts.size_mismatches == 0, "Expected every block returned to the stream's allocator at index 7.");
+	
+	/* Index 8 */
+	/* NULL inputs */
+	ASSERT_TRUE(pvars_stream_create(PVARS_STREAM_JSON, NULL, NULL) == NULL && pvars_errno == FAILURE_PVARS_STREAM_CREATE_NULL_INPUT, "Expected NULL callbacks refused at index 8.");
+	ASSERT_TRUE(pvars_stream_create((pvars_stream_format)9, &none, NULL) == NULL && pvars_errno == FAILURE_PVARS_STREAM_CREATE_UNKNOWN_FORMAT, "Expected an unknown format refused at index 8.");
+	ASSERT_TRUE(!pvars_stream_feed(NULL, "1", 1) && pvars_errno == FAILURE_PVARS_STREAM_FEED_NULL_INPUT, "Expected a NULL stream refused at index 8.");
+	ASSERT_TRUE(!pvars_stream_finish(NULL) && pvars_errno == FAILURE_PVARS_STREAM_FINISH_NULL_INPUT, "Expected a NULL stream refused by finish at index 8.");
+	ASSERT_TRUE(pvars_stream_get_offset(NULL) == 0 && pvars_errno == FAILURE_PVARS_STREAM_GET_OFFSET_NULL_INPUT, "Expected a NULL stream refused by get_offset at index 8.");
+	
+	pvars_buffer_release(&originals.transcript);
+	pvars_buffer_release(&binary);
+	pvars_buffer_release(&input);
+	pvars_buffer_release(&log.transcript);
+	
+	TEST_END();
+}
+
 
 /* ------------------------- */
 /* --- Test Suite Runner --- */
@@ -1564,6 +4587,31 @@ struct {
 	{"test_plist_empty_copy", test_plist_empty_copy},
 	{"test_plist_contains", test_plist_contains},
 	{"test_plist_add_pvar", test_plist_add_pvar},
+	{"test_pdict_resize", test_pdict_resize},
+	{"test_pdict_flat_backend", test_pdict_flat_backend},
+	{"test_pdict_cached_hash", test_pdict_cached_hash},
+	{"test_pdict_hash_function", test_pdict_hash_function},
+	{"test_borrow_accessors", test_borrow_accessors},
+	{"test_take_pop", test_take_pop},
+	{"test_arena", test_arena},
+	{"test_allocator", test_allocator},
+	{"test_pdict_slabs", test_pdict_slabs},
+	{"test_inline_strings", test_inline_strings},
+	{"test_length_prefixed_strings", test_length_prefixed_strings},
+	{"test_key_interning", test_key_interning},
+	{"test_copy_on_write", test_copy_on_write},
+	{"test_plist_extend", test_plist_extend},
+	{"test_plist_sizing", test_plist_sizing},
+	{"test_plist_remove_batch", test_plist_remove_batch},
+	{"test_plist_insert", test_plist_insert},
+	{"test_plist_typed", test_plist_typed},
+	{"test_plist_reduce", test_plist_reduce},
+	{"test_plist_index", test_plist_index},
+	{"test_pvars_serialize", test_pvars_serialize},
+	{"test_pvars_image", test_pvars_image},
+	{"test_pvars_parse_json", test_pvars_parse_json},
+	{"test_pvars_to_json", test_pvars_to_json},
+	{"test_pvars_stream", test_pvars_stream},
 	{NULL, NULL}
 };
 